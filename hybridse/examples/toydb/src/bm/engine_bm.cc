@@ -73,6 +73,11 @@ static void BM_EngineWindowSumFeature5Window5(
     EngineWindowSumFeature5Window5(&state, BENCHMARK, state.range(0),
                                    state.range(1));
 }
+static void BM_EngineWindowSumFeature5Window5Pipeline(
+    benchmark::State& state) {  // NOLINT
+    EngineWindowSumFeature5Window5Pipeline(&state, BENCHMARK, state.range(0),
+                                           state.range(1));
+}
 static void BM_EngineWindowDistinctCntFeature(
     benchmark::State& state) {  // NOLINT
     EngineWindowDistinctCntFeature(&state, BENCHMARK, state.range(0),
@@ -220,6 +225,15 @@ BENCHMARK(BM_EngineWindowSumFeature5Window5)
     ->Args({100, 100})
     ->Args({1000, 1000})
     ->Args({10000, 10000});
+BENCHMARK(BM_EngineWindowSumFeature5Window5Pipeline)
+    ->Args({1, 2})
+    ->Args({1, 10})
+    ->Args({1, 100})
+    ->Args({1, 1000})
+    ->Args({1, 10000})
+    ->Args({100, 100})
+    ->Args({1000, 1000})
+    ->Args({10000, 10000});
 BENCHMARK(BM_EngineWindowMultiAggFeature5)
     ->Args({1, 2})
     ->Args({1, 10})
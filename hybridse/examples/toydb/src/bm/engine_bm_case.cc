@@ -102,7 +102,8 @@ void MapTop1(benchmark::State* state, MODE mode, int64_t limit_cnt,
 
 static void EngineRequestMode(const std::string sql, MODE mode,
                               int64_t limit_cnt, int64_t size,
-                              benchmark::State* state) {
+                              benchmark::State* state,
+                              bool enable_request_pipeline = false) {
     InitializeNativeTarget();
     InitializeNativeTargetAsmPrinter();
     // prepare data into table
@@ -111,6 +112,7 @@ static void EngineRequestMode(const std::string sql, MODE mode,
     if (hybridse::sqlcase::SqlCase::IsCluster()) {
         options.SetClusterOptimized(true);
     }
+    options.SetEnableRequestPipeline(enable_request_pipeline);
     Engine engine(catalog, options);
     RequestRunSession session;
     base::Status query_status;
@@ -459,10 +461,8 @@ void EngineWindowTop1RatioFeature(benchmark::State* state, MODE mode,
     EngineRequestMode(sql, mode, limit_cnt, size, state);
 }
 
-void EngineWindowSumFeature5Window5(benchmark::State* state, MODE mode,
-                                    int64_t limit_cnt,
-                                    int64_t size) {  // NOLINT
-    const std::string sql =
+static const std::string WindowSumFeature5Window5Sql(int64_t limit_cnt) {
+    return
         "SELECT "
         "sum(col1) OVER w1 as w1_col1_sum, "
         "sum(col3) OVER (PARTITION BY col0 ORDER BY col5 ROWS_RANGE BETWEEN "
@@ -480,7 +480,19 @@ void EngineWindowSumFeature5Window5(benchmark::State* state, MODE mode,
         "BETWEEN "
         "30d PRECEDING AND CURRENT ROW) limit " +
         std::to_string(limit_cnt) + ";";
-    EngineRequestMode(sql, mode, limit_cnt, size, state);
+}
+void EngineWindowSumFeature5Window5(benchmark::State* state, MODE mode,
+                                    int64_t limit_cnt,
+                                    int64_t size) {  // NOLINT
+    EngineRequestMode(WindowSumFeature5Window5Sql(limit_cnt), mode, limit_cnt,
+                      size, state);
+}
+void EngineWindowSumFeature5Window5Pipeline(benchmark::State* state, MODE mode,
+                                            int64_t limit_cnt,
+                                            int64_t size) {  // NOLINT
+    // the concats of the 5 windows and the final project run as one pipeline
+    EngineRequestMode(WindowSumFeature5Window5Sql(limit_cnt), mode, limit_cnt,
+                      size, state, true);
 }
 void EngineWindowMultiAggFeature5(benchmark::State* state, MODE mode,
                                   int64_t limit_cnt,
@@ -71,6 +71,9 @@ void EngineWindowSumFeature5ExcludeCurrentTime(benchmark::State* state,
 void EngineWindowSumFeature5Window5(benchmark::State* state, MODE mode,
                                     int64_t limit_cnt,
                                     int64_t size);  // NOLINT
+void EngineWindowSumFeature5Window5Pipeline(benchmark::State* state, MODE mode,
+                                            int64_t limit_cnt,
+                                            int64_t size);  // NOLINT
 
 void EngineWindowTop1RatioFeature(benchmark::State* state, MODE mode,
                                   int64_t limit_cnt, int64_t size);
@@ -49,6 +49,11 @@ TEST_F(EngineBMCaseTest, EngineWindowSumFeature5Window5_TEST) {
     EngineWindowSumFeature5Window5(nullptr, TEST, 100L, 100L);
     EngineWindowSumFeature5Window5(nullptr, TEST, 1000L, 1000L);
 }
+TEST_F(EngineBMCaseTest, EngineWindowSumFeature5Window5Pipeline_TEST) {
+    EngineWindowSumFeature5Window5Pipeline(nullptr, TEST, 1L, 100L);
+    EngineWindowSumFeature5Window5Pipeline(nullptr, TEST, 100L, 100L);
+    EngineWindowSumFeature5Window5Pipeline(nullptr, TEST, 1000L, 1000L);
+}
 TEST_F(EngineBMCaseTest, EngineWindowMultiAggWindow25Feature25_TEST) {
     EngineWindowMultiAggWindow25Feature25(nullptr, TEST, 1L, 100L);
     EngineWindowMultiAggWindow25Feature25(nullptr, TEST, 1L, 1000L);
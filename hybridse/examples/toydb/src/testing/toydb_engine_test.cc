@@ -35,6 +35,19 @@ TEST_P(EngineTest, TestRequestEngine) {
         LOG(INFO) << "Skip mode " << sql_case.mode();
     }
 }
+TEST_P(EngineTest, TestRequestPipelineEngine) {
+    ParamType sql_case = GetParam();
+    EngineOptions options;
+    options.SetEnableRequestPipeline(true);
+    LOG(INFO) << "ID: " << sql_case.id() << ", DESC: " << sql_case.desc();
+    if (!boost::contains(sql_case.mode(), "request-unsupport") &&
+        !boost::contains(sql_case.mode(), "performance-sensitive-unsupport") &&
+        !boost::contains(sql_case.mode(), "rtidb-unsupport")) {
+        EngineCheck(sql_case, options, kRequestMode);
+    } else {
+        LOG(INFO) << "Skip mode " << sql_case.mode();
+    }
+}
 TEST_P(EngineTest, TestBatchEngine) {
     ParamType sql_case = GetParam();
     EngineOptions options;
@@ -48,6 +61,19 @@ TEST_P(EngineTest, TestBatchEngine) {
         LOG(INFO) << "Skip mode " << sql_case.mode();
     }
 }
+TEST_P(EngineTest, TestBatchEngineWithSpill) {
+    ParamType sql_case = GetParam();
+    EngineOptions options;
+    LOG(INFO) << "ID: " << sql_case.id() << ", DESC: " << sql_case.desc();
+    if (!boost::contains(sql_case.mode(), "batch-unsupport") &&
+        !boost::contains(sql_case.mode(), "rtidb-unsupport") &&
+        !boost::contains(sql_case.mode(), "performance-sensitive-unsupport") &&
+        !boost::contains(sql_case.mode(), "rtidb-batch-unsupport")) {
+        BatchEngineSpillCheck(sql_case, options);
+    } else {
+        LOG(INFO) << "Skip mode " << sql_case.mode();
+    }
+}
 TEST_P(EngineTest, TestBatchRequestEngineForLastRow) {
     ParamType sql_case = GetParam();
     EngineOptions options;
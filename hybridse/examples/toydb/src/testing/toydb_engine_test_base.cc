@@ -211,6 +211,41 @@ void EngineCheck(const SqlCase& sql_case, const EngineOptions& options,
     }
 }
 
+static void ComputeBatchOutput(const SqlCase& sql_case, const EngineOptions& options, Schema* schema,
+                               std::vector<Row>* output) {
+    ToydbBatchEngineTestRunner engine_test(sql_case, options);
+    ASSERT_TRUE(engine_test.InitEngineCatalog());
+    Status status = engine_test.Compile();
+    ASSERT_TRUE(status.isOK()) << "Compile error: " << status;
+    status = engine_test.PrepareData();
+    ASSERT_TRUE(status.isOK()) << "Prepare data error: " << status;
+    status = engine_test.Compute(output);
+    ASSERT_TRUE(status.isOK()) << "Session run error: " << status;
+    *schema = engine_test.GetSession()->GetSchema();
+}
+
+void BatchEngineSpillCheck(const SqlCase& sql_case, const EngineOptions& options) {
+    if (!sql_case.expect().success_) {
+        LOG(INFO) << "Skip failure case " << sql_case.id();
+        return;
+    }
+    Schema schema;
+    std::vector<Row> memory_output;
+    ASSERT_NO_FATAL_FAILURE(ComputeBatchOutput(sql_case, options, &schema, &memory_output));
+
+    EngineOptions spill_options = options;
+    // a budget of a byte spills every row, one row per sorted run
+    spill_options.spill_options().SetMemoryBudget(1);
+    Schema spill_schema;
+    std::vector<Row> spill_output;
+    ASSERT_NO_FATAL_FAILURE(ComputeBatchOutput(sql_case, spill_options, &spill_schema, &spill_output));
+
+    // the spilled partitions are read in the order of the in-memory ones, so the
+    // rows are compared as they are output, and LIMIT takes the same rows
+    ASSERT_NO_FATAL_FAILURE(CheckSchema(spill_schema, schema));
+    ASSERT_NO_FATAL_FAILURE(CheckRows(schema, spill_output, memory_output));
+}
+
 int GenerateSqliteTestStringCallback(void* s, int argc, char** argv,
                                      char** azColName) {
     std::string& sqliteStr = *static_cast<std::string*>(s);
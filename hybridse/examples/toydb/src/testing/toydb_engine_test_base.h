@@ -47,6 +47,9 @@ void BatchRequestEngineCheckWithCommonColumnIndices(const SqlCase& sql_case, con
                                                     const std::set<size_t>& common_column_indices);
 void BatchRequestEngineCheck(const SqlCase& sql_case, const EngineOptions options);
 void EngineCheck(const SqlCase& sql_case, const EngineOptions& options, EngineMode engine_mode);
+// Run the batch case in memory and again with every window and group spilling
+// to disk, and check the spilled output equals the in-memory one
+void BatchEngineSpillCheck(const SqlCase& sql_case, const EngineOptions& options);
 
 int GenerateSqliteTestStringCallback(void* s, int argc, char** argv, char** azColName);
 void CheckSqliteCompatible(const SqlCase& sql_case, const vm::Schema& schema, const std::vector<Row>& output);
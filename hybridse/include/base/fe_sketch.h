@@ -0,0 +1,118 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYBRIDSE_INCLUDE_BASE_FE_SKETCH_H_
+#define HYBRIDSE_INCLUDE_BASE_FE_SKETCH_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace hybridse {
+namespace base {
+
+/**
+ * HyperLogLog cardinality sketch.
+ *
+ * Small sets are kept as a sorted list of (register index, rank) pairs and
+ * converted to the dense register array once the list outgrows it, so the
+ * sketch of a short window stays a few bytes. Sketches with the same
+ * precision can be merged, which makes the state usable for pre-aggregation.
+ *
+ * Values must be hashed with the Hash* helpers so that sketches built by the
+ * udaf, the pre-aggregator and the request runner are compatible.
+ */
+class HyperLogLog {
+ public:
+    static constexpr uint8_t kDefaultPrecision = 12;
+    static constexpr uint8_t kMinPrecision = 4;
+    static constexpr uint8_t kMaxPrecision = 18;
+
+    explicit HyperLogLog(uint8_t precision = kDefaultPrecision);
+
+    void Add(uint64_t hash);
+    // return false if the precision of other sketch is different
+    bool Merge(const HyperLogLog& other);
+    uint64_t Estimate() const;
+    void Clear();
+
+    bool IsEmpty() const { return !dense_ && sparse_.empty(); }
+    uint8_t GetPrecision() const { return precision_; }
+    size_t GetByteSize() const;
+
+    void SerializeTo(std::string* output) const;
+    bool ParseFrom(const char* data, size_t size);
+
+    static uint64_t HashInt(int64_t value);
+    static uint64_t HashDouble(double value);
+    static uint64_t HashBytes(const char* data, size_t size);
+
+ private:
+    void ToDense();
+    void MergeSparse(const std::vector<uint32_t>& entries);
+    void SetRegister(uint32_t idx, uint8_t rank);
+
+    uint8_t precision_;
+    bool dense_ = false;
+    // (idx << 8 | rank), sorted by idx, at most one entry for each idx
+    std::vector<uint32_t> sparse_;
+    std::vector<uint8_t> registers_;
+};
+
+/**
+ * KLL quantile sketch over double values.
+ *
+ * Keeps O(k * log(n / k)) items and answers rank queries with an error of
+ * roughly 1.7 / k. Compaction picks the surviving half with an alternating
+ * offset instead of a random one, so results are reproducible.
+ */
+class KllSketch {
+ public:
+    static constexpr uint32_t kDefaultK = 200;
+
+    explicit KllSketch(uint32_t k = kDefaultK);
+
+    void Add(double value);
+    void Merge(const KllSketch& other);
+    // q in [0, 1], return false if the sketch is empty
+    bool Quantile(double q, double* output) const;
+    void Clear();
+
+    uint64_t Count() const { return n_; }
+    bool IsEmpty() const { return n_ == 0; }
+    uint32_t GetK() const { return k_; }
+    size_t GetRetainedItems() const;
+
+    void SerializeTo(std::string* output) const;
+    bool ParseFrom(const char* data, size_t size);
+
+ private:
+    uint32_t LevelCapacity(size_t level) const;
+    void Compress();
+    void CompactLevel(size_t level);
+
+    uint32_t k_;
+    uint64_t n_ = 0;
+    double min_ = 0;
+    double max_ = 0;
+    bool compact_offset_ = false;
+    std::vector<std::vector<double>> levels_;
+};
+
+}  // namespace base
+}  // namespace hybridse
+#endif  // HYBRIDSE_INCLUDE_BASE_FE_SKETCH_H_
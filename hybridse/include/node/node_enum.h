@@ -94,6 +94,7 @@ enum SqlNodeType {
     kCreateFunctionStmt,
     kDynamicUdfFnDef,
     kDynamicUdafFnDef,
+    kIndexHotTTL,
     kUnknow = -1
 };
 
@@ -315,6 +316,7 @@ enum StorageMode {
     kMemory = 1,
     kSSD = 2,
     kHDD = 3,
+    kTiered = 4,
 };
 
 // batch plan node type
@@ -162,6 +162,7 @@ class NodeManager {
     SqlNode *MakeIndexTsNode(const std::string &ts);
     SqlNode *MakeIndexTTLNode(ExprListNode *ttl_expr);
     SqlNode *MakeIndexTTLTypeNode(const std::string &ttl_type);
+    SqlNode *MakeIndexHotTTLNode(int64_t hot_ttl);
     SqlNode *MakeIndexVersionNode(const std::string &version);
     SqlNode *MakeIndexVersionNode(const std::string &version, int count);
 
@@ -394,6 +394,8 @@ inline const std::string StorageModeName(StorageMode mode) {
             return "hdd";
         case kSSD:
             return "ssd";
+        case kTiered:
+            return "tiered";
         default:
             return "unknown";
     }
@@ -406,6 +408,8 @@ inline const StorageMode NameToStorageMode(const std::string& name) {
         return kHDD;
     } else if (boost::iequals(name, "ssd")) {
         return kSSD;
+    } else if (boost::iequals(name, "tiered")) {
+        return kTiered;
     } else {
         return kUnknown;
     }
@@ -1944,6 +1948,17 @@ class IndexTTLTypeNode : public SqlNode {
  private:
     std::string ttl_type_;
 };
+class IndexHotTTLNode : public SqlNode {
+ public:
+    IndexHotTTLNode() : SqlNode(kIndexHotTTL, 0, 0), hot_ttl_(0) {}
+    explicit IndexHotTTLNode(int64_t hot_ttl) : SqlNode(kIndexHotTTL, 0, 0), hot_ttl_(hot_ttl) {}
+
+    // ms of rows kept in memory by tiered storage
+    int64_t GetHotTTL() const { return hot_ttl_; }
+
+ private:
+    int64_t hot_ttl_;
+};
 
 class ColumnIndexNode : public SqlNode {
  public:
@@ -1955,7 +1970,8 @@ class ColumnIndexNode : public SqlNode {
           abs_ttl_(-2),
           lat_ttl_(-2),
           ttl_type_(""),
-          name_("") {}
+          name_(""),
+          hot_ttl_(0) {}
 
     std::vector<std::string> &GetKey() { return key_; }
     void SetKey(const std::vector<std::string> &key) { key_ = key; }
@@ -1983,6 +1999,9 @@ class ColumnIndexNode : public SqlNode {
 
     void SetTTL(ExprListNode *ttl_node_list);
 
+    int64_t GetHotTTL() const { return hot_ttl_; }
+    void SetHotTTL(int64_t hot_ttl) { hot_ttl_ = hot_ttl; }
+
     void Print(std::ostream &output, const std::string &org_tab) const;
 
  private:
@@ -1994,6 +2013,8 @@ class ColumnIndexNode : public SqlNode {
     int64_t lat_ttl_;
     std::string ttl_type_;
     std::string name_;
+    // ms, 0 means all rows are kept in memory
+    int64_t hot_ttl_;
 };
 class CmdNode : public SqlNode {
  public:
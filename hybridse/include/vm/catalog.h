@@ -91,6 +91,9 @@ class DataHandler : public ListV<Row> {
     virtual const std::string GetHandlerTypeName() = 0;
     /// Return dataset status. Default is hybridse::common::kOk
     virtual base::Status GetStatus() { return base::Status::OK(); }
+    /// Return the write version of the underlying table, which is increased by every write.
+    /// Return 0 if the version is unknown, e.g. the data is not backed by a storage table
+    virtual uint64_t GetWriteVersion() { return 0; }
 };
 
 /// \brief A sequence of DataHandler
@@ -34,7 +34,10 @@
 #include "proto/fe_common.pb.h"
 #include "vm/catalog.h"
 #include "vm/engine_context.h"
+#include "vm/memory_tracker.h"
 #include "vm/router.h"
+#include "vm/runner_profile.h"
+#include "vm/subplan_executor.h"
 
 namespace hybridse {
 namespace vm {
@@ -42,6 +45,12 @@ namespace vm {
 using ::hybridse::codec::Row;
 
 inline constexpr const char* LONG_WINDOWS = "long_windows";
+// deployment options of subplan result cache, see SubplanResultCache
+// ttl of cache entries in milliseconds, result cache is enabled if it is set
+inline constexpr const char* RESULT_CACHE_TTL = "result_cache_ttl";
+// max bytes of cache entries
+inline constexpr const char* RESULT_CACHE_SIZE = "result_cache_size";
+inline constexpr uint64_t DEFAULT_RESULT_CACHE_SIZE = 64 * 1024 * 1024;
 
 class Engine;
 /// \brief An options class for controlling engine behaviour.
@@ -113,6 +122,19 @@ class EngineOptions {
         return enable_window_column_pruning_;
     }
 
+    /// Set `true` to enable request pipeline, default `false`.
+    ///
+    /// If set `true`, the chains of row projects, concats and last joins in the
+    /// request mode plan run as one runner without the intermediate row handlers.
+    inline EngineOptions* SetEnableRequestPipeline(bool flag) {
+        enable_request_pipeline_ = flag;
+        return this;
+    }
+    /// Return if the engine support request pipeline.
+    inline bool IsEnableRequestPipeline() const {
+        return enable_request_pipeline_;
+    }
+
     /// Set the maximum number of cache entries, default is `50`.
     inline void SetMaxSqlCacheSize(uint32_t size) {
         max_sql_cache_size_ = size;
@@ -123,6 +145,9 @@ class EngineOptions {
     /// Return JitOptions
     inline hybridse::vm::JitOptions& jit_options() { return jit_options_; }
 
+    /// Return SpillOptions of the batch mode aggregations, spilling is disabled by default
+    inline hybridse::vm::SpillOptions& spill_options() { return spill_options_; }
+
  private:
     bool keep_ir_;
     bool compile_only_;
@@ -132,8 +157,10 @@ class EngineOptions {
     bool enable_expr_optimize_;
     bool enable_batch_window_parallelization_;
     bool enable_window_column_pruning_;
+    bool enable_request_pipeline_;
     uint32_t max_sql_cache_size_;
     JitOptions jit_options_;
+    SpillOptions spill_options_;
 };
 
 /// \brief A RunSession maintain SQL running context, including compile information, procedure name.
@@ -168,7 +195,28 @@ class RunSession {
     /// Disable printing debug information while running a query.
     void DisableDebug() { is_debug_ = false; }
     /// Return if this run session support printing debug information.
-    bool IsDebug() { return is_debug_; }
+    bool IsDebug() const { return is_debug_; }
+
+    /// Enable collecting per-runner execution statistics while running a query.
+    void EnableProfile() { is_profile_ = true; }
+    /// Return if this run session collects per-runner execution statistics.
+    bool IsProfile() const { return is_profile_; }
+    /// Return the runner profile of the last run, null if profile is disabled.
+    std::shared_ptr<RunnerProfile> GetProfile() const { return profile_; }
+
+    /// Limit the memory held by a run in bytes, -1 for unlimited.
+    /// The default is `MemoryTracker::GetDefaultQueryLimit()`.
+    void SetMemoryLimit(int64_t limit) {
+        memory_limit_ = limit;
+        has_memory_limit_ = true;
+    }
+    /// Return the memory tracker of the last run, null if memory was not tracked.
+    /// Memory is tracked if there is a query or process limit, or the run is profiled.
+    std::shared_ptr<MemoryTracker> GetMemoryTracker() const { return memory_tracker_; }
+
+    /// Run the independent subplans of a request with the executor, it is not owned by
+    /// the session. Only request mode runs use it, and not while profiling.
+    void SetSubplanExecutor(SubplanExecutor* executor) { subplan_executor_ = executor; }
 
     /// Bind this run session with specific procedure
     void SetSpName(const std::string& sp_name) { sp_name_ = sp_name; }
@@ -184,9 +232,18 @@ class RunSession {
     }
 
  protected:
+    // the tracker of a new run, null if memory needs not be tracked
+    std::shared_ptr<MemoryTracker> NewMemoryTracker() const;
+
     std::shared_ptr<hybridse::vm::CompileInfo> compile_info_;
     hybridse::vm::EngineMode engine_mode_;
     bool is_debug_;
+    bool is_profile_ = false;
+    std::shared_ptr<RunnerProfile> profile_ = nullptr;
+    bool has_memory_limit_ = false;
+    int64_t memory_limit_ = -1;
+    std::shared_ptr<MemoryTracker> memory_tracker_ = nullptr;
+    SubplanExecutor* subplan_executor_ = nullptr;
     std::string sp_name_;
     std::shared_ptr<const std::unordered_map<std::string, std::string>> options_ = nullptr;
     friend Engine;
@@ -107,6 +107,32 @@ class JitOptions {
     bool enable_gdb_ = false;
     bool enable_perf_ = false;
 };
+
+/// Options of the batch mode window and group aggregations spilling their
+/// partitioned and sorted rows to disk
+class SpillOptions {
+ public:
+    /// Return if spilling is enabled
+    bool IsEnabled() const { return memory_budget_ >= 0; }
+
+    /// The bytes of rows a sort buffers in memory before spilling them to a
+    /// sorted run on disk, -1 to never spill
+    int64_t GetMemoryBudget() const { return memory_budget_; }
+    void SetMemoryBudget(int64_t bytes) { memory_budget_ = bytes; }
+
+    /// The directory of the spill files
+    const std::string& GetDir() const { return dir_; }
+    void SetDir(const std::string& dir) { dir_ = dir; }
+
+    /// The number of threads sorting and writing the runs of one spill
+    uint32_t GetSortThreads() const { return sort_threads_; }
+    void SetSortThreads(uint32_t threads) { sort_threads_ = threads; }
+
+ private:
+    int64_t memory_budget_ = -1;
+    std::string dir_ = "/tmp";
+    uint32_t sort_threads_ = 4;
+};
 }  // namespace vm
 }  // namespace hybridse
 #endif  // HYBRIDSE_INCLUDE_VM_ENGINE_CONTEXT_H_
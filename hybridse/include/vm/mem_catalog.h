@@ -28,6 +28,7 @@
 #include "codec/list_iterator_codec.h"
 #include "glog/logging.h"
 #include "vm/catalog.h"
+#include "vm/memory_tracker.h"
 
 namespace hybridse {
 namespace vm {
@@ -37,19 +38,19 @@ using hybridse::codec::RowIterator;
 using hybridse::codec::WindowIterator;
 
 struct AscKeyComparor {
-    bool operator()(std::pair<std::string, Row> i,
-                    std::pair<std::string, Row> j) {
+    bool operator()(const std::pair<std::string, Row>& i,
+                    const std::pair<std::string, Row>& j) {
         return i.first < j.first;
     }
 };
 struct AscComparor {
-    bool operator()(std::pair<uint64_t, Row> i, std::pair<uint64_t, Row> j) {
+    bool operator()(const std::pair<uint64_t, Row>& i, const std::pair<uint64_t, Row>& j) {
         return i.first < j.first;
     }
 };
 
 struct DescComparor {
-    bool operator()(std::pair<uint64_t, Row> i, std::pair<uint64_t, Row> j) {
+    bool operator()(const std::pair<uint64_t, Row>& i, const std::pair<uint64_t, Row>& j) {
         return i.first > j.first;
     }
 };
@@ -59,6 +60,16 @@ typedef std::vector<Row> MemTable;
 typedef std::map<std::string, MemTimeTable, std::greater<std::string>>
     MemSegmentMap;
 
+// the memory charged for a row held by a handler: the entry and the row
+// slices, a slice shared by several handlers is charged by each of them
+inline int64_t RowMemoryBytes(const Row& row) {
+    int64_t bytes = sizeof(std::pair<uint64_t, Row>);
+    for (int32_t pos = 0; pos < row.GetRowPtrCnt(); pos++) {
+        bytes += row.size(pos);
+    }
+    return bytes;
+}
+
 class MemTimeTableIterator : public RowIterator {
  public:
     MemTimeTableIterator(const MemTimeTable* table, const vm::Schema* schema);
@@ -178,6 +189,9 @@ class MemTableHandler : public TableHandler {
     const std::string GetHandlerTypeName() override {
         return "MemTableHandler";
     }
+    // charge the rows to `tracker`, null to stop tracking
+    void SetMemoryTracker(const std::shared_ptr<MemoryTracker>& tracker) { memory_.SetTracker(tracker); }
+    const std::shared_ptr<MemoryTracker>& GetMemoryTracker() const { return memory_.tracker(); }
 
  protected:
     void Resize(const size_t size);
@@ -189,6 +203,7 @@ class MemTableHandler : public TableHandler {
     IndexHint index_hint_;
     MemTable table_;
     OrderType order_type_;
+    MemoryReservation memory_;
 };
 
 class MemTimeTableHandler : public TableHandler {
@@ -228,6 +243,9 @@ class MemTimeTableHandler : public TableHandler {
     const std::string GetHandlerTypeName() override {
         return "MemTimeTableHandler";
     }
+    // charge the rows to `tracker`, null to stop tracking
+    void SetMemoryTracker(const std::shared_ptr<MemoryTracker>& tracker) { memory_.SetTracker(tracker); }
+    const std::shared_ptr<MemoryTracker>& GetMemoryTracker() const { return memory_.tracker(); }
 
  protected:
     const std::string table_name_;
@@ -237,6 +255,7 @@ class MemTimeTableHandler : public TableHandler {
     IndexHint index_hint_;
     MemTimeTable table_;
     OrderType order_type_;
+    MemoryReservation memory_;
 };
 
 class Window : public MemTimeTableHandler {
@@ -372,6 +391,7 @@ class HistoryWindow : public Window {
         if (current_history_buffer_.empty()) {
             PopFrontRow();
         } else {
+            memory_.Shrink(RowMemoryBytes(current_history_buffer_.front().second));
             current_history_buffer_.pop_front();
         }
     }
@@ -412,6 +432,7 @@ class HistoryWindow : public Window {
     bool BufferCurrentHistoryBuffer(uint64_t key, const Row& row,
                                     uint64_t end_ts) {
         current_history_buffer_.emplace_front(key, row);
+        memory_.Grow(RowMemoryBytes(row));
         int64_t sub = (key + window_range_.start_offset_);
         uint64_t start_ts = sub < 0 ? 0u : static_cast<uint64_t>(sub);
         while (!current_history_buffer_.empty()) {
@@ -420,9 +441,10 @@ class HistoryWindow : public Window {
                 break;
             }
             BufferEffectiveWindow(back.first, back.second, start_ts);
+            memory_.Shrink(RowMemoryBytes(back.second));
             current_history_buffer_.pop_back();
         }
-        return true;
+        return !MemoryLimitExceeded();
     }
 
     bool BufferEffectiveWindow(uint64_t key, const Row& row,
@@ -452,7 +474,7 @@ class HistoryWindow : public Window {
                 break;
             }
         }
-        return true;
+        return !MemoryLimitExceeded();
     }
     bool BufferCurrentTimeBuffer(uint64_t key, const Row& row,
                                  uint64_t start_ts) {
@@ -464,6 +486,14 @@ class HistoryWindow : public Window {
             return BufferEffectiveWindow(key, row, start_ts);
         }
     }
+    // the buffered rows are kept, the caller fails the window
+    bool MemoryLimitExceeded() const {
+        if (memory_.LimitExceeded()) {
+            DLOG(WARNING) << "Fail BufferData: memory limit exceeded";
+            return true;
+        }
+        return false;
+    }
     WindowRange window_range_;
     MemTimeTable current_history_buffer_;
 };
@@ -609,6 +639,7 @@ class MemPartitionHandler
     const std::string& GetName() override;
     const std::string& GetDatabase() override;
     virtual std::unique_ptr<WindowIterator> GetWindowIterator();
+    // return false if the rows exceed the limit of the memory tracker, the row is added anyway
     bool AddRow(const std::string& key, uint64_t ts, const Row& row);
     void Sort(const bool is_asc);
     void Reverse();
@@ -623,6 +654,8 @@ class MemPartitionHandler
     const std::string GetHandlerTypeName() override {
         return "MemPartitionHandler";
     }
+    // charge the rows to `tracker`, null to stop tracking
+    void SetMemoryTracker(const std::shared_ptr<MemoryTracker>& tracker) { memory_.SetTracker(tracker); }
 
  private:
     std::string table_name_;
@@ -632,6 +665,7 @@ class MemPartitionHandler
     Types types_;
     IndexHint index_hint_;
     OrderType order_type_;
+    MemoryReservation memory_;
 };
 class ConcatTableHandler : public MemTimeTableHandler {
  public:
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYBRIDSE_INCLUDE_VM_MEMORY_TRACKER_H_
+#define HYBRIDSE_INCLUDE_VM_MEMORY_TRACKER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace hybridse {
+namespace vm {
+
+/// \brief MemoryTracker accounts the memory held by query execution in a tree:
+/// process -> query -> runner. Consuming bytes on a tracker charges all its
+/// ancestors, so a query tracker sums its runners, and the process tracker
+/// sums all the running queries.
+///
+/// A tracker with a non-negative limit is exceeded once its consumption goes
+/// beyond the limit. Consume never fails, the allocation has been done anyway;
+/// it marks the trackers from the consumer up to the exceeded one, and the
+/// handlers stop growing and the runners check the query tracker between two
+/// runners to fail the query. The process tracker is never marked, it only makes
+/// the query which crosses its limit fail.
+///
+/// Trackers are passed explicitly: the runner context creates a tracker for each
+/// runner, and a runner hands it to the handlers it builds.
+class MemoryTracker : public std::enable_shared_from_this<MemoryTracker> {
+ public:
+    /// The root tracker of all queries, unlimited by default
+    static MemoryTracker* Process();
+
+    /// The limit of a new query tracker, -1 for unlimited
+    static int64_t GetDefaultQueryLimit();
+    static void SetDefaultQueryLimit(int64_t limit);
+
+    /// Create a tracker under `parent`, or under the process tracker if `parent` is null
+    static std::shared_ptr<MemoryTracker> Create(const std::string& label, int64_t limit,
+                                                 std::shared_ptr<MemoryTracker> parent = nullptr);
+
+    MemoryTracker(const MemoryTracker&) = delete;
+    MemoryTracker& operator=(const MemoryTracker&) = delete;
+
+    /// Charge `bytes` to the tracker and its ancestors, return false if a limit is exceeded
+    bool Consume(int64_t bytes);
+    void Release(int64_t bytes);
+
+    const std::string& label() const { return label_; }
+    int64_t limit() const { return limit_.load(std::memory_order_relaxed); }
+    void SetLimit(int64_t limit) { limit_.store(limit, std::memory_order_relaxed); }
+    int64_t consumption() const { return consumption_.load(std::memory_order_relaxed); }
+    int64_t peak() const { return peak_.load(std::memory_order_relaxed); }
+    bool LimitExceeded() const { return exceeded_.load(std::memory_order_relaxed); }
+
+    std::string ToString() const;
+
+ private:
+    MemoryTracker(const std::string& label, int64_t limit, std::shared_ptr<MemoryTracker> parent);
+
+    const std::string label_;
+    std::atomic<int64_t> limit_;
+    std::atomic<int64_t> consumption_{0};
+    std::atomic<int64_t> peak_{0};
+    std::atomic<bool> exceeded_{false};
+    // null for the process tracker
+    const std::shared_ptr<MemoryTracker> parent_;
+};
+
+/// \brief MemoryReservation charges the memory of one data structure, e.g. the
+/// rows of a table handler, to a tracker. It reserves a quarter more than it
+/// uses (and 4KB at least) from the tracker, so growing and shrinking by a row
+/// does not touch the shared counters. It is not thread safe, and it does
+/// nothing without a tracker.
+class MemoryReservation {
+ public:
+    MemoryReservation() {}
+    explicit MemoryReservation(std::shared_ptr<MemoryTracker> tracker) : tracker_(std::move(tracker)) {}
+    // a copy charges the same bytes again, to the same tracker
+    MemoryReservation(const MemoryReservation& other) : tracker_(other.tracker_) { Grow(other.used_); }
+    ~MemoryReservation();
+
+    MemoryReservation& operator=(const MemoryReservation&) = delete;
+
+    inline void Grow(int64_t bytes) {
+        used_ += bytes;
+        if (tracker_ && used_ > reserved_) {
+            Resize();
+        }
+    }
+    inline void Shrink(int64_t bytes) {
+        used_ -= bytes;
+        if (tracker_ && reserved_ - used_ > used_ + 2 * kMinSlackBytes) {
+            Resize();
+        }
+    }
+    // charge the used bytes to `tracker` instead, null to stop tracking
+    void SetTracker(std::shared_ptr<MemoryTracker> tracker);
+    const std::shared_ptr<MemoryTracker>& tracker() const { return tracker_; }
+    // true if charging the tracker has exceeded its limit or the limit of an ancestor
+    bool LimitExceeded() const { return tracker_ && tracker_->LimitExceeded(); }
+    int64_t used() const { return used_; }
+    int64_t reserved() const { return reserved_; }
+
+ private:
+    static constexpr int64_t kMinSlackBytes = 4096;
+
+    // reserve the used bytes and the slack
+    void Resize();
+
+    std::shared_ptr<MemoryTracker> tracker_;
+    int64_t used_ = 0;
+    int64_t reserved_ = 0;
+};
+
+}  // namespace vm
+}  // namespace hybridse
+#endif  // HYBRIDSE_INCLUDE_VM_MEMORY_TRACKER_H_
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYBRIDSE_INCLUDE_VM_RUNNER_PROFILE_H_
+#define HYBRIDSE_INCLUDE_VM_RUNNER_PROFILE_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace hybridse {
+namespace vm {
+
+/// Execution statistics of one runner.
+/// Times are exclusive: time spent in nested runners is not included.
+/// Since most runners output lazy data handlers, the cost of iterating a lazy
+/// output is attributed to the runner which consumes it. Cpu time is of the
+/// current thread, it is less precise if the run is switched between threads,
+/// e.g. a bthread waiting for a remote sub-query. Peak memory is the max of the
+/// runs, it is only collected if memory is tracked.
+struct RunnerStat {
+    uint64_t calls = 0;
+    uint64_t cache_hits = 0;
+    // hits and misses of the cross-request result cache
+    uint64_t result_cache_hits = 0;
+    uint64_t result_cache_misses = 0;
+    uint64_t wall_ns = 0;
+    uint64_t cpu_ns = 0;
+    int64_t peak_memory_bytes = 0;
+
+    void Merge(const RunnerStat& other) {
+        calls += other.calls;
+        cache_hits += other.cache_hits;
+        result_cache_hits += other.result_cache_hits;
+        result_cache_misses += other.result_cache_misses;
+        wall_ns += other.wall_ns;
+        cpu_ns += other.cpu_ns;
+        peak_memory_bytes = std::max(peak_memory_bytes, other.peak_memory_bytes);
+    }
+};
+
+/// \brief RunnerProfile collects per-runner wall and cpu time of one or more
+/// runs of the same compiled plan. It is not thread safe, one profile is
+/// filled by one run session.
+class RunnerProfile {
+ public:
+    RunnerProfile() {}
+    ~RunnerProfile() {}
+
+    void Record(int32_t runner_id, uint64_t wall_ns, uint64_t cpu_ns);
+    void RecordCacheHit(int32_t runner_id);
+    void RecordResultCache(int32_t runner_id, bool hit);
+    void RecordPeakMemory(int32_t runner_id, int64_t bytes);
+
+    /// Set the runner tree to print, each line is (runner id, runner info with indent)
+    void SetPlan(const std::vector<std::pair<int32_t, std::string>>& plan) { plan_ = plan; }
+    const std::vector<std::pair<int32_t, std::string>>& GetPlan() const { return plan_; }
+
+    /// Record the cost of the whole run, including the output extraction
+    void RecordTotal(uint64_t wall_ns, uint64_t cpu_ns);
+    void RecordTotalPeakMemory(int64_t bytes);
+
+    /// Merge another profile of the same plan
+    void Merge(const RunnerProfile& other);
+
+    const std::map<int32_t, RunnerStat>& GetStats() const { return stats_; }
+    const RunnerStat& GetTotal() const { return total_; }
+
+    /// Print the runner tree annotated with statistics, like EXPLAIN ANALYZE
+    std::string ToString() const;
+
+ private:
+    friend class RunnerProfileGuard;
+
+    std::vector<std::pair<int32_t, std::string>> plan_;
+    std::map<int32_t, RunnerStat> stats_;
+    RunnerStat total_;
+    // time of nested guards, used to compute exclusive time
+    uint64_t nested_wall_ns_ = 0;
+    uint64_t nested_cpu_ns_ = 0;
+};
+
+/// \brief RAII guard which records the exclusive time of a runner into profile.
+/// Do nothing if profile is null.
+class RunnerProfileGuard {
+ public:
+    RunnerProfileGuard(RunnerProfile* profile, int32_t runner_id);
+    ~RunnerProfileGuard();
+
+    static uint64_t WallNs();
+    static uint64_t ThreadCpuNs();
+
+ private:
+    RunnerProfile* profile_;
+    const int32_t runner_id_;
+    uint64_t start_wall_ns_ = 0;
+    uint64_t start_cpu_ns_ = 0;
+    uint64_t saved_nested_wall_ns_ = 0;
+    uint64_t saved_nested_cpu_ns_ = 0;
+};
+
+}  // namespace vm
+}  // namespace hybridse
+#endif  // HYBRIDSE_INCLUDE_VM_RUNNER_PROFILE_H_
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYBRIDSE_INCLUDE_VM_SUBPLAN_EXECUTOR_H_
+#define HYBRIDSE_INCLUDE_VM_SUBPLAN_EXECUTOR_H_
+
+#include <functional>
+#include <vector>
+
+namespace hybridse {
+namespace vm {
+
+/// \brief SubplanExecutor runs the independent subplans of one request concurrently.
+///
+/// A request plan is evaluated depth-first on the calling thread by default. When an
+/// executor is set on the run session, runners whose producers are independent and
+/// access data, e.g. two windows over different tables, run the producers with the
+/// executor, and the remote sub-queries are issued before the local subplans run.
+class SubplanExecutor {
+ public:
+    virtual ~SubplanExecutor() {}
+
+    /// Run all the tasks and return after all of them are done. Tasks may block on
+    /// remote sub-queries. The calling thread may run one of the tasks itself.
+    virtual void RunAll(const std::vector<std::function<void()>>& tasks) = 0;
+};
+
+}  // namespace vm
+}  // namespace hybridse
+#endif  // HYBRIDSE_INCLUDE_VM_SUBPLAN_EXECUTOR_H_
@@ -0,0 +1,413 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "base/fe_sketch.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "base/fe_hash.h"
+
+namespace hybridse {
+namespace base {
+
+static constexpr uint32_t kSketchHashSeed = 0xe17a1465;
+static constexpr uint8_t kHllSparse = 0;
+static constexpr uint8_t kHllDense = 1;
+
+template <typename T>
+static void AppendValue(std::string* output, T value) {
+    output->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+static bool ReadValue(const char** data, size_t* size, T* value) {
+    if (*size < sizeof(T)) {
+        return false;
+    }
+    memcpy(value, *data, sizeof(T));
+    *data += sizeof(T);
+    *size -= sizeof(T);
+    return true;
+}
+
+HyperLogLog::HyperLogLog(uint8_t precision)
+    : precision_(std::min(std::max(precision, kMinPrecision), kMaxPrecision)) {}
+
+uint64_t HyperLogLog::HashInt(int64_t value) {
+    return MurmurHash64A(&value, sizeof(value), kSketchHashSeed);
+}
+
+uint64_t HyperLogLog::HashDouble(double value) {
+    // -0.0 and 0.0 are the same value
+    if (value == 0) {
+        value = 0;
+    }
+    return MurmurHash64A(&value, sizeof(value), kSketchHashSeed);
+}
+
+uint64_t HyperLogLog::HashBytes(const char* data, size_t size) {
+    return MurmurHash64A(data, static_cast<int>(size), kSketchHashSeed);
+}
+
+void HyperLogLog::Add(uint64_t hash) {
+    uint32_t idx = static_cast<uint32_t>(hash >> (64 - precision_));
+    // leading zeros of the remaining bits, the guard bit limits the rank
+    uint64_t w = (hash << precision_) | (1ull << (precision_ - 1));
+    uint8_t rank = static_cast<uint8_t>(__builtin_clzll(w) + 1);
+    SetRegister(idx, rank);
+}
+
+void HyperLogLog::SetRegister(uint32_t idx, uint8_t rank) {
+    if (dense_) {
+        if (registers_[idx] < rank) {
+            registers_[idx] = rank;
+        }
+        return;
+    }
+    uint32_t entry = idx << 8 | rank;
+    auto it = std::lower_bound(sparse_.begin(), sparse_.end(), idx << 8);
+    if (it != sparse_.end() && (*it >> 8) == idx) {
+        if ((*it & 0xff) < rank) {
+            *it = entry;
+        }
+        return;
+    }
+    sparse_.insert(it, entry);
+    // sparse entry takes 4 bytes while dense register takes 1 byte
+    if (sparse_.size() * sizeof(uint32_t) > (1u << precision_)) {
+        ToDense();
+    }
+}
+
+void HyperLogLog::ToDense() {
+    registers_.assign(1u << precision_, 0);
+    for (auto entry : sparse_) {
+        registers_[entry >> 8] = entry & 0xff;
+    }
+    sparse_.clear();
+    sparse_.shrink_to_fit();
+    dense_ = true;
+}
+
+void HyperLogLog::MergeSparse(const std::vector<uint32_t>& entries) {
+    for (auto entry : entries) {
+        SetRegister(entry >> 8, entry & 0xff);
+    }
+}
+
+bool HyperLogLog::Merge(const HyperLogLog& other) {
+    if (other.precision_ != precision_) {
+        return false;
+    }
+    if (!other.dense_) {
+        MergeSparse(other.sparse_);
+        return true;
+    }
+    if (!dense_) {
+        ToDense();
+    }
+    for (size_t i = 0; i < registers_.size(); ++i) {
+        registers_[i] = std::max(registers_[i], other.registers_[i]);
+    }
+    return true;
+}
+
+uint64_t HyperLogLog::Estimate() const {
+    if (IsEmpty()) {
+        return 0;
+    }
+    double m = static_cast<double>(1u << precision_);
+    double sum = 0;
+    uint32_t zeros = 0;
+    if (dense_) {
+        for (auto r : registers_) {
+            sum += std::ldexp(1.0, -r);
+            zeros += r == 0;
+        }
+    } else {
+        zeros = (1u << precision_) - sparse_.size();
+        sum = zeros;
+        for (auto entry : sparse_) {
+            sum += std::ldexp(1.0, -static_cast<int>(entry & 0xff));
+        }
+    }
+    double alpha;
+    switch (precision_) {
+        case 4:
+            alpha = 0.673;
+            break;
+        case 5:
+            alpha = 0.697;
+            break;
+        case 6:
+            alpha = 0.709;
+            break;
+        default:
+            alpha = 0.7213 / (1 + 1.079 / m);
+    }
+    double estimate = alpha * m * m / sum;
+    // linear counting is much more precise for small cardinality
+    if (estimate <= 2.5 * m && zeros > 0) {
+        estimate = m * std::log(m / zeros);
+    }
+    return static_cast<uint64_t>(std::llround(estimate));
+}
+
+void HyperLogLog::Clear() {
+    dense_ = false;
+    sparse_.clear();
+    registers_.clear();
+}
+
+size_t HyperLogLog::GetByteSize() const {
+    return dense_ ? registers_.size() : sparse_.size() * sizeof(uint32_t);
+}
+
+void HyperLogLog::SerializeTo(std::string* output) const {
+    output->clear();
+    output->reserve(2 + sizeof(uint32_t) + GetByteSize());
+    output->push_back(static_cast<char>(dense_ ? kHllDense : kHllSparse));
+    output->push_back(static_cast<char>(precision_));
+    if (dense_) {
+        output->append(reinterpret_cast<const char*>(registers_.data()), registers_.size());
+    } else {
+        AppendValue<uint32_t>(output, sparse_.size());
+        for (auto entry : sparse_) {
+            AppendValue<uint32_t>(output, entry);
+        }
+    }
+}
+
+bool HyperLogLog::ParseFrom(const char* data, size_t size) {
+    uint8_t format = 0;
+    uint8_t precision = 0;
+    if (!ReadValue(&data, &size, &format) || !ReadValue(&data, &size, &precision)) {
+        return false;
+    }
+    if (precision < kMinPrecision || precision > kMaxPrecision) {
+        return false;
+    }
+    uint32_t m = 1u << precision;
+    if (format == kHllDense) {
+        if (size != m) {
+            return false;
+        }
+        precision_ = precision;
+        registers_.assign(data, data + size);
+        sparse_.clear();
+        dense_ = true;
+        return true;
+    } else if (format == kHllSparse) {
+        uint32_t cnt = 0;
+        if (!ReadValue(&data, &size, &cnt) || size != cnt * sizeof(uint32_t)) {
+            return false;
+        }
+        std::vector<uint32_t> entries(cnt);
+        memcpy(entries.data(), data, size);
+        for (size_t i = 0; i < cnt; ++i) {
+            if ((entries[i] >> 8) >= m || (i > 0 && (entries[i - 1] >> 8) >= (entries[i] >> 8))) {
+                return false;
+            }
+        }
+        precision_ = precision;
+        Clear();
+        sparse_ = std::move(entries);
+        return true;
+    }
+    return false;
+}
+
+KllSketch::KllSketch(uint32_t k) : k_(std::max(k, 8u)), levels_(1) {}
+
+uint32_t KllSketch::LevelCapacity(size_t level) const {
+    size_t depth = levels_.size() - level - 1;
+    double cap = std::ceil(k_ * std::pow(2.0 / 3.0, static_cast<double>(depth)));
+    return std::max(2u, static_cast<uint32_t>(cap));
+}
+
+size_t KllSketch::GetRetainedItems() const {
+    size_t cnt = 0;
+    for (auto& level : levels_) {
+        cnt += level.size();
+    }
+    return cnt;
+}
+
+void KllSketch::Add(double value) {
+    if (std::isnan(value)) {
+        return;
+    }
+    if (n_ == 0) {
+        min_ = max_ = value;
+    } else {
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+    }
+    n_++;
+    levels_[0].push_back(value);
+    if (levels_[0].size() >= LevelCapacity(0)) {
+        Compress();
+    }
+}
+
+void KllSketch::Compress() {
+    for (size_t level = 0; level < levels_.size(); ++level) {
+        if (levels_[level].size() >= LevelCapacity(level)) {
+            CompactLevel(level);
+        }
+    }
+}
+
+void KllSketch::CompactLevel(size_t level) {
+    if (level + 1 == levels_.size()) {
+        levels_.emplace_back();
+    }
+    auto& items = levels_[level];
+    auto& upper = levels_[level + 1];
+    std::sort(items.begin(), items.end());
+    // an odd item stays in current level with its original weight
+    size_t pairs = items.size() / 2;
+    size_t offset = compact_offset_ ? 1 : 0;
+    compact_offset_ = !compact_offset_;
+    for (size_t i = 0; i < pairs; ++i) {
+        upper.push_back(items[2 * i + offset]);
+    }
+    if (items.size() % 2 == 1) {
+        items[0] = items.back();
+        items.resize(1);
+    } else {
+        items.clear();
+    }
+}
+
+void KllSketch::Merge(const KllSketch& other) {
+    if (other.n_ == 0) {
+        return;
+    }
+    if (n_ == 0) {
+        min_ = other.min_;
+        max_ = other.max_;
+    } else {
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+    n_ += other.n_;
+    k_ = std::min(k_, other.k_);
+    if (levels_.size() < other.levels_.size()) {
+        levels_.resize(other.levels_.size());
+    }
+    for (size_t i = 0; i < other.levels_.size(); ++i) {
+        levels_[i].insert(levels_[i].end(), other.levels_[i].begin(), other.levels_[i].end());
+    }
+    Compress();
+}
+
+bool KllSketch::Quantile(double q, double* output) const {
+    if (n_ == 0) {
+        return false;
+    }
+    if (q <= 0) {
+        *output = min_;
+        return true;
+    } else if (q >= 1) {
+        *output = max_;
+        return true;
+    }
+    std::vector<std::pair<double, uint64_t>> items;
+    items.reserve(GetRetainedItems());
+    uint64_t total = 0;
+    for (size_t level = 0; level < levels_.size(); ++level) {
+        uint64_t weight = 1ull << level;
+        for (auto v : levels_[level]) {
+            items.emplace_back(v, weight);
+            total += weight;
+        }
+    }
+    std::sort(items.begin(), items.end());
+    double target = q * static_cast<double>(total);
+    uint64_t acc = 0;
+    for (auto& item : items) {
+        acc += item.second;
+        if (static_cast<double>(acc) >= target) {
+            *output = item.first;
+            return true;
+        }
+    }
+    *output = max_;
+    return true;
+}
+
+void KllSketch::Clear() {
+    n_ = 0;
+    min_ = max_ = 0;
+    compact_offset_ = false;
+    levels_.assign(1, {});
+}
+
+void KllSketch::SerializeTo(std::string* output) const {
+    output->clear();
+    AppendValue<uint32_t>(output, k_);
+    AppendValue<uint64_t>(output, n_);
+    AppendValue<double>(output, min_);
+    AppendValue<double>(output, max_);
+    AppendValue<uint32_t>(output, levels_.size());
+    for (auto& level : levels_) {
+        AppendValue<uint32_t>(output, level.size());
+        output->append(reinterpret_cast<const char*>(level.data()), level.size() * sizeof(double));
+    }
+}
+
+bool KllSketch::ParseFrom(const char* data, size_t size) {
+    uint32_t k = 0;
+    uint64_t n = 0;
+    double min = 0;
+    double max = 0;
+    uint32_t level_cnt = 0;
+    if (!ReadValue(&data, &size, &k) || !ReadValue(&data, &size, &n) || !ReadValue(&data, &size, &min) ||
+        !ReadValue(&data, &size, &max) || !ReadValue(&data, &size, &level_cnt)) {
+        return false;
+    }
+    if (level_cnt == 0 || level_cnt > 64) {
+        return false;
+    }
+    std::vector<std::vector<double>> levels(level_cnt);
+    for (auto& level : levels) {
+        uint32_t cnt = 0;
+        if (!ReadValue(&data, &size, &cnt) || size < cnt * sizeof(double)) {
+            return false;
+        }
+        level.resize(cnt);
+        memcpy(level.data(), data, cnt * sizeof(double));
+        data += cnt * sizeof(double);
+        size -= cnt * sizeof(double);
+    }
+    if (size != 0) {
+        return false;
+    }
+    k_ = std::max(k, 8u);
+    n_ = n;
+    min_ = min;
+    max_ = max;
+    levels_ = std::move(levels);
+    return true;
+}
+
+}  // namespace base
+}  // namespace hybridse
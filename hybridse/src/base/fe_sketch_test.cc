@@ -0,0 +1,164 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "base/fe_sketch.h"
+
+#include <cmath>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace hybridse {
+namespace base {
+
+class SketchTest : public ::testing::Test {};
+
+TEST_F(SketchTest, HyperLogLogSmall) {
+    HyperLogLog hll;
+    ASSERT_TRUE(hll.IsEmpty());
+    ASSERT_EQ(0u, hll.Estimate());
+    for (int i = 0; i < 10; ++i) {
+        hll.Add(HyperLogLog::HashInt(i % 5));
+    }
+    ASSERT_EQ(5u, hll.Estimate());
+    ASSERT_EQ(HyperLogLog::HashDouble(0.0), HyperLogLog::HashDouble(-0.0));
+    std::string str = "hello";
+    ASSERT_EQ(HyperLogLog::HashBytes(str.data(), str.size()), HyperLogLog::HashBytes("hello", 5));
+}
+
+TEST_F(SketchTest, HyperLogLogLarge) {
+    HyperLogLog hll;
+    const int64_t n = 100000;
+    for (int64_t i = 0; i < n; ++i) {
+        hll.Add(HyperLogLog::HashInt(i));
+    }
+    // standard error of precision 12 is about 1.6%
+    ASSERT_NEAR(static_cast<double>(n), static_cast<double>(hll.Estimate()), n * 0.05);
+    ASSERT_EQ(4096u, hll.GetByteSize());
+}
+
+TEST_F(SketchTest, HyperLogLogMerge) {
+    HyperLogLog hll1;
+    HyperLogLog hll2;
+    HyperLogLog all;
+    for (int64_t i = 0; i < 20000; ++i) {
+        hll1.Add(HyperLogLog::HashInt(i));
+        all.Add(HyperLogLog::HashInt(i));
+    }
+    for (int64_t i = 10000; i < 30000; ++i) {
+        hll2.Add(HyperLogLog::HashInt(i));
+        all.Add(HyperLogLog::HashInt(i));
+    }
+    HyperLogLog small;
+    small.Add(HyperLogLog::HashInt(1));
+    ASSERT_TRUE(hll1.Merge(hll2));
+    ASSERT_TRUE(hll1.Merge(small));
+    ASSERT_EQ(all.Estimate(), hll1.Estimate());
+
+    HyperLogLog other(10);
+    ASSERT_FALSE(hll1.Merge(other));
+}
+
+TEST_F(SketchTest, HyperLogLogSerialize) {
+    HyperLogLog sparse;
+    for (int64_t i = 0; i < 100; ++i) {
+        sparse.Add(HyperLogLog::HashInt(i));
+    }
+    HyperLogLog dense;
+    for (int64_t i = 0; i < 10000; ++i) {
+        dense.Add(HyperLogLog::HashInt(i));
+    }
+    for (auto hll : {&sparse, &dense}) {
+        std::string buf;
+        hll->SerializeTo(&buf);
+        HyperLogLog parsed;
+        ASSERT_TRUE(parsed.ParseFrom(buf.data(), buf.size()));
+        ASSERT_EQ(hll->Estimate(), parsed.Estimate());
+        ASSERT_FALSE(parsed.ParseFrom(buf.data(), buf.size() - 1));
+    }
+    HyperLogLog empty;
+    std::string buf;
+    empty.SerializeTo(&buf);
+    ASSERT_EQ(6u, buf.size());
+    HyperLogLog parsed;
+    ASSERT_TRUE(parsed.ParseFrom(buf.data(), buf.size()));
+    ASSERT_TRUE(parsed.IsEmpty());
+}
+
+TEST_F(SketchTest, KllSketchQuantile) {
+    KllSketch kll;
+    double output = 0;
+    ASSERT_FALSE(kll.Quantile(0.5, &output));
+    const int n = 100000;
+    for (int i = n; i > 0; --i) {
+        kll.Add(i);
+    }
+    ASSERT_EQ(static_cast<uint64_t>(n), kll.Count());
+    ASSERT_LT(kll.GetRetainedItems(), 2000u);
+    ASSERT_TRUE(kll.Quantile(0, &output));
+    ASSERT_EQ(1.0, output);
+    ASSERT_TRUE(kll.Quantile(1, &output));
+    ASSERT_EQ(static_cast<double>(n), output);
+    for (double q : {0.1, 0.5, 0.9, 0.99}) {
+        ASSERT_TRUE(kll.Quantile(q, &output));
+        ASSERT_NEAR(q * n, output, n * 0.02) << "q=" << q;
+    }
+}
+
+TEST_F(SketchTest, KllSketchExactForSmallInput) {
+    KllSketch kll;
+    for (int i = 1; i <= 5; ++i) {
+        kll.Add(i);
+    }
+    double output = 0;
+    ASSERT_TRUE(kll.Quantile(0.5, &output));
+    ASSERT_EQ(3.0, output);
+    kll.Add(std::nan(""));
+    ASSERT_EQ(5u, kll.Count());
+}
+
+TEST_F(SketchTest, KllSketchMergeAndSerialize) {
+    KllSketch kll1;
+    KllSketch kll2;
+    for (int i = 0; i < 50000; ++i) {
+        kll1.Add(i);
+        kll2.Add(50000 + i);
+    }
+    kll1.Merge(kll2);
+    kll1.Merge(KllSketch());
+    ASSERT_EQ(100000u, kll1.Count());
+    double output = 0;
+    ASSERT_TRUE(kll1.Quantile(0.5, &output));
+    ASSERT_NEAR(50000, output, 2000);
+
+    std::string buf;
+    kll1.SerializeTo(&buf);
+    KllSketch parsed;
+    ASSERT_TRUE(parsed.ParseFrom(buf.data(), buf.size()));
+    ASSERT_EQ(kll1.Count(), parsed.Count());
+    double parsed_output = 0;
+    ASSERT_TRUE(parsed.Quantile(0.5, &parsed_output));
+    ASSERT_EQ(output, parsed_output);
+    ASSERT_FALSE(parsed.ParseFrom(buf.data(), buf.size() - 1));
+}
+
+}  // namespace base
+}  // namespace hybridse
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -74,6 +74,30 @@ static void BM_DateToString(benchmark::State& state) {  // NOLINT
 static void BM_DateFormat(benchmark::State& state) {  // NOLINT
     DateFormat(&state, BENCHMARK);
 }
+static void BM_LikeMatchExact(benchmark::State& state) {  // NOLINT
+    LikeMatch(&state, BENCHMARK, "openmldb_user_0123456789@example.com");
+}
+static void BM_LikeMatchPrefix(benchmark::State& state) {  // NOLINT
+    LikeMatch(&state, BENCHMARK, "openmldb%");
+}
+static void BM_LikeMatchSuffix(benchmark::State& state) {  // NOLINT
+    LikeMatch(&state, BENCHMARK, "%example.com");
+}
+static void BM_LikeMatchContains(benchmark::State& state) {  // NOLINT
+    LikeMatch(&state, BENCHMARK, "%0123456789%");
+}
+static void BM_LikeMatchGeneral(benchmark::State& state) {  // NOLINT
+    LikeMatch(&state, BENCHMARK, "open%user__1%@%.com");
+}
+static void BM_ILikeMatchContains(benchmark::State& state) {  // NOLINT
+    ILikeMatch(&state, BENCHMARK, "%USER%");
+}
+static void BM_RegexpLike(benchmark::State& state) {  // NOLINT
+    RegexpLike(&state, BENCHMARK);
+}
+static void BM_RegexpExtract(benchmark::State& state) {  // NOLINT
+    RegexpExtract(&state, BENCHMARK);
+}
 
 static void BM_AllocFromByteMemPool1000(benchmark::State& state) {  // NOLINT
     ByteMemPoolAlloc1000(&state, BENCHMARK, state.range(0));
@@ -162,6 +186,15 @@ BENCHMARK(BM_TimestampToString);
 BENCHMARK(BM_DateFormat);
 BENCHMARK(BM_DateToString);
 
+BENCHMARK(BM_LikeMatchExact);
+BENCHMARK(BM_LikeMatchPrefix);
+BENCHMARK(BM_LikeMatchSuffix);
+BENCHMARK(BM_LikeMatchContains);
+BENCHMARK(BM_LikeMatchGeneral);
+BENCHMARK(BM_ILikeMatchContains);
+BENCHMARK(BM_RegexpLike);
+BENCHMARK(BM_RegexpExtract);
+
 BENCHMARK(BM_HistoryWindowBuffer)
     ->Args({10})
     ->Args({100})
@@ -590,6 +590,93 @@ void DateToString(benchmark::State* state, MODE mode) {
         }
     }
 }
+
+// every pattern in benchmark is expected to match the target
+static const char* kMatchTarget = "openmldb_user_0123456789@example.com";
+void LikeMatch(benchmark::State* state, MODE mode, const std::string& pattern) {
+    codec::StringRef name(kMatchTarget);
+    codec::StringRef pattern_ref(pattern);
+    bool out = false;
+    bool is_null = false;
+    switch (mode) {
+        case BENCHMARK: {
+            for (auto _ : *state) {
+                udf::v1::like(&name, &pattern_ref, &out, &is_null);
+                benchmark::DoNotOptimize(out);
+            }
+            break;
+        }
+        case TEST: {
+            udf::v1::like(&name, &pattern_ref, &out, &is_null);
+            ASSERT_FALSE(is_null);
+            ASSERT_TRUE(out) << pattern;
+            break;
+        }
+    }
+}
+void ILikeMatch(benchmark::State* state, MODE mode, const std::string& pattern) {
+    codec::StringRef name(kMatchTarget);
+    codec::StringRef pattern_ref(pattern);
+    bool out = false;
+    bool is_null = false;
+    switch (mode) {
+        case BENCHMARK: {
+            for (auto _ : *state) {
+                udf::v1::ilike(&name, &pattern_ref, &out, &is_null);
+                benchmark::DoNotOptimize(out);
+            }
+            break;
+        }
+        case TEST: {
+            udf::v1::ilike(&name, &pattern_ref, &out, &is_null);
+            ASSERT_FALSE(is_null);
+            ASSERT_TRUE(out) << pattern;
+            break;
+        }
+    }
+}
+void RegexpLike(benchmark::State* state, MODE mode) {
+    codec::StringRef name(kMatchTarget);
+    codec::StringRef pattern("user_[0-9]+@");
+    bool out = false;
+    bool is_null = false;
+    switch (mode) {
+        case BENCHMARK: {
+            for (auto _ : *state) {
+                udf::v1::regexp_like(&name, &pattern, &out, &is_null);
+                benchmark::DoNotOptimize(out);
+            }
+            break;
+        }
+        case TEST: {
+            udf::v1::regexp_like(&name, &pattern, &out, &is_null);
+            ASSERT_FALSE(is_null);
+            ASSERT_TRUE(out);
+            break;
+        }
+    }
+}
+void RegexpExtract(benchmark::State* state, MODE mode) {
+    codec::StringRef name(kMatchTarget);
+    codec::StringRef pattern("user_([0-9]+)@");
+    bool is_null = false;
+    switch (mode) {
+        case BENCHMARK: {
+            for (auto _ : *state) {
+                codec::StringRef str;
+                udf::v1::regexp_extract(&name, &pattern, 1, &str, &is_null);
+            }
+            break;
+        }
+        case TEST: {
+            codec::StringRef str;
+            udf::v1::regexp_extract(&name, &pattern, 1, &str, &is_null);
+            ASSERT_FALSE(is_null);
+            ASSERT_EQ(codec::StringRef("0123456789"), str);
+            break;
+        }
+    }
+}
 int64_t RunHistoryWindowBuffer(const vm::WindowRange& window_range,
                                uint64_t data_size,
                                const bool exclude_current_time) {  // NOLINT
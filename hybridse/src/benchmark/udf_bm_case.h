@@ -40,6 +40,11 @@ void TimestampFormat(benchmark::State* state, MODE mode);
 
 void DateToString(benchmark::State* state, MODE mode);
 void DateFormat(benchmark::State* state, MODE mode);
+// String match Udf
+void LikeMatch(benchmark::State* state, MODE mode, const std::string& pattern);
+void ILikeMatch(benchmark::State* state, MODE mode, const std::string& pattern);
+void RegexpLike(benchmark::State* state, MODE mode);
+void RegexpExtract(benchmark::State* state, MODE mode);
 void ByteMemPoolAlloc1000(benchmark::State* state, MODE mode,
                           size_t request_size);
 void NewFree1000(benchmark::State* state, MODE mode, size_t request_size);
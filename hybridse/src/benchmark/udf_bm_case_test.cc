@@ -80,6 +80,17 @@ TEST_F(UdfBMCaseTest, TimestampFormat_TEST) { TimestampFormat(nullptr, TEST); }
 TEST_F(UdfBMCaseTest, DateToString_TEST) { DateToString(nullptr, TEST); }
 TEST_F(UdfBMCaseTest, DateFormat_TEST) { DateFormat(nullptr, TEST); }
 
+TEST_F(UdfBMCaseTest, LikeMatch_TEST) {
+    LikeMatch(nullptr, TEST, "openmldb_user_0123456789@example.com");
+    LikeMatch(nullptr, TEST, "openmldb%");
+    LikeMatch(nullptr, TEST, "%example.com");
+    LikeMatch(nullptr, TEST, "%0123456789%");
+    LikeMatch(nullptr, TEST, "open%user__1%@%.com");
+}
+TEST_F(UdfBMCaseTest, ILikeMatch_TEST) { ILikeMatch(nullptr, TEST, "%USER%"); }
+TEST_F(UdfBMCaseTest, RegexpLike_TEST) { RegexpLike(nullptr, TEST); }
+TEST_F(UdfBMCaseTest, RegexpExtract_TEST) { RegexpExtract(nullptr, TEST); }
+
 }  // namespace bm
 }  // namespace hybridse
 int main(int argc, char** argv) {
@@ -988,6 +988,39 @@ TEST_F(UdfIRBuilderTest, ilike_match) {
     CheckUdf<Nullable<bool>, Nullable<StringRef>, Nullable<StringRef>, Nullable<StringRef>>(
         udf_name, true, StringRef("mi\\ke"), StringRef("Mi\\_e"), StringRef(""));
 }
+TEST_F(UdfIRBuilderTest, regexp_like) {
+    auto udf_name = "regexp_like";
+    CheckUdf<Nullable<bool>, Nullable<StringRef>, Nullable<StringRef>>(udf_name, true, StringRef("Mike"),
+                                                                       StringRef("M.k"));
+    CheckUdf<Nullable<bool>, Nullable<StringRef>, Nullable<StringRef>>(udf_name, false, StringRef("Mike"),
+                                                                       StringRef("^k"));
+    CheckUdf<Nullable<bool>, Nullable<StringRef>, Nullable<StringRef>>(udf_name, true, StringRef(""),
+                                                                       StringRef(""));
+    // invalid pattern
+    CheckUdf<Nullable<bool>, Nullable<StringRef>, Nullable<StringRef>>(udf_name, nullptr, StringRef("Mike"),
+                                                                       StringRef("M(k"));
+    CheckUdf<Nullable<bool>, Nullable<StringRef>, Nullable<StringRef>>(udf_name, nullptr, nullptr,
+                                                                       StringRef("M.k"));
+    CheckUdf<Nullable<bool>, Nullable<StringRef>, Nullable<StringRef>>(udf_name, nullptr, StringRef("Mike"),
+                                                                       nullptr);
+}
+TEST_F(UdfIRBuilderTest, regexp_extract) {
+    auto udf_name = "regexp_extract";
+    CheckUdf<Nullable<StringRef>, Nullable<StringRef>, Nullable<StringRef>, Nullable<int32_t>>(
+        udf_name, StringRef("Mike"), StringRef("id=100,name=Mike"), StringRef("name=(\\w+)"), 1);
+    CheckUdf<Nullable<StringRef>, Nullable<StringRef>, Nullable<StringRef>, Nullable<int32_t>>(
+        udf_name, StringRef("100"), StringRef("id=100,name=Mike"), StringRef("[0-9]+"), 0);
+    // no match
+    CheckUdf<Nullable<StringRef>, Nullable<StringRef>, Nullable<StringRef>, Nullable<int32_t>>(
+        udf_name, StringRef(""), StringRef("id=100"), StringRef("name=(\\w+)"), 1);
+    // group index out of range
+    CheckUdf<Nullable<StringRef>, Nullable<StringRef>, Nullable<StringRef>, Nullable<int32_t>>(
+        udf_name, nullptr, StringRef("id=100"), StringRef("id=([0-9]+)"), 2);
+    CheckUdf<Nullable<StringRef>, Nullable<StringRef>, Nullable<StringRef>, Nullable<int32_t>>(
+        udf_name, nullptr, StringRef("id=100"), StringRef("id=([0-9]+"), 1);
+    CheckUdf<Nullable<StringRef>, Nullable<StringRef>, Nullable<StringRef>>(
+        udf_name, StringRef("100"), StringRef("id=100"), StringRef("id=([0-9]+)"));
+}
 TEST_F(UdfIRBuilderTest, reverse) {
     auto udf_name = "reverse";
     CheckUdf<Nullable<StringRef>, Nullable<StringRef>>(udf_name, StringRef("SQL"), StringRef("LQS"));
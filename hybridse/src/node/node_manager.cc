@@ -475,6 +475,10 @@ SqlNode *NodeManager::MakeColumnIndexNode(SqlNodeList *index_item_list) {
                     index_ptr->set_ttl_type(ttl_type_node->ttl_type());
                     break;
                 }
+                case kIndexHotTTL: {
+                    index_ptr->SetHotTTL(dynamic_cast<IndexHotTTLNode *>(node_ptr)->GetHotTTL());
+                    break;
+                }
                 default: {
                     LOG(WARNING) << "can not handle type " << NameOfSqlNodeType(node_ptr->GetType())
                                  << " for column index";
@@ -676,6 +680,10 @@ SqlNode *NodeManager::MakeIndexTTLTypeNode(const std::string &ttl_type) {
     SqlNode *node_ptr = new IndexTTLTypeNode(ttl_type);
     return RegisterNode(node_ptr);
 }
+SqlNode *NodeManager::MakeIndexHotTTLNode(int64_t hot_ttl) {
+    SqlNode *node_ptr = new IndexHotTTLNode(hot_ttl);
+    return RegisterNode(node_ptr);
+}
 SqlNode *NodeManager::MakeIndexVersionNode(const std::string &version) {
     SqlNode *node_ptr = new IndexVersionNode(version);
     return RegisterNode(node_ptr);
@@ -1124,6 +1124,9 @@ std::string NameOfSqlNodeType(const SqlNodeType &type) {
         case kIndexTTL:
             output = "kIndexTTL";
             break;
+        case kIndexHotTTL:
+            output = "kIndexHotTTL";
+            break;
         case kIndexVersion:
             output = "kIndexVersion";
             break;
@@ -1485,6 +1488,10 @@ void ColumnIndexNode::Print(std::ostream &output, const std::string &org_tab) co
     output << "\n";
     PrintValue(output, tab, ttl_type_, "ttl_type", false);
     output << "\n";
+    if (hot_ttl_ > 0) {
+        PrintValue(output, tab, std::to_string(hot_ttl_), "hot_ttl", false);
+        output << "\n";
+    }
     PrintValue(output, tab, version_, "version_column", false);
     output << "\n";
     PrintValue(output, tab, std::to_string(version_count_), "version_count", true);
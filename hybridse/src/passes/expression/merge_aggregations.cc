@@ -35,10 +35,6 @@ bool IsCandidate(const WindowIterAnalysis& window_iter_analyzer,
     if (call->GetFnDef()->GetType() != node::kUdafDef) {
         return false;
     }
-    auto udaf = dynamic_cast<node::UdafDefNode*>(call->GetFnDef());
-    if (udaf->merge_func() != nullptr) {
-        return false;
-    }
     WindowIterRank rank;
     if (!window_iter_analyzer.GetRank(call, &rank)) {
         return false;
@@ -268,6 +264,57 @@ Status MergeUdafCalls(const std::vector<ExprNode*>& calls, ExprIdNode* window,
     }
     auto new_init_expr = nm->MakeFuncNode("make_tuple", sub_inits, nullptr);
 
+    // build merge function if every sub udaf is mergeable
+    node::FnDefNode* new_merge_func = nullptr;
+    bool all_mergeable = true;
+    for (auto udaf : udafs) {
+        all_mergeable &= udaf->merge_func() != nullptr;
+    }
+    if (all_mergeable) {
+        ExprIdNode* lhs_state = nm->MakeExprIdNode("merged_state_lhs");
+        lhs_state->SetOutputType(new_state_type);
+        lhs_state->SetNullable(false);
+        ExprIdNode* rhs_state = nm->MakeExprIdNode("merged_state_rhs");
+        rhs_state->SetOutputType(new_state_type);
+        rhs_state->SetNullable(false);
+
+        std::vector<ExprNode*> sub_merge_results;
+        for (size_t i = 0; i < udafs.size(); ++i) {
+            size_t state_begin_idx = state_range[i].first;
+            size_t state_end_idx = state_range[i].second;
+            bool is_tuple = state_end_idx - state_begin_idx > 1;
+            std::vector<ExprNode*> sub_merge_args;
+            for (auto merged_state : {lhs_state, rhs_state}) {
+                if (is_tuple) {
+                    std::vector<ExprNode*> tuple;
+                    for (size_t j = state_begin_idx; j < state_end_idx; ++j) {
+                        tuple.push_back(nm->MakeGetFieldExpr(merged_state, j));
+                    }
+                    sub_merge_args.push_back(
+                        nm->MakeFuncNode("make_tuple", tuple, nullptr));
+                } else {
+                    sub_merge_args.push_back(
+                        nm->MakeGetFieldExpr(merged_state, state_begin_idx));
+                }
+            }
+            ExprNode* sub_call = nullptr;
+            CHECK_STATUS(ApplyArgs(udafs[i]->merge_func(), sub_merge_args, nm,
+                                   &sub_call));
+            if (is_tuple) {
+                for (size_t j = state_begin_idx; j < state_end_idx; ++j) {
+                    sub_merge_results.push_back(
+                        nm->MakeGetFieldExpr(sub_call, j - state_begin_idx));
+                }
+            } else {
+                sub_merge_results.push_back(sub_call);
+            }
+        }
+        auto merge_results =
+            nm->MakeFuncNode("make_tuple", sub_merge_results, nullptr);
+        new_merge_func =
+            nm->MakeLambdaNode({lhs_state, rhs_state}, merge_results);
+    }
+
     // build merged call arguments
     std::vector<ExprNode*> call_args;
     call_args.push_back(window);
@@ -284,7 +331,8 @@ Status MergeUdafCalls(const std::vector<ExprNode*>& calls, ExprIdNode* window,
     }
     auto new_udaf =
         nm->MakeUdafDefNode("merged_window_agg", call_arg_types, new_init_expr,
-                            new_update_func, nullptr, new_output_func);
+                            new_update_func, new_merge_func,
+                            new_output_func);
     *output = nm->MakeFuncNode(new_udaf, call_args, nullptr);
     return Status::OK();
 }
@@ -107,6 +107,41 @@ TEST_F(MergeAggregationsTest, Test) {
     LOG(INFO) << "Merged aggregation:\n" << merged->GetTreeString();
 }
 
+TEST_F(MergeAggregationsTest, MergeableUdafTest) {
+    auto schema = udf::MakeLiteralSchema<int32_t, float, double, int64_t>();
+    schemas_ctx_.BuildTrivial({&schema});
+
+    std::string sql =
+        "select approx_distinct_count(col_0) over w1, "
+        "approx_percentile(col_2, 0.9) over w1, "
+        "approx_distinct_count(col_3) over w1 "
+        "from t1 window w1 as (partition by col_1 order by col_3 rows between "
+        "3 preceding and current row);";
+    node::LambdaNode* function_let = nullptr;
+    InitFunctionLet(sql, &function_let);
+
+    MergeAggregations pass;
+    node::ExprNode* output = nullptr;
+    Status status = ApplyPass(&pass, function_let, &output);
+    ASSERT_TRUE(status.isOK()) << status;
+
+    ResolveFnAndAttrs resolver(&ctx_);
+    status = resolver.Apply(&ctx_, output, &output);
+    ASSERT_TRUE(status.isOK()) << status;
+
+    ASSERT_EQ(3u, output->GetChildNum());
+    auto expr = output->GetChild(0);
+    ASSERT_EQ(node::kExprGetField, expr->GetExprType());
+    auto call = dynamic_cast<node::CallExprNode*>(expr->GetChild(0));
+    ASSERT_TRUE(call != nullptr);
+    auto udaf = dynamic_cast<node::UdafDefNode*>(call->GetFnDef());
+    ASSERT_TRUE(udaf != nullptr);
+    ASSERT_EQ(0u, udaf->GetName().rfind("merged_window_agg"));
+    // merged state is still mergeable since all sub states are
+    ASSERT_TRUE(udaf->merge_func() != nullptr);
+    ASSERT_EQ(2u, udaf->merge_func()->GetArgSize());
+}
+
 }  // namespace passes
 }  // namespace hybridse
 
@@ -1506,6 +1506,7 @@ base::Status ConvertColumnIndexNode(const zetasql::ASTIndexDefinition* ast_def_n
 //   "ts"       -> IndexTsNode
 //   "ttl"      -> IndexTTLNode
 //   "ttl_type" -> IndexTTLTypeNode
+//   "hot_ttl"  -> IndexHotTTLNode
 //   "version"  -> IndexVersionNode
 base::Status ConvertIndexOption(const zetasql::ASTOptionsEntry* entry, node::NodeManager* node_manager,
                                 node::SqlNode** output) {
@@ -1618,6 +1619,16 @@ base::Status ConvertIndexOption(const zetasql::ASTOptionsEntry* entry, node::Nod
         CHECK_STATUS(AstPathExpressionToString(entry->value()->GetAsOrNull<zetasql::ASTPathExpression>(), &ttl_type));
         *output = node_manager->MakeIndexTTLTypeNode(ttl_type);
         return base::Status::OK();
+    } else if (boost::equals("hot_ttl", name)) {
+        CHECK_TRUE(zetasql::AST_INTERVAL_LITERAL == entry->value()->node_kind(), common::kSqlAstError,
+                   "Invalid hot_ttl, should be interval literal");
+        int64_t value;
+        node::DataType unit;
+        CHECK_STATUS(ASTIntervalLIteralToNum(entry->value(), &value, &unit));
+        auto node = node_manager->MakeConstNode(value, unit);
+        CHECK_TRUE(node->GetMillis() > 0, common::kSqlAstError, "Invalid hot_ttl, should be positive");
+        *output = node_manager->MakeIndexHotTTLNode(node->GetMillis());
+        return base::Status::OK();
     } else if (boost::equals("version", name)) {
         switch (entry->value()->node_kind()) {
             case zetasql::AST_PATH_EXPRESSION: {
@@ -460,6 +460,37 @@ TEST_F(ASTNodeConverterTest, ConvertCreateTableNodeOkTest) {
             }
         }
     }
+    {
+        const std::string sql =
+            "create table t5 (a int32, b timestamp, index(key=a, ts=b, ttl=30d, ttl_type=absolute, hot_ttl=1d)) "
+            "options (storage_mode = 'tiered');";
+
+        std::unique_ptr<zetasql::ParserOutput> parser_output;
+        ZETASQL_ASSERT_OK(zetasql::ParseStatement(sql, zetasql::ParserOptions(), &parser_output));
+        const auto* statement = parser_output->statement();
+        ASSERT_TRUE(statement->Is<zetasql::ASTCreateTableStatement>());
+
+        const auto create_stmt = statement->GetAsOrDie<zetasql::ASTCreateTableStatement>();
+        node::CreateStmt* output = nullptr;
+        auto status = ConvertCreateTableNode(create_stmt, &node_manager, &output);
+        EXPECT_EQ(common::kOk, status.code) << status;
+        bool has_index = false;
+        for (auto column_desc : output->GetColumnDefList()) {
+            if (column_desc->GetType() == node::kColumnIndex) {
+                has_index = true;
+                ASSERT_EQ(86400000, dynamic_cast<node::ColumnIndexNode *>(column_desc)->GetHotTTL());
+            }
+        }
+        ASSERT_TRUE(has_index);
+        bool has_storage_mode = false;
+        for (auto table_option : output->GetTableOptionList()) {
+            if (table_option->GetType() == node::kStorageMode) {
+                has_storage_mode = true;
+                ASSERT_EQ(node::kTiered, dynamic_cast<node::StorageModeNode *>(table_option)->GetStorageMode());
+            }
+        }
+        ASSERT_TRUE(has_storage_mode);
+    }
     {
         // empty table element and option list
         const std::string sql = "create table t4;";
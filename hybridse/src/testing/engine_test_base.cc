@@ -549,6 +549,8 @@ INSTANTIATE_TEST_SUITE_P(EngineBatchHavingQuery, EngineTest,
                          testing::ValuesIn(sqlcase::InitCases("/cases/query/having_query.yaml")));
 INSTANTIATE_TEST_SUITE_P(EngineBatchWhereGroupQuery, EngineTest,
                          testing::ValuesIn(sqlcase::InitCases("/cases/query/where_group_query.yaml")));
+INSTANTIATE_TEST_SUITE_P(EngineBatchSpillQuery, EngineTest,
+                         testing::ValuesIn(sqlcase::InitCases("/cases/query/spill_query.yaml")));
 INSTANTIATE_TEST_SUITE_P(EngineTestWindowRowQuery, EngineTest,
                         testing::ValuesIn(sqlcase::InitCases("/cases/function/window/test_window_row.yaml")));
 
@@ -0,0 +1,199 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+
+#include "base/fe_sketch.h"
+#include "udf/default_udf_library.h"
+#include "udf/udf_registry.h"
+
+using openmldb::base::Date;
+using openmldb::base::StringRef;
+using openmldb::base::Timestamp;
+
+namespace hybridse {
+namespace udf {
+
+// hash values in the same way as storage pre-aggregation and request runner,
+// so that sketches from different sources can be merged
+template <typename V>
+static uint64_t SketchHash(V value) {
+    return base::HyperLogLog::HashInt(static_cast<int64_t>(value));
+}
+template <>
+uint64_t SketchHash(float value) {
+    return base::HyperLogLog::HashDouble(value);
+}
+template <>
+uint64_t SketchHash(double value) {
+    return base::HyperLogLog::HashDouble(value);
+}
+template <>
+uint64_t SketchHash(Timestamp* value) {
+    return base::HyperLogLog::HashInt(value->ts_);
+}
+template <>
+uint64_t SketchHash(Date* value) {
+    return base::HyperLogLog::HashInt(value->date_);
+}
+template <>
+uint64_t SketchHash(StringRef* value) {
+    return base::HyperLogLog::HashBytes(value->data_, value->size_);
+}
+
+template <typename T>
+struct ApproxDistinctCountDef {
+    using ArgT = typename DataTypeTrait<T>::CCallArgType;
+    using SketchT = base::HyperLogLog;
+
+    void operator()(UdafRegistryHelper& helper) {  // NOLINT
+        std::string suffix = ".opaque_hll_" + DataTypeTrait<T>::to_string();
+        helper.templates<int64_t, Opaque<SketchT>, Nullable<T>>()
+            .init("approx_distinct_count_init" + suffix, Init)
+            .update("approx_distinct_count_update" + suffix, Update)
+            .merge("approx_distinct_count_merge" + suffix,
+                   reinterpret_cast<void*>(Merge))
+            .output("approx_distinct_count_output" + suffix, Output);
+    }
+
+    static void Init(SketchT* addr) { new (addr) SketchT(); }
+
+    static SketchT* Update(SketchT* sketch, ArgT value, bool is_null) {
+        if (!is_null) {
+            sketch->Add(SketchHash(value));
+        }
+        return sketch;
+    }
+
+    static SketchT* Merge(SketchT* lhs, SketchT* rhs) {
+        lhs->Merge(*rhs);
+        return lhs;
+    }
+
+    static int64_t Output(SketchT* sketch) {
+        int64_t cnt = sketch->Estimate();
+        sketch->~SketchT();
+        return cnt;
+    }
+};
+
+template <typename T>
+struct ApproxPercentileDef {
+    using ArgT = typename DataTypeTrait<T>::CCallArgType;
+
+    struct StateT {
+        base::KllSketch sketch;
+        double percentile = 0.5;
+    };
+
+    void operator()(UdafRegistryHelper& helper) {  // NOLINT
+        std::string suffix = ".opaque_kll_" + DataTypeTrait<T>::to_string();
+        helper.templates<Nullable<double>, Opaque<StateT>, Nullable<T>, double>()
+            .init("approx_percentile_init" + suffix, Init)
+            .update("approx_percentile_update" + suffix, Update)
+            .merge("approx_percentile_merge" + suffix,
+                   reinterpret_cast<void*>(Merge))
+            .output("approx_percentile_output" + suffix,
+                    reinterpret_cast<void*>(Output), true);
+    }
+
+    static void Init(StateT* addr) { new (addr) StateT(); }
+
+    static StateT* Update(StateT* state, ArgT value, bool is_null,
+                          double percentile) {
+        state->percentile = percentile;
+        if (!is_null) {
+            state->sketch.Add(static_cast<double>(value));
+        }
+        return state;
+    }
+
+    static StateT* Merge(StateT* lhs, StateT* rhs) {
+        if (lhs->sketch.IsEmpty()) {
+            lhs->percentile = rhs->percentile;
+        }
+        lhs->sketch.Merge(rhs->sketch);
+        return lhs;
+    }
+
+    static void Output(StateT* state, double* output, bool* is_null) {
+        *is_null = !state->sketch.Quantile(state->percentile, output);
+        if (*is_null) {
+            *output = 0;
+        }
+        state->~StateT();
+    }
+};
+
+void DefaultUdfLibrary::InitApproxUdafs() {
+    RegisterUdafTemplate<ApproxDistinctCountDef>("approx_distinct_count")
+        .doc(R"(
+            @brief Compute approximate number of distinct values with HyperLogLog.
+
+            The relative standard error is about 1.6%. Unlike distinct_count, memory of
+            each window is bounded by 4KB and the aggregate state can be pre-aggregated
+            for long windows. Null values are ignored.
+
+            @param value  Specify value column to aggregate on.
+
+            Example:
+
+            |value|
+            |--|
+            |0|
+            |0|
+            |2|
+            |2|
+            |4|
+            @code{.sql}
+                SELECT approx_distinct_count(value) OVER w;
+                -- output 3
+            @endcode
+            @since 0.6.0
+        )")
+        .args_in<bool, int16_t, int32_t, int64_t, float, double, Timestamp,
+                 Date, StringRef>();
+
+    RegisterUdafTemplate<ApproxPercentileDef>("approx_percentile")
+        .doc(R"(
+            @brief Compute approximate percentile of values with KLL sketch.
+
+            The rank error is about 1% of the window size. Null values are ignored,
+            and null is returned if all values are null.
+
+            @param value  Specify value column to aggregate on.
+            @param percentile  Percentile in range [0, 1].
+
+            Example:
+
+            |value|
+            |--|
+            |1|
+            |2|
+            |3|
+            |4|
+            |5|
+            @code{.sql}
+                SELECT approx_percentile(value, 0.5) OVER w;
+                -- output 3
+            @endcode
+            @since 0.6.0
+        )")
+        .args_in<int16_t, int32_t, int64_t, float, double>();
+}
+
+}  // namespace udf
+}  // namespace hybridse
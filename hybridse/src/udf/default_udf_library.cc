@@ -848,6 +848,80 @@ void DefaultUdfLibrary::InitStringUdf() {
 
                 @since 0.4.0
         )r");
+    RegisterExternal("regexp_like")
+        .args<StringRef, StringRef>(reinterpret_cast<void*>(
+            static_cast<void (*)(StringRef*, StringRef*, bool*, bool*)>(udf::v1::regexp_like)))
+        .return_by_arg(true)
+        .returns<Nullable<bool>>()
+        .doc(R"r(
+                @brief Return true if any substring of target matches the regular expression
+
+                The pattern uses RE2 syntax and is compiled once per thread. Return NULL if
+                target or pattern is NULL, or the pattern is not a valid regular expression.
+
+                Example:
+                @code{.sql}
+                    select regexp_like('Mike', 'M.k')
+                    -- output: true
+
+                    select regexp_like('Mike', '^k')
+                    -- output: false
+                @endcode
+
+                @param target: string to match
+
+                @param pattern: the regular expression
+
+                @since 0.6.0
+        )r");
+    RegisterExternal("regexp_extract")
+        .args<StringRef, StringRef, int32_t>(reinterpret_cast<void*>(
+            static_cast<void (*)(StringRef*, StringRef*, int32_t, StringRef*, bool*)>(udf::v1::regexp_extract)))
+        .return_by_arg(true)
+        .returns<Nullable<StringRef>>()
+        .doc(R"r(
+                @brief Extract the group of the first substring matching the regular expression
+
+                Group 0 is the whole match. Return empty string if nothing matches, and NULL if
+                the pattern is invalid or the group index is out of range.
+
+                Example:
+                @code{.sql}
+                    select regexp_extract('id=100,name=Mike', 'name=(\\w+)', 1)
+                    -- output: Mike
+
+                    select regexp_extract('id=100', '[0-9]+', 0)
+                    -- output: 100
+                @endcode
+
+                @param target: string to match
+
+                @param pattern: the regular expression
+
+                @param idx: index of the capturing group
+
+                @since 0.6.0
+        )r");
+    RegisterExternal("regexp_extract")
+        .args<StringRef, StringRef>(reinterpret_cast<void*>(
+            static_cast<void (*)(StringRef*, StringRef*, StringRef*, bool*)>(udf::v1::regexp_extract)))
+        .return_by_arg(true)
+        .returns<Nullable<StringRef>>()
+        .doc(R"r(
+                @brief Extract the first capturing group of the first substring matching the regular expression
+
+                Example:
+                @code{.sql}
+                    select regexp_extract('id=100,name=Mike', 'name=(\\w+)')
+                    -- output: Mike
+                @endcode
+
+                @param target: string to match
+
+                @param pattern: the regular expression
+
+                @since 0.6.0
+        )r");
     RegisterExternal("ucase")
         .args<StringRef>(
             reinterpret_cast<void*>(static_cast<void (*)(StringRef*, StringRef*, bool*)>(udf::v1::ucase)))
@@ -2004,6 +2078,7 @@ void DefaultUdfLibrary::Init() {
     InitWindowFunctions();
     InitUdaf();
     InitFeatureZero();
+    InitApproxUdafs();
 
     AddExternalFunction("init_udfcontext.opaque",
             reinterpret_cast<void*>(static_cast<void (*)(UDFContext* context)>(udf::v1::init_udfcontext)));
@@ -42,6 +42,7 @@ class DefaultUdfLibrary : public UdfLibrary {
     void initMaxByCateUdaFs();
     void InitAvgByCateUdafs();
     void InitFeatureZero();
+    void InitApproxUdafs();
 
     static DefaultUdfLibrary inst_;
 
@@ -0,0 +1,210 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "udf/string_matcher.h"
+
+#include <string.h>
+
+#include <cctype>
+#include <unordered_map>
+#include <utility>
+
+#include "base/fe_hash.h"
+#include "re2/re2.h"
+
+namespace hybridse {
+namespace udf {
+
+// cached patterns of a thread, the cache is simply dropped when it is full
+static constexpr size_t kMaxCachedPatterns = 256;
+
+static inline char ToLower(char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); }
+
+LikeMatcher::LikeMatcher(std::string_view pattern, const char* escape, bool case_insensitive)
+    : pattern_(pattern),
+      escape_(escape == nullptr ? 0 : *escape),
+      has_escape_(escape != nullptr),
+      case_insensitive_(case_insensitive) {
+    Segment cur;
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        char c = pattern[i];
+        if (has_escape_ && c == escape_) {
+            if (i + 1 == pattern.size()) {
+                kind_ = kNever;
+                segments_.clear();
+                return;
+            }
+            c = pattern[++i];
+        } else if (c == '%') {
+            has_percent_ = true;
+            segments_.push_back(std::move(cur));
+            cur = Segment();
+            continue;
+        } else if (c == '_') {
+            cur.chars.push_back(0);
+            cur.any.push_back(true);
+            cur.literal = false;
+            continue;
+        }
+        cur.chars.push_back(case_insensitive_ ? ToLower(c) : c);
+        cur.any.push_back(false);
+    }
+    segments_.push_back(std::move(cur));
+
+    if (!has_percent_) {
+        kind_ = kExact;
+        min_size_ = segments_[0].chars.size();
+        return;
+    }
+    // '%%' is the same as '%'
+    std::vector<Segment> segments;
+    for (size_t i = 0; i < segments_.size(); ++i) {
+        if (i == 0 || i + 1 == segments_.size() || !segments_[i].chars.empty()) {
+            min_size_ += segments_[i].chars.size();
+            segments.push_back(std::move(segments_[i]));
+        }
+    }
+    segments_ = std::move(segments);
+
+    auto& first = segments_.front();
+    auto& last = segments_.back();
+    if (min_size_ == 0) {
+        kind_ = kAny;
+    } else if (segments_.size() == 2 && last.chars.empty()) {
+        kind_ = kPrefix;
+    } else if (segments_.size() == 2 && first.chars.empty()) {
+        kind_ = kSuffix;
+    } else if (segments_.size() == 3 && first.chars.empty() && last.chars.empty() && segments_[1].literal) {
+        kind_ = kContains;
+    } else {
+        kind_ = kGeneral;
+    }
+}
+
+bool LikeMatcher::IsCompiledFrom(std::string_view pattern, const char* escape, bool case_insensitive) const {
+    return case_insensitive_ == case_insensitive && has_escape_ == (escape != nullptr) &&
+           (escape == nullptr || escape_ == *escape) && pattern_ == pattern;
+}
+
+bool LikeMatcher::Match(std::string_view target) const {
+    if (kind_ == kNever) {
+        return false;
+    }
+    if (kind_ == kAny) {
+        return true;
+    }
+    if (!case_insensitive_) {
+        return MatchSegments(target);
+    }
+    thread_local std::string lowered;
+    lowered.resize(target.size());
+    for (size_t i = 0; i < target.size(); ++i) {
+        lowered[i] = ToLower(target[i]);
+    }
+    return MatchSegments(lowered);
+}
+
+bool LikeMatcher::MatchSegments(std::string_view target) const {
+    if (target.size() < min_size_) {
+        return false;
+    }
+    if (!has_percent_) {
+        return target.size() == min_size_ && MatchAt(target, 0, segments_[0]);
+    }
+    // first and last segments are anchored
+    auto& first = segments_.front();
+    auto& last = segments_.back();
+    if (!MatchAt(target, 0, first) || !MatchAt(target, target.size() - last.chars.size(), last)) {
+        return false;
+    }
+    // leftmost match of each middle segment leaves most room for the rest
+    size_t pos = first.chars.size();
+    size_t end = target.size() - last.chars.size();
+    for (size_t i = 1; i + 1 < segments_.size(); ++i) {
+        size_t found = Find(target, pos, end, segments_[i]);
+        if (found == std::string_view::npos) {
+            return false;
+        }
+        pos = found + segments_[i].chars.size();
+    }
+    return true;
+}
+
+bool LikeMatcher::MatchAt(std::string_view target, size_t pos, const Segment& seg) {
+    if (seg.literal) {
+        return memcmp(target.data() + pos, seg.chars.data(), seg.chars.size()) == 0;
+    }
+    for (size_t i = 0; i < seg.chars.size(); ++i) {
+        if (!seg.any[i] && target[pos + i] != seg.chars[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t LikeMatcher::Find(std::string_view target, size_t from, size_t to, const Segment& seg) {
+    size_t len = seg.chars.size();
+    if (to < from || to - from < len) {
+        return std::string_view::npos;
+    }
+    if (seg.literal) {
+        auto found = static_cast<const char*>(memmem(target.data() + from, to - from, seg.chars.data(), len));
+        return found == nullptr ? std::string_view::npos : found - target.data();
+    }
+    for (size_t pos = from; pos + len <= to; ++pos) {
+        if (MatchAt(target, pos, seg)) {
+            return pos;
+        }
+    }
+    return std::string_view::npos;
+}
+
+const LikeMatcher* LikeMatcher::Get(std::string_view pattern, const char* escape, bool case_insensitive) {
+    thread_local std::unordered_map<uint64_t, std::unique_ptr<LikeMatcher>> cache;
+    uint32_t seed = (escape == nullptr ? 0x100 : static_cast<unsigned char>(*escape)) | (case_insensitive << 9);
+    uint64_t key = base::MurmurHash64A(pattern.data(), pattern.size(), seed);
+    auto it = cache.find(key);
+    if (it != cache.end() && it->second->IsCompiledFrom(pattern, escape, case_insensitive)) {
+        return it->second.get();
+    }
+    if (cache.size() >= kMaxCachedPatterns) {
+        cache.clear();
+    }
+    auto& matcher = cache[key];
+    matcher = std::make_unique<LikeMatcher>(pattern, escape, case_insensitive);
+    return matcher.get();
+}
+
+const re2::RE2* RegexCache::Get(std::string_view pattern) {
+    thread_local std::unordered_map<uint64_t, std::unique_ptr<re2::RE2>> cache;
+    uint64_t key = base::MurmurHash64A(pattern.data(), pattern.size(), 0);
+    auto it = cache.find(key);
+    if (it == cache.end() || it->second->pattern() != pattern) {
+        if (cache.size() >= kMaxCachedPatterns) {
+            cache.clear();
+        }
+        re2::RE2::Options options;
+        options.set_log_errors(false);
+        auto& re = cache[key];
+        // invalid pattern is cached too, so that it is not compiled for every row
+        re = std::make_unique<re2::RE2>(re2::StringPiece(pattern.data(), pattern.size()), options);
+        return re->ok() ? re.get() : nullptr;
+    }
+    return it->second->ok() ? it->second.get() : nullptr;
+}
+
+}  // namespace udf
+}  // namespace hybridse
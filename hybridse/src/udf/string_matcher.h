@@ -0,0 +1,106 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYBRIDSE_SRC_UDF_STRING_MATCHER_H_
+#define HYBRIDSE_SRC_UDF_STRING_MATCHER_H_
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace re2 {
+class RE2;
+}  // namespace re2
+
+namespace hybridse {
+namespace udf {
+
+/**
+ * Compiled SQL LIKE pattern.
+ *
+ * The pattern is split by percent signs (%) into segments. The first and
+ * the last segment are anchored, the ones in between are searched leftmost
+ * with memmem, which is enough for glob patterns and never backtracks.
+ * Common shapes like 'abc%', '%abc' and '%abc%' are recognized so that
+ * callers can tell how the pattern is evaluated.
+ *
+ * Rules are the same as like_match:
+ * - underscore (_) matches exactly one character
+ * - percent (%) matches zero or more characters
+ * - escape character makes the next character a literal, a pattern ending
+ *   with escape character matches nothing
+ */
+class LikeMatcher {
+ public:
+    enum Kind {
+        kExact,     // no percent sign
+        kPrefix,    // abc%
+        kSuffix,    // %abc
+        kContains,  // %abc%
+        kAny,       // %
+        kNever,     // terminated with escape character
+        kGeneral,
+    };
+
+    // escape is nullptr if escape is disabled
+    LikeMatcher(std::string_view pattern, const char* escape, bool case_insensitive);
+
+    bool Match(std::string_view target) const;
+
+    Kind kind() const { return kind_; }
+
+    bool IsCompiledFrom(std::string_view pattern, const char* escape, bool case_insensitive) const;
+
+    // Get compiled matcher from cache of current thread, pattern is compiled
+    // on first use so constant patterns are compiled once per thread.
+    static const LikeMatcher* Get(std::string_view pattern, const char* escape, bool case_insensitive);
+
+ private:
+    struct Segment {
+        std::string chars;
+        // position of underscore in chars
+        std::vector<bool> any;
+        bool literal = true;
+    };
+
+    bool MatchSegments(std::string_view target) const;
+    static bool MatchAt(std::string_view target, size_t pos, const Segment& seg);
+    static size_t Find(std::string_view target, size_t from, size_t to, const Segment& seg);
+
+    std::string pattern_;
+    char escape_;
+    bool has_escape_;
+    bool case_insensitive_;
+
+    Kind kind_ = kGeneral;
+    bool has_percent_ = false;
+    std::vector<Segment> segments_;
+    size_t min_size_ = 0;
+};
+
+/**
+ * Thread local cache of compiled RE2 regular expressions.
+ */
+class RegexCache {
+ public:
+    // return nullptr if the pattern is invalid
+    static const re2::RE2* Get(std::string_view pattern);
+};
+
+}  // namespace udf
+}  // namespace hybridse
+#endif  // HYBRIDSE_SRC_UDF_STRING_MATCHER_H_
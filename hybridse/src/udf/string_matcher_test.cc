@@ -0,0 +1,143 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "udf/string_matcher.h"
+
+#include <random>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "re2/re2.h"
+
+namespace hybridse {
+namespace udf {
+
+class StringMatcherTest : public ::testing::Test {};
+
+// straightforward backtracking glob match, used as reference
+static bool ReferenceLike(std::string_view name, std::string_view pattern, char escape) {
+    if (pattern.empty()) {
+        return name.empty();
+    }
+    char c = pattern[0];
+    if (c == escape) {
+        if (pattern.size() == 1) {
+            return false;
+        }
+        return !name.empty() && name[0] == pattern[1] && ReferenceLike(name.substr(1), pattern.substr(2), escape);
+    }
+    if (c == '%') {
+        for (size_t i = 0; i <= name.size(); ++i) {
+            if (ReferenceLike(name.substr(i), pattern.substr(1), escape)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    return !name.empty() && (c == '_' || c == name[0]) && ReferenceLike(name.substr(1), pattern.substr(1), escape);
+}
+
+TEST_F(StringMatcherTest, Kind) {
+    ASSERT_EQ(LikeMatcher::kExact, LikeMatcher("abc", nullptr, false).kind());
+    ASSERT_EQ(LikeMatcher::kExact, LikeMatcher("a_c", nullptr, false).kind());
+    ASSERT_EQ(LikeMatcher::kPrefix, LikeMatcher("abc%", nullptr, false).kind());
+    ASSERT_EQ(LikeMatcher::kPrefix, LikeMatcher("abc%%", nullptr, false).kind());
+    ASSERT_EQ(LikeMatcher::kSuffix, LikeMatcher("%abc", nullptr, false).kind());
+    ASSERT_EQ(LikeMatcher::kContains, LikeMatcher("%abc%", nullptr, false).kind());
+    ASSERT_EQ(LikeMatcher::kGeneral, LikeMatcher("%a_c%", nullptr, false).kind());
+    ASSERT_EQ(LikeMatcher::kGeneral, LikeMatcher("a%b%c", nullptr, false).kind());
+    ASSERT_EQ(LikeMatcher::kAny, LikeMatcher("%", nullptr, false).kind());
+    ASSERT_EQ(LikeMatcher::kAny, LikeMatcher("%%%", nullptr, false).kind());
+
+    char esc = '\\';
+    ASSERT_EQ(LikeMatcher::kExact, LikeMatcher("abc\\%", &esc, false).kind());
+    ASSERT_EQ(LikeMatcher::kContains, LikeMatcher("%\\_%", &esc, false).kind());
+    ASSERT_EQ(LikeMatcher::kNever, LikeMatcher("abc\\", &esc, false).kind());
+    // escape disabled
+    ASSERT_EQ(LikeMatcher::kExact, LikeMatcher("abc\\", nullptr, false).kind());
+}
+
+TEST_F(StringMatcherTest, Match) {
+    char esc = '\\';
+    ASSERT_TRUE(LikeMatcher("abc%", &esc, false).Match("abcdef"));
+    ASSERT_FALSE(LikeMatcher("abc%", &esc, false).Match("ab"));
+    ASSERT_TRUE(LikeMatcher("%def", &esc, false).Match("abcdef"));
+    ASSERT_FALSE(LikeMatcher("%def", &esc, false).Match("abcde"));
+    ASSERT_TRUE(LikeMatcher("%cd%", &esc, false).Match("abcdef"));
+    ASSERT_FALSE(LikeMatcher("%cd%", &esc, false).Match("abdcef"));
+    // segments should not overlap
+    ASSERT_FALSE(LikeMatcher("ab%bc", &esc, false).Match("abc"));
+    ASSERT_TRUE(LikeMatcher("ab%bc", &esc, false).Match("abbc"));
+    ASSERT_TRUE(LikeMatcher("%a_c%d", &esc, false).Match("xxabcxd"));
+    ASSERT_TRUE(LikeMatcher("%", &esc, false).Match(""));
+    ASSERT_FALSE(LikeMatcher("abc\\", &esc, false).Match("abc\\"));
+    ASSERT_TRUE(LikeMatcher("abc\\", nullptr, false).Match("abc\\"));
+
+    ASSERT_TRUE(LikeMatcher("ABC%", &esc, true).Match("abcdef"));
+    ASSERT_TRUE(LikeMatcher("%Cd%", &esc, true).Match("ABCDEF"));
+    ASSERT_FALSE(LikeMatcher("%Cd%", &esc, false).Match("ABCDEF"));
+}
+
+TEST_F(StringMatcherTest, SameAsReference) {
+    std::mt19937 rng(1234);
+    const std::string alphabet = "ab_%\\";
+    auto random_str = [&](size_t max_len, size_t alphabet_size) {
+        std::string str(rng() % (max_len + 1), 'a');
+        for (auto& c : str) {
+            c = alphabet[rng() % alphabet_size];
+        }
+        return str;
+    };
+    char esc = '\\';
+    for (int i = 0; i < 20000; ++i) {
+        std::string pattern = random_str(8, alphabet.size());
+        std::string name = random_str(10, i % 2 == 0 ? 2 : alphabet.size());
+        LikeMatcher matcher(pattern, &esc, false);
+        ASSERT_EQ(ReferenceLike(name, pattern, esc), matcher.Match(name))
+            << "'" << name << "' LIKE '" << pattern << "'";
+    }
+}
+
+TEST_F(StringMatcherTest, Cache) {
+    char esc = '\\';
+    char other_esc = '$';
+    auto matcher = LikeMatcher::Get("abc%", &esc, false);
+    ASSERT_EQ(matcher, LikeMatcher::Get("abc%", &esc, false));
+    ASSERT_NE(matcher, LikeMatcher::Get("abc%", &esc, true));
+    ASSERT_NE(matcher, LikeMatcher::Get("abc%", &other_esc, false));
+    ASSERT_NE(matcher, LikeMatcher::Get("abc%", nullptr, false));
+    for (int i = 0; i < 1000; ++i) {
+        auto pattern = std::to_string(i) + "%";
+        ASSERT_TRUE(LikeMatcher::Get(pattern, &esc, false)->Match(std::to_string(i) + "x"));
+    }
+}
+
+TEST_F(StringMatcherTest, RegexCache) {
+    auto re = RegexCache::Get("a(b+)c");
+    ASSERT_TRUE(re != nullptr);
+    ASSERT_EQ(re, RegexCache::Get("a(b+)c"));
+    ASSERT_TRUE(re2::RE2::PartialMatch("xabbcx", *re));
+    ASSERT_TRUE(RegexCache::Get("a(b") == nullptr);
+    ASSERT_TRUE(RegexCache::Get("a(b") == nullptr);
+}
+
+}  // namespace udf
+}  // namespace hybridse
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -230,6 +230,34 @@ TEST_F(UdafTest, avg_test) {
     CheckUdf<double, ListRef<double>>("avg", 0.0 / 0, MakeList<double>({}));
 }
 
+TEST_F(UdafTest, approx_distinct_count_test) {
+    CheckUdafOneParam<int64_t, Nullable<int32_t>>("approx_distinct_count", 0, {});
+    CheckUdafOneParam<int64_t, Nullable<int32_t>>("approx_distinct_count", 0, {nullptr});
+    CheckUdafOneParam<int64_t, Nullable<int32_t>>("approx_distinct_count", 3, {0, 0, 2, 2, 4, nullptr});
+    CheckUdafOneParam<int64_t, Nullable<int64_t>>("approx_distinct_count", 2, {1, 2, 1});
+    CheckUdafOneParam<int64_t, Nullable<double>>("approx_distinct_count", 2, {0.0, -0.0, 1.5});
+    CheckUdafOneParam<int64_t, Nullable<Timestamp>>("approx_distinct_count", 2,
+                                                    {Timestamp(1000), Timestamp(2000), Timestamp(1000)});
+    CheckUdafOneParam<int64_t, Nullable<Date>>("approx_distinct_count", 1, {Date(1), Date(1)});
+    CheckUdafOneParam<int64_t, Nullable<StringRef>>("approx_distinct_count", 2,
+                                                    {StringRef("a"), StringRef("b"), nullptr, StringRef("a")});
+}
+
+TEST_F(UdafTest, approx_percentile_test) {
+    CheckUdf<Nullable<double>, ListRef<Nullable<int32_t>>, ListRef<double>>(
+        "approx_percentile", 3.0, MakeList<Nullable<int32_t>>({1, 2, nullptr, 3, 4, 5}),
+        MakeList<double>({0.5, 0.5, 0.5, 0.5, 0.5, 0.5}));
+    CheckUdf<Nullable<double>, ListRef<Nullable<double>>, ListRef<double>>(
+        "approx_percentile", 5.0, MakeList<Nullable<double>>({5.0, 1.0, 2.0}),
+        MakeList<double>({1.0, 1.0, 1.0}));
+    CheckUdf<Nullable<double>, ListRef<Nullable<int64_t>>, ListRef<double>>(
+        "approx_percentile", 1.0, MakeList<Nullable<int64_t>>({5, 1, 2}),
+        MakeList<double>({0.0, 0.0, 0.0}));
+    // all null
+    CheckUdf<Nullable<double>, ListRef<Nullable<int32_t>>, ListRef<double>>(
+        "approx_percentile", nullptr, MakeList<Nullable<int32_t>>({nullptr}), MakeList<double>({0.5}));
+}
+
 TEST_F(UdafTest, topk_test) {
     CheckUdf<StringRef, ListRef<int32_t>, ListRef<int32_t>>(
         "top", StringRef("6,6,5,4"), MakeList<int32_t>({1, 6, 3, 4, 5, 2, 6}),
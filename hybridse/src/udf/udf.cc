@@ -33,8 +33,10 @@
 #include "codegen/fn_ir_builder.h"
 #include "node/node_manager.h"
 #include "node/sql_node.h"
+#include "re2/re2.h"
 #include "udf/default_udf_library.h"
 #include "udf/literal_traits.h"
+#include "udf/string_matcher.h"
 #include "vm/jit_runtime.h"
 
 namespace hybridse {
@@ -283,103 +285,13 @@ void date_to_string(Date *date, StringRef *output) {
     date_format(date, "%Y-%m-%d", output);
 }
 
-/*
-* SQL style glob match, use
-* - percent sign (%) as zero or more characters
-* - underscore (_) as exactly one.
-* - backslash (\) as escape character by default
-*
-* rules:
-* - escape
-*   - exception(invalid escape character): if escape size >= 2
-*   - exception(invalid escape sequence)[TODO]:
-*     if <escape character> size = 1, and in pattern string, the follower character of <escape character>
-*     is not <escape character>, <underscore> or <precent>
-*   - empty string or null value means disable escape
-*
-* credit:
-*  Michael Cook, https://github.com/MichaelCook/glob_match/blob/master/glob_match.cpp
-*/
-template <typename EQUAL>
-bool like_internal(std::string_view name, std::string_view pattern, const char *escape, EQUAL &&equal) {
-    auto pattern_it = pattern.cbegin();
-    auto pattern_end = pattern.cend();
-    auto name_it = name.cbegin();
-    auto name_end = name.cend();
-
-    while (pattern_it != pattern_end) {
-        if (name_it == name_end) {
-            break;
-        }
-
-        char c = *pattern_it;
-        if (escape != nullptr && c == *escape) {
-            // exact character match
-            if (std::next(pattern_it) == pattern_end) {
-                // the pattern is terminated with escape character, just return false
-                return false;
-            }
-            c = *std::next(pattern_it);
-            if (!equal(c, *name_it)) {
-                return false;
-            }
-
-            std::advance(pattern_it, 2);
-        } else {
-            switch (c) {
-                case '%': {
-                    std::advance(pattern_it, 1);
-                    auto sub_pattern = std::string_view(pattern_it, std::distance(pattern_it, pattern_end));
-                    for (auto back = name_end; back >= name_it; std::advance(back, -1)) {
-                        if (like_internal(std::string_view(back, std::distance(back, name_end)),
-                                          sub_pattern, escape, std::forward<EQUAL>(equal))) {
-                            return true;
-                        }
-                    }
-                    return false;
-                }
-                case '_': {
-                    break;
-                }
-                default: {
-                    if (!equal(c, *name_it)) {
-                        return false;
-                    }
-                    break;
-                }
-            }
-
-            std::advance(pattern_it, 1);
-        }
-
-        std::advance(name_it, 1);
-    }
-
-    if (pattern_it != pattern_end) {
-        // when pattern iterator do not reach the end
-        // 1. true if there is only special character <percent>s left in pattern
-        // 2. false otherwise
-        for (; pattern_it != pattern_end; std::advance(pattern_it, 1)) {
-            if ((escape != nullptr && *pattern_it == *escape) || *pattern_it != '%') {
-                // character under pattern_it is escape character or is not <percent> character, return false
-                return false;
-            }
-        }
-
-        return true;
-    }
-
-    return name_it == name_end;
-}
-
 /*
 * if escape is null or ref to empty string, disable escape feature
 *
 * nullable
 * - any of (name, pattern, escape) is null, return null
 */
-template <typename EQUAL>
-void like_internal(StringRef *name, StringRef *pattern, StringRef *escape, EQUAL &&equal,
+void like_internal(StringRef *name, StringRef *pattern, StringRef *escape, bool case_insensitive,
                    bool *out, bool *is_null) {
     if (name == nullptr || pattern == nullptr || escape == nullptr) {
         out = nullptr;
@@ -399,13 +311,13 @@ void like_internal(StringRef *name, StringRef *pattern, StringRef *escape, EQUAL
         }
         esc = escape->data_;
     }
-    *out = like_internal(name_view, pattern_view, esc, std::forward<EQUAL>(equal));
+    // pattern is usually a constant, it is compiled once and reused for every row
+    *out = LikeMatcher::Get(pattern_view, esc, case_insensitive)->Match(name_view);
 }
 
 void like(StringRef *name, StringRef *pattern, StringRef *escape, bool *out,
           bool *is_null) {
-    like_internal(
-        name, pattern, escape, [](char lhs, char rhs) { return lhs == rhs; }, out, is_null);
+    like_internal(name, pattern, escape, false, out, is_null);
 }
 
 void like(StringRef* name, StringRef* pattern, bool* out, bool* is_null) {
@@ -414,12 +326,7 @@ void like(StringRef* name, StringRef* pattern, bool* out, bool* is_null) {
 }
 
 void ilike(StringRef *name, StringRef *pattern, StringRef *escape, bool *out, bool *is_null) {
-    like_internal(
-        name, pattern, escape,
-        [](char lhs, char rhs) {
-            return std::tolower(static_cast<unsigned char>(lhs)) == std::tolower(static_cast<unsigned char>(rhs));
-        },
-        out, is_null);
+    like_internal(name, pattern, escape, true, out, is_null);
 }
 
 void ilike(StringRef* name, StringRef* pattern, bool* out, bool* is_null) {
@@ -427,6 +334,48 @@ void ilike(StringRef* name, StringRef* pattern, bool* out, bool* is_null) {
     ilike(name, pattern, &default_esc,  out, is_null);
 }
 
+void regexp_like(StringRef *name, StringRef *pattern, bool *out, bool *is_null) {
+    auto re = RegexCache::Get(std::string_view(pattern->data_, pattern->size_));
+    if (re == nullptr) {
+        DLOG(ERROR) << "invalid regular expression '" << pattern->ToString() << "'";
+        *out = false;
+        *is_null = true;
+        return;
+    }
+    *out = re2::RE2::PartialMatch(re2::StringPiece(name->data_, name->size_), *re);
+    *is_null = false;
+}
+
+void regexp_extract(StringRef *name, StringRef *pattern, int32_t idx, StringRef *out, bool *is_null) {
+    auto re = RegexCache::Get(std::string_view(pattern->data_, pattern->size_));
+    if (re == nullptr || idx < 0 || idx > re->NumberOfCapturingGroups()) {
+        *is_null = true;
+        return;
+    }
+    *is_null = false;
+    std::vector<re2::StringPiece> groups(idx + 1);
+    if (!re->Match(re2::StringPiece(name->data_, name->size_), 0, name->size_, re2::RE2::UNANCHORED, groups.data(),
+                   idx + 1) ||
+        groups[idx].empty()) {
+        // no match or the group does not participate in the match
+        out->data_ = "";
+        out->size_ = 0;
+        return;
+    }
+    char *buffer = AllocManagedStringBuf(groups[idx].size());
+    if (buffer == nullptr) {
+        *is_null = true;
+        return;
+    }
+    memcpy(buffer, groups[idx].data(), groups[idx].size());
+    out->data_ = buffer;
+    out->size_ = groups[idx].size();
+}
+
+void regexp_extract(StringRef *name, StringRef *pattern, StringRef *out, bool *is_null) {
+    regexp_extract(name, pattern, 1, out, is_null);
+}
+
 void string_to_bool(StringRef *str, bool *out, bool *is_null_ptr) {
     if (nullptr == str) {
         *out = false;
@@ -250,6 +250,9 @@ void like(StringRef *name, StringRef *pattern, bool *out, bool *is_null);
 void ilike(StringRef *name, StringRef *pattern,
         StringRef *escape, bool *out, bool *is_null);
 void ilike(StringRef *name, StringRef *pattern, bool *out, bool *is_null);
+void regexp_like(StringRef *name, StringRef *pattern, bool *out, bool *is_null);
+void regexp_extract(StringRef *name, StringRef *pattern, int32_t idx, StringRef *out, bool *is_null);
+void regexp_extract(StringRef *name, StringRef *pattern, StringRef *out, bool *is_null);
 
 void date_to_timestamp(Date *date, Timestamp *output, bool *is_null);
 void string_to_date(StringRef *str, Date *output, bool *is_null);
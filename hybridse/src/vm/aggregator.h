@@ -23,6 +23,7 @@
 #include <string>
 #include <boost/algorithm/string/compare.hpp>
 
+#include "base/fe_sketch.h"
 #include "codec/fe_row_codec.h"
 #include "codec/row.h"
 #include "proto/fe_type.pb.h"
@@ -366,6 +367,65 @@ class MaxAggregator : public Aggregator<T> {
     }
 };
 
+// aggregate values into HyperLogLog sketch, pre-aggregated sketches are merged
+template <class T>
+class ApproxDistinctCountAggregator : public Aggregator<T> {
+ public:
+    ApproxDistinctCountAggregator(type::Type type, const Schema& output_schema)
+        : Aggregator<T>(type, output_schema, T()) {}
+
+    // val is assumed to be not null
+    void UpdateValue(const T& val) override {
+        hll_.Add(Hash(val));
+        this->counter_++;
+    }
+
+    void Update(const std::string& bval) override {
+        base::HyperLogLog other;
+        if (!other.ParseFrom(bval.data(), bval.size()) || !hll_.Merge(other)) {
+            LOG(ERROR) << "encoded aggr val is not valid";
+            return;
+        }
+        this->counter_++;
+    }
+
+    Row Output() override {
+        uint32_t total_len = this->row_builder_.CalTotalLength(0);
+        int8_t* buf = static_cast<int8_t*>(malloc(total_len));
+        this->row_builder_.SetBuffer(buf, total_len);
+        this->row_builder_.AppendInt64(static_cast<int64_t>(hll_.Estimate()));
+        Reset();
+        return Row(base::RefCountedSlice::CreateManaged(buf, total_len));
+    }
+
+    bool IsNull() const override {
+        return false;
+    }
+
+    void Reset() override {
+        Aggregator<T>::Reset();
+        hll_.Clear();
+    }
+
+ private:
+    template <class TT = T>
+    static uint64_t Hash(const TT& val, std::enable_if_t<std::is_integral<TT>{}>* = nullptr) {
+        return base::HyperLogLog::HashInt(val);
+    }
+
+    template <class TT = T>
+    static uint64_t Hash(const TT& val, std::enable_if_t<std::is_floating_point<TT>{}>* = nullptr) {
+        return base::HyperLogLog::HashDouble(val);
+    }
+
+    template <class TT = T>
+    static uint64_t Hash(const TT& val, std::enable_if_t<!std::is_arithmetic<TT>{}>* = nullptr) {
+        return base::HyperLogLog::HashBytes(val.data(), val.size());
+    }
+
+    base::HyperLogLog hll_;
+};
+
 template <template<class> class AggregatorClass>
 std::unique_ptr<BaseAggregator> MakeOverflowAggregator(type::Type agg_col_type, const Schema& output_schema) {
     switch (agg_col_type) {
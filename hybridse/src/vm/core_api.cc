@@ -190,9 +190,10 @@ hybridse::vm::TableHandler* GroupbyInterface::GetTableHandler() {
 
 hybridse::codec::Row CoreAPI::RowConstProject(const RawPtrHandle fn,
                                               const Row parameter,
-                                              const bool need_free) {
+                                              const bool need_free,
+                                              const std::shared_ptr<MemoryTracker>& tracker) {
     // Init current run step runtime
-    JitRuntime::get()->InitRunStep();
+    JitRuntime::get()->InitRunStep(tracker);
 
     auto udf = reinterpret_cast<int32_t (*)(const int64_t, const int8_t*,
                                             const int8_t*, const int8_t*, int8_t**)>(
@@ -215,12 +216,13 @@ hybridse::codec::Row CoreAPI::RowConstProject(const RawPtrHandle fn,
 hybridse::codec::Row CoreAPI::RowProject(const RawPtrHandle fn,
                                          const hybridse::codec::Row row,
                                          const hybridse::codec::Row parameter,
-                                         const bool need_free) {
+                                         const bool need_free,
+                                         const std::shared_ptr<MemoryTracker>& tracker) {
     if (row.empty()) {
         return hybridse::codec::Row();
     }
     // Init current run step runtime
-    JitRuntime::get()->InitRunStep();
+    JitRuntime::get()->InitRunStep(tracker);
 
     auto udf = reinterpret_cast<int32_t (*)(const int64_t, const int8_t*,
                                             const int8_t*, const int8_t*, int8_t**)>(
@@ -246,14 +248,15 @@ hybridse::codec::Row CoreAPI::RowProject(const RawPtrHandle fn,
 hybridse::codec::Row CoreAPI::UnsafeRowProject(
     const hybridse::vm::RawPtrHandle fn,
     hybridse::vm::ByteArrayPtr inputUnsafeRowBytes,
-    const int inputRowSizeInBytes, const bool need_free) {
+    const int inputRowSizeInBytes, const bool need_free,
+    const std::shared_ptr<MemoryTracker>& tracker) {
     // Create Row from input UnsafeRow bytes
     auto inputRow = Row(base::RefCountedSlice::Create(inputUnsafeRowBytes,
                                                       inputRowSizeInBytes));
     auto row_ptr = reinterpret_cast<const int8_t*>(&inputRow);
 
     // Init current run step runtime
-    JitRuntime::get()->InitRunStep();
+    JitRuntime::get()->InitRunStep(tracker);
 
     auto udf = reinterpret_cast<int32_t (*)(const int64_t, const int8_t*,
                                             const int8_t*, const int8_t*, int8_t**)>(
@@ -287,8 +290,8 @@ hybridse::codec::Row CoreAPI::WindowProject(const RawPtrHandle fn,
     if (row.empty()) {
         return row;
     }
-    // Init current run step runtime
-    JitRuntime::get()->InitRunStep();
+    // Init current run step runtime, charging the memory of the window
+    JitRuntime::get()->InitRunStep(window->GetWindow()->GetMemoryTracker());
 
     auto udf = reinterpret_cast<int32_t (*)(const int64_t, const int8_t*,
                                             const int8_t*, const int8_t*, int8_t**)>(
@@ -345,8 +348,9 @@ bool CoreAPI::ComputeCondition(const hybridse::vm::RawPtrHandle fn,
                                const Row& row,
                                const Row& parameter,
                                const hybridse::codec::RowView* row_view,
-                               size_t out_idx) {
-    Row cond_row = CoreAPI::RowProject(fn, row, parameter, true);
+                               size_t out_idx,
+                               const std::shared_ptr<MemoryTracker>& tracker) {
+    Row cond_row = CoreAPI::RowProject(fn, row, parameter, true, tracker);
     return Runner::GetColumnBool(cond_row.buf(), row_view, out_idx,
                                  row_view->GetSchema()->Get(out_idx).type());
 }
@@ -126,19 +126,22 @@ class CoreAPI {
 
     static size_t GetUniqueID(const hybridse::vm::PhysicalOpNode* node);
 
+    // the JIT arena of a project is charged to `tracker` if not null
     static hybridse::codec::Row RowProject(const hybridse::vm::RawPtrHandle fn,
                                            const hybridse::codec::Row row,
                                            const hybridse::codec::Row parameter,
-                                           const bool need_free = false);
+                                           const bool need_free = false,
+                                           const std::shared_ptr<MemoryTracker>& tracker = nullptr);
     static hybridse::codec::Row RowConstProject(
         const hybridse::vm::RawPtrHandle fn, const hybridse::codec::Row parameter,
-        const bool need_free = false);
+        const bool need_free = false, const std::shared_ptr<MemoryTracker>& tracker = nullptr);
 
     // Row project API with Spark UnsafeRow optimization
     static hybridse::codec::Row UnsafeRowProject(
         const hybridse::vm::RawPtrHandle fn,
         hybridse::vm::ByteArrayPtr inputUnsafeRowBytes,
-        const int inputRowSizeInBytes, const bool need_free = false);
+        const int inputRowSizeInBytes, const bool need_free = false,
+        const std::shared_ptr<MemoryTracker>& tracker = nullptr);
 
     static void CopyRowToUnsafeRowBytes(const hybridse::codec::Row inputRow,
                                         hybridse::vm::ByteArrayPtr outputBytes,
@@ -167,7 +170,8 @@ class CoreAPI {
                                  const Row& row,
                                  const Row& parameter,
                                  const hybridse::codec::RowView* row_view,
-                                 size_t out_idx);
+                                 size_t out_idx,
+                                 const std::shared_ptr<MemoryTracker>& tracker = nullptr);
 
     static bool EnableSignalTraceback();
 };
@@ -15,6 +15,8 @@
  */
 
 #include "vm/engine.h"
+#include <set>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -50,6 +52,7 @@ EngineOptions::EngineOptions()
       enable_expr_optimize_(true),
       enable_batch_window_parallelization_(false),
       enable_window_column_pruning_(false),
+      enable_request_pipeline_(false),
       max_sql_cache_size_(50) {
 }
 
@@ -225,8 +228,10 @@ bool Engine::Get(const std::string& sql, const std::string& db, RunSession& sess
     sql_context.is_batch_request_optimized = options_.IsBatchRequestOptimized();
     sql_context.enable_batch_window_parallelization = options_.IsEnableBatchWindowParallelization();
     sql_context.enable_window_column_pruning = options_.IsEnableWindowColumnPruning();
+    sql_context.enable_request_pipeline = options_.IsEnableRequestPipeline();
     sql_context.enable_expr_optimize = options_.IsEnableExprOptimize();
     sql_context.jit_options = options_.jit_options();
+    sql_context.spill_options = options_.spill_options();
     sql_context.options = session.GetOptions();
     if (session.engine_mode() == kBatchMode) {
         sql_context.parameter_types = dynamic_cast<BatchRunSession*>(&session)->GetParameterSchema();
@@ -247,6 +252,9 @@ bool Engine::Get(const std::string& sql, const std::string& db, RunSession& sess
             LOG(WARNING) << "fail to build cluster job: " << status.msg;
             return false;
         }
+        if (session.engine_mode() != kBatchMode) {
+            sql_context.result_cache = SubplanResultCache::CreateFromOptions(sql_context.options.get());
+        }
     }
 
     SetCacheLocked(db, sql, session.engine_mode(), info);
@@ -431,6 +439,56 @@ bool Engine::SetCacheLocked(const std::string& db, const std::string& sql, Engin
     }
 }
 
+static void BuildProfilePlan(const Runner* runner, const std::string& tab, std::set<int32_t>* visited_ids,
+                             std::vector<std::pair<int32_t, std::string>>* plan) {
+    std::ostringstream oss;
+    runner->PrintRunnerInfo(oss, tab);
+    plan->emplace_back(runner->id_, oss.str());
+    if (!visited_ids->insert(runner->id_).second) {
+        return;
+    }
+    for (auto producer : runner->GetProducers()) {
+        BuildProfilePlan(producer, "  " + tab, visited_ids, plan);
+    }
+}
+
+// attach the profile to runner context for one run, and record the total cost and the peak memory of the run
+// when leaving the scope
+class RunProfileScope {
+ public:
+    RunProfileScope(RunnerProfile* profile, const Runner* root, RunnerContext* ctx) : profile_(profile), ctx_(ctx) {
+        if (nullptr == profile_) {
+            return;
+        }
+        std::set<int32_t> visited_ids;
+        std::vector<std::pair<int32_t, std::string>> plan;
+        BuildProfilePlan(root, "", &visited_ids, &plan);
+        profile_->SetPlan(plan);
+        ctx->SetProfile(profile_);
+        start_wall_ns_ = RunnerProfileGuard::WallNs();
+        start_cpu_ns_ = RunnerProfileGuard::ThreadCpuNs();
+    }
+    ~RunProfileScope() {
+        if (nullptr == profile_) {
+            return;
+        }
+        profile_->RecordTotal(RunnerProfileGuard::WallNs() - start_wall_ns_,
+                              RunnerProfileGuard::ThreadCpuNs() - start_cpu_ns_);
+        if (ctx_->memory_tracker()) {
+            for (auto& kv : ctx_->GetRunnerMemoryTrackers()) {
+                profile_->RecordPeakMemory(kv.first, kv.second->peak());
+            }
+            profile_->RecordTotalPeakMemory(ctx_->memory_tracker()->peak());
+        }
+    }
+
+ private:
+    RunnerProfile* profile_;
+    RunnerContext* ctx_;
+    uint64_t start_wall_ns_ = 0;
+    uint64_t start_cpu_ns_ = 0;
+};
+
 RunSession::RunSession(EngineMode engine_mode) : engine_mode_(engine_mode), is_debug_(false), sp_name_("") {}
 RunSession::~RunSession() {}
 
@@ -439,6 +497,22 @@ bool RunSession::SetCompileInfo(const std::shared_ptr<CompileInfo>& compile_info
     return true;
 }
 
+std::shared_ptr<MemoryTracker> RunSession::NewMemoryTracker() const {
+    int64_t limit = has_memory_limit_ ? memory_limit_ : MemoryTracker::GetDefaultQueryLimit();
+    if (limit < 0 && MemoryTracker::Process()->limit() < 0 && !is_profile_) {
+        return nullptr;
+    }
+    return MemoryTracker::Create(sp_name_.empty() ? "query" : sp_name_, limit);
+}
+
+static bool CheckMemoryLimit(const RunnerContext& ctx) {
+    if (ctx.MemoryLimitExceeded()) {
+        LOG(WARNING) << "fail to run: memory limit exceeded, " << ctx.memory_tracker()->ToString();
+        return false;
+    }
+    return true;
+}
+
 int32_t RequestRunSession::Run(const Row& in_row, Row* out_row) {
     DLOG(INFO) << "Request Row Run with main task";
     return Run(std::dynamic_pointer_cast<SqlCompileInfo>(compile_info_)->get_sql_context().cluster_job.main_task_id(),
@@ -454,9 +528,26 @@ int32_t RequestRunSession::Run(const uint32_t task_id, const Row& in_row, Row* o
         return -2;
     }
     DLOG(INFO) << "Request Row Run with task_id " << task_id;
-    RunnerContext ctx(&std::dynamic_pointer_cast<SqlCompileInfo>(compile_info_)->get_sql_context().cluster_job, in_row,
-                      sp_name_, is_debug_);
+    auto& sql_ctx = std::dynamic_pointer_cast<SqlCompileInfo>(compile_info_)->get_sql_context();
+    RunnerContext ctx(&sql_ctx.cluster_job, in_row, sp_name_, is_debug_);
+    ctx.SetResultCache(sql_ctx.result_cache.get());
+    memory_tracker_ = NewMemoryTracker();
+    ctx.SetMemoryTracker(memory_tracker_);
+    profile_ = is_profile_ ? std::make_shared<RunnerProfile>() : nullptr;
+    RunProfileScope profile_scope(profile_.get(), task, &ctx);
+    if (nullptr != subplan_executor_ && nullptr == profile_) {
+        ctx.SetSubplanExecutor(subplan_executor_);
+        // sub-queries are async, issue them before running the local subplans
+        if (static_cast<int32_t>(task_id) == sql_ctx.cluster_job.main_task_id()) {
+            for (auto runner : sql_ctx.cluster_job.prefetch_runners()) {
+                runner->RunWithCache(ctx);
+            }
+        }
+    }
     auto output = task->RunWithCache(ctx);
+    if (!CheckMemoryLimit(ctx)) {
+        return -1;
+    }
     if (!output) {
         LOG(WARNING) << "Run request plan output is null";
         return -1;
@@ -474,21 +565,29 @@ int32_t BatchRequestRunSession::Run(const std::vector<Row>& request_batch, std::
 }
 int32_t BatchRequestRunSession::Run(const uint32_t id, const std::vector<Row>& request_batch,
                                     std::vector<Row>& output) {
-    RunnerContext ctx(&std::dynamic_pointer_cast<SqlCompileInfo>(compile_info_)->get_sql_context().cluster_job,
-                      request_batch, sp_name_, is_debug_);
+    auto& sql_ctx = std::dynamic_pointer_cast<SqlCompileInfo>(compile_info_)->get_sql_context();
+    RunnerContext ctx(&sql_ctx.cluster_job, request_batch, sp_name_, is_debug_);
+    ctx.SetResultCache(sql_ctx.result_cache.get());
     auto task =
         std::dynamic_pointer_cast<SqlCompileInfo>(compile_info_)->get_sql_context().cluster_job.GetTask(id).GetRoot();
     if (nullptr == task) {
         LOG(WARNING) << "Fail to run request plan: taskid" << id << " not exist!";
         return -2;
     }
+    memory_tracker_ = NewMemoryTracker();
+    ctx.SetMemoryTracker(memory_tracker_);
+    profile_ = is_profile_ ? std::make_shared<RunnerProfile>() : nullptr;
+    RunProfileScope profile_scope(profile_.get(), task, &ctx);
     auto handler = task->BatchRequestRun(ctx);
+    if (!CheckMemoryLimit(ctx)) {
+        return -1;
+    }
     if (!handler) {
         LOG(WARNING) << "Run request plan output is null";
         return -1;
     }
     bool ok = Runner::ExtractRows(handler, output);
-    if (!ok) {
+    if (!ok || !CheckMemoryLimit(ctx)) {
         return -1;
     }
     ctx.ClearCache();
@@ -500,7 +599,15 @@ int32_t BatchRunSession::Run(std::vector<Row>& rows, uint64_t limit) {
 int32_t BatchRunSession::Run(const Row& parameter_row, std::vector<Row>& rows, uint64_t limit) {
     auto& sql_ctx = std::dynamic_pointer_cast<SqlCompileInfo>(compile_info_)->get_sql_context();
     RunnerContext ctx(&sql_ctx.cluster_job, parameter_row, is_debug_);
-    auto output = sql_ctx.cluster_job.GetTask(0).GetRoot()->RunWithCache(ctx);
+    auto root = sql_ctx.cluster_job.GetTask(0).GetRoot();
+    memory_tracker_ = NewMemoryTracker();
+    ctx.SetMemoryTracker(memory_tracker_);
+    profile_ = is_profile_ ? std::make_shared<RunnerProfile>() : nullptr;
+    RunProfileScope profile_scope(profile_.get(), root, &ctx);
+    auto output = root->RunWithCache(ctx);
+    if (!CheckMemoryLimit(ctx)) {
+        return -1;
+    }
     if (!output) {
         DLOG(INFO) << "Run batch plan output is empty";
         return 0;
@@ -516,7 +623,8 @@ int32_t BatchRunSession::Run(const Row& parameter_row, std::vector<Row>& rows, u
                 rows.push_back(iter->GetValue());
                 iter->Next();
             }
-            return 0;
+            // the lazy outputs run while iterating
+            return CheckMemoryLimit(ctx) ? 0 : -1;
         }
         case kRowHandler: {
             rows.push_back(std::dynamic_pointer_cast<RowHandler>(output)->GetValue());
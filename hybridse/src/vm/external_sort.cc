@@ -0,0 +1,506 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/external_sort.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <functional>
+#include <thread>  // NOLINT
+#include <utility>
+
+#include "glog/logging.h"
+#include "vm/mem_catalog.h"
+
+namespace hybridse {
+namespace vm {
+
+// rows sorted by one thread at least, so small buffers are sorted without threads
+static constexpr size_t kMinRowsPerThread = 4096;
+// runs merged at once at most, more runs are merged into bigger runs first
+static constexpr size_t kMaxMergeRuns = 64;
+static constexpr size_t kMaxSpillBufferSize = 256 * 1024;
+static constexpr size_t kMinSpillBufferSize = 4 * 1024;
+
+// an unlinked temporary file, the records are written then read back once. The
+// buffer is only allocated while writing and while reading, and charged to the tracker
+class SpillFile {
+ public:
+    static std::unique_ptr<SpillFile> Create(const std::string& dir, size_t buffer_size,
+                                             const std::shared_ptr<MemoryTracker>& tracker) {
+        std::string path = dir + "/hybridse_spill_XXXXXX";
+        std::vector<char> name(path.begin(), path.end());
+        name.push_back('\0');
+        int fd = mkstemp(name.data());
+        if (fd < 0) {
+            LOG(WARNING) << "fail to create spill file in " << dir << ": " << strerror(errno);
+            return nullptr;
+        }
+        // removed once closed, even if the process crashes
+        unlink(name.data());
+        return std::unique_ptr<SpillFile>(new SpillFile(fd, buffer_size, tracker));
+    }
+    ~SpillFile() {
+        ReleaseBuffer();
+        close(fd_);
+    }
+
+    bool Write(const SortRecord& record) {
+        AcquireBuffer();
+        WriteString(record.sort_key);
+        WriteString(record.key);
+        WriteBytes(&record.ts, sizeof(record.ts));
+        uint32_t slices = record.row.GetRowPtrCnt();
+        WriteBytes(&slices, sizeof(slices));
+        for (uint32_t i = 0; i < slices; i++) {
+            uint32_t size = record.row.size(i);
+            WriteBytes(&size, sizeof(size));
+            WriteBytes(record.row.buf(i), size);
+        }
+        return !error_;
+    }
+    // done writing, read from the start
+    bool Rewind() {
+        if (Flush() && lseek(fd_, 0, SEEK_SET) < 0) {
+            LOG(WARNING) << "fail to rewind spill file: " << strerror(errno);
+            error_ = true;
+        }
+        ReleaseBuffer();
+        return !error_;
+    }
+    bool Read(SortRecord* record) {
+        if (error_ || done_) {
+            return false;
+        }
+        AcquireBuffer();
+        uint32_t size = 0;
+        if (pos_ == end_ && !Fill()) {
+            // the end of the file is only expected between two records
+            done_ = true;
+            ReleaseBuffer();
+            return false;
+        }
+        uint32_t slices = 0;
+        if (!ReadBytes(&size, sizeof(size)) || !ReadString(size, &record->sort_key) ||
+            !ReadBytes(&size, sizeof(size)) || !ReadString(size, &record->key) ||
+            !ReadBytes(&record->ts, sizeof(record->ts)) || !ReadBytes(&slices, sizeof(slices)) || 0 == slices) {
+            return Fail();
+        }
+        Row row;
+        for (uint32_t i = 0; i < slices; i++) {
+            base::RefCountedSlice slice;
+            if (!ReadBytes(&size, sizeof(size)) || !ReadSlice(size, &slice)) {
+                return Fail();
+            }
+            if (0 == i) {
+                row = Row(slice);
+            } else {
+                row.Append(slice);
+            }
+        }
+        record->row = row;
+        return true;
+    }
+    bool error() const { return error_; }
+
+ private:
+    SpillFile(int fd, size_t buffer_size, const std::shared_ptr<MemoryTracker>& tracker)
+        : fd_(fd), buffer_size_(buffer_size), tracker_(tracker) {}
+
+    void AcquireBuffer() {
+        if (!buffer_) {
+            buffer_.reset(new char[buffer_size_]);
+            pos_ = 0;
+            end_ = 0;
+            if (tracker_) {
+                tracker_->Consume(buffer_size_);
+            }
+        }
+    }
+    void ReleaseBuffer() {
+        if (buffer_) {
+            buffer_.reset();
+            if (tracker_) {
+                tracker_->Release(buffer_size_);
+            }
+        }
+    }
+    bool Fail() {
+        error_ = true;
+        ReleaseBuffer();
+        return false;
+    }
+    // write the buffered bytes to the file
+    bool Flush() {
+        size_t done = 0;
+        while (!error_ && done < pos_) {
+            ssize_t n = write(fd_, buffer_.get() + done, pos_ - done);
+            if (n < 0 && EINTR == errno) {
+                continue;
+            }
+            if (n <= 0) {
+                LOG(WARNING) << "fail to write spill file: " << strerror(errno);
+                error_ = true;
+            } else {
+                done += n;
+            }
+        }
+        pos_ = 0;
+        return !error_;
+    }
+    // read the next bytes of the file into the buffer, return false at the end of the file
+    bool Fill() {
+        ssize_t n = 0;
+        do {
+            n = read(fd_, buffer_.get(), buffer_size_);
+        } while (n < 0 && EINTR == errno);
+        if (n < 0) {
+            LOG(WARNING) << "fail to read spill file: " << strerror(errno);
+            error_ = true;
+        }
+        pos_ = 0;
+        end_ = n > 0 ? n : 0;
+        return n > 0;
+    }
+    void WriteBytes(const void* data, size_t size) {
+        const char* src = static_cast<const char*>(data);
+        while (!error_ && size > 0) {
+            if (pos_ == buffer_size_ && !Flush()) {
+                return;
+            }
+            size_t n = std::min(size, buffer_size_ - pos_);
+            memcpy(buffer_.get() + pos_, src, n);
+            pos_ += n;
+            src += n;
+            size -= n;
+        }
+    }
+    void WriteString(const std::string& str) {
+        uint32_t size = str.size();
+        WriteBytes(&size, sizeof(size));
+        WriteBytes(str.data(), size);
+    }
+    bool ReadBytes(void* data, size_t size) {
+        char* dst = static_cast<char*>(data);
+        while (size > 0) {
+            if (pos_ == end_ && !Fill()) {
+                return false;
+            }
+            size_t n = std::min(size, end_ - pos_);
+            memcpy(dst, buffer_.get() + pos_, n);
+            pos_ += n;
+            dst += n;
+            size -= n;
+        }
+        return true;
+    }
+    bool ReadString(uint32_t size, std::string* str) {
+        str->resize(size);
+        return ReadBytes(&(*str)[0], size);
+    }
+    bool ReadSlice(uint32_t size, base::RefCountedSlice* slice) {
+        if (0 == size) {
+            *slice = base::RefCountedSlice();
+            return true;
+        }
+        int8_t* buf = static_cast<int8_t*>(malloc(size));
+        *slice = base::RefCountedSlice::CreateManaged(buf, size);
+        return ReadBytes(buf, size);
+    }
+
+    const int fd_;
+    const size_t buffer_size_;
+    const std::shared_ptr<MemoryTracker> tracker_;
+    std::unique_ptr<char[]> buffer_;
+    // the next byte to read or write in the buffer, and the end of the bytes read
+    size_t pos_ = 0;
+    size_t end_ = 0;
+    bool error_ = false;
+    bool done_ = false;
+};
+
+class SpillFileRun : public SortedRun {
+ public:
+    explicit SpillFileRun(std::unique_ptr<SpillFile> file) : file_(std::move(file)) {}
+    bool Read(SortRecord* record) override { return file_->Read(record); }
+    bool ok() const override { return !file_->error(); }
+
+ private:
+    std::unique_ptr<SpillFile> file_;
+};
+
+// the rows left in memory when the sort finishes, shared by their runs
+struct BufferedRecords {
+    std::vector<SortRecord> records;
+    MemoryReservation memory;
+};
+
+class MemoryRun : public SortedRun {
+ public:
+    MemoryRun(std::shared_ptr<BufferedRecords> buffer, std::vector<uint32_t> order)
+        : buffer_(std::move(buffer)), order_(std::move(order)) {}
+    bool Read(SortRecord* record) override {
+        if (pos_ >= order_.size()) {
+            return false;
+        }
+        *record = std::move(buffer_->records[order_[pos_++]]);
+        return true;
+    }
+
+ private:
+    std::shared_ptr<BufferedRecords> buffer_;
+    std::vector<uint32_t> order_;
+    size_t pos_ = 0;
+};
+
+// run fn(0), ..., fn(n - 1) on n threads, the calling thread runs fn(0)
+static void ParallelRun(size_t n, const std::function<void(size_t)>& fn) {
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < n; i++) {
+        threads.emplace_back(fn, i);
+    }
+    fn(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+static void AppendBigEndian(uint64_t value, std::string* output) {
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        output->push_back(static_cast<char>((value >> shift) & 0xFF));
+    }
+}
+
+// the first 8 bytes of a sort key, comparing the prefixes first keeps the
+// order of the full keys
+static uint64_t KeyPrefix(const std::string& sort_key) {
+    uint64_t prefix = 0;
+    size_t size = std::min<size_t>(8, sort_key.size());
+    for (size_t i = 0; i < size; i++) {
+        prefix |= static_cast<uint64_t>(static_cast<uint8_t>(sort_key[i])) << (56 - 8 * i);
+    }
+    return prefix;
+}
+
+SortedRowStream::SortedRowStream(std::vector<std::unique_ptr<SortedRun>> runs)
+    : runs_(std::move(runs)), heads_(runs_.size()) {
+    heap_.reserve(runs_.size());
+    for (size_t i = 0; i < runs_.size(); i++) {
+        Pull(i);
+    }
+}
+
+SortedRowStream::~SortedRowStream() {}
+
+static bool HeadGreater(const std::vector<SortRecord>& heads, size_t a, size_t b) {
+    return heads[a].sort_key > heads[b].sort_key;
+}
+
+void SortedRowStream::Pull(size_t run) {
+    if (runs_[run]->Read(&heads_[run])) {
+        heap_.push_back(run);
+        std::push_heap(heap_.begin(), heap_.end(),
+                       [this](size_t a, size_t b) { return HeadGreater(heads_, a, b); });
+    }
+}
+
+void SortedRowStream::Next() {
+    if (heap_.empty()) {
+        return;
+    }
+    size_t run = heap_.front();
+    std::pop_heap(heap_.begin(), heap_.end(), [this](size_t a, size_t b) { return HeadGreater(heads_, a, b); });
+    heap_.pop_back();
+    Pull(run);
+}
+
+bool SortedRowStream::ok() const {
+    for (auto& run : runs_) {
+        if (!run->ok()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+ExternalSorter::ExternalSorter(const SpillOptions& options, OrderType order,
+                               const std::shared_ptr<MemoryTracker>& tracker)
+    : options_(options),
+      order_(order),
+      spill_buffer_size_(std::min<int64_t>(
+          kMaxSpillBufferSize,
+          std::max<int64_t>(kMinSpillBufferSize, options.GetMemoryBudget() / (2 * kMaxMergeRuns)))),
+      // the read buffers of the runs merged at once take half of the budget at most
+      max_merge_runs_(std::min<int64_t>(
+          kMaxMergeRuns, std::max<int64_t>(2, options.GetMemoryBudget() / (2 * spill_buffer_size_)))),
+      memory_(tracker) {}
+
+ExternalSorter::~ExternalSorter() {}
+
+bool ExternalSorter::Add(const std::string& key, uint64_t ts, const Row& row) {
+    buffer_.emplace_back();
+    auto& record = buffer_.back();
+    // the partition key descending: each byte inverted, escaping the 0 bytes and
+    // ending with an inverted 0x0000, so a key sorts after the keys it prefixes
+    record.sort_key.reserve(key.size() + 2 + 2 * sizeof(uint64_t));
+    for (char c : key) {
+        if (0 == c) {
+            record.sort_key.push_back(static_cast<char>(0xFF));
+            record.sort_key.push_back(0);
+        } else {
+            record.sort_key.push_back(static_cast<char>(~c));
+        }
+    }
+    record.sort_key.push_back(static_cast<char>(0xFF));
+    record.sort_key.push_back(static_cast<char>(0xFF));
+    if (kAscOrder == order_) {
+        AppendBigEndian(ts, &record.sort_key);
+    } else if (kDescOrder == order_) {
+        AppendBigEndian(~ts, &record.sort_key);
+    }
+    AppendBigEndian(seq_++, &record.sort_key);
+    record.key = key;
+    record.ts = ts;
+    record.row = row;
+
+    int64_t bytes = sizeof(SortRecord) + record.sort_key.size() + key.size() + RowMemoryBytes(row);
+    buffer_bytes_ += bytes;
+    memory_.Grow(bytes);
+    // the spilled runs need a read buffer each when they are merged
+    int64_t merge_bytes = static_cast<int64_t>(spilled_.size() * spill_buffer_size_);
+    if (buffer_bytes_ + merge_bytes > options_.GetMemoryBudget() && options_.IsEnabled()) {
+        return Spill();
+    }
+    return true;
+}
+
+std::vector<std::vector<uint32_t>> ExternalSorter::SortBuffer(size_t max_runs) const {
+    size_t runs = std::max<size_t>(1, std::min(max_runs, buffer_.size() / kMinRowsPerThread));
+    size_t run_size = (buffer_.size() + runs - 1) / runs;
+    std::vector<std::vector<uint32_t>> orders(runs);
+    // the threads only read the buffered records, the rows are not copied as their
+    // slices are not thread safe to share
+    ParallelRun(runs, [&](size_t run) {
+        size_t begin = std::min(buffer_.size(), run * run_size);
+        size_t end = std::min(buffer_.size(), begin + run_size);
+        std::vector<std::pair<uint64_t, uint32_t>> entries;
+        entries.reserve(end - begin);
+        for (size_t i = begin; i < end; i++) {
+            entries.emplace_back(KeyPrefix(buffer_[i].sort_key), i);
+        }
+        std::sort(entries.begin(), entries.end(),
+                  [this](const std::pair<uint64_t, uint32_t>& a, const std::pair<uint64_t, uint32_t>& b) {
+                      if (a.first != b.first) {
+                          return a.first < b.first;
+                      }
+                      return buffer_[a.second].sort_key < buffer_[b.second].sort_key;
+                  });
+        auto& order = orders[run];
+        order.reserve(entries.size());
+        for (auto& entry : entries) {
+            order.push_back(entry.second);
+        }
+    });
+    return orders;
+}
+
+bool ExternalSorter::Spill() {
+    if (buffer_.empty()) {
+        return true;
+    }
+    auto orders = SortBuffer(std::max(options_.GetSortThreads(), 1u));
+    std::vector<std::unique_ptr<SpillFile>> files(orders.size());
+    ParallelRun(orders.size(), [&](size_t run) {
+        auto file = SpillFile::Create(options_.GetDir(), spill_buffer_size_, memory_.tracker());
+        if (!file) {
+            return;
+        }
+        for (uint32_t i : orders[run]) {
+            if (!file->Write(buffer_[i])) {
+                return;
+            }
+        }
+        if (file->Rewind()) {
+            files[run] = std::move(file);
+        }
+    });
+    memory_.Shrink(buffer_bytes_);
+    buffer_.clear();
+    buffer_bytes_ = 0;
+    for (auto& file : files) {
+        if (!file) {
+            LOG(WARNING) << "fail to spill sorted rows to " << options_.GetDir();
+            return false;
+        }
+        spilled_.push_back(std::make_unique<SpillFileRun>(std::move(file)));
+    }
+    spilled_runs_ += files.size();
+    DLOG(INFO) << "spill " << files.size() << " sorted runs, " << spilled_runs_ << " runs in total";
+    return MergeSpilled();
+}
+
+bool ExternalSorter::MergeSpilled() {
+    while (spilled_.size() > max_merge_runs_) {
+        std::vector<std::unique_ptr<SortedRun>> runs;
+        for (size_t i = 0; i < max_merge_runs_; i++) {
+            runs.push_back(std::move(spilled_[i]));
+        }
+        spilled_.erase(spilled_.begin(), spilled_.begin() + max_merge_runs_);
+        SortedRowStream merging(std::move(runs));
+        auto file = SpillFile::Create(options_.GetDir(), spill_buffer_size_, memory_.tracker());
+        if (!file) {
+            return false;
+        }
+        for (; merging.Valid(); merging.Next()) {
+            if (!file->Write(merging.GetRecord())) {
+                return false;
+            }
+        }
+        if (!merging.ok() || !file->Rewind()) {
+            LOG(WARNING) << "fail to merge spilled runs";
+            return false;
+        }
+        spilled_.push_back(std::make_unique<SpillFileRun>(std::move(file)));
+    }
+    return true;
+}
+
+std::unique_ptr<SortedRowStream> ExternalSorter::Finish() {
+    // the spilled runs are merged down to max_merge_runs_ as they are spilled
+    auto runs = std::move(spilled_);
+    spilled_.clear();
+    if (!buffer_.empty()) {
+        // the rows not spilled are merged with the spilled runs in memory
+        auto orders = SortBuffer(runs.empty() ? std::max(options_.GetSortThreads(), 1u) : 1);
+        auto buffered = std::make_shared<BufferedRecords>();
+        buffered->memory.SetTracker(memory_.tracker());
+        buffered->records.swap(buffer_);
+        buffered->memory.Grow(buffer_bytes_);
+        memory_.Shrink(buffer_bytes_);
+        buffer_bytes_ = 0;
+        for (auto& order : orders) {
+            runs.push_back(std::make_unique<MemoryRun>(buffered, std::move(order)));
+        }
+    }
+    return std::make_unique<SortedRowStream>(std::move(runs));
+}
+
+}  // namespace vm
+}  // namespace hybridse
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYBRIDSE_SRC_VM_EXTERNAL_SORT_H_
+#define HYBRIDSE_SRC_VM_EXTERNAL_SORT_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "vm/catalog.h"
+#include "vm/engine_context.h"
+#include "vm/memory_tracker.h"
+
+namespace hybridse {
+namespace vm {
+
+/// \brief A row of ExternalSorter with its partition key and order key
+struct SortRecord {
+    // the normalized sort key, the memcmp order of the sort keys is the order of the rows
+    std::string sort_key;
+    std::string key;
+    uint64_t ts = 0;
+    Row row;
+};
+
+// a sorted run of records, in memory or in a spill file
+class SortedRun {
+ public:
+    virtual ~SortedRun() {}
+    // move the next record of the run into `record`, return false at the end of the run
+    virtual bool Read(SortRecord* record) = 0;
+    // return false if the run fails to read
+    virtual bool ok() const { return true; }
+};
+
+/// \brief SortedRowStream iterates the rows of an ExternalSorter in order,
+/// merging its sorted runs. It only holds the current row of each run.
+class SortedRowStream {
+ public:
+    explicit SortedRowStream(std::vector<std::unique_ptr<SortedRun>> runs);
+    ~SortedRowStream();
+
+    bool Valid() const { return !heap_.empty(); }
+    void Next();
+    const SortRecord& GetRecord() const { return heads_[heap_.front()]; }
+    const std::string& GetKey() const { return GetRecord().key; }
+    const uint64_t& GetTs() const { return GetRecord().ts; }
+    const Row& GetRow() const { return GetRecord().row; }
+    // return false if a spill file failed to read, the stream ends early then
+    bool ok() const;
+
+ private:
+    // add the next record of the run to the heap
+    void Pull(size_t run);
+
+    std::vector<std::unique_ptr<SortedRun>> runs_;
+    // the current record of each run
+    std::vector<SortRecord> heads_;
+    // the runs with a current record, a min heap of their sort keys
+    std::vector<size_t> heap_;
+};
+
+/// \brief The rows of one partition key of a SortedRowStream, consuming the
+/// stream as it iterates. It can not seek.
+class SortedSegmentIterator : public RowIterator {
+ public:
+    SortedSegmentIterator(SortedRowStream* stream, const std::string& key) : stream_(stream), key_(key) {}
+    ~SortedSegmentIterator() {}
+    bool Valid() const override { return stream_->Valid() && stream_->GetKey() == key_; }
+    void Next() override { stream_->Next(); }
+    const uint64_t& GetKey() const override { return stream_->GetTs(); }
+    const Row& GetValue() override { return stream_->GetRow(); }
+    bool IsSeekable() const override { return false; }
+    void Seek(const uint64_t& key) override {}
+    void SeekToFirst() override {}
+
+ private:
+    SortedRowStream* stream_;
+    const std::string key_;
+};
+
+/// \brief ExternalSorter sorts rows by a partition key and an order key under a
+/// memory budget, it groups the rows of a partition like PartitionGenerator and
+/// sorts them like SortGenerator.
+///
+/// The rows are ordered by the partition key descending, the order of the
+/// segments of MemPartitionHandler, then by the order key as `order`, and keep
+/// the order they are added for the same keys or if `order` is kNoneOrder.
+/// Each row gets a normalized sort key, so rows compare with one memcmp, and
+/// the sort itself only moves the first 8 bytes of the keys and the indices.
+///
+/// Once the buffered rows take more than the budget, they are sorted by up to
+/// `GetSortThreads()` threads and written to disk as sorted runs. Whenever there
+/// are more runs than can be merged at once, the oldest are merged into one, so
+/// the read buffers of the final merge in Finish take half of the budget at most
+/// and are counted with the buffered rows. Without spill, the rows are sorted in
+/// memory and nothing is written. The buffered rows and the buffers of the spill
+/// files are charged to `tracker` if it is not null.
+class ExternalSorter {
+ public:
+    ExternalSorter(const SpillOptions& options, OrderType order,
+                   const std::shared_ptr<MemoryTracker>& tracker = nullptr);
+    ~ExternalSorter();
+
+    // add a row of partition `key` and order key `ts`, return false if it fails to spill
+    bool Add(const std::string& key, uint64_t ts, const Row& row);
+    // finish adding rows and return the sorted rows, null if it fails to spill
+    std::unique_ptr<SortedRowStream> Finish();
+
+    // the number of runs spilled to disk
+    size_t GetSpilledRuns() const { return spilled_runs_; }
+
+ private:
+    // sort the buffered rows into at most `max_runs` runs in parallel, return the
+    // indices of the rows of each run in order
+    std::vector<std::vector<uint32_t>> SortBuffer(size_t max_runs) const;
+    // write the buffered rows to disk as sorted runs
+    bool Spill();
+    // merge the oldest spilled runs into one until at most `max_merge_runs_` are left
+    bool MergeSpilled();
+
+    const SpillOptions options_;
+    const OrderType order_;
+    // the buffer of each spill file being written or read
+    const size_t spill_buffer_size_;
+    const size_t max_merge_runs_;
+    uint64_t seq_ = 0;
+    std::vector<SortRecord> buffer_;
+    int64_t buffer_bytes_ = 0;
+    MemoryReservation memory_;
+    std::vector<std::unique_ptr<SortedRun>> spilled_;
+    size_t spilled_runs_ = 0;
+};
+
+}  // namespace vm
+}  // namespace hybridse
+#endif  // HYBRIDSE_SRC_VM_EXTERNAL_SORT_H_
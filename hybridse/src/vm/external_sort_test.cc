@@ -0,0 +1,240 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/external_sort.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace hybridse {
+namespace vm {
+using hybridse::codec::Row;
+class ExternalSortTest : public ::testing::Test {};
+
+typedef std::tuple<std::string, uint64_t, std::string> SortedRow;
+
+static std::vector<SortedRow> ReadAll(SortedRowStream* stream) {
+    std::vector<SortedRow> rows;
+    for (; stream->Valid(); stream->Next()) {
+        rows.emplace_back(stream->GetKey(), stream->GetTs(), stream->GetRow().ToString());
+    }
+    return rows;
+}
+
+// a row owning a copy of str
+static Row MakeRow(const std::string& str) {
+    int8_t* buf = static_cast<int8_t*>(malloc(str.size()));
+    memcpy(buf, str.data(), str.size());
+    return Row(base::RefCountedSlice::CreateManaged(buf, str.size()));
+}
+
+static SpillOptions SpillAt(int64_t budget) {
+    SpillOptions options;
+    options.SetMemoryBudget(budget);
+    return options;
+}
+
+TEST_F(ExternalSortTest, sort_in_memory_test) {
+    ExternalSorter sorter(SpillOptions(), kAscOrder);
+    ASSERT_TRUE(sorter.Add("a", 3, MakeRow("a3")));
+    ASSERT_TRUE(sorter.Add("b", 1, MakeRow("b1")));
+    ASSERT_TRUE(sorter.Add("a", 1, MakeRow("a1")));
+    ASSERT_TRUE(sorter.Add("a", 3, MakeRow("a3'")));
+    ASSERT_TRUE(sorter.Add("b", 2, MakeRow("b2")));
+    auto stream = sorter.Finish();
+    ASSERT_TRUE(stream != nullptr);
+    // keys descending, then ts ascending, then the order of adding
+    std::vector<SortedRow> expect = {
+        {"b", 1, "b1"}, {"b", 2, "b2"}, {"a", 1, "a1"}, {"a", 3, "a3"}, {"a", 3, "a3'"}};
+    ASSERT_EQ(expect, ReadAll(stream.get()));
+    ASSERT_TRUE(stream->ok());
+    ASSERT_EQ(0u, sorter.GetSpilledRuns());
+}
+
+TEST_F(ExternalSortTest, key_order_test) {
+    // the keys are ordered as std::greater<std::string>, as the segments of MemPartitionHandler
+    std::vector<std::string> keys = {"a", "ab", std::string("a\0", 2), "abc", "", "b", "\xff", std::string("\0", 1)};
+    for (auto order : {kAscOrder, kDescOrder, kNoneOrder}) {
+        ExternalSorter sorter(SpillOptions(), order);
+        for (auto& key : keys) {
+            ASSERT_TRUE(sorter.Add(key, 0, MakeRow(key + "-row")));
+        }
+        auto stream = sorter.Finish();
+        std::vector<std::string> sorted;
+        for (; stream->Valid(); stream->Next()) {
+            sorted.push_back(stream->GetKey());
+        }
+        auto expect = keys;
+        std::sort(expect.begin(), expect.end(), std::greater<std::string>());
+        ASSERT_EQ(expect, sorted);
+    }
+}
+
+TEST_F(ExternalSortTest, ts_order_test) {
+    std::vector<uint64_t> ts = {5, 1, 3, 1, 0, UINT64_MAX, 4};
+    {
+        ExternalSorter sorter(SpillOptions(), kDescOrder);
+        for (size_t i = 0; i < ts.size(); i++) {
+            sorter.Add("k", ts[i], MakeRow(std::to_string(i)));
+        }
+        auto rows = ReadAll(sorter.Finish().get());
+        std::vector<SortedRow> expect = {{"k", UINT64_MAX, "5"}, {"k", 5, "0"}, {"k", 4, "6"}, {"k", 3, "2"},
+                                         {"k", 1, "1"},          {"k", 1, "3"}, {"k", 0, "4"}};
+        ASSERT_EQ(expect, rows);
+    }
+    {
+        // kNoneOrder keeps the order of adding
+        ExternalSorter sorter(SpillOptions(), kNoneOrder);
+        for (size_t i = 0; i < ts.size(); i++) {
+            sorter.Add("k", ts[i], MakeRow(std::to_string(i)));
+        }
+        auto rows = ReadAll(sorter.Finish().get());
+        ASSERT_EQ(ts.size(), rows.size());
+        for (size_t i = 0; i < ts.size(); i++) {
+            ASSERT_EQ(ts[i], std::get<1>(rows[i]));
+            ASSERT_EQ(std::to_string(i), std::get<2>(rows[i]));
+        }
+    }
+}
+
+TEST_F(ExternalSortTest, spill_test) {
+    std::mt19937 rand(42);
+    std::vector<SortedRow> input;
+    for (int i = 0; i < 40000; i++) {
+        input.emplace_back("key" + std::to_string(rand() % 50), rand() % 1000,
+                           "row" + std::to_string(i) + std::string(rand() % 100, 'x'));
+    }
+    for (auto order : {kAscOrder, kDescOrder, kNoneOrder}) {
+        ExternalSorter memory_sorter(SpillOptions(), order);
+        auto options = SpillAt(4 << 20);
+        options.SetSortThreads(4);
+        ExternalSorter spill_sorter(options, order);
+        for (auto& row : input) {
+            ASSERT_TRUE(memory_sorter.Add(std::get<0>(row), std::get<1>(row), MakeRow(std::get<2>(row))));
+            ASSERT_TRUE(spill_sorter.Add(std::get<0>(row), std::get<1>(row), MakeRow(std::get<2>(row))));
+        }
+        auto expect = ReadAll(memory_sorter.Finish().get());
+        auto stream = spill_sorter.Finish();
+        ASSERT_TRUE(stream != nullptr);
+        ASSERT_EQ(expect, ReadAll(stream.get()));
+        ASSERT_TRUE(stream->ok());
+        ASSERT_EQ(0u, memory_sorter.GetSpilledRuns());
+        ASSERT_GT(spill_sorter.GetSpilledRuns(), 1u);
+    }
+}
+
+TEST_F(ExternalSortTest, merge_many_runs_test) {
+    // every row spills as a run, the runs are merged in more than one pass
+    ExternalSorter sorter(SpillAt(0), kAscOrder);
+    for (int i = 0; i < 300; i++) {
+        ASSERT_TRUE(sorter.Add(std::to_string(i % 7), 300 - i, MakeRow(std::to_string(i))));
+    }
+    ASSERT_EQ(300u, sorter.GetSpilledRuns());
+    auto stream = sorter.Finish();
+    ASSERT_TRUE(stream != nullptr);
+    auto rows = ReadAll(stream.get());
+    ASSERT_TRUE(stream->ok());
+    ASSERT_EQ(300u, rows.size());
+    for (size_t i = 1; i < rows.size(); i++) {
+        auto& prev = rows[i - 1];
+        auto& cur = rows[i];
+        ASSERT_TRUE(std::get<0>(prev) > std::get<0>(cur) ||
+                    (std::get<0>(prev) == std::get<0>(cur) && std::get<1>(prev) < std::get<1>(cur)));
+    }
+}
+
+TEST_F(ExternalSortTest, spill_row_slices_test) {
+    ExternalSorter sorter(SpillAt(0), kAscOrder);
+    Row row = MakeRow("first");
+    row.Append(base::RefCountedSlice());
+    row.Append(MakeRow("third").GetSlice(0));
+    ASSERT_TRUE(sorter.Add("k", 1, row));
+    auto stream = sorter.Finish();
+    ASSERT_TRUE(stream->Valid());
+    auto& spilled = stream->GetRow();
+    ASSERT_EQ(3, spilled.GetRowPtrCnt());
+    ASSERT_EQ("first", std::string(reinterpret_cast<char*>(spilled.buf(0)), spilled.size(0)));
+    ASSERT_EQ(0, spilled.size(1));
+    ASSERT_EQ("third", std::string(reinterpret_cast<char*>(spilled.buf(2)), spilled.size(2)));
+}
+
+TEST_F(ExternalSortTest, segment_iterator_test) {
+    ExternalSorter sorter(SpillAt(64), kDescOrder);
+    for (int i = 0; i < 10; i++) {
+        sorter.Add(i % 2 == 0 ? "even" : "odd", i, MakeRow(std::to_string(i)));
+    }
+    auto stream = sorter.Finish();
+    std::vector<uint64_t> odd;
+    for (SortedSegmentIterator iter(stream.get(), "odd"); iter.Valid(); iter.Next()) {
+        odd.push_back(iter.GetKey());
+    }
+    ASSERT_EQ(std::vector<uint64_t>({9, 7, 5, 3, 1}), odd);
+    std::vector<std::string> even;
+    for (SortedSegmentIterator iter(stream.get(), "even"); iter.Valid(); iter.Next()) {
+        even.push_back(iter.GetValue().ToString());
+    }
+    ASSERT_EQ(std::vector<std::string>({"8", "6", "4", "2", "0"}), even);
+    ASSERT_FALSE(stream->Valid());
+}
+
+TEST_F(ExternalSortTest, memory_tracker_test) {
+    auto query = MemoryTracker::Create("query", -1);
+    {
+        ExternalSorter sorter(SpillAt(64 * 1024), kAscOrder, query);
+        for (int i = 0; i < 10000; i++) {
+            sorter.Add(std::to_string(i % 10), i, MakeRow(std::string(100, 'x')));
+            ASSERT_LT(query->consumption(), 256 * 1024);
+        }
+        auto stream = sorter.Finish();
+        ASSERT_GT(query->consumption(), 0);
+    }
+    ASSERT_EQ(0, query->consumption());
+}
+
+TEST_F(ExternalSortTest, spill_buffer_memory_test) {
+    auto query = MemoryTracker::Create("query", -1);
+    {
+        ExternalSorter sorter(SpillAt(0), kAscOrder, query);
+        for (int i = 0; i < 300; i++) {
+            ASSERT_TRUE(sorter.Add(std::to_string(i % 7), i, MakeRow(std::string(100, 'x'))));
+            // the spilled runs hold no buffer until they are merged
+            ASSERT_LT(query->consumption(), 16 * 1024);
+        }
+        auto stream = sorter.Finish();
+        ASSERT_TRUE(stream != nullptr);
+        // the read buffers of the runs being merged are charged
+        ASSERT_GT(query->consumption(), 0);
+        ASSERT_EQ(300u, ReadAll(stream.get()).size());
+        ASSERT_TRUE(stream->ok());
+    }
+    ASSERT_EQ(0, query->consumption());
+}
+
+}  // namespace vm
+}  // namespace hybridse
+int main(int argc, char** argv) {
+    ::testing::GTEST_FLAG(color) = "yes";
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
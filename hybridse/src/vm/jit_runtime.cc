@@ -23,6 +23,10 @@ thread_local JitRuntime JitRuntime::tls_runtime_inst_;
 JitRuntime* JitRuntime::get() { return &tls_runtime_inst_; }
 
 int8_t* JitRuntime::AllocManaged(size_t bytes) {
+    if (tracker_) {
+        tracker_->Consume(bytes);
+        charged_bytes_ += bytes;
+    }
     return reinterpret_cast<int8_t*>(mem_pool_.Alloc(bytes));
 }
 
@@ -32,10 +36,21 @@ void JitRuntime::AddManagedObject(base::FeBaseObject* obj) {
     }
 }
 
-void JitRuntime::InitRunStep() {}
+void JitRuntime::InitRunStep(const std::shared_ptr<MemoryTracker>& tracker) {
+    if (tracker_) {
+        tracker_->Release(charged_bytes_);
+        charged_bytes_ = 0;
+    }
+    tracker_ = tracker;
+}
 
 void JitRuntime::ReleaseRunStep() {
     mem_pool_.Reset();
+    if (tracker_) {
+        tracker_->Release(charged_bytes_);
+        tracker_.reset();
+        charged_bytes_ = 0;
+    }
     for (base::FeBaseObject* obj : allocated_obj_pool_) {
         if (obj != nullptr) {
             delete obj;
@@ -17,9 +17,11 @@
 #define HYBRIDSE_SRC_VM_JIT_RUNTIME_H_
 
 #include <list>
+#include <memory>
 
 #include "base/fe_object.h"
 #include "base/mem_pool.h"
+#include "vm/memory_tracker.h"
 
 namespace hybridse {
 namespace vm {
@@ -36,7 +38,8 @@ class JitRuntime {
     /**
      * Allocate raw memory with specified bytes.
      * Return nullptr on failure. All allocated memory
-     * will be released by `ReleaseRunStep()`.
+     * will be released by `ReleaseRunStep()`. The memory is
+     * charged to the tracker of the run step until then.
      */
     int8_t* AllocManaged(size_t bytes);
 
@@ -51,9 +54,10 @@ class JitRuntime {
     void AddManagedObject(base::FeBaseObject* obj);
 
     /**
-     * Initialize before each single run step
+     * Initialize before each single run step, the managed
+     * memory of the step is charged to `tracker` if not null
      */
-    void InitRunStep();
+    void InitRunStep(const std::shared_ptr<MemoryTracker>& tracker = nullptr);
 
     /**
      * Release resources allocated in run step
@@ -63,6 +67,9 @@ class JitRuntime {
  private:
     openmldb::base::ByteMemoryPool mem_pool_;
     std::list<base::FeBaseObject*> allocated_obj_pool_;
+    // the tracker charged by the current run step and the charged bytes
+    std::shared_ptr<MemoryTracker> tracker_;
+    int64_t charged_bytes_ = 0;
 
     static thread_local JitRuntime tls_runtime_inst_;
 };
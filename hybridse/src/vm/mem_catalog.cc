@@ -124,14 +124,22 @@ std::unique_ptr<WindowIterator> MemTimeTableHandler::GetWindowIterator(
 
 void MemTimeTableHandler::AddRow(const uint64_t key, const Row& row) {
     table_.emplace_back(key, row);
+    memory_.Grow(RowMemoryBytes(row));
 }
 
 void MemTimeTableHandler::AddFrontRow(const uint64_t key, const Row& row) {
     table_.emplace_front(key, row);
+    memory_.Grow(RowMemoryBytes(row));
+}
+void MemTimeTableHandler::PopBackRow() {
+    memory_.Shrink(RowMemoryBytes(table_.back().second));
+    table_.pop_back();
 }
-void MemTimeTableHandler::PopBackRow() { table_.pop_back(); }
 
-void MemTimeTableHandler::PopFrontRow() { table_.pop_front(); }
+void MemTimeTableHandler::PopFrontRow() {
+    memory_.Shrink(RowMemoryBytes(table_.front().second));
+    table_.pop_front();
+}
 
 const Types& MemTimeTableHandler::GetTypes() { return types_; }
 
@@ -189,10 +197,12 @@ bool MemPartitionHandler::AddRow(const std::string& key, uint64_t ts,
     if (iter == partitions_.cend()) {
         partitions_.insert(std::pair<std::string, MemTimeTable>(
             key, {std::make_pair(ts, row)}));
+        memory_.Grow(sizeof(MemSegmentMap::value_type) + key.size());
     } else {
         iter->second.push_back(std::make_pair(ts, row));
     }
-    return true;
+    memory_.Grow(RowMemoryBytes(row));
+    return !memory_.LimitExceeded();
 }
 std::unique_ptr<WindowIterator> MemPartitionHandler::GetWindowIterator() {
     return std::unique_ptr<WindowIterator>(
@@ -273,13 +283,26 @@ MemTableHandler::MemTableHandler(const std::string& table_name,
       index_hint_(),
       table_(),
       order_type_(kNoneOrder) {}
-void MemTableHandler::AddRow(const Row& row) { table_.push_back(row); }
-void MemTableHandler::Resize(const size_t size) { table_.resize(size); }
+void MemTableHandler::AddRow(const Row& row) {
+    table_.push_back(row);
+    memory_.Grow(RowMemoryBytes(row));
+}
+void MemTableHandler::Resize(const size_t size) {
+    for (size_t idx = size; idx < table_.size(); idx++) {
+        memory_.Shrink(RowMemoryBytes(table_[idx]));
+    }
+    if (size > table_.size()) {
+        memory_.Grow((size - table_.size()) * RowMemoryBytes(Row()));
+    }
+    table_.resize(size);
+}
 bool MemTableHandler::SetRow(const size_t idx, const Row& row) {
     if (idx >= table_.size()) {
         return false;
     }
+    memory_.Shrink(RowMemoryBytes(table_[idx]));
     table_[idx] = row;
+    memory_.Grow(RowMemoryBytes(row));
     return true;
 }
 void MemTableHandler::Reverse() {
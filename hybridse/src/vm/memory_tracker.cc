@@ -0,0 +1,119 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/memory_tracker.h"
+
+#include <algorithm>
+#include <sstream>
+#include <utility>
+
+namespace hybridse {
+namespace vm {
+
+static std::atomic<int64_t> default_query_limit{-1};
+
+MemoryTracker* MemoryTracker::Process() {
+    static std::shared_ptr<MemoryTracker> process(new MemoryTracker("process", -1, nullptr));
+    return process.get();
+}
+
+int64_t MemoryTracker::GetDefaultQueryLimit() { return default_query_limit.load(std::memory_order_relaxed); }
+
+void MemoryTracker::SetDefaultQueryLimit(int64_t limit) {
+    default_query_limit.store(limit, std::memory_order_relaxed);
+}
+
+std::shared_ptr<MemoryTracker> MemoryTracker::Create(const std::string& label, int64_t limit,
+                                                     std::shared_ptr<MemoryTracker> parent) {
+    if (!parent) {
+        parent = Process()->shared_from_this();
+    }
+    return std::shared_ptr<MemoryTracker>(new MemoryTracker(label, limit, std::move(parent)));
+}
+
+MemoryTracker::MemoryTracker(const std::string& label, int64_t limit, std::shared_ptr<MemoryTracker> parent)
+    : label_(label), limit_(limit), parent_(std::move(parent)) {}
+
+bool MemoryTracker::Consume(int64_t bytes) {
+    MemoryTracker* exceeded = nullptr;
+    for (auto tracker = this; tracker != nullptr; tracker = tracker->parent_.get()) {
+        int64_t consumption = tracker->consumption_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        int64_t peak = tracker->peak_.load(std::memory_order_relaxed);
+        while (consumption > peak &&
+               !tracker->peak_.compare_exchange_weak(peak, consumption, std::memory_order_relaxed)) {
+        }
+        int64_t limit = tracker->limit();
+        if (limit >= 0 && consumption > limit) {
+            exceeded = tracker;
+        }
+    }
+    if (nullptr == exceeded) {
+        return true;
+    }
+    for (auto tracker = this; tracker != nullptr && tracker->parent_ != nullptr; tracker = tracker->parent_.get()) {
+        tracker->exceeded_.store(true, std::memory_order_relaxed);
+        if (tracker == exceeded) {
+            break;
+        }
+    }
+    return false;
+}
+
+void MemoryTracker::Release(int64_t bytes) {
+    for (auto tracker = this; tracker != nullptr; tracker = tracker->parent_.get()) {
+        tracker->consumption_.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+}
+
+std::string MemoryTracker::ToString() const {
+    std::ostringstream output;
+    output << label_ << " (consumption=" << consumption() << " peak=" << peak();
+    if (limit() >= 0) {
+        output << " limit=" << limit();
+    }
+    output << ")";
+    return output.str();
+}
+
+MemoryReservation::~MemoryReservation() {
+    if (tracker_ && reserved_ > 0) {
+        tracker_->Release(reserved_);
+    }
+}
+
+void MemoryReservation::SetTracker(std::shared_ptr<MemoryTracker> tracker) {
+    if (tracker_ && reserved_ > 0) {
+        tracker_->Release(reserved_);
+    }
+    reserved_ = 0;
+    tracker_ = std::move(tracker);
+    if (tracker_ && used_ > 0) {
+        Resize();
+    }
+}
+
+void MemoryReservation::Resize() {
+    int64_t reserved = used_ + std::max(kMinSlackBytes, used_ / 4);
+    if (reserved > reserved_) {
+        tracker_->Consume(reserved - reserved_);
+    } else {
+        tracker_->Release(reserved_ - reserved);
+    }
+    reserved_ = reserved;
+}
+
+}  // namespace vm
+}  // namespace hybridse
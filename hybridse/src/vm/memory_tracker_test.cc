@@ -0,0 +1,209 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/memory_tracker.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "testing/test_base.h"
+#include "vm/jit_runtime.h"
+#include "vm/mem_catalog.h"
+
+namespace hybridse {
+namespace vm {
+using hybridse::codec::Row;
+class MemoryTrackerTest : public ::testing::Test {};
+
+TEST_F(MemoryTrackerTest, hierarchy_test) {
+    int64_t process_consumption = MemoryTracker::Process()->consumption();
+    auto query = MemoryTracker::Create("query", -1);
+    auto runner1 = MemoryTracker::Create("runner 1", -1, query);
+    auto runner2 = MemoryTracker::Create("runner 2", -1, query);
+
+    ASSERT_TRUE(runner1->Consume(100));
+    ASSERT_TRUE(runner2->Consume(50));
+    ASSERT_EQ(100, runner1->consumption());
+    ASSERT_EQ(50, runner2->consumption());
+    ASSERT_EQ(150, query->consumption());
+    ASSERT_EQ(process_consumption + 150, MemoryTracker::Process()->consumption());
+
+    runner1->Release(100);
+    ASSERT_EQ(0, runner1->consumption());
+    ASSERT_EQ(100, runner1->peak());
+    ASSERT_EQ(50, query->consumption());
+    ASSERT_EQ(150, query->peak());
+    runner2->Release(50);
+    ASSERT_EQ(process_consumption, MemoryTracker::Process()->consumption());
+    ASSERT_FALSE(query->LimitExceeded());
+}
+
+TEST_F(MemoryTrackerTest, limit_test) {
+    auto query = MemoryTracker::Create("query", 100);
+    auto runner1 = MemoryTracker::Create("runner 1", 60, query);
+    auto runner2 = MemoryTracker::Create("runner 2", -1, query);
+
+    ASSERT_TRUE(runner1->Consume(50));
+    ASSERT_FALSE(runner1->Consume(20));
+    // the runner limit is exceeded, not the query one
+    ASSERT_TRUE(runner1->LimitExceeded());
+    ASSERT_FALSE(query->LimitExceeded());
+
+    ASSERT_FALSE(runner2->Consume(40));
+    ASSERT_TRUE(runner2->LimitExceeded());
+    ASSERT_TRUE(query->LimitExceeded());
+    ASSERT_FALSE(MemoryTracker::Process()->LimitExceeded());
+    ASSERT_EQ(110, query->consumption());
+    runner1->Release(70);
+    runner2->Release(40);
+    ASSERT_EQ(0, query->consumption());
+}
+
+TEST_F(MemoryTrackerTest, process_limit_test) {
+    int64_t process_limit = MemoryTracker::Process()->limit();
+    auto query = MemoryTracker::Create("query", -1);
+    MemoryTracker::Process()->SetLimit(MemoryTracker::Process()->consumption() + 100);
+    ASSERT_TRUE(query->Consume(100));
+    ASSERT_FALSE(query->Consume(1));
+    ASSERT_TRUE(query->LimitExceeded());
+    ASSERT_FALSE(MemoryTracker::Process()->LimitExceeded());
+    query->Release(101);
+    MemoryTracker::Process()->SetLimit(process_limit);
+}
+
+TEST_F(MemoryTrackerTest, reservation_test) {
+    {
+        // no tracker, nothing is charged
+        MemoryReservation reservation;
+        reservation.Grow(1024);
+        ASSERT_EQ(1024, reservation.used());
+        ASSERT_EQ(0, reservation.reserved());
+    }
+    auto query = MemoryTracker::Create("query", -1);
+    {
+        MemoryReservation reservation(query);
+        reservation.Grow(100);
+        ASSERT_EQ(100, reservation.used());
+        ASSERT_GE(reservation.reserved(), 100);
+        ASSERT_EQ(reservation.reserved(), query->consumption());
+
+        // growing within the slack does not touch the tracker
+        int64_t consumption = query->consumption();
+        reservation.Grow(100);
+        ASSERT_EQ(consumption, query->consumption());
+
+        reservation.Grow(1 << 20);
+        ASSERT_GE(query->consumption(), (1 << 20) + 200);
+        {
+            MemoryReservation copy(reservation);
+            ASSERT_EQ(reservation.used(), copy.used());
+            ASSERT_EQ(reservation.reserved() + copy.reserved(), query->consumption());
+        }
+        reservation.Shrink(1 << 20);
+        ASSERT_EQ(200, reservation.used());
+        ASSERT_LT(query->consumption(), 1 << 20);
+        ASSERT_EQ(reservation.reserved(), query->consumption());
+    }
+    ASSERT_EQ(0, query->consumption());
+    ASSERT_GT(query->peak(), 2 * (1 << 20));
+}
+
+TEST_F(MemoryTrackerTest, reservation_set_tracker_test) {
+    auto query = MemoryTracker::Create("query", -1);
+    auto other = MemoryTracker::Create("other", -1);
+    MemoryReservation reservation;
+    reservation.Grow(100);
+    // the bytes used before are charged to the new tracker
+    reservation.SetTracker(query);
+    ASSERT_EQ(reservation.reserved(), query->consumption());
+    ASSERT_GE(query->consumption(), 100);
+    reservation.SetTracker(other);
+    ASSERT_EQ(0, query->consumption());
+    ASSERT_EQ(reservation.reserved(), other->consumption());
+    reservation.SetTracker(nullptr);
+    ASSERT_EQ(0, other->consumption());
+    ASSERT_EQ(100, reservation.used());
+}
+
+TEST_F(MemoryTrackerTest, mem_table_handler_test) {
+    std::vector<Row> rows;
+    ::hybridse::type::TableDef table;
+    BuildRows(table, rows);
+    auto query = MemoryTracker::Create("query", -1);
+    {
+        vm::MemTableHandler table_handler("t1", "temp", &(table.columns()));
+        vm::MemTimeTableHandler time_table_handler("t1", "temp", &(table.columns()));
+        table_handler.SetMemoryTracker(query);
+        time_table_handler.SetMemoryTracker(query);
+        int64_t bytes = 0;
+        for (size_t i = 0; i < rows.size(); i++) {
+            table_handler.AddRow(rows[i]);
+            time_table_handler.AddRow(i, rows[i]);
+            bytes += RowMemoryBytes(rows[i]);
+        }
+        ASSERT_GE(query->consumption(), 2 * bytes);
+    }
+    ASSERT_EQ(0, query->consumption());
+    ASSERT_GT(query->peak(), 0);
+}
+
+TEST_F(MemoryTrackerTest, mem_partition_handler_limit_test) {
+    std::vector<Row> rows;
+    ::hybridse::type::TableDef table;
+    BuildRows(table, rows);
+    auto query = MemoryTracker::Create("query", 1024);
+    vm::MemPartitionHandler partition_handler("t1", "temp", &(table.columns()));
+    partition_handler.SetMemoryTracker(query);
+    // the first reservation takes the minimal slack, beyond the limit
+    ASSERT_FALSE(partition_handler.AddRow("k", 1, rows[0]));
+    ASSERT_TRUE(query->LimitExceeded());
+}
+
+TEST_F(MemoryTrackerTest, window_limit_test) {
+    std::vector<Row> rows;
+    ::hybridse::type::TableDef table;
+    BuildRows(table, rows);
+    auto query = MemoryTracker::Create("query", 1024);
+    vm::CurrentHistoryWindow window(vm::Window::kFrameRowsRange, -1000L, 0);
+    ASSERT_TRUE(window.BufferData(1, rows[0]));
+    window.SetMemoryTracker(query);
+    ASSERT_TRUE(query->LimitExceeded());
+    ASSERT_FALSE(window.BufferData(2, rows[1]));
+}
+
+TEST_F(MemoryTrackerTest, jit_runtime_test) {
+    auto query = MemoryTracker::Create("query", -1);
+    auto runtime = JitRuntime::get();
+    runtime->InitRunStep(query);
+    ASSERT_NE(nullptr, runtime->AllocManaged(64));
+    ASSERT_EQ(64, query->consumption());
+    runtime->ReleaseRunStep();
+    ASSERT_EQ(0, query->consumption());
+
+    // a step without tracker charges nothing
+    runtime->InitRunStep();
+    ASSERT_NE(nullptr, runtime->AllocManaged(64));
+    runtime->ReleaseRunStep();
+    ASSERT_EQ(0, query->consumption());
+}
+
+}  // namespace vm
+}  // namespace hybridse
+int main(int argc, char** argv) {
+    ::testing::GTEST_FLAG(color) = "yes";
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/result_cache.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>  // NOLINT
+#include <utility>
+
+#include "glog/logging.h"
+#include "vm/engine.h"
+
+namespace hybridse {
+namespace vm {
+
+static uint64_t NowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static bool ParseUint64(const std::string& str, uint64_t* value) {
+    if (str.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    *value = strtoull(str.c_str(), &end, 10);
+    return end != nullptr && *end == '\0';
+}
+
+SubplanResultCache::SubplanResultCache(uint64_t ttl_ms, uint64_t capacity)
+    : ttl_ms_(ttl_ms), shard_capacity_(capacity / kShardNum), hit_cnt_(0), miss_cnt_(0) {}
+
+std::shared_ptr<SubplanResultCache> SubplanResultCache::CreateFromOptions(
+    const std::unordered_map<std::string, std::string>* options) {
+    if (nullptr == options) {
+        return nullptr;
+    }
+    auto ttl_it = options->find(RESULT_CACHE_TTL);
+    if (ttl_it == options->end()) {
+        return nullptr;
+    }
+    uint64_t ttl_ms = 0;
+    if (!ParseUint64(ttl_it->second, &ttl_ms) || ttl_ms == 0) {
+        LOG(WARNING) << "invalid " << RESULT_CACHE_TTL << " " << ttl_it->second << ", result cache is disabled";
+        return nullptr;
+    }
+    uint64_t capacity = DEFAULT_RESULT_CACHE_SIZE;
+    auto size_it = options->find(RESULT_CACHE_SIZE);
+    if (size_it != options->end() && (!ParseUint64(size_it->second, &capacity) || capacity == 0)) {
+        LOG(WARNING) << "invalid " << RESULT_CACHE_SIZE << " " << size_it->second << ", result cache is disabled";
+        return nullptr;
+    }
+    return std::make_shared<SubplanResultCache>(ttl_ms, capacity);
+}
+
+std::string SubplanResultCache::EncodeKey(int32_t runner_id, const std::string& key) {
+    std::string encoded;
+    encoded.reserve(sizeof(runner_id) + key.size());
+    encoded.append(reinterpret_cast<const char*>(&runner_id), sizeof(runner_id));
+    encoded.append(key);
+    return encoded;
+}
+
+bool SubplanResultCache::Get(int32_t runner_id, const std::string& key, uint64_t version, codec::Row* row) {
+    std::string encoded = EncodeKey(runner_id, key);
+    auto& shard = GetShard(encoded);
+    std::vector<std::string> slices;
+    {
+        std::lock_guard<std::mutex> lock(shard.mu);
+        auto it = shard.index.find(encoded);
+        if (it == shard.index.end()) {
+            miss_cnt_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        auto entry_it = it->second;
+        if (entry_it->version != version || NowMs() - entry_it->put_time_ms >= ttl_ms_) {
+            Erase(&shard, entry_it);
+            miss_cnt_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        shard.lru.splice(shard.lru.begin(), shard.lru, entry_it);
+        slices = entry_it->slices;
+    }
+    hit_cnt_.fetch_add(1, std::memory_order_relaxed);
+    if (slices.empty()) {
+        *row = codec::Row();
+        return true;
+    }
+    for (size_t idx = 0; idx < slices.size(); idx++) {
+        auto& slice = slices[idx];
+        // keep null slice as null, e.g. the right slices of last join without matched row
+        base::RefCountedSlice managed;
+        if (!slice.empty()) {
+            int8_t* buf = reinterpret_cast<int8_t*>(malloc(slice.size()));
+            memcpy(buf, slice.data(), slice.size());
+            managed = base::RefCountedSlice::CreateManaged(buf, slice.size());
+        }
+        if (idx == 0) {
+            *row = codec::Row(managed);
+        } else {
+            row->Append(managed);
+        }
+    }
+    return true;
+}
+
+void SubplanResultCache::Put(int32_t runner_id, const std::string& key, uint64_t version, const codec::Row& row) {
+    Entry entry;
+    entry.key = EncodeKey(runner_id, key);
+    entry.version = version;
+    entry.put_time_ms = NowMs();
+    entry.byte_size = entry.key.size() + sizeof(Entry);
+    if (!row.empty()) {
+        for (int32_t idx = 0; idx < row.GetRowPtrCnt(); idx++) {
+            entry.slices.emplace_back(reinterpret_cast<const char*>(row.buf(idx)), row.size(idx));
+            entry.byte_size += row.size(idx);
+        }
+    }
+    if (entry.byte_size > shard_capacity_) {
+        return;
+    }
+    auto& shard = GetShard(entry.key);
+    std::lock_guard<std::mutex> lock(shard.mu);
+    auto it = shard.index.find(entry.key);
+    if (it != shard.index.end()) {
+        Erase(&shard, it->second);
+    }
+    shard.byte_size += entry.byte_size;
+    shard.lru.push_front(std::move(entry));
+    shard.index.emplace(shard.lru.front().key, shard.lru.begin());
+    while (shard.byte_size > shard_capacity_ && !shard.lru.empty()) {
+        Erase(&shard, std::prev(shard.lru.end()));
+    }
+}
+
+void SubplanResultCache::Erase(Shard* shard, std::list<Entry>::iterator it) {
+    shard->byte_size -= it->byte_size;
+    shard->index.erase(it->key);
+    shard->lru.erase(it);
+}
+
+uint64_t SubplanResultCache::GetByteSize() const {
+    uint64_t byte_size = 0;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mu);
+        byte_size += shard.byte_size;
+    }
+    return byte_size;
+}
+
+}  // namespace vm
+}  // namespace hybridse
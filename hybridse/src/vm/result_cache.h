@@ -0,0 +1,95 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYBRIDSE_SRC_VM_RESULT_CACHE_H_
+#define HYBRIDSE_SRC_VM_RESULT_CACHE_H_
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "codec/row.h"
+
+namespace hybridse {
+namespace vm {
+
+/// \brief SubplanResultCache caches the output row of deterministic subplans across requests
+/// of one deployment, e.g. LAST JOIN to a slowly-changing dimension table.
+///
+/// An entry is keyed by runner id and the input key of the subplan, and is valid only if
+/// - the write version of the input table is the same as the version when the entry is put, and
+/// - the entry is put within `ttl_ms`.
+/// Entries are evicted in LRU order when the cached bytes exceed `capacity`.
+///
+/// Rows are copied in and out of the cache, since the reference count of row slices is not
+/// thread safe and the row may refer to memory owned by storage.
+class SubplanResultCache {
+ public:
+    SubplanResultCache(uint64_t ttl_ms, uint64_t capacity);
+    ~SubplanResultCache() {}
+
+    /// Create a cache from deployment options, null if result cache is not enabled
+    static std::shared_ptr<SubplanResultCache> CreateFromOptions(
+        const std::unordered_map<std::string, std::string>* options);
+
+    /// Return true and fill `row` if a valid entry is found
+    bool Get(int32_t runner_id, const std::string& key, uint64_t version, codec::Row* row);
+
+    void Put(int32_t runner_id, const std::string& key, uint64_t version, const codec::Row& row);
+
+    uint64_t GetHitCnt() const { return hit_cnt_.load(std::memory_order_relaxed); }
+    uint64_t GetMissCnt() const { return miss_cnt_.load(std::memory_order_relaxed); }
+    uint64_t GetByteSize() const;
+
+ private:
+    struct Entry {
+        std::string key;
+        uint64_t version;
+        uint64_t put_time_ms;
+        // copy of row slices, empty if the row is empty
+        std::vector<std::string> slices;
+        uint64_t byte_size;
+    };
+
+    struct Shard {
+        mutable std::mutex mu;
+        std::list<Entry> lru;
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+        uint64_t byte_size = 0;
+    };
+
+    static constexpr uint32_t kShardNum = 16;
+
+    static std::string EncodeKey(int32_t runner_id, const std::string& key);
+
+    Shard& GetShard(const std::string& key) { return shards_[std::hash<std::string>()(key) % kShardNum]; }
+
+    void Erase(Shard* shard, std::list<Entry>::iterator it);
+
+    const uint64_t ttl_ms_;
+    const uint64_t shard_capacity_;
+    Shard shards_[kShardNum];
+    std::atomic<uint64_t> hit_cnt_;
+    std::atomic<uint64_t> miss_cnt_;
+};
+
+}  // namespace vm
+}  // namespace hybridse
+#endif  // HYBRIDSE_SRC_VM_RESULT_CACHE_H_
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/result_cache.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <thread>  // NOLINT
+
+#include "gtest/gtest.h"
+#include "vm/engine.h"
+
+namespace hybridse {
+namespace vm {
+
+class ResultCacheTest : public ::testing::Test {};
+
+static codec::Row MakeRow(const std::string& value) {
+    int8_t* buf = reinterpret_cast<int8_t*>(malloc(value.size()));
+    memcpy(buf, value.data(), value.size());
+    return codec::Row(base::RefCountedSlice::CreateManaged(buf, value.size()));
+}
+
+TEST_F(ResultCacheTest, GetAndPut) {
+    SubplanResultCache cache(60000, 1024 * 1024);
+    codec::Row row;
+    ASSERT_FALSE(cache.Get(1, "key1", 1, &row));
+    cache.Put(1, "key1", 1, MakeRow("value1"));
+    ASSERT_TRUE(cache.Get(1, "key1", 1, &row));
+    ASSERT_EQ("value1", row.ToString());
+    // same key of another runner
+    ASSERT_FALSE(cache.Get(2, "key1", 1, &row));
+    ASSERT_EQ(1u, cache.GetHitCnt());
+    ASSERT_EQ(2u, cache.GetMissCnt());
+}
+
+TEST_F(ResultCacheTest, MultiSlicesAndNullSlice) {
+    SubplanResultCache cache(60000, 1024 * 1024);
+    codec::Row row = MakeRow("slice0");
+    row.Append(base::RefCountedSlice());
+    row.Append(MakeRow("slice2").GetSlice(0));
+    cache.Put(1, "key", 1, row);
+
+    codec::Row cached;
+    ASSERT_TRUE(cache.Get(1, "key", 1, &cached));
+    ASSERT_EQ(3, cached.GetRowPtrCnt());
+    ASSERT_EQ("slice0", cached.GetSlice(0).ToString());
+    ASSERT_EQ(nullptr, cached.buf(1));
+    ASSERT_EQ(0, cached.size(1));
+    ASSERT_EQ("slice2", cached.GetSlice(2).ToString());
+
+    // last join without matched row
+    cache.Put(1, "empty", 1, codec::Row());
+    ASSERT_TRUE(cache.Get(1, "empty", 1, &cached));
+    ASSERT_TRUE(cached.empty());
+}
+
+TEST_F(ResultCacheTest, VersionInvalidate) {
+    SubplanResultCache cache(60000, 1024 * 1024);
+    codec::Row row;
+    cache.Put(1, "key", 1, MakeRow("v1"));
+    ASSERT_FALSE(cache.Get(1, "key", 2, &row));
+    // the stale entry is removed
+    ASSERT_FALSE(cache.Get(1, "key", 1, &row));
+    cache.Put(1, "key", 2, MakeRow("v2"));
+    ASSERT_TRUE(cache.Get(1, "key", 2, &row));
+    ASSERT_EQ("v2", row.ToString());
+}
+
+TEST_F(ResultCacheTest, TTLExpire) {
+    SubplanResultCache cache(20, 1024 * 1024);
+    codec::Row row;
+    cache.Put(1, "key", 1, MakeRow("value"));
+    ASSERT_TRUE(cache.Get(1, "key", 1, &row));
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    ASSERT_FALSE(cache.Get(1, "key", 1, &row));
+    ASSERT_EQ(0u, cache.GetByteSize());
+}
+
+TEST_F(ResultCacheTest, LRUEvict) {
+    // 16 shards with 1KB for each one
+    SubplanResultCache cache(60000, 16 * 1024);
+    std::string value(100, 'a');
+    for (int i = 0; i < 1000; i++) {
+        cache.Put(1, "key" + std::to_string(i), 1, MakeRow(value));
+    }
+    ASSERT_LE(cache.GetByteSize(), 16u * 1024);
+    codec::Row row;
+    ASSERT_FALSE(cache.Get(1, "key0", 1, &row));
+    ASSERT_TRUE(cache.Get(1, "key999", 1, &row));
+
+    // entry larger than the capacity of shard is not cached
+    cache.Put(1, "large", 1, MakeRow(std::string(2048, 'b')));
+    ASSERT_FALSE(cache.Get(1, "large", 1, &row));
+}
+
+TEST_F(ResultCacheTest, CreateFromOptions) {
+    ASSERT_EQ(nullptr, SubplanResultCache::CreateFromOptions(nullptr));
+    std::unordered_map<std::string, std::string> options;
+    ASSERT_EQ(nullptr, SubplanResultCache::CreateFromOptions(&options));
+    options[RESULT_CACHE_TTL] = "abc";
+    ASSERT_EQ(nullptr, SubplanResultCache::CreateFromOptions(&options));
+    options[RESULT_CACHE_TTL] = "1000";
+    ASSERT_NE(nullptr, SubplanResultCache::CreateFromOptions(&options));
+    options[RESULT_CACHE_SIZE] = "0";
+    ASSERT_EQ(nullptr, SubplanResultCache::CreateFromOptions(&options));
+    options[RESULT_CACHE_SIZE] = "1048576";
+    ASSERT_NE(nullptr, SubplanResultCache::CreateFromOptions(&options));
+}
+
+}  // namespace vm
+}  // namespace hybridse
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -16,8 +16,13 @@
 
 #include "vm/runner.h"
 
+#include <algorithm>
+#include <functional>
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -221,6 +226,13 @@ ClusterTask RunnerBuilder::Build(PhysicalOpNode* node, Status& status) {
                     CreateRunner<GroupAggRunner>(
                         &runner, id_++, node->schemas_ctx(), op->GetLimitCnt(),
                         op->group_, op->having_condition_, op->project().fn_info());
+                    auto group_op = dynamic_cast<const PhysicalGroupNode*>(node->GetProducer(0));
+                    if (spill_options_.IsEnabled() && nullptr != group_op && kRunnerGroup == input->type_) {
+                        // group the input of the group runner in the aggregation, so the
+                        // groups spill to disk instead of being partitioned in memory
+                        runner->SetSpillGroup(spill_options_, group_op->group());
+                        cluster_task.SetRoot(input->GetProducers().at(0));
+                    }
                     return RegisterTask(node,
                                         UnaryInheritTask(cluster_task, runner));
                 }
@@ -242,6 +254,7 @@ ClusterTask RunnerBuilder::Build(PhysicalOpNode* node, Status& status) {
                         op->window_, op->project().fn_info(),
                         op->instance_not_in_window(),
                         op->exclude_current_time(), op->need_append_input());
+                    runner->SetSpillOptions(spill_options_);
                     size_t input_slices =
                         input->output_schemas()->GetSchemaSourceSize();
                     if (!op->window_unions_.Empty()) {
@@ -883,6 +896,149 @@ ClusterTask RunnerBuilder::BuildProxyRunnerForClusterTask(
     LOG(WARNING) << "Fail to build proxy runner for cluster job";
     return ClusterTask();
 }
+// runners which read tables or remote tablets, a branch without them is cheap
+// to run on the calling thread
+static bool IsDataAccessRunner(const Runner* runner) {
+    switch (runner->type_) {
+        case kRunnerRequestUnion:
+        case kRunnerRequestAggUnion:
+        case kRunnerIndexSeek:
+        case kRunnerLastJoin:
+        case kRunnerRequestLastJoin:
+        case kRunnerRequestRunProxy:
+        case kRunnerBatchRequestRunProxy:
+        case kRunnerWindowAgg:
+        case kRunnerGroupAgg:
+        case kRunnerAgg:
+        case kRunnerReduce:
+            return true;
+        default:
+            return false;
+    }
+}
+static void CollectRunners(Runner* root, std::set<Runner*>* runners) {
+    if (nullptr == root || !runners->insert(root).second) {
+        return;
+    }
+    for (auto producer : root->GetProducers()) {
+        CollectRunners(producer, runners);
+    }
+}
+void RunnerBuilder::FuseRequestPipelines() {
+    std::set<Runner*> runner_set;
+    for (size_t idx = 0; idx < cluster_job_.GetTaskSize(); idx++) {
+        CollectRunners(cluster_job_.GetTask(idx).GetRoot(), &runner_set);
+    }
+    std::vector<Runner*> runners(runner_set.begin(), runner_set.end());
+    std::sort(runners.begin(), runners.end(),
+              [](const Runner* r1, const Runner* r2) { return r1->id_ < r2->id_; });
+    std::map<Runner*, std::vector<Runner*>> consumers;
+    // runners run by the proxy runners besides the producers
+    std::set<Runner*> pinned;
+    for (auto runner : runners) {
+        for (auto producer : runner->GetProducers()) {
+            consumers[producer].push_back(runner);
+        }
+        if (kRunnerRequestRunProxy == runner->type_) {
+            auto proxy = dynamic_cast<ProxyRequestRunner*>(runner);
+            if (nullptr != proxy && nullptr != proxy->index_input()) {
+                pinned.insert(proxy->index_input());
+            }
+        }
+    }
+    // a cached runner may be run from more than one place, keep it in the graph
+    auto fusable = [&pinned](Runner* runner) {
+        return runner->IsPipelineStep() && !runner->need_cache() && !runner->need_batch_cache() &&
+               0 == pinned.count(runner);
+    };
+    for (auto last : runners) {
+        if (!fusable(last)) {
+            continue;
+        }
+        auto& last_consumers = consumers[last];
+        if (1u == last_consumers.size() && fusable(last_consumers[0]) &&
+            last == last_consumers[0]->GetProducers()[0]) {
+            // not the last step of the chain
+            continue;
+        }
+        std::vector<Runner*> steps = {last};
+        Runner* step = last;
+        while (!step->GetProducers().empty()) {
+            Runner* producer = step->GetProducers()[0];
+            if (!fusable(producer) || 1u != consumers[producer].size()) {
+                break;
+            }
+            steps.push_back(producer);
+            step = producer;
+        }
+        if (steps.size() < 2u) {
+            continue;
+        }
+        std::reverse(steps.begin(), steps.end());
+        PipelineRunner* pipeline = nullptr;
+        CreateRunner<PipelineRunner>(&pipeline, id_++, steps);
+        for (auto consumer : last_consumers) {
+            for (size_t i = 0; i < consumer->GetProducers().size(); i++) {
+                if (last == consumer->GetProducers()[i]) {
+                    consumer->SetProducer(i, pipeline);
+                }
+            }
+        }
+        cluster_job_.ReplaceTaskRoot(last, pipeline);
+    }
+}
+void RunnerBuilder::PlanParallelProducers() {
+    std::set<Runner*> runners;
+    for (size_t idx = 0; idx < cluster_job_.GetTaskSize(); idx++) {
+        CollectRunners(cluster_job_.GetTask(idx).GetRoot(), &runners);
+    }
+    std::set<Runner*> main_runners;
+    CollectRunners(cluster_job_.GetMainTask().GetRoot(), &main_runners);
+    for (auto runner : runners) {
+        if (kRunnerRequestRunProxy == runner->type_ && 1u == runner->GetProducers().size() &&
+            main_runners.count(runner) > 0) {
+            // the sub-query only needs the request row, issue it before the main task runs
+            auto proxy = dynamic_cast<ProxyRequestRunner*>(runner);
+            auto input = runner->GetProducers()[0];
+            if (nullptr != proxy && nullptr != input && kRunnerRequest == input->type_ &&
+                (nullptr == proxy->index_input() || kRunnerRequest == proxy->index_input()->type_)) {
+                proxy->EnablePrefetch();
+                cluster_job_.AddPrefetchRunner(proxy);
+            }
+        }
+        auto& producers = runner->GetProducers();
+        if (producers.size() < 2u) {
+            continue;
+        }
+        size_t data_branches = 0;
+        std::map<Runner*, size_t> branch_cnt;
+        for (auto producer : producers) {
+            std::set<Runner*> branch;
+            CollectRunners(producer, &branch);
+            bool access_data = false;
+            for (auto branch_runner : branch) {
+                access_data = access_data || IsDataAccessRunner(branch_runner);
+                branch_cnt[branch_runner]++;
+            }
+            if (access_data) {
+                data_branches++;
+            }
+        }
+        if (data_branches < 2u) {
+            continue;
+        }
+        std::vector<Runner*> shared_runners;
+        for (auto& kv : branch_cnt) {
+            if (kv.second > 1 && kv.first->need_cache()) {
+                shared_runners.push_back(kv.first);
+            }
+        }
+        // producers are built before their consumers and get smaller ids
+        std::sort(shared_runners.begin(), shared_runners.end(),
+                  [](const Runner* r1, const Runner* r2) { return r1->id_ < r2->id_; });
+        runner->EnableParallelProducers(shared_runners);
+    }
+}
 ClusterTask RunnerBuilder::UnCompletedClusterTask(
     Runner* runner, const std::shared_ptr<TableHandler> table_handler,
     std::string index) {
@@ -981,8 +1137,8 @@ Row Runner::WindowProject(const int8_t* fn, const uint64_t row_key,
     if (!is_instance) {
         return Row();
     }
-    // Init current run step runtime
-    JitRuntime::get()->InitRunStep();
+    // Init current run step runtime, charging the memory of the window
+    JitRuntime::get()->InitRunStep(window->GetMemoryTracker());
 
     auto udf = reinterpret_cast<int32_t (*)(const int64_t key, const int8_t*,
                                             const int8_t*, const int8_t*, int8_t**)>(
@@ -1095,6 +1251,9 @@ std::shared_ptr<DataHandlerList> Runner::BatchRequestRun(RunnerContext& ctx) {
         auto cached = ctx.GetBatchCache(id_);
         if (cached != nullptr) {
             DLOG(INFO) << "RUNNER ID " << id_ << " HIT CACHE!";
+            if (ctx.profile() != nullptr) {
+                ctx.profile()->RecordCacheHit(id_);
+            }
             return cached;
         }
     }
@@ -1107,6 +1266,7 @@ std::shared_ptr<DataHandlerList> Runner::BatchRequestRun(RunnerContext& ctx) {
         batch_inputs[idx - 1] = producers_[idx - 1]->BatchRequestRun(ctx);
     }
 
+    RunnerProfileGuard profile_guard(ctx.profile(), id_);
     for (size_t idx = 0; idx < ctx.GetRequestSize(); idx++) {
         inputs.clear();
         for (size_t producer_idx = 0; producer_idx < producers_.size();
@@ -1150,31 +1310,71 @@ std::shared_ptr<DataHandlerList> Runner::BatchRequestRun(RunnerContext& ctx) {
     }
     return outputs;
 }
+bool Runner::NeedCache(const RunnerContext& ctx) const {
+    return need_cache_ || (prefetch_ && nullptr != ctx.subplan_executor());
+}
 std::shared_ptr<DataHandler> Runner::RunWithCache(RunnerContext& ctx) {
-    if (need_cache_) {
+    bool use_cache = NeedCache(ctx);
+    if (use_cache) {
         auto cached = ctx.GetCache(id_);
         if (cached != nullptr) {
             DLOG(INFO) << "RUNNER ID " << id_ << " HIT CACHE!";
+            if (ctx.profile() != nullptr) {
+                ctx.profile()->RecordCacheHit(id_);
+            }
             return cached;
         }
     }
     std::vector<std::shared_ptr<DataHandler>> inputs(producers_.size());
-    for (size_t idx = producers_.size(); idx > 0; idx--) {
-        inputs[idx - 1] = producers_[idx - 1]->RunWithCache(ctx);
+    if (!parallel_producers_ || !RunProducersInParallel(ctx, &inputs)) {
+        for (size_t idx = producers_.size(); idx > 0; idx--) {
+            inputs[idx - 1] = producers_[idx - 1]->RunWithCache(ctx);
+        }
     }
 
-    auto res = Run(ctx, inputs);
+    std::shared_ptr<DataHandler> res;
+    {
+        RunnerProfileGuard profile_guard(ctx.profile(), id_);
+        res = Run(ctx, inputs);
+    }
+    if (ctx.MemoryLimitExceeded()) {
+        LOG(WARNING) << "fail to run " << RunnerTypeName(type_) << " runner " << id_
+                     << ": memory limit exceeded, " << ctx.memory_tracker()->ToString();
+        return nullptr;
+    }
     if (ctx.is_debug()) {
         std::ostringstream oss;
         oss << "RUNNER TYPE: " << RunnerTypeName(type_) << ", ID: " << id_ << "\n";
         Runner::PrintData(oss, output_schemas_, res);
         LOG(INFO) << oss.str();
     }
-    if (need_cache_) {
+    if (use_cache) {
         ctx.SetCache(id_, res);
     }
     return res;
 }
+bool Runner::RunProducersInParallel(RunnerContext& ctx,
+                                    std::vector<std::shared_ptr<DataHandler>>* inputs) {
+    auto executor = ctx.subplan_executor();
+    // the runner profile is filled by one thread
+    if (nullptr == executor || nullptr != ctx.profile()) {
+        return false;
+    }
+    // run the shared runners first, so the producers find them in the cache
+    // instead of running them twice
+    for (auto runner : shared_runners_) {
+        runner->RunWithCache(ctx);
+    }
+    std::vector<std::function<void()>> tasks;
+    tasks.reserve(producers_.size());
+    for (size_t idx = 0; idx < producers_.size(); idx++) {
+        tasks.emplace_back([this, idx, inputs, &ctx]() {
+            (*inputs)[idx] = producers_[idx]->RunWithCache(ctx);
+        });
+    }
+    executor->RunAll(tasks);
+    return true;
+}
 std::shared_ptr<DataHandler> DataRunner::Run(
     RunnerContext& ctx,
     const std::vector<std::shared_ptr<DataHandler>>& inputs) {
@@ -1256,7 +1456,7 @@ std::shared_ptr<DataHandler> GroupRunner::Run(
         LOG(WARNING) << "input is empty";
         return fail_ptr;
     }
-    return partition_gen_.Partition(input, ctx.GetParameterRow());
+    return partition_gen_.Partition(input, ctx.GetParameterRow(), ctx.GetRunnerMemoryTracker(id_));
 }
 std::shared_ptr<DataHandler> SortRunner::Run(
     RunnerContext& ctx,
@@ -1271,14 +1471,16 @@ std::shared_ptr<DataHandler> SortRunner::Run(
         LOG(WARNING) << "input is empty";
         return fail_ptr;
     }
-    return sort_gen_.Sort(input);
+    return sort_gen_.Sort(input, false, ctx.GetRunnerMemoryTracker(id_));
 }
 
 std::shared_ptr<DataHandler> ConstProjectRunner::Run(
     RunnerContext& ctx,
     const std::vector<std::shared_ptr<DataHandler>>& inputs) {
     auto output_table = std::shared_ptr<MemTableHandler>(new MemTableHandler());
-    output_table->AddRow(project_gen_.Gen(ctx.GetParameterRow()));
+    auto tracker = ctx.GetRunnerMemoryTracker(id_);
+    output_table->SetMemoryTracker(tracker);
+    output_table->AddRow(project_gen_.Gen(ctx.GetParameterRow(), tracker));
     return output_table;
 }
 std::shared_ptr<DataHandler> TableProjectRunner::Run(
@@ -1297,6 +1499,8 @@ std::shared_ptr<DataHandler> TableProjectRunner::Run(
         return std::shared_ptr<DataHandler>();
     }
     auto output_table = std::shared_ptr<MemTableHandler>(new MemTableHandler());
+    auto tracker = ctx.GetRunnerMemoryTracker(id_);
+    output_table->SetMemoryTracker(tracker);
     auto iter = std::dynamic_pointer_cast<TableHandler>(input)->GetIterator();
     if (!iter) {
         LOG(WARNING) << "Table Project Fail: table iter is Empty";
@@ -1309,7 +1513,7 @@ std::shared_ptr<DataHandler> TableProjectRunner::Run(
         if (limit_cnt_ > 0 && cnt++ >= limit_cnt_) {
             break;
         }
-        output_table->AddRow(project_gen_.Gen(iter->GetValue(), parameter));
+        output_table->AddRow(project_gen_.Gen(iter->GetValue(), parameter, tracker));
         iter->Next();
     }
     return output_table;
@@ -1324,7 +1528,12 @@ std::shared_ptr<DataHandler> RowProjectRunner::Run(
     }
     auto row = std::dynamic_pointer_cast<RowHandler>(inputs[0]);
     return std::shared_ptr<RowHandler>(
-        new MemRowHandler(project_gen_.Gen(row->GetValue(), ctx.GetParameterRow())));
+        new MemRowHandler(project_gen_.Gen(row->GetValue(), ctx.GetParameterRow(), ctx.GetRunnerMemoryTracker(id_))));
+}
+bool RowProjectRunner::RunPipelineStep(RunnerContext& ctx, const Row& row,
+                                       const std::vector<std::shared_ptr<DataHandler>>& inputs, Row* output) {
+    *output = project_gen_.Gen(row, ctx.GetParameterRow(), ctx.GetRunnerMemoryTracker(id_));
+    return true;
 }
 
 std::shared_ptr<DataHandler> SimpleProjectRunner::Run(
@@ -1366,6 +1575,12 @@ std::shared_ptr<DataHandler> SimpleProjectRunner::Run(
 
     return std::shared_ptr<DataHandler>();
 }
+bool SimpleProjectRunner::RunPipelineStep(RunnerContext& ctx, const Row& row,
+                                          const std::vector<std::shared_ptr<DataHandler>>& inputs, Row* output) {
+    // same as RowProjectWrapper, an empty row is not projected
+    *output = row.empty() ? row : project_gen_.Gen(row, ctx.GetParameterRow(), ctx.GetRunnerMemoryTracker(id_));
+    return true;
+}
 
 Row SelectSliceRunner::GetSliceFn::operator()(const Row& row, const Row& parameter) const {
     if (slice_ < static_cast<size_t>(row.GetRowPtrCnt())) {
@@ -1410,6 +1625,11 @@ std::shared_ptr<DataHandler> SelectSliceRunner::Run(
     }
     return nullptr;
 }
+bool SelectSliceRunner::RunPipelineStep(RunnerContext& ctx, const Row& row,
+                                        const std::vector<std::shared_ptr<DataHandler>>& inputs, Row* output) {
+    *output = row.empty() ? row : get_slice_fn_(row, ctx.GetParameterRow());
+    return true;
+}
 
 std::shared_ptr<DataHandler> WindowAggRunner::Run(
     RunnerContext& ctx,
@@ -1424,10 +1644,14 @@ std::shared_ptr<DataHandler> WindowAggRunner::Run(
         LOG(WARNING) << "window aggregation fail: input is null";
         return fail_ptr;
     }
+    if (spill_options_.IsEnabled() && kTableHandler == input->GetHanlderType()) {
+        return RunWithSpill(ctx, std::dynamic_pointer_cast<TableHandler>(input));
+    }
     auto& parameter = ctx.GetParameterRow();
+    auto tracker = ctx.GetRunnerMemoryTracker(id_);
     // Partition Instance Table
     auto instance_partition =
-        instance_window_gen_.partition_gen_.Partition(input, parameter);
+        instance_window_gen_.partition_gen_.Partition(input, parameter, tracker);
     if (!instance_partition) {
         LOG(WARNING) << "Window Aggregation Fail: input partition is empty";
         return fail_ptr;
@@ -1442,16 +1666,21 @@ std::shared_ptr<DataHandler> WindowAggRunner::Run(
 
     // Partition Union Table
     auto union_inputs = windows_union_gen_.RunInputs(ctx);
-    auto union_partitions = windows_union_gen_.PartitionEach(union_inputs, parameter);
+    auto union_partitions = windows_union_gen_.PartitionEach(union_inputs, parameter, tracker);
     // Prepare Join Tables
     auto join_right_tables = windows_join_gen_.RunInputs(ctx);
 
     // Compute output
     std::shared_ptr<MemTableHandler> output_table = std::make_shared<MemTableHandler>();
+    output_table->SetMemoryTracker(tracker);
     while (instance_partition_iter->Valid()) {
         auto key = instance_partition_iter->GetKey().ToString();
         RunWindowAggOnKey(parameter, instance_partition, union_partitions,
-                          join_right_tables, key, output_table);
+                          join_right_tables, key, output_table, tracker);
+        if (ctx.MemoryLimitExceeded()) {
+            LOG(WARNING) << "Window Aggregation Fail: memory limit exceeded";
+            return fail_ptr;
+        }
         instance_partition_iter->Next();
     }
     return output_table;
@@ -1463,10 +1692,11 @@ void WindowAggRunner::RunWindowAggOnKey(
     std::shared_ptr<PartitionHandler> instance_partition,
     std::vector<std::shared_ptr<PartitionHandler>> union_partitions,
     std::vector<std::shared_ptr<DataHandler>> join_right_tables,
-    const std::string& key, std::shared_ptr<MemTableHandler> output_table) {
+    const std::string& key, std::shared_ptr<MemTableHandler> output_table,
+    const std::shared_ptr<MemoryTracker>& tracker) {
     // Prepare Instance Segment
     auto instance_segment = instance_partition->GetSegment(key);
-    instance_segment = instance_window_gen_.sort_gen_.Sort(instance_segment);
+    instance_segment = instance_window_gen_.sort_gen_.Sort(instance_segment, false, tracker);
     if (!instance_segment) {
         LOG(WARNING) << "Instance Segment is Empty";
         return;
@@ -1483,26 +1713,41 @@ void WindowAggRunner::RunWindowAggOnKey(
     size_t unions_cnt = windows_union_gen_.inputs_cnt_;
     std::vector<std::shared_ptr<TableHandler>> union_segments(unions_cnt);
     std::vector<std::unique_ptr<RowIterator>> union_segment_iters(unions_cnt);
-    std::vector<IteratorStatus> union_segment_status(unions_cnt);
-
     for (size_t i = 0; i < unions_cnt; i++) {
         if (!union_partitions[i]) {
             continue;
         }
-        auto segment = union_partitions[i]->GetSegment(key);
-        segment = windows_union_gen_.windows_gen_[i].sort_gen_.Sort(segment);
-        union_segments[i] = segment;
-        if (!segment) {
-            union_segment_status[i] = IteratorStatus();
-            continue;
-        }
-        union_segment_iters[i] = segment->GetIterator();
-        if (!union_segment_iters[i]) {
-            union_segment_status[i] = IteratorStatus();
-            continue;
-        }
-        union_segment_iters[i]->SeekToFirst();
-        if (!union_segment_iters[i]->Valid()) {
+        union_segment_iters[i] = GetUnionSegmentIterator(i, union_partitions[i], key, &union_segments[i], tracker);
+    }
+    RunWindowAggOnIterators(parameter, instance_segment_iter.get(), union_segment_iters, join_right_tables,
+                            output_table, tracker);
+}
+
+std::unique_ptr<RowIterator> WindowAggRunner::GetUnionSegmentIterator(
+    size_t idx, std::shared_ptr<PartitionHandler> union_partition, const std::string& key,
+    std::shared_ptr<TableHandler>* segment, const std::shared_ptr<MemoryTracker>& tracker) {
+    *segment = windows_union_gen_.windows_gen_[idx].sort_gen_.Sort(union_partition->GetSegment(key), false, tracker);
+    if (!*segment) {
+        return nullptr;
+    }
+    auto iter = (*segment)->GetIterator();
+    if (iter) {
+        iter->SeekToFirst();
+    }
+    return iter;
+}
+
+// Run Window Aggeregation on the instance rows and the union rows of one key,
+// the iterators are positioned at their first rows
+void WindowAggRunner::RunWindowAggOnIterators(
+    const Row& parameter, RowIterator* instance_segment_iter,
+    const std::vector<std::unique_ptr<RowIterator>>& union_segment_iters,
+    const std::vector<std::shared_ptr<DataHandler>>& join_right_tables,
+    std::shared_ptr<MemTableHandler> output_table, const std::shared_ptr<MemoryTracker>& tracker) {
+    size_t unions_cnt = union_segment_iters.size();
+    std::vector<IteratorStatus> union_segment_status(unions_cnt);
+    for (size_t i = 0; i < unions_cnt; i++) {
+        if (!union_segment_iters[i] || !union_segment_iters[i]->Valid()) {
             union_segment_status[i] = IteratorStatus();
             continue;
         }
@@ -1513,6 +1758,7 @@ void WindowAggRunner::RunWindowAggOnKey(
     int32_t min_union_pos = IteratorStatus::FindLastIteratorWithMininumKey(union_segment_status);
     int32_t cnt = output_table->GetCount();
     HistoryWindow window(instance_window_gen_.range_gen_.window_range_);
+    window.SetMemoryTracker(tracker);
     window.set_instance_not_in_window(instance_not_in_window_);
     window.set_exclude_current_time(exclude_current_time_);
 
@@ -1520,6 +1766,10 @@ void WindowAggRunner::RunWindowAggOnKey(
         if (limit_cnt_ > 0 && cnt >= limit_cnt_) {
             break;
         }
+        // the window fails to buffer rows beyond the limit, the caller fails the run
+        if (tracker && tracker->LimitExceeded()) {
+            break;
+        }
         const Row& instance_row = instance_segment_iter->GetValue();
         uint64_t instance_order = instance_segment_iter->GetKey();
         while (min_union_pos >= 0 &&
@@ -1558,6 +1808,84 @@ void WindowAggRunner::RunWindowAggOnKey(
     }
 }
 
+// Run Window Aggeregation with the inputs sorted by external sorters, only the
+// rows of one key and the runs being merged are in memory besides the output
+std::shared_ptr<DataHandler> WindowAggRunner::RunWithSpill(RunnerContext& ctx, std::shared_ptr<TableHandler> input) {
+    auto fail_ptr = std::shared_ptr<DataHandler>();
+    auto& parameter = ctx.GetParameterRow();
+    auto tracker = ctx.GetRunnerMemoryTracker(id_);
+    auto instance_stream = instance_window_gen_.PartitionAndSort(input, parameter, spill_options_, tracker);
+    if (!instance_stream) {
+        LOG(WARNING) << "Window Aggregation Fail: fail to sort input";
+        return fail_ptr;
+    }
+
+    // Sort the union tables, partition the other union inputs in memory
+    auto union_inputs = windows_union_gen_.RunInputs(ctx);
+    size_t unions_cnt = windows_union_gen_.inputs_cnt_;
+    std::vector<std::unique_ptr<SortedRowStream>> union_streams(unions_cnt);
+    std::vector<std::shared_ptr<PartitionHandler>> union_partitions(unions_cnt);
+    for (size_t i = 0; i < unions_cnt; i++) {
+        auto& window_gen = windows_union_gen_.windows_gen_[i];
+        if (kTableHandler == union_inputs[i]->GetHanlderType()) {
+            union_streams[i] = window_gen.PartitionAndSort(std::dynamic_pointer_cast<TableHandler>(union_inputs[i]),
+                                                           parameter, spill_options_, tracker);
+            if (!union_streams[i]) {
+                LOG(WARNING) << "Window Aggregation Fail: fail to sort union input";
+                return fail_ptr;
+            }
+        } else {
+            union_partitions[i] = window_gen.partition_gen_.Partition(union_inputs[i], parameter, tracker);
+        }
+    }
+    // Prepare Join Tables
+    auto join_right_tables = windows_join_gen_.RunInputs(ctx);
+
+    // Compute output
+    std::shared_ptr<MemTableHandler> output_table = std::make_shared<MemTableHandler>();
+    output_table->SetMemoryTracker(tracker);
+    while (instance_stream->Valid()) {
+        if (limit_cnt_ > 0 && static_cast<int32_t>(output_table->GetCount()) >= limit_cnt_) {
+            break;
+        }
+        std::string key = instance_stream->GetKey();
+        SortedSegmentIterator instance_segment_iter(instance_stream.get(), key);
+        std::vector<std::shared_ptr<TableHandler>> union_segments(unions_cnt);
+        std::vector<std::unique_ptr<RowIterator>> union_segment_iters(unions_cnt);
+        for (size_t i = 0; i < unions_cnt; i++) {
+            if (union_streams[i]) {
+                // skip the union rows of the keys without instance rows, the keys are descending
+                while (union_streams[i]->Valid() && union_streams[i]->GetKey() > key) {
+                    union_streams[i]->Next();
+                }
+                union_segment_iters[i] = std::make_unique<SortedSegmentIterator>(union_streams[i].get(), key);
+            } else if (union_partitions[i]) {
+                union_segment_iters[i] =
+                    GetUnionSegmentIterator(i, union_partitions[i], key, &union_segments[i], tracker);
+            }
+        }
+        RunWindowAggOnIterators(parameter, &instance_segment_iter, union_segment_iters, join_right_tables,
+                                output_table, tracker);
+        if (ctx.MemoryLimitExceeded()) {
+            LOG(WARNING) << "Window Aggregation Fail: memory limit exceeded";
+            return fail_ptr;
+        }
+        // the rows left by the limit
+        while (instance_segment_iter.Valid()) {
+            instance_segment_iter.Next();
+        }
+    }
+    bool ok = instance_stream->ok();
+    for (auto& stream : union_streams) {
+        ok = ok && (!stream || stream->ok());
+    }
+    if (!ok) {
+        LOG(WARNING) << "Window Aggregation Fail: fail to read spilled rows";
+        return fail_ptr;
+    }
+    return output_table;
+}
+
 std::shared_ptr<DataHandler> RequestLastJoinRunner::Run(
     RunnerContext& ctx,
     const std::vector<std::shared_ptr<DataHandler>>& inputs) {  // NOLINT
@@ -1574,15 +1902,51 @@ std::shared_ptr<DataHandler> RequestLastJoinRunner::Run(
     if (kRowHandler != left->GetHanlderType()) {
         return std::shared_ptr<DataHandler>();
     }
-    auto left_row = std::dynamic_pointer_cast<RowHandler>(left)->GetValue();
+    Row output;
+    if (!JoinRow(ctx, std::dynamic_pointer_cast<RowHandler>(left)->GetValue(), right, &output)) {
+        return std::shared_ptr<DataHandler>();
+    }
+    return std::shared_ptr<RowHandler>(new MemRowHandler(output));
+}
+bool RequestLastJoinRunner::RunPipelineStep(RunnerContext& ctx, const Row& row,
+                                            const std::vector<std::shared_ptr<DataHandler>>& inputs, Row* output) {
+    if (inputs.size() < 2u) {
+        LOG(WARNING) << "inputs size < 2";
+        return false;
+    }
+    return JoinRow(ctx, row, inputs[1], output);
+}
+bool RequestLastJoinRunner::JoinRow(RunnerContext& ctx, const Row& left_row, std::shared_ptr<DataHandler> right,
+                                    Row* output) {
+    if (!right) {
+        return false;
+    }
     auto &parameter = ctx.GetParameterRow();
+    auto result_cache = ctx.result_cache();
+    if (nullptr != result_cache) {
+        // right data unchanged since the entry is put, the matched right row is the same
+        std::string cache_key;
+        uint64_t version = 0;
+        if (join_gen_.GetResultCacheKey(left_row, right, parameter, &cache_key, &version)) {
+            Row right_row;
+            bool hit = result_cache->Get(id_, cache_key, version, &right_row);
+            if (!hit) {
+                right_row = join_gen_.RowLastJoinDropLeftSlices(left_row, right, parameter);
+                result_cache->Put(id_, cache_key, version, right_row);
+            }
+            if (nullptr != ctx.profile()) {
+                ctx.profile()->RecordResultCache(id_, hit);
+            }
+            *output = output_right_only_ ? right_row : join_gen_.JoinRight(left_row, right_row);
+            return true;
+        }
+    }
     if (output_right_only_) {
-        return std::shared_ptr<RowHandler>(new MemRowHandler(
-            join_gen_.RowLastJoinDropLeftSlices(left_row, right, parameter)));
+        *output = join_gen_.RowLastJoinDropLeftSlices(left_row, right, parameter);
     } else {
-        return std::shared_ptr<RowHandler>(
-            new MemRowHandler(join_gen_.RowLastJoin(left_row, right, parameter)));
+        *output = join_gen_.RowLastJoin(left_row, right, parameter);
     }
+    return true;
 }
 
 std::shared_ptr<DataHandler> LastJoinRunner::Run(RunnerContext& ctx,
@@ -1603,11 +1967,12 @@ std::shared_ptr<DataHandler> LastJoinRunner::Run(RunnerContext& ctx,
         return fail_ptr;
     }
     auto &parameter = ctx.GetParameterRow();
+    auto tracker = ctx.GetRunnerMemoryTracker(id_);
 
     switch (left->GetHanlderType()) {
         case kTableHandler: {
             if (join_gen_.right_group_gen_.Valid()) {
-                right = join_gen_.right_group_gen_.Partition(right, parameter);
+                right = join_gen_.right_group_gen_.Partition(right, parameter, tracker);
             }
             if (!right) {
                 LOG(WARNING) << "fail to run last join: right partition is empty";
@@ -1617,6 +1982,7 @@ std::shared_ptr<DataHandler> LastJoinRunner::Run(RunnerContext& ctx,
 
             auto output_table =
                 std::shared_ptr<MemTimeTableHandler>(new MemTimeTableHandler());
+            output_table->SetMemoryTracker(tracker);
             output_table->SetOrderType(left_table->GetOrderType());
             if (kPartitionHandler == right->GetHanlderType()) {
                 if (!join_gen_.TableJoin(
@@ -1639,7 +2005,7 @@ std::shared_ptr<DataHandler> LastJoinRunner::Run(RunnerContext& ctx,
         }
         case kPartitionHandler: {
             if (join_gen_.right_group_gen_.Valid()) {
-                right = join_gen_.right_group_gen_.Partition(right, parameter);
+                right = join_gen_.right_group_gen_.Partition(right, parameter, tracker);
             }
             if (!right) {
                 LOG(WARNING) << "fail to run last join: right partition is empty";
@@ -1647,6 +2013,7 @@ std::shared_ptr<DataHandler> LastJoinRunner::Run(RunnerContext& ctx,
             }
             auto output_partition =
                 std::shared_ptr<MemPartitionHandler>(new MemPartitionHandler());
+            output_partition->SetMemoryTracker(tracker);
             auto left_partition =
                 std::dynamic_pointer_cast<PartitionHandler>(left);
             output_partition->SetOrderType(left_partition->GetOrderType());
@@ -1681,14 +2048,15 @@ std::shared_ptr<DataHandler> LastJoinRunner::Run(RunnerContext& ctx,
 }
 
 std::shared_ptr<PartitionHandler> PartitionGenerator::Partition(
-    std::shared_ptr<DataHandler> input, const Row& parameter) {
+    std::shared_ptr<DataHandler> input, const Row& parameter,
+    const std::shared_ptr<MemoryTracker>& tracker) {
     switch (input->GetHanlderType()) {
         case kPartitionHandler: {
             return Partition(
-                std::dynamic_pointer_cast<PartitionHandler>(input), parameter);
+                std::dynamic_pointer_cast<PartitionHandler>(input), parameter, tracker);
         }
         case kTableHandler: {
-            return Partition(std::dynamic_pointer_cast<TableHandler>(input), parameter);
+            return Partition(std::dynamic_pointer_cast<TableHandler>(input), parameter, tracker);
         }
         default: {
             LOG(WARNING) << "Partition Fail: input isn't partition or table";
@@ -1697,7 +2065,8 @@ std::shared_ptr<PartitionHandler> PartitionGenerator::Partition(
     }
 }
 std::shared_ptr<PartitionHandler> PartitionGenerator::Partition(
-    std::shared_ptr<PartitionHandler> table, const Row& parameter) {
+    std::shared_ptr<PartitionHandler> table, const Row& parameter,
+    const std::shared_ptr<MemoryTracker>& tracker) {
     if (!key_gen_.Valid()) {
         return table;
     }
@@ -1706,6 +2075,7 @@ std::shared_ptr<PartitionHandler> PartitionGenerator::Partition(
     }
     auto output_partitions = std::shared_ptr<MemPartitionHandler>(
         new MemPartitionHandler(table->GetSchema()));
+    output_partitions->SetMemoryTracker(tracker);
     auto partitions = std::dynamic_pointer_cast<PartitionHandler>(table);
     auto iter = partitions->GetWindowIterator();
     if (!iter) {
@@ -1723,10 +2093,13 @@ std::shared_ptr<PartitionHandler> PartitionGenerator::Partition(
         auto segment_key = iter->GetKey().ToString();
         segment_iter->SeekToFirst();
         while (segment_iter->Valid()) {
-            std::string keys = key_gen_.Gen(segment_iter->GetValue(), parameter);
-            output_partitions->AddRow(segment_key + "|" + keys,
-                                      segment_iter->GetKey(),
-                                      segment_iter->GetValue());
+            std::string keys = key_gen_.Gen(segment_iter->GetValue(), parameter, tracker);
+            if (!output_partitions->AddRow(segment_key + "|" + keys,
+                                           segment_iter->GetKey(),
+                                           segment_iter->GetValue())) {
+                LOG(WARNING) << "Partition Fail: memory limit exceeded";
+                return std::shared_ptr<PartitionHandler>();
+            }
             segment_iter->Next();
         }
         iter->Next();
@@ -1734,7 +2107,8 @@ std::shared_ptr<PartitionHandler> PartitionGenerator::Partition(
     return output_partitions;
 }
 std::shared_ptr<PartitionHandler> PartitionGenerator::Partition(
-    std::shared_ptr<TableHandler> table, const Row& parameter) {
+    std::shared_ptr<TableHandler> table, const Row& parameter,
+    const std::shared_ptr<MemoryTracker>& tracker) {
     auto fail_ptr = std::shared_ptr<PartitionHandler>();
     if (!key_gen_.Valid()) {
         return fail_ptr;
@@ -1748,6 +2122,7 @@ std::shared_ptr<PartitionHandler> PartitionGenerator::Partition(
 
     auto output_partitions = std::shared_ptr<MemPartitionHandler>(
         new MemPartitionHandler(table->GetSchema()));
+    output_partitions->SetMemoryTracker(tracker);
 
     auto iter = std::dynamic_pointer_cast<TableHandler>(table)->GetIterator();
     if (!iter) {
@@ -1756,25 +2131,29 @@ std::shared_ptr<PartitionHandler> PartitionGenerator::Partition(
     }
     iter->SeekToFirst();
     while (iter->Valid()) {
-        std::string keys = key_gen_.Gen(iter->GetValue(), parameter);
-        output_partitions->AddRow(keys, iter->GetKey(), iter->GetValue());
+        std::string keys = key_gen_.Gen(iter->GetValue(), parameter, tracker);
+        if (!output_partitions->AddRow(keys, iter->GetKey(), iter->GetValue())) {
+            LOG(WARNING) << "Fail to group table: memory limit exceeded";
+            return fail_ptr;
+        }
         iter->Next();
     }
     output_partitions->SetOrderType(table->GetOrderType());
     return output_partitions;
 }
 std::shared_ptr<DataHandler> SortGenerator::Sort(
-    std::shared_ptr<DataHandler> input, const bool reverse) {
+    std::shared_ptr<DataHandler> input, const bool reverse,
+    const std::shared_ptr<MemoryTracker>& tracker) {
     if (!input || !is_valid_ || !order_gen_.Valid()) {
         return input;
     }
     switch (input->GetHanlderType()) {
         case kTableHandler:
             return Sort(std::dynamic_pointer_cast<TableHandler>(input),
-                        reverse);
+                        reverse, tracker);
         case kPartitionHandler:
             return Sort(std::dynamic_pointer_cast<PartitionHandler>(input),
-                        reverse);
+                        reverse, tracker);
         default: {
             LOG(WARNING) << "Sort Fail: input isn't partition or table";
             return std::shared_ptr<PartitionHandler>();
@@ -1783,7 +2162,8 @@ std::shared_ptr<DataHandler> SortGenerator::Sort(
 }
 
 std::shared_ptr<PartitionHandler> SortGenerator::Sort(
-    std::shared_ptr<PartitionHandler> partition, const bool reverse) {
+    std::shared_ptr<PartitionHandler> partition, const bool reverse,
+    const std::shared_ptr<MemoryTracker>& tracker) {
     bool is_asc = reverse ? !is_asc_ : is_asc_;
     if (!is_valid_) {
         return partition;
@@ -1800,6 +2180,7 @@ std::shared_ptr<PartitionHandler> SortGenerator::Sort(
     DLOG(INFO) << "mismatch the order and sort it";
     auto output =
         std::shared_ptr<MemPartitionHandler>(new MemPartitionHandler());
+    output->SetMemoryTracker(tracker);
 
     auto iter = partition->GetWindowIterator();
     if (!iter) {
@@ -1817,9 +2198,12 @@ std::shared_ptr<PartitionHandler> SortGenerator::Sort(
         auto key = iter->GetKey().ToString();
         segment_iter->SeekToFirst();
         while (segment_iter->Valid()) {
-            int64_t ts = order_gen_.Gen(segment_iter->GetValue());
-            output->AddRow(key, static_cast<uint64_t>(ts),
-                           segment_iter->GetValue());
+            int64_t ts = order_gen_.Gen(segment_iter->GetValue(), tracker);
+            if (!output->AddRow(key, static_cast<uint64_t>(ts),
+                                segment_iter->GetValue())) {
+                LOG(WARNING) << "Sort partition fail: memory limit exceeded";
+                return std::shared_ptr<PartitionHandler>();
+            }
             segment_iter->Next();
         }
     }
@@ -1831,8 +2215,45 @@ std::shared_ptr<PartitionHandler> SortGenerator::Sort(
     return output;
 }
 
+OrderType SortGenerator::SortedOrder(OrderType input_order, const bool reverse) const {
+    bool is_asc = reverse ? !is_asc_ : is_asc_;
+    if (!is_valid_) {
+        return kNoneOrder;
+    }
+    if (!order_gen_.Valid() && (kNoneOrder == input_order || is_asc == (kAscOrder == input_order))) {
+        return kNoneOrder;
+    }
+    // sorted by the order keys, or reversed by the input keys
+    return is_asc ? kAscOrder : kDescOrder;
+}
+
+std::unique_ptr<SortedRowStream> WindowGenerator::PartitionAndSort(std::shared_ptr<TableHandler> table,
+                                                                   const Row& parameter,
+                                                                   const SpillOptions& options,
+                                                                   const std::shared_ptr<MemoryTracker>& tracker) {
+    if (!table || !partition_gen_.Valid()) {
+        return nullptr;
+    }
+    auto iter = table->GetIterator();
+    if (!iter) {
+        LOG(WARNING) << "Partition Fail: table is empty";
+        return nullptr;
+    }
+    ExternalSorter sorter(options, sort_gen_.SortedOrder(table->GetOrderType()), tracker);
+    iter->SeekToFirst();
+    while (iter->Valid()) {
+        const Row& row = iter->GetValue();
+        if (!sorter.Add(partition_gen_.GetKey(row, parameter), sort_gen_.SortedKey(row, iter->GetKey()), row)) {
+            return nullptr;
+        }
+        iter->Next();
+    }
+    return sorter.Finish();
+}
+
 std::shared_ptr<TableHandler> SortGenerator::Sort(
-    std::shared_ptr<TableHandler> table, const bool reverse) {
+    std::shared_ptr<TableHandler> table, const bool reverse,
+    const std::shared_ptr<MemoryTracker>& tracker) {
     bool is_asc = reverse ? !is_asc_ : is_asc_;
     if (!table || !is_valid_) {
         return table;
@@ -1842,6 +2263,7 @@ std::shared_ptr<TableHandler> SortGenerator::Sort(
         return table;
     }
     auto output_table = std::make_shared<MemTimeTableHandler>(table->GetSchema());
+    output_table->SetMemoryTracker(tracker);
     output_table->SetOrderType(table->GetOrderType());
     auto iter = std::dynamic_pointer_cast<TableHandler>(table)->GetIterator();
     if (!iter) {
@@ -1851,7 +2273,7 @@ std::shared_ptr<TableHandler> SortGenerator::Sort(
     iter->SeekToFirst();
     while (iter->Valid()) {
         if (order_gen_.Valid()) {
-            int64_t key = order_gen_.Gen(iter->GetValue());
+            int64_t key = order_gen_.Gen(iter->GetValue(), tracker);
             output_table->AddRow(static_cast<uint64_t>(key), iter->GetValue());
         } else {
             output_table->AddRow(iter->GetKey(), iter->GetValue());
@@ -1890,6 +2312,43 @@ Row JoinGenerator::RowLastJoinDropLeftSlices(
     }
     return right_row;
 }
+bool JoinGenerator::GetResultCacheKey(const Row& left_row, std::shared_ptr<DataHandler> right,
+                                      const Row& parameter, std::string* key, uint64_t* version) {
+    if (condition_gen_.Valid()) {
+        return false;
+    }
+    key->clear();
+    switch (right->GetHanlderType()) {
+        case kPartitionHandler: {
+            if (!index_key_gen_.Valid()) {
+                return false;
+            }
+            std::string index_key = index_key_gen_.Gen(left_row, parameter);
+            auto segment = std::dynamic_pointer_cast<PartitionHandler>(right)->GetSegment(index_key);
+            if (!segment) {
+                return false;
+            }
+            *version = segment->GetWriteVersion();
+            uint32_t size = index_key.size();
+            key->append(reinterpret_cast<const char*>(&size), sizeof(size));
+            key->append(index_key);
+            break;
+        }
+        case kTableHandler: {
+            *version = right->GetWriteVersion();
+            break;
+        }
+        default:
+            return false;
+    }
+    if (0 == *version) {
+        return false;
+    }
+    if (left_key_gen_.Valid()) {
+        key->append(left_key_gen_.Gen(left_row, parameter));
+    }
+    return true;
+}
 Row JoinGenerator::RowLastJoin(const Row& left_row,
                                std::shared_ptr<DataHandler> right,
                                const Row& parameter) {
@@ -2057,11 +2516,14 @@ bool JoinGenerator::PartitionJoin(std::shared_ptr<PartitionHandler> left,
             const Row& left_row = left_iter->GetValue();
             auto key_str = std::string(
                 reinterpret_cast<const char*>(left_key.buf()), left_key.size());
-            output->AddRow(key_str, left_iter->GetKey(),
-                           Runner::RowLastJoinTable(
-                               left_slices_, left_row, right_slices_, right,
-                               parameter,
-                               right_sort_gen_, condition_gen_));
+            if (!output->AddRow(key_str, left_iter->GetKey(),
+                                Runner::RowLastJoinTable(
+                                    left_slices_, left_row, right_slices_, right,
+                                    parameter,
+                                    right_sort_gen_, condition_gen_))) {
+                LOG(WARNING) << "fail to run last join: memory limit exceeded";
+                return false;
+            }
             left_iter->Next();
         }
         left_window_iter->Next();
@@ -2110,10 +2572,13 @@ bool JoinGenerator::PartitionJoin(std::shared_ptr<PartitionHandler> left,
             auto right_table = right->GetSegment(key_str);
             auto left_key_str = std::string(
                 reinterpret_cast<const char*>(left_key.buf()), left_key.size());
-            output->AddRow(left_key_str, left_iter->GetKey(),
-                           Runner::RowLastJoinTable(
-                               left_slices_, left_row, right_slices_,
-                               right_table, parameter, right_sort_gen_, condition_gen_));
+            if (!output->AddRow(left_key_str, left_iter->GetKey(),
+                                Runner::RowLastJoinTable(
+                                    left_slices_, left_row, right_slices_,
+                                    right_table, parameter, right_sort_gen_, condition_gen_))) {
+                LOG(WARNING) << "fail to run last join: memory limit exceeded";
+                return false;
+            }
             left_iter->Next();
         }
         left_partition_iter->Next();
@@ -2542,6 +3007,85 @@ std::shared_ptr<DataHandler> ConcatRunner::Run(
         }
     }
 }
+bool ConcatRunner::RunPipelineStep(RunnerContext& ctx, const Row& row,
+                                   const std::vector<std::shared_ptr<DataHandler>>& inputs, Row* output) {
+    if (inputs.size() < 2) {
+        LOG(WARNING) << "inputs size < 2";
+        return false;
+    }
+    size_t left_slices = producers_[0]->output_schemas()->GetSchemaSourceSize();
+    size_t right_slices = producers_[1]->output_schemas()->GetSchemaSourceSize();
+    // same as RowCombineWrapper, the right input is a row handler in request mode
+    auto right = std::dynamic_pointer_cast<RowHandler>(inputs[1]);
+    *output = Row(left_slices, row, right_slices, right ? right->GetValue() : Row());
+    return true;
+}
+
+PipelineRunner::PipelineRunner(const int32_t id, const std::vector<Runner*>& steps)
+    : Runner(id, kRunnerPipeline, steps.back()->output_schemas(), steps.back()->limit_cnt_), steps_(steps) {
+    producers_.push_back(steps_.front()->GetProducers()[0]);
+    for (auto step : steps_) {
+        side_input_offsets_.push_back(producers_.size());
+        auto& step_producers = step->GetProducers();
+        for (size_t i = 1; i < step_producers.size(); i++) {
+            producers_.push_back(step_producers[i]);
+        }
+    }
+}
+void PipelineRunner::StepInputs(size_t idx, std::shared_ptr<DataHandler> main,
+                                const std::vector<std::shared_ptr<DataHandler>>& inputs,
+                                std::vector<std::shared_ptr<DataHandler>>* step_inputs) const {
+    size_t size = steps_[idx]->GetProducers().size();
+    step_inputs->resize(size);
+    (*step_inputs)[0] = main;
+    for (size_t i = 1; i < size; i++) {
+        (*step_inputs)[i] = inputs[side_input_offsets_[idx] + i - 1];
+    }
+}
+std::shared_ptr<DataHandler> PipelineRunner::Run(
+    RunnerContext& ctx,
+    const std::vector<std::shared_ptr<DataHandler>>& inputs) {
+    if (inputs.size() != producers_.size()) {
+        LOG(WARNING) << "inputs size " << inputs.size() << " != " << producers_.size();
+        return std::shared_ptr<DataHandler>();
+    }
+    auto head = inputs[0];
+    if (!head) {
+        LOG(WARNING) << "pipeline fail: head input is null";
+        return std::shared_ptr<DataHandler>();
+    }
+    std::vector<std::shared_ptr<DataHandler>> step_inputs;
+    if (kRowHandler != head->GetHanlderType()) {
+        // not a request row, run the steps one by one like they are not fused
+        std::shared_ptr<DataHandler> output = head;
+        for (size_t i = 0; i < steps_.size() && output; i++) {
+            StepInputs(i, output, inputs, &step_inputs);
+            output = steps_[i]->Run(ctx, step_inputs);
+        }
+        return output;
+    }
+    Row row = std::dynamic_pointer_cast<RowHandler>(head)->GetValue();
+    Row output;
+    for (size_t i = 0; i < steps_.size(); i++) {
+        StepInputs(i, std::shared_ptr<DataHandler>(), inputs, &step_inputs);
+        if (!steps_[i]->RunPipelineStep(ctx, row, step_inputs, &output)) {
+            LOG(WARNING) << "pipeline fail: step [" << steps_[i]->id_ << "] fail";
+            return std::shared_ptr<DataHandler>();
+        }
+        row = output;
+    }
+    return std::shared_ptr<RowHandler>(new MemRowHandler(row));
+}
+void PipelineRunner::PrintRunnerInfo(std::ostream& output, const std::string& tab) const {
+    output << tab << "[" << id_ << "]" << RunnerTypeName(type_) << "(";
+    for (size_t i = 0; i < steps_.size(); i++) {
+        if (i > 0) {
+            output << " -> ";
+        }
+        steps_[i]->PrintRunnerInfo(output, "");
+    }
+    output << ")";
+}
 
 std::shared_ptr<DataHandler> LimitRunner::Run(
     RunnerContext& ctx,
@@ -2567,6 +3111,7 @@ std::shared_ptr<DataHandler> LimitRunner::Run(
             iter->SeekToFirst();
             auto output_table = std::shared_ptr<MemTableHandler>(
                 new MemTableHandler(input->GetSchema()));
+            output_table->SetMemoryTracker(ctx.GetRunnerMemoryTracker(id_));
             int32_t cnt = 0;
             while (cnt++ < limit_cnt_ && iter->Valid()) {
                 output_table->AddRow(iter->GetValue());
@@ -2631,7 +3176,20 @@ std::shared_ptr<DataHandler> GroupAggRunner::Run(
         return std::shared_ptr<DataHandler>();
     }
     auto& parameter = ctx.GetParameterRow();
+    auto tracker = ctx.GetRunnerMemoryTracker(id_);
+    if (spill_group_gen_) {
+        if (kTableHandler == input->GetHanlderType() && spill_group_gen_->Valid()) {
+            return RunWithSpill(parameter, std::dynamic_pointer_cast<TableHandler>(input), tracker);
+        }
+        // group the other inputs in memory, as the group runner does
+        input = spill_group_gen_->Partition(input, parameter, tracker);
+        if (!input) {
+            LOG(WARNING) << "group aggregation fail: fail to group input";
+            return std::shared_ptr<DataHandler>();
+        }
+    }
     auto output_table = std::shared_ptr<MemTableHandler>(new MemTableHandler());
+    output_table->SetMemoryTracker(tracker);
 
     if (kTableHandler == input->GetHanlderType()) {
         auto table = std::dynamic_pointer_cast<TableHandler>(input);
@@ -2639,8 +3197,8 @@ std::shared_ptr<DataHandler> GroupAggRunner::Run(
             LOG(WARNING) << "group aggregation fail: input table is null";
             return std::shared_ptr<DataHandler>();
         }
-        if (!having_condition_.Valid() || having_condition_.Gen(table, parameter)) {
-            output_table->AddRow(agg_gen_.Gen(parameter, table));
+        if (!having_condition_.Valid() || having_condition_.Gen(table, parameter, tracker)) {
+            output_table->AddRow(agg_gen_.Gen(parameter, table, tracker));
         }
         return output_table;
     } else if (kPartitionHandler == input->GetHanlderType()) {
@@ -2662,8 +3220,8 @@ std::shared_ptr<DataHandler> GroupAggRunner::Run(
                 LOG(WARNING) << "group aggregation fail: segment segment is null";
                 return std::shared_ptr<DataHandler>();
             }
-            if (!having_condition_.Valid() || having_condition_.Gen(segment, parameter)) {
-                output_table->AddRow(agg_gen_.Gen(parameter, segment));
+            if (!having_condition_.Valid() || having_condition_.Gen(segment, parameter, tracker)) {
+                output_table->AddRow(agg_gen_.Gen(parameter, segment, tracker));
             }
             iter->Next();
         }
@@ -2674,6 +3232,56 @@ std::shared_ptr<DataHandler> GroupAggRunner::Run(
     }
 }
 
+// Run group aggregation on the table grouped by an external sorter, only the
+// rows of one group and the runs being merged are in memory besides the output
+std::shared_ptr<DataHandler> GroupAggRunner::RunWithSpill(const Row& parameter, std::shared_ptr<TableHandler> table,
+                                                          const std::shared_ptr<MemoryTracker>& tracker) {
+    auto iter = table->GetIterator();
+    if (!iter) {
+        LOG(WARNING) << "group aggregation fail: input iterator is null";
+        return std::shared_ptr<DataHandler>();
+    }
+    // the rows of a group keep their order, as the partition of the group runner
+    ExternalSorter sorter(spill_options_, kNoneOrder, tracker);
+    iter->SeekToFirst();
+    while (iter->Valid()) {
+        const Row& row = iter->GetValue();
+        if (!sorter.Add(spill_group_gen_->GetKey(row, parameter), iter->GetKey(), row)) {
+            LOG(WARNING) << "group aggregation fail: fail to spill input";
+            return std::shared_ptr<DataHandler>();
+        }
+        iter->Next();
+    }
+    auto stream = sorter.Finish();
+    if (!stream) {
+        LOG(WARNING) << "group aggregation fail: fail to sort input";
+        return std::shared_ptr<DataHandler>();
+    }
+    auto output_table = std::shared_ptr<MemTableHandler>(new MemTableHandler());
+    output_table->SetMemoryTracker(tracker);
+    int32_t cnt = 0;
+    while (stream->Valid()) {
+        if (limit_cnt_ > 0 && cnt++ >= limit_cnt_) {
+            break;
+        }
+        std::string key = stream->GetKey();
+        auto segment = std::make_shared<MemTimeTableHandler>(table->GetSchema());
+        segment->SetMemoryTracker(tracker);
+        segment->SetOrderType(table->GetOrderType());
+        for (SortedSegmentIterator segment_iter(stream.get(), key); segment_iter.Valid(); segment_iter.Next()) {
+            segment->AddRow(segment_iter.GetKey(), segment_iter.GetValue());
+        }
+        if (!having_condition_.Valid() || having_condition_.Gen(segment, parameter, tracker)) {
+            output_table->AddRow(agg_gen_.Gen(parameter, segment, tracker));
+        }
+    }
+    if (!stream->ok()) {
+        LOG(WARNING) << "group aggregation fail: fail to read spilled rows";
+        return std::shared_ptr<DataHandler>();
+    }
+    return output_table;
+}
+
 bool RequestAggUnionRunner::InitAggregator() {
     auto func_name = func_->GetName();
     auto type_it = agg_type_map_.find(func_name);
@@ -2712,6 +3320,10 @@ bool RequestAggUnionRunner::InitAggregator() {
         case kMax:
             aggregator_ = MakeSameTypeAggregator<MaxAggregator>(agg_col_type, *output_schemas_->GetOutputSchema());
             return true;
+        case kApproxDistinctCount:
+            aggregator_ = MakeSameTypeAggregator<ApproxDistinctCountAggregator>(
+                agg_col_type, *output_schemas_->GetOutputSchema());
+            return aggregator_ != nullptr;
         default:
             LOG(ERROR) << "RequestAggUnionRunner does not support for op " << func_name;
             return false;
@@ -2780,7 +3392,8 @@ std::shared_ptr<DataHandler> RequestAggUnionRunner::Run(
     } else {
         LOG(WARNING) << "Aggr segment is empty. Fall back to normal RequestUnionRunner";
         window = RequestUnionRunner::RequestUnionWindow(request, union_segments, ts_gen, range_gen_.window_range_,
-                                                        output_request_row_, exclude_current_time_);
+                                                        output_request_row_, exclude_current_time_,
+                                                        ctx.GetRunnerMemoryTracker(id_));
     }
 
     if (ctx.is_debug()) {
@@ -3071,7 +3684,7 @@ std::shared_ptr<DataHandler> ReduceRunner::Run(
     }
 
     auto parameter = ctx.GetParameterRow();
-    if (having_condition_.Valid() && !having_condition_.Gen(table, parameter)) {
+    if (having_condition_.Valid() && !having_condition_.Gen(table, parameter, ctx.GetRunnerMemoryTracker(id_))) {
         return std::shared_ptr<DataHandler>();
     }
 
@@ -3119,13 +3732,97 @@ std::shared_ptr<DataHandler> RequestUnionRunner::Run(
     // build window with start and end offset
     return RequestUnionWindow(request, union_segments, ts_gen,
                               range_gen_.window_range_, output_request_row_,
-                              exclude_current_time_);
+                              exclude_current_time_, ctx.GetRunnerMemoryTracker(id_));
+}
+std::shared_ptr<DataHandlerList> RequestUnionRunner::BatchRequestRun(
+    RunnerContext& ctx) {
+    if (need_batch_cache_ || producers_.size() < 2u || ctx.GetRequestSize() <= 1 ||
+        windows_union_gen_.windows_gen_.empty()) {
+        return Runner::BatchRequestRun(ctx);
+    }
+    if (need_cache_) {
+        auto cached = ctx.GetBatchCache(id_);
+        if (cached != nullptr) {
+            DLOG(INFO) << "RUNNER ID " << id_ << " HIT CACHE!";
+            if (ctx.profile() != nullptr) {
+                ctx.profile()->RecordCacheHit(id_);
+            }
+            return cached;
+        }
+    }
+    std::vector<std::shared_ptr<DataHandlerList>> batch_inputs(
+        producers_.size());
+    for (size_t idx = producers_.size(); idx > 0; idx--) {
+        batch_inputs[idx - 1] = producers_[idx - 1]->BatchRequestRun(ctx);
+    }
+
+    RunnerProfileGuard profile_guard(ctx.profile(), id_);
+    size_t request_size = ctx.GetRequestSize();
+    std::vector<std::shared_ptr<DataHandler>> results(request_size);
+    // group the rows by the keys of the union windows, keep the order of the
+    // first row of each group
+    std::vector<Row> requests(request_size);
+    std::vector<std::vector<size_t>> groups;
+    std::unordered_map<std::string, size_t> group_pos;
+    for (size_t idx = 0; idx < request_size; idx++) {
+        auto left = batch_inputs[0]->Get(idx);
+        auto right = batch_inputs[1]->Get(idx);
+        if (!left || !right || kRowHandler != left->GetHanlderType()) {
+            continue;
+        }
+        requests[idx] = std::dynamic_pointer_cast<RowHandler>(left)->GetValue();
+        auto key = windows_union_gen_.GetRequestWindowsKey(requests[idx], ctx.GetParameterRow());
+        auto iter = group_pos.find(key);
+        if (iter == group_pos.end()) {
+            group_pos.emplace(key, groups.size());
+            groups.push_back({idx});
+        } else {
+            groups[iter->second].push_back(idx);
+        }
+    }
+
+    auto union_inputs = windows_union_gen_.RunInputs(ctx);
+    auto tracker = ctx.GetRunnerMemoryTracker(id_);
+    for (const auto& group : groups) {
+        // the segments are sought, filtered and sorted once for the group
+        auto union_segments = windows_union_gen_.GetRequestWindows(
+            requests[group[0]], ctx.GetParameterRow(), union_inputs);
+        for (size_t idx : group) {
+            int64_t ts_gen = range_gen_.Valid() ? range_gen_.ts_gen_.Gen(requests[idx]) : -1;
+            results[idx] = RequestUnionWindow(requests[idx], union_segments, ts_gen,
+                                              range_gen_.window_range_, output_request_row_,
+                                              exclude_current_time_, tracker);
+        }
+    }
+
+    std::shared_ptr<DataHandlerVector> outputs =
+        std::make_shared<DataHandlerVector>();
+    for (auto& res : results) {
+        outputs->Add(res);
+    }
+    if (ctx.is_debug()) {
+        std::ostringstream oss;
+        oss << "RUNNER TYPE: " << RunnerTypeName(type_) << ", ID: " << id_
+            << ", WINDOW GROUPS: " << groups.size() << "\n";
+        for (size_t idx = 0; idx < outputs->GetSize(); idx++) {
+            if (idx >= MAX_DEBUG_BATCH_SiZE) {
+                oss << ">= MAX_DEBUG_BATCH_SiZE...\n";
+                break;
+            }
+            Runner::PrintData(oss, output_schemas_, outputs->Get(idx));
+        }
+        LOG(INFO) << oss.str();
+    }
+    if (need_cache_) {
+        ctx.SetBatchCache(id_, outputs);
+    }
+    return outputs;
 }
 std::shared_ptr<TableHandler> RequestUnionRunner::RequestUnionWindow(
     const Row& request,
     std::vector<std::shared_ptr<TableHandler>> union_segments, int64_t ts_gen,
     const WindowRange& window_range, const bool output_request_row,
-    const bool exclude_current_time) {
+    const bool exclude_current_time, const std::shared_ptr<MemoryTracker>& tracker) {
     uint64_t start = 0;
     uint64_t end = UINT64_MAX;
     uint64_t rows_start_preceding = 0;
@@ -3148,6 +3845,7 @@ std::shared_ptr<TableHandler> RequestUnionRunner::RequestUnionWindow(
 
     auto window_table =
         std::shared_ptr<MemTimeTableHandler>(new MemTimeTableHandler());
+    window_table->SetMemoryTracker(tracker);
 
     size_t unions_cnt = union_segments.size();
     // Prepare Union Segment Iterators
@@ -3201,6 +3899,10 @@ std::shared_ptr<TableHandler> RequestUnionRunner::RequestUnionWindow(
                 union_segment_status[max_union_pos].key_,
                 union_segment_iters[max_union_pos]->GetValue());
             cnt++;
+            if (tracker && tracker->LimitExceeded()) {
+                LOG(WARNING) << "fail to build request union window: memory limit exceeded";
+                return nullptr;
+            }
         }
         // Update Iterator Status
         union_segment_iters[max_union_pos]->Next();
@@ -3264,11 +3966,12 @@ std::shared_ptr<DataHandler> AggRunner::Run(
     }
     auto table = std::dynamic_pointer_cast<TableHandler>(input);
     auto parameter = ctx.GetParameterRow();
-    if (having_condition_.Valid() && !having_condition_.Gen(table, parameter)) {
+    auto tracker = ctx.GetRunnerMemoryTracker(id_);
+    if (having_condition_.Valid() && !having_condition_.Gen(table, parameter, tracker)) {
         return std::shared_ptr<DataHandler>();
     }
     auto row_handler = std::shared_ptr<RowHandler>(new MemRowHandler(
-        agg_gen_.Gen(parameter, table)));
+        agg_gen_.Gen(parameter, table, tracker)));
     return row_handler;
 }
 std::shared_ptr<DataHandlerList> ProxyRequestRunner::BatchRequestRun(
@@ -3277,6 +3980,9 @@ std::shared_ptr<DataHandlerList> ProxyRequestRunner::BatchRequestRun(
         auto cached = ctx.GetBatchCache(id_);
         if (cached != nullptr) {
             DLOG(INFO) << "RUNNER ID " << id_ << " HIT CACHE!";
+            if (ctx.profile() != nullptr) {
+                ctx.profile()->RecordCacheHit(id_);
+            }
             return cached;
         }
     }
@@ -3287,6 +3993,7 @@ std::shared_ptr<DataHandlerList> ProxyRequestRunner::BatchRequestRun(
     if (nullptr != index_input_) {
         index_key_input = index_input_->BatchRequestRun(ctx);
     }
+    RunnerProfileGuard profile_guard(ctx.profile(), id_);
     if (!proxy_batch_input || 0 == proxy_batch_input->GetSize()) {
         LOG(WARNING) << "proxy batch run input is empty";
         return std::shared_ptr<DataHandlerList>();
@@ -3654,8 +4361,8 @@ std::shared_ptr<TableHandler> ProxyRequestRunner::RunWithRowsInput(
  * TODO(chenjing): GenConst key during compile-time
  * @return
  */
-const std::string KeyGenerator::GenConst(const Row& parameter) {
-    Row key_row = CoreAPI::RowConstProject(fn_, parameter, true);
+const std::string KeyGenerator::GenConst(const Row& parameter, const std::shared_ptr<MemoryTracker>& tracker) {
+    Row key_row = CoreAPI::RowConstProject(fn_, parameter, true, tracker);
     RowView row_view(row_view_);
     if (!row_view.Reset(key_row.buf())) {
         LOG(WARNING) << "fail to gen key: row view reset fail";
@@ -3679,113 +4386,131 @@ const std::string KeyGenerator::GenConst(const Row& parameter) {
     }
     return keys;
 }
-const std::string KeyGenerator::Gen(const Row& row, const Row& parameter) {
+const std::string KeyGenerator::Gen(const Row& row, const Row& parameter,
+                                    const std::shared_ptr<MemoryTracker>& tracker) {
+    return Gen(row, parameter, false, tracker);
+}
+
+const std::string KeyGenerator::GenUnique(const Row& row, const Row& parameter,
+                                          const std::shared_ptr<MemoryTracker>& tracker) {
+    return Gen(row, parameter, true, tracker);
+}
+
+const std::string KeyGenerator::Gen(const Row& row, const Row& parameter, bool size_prefixed,
+                                    const std::shared_ptr<MemoryTracker>& tracker) {
     // TODO(wtz) 避免不必要的row project
     if (row.size() == 0) {
         return codec::NONETOKEN;
     }
-    Row key_row = CoreAPI::RowProject(fn_, row, parameter, true);
+    Row key_row = CoreAPI::RowProject(fn_, row, parameter, true, tracker);
     std::string keys = "";
+    std::string key;
     for (auto pos : idxs_) {
-        if (!keys.empty()) {
-            keys.append("|");
-        }
+        key.clear();
         if (row_view_.IsNULL(key_row.buf(), pos)) {
-            keys.append(codec::NONETOKEN);
-            continue;
+            key.append(codec::NONETOKEN);
+        } else {
+            AppendKey(key_row, pos, &key);
         }
-        ::hybridse::type::Type type = fn_schema_.Get(pos).type();
-        switch (type) {
-            case ::hybridse::type::kVarchar: {
-                const char* buf = nullptr;
-                uint32_t size = 0;
-                if (row_view_.GetValue(key_row.buf(), pos, &buf, &size) == 0) {
-                    if (size == 0) {
-                        keys.append(codec::EMPTY_STRING.c_str(),
-                                    codec::EMPTY_STRING.size());
-                    } else {
-                        keys.append(buf, size);
-                    }
-                }
-                break;
-            }
-            case hybridse::type::kDate: {
-                int32_t buf = 0;
-                if (row_view_.GetValue(key_row.buf(), pos, type,
-                                       reinterpret_cast<void*>(&buf)) == 0) {
-                    keys.append(std::to_string(buf));
+        if (size_prefixed) {
+            keys.append(std::to_string(key.size())).append(1, ':');
+        } else if (!keys.empty()) {
+            keys.append("|");
+        }
+        keys.append(key);
+    }
+    return keys;
+}
+
+void KeyGenerator::AppendKey(const Row& key_row, int32_t pos, std::string* keys) {
+    ::hybridse::type::Type type = fn_schema_.Get(pos).type();
+    switch (type) {
+        case ::hybridse::type::kVarchar: {
+            const char* buf = nullptr;
+            uint32_t size = 0;
+            if (row_view_.GetValue(key_row.buf(), pos, &buf, &size) == 0) {
+                if (size == 0) {
+                    keys->append(codec::EMPTY_STRING.c_str(), codec::EMPTY_STRING.size());
+                } else {
+                    keys->append(buf, size);
                 }
-                break;
             }
-            case hybridse::type::kBool: {
-                bool buf = false;
-                if (row_view_.GetValue(key_row.buf(), pos, type,
-                                       reinterpret_cast<void*>(&buf)) == 0) {
-                    keys.append(buf ? "true" : "false");
-                }
-                break;
+            break;
+        }
+        case hybridse::type::kDate: {
+            int32_t buf = 0;
+            if (row_view_.GetValue(key_row.buf(), pos, type, reinterpret_cast<void*>(&buf)) == 0) {
+                keys->append(std::to_string(buf));
             }
-            case hybridse::type::kInt16: {
-                int16_t buf = 0;
-                if (row_view_.GetValue(key_row.buf(), pos, type,
-                                       reinterpret_cast<void*>(&buf)) == 0) {
-                    keys.append(std::to_string(buf));
-                }
-                break;
+            break;
+        }
+        case hybridse::type::kBool: {
+            bool buf = false;
+            if (row_view_.GetValue(key_row.buf(), pos, type, reinterpret_cast<void*>(&buf)) == 0) {
+                keys->append(buf ? "true" : "false");
             }
-            case hybridse::type::kInt32: {
-                int32_t buf = 0;
-                if (row_view_.GetValue(key_row.buf(), pos, type,
-                                       reinterpret_cast<void*>(&buf)) == 0) {
-                    keys.append(std::to_string(buf));
-                }
-                break;
+            break;
+        }
+        case hybridse::type::kInt16: {
+            int16_t buf = 0;
+            if (row_view_.GetValue(key_row.buf(), pos, type, reinterpret_cast<void*>(&buf)) == 0) {
+                keys->append(std::to_string(buf));
             }
-            case hybridse::type::kInt64:
-            case hybridse::type::kTimestamp: {
-                int64_t buf = 0;
-                if (row_view_.GetValue(key_row.buf(), pos, type,
-                                       reinterpret_cast<void*>(&buf)) == 0) {
-                    keys.append(std::to_string(buf));
-                }
-                break;
+            break;
+        }
+        case hybridse::type::kInt32: {
+            int32_t buf = 0;
+            if (row_view_.GetValue(key_row.buf(), pos, type, reinterpret_cast<void*>(&buf)) == 0) {
+                keys->append(std::to_string(buf));
             }
-            default: {
-                DLOG(ERROR) << "unsupported: partition key's type is " << node::TypeName(type);
-                break;
+            break;
+        }
+        case hybridse::type::kInt64:
+        case hybridse::type::kTimestamp: {
+            int64_t buf = 0;
+            if (row_view_.GetValue(key_row.buf(), pos, type, reinterpret_cast<void*>(&buf)) == 0) {
+                keys->append(std::to_string(buf));
             }
+            break;
+        }
+        default: {
+            DLOG(ERROR) << "unsupported: partition key's type is " << node::TypeName(type);
+            break;
         }
     }
-    return keys;
 }
 
-const int64_t OrderGenerator::Gen(const Row& row) {
-    Row order_row = CoreAPI::RowProject(fn_, row, Row(), true);
+const int64_t OrderGenerator::Gen(const Row& row, const std::shared_ptr<MemoryTracker>& tracker) {
+    Row order_row = CoreAPI::RowProject(fn_, row, Row(), true, tracker);
     return Runner::GetColumnInt64(order_row.buf(), &row_view_, idxs_[0],
                                   fn_schema_.Get(idxs_[0]).type());
 }
 
-const bool ConditionGenerator::Gen(const Row& row, const Row& parameter) const {
-    return CoreAPI::ComputeCondition(fn_, row, parameter, &row_view_, idxs_[0]);
+const bool ConditionGenerator::Gen(const Row& row, const Row& parameter,
+                                   const std::shared_ptr<MemoryTracker>& tracker) const {
+    return CoreAPI::ComputeCondition(fn_, row, parameter, &row_view_, idxs_[0], tracker);
 }
-const bool ConditionGenerator::Gen(std::shared_ptr<TableHandler> table, const codec::Row& parameter) {
-    Row cond_row = Runner::GroupbyProject(fn_, parameter, table.get());
+const bool ConditionGenerator::Gen(std::shared_ptr<TableHandler> table, const codec::Row& parameter,
+                                   const std::shared_ptr<MemoryTracker>& tracker) {
+    Row cond_row = Runner::GroupbyProject(fn_, parameter, table.get(), tracker);
     return Runner::GetColumnBool(cond_row.buf(), &row_view_, idxs_[0],
                                  row_view_.GetSchema()->Get(idxs_[0]).type());
 }
-const Row ProjectGenerator::Gen(const Row& row, const Row& parameter) {
-    return CoreAPI::RowProject(fn_, row, parameter, false);
+const Row ProjectGenerator::Gen(const Row& row, const Row& parameter, const std::shared_ptr<MemoryTracker>& tracker) {
+    return CoreAPI::RowProject(fn_, row, parameter, false, tracker);
 }
 
-const Row ConstProjectGenerator::Gen(const Row& parameter) {
-    return CoreAPI::RowConstProject(fn_, parameter, false);
+const Row ConstProjectGenerator::Gen(const Row& parameter, const std::shared_ptr<MemoryTracker>& tracker) {
+    return CoreAPI::RowConstProject(fn_, parameter, false, tracker);
 }
 
-const Row AggGenerator::Gen(const codec::Row& parameter_row, std::shared_ptr<TableHandler> table) {
-    return Runner::GroupbyProject(fn_, parameter_row, table.get());
+const Row AggGenerator::Gen(const codec::Row& parameter_row, std::shared_ptr<TableHandler> table,
+                            const std::shared_ptr<MemoryTracker>& tracker) {
+    return Runner::GroupbyProject(fn_, parameter_row, table.get(), tracker);
 }
 
-Row Runner::GroupbyProject(const int8_t* fn, const codec::Row& parameter, TableHandler* table) {
+Row Runner::GroupbyProject(const int8_t* fn, const codec::Row& parameter, TableHandler* table,
+                           const std::shared_ptr<MemoryTracker>& tracker) {
     auto iter = table->GetIterator();
     if (!iter) {
         LOG(WARNING) << "Agg table is empty";
@@ -3797,6 +4522,9 @@ Row Runner::GroupbyProject(const int8_t* fn, const codec::Row& parameter, TableH
     }
     auto& row = iter->GetValue();
     auto& row_key = iter->GetKey();
+    // Init current run step runtime
+    JitRuntime::get()->InitRunStep(tracker);
+
     auto udf = reinterpret_cast<int32_t (*)(const int64_t, const int8_t*,
                                             const int8_t*, const int8_t*, int8_t**)>(
         const_cast<int8_t*>(fn));
@@ -3810,6 +4538,10 @@ Row Runner::GroupbyProject(const int8_t* fn, const codec::Row& parameter, TableH
     auto window_ptr = reinterpret_cast<const int8_t*>(&window_ref);
 
     uint32_t ret = udf(row_key, row_ptr, window_ptr, parameter_ptr, &buf);
+
+    // Release current run step resources
+    JitRuntime::get()->ReleaseRunStep();
+
     if (ret != 0) {
         LOG(WARNING) << "fail to run udf " << ret;
         return Row();
@@ -3837,13 +4569,13 @@ std::vector<std::shared_ptr<DataHandler>> InputsGenerator::RunInputs(
 std::vector<std::shared_ptr<PartitionHandler>>
 WindowUnionGenerator::PartitionEach(
     std::vector<std::shared_ptr<DataHandler>> union_inputs,
-    const Row& parameter) {
+    const Row& parameter, const std::shared_ptr<MemoryTracker>& tracker) {
     std::vector<std::shared_ptr<PartitionHandler>> union_partitions;
     if (!windows_gen_.empty()) {
         union_partitions.reserve(windows_gen_.size());
         for (size_t i = 0; i < inputs_cnt_; i++) {
             union_partitions.push_back(
-                windows_gen_[i].partition_gen_.Partition(union_inputs[i], parameter));
+                windows_gen_[i].partition_gen_.Partition(union_inputs[i], parameter, tracker));
         }
     }
     return union_partitions;
@@ -4009,6 +4741,7 @@ std::shared_ptr<DataHandler> FilterGenerator::Filter(
 
 std::shared_ptr<DataHandlerList> RunnerContext::GetBatchCache(
     int64_t id) const {
+    std::lock_guard<std::mutex> lock(cache_mu_);
     auto iter = batch_cache_.find(id);
     if (iter == batch_cache_.end()) {
         return std::shared_ptr<DataHandlerList>();
@@ -4019,10 +4752,12 @@ std::shared_ptr<DataHandlerList> RunnerContext::GetBatchCache(
 
 void RunnerContext::SetBatchCache(int64_t id,
                                   std::shared_ptr<DataHandlerList> data) {
+    std::lock_guard<std::mutex> lock(cache_mu_);
     batch_cache_[id] = data;
 }
 
 std::shared_ptr<DataHandler> RunnerContext::GetCache(int64_t id) const {
+    std::lock_guard<std::mutex> lock(cache_mu_);
     auto iter = cache_.find(id);
     if (iter == cache_.end()) {
         return std::shared_ptr<DataHandler>();
@@ -4033,9 +4768,27 @@ std::shared_ptr<DataHandler> RunnerContext::GetCache(int64_t id) const {
 
 void RunnerContext::SetCache(int64_t id,
                              const std::shared_ptr<DataHandler> data) {
+    std::lock_guard<std::mutex> lock(cache_mu_);
     cache_[id] = data;
 }
 
+std::shared_ptr<MemoryTracker> RunnerContext::GetRunnerMemoryTracker(int32_t runner_id) {
+    if (!memory_tracker_) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(cache_mu_);
+    auto& tracker = runner_memory_trackers_[runner_id];
+    if (!tracker) {
+        tracker = MemoryTracker::Create("runner " + std::to_string(runner_id), -1, memory_tracker_);
+    }
+    return tracker;
+}
+
+std::map<int32_t, std::shared_ptr<MemoryTracker>> RunnerContext::GetRunnerMemoryTrackers() const {
+    std::lock_guard<std::mutex> lock(cache_mu_);
+    return runner_memory_trackers_;
+}
+
 void RunnerContext::SetRequest(const hybridse::codec::Row& request) {
     request_ = request;
 }
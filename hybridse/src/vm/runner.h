@@ -19,6 +19,7 @@
 
 #include <map>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -31,8 +32,14 @@
 #include "vm/catalog.h"
 #include "vm/catalog_wrapper.h"
 #include "vm/core_api.h"
+#include "vm/engine_context.h"
+#include "vm/external_sort.h"
 #include "vm/mem_catalog.h"
+#include "vm/memory_tracker.h"
 #include "vm/physical_op.h"
+#include "vm/result_cache.h"
+#include "vm/runner_profile.h"
+#include "vm/subplan_executor.h"
 namespace hybridse {
 namespace vm {
 
@@ -80,7 +87,8 @@ class ProjectGenerator : public FnGenerator {
     explicit ProjectGenerator(const FnInfo& info)
         : FnGenerator(info), fun_(info.fn_ptr()) {}
     virtual ~ProjectGenerator() {}
-    const Row Gen(const Row& row, const Row& parameter);
+    // the generators charge the JIT arena of `fn_` to `tracker` if not null
+    const Row Gen(const Row& row, const Row& parameter, const std::shared_ptr<MemoryTracker>& tracker = nullptr);
     RowProjectFun fun_;
 };
 
@@ -89,14 +97,15 @@ class ConstProjectGenerator : public FnGenerator {
     explicit ConstProjectGenerator(const FnInfo& info)
         : FnGenerator(info), fun_(info.fn_ptr()) {}
     virtual ~ConstProjectGenerator() {}
-    const Row Gen(const Row& parameter);
+    const Row Gen(const Row& parameter, const std::shared_ptr<MemoryTracker>& tracker = nullptr);
     RowProjectFun fun_;
 };
 class AggGenerator : public FnGenerator {
  public:
     explicit AggGenerator(const FnInfo& info) : FnGenerator(info) {}
     virtual ~AggGenerator() {}
-    const Row Gen(const codec::Row& parameter_row, std::shared_ptr<TableHandler> table);
+    const Row Gen(const codec::Row& parameter_row, std::shared_ptr<TableHandler> table,
+                  const std::shared_ptr<MemoryTracker>& tracker = nullptr);
 };
 class WindowProjectGenerator : public FnGenerator {
  public:
@@ -109,21 +118,32 @@ class KeyGenerator : public FnGenerator {
  public:
     explicit KeyGenerator(const FnInfo& info) : FnGenerator(info) {}
     virtual ~KeyGenerator() {}
-    const std::string Gen(const Row& row, const Row& parameter);
-    const std::string GenConst(const Row& parameter);
+    const std::string Gen(const Row& row, const Row& parameter,
+                          const std::shared_ptr<MemoryTracker>& tracker = nullptr);
+    // each part is prefixed by its size instead of joined by '|', so different key tuples
+    // like ("a|b", "c") and ("a", "b|c") never get the same key
+    const std::string GenUnique(const Row& row, const Row& parameter,
+                                const std::shared_ptr<MemoryTracker>& tracker = nullptr);
+    const std::string GenConst(const Row& parameter, const std::shared_ptr<MemoryTracker>& tracker = nullptr);
+
+ private:
+    const std::string Gen(const Row& row, const Row& parameter, bool size_prefixed,
+                          const std::shared_ptr<MemoryTracker>& tracker);
+    void AppendKey(const Row& key_row, int32_t pos, std::string* keys);
 };
 class OrderGenerator : public FnGenerator {
  public:
     explicit OrderGenerator(const FnInfo& info) : FnGenerator(info) {}
     virtual ~OrderGenerator() {}
-    const int64_t Gen(const Row& row);
+    const int64_t Gen(const Row& row, const std::shared_ptr<MemoryTracker>& tracker = nullptr);
 };
 class ConditionGenerator : public FnGenerator {
  public:
     explicit ConditionGenerator(const FnInfo& info) : FnGenerator(info) {}
     virtual ~ConditionGenerator() {}
-    const bool Gen(const Row& row, const Row& parameter) const;
-    const bool Gen(std::shared_ptr<TableHandler> table, const codec::Row& parameter_row);
+    const bool Gen(const Row& row, const Row& parameter, const std::shared_ptr<MemoryTracker>& tracker = nullptr) const;
+    const bool Gen(std::shared_ptr<TableHandler> table, const codec::Row& parameter_row,
+                   const std::shared_ptr<MemoryTracker>& tracker = nullptr);
 };
 class RangeGenerator {
  public:
@@ -201,12 +221,17 @@ class PartitionGenerator {
     virtual ~PartitionGenerator() {}
 
     const bool Valid() const { return key_gen_.Valid(); }
+    // the output partitions charge their rows to `tracker` if not null, and the
+    // partition fails once the tracker exceeds its limit
     std::shared_ptr<PartitionHandler> Partition(
-        std::shared_ptr<DataHandler> input, const Row& parameter);
+        std::shared_ptr<DataHandler> input, const Row& parameter,
+        const std::shared_ptr<MemoryTracker>& tracker = nullptr);
     std::shared_ptr<PartitionHandler> Partition(
-        std::shared_ptr<PartitionHandler> table, const Row& parameter);
+        std::shared_ptr<PartitionHandler> table, const Row& parameter,
+        const std::shared_ptr<MemoryTracker>& tracker = nullptr);
     std::shared_ptr<PartitionHandler> Partition(
-        std::shared_ptr<TableHandler> table, const Row& parameter);
+        std::shared_ptr<TableHandler> table, const Row& parameter,
+        const std::shared_ptr<MemoryTracker>& tracker = nullptr);
     const std::string GetKey(const Row& row, const Row& parameter) { return key_gen_.Gen(row, parameter); }
 
  private:
@@ -222,14 +247,24 @@ class SortGenerator {
 
     const bool Valid() const { return is_valid_; }
 
+    // the sorted outputs charge their rows to `tracker` if not null
     std::shared_ptr<DataHandler> Sort(std::shared_ptr<DataHandler> input,
-                                      const bool reverse = false);
+                                      const bool reverse = false,
+                                      const std::shared_ptr<MemoryTracker>& tracker = nullptr);
     std::shared_ptr<PartitionHandler> Sort(
         std::shared_ptr<PartitionHandler> partition,
-        const bool reverse = false);
+        const bool reverse = false,
+        const std::shared_ptr<MemoryTracker>& tracker = nullptr);
     std::shared_ptr<TableHandler> Sort(std::shared_ptr<TableHandler> table,
-                                       const bool reverse = false);
+                                       const bool reverse = false,
+                                       const std::shared_ptr<MemoryTracker>& tracker = nullptr);
     const OrderGenerator& order_gen() const { return order_gen_; }
+    // the order of a segment of `input_order` sorted by Sort, kNoneOrder if Sort keeps it
+    OrderType SortedOrder(OrderType input_order, const bool reverse = false) const;
+    // the key of the row in a segment sorted by Sort
+    uint64_t SortedKey(const Row& row, uint64_t input_key) {
+        return order_gen_.Valid() ? static_cast<uint64_t>(order_gen_.Gen(row)) : input_key;
+    }
 
  private:
     bool is_valid_;
@@ -287,6 +322,11 @@ class WindowGenerator {
     const int64_t OrderKey(const Row& row) {
         return range_gen_.ts_gen_.Gen(row);
     }
+    // partition the table and sort the segments as Partition and Sort do, with an
+    // external sorter spilling to disk under the options and charging `tracker`
+    std::unique_ptr<SortedRowStream> PartitionAndSort(std::shared_ptr<TableHandler> table, const Row& parameter,
+                                                      const SpillOptions& options,
+                                                      const std::shared_ptr<MemoryTracker>& tracker);
     const WindowOp window_op_;
     PartitionGenerator partition_gen_;
     SortGenerator sort_gen_;
@@ -315,6 +355,15 @@ class RequestWindowGenertor {
         }
         return segment;
     }
+    // rows with the same key get the same window segment from GetRequestWindow
+    const std::string GetRequestWindowKey(const Row& row, const Row& parameter) {
+        std::string index_key;
+        if (index_seek_gen_.Valid()) {
+            index_key = index_seek_gen_.index_key_gen_.GenUnique(row, parameter);
+        }
+        std::string filter_key = filter_gen_.Valid() ? filter_gen_.filter_key_.GenUnique(row, parameter) : "";
+        return std::to_string(index_key.size()).append(1, ':').append(index_key).append(filter_key);
+    }
     RequestWindowOp window_op_;
     FilterKeyGenerator filter_gen_;
     SortGenerator sort_gen_;
@@ -348,6 +397,7 @@ enum RunnerType {
     kRunnerRequestLastJoin,
     kRunnerBatchRequestRunProxy,
     kRunnerLimit,
+    kRunnerPipeline,
     kRunnerUnknow,
 };
 inline const std::string RunnerTypeName(const RunnerType& type) {
@@ -396,6 +446,8 @@ inline const std::string RunnerTypeName(const RunnerType& type) {
             return "REQUEST_LASTJOIN";
         case kRunnerLimit:
             return "LIMIT";
+        case kRunnerPipeline:
+            return "PIPELINE";
         case kRunnerRequestRunProxy:
             return "REQUEST_RUN_PROXY";
         case kRunnerBatchRequestRunProxy:
@@ -481,6 +533,29 @@ class Runner : public node::NodeBase<Runner> {
     void DisableCache() { need_cache_ = false; }
     void EnableBatchCache() { need_batch_cache_ = true; }
     void DisableBatchCache() { need_batch_cache_ = false; }
+    // run the producers with the subplan executor of the context, the shared runners
+    // are reachable from more than one producer and run before the producers
+    void EnableParallelProducers(const std::vector<Runner*>& shared_runners) {
+        parallel_producers_ = true;
+        shared_runners_ = shared_runners;
+    }
+    const bool parallel_producers() const { return parallel_producers_; }
+    // the result of a prefetch runner is issued before the main task and cached, only if
+    // the context runs the subplans in parallel
+    void EnablePrefetch() { prefetch_ = true; }
+    const bool prefetch() const { return prefetch_; }
+
+    // a pipeline step maps the row of its first producer to one row, the other
+    // producers are side inputs, see PipelineRunner
+    virtual bool IsPipelineStep() const { return false; }
+    // run the step on row, inputs[0] is unused and the rest are the outputs of
+    // the side producers. return false if the step fails
+    virtual bool RunPipelineStep(RunnerContext& ctx,  // NOLINT
+                                 const Row& row,
+                                 const std::vector<std::shared_ptr<DataHandler>>& inputs,
+                                 Row* output) {
+        return false;
+    }
 
     const int32_t id_;
     const RunnerType type_;
@@ -505,7 +580,8 @@ class Runner : public node::NodeBase<Runner> {
                              const Row row, const Row& parameter,
                              const bool is_instance,
                              size_t append_slices, Window* window);
-    static Row GroupbyProject(const int8_t* fn, const Row& parameter, TableHandler* table);
+    static Row GroupbyProject(const int8_t* fn, const Row& parameter, TableHandler* table,
+                              const std::shared_ptr<MemoryTracker>& tracker = nullptr);
     static const Row RowLastJoinTable(size_t left_slices, const Row& left_row,
                                       size_t right_slices,
                                       std::shared_ptr<TableHandler> right_table,
@@ -565,6 +641,16 @@ class Runner : public node::NodeBase<Runner> {
     std::vector<Runner*> producers_;
     const vm::SchemasContext* output_schemas_;
     std::unique_ptr<RowParser> row_parser_ = nullptr;
+    bool parallel_producers_ = false;
+    std::vector<Runner*> shared_runners_;
+    bool prefetch_ = false;
+
+ private:
+    // whether the result of the runner is cached in the context
+    bool NeedCache(const RunnerContext& ctx) const;
+    // return false if the producers can not run in parallel in the context
+    bool RunProducersInParallel(RunnerContext& ctx,  // NOLINT
+                                std::vector<std::shared_ptr<DataHandler>>* inputs);
 };
 
 class IteratorStatus {
@@ -615,7 +701,7 @@ class WindowUnionGenerator : public InputsGenerator {
     virtual ~WindowUnionGenerator() {}
     std::vector<std::shared_ptr<PartitionHandler>> PartitionEach(
         std::vector<std::shared_ptr<DataHandler>> union_inputs,
-        const Row& parameter);
+        const Row& parameter, const std::shared_ptr<MemoryTracker>& tracker = nullptr);
     void AddWindowUnion(const WindowOp& window_op, Runner* runner) {
         windows_gen_.push_back(WindowGenerator(window_op));
         AddInput(runner);
@@ -646,6 +732,16 @@ class RequestWindowUnionGenerator : public InputsGenerator {
         }
         return union_segments;
     }
+    // the key of all the union windows, rows of a batch request with the same key share
+    // the segments of GetRequestWindows
+    const std::string GetRequestWindowsKey(const Row& row, const Row& parameter) {
+        std::string key;
+        for (auto& window_gen : windows_gen_) {
+            std::string window_key = window_gen.GetRequestWindowKey(row, parameter);
+            key.append(std::to_string(window_key.size())).append(1, ':').append(window_key);
+        }
+        return key;
+    }
     std::vector<RequestWindowGenertor> windows_gen_;
 };
 class JoinGenerator {
@@ -677,6 +773,14 @@ class JoinGenerator {
 
     Row RowLastJoin(const Row& left_row, std::shared_ptr<DataHandler> right, const Row& parameter);
     Row RowLastJoinDropLeftSlices(const Row& left_row, std::shared_ptr<DataHandler> right, const Row& parameter);
+    // generate the key of last join result in `key` and the write version of the right data
+    // in `version`, return false if the result does not depend on the key only (e.g. right is a
+    // request row or join condition exists) or the version is unknown
+    bool GetResultCacheKey(const Row& left_row, std::shared_ptr<DataHandler> right, const Row& parameter,
+                           std::string* key, uint64_t* version);
+    Row JoinRight(const Row& left_row, const Row& right_row) const {
+        return Row(left_slices_, left_row, right_slices_, right_row);
+    }
     ConditionGenerator condition_gen_;
     KeyGenerator left_key_gen_;
     PartitionGenerator right_group_gen_;
@@ -812,6 +916,9 @@ class RowProjectRunner : public Runner {
         RunnerContext& ctx,  // NOLINT
         const std::vector<std::shared_ptr<DataHandler>>& inputs)
         override;  // NOLINT
+    bool IsPipelineStep() const override { return true; }
+    bool RunPipelineStep(RunnerContext& ctx, const Row& row,  // NOLINT
+                         const std::vector<std::shared_ptr<DataHandler>>& inputs, Row* output) override;
     ProjectGenerator project_gen_;
 };
 
@@ -835,6 +942,9 @@ class SimpleProjectRunner : public Runner {
         RunnerContext& ctx,  // NOLINT
         const std::vector<std::shared_ptr<DataHandler>>& inputs)
         override;  // NOLINT
+    bool IsPipelineStep() const override { return true; }
+    bool RunPipelineStep(RunnerContext& ctx, const Row& row,  // NOLINT
+                         const std::vector<std::shared_ptr<DataHandler>>& inputs, Row* output) override;
     ProjectGenerator project_gen_;
 };
 
@@ -850,6 +960,9 @@ class SelectSliceRunner : public Runner {
     std::shared_ptr<DataHandler> Run(
         RunnerContext& ctx,  // NOLINT
         const std::vector<std::shared_ptr<DataHandler>>& inputs) override;
+    bool IsPipelineStep() const override { return true; }
+    bool RunPipelineStep(RunnerContext& ctx, const Row& row,  // NOLINT
+                         const std::vector<std::shared_ptr<DataHandler>>& inputs, Row* output) override;
 
     size_t slice() const { return get_slice_fn_.slice_; }
 
@@ -874,9 +987,19 @@ class GroupAggRunner : public Runner {
         RunnerContext& ctx,  // NOLINT
         const std::vector<std::shared_ptr<DataHandler>>& inputs)
         override;  // NOLINT
+    // group the input with an external sorter spilling to disk, set by the runner builder
+    // when the aggregation takes the input of the group runner in its place
+    void SetSpillGroup(const SpillOptions& options, const Key& group) {
+        spill_options_ = options;
+        spill_group_gen_ = std::make_unique<PartitionGenerator>(group);
+    }
+    std::shared_ptr<DataHandler> RunWithSpill(const Row& parameter, std::shared_ptr<TableHandler> table,
+                                              const std::shared_ptr<MemoryTracker>& tracker);
     KeyGenerator group_;
     ConditionGenerator having_condition_;
     AggGenerator agg_gen_;
+    SpillOptions spill_options_;
+    std::unique_ptr<PartitionGenerator> spill_group_gen_;
 };
 class AggRunner : public Runner {
  public:
@@ -933,16 +1056,31 @@ class WindowAggRunner : public Runner {
     void AddWindowUnion(const WindowOp& window, Runner* runner) {
         windows_union_gen_.AddWindowUnion(window, runner);
     }
+    void SetSpillOptions(const SpillOptions& options) { spill_options_ = options; }
     std::shared_ptr<DataHandler> Run(
         RunnerContext& ctx,  // NOLINT
         const std::vector<std::shared_ptr<DataHandler>>& inputs)
         override;  // NOLINT
+    std::shared_ptr<DataHandler> RunWithSpill(RunnerContext& ctx,  // NOLINT
+                                              std::shared_ptr<TableHandler> input);
     void RunWindowAggOnKey(
         const Row& parameter,
         std::shared_ptr<PartitionHandler> instance_partition,
         std::vector<std::shared_ptr<PartitionHandler>> union_partitions,
         std::vector<std::shared_ptr<DataHandler>> joins, const std::string& key,
-        std::shared_ptr<MemTableHandler> output_table);
+        std::shared_ptr<MemTableHandler> output_table,
+        const std::shared_ptr<MemoryTracker>& tracker);
+    // the window charges its rows to `tracker`, and stops once the tracker exceeds its limit
+    void RunWindowAggOnIterators(const Row& parameter, RowIterator* instance_segment_iter,
+                                 const std::vector<std::unique_ptr<RowIterator>>& union_segment_iters,
+                                 const std::vector<std::shared_ptr<DataHandler>>& joins,
+                                 std::shared_ptr<MemTableHandler> output_table,
+                                 const std::shared_ptr<MemoryTracker>& tracker);
+    // the sorted segment of key of the union partition, held by `segment`
+    std::unique_ptr<RowIterator> GetUnionSegmentIterator(size_t idx, std::shared_ptr<PartitionHandler> union_partition,
+                                                         const std::string& key,
+                                                         std::shared_ptr<TableHandler>* segment,
+                                                         const std::shared_ptr<MemoryTracker>& tracker);
 
     const bool instance_not_in_window_;
     const bool exclude_current_time_;
@@ -952,6 +1090,7 @@ class WindowAggRunner : public Runner {
     WindowUnionGenerator windows_union_gen_;
     WindowJoinGenerator windows_join_gen_;
     WindowProjectGenerator window_project_gen_;
+    SpillOptions spill_options_;
 };
 
 class RequestUnionRunner : public Runner {
@@ -968,11 +1107,16 @@ class RequestUnionRunner : public Runner {
         RunnerContext& ctx,  // NOLINT
         const std::vector<std::shared_ptr<DataHandler>>& inputs)
         override;  // NOLINT
+    // rows of the batch sharing the window keys fetch the union segments once
+    std::shared_ptr<DataHandlerList> BatchRequestRun(
+        RunnerContext& ctx) override;  // NOLINT
+    // the window charges its rows to `tracker` if not null
     static std::shared_ptr<TableHandler> RequestUnionWindow(
         const Row& request,
         std::vector<std::shared_ptr<TableHandler>> union_segments,
         int64_t request_ts, const WindowRange& window_range,
-        const bool output_request_row, const bool exclude_current_time);
+        const bool output_request_row, const bool exclude_current_time,
+        const std::shared_ptr<MemoryTracker>& tracker = nullptr);
     void AddWindowUnion(const RequestWindowOp& window, Runner* runner) {
         windows_union_gen_.AddWindowUnion(window, runner);
     }
@@ -1016,11 +1160,13 @@ class RequestAggUnionRunner : public Runner {
         kCount,
         kAvg,
         kMin,
-        kMax
+        kMax,
+        kApproxDistinctCount
     };
 
     static inline const std::unordered_map<std::string, AggType> agg_type_map_ = {
         {"sum", kSum}, {"count", kCount}, {"avg", kAvg}, {"min", kMin}, {"max", kMax},
+        {"approx_distinct_count", kApproxDistinctCount},
     };
 
     RequestWindowUnionGenerator windows_union_gen_;
@@ -1078,6 +1224,9 @@ class RequestLastJoinRunner : public Runner {
     std::shared_ptr<DataHandler> Run(
         RunnerContext& ctx,                                        // NOLINT
         const std::vector<std::shared_ptr<DataHandler>>& inputs);  // NOLINT
+    virtual bool IsPipelineStep() const { return true; }
+    virtual bool RunPipelineStep(RunnerContext& ctx, const Row& row,  // NOLINT
+                                 const std::vector<std::shared_ptr<DataHandler>>& inputs, Row* output);
     virtual void PrintRunnerInfo(std::ostream& output,
                                  const std::string& tab) const {
         output << tab << "[" << id_ << "]" << RunnerTypeName(type_);
@@ -1090,6 +1239,11 @@ class RequestLastJoinRunner : public Runner {
     }
     JoinGenerator join_gen_;
     const bool output_right_only_;
+
+ private:
+    // join the right input to left_row, return false if the right input is missing
+    bool JoinRow(RunnerContext& ctx, const Row& left_row,  // NOLINT
+                 std::shared_ptr<DataHandler> right, Row* output);
 };
 class ConcatRunner : public Runner {
  public:
@@ -1103,6 +1257,40 @@ class ConcatRunner : public Runner {
         RunnerContext& ctx,  // NOLINT
         const std::vector<std::shared_ptr<DataHandler>>& inputs)
         override;  // NOLINT
+    bool IsPipelineStep() const override { return true; }
+    bool RunPipelineStep(RunnerContext& ctx, const Row& row,  // NOLINT
+                         const std::vector<std::shared_ptr<DataHandler>>& inputs, Row* output) override;
+};
+
+// PipelineRunner runs a chain of pipeline steps in request mode on the request
+// row. The row flows through the steps without the lazy row wrappers and the
+// memory row handlers of the intermediate runners, and the side inputs of all
+// the steps are the producers of the pipeline, so they are evaluated like the
+// producers of any other runner. The steps are kept out of the runner graph
+// and run as a whole when the head input is not a row.
+class PipelineRunner : public Runner {
+ public:
+    // steps are in the order of execution, the first producer of steps[0] is
+    // the head input of the pipeline
+    PipelineRunner(const int32_t id, const std::vector<Runner*>& steps);
+    ~PipelineRunner() {}
+    std::shared_ptr<DataHandler> Run(
+        RunnerContext& ctx,  // NOLINT
+        const std::vector<std::shared_ptr<DataHandler>>& inputs)
+        override;  // NOLINT
+    void PrintRunnerInfo(std::ostream& output,
+                         const std::string& tab) const override;
+    const std::vector<Runner*>& steps() const { return steps_; }
+
+ private:
+    // fill the inputs of the idx-th step, the first one is main
+    void StepInputs(size_t idx, std::shared_ptr<DataHandler> main,
+                    const std::vector<std::shared_ptr<DataHandler>>& inputs,
+                    std::vector<std::shared_ptr<DataHandler>>* step_inputs) const;
+
+    std::vector<Runner*> steps_;
+    // offset of the side inputs of each step in the producers
+    std::vector<size_t> side_input_offsets_;
 };
 class LimitRunner : public Runner {
  public:
@@ -1131,6 +1319,7 @@ class ProxyRequestRunner : public Runner {
         is_lazy_ = true;
     }
     ~ProxyRequestRunner() {}
+    Runner* index_input() const { return index_input_; }
     std::shared_ptr<DataHandler> Run(
         RunnerContext& ctx,  // NOLINT
         const std::vector<std::shared_ptr<DataHandler>>& inputs) override;
@@ -1395,7 +1584,21 @@ class ClusterJob {
     }
 
     void AddMainTask(const ClusterTask& task) { main_task_id_ = AddTask(task); }
-    void Reset() { tasks_.clear(); }
+    void ReplaceTaskRoot(Runner* old_root, Runner* new_root) {
+        for (auto& task : tasks_) {
+            if (old_root == task.GetRoot()) {
+                task.SetRoot(new_root);
+            }
+        }
+    }
+    void Reset() {
+        tasks_.clear();
+        prefetch_runners_.clear();
+    }
+    // proxy runners of the request row only, their sub-queries can be issued before
+    // the main task runs
+    void AddPrefetchRunner(Runner* runner) { prefetch_runners_.push_back(runner); }
+    const std::vector<Runner*>& prefetch_runners() const { return prefetch_runners_; }
     const size_t GetTaskSize() const { return tasks_.size(); }
     const bool IsValid() const { return !tasks_.empty(); }
     const int32_t main_task_id() const { return main_task_id_; }
@@ -1427,6 +1630,7 @@ class ClusterJob {
     std::string sql_;
     std::string db_;
     std::set<size_t> common_column_indices_;
+    std::vector<Runner*> prefetch_runners_;
 };
 class RunnerBuilder {
     enum TaskBiasType { kLeftBias, kRightBias, kNoBias };
@@ -1484,9 +1688,24 @@ class RunnerBuilder {
         } else {
             cluster_job_.AddMainTask(task);
         }
+        if (enable_request_pipeline_) {
+            FuseRequestPipelines();
+        }
+        PlanParallelProducers();
         return cluster_job_;
     }
 
+    // fuse the chains of pipeline steps into PipelineRunners, request mode only
+    void SetEnableRequestPipeline(bool flag) { enable_request_pipeline_ = flag; }
+    void FuseRequestPipelines();
+
+    // let the window and group aggregations spill to disk, batch mode only
+    void SetSpillOptions(const SpillOptions& options) { spill_options_ = options; }
+
+    // enable parallel producers of the runners with more than one producer
+    // accessing data and collect the proxy runners to prefetch
+    void PlanParallelProducers();
+
     template <typename Op, typename... Args>
     void CreateRunner(Op** result_runner, Args&&... args) {
         Op* runner = new Op(std::forward<Args>(args)...);
@@ -1496,6 +1715,8 @@ class RunnerBuilder {
  private:
     node::NodeManager* nm_;
     bool support_cluster_optimized_;
+    bool enable_request_pipeline_ = false;
+    SpillOptions spill_options_;
     int32_t id_;
     ClusterJob cluster_job_;
 
@@ -1575,11 +1796,31 @@ class RunnerContext {
     void SetRequest(const hybridse::codec::Row& request);
     void SetRequests(const std::vector<hybridse::codec::Row>& requests);
     bool is_debug() const { return is_debug_; }
+    // profile of runners, null if profiling is disabled
+    RunnerProfile* profile() const { return profile_; }
+    void SetProfile(RunnerProfile* profile) { profile_ = profile; }
+    // cross-request result cache of the deployment, null if not enabled
+    SubplanResultCache* result_cache() const { return result_cache_; }
+    void SetResultCache(SubplanResultCache* result_cache) { result_cache_ = result_cache; }
+    // executor of independent subplans, null if subplans run on the calling thread
+    SubplanExecutor* subplan_executor() const { return subplan_executor_; }
+    void SetSubplanExecutor(SubplanExecutor* executor) { subplan_executor_ = executor; }
+    // memory tracker of the query, null if memory is not tracked
+    const std::shared_ptr<MemoryTracker>& memory_tracker() const { return memory_tracker_; }
+    void SetMemoryTracker(const std::shared_ptr<MemoryTracker>& tracker) { memory_tracker_ = tracker; }
+    // the tracker of a runner under the query tracker, null if memory is not tracked
+    std::shared_ptr<MemoryTracker> GetRunnerMemoryTracker(int32_t runner_id);
+    std::map<int32_t, std::shared_ptr<MemoryTracker>> GetRunnerMemoryTrackers() const;
+    // true if the query exceeds its memory limit, or makes the process exceed its limit
+    bool MemoryLimitExceeded() const { return memory_tracker_ && memory_tracker_->LimitExceeded(); }
 
     const std::string& sp_name() { return sp_name_; }
     std::shared_ptr<DataHandler> GetCache(int64_t id) const;
     void SetCache(int64_t id, std::shared_ptr<DataHandler> data);
-    void ClearCache() { cache_.clear(); }
+    void ClearCache() {
+        std::lock_guard<std::mutex> lock(cache_mu_);
+        cache_.clear();
+    }
     std::shared_ptr<DataHandlerList> GetBatchCache(int64_t id) const;
     void SetBatchCache(int64_t id, std::shared_ptr<DataHandlerList> data);
 
@@ -1591,6 +1832,13 @@ class RunnerContext {
     hybridse::codec::Row parameter_;
     size_t idx_;
     const bool is_debug_;
+    RunnerProfile* profile_ = nullptr;
+    SubplanResultCache* result_cache_ = nullptr;
+    SubplanExecutor* subplan_executor_ = nullptr;
+    std::shared_ptr<MemoryTracker> memory_tracker_;
+    // guard the caches and the runner trackers, runners of a request may run in parallel
+    mutable std::mutex cache_mu_;
+    std::map<int32_t, std::shared_ptr<MemoryTracker>> runner_memory_trackers_;
     // TODO(chenjing): optimize
     std::map<int64_t, std::shared_ptr<DataHandler>> cache_;
     std::map<int64_t, std::shared_ptr<DataHandlerList>> batch_cache_;
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/runner_profile.h"
+
+#include <time.h>
+
+#include <iomanip>
+#include <set>
+#include <sstream>
+
+namespace hybridse {
+namespace vm {
+
+static void PrintStat(std::ostream& output, const RunnerStat& stat) {
+    output << "(calls=" << stat.calls;
+    if (stat.cache_hits > 0) {
+        output << " cache_hits=" << stat.cache_hits;
+    }
+    uint64_t result_cache_cnt = stat.result_cache_hits + stat.result_cache_misses;
+    if (result_cache_cnt > 0) {
+        output << " result_cache_hits=" << stat.result_cache_hits << "/" << result_cache_cnt;
+    }
+    output << std::fixed << std::setprecision(3) << " wall=" << stat.wall_ns / 1000000.0
+           << "ms cpu=" << stat.cpu_ns / 1000000.0 << "ms";
+    if (stat.peak_memory_bytes > 0) {
+        output << " peak_mem=" << stat.peak_memory_bytes / 1024.0 << "KB";
+    }
+    output << ")";
+}
+
+void RunnerProfile::Record(int32_t runner_id, uint64_t wall_ns, uint64_t cpu_ns) {
+    auto& stat = stats_[runner_id];
+    stat.calls++;
+    stat.wall_ns += wall_ns;
+    stat.cpu_ns += cpu_ns;
+}
+
+void RunnerProfile::RecordCacheHit(int32_t runner_id) { stats_[runner_id].cache_hits++; }
+
+void RunnerProfile::RecordResultCache(int32_t runner_id, bool hit) {
+    auto& stat = stats_[runner_id];
+    if (hit) {
+        stat.result_cache_hits++;
+    } else {
+        stat.result_cache_misses++;
+    }
+}
+
+void RunnerProfile::RecordPeakMemory(int32_t runner_id, int64_t bytes) {
+    auto& stat = stats_[runner_id];
+    stat.peak_memory_bytes = std::max(stat.peak_memory_bytes, bytes);
+}
+
+void RunnerProfile::RecordTotalPeakMemory(int64_t bytes) {
+    total_.peak_memory_bytes = std::max(total_.peak_memory_bytes, bytes);
+}
+
+void RunnerProfile::RecordTotal(uint64_t wall_ns, uint64_t cpu_ns) {
+    total_.calls++;
+    total_.wall_ns += wall_ns;
+    total_.cpu_ns += cpu_ns;
+}
+
+void RunnerProfile::Merge(const RunnerProfile& other) {
+    if (plan_.empty()) {
+        plan_ = other.plan_;
+    }
+    for (auto& kv : other.stats_) {
+        stats_[kv.first].Merge(kv.second);
+    }
+    total_.Merge(other.total_);
+}
+
+std::string RunnerProfile::ToString() const {
+    std::ostringstream output;
+    output << "TOTAL ";
+    PrintStat(output, total_);
+    output << "\n";
+    std::set<int32_t> printed;
+    for (auto& line : plan_) {
+        output << line.second << " ";
+        auto it = stats_.find(line.first);
+        PrintStat(output, it == stats_.end() ? RunnerStat() : it->second);
+        output << "\n";
+        printed.insert(line.first);
+    }
+    // runners which are not in the producer tree, e.g. index input of proxy runner
+    for (auto& kv : stats_) {
+        if (printed.find(kv.first) == printed.end()) {
+            output << "[" << kv.first << "] ";
+            PrintStat(output, kv.second);
+            output << "\n";
+        }
+    }
+    return output.str();
+}
+
+RunnerProfileGuard::RunnerProfileGuard(RunnerProfile* profile, int32_t runner_id)
+    : profile_(profile), runner_id_(runner_id) {
+    if (nullptr == profile_) {
+        return;
+    }
+    saved_nested_wall_ns_ = profile_->nested_wall_ns_;
+    saved_nested_cpu_ns_ = profile_->nested_cpu_ns_;
+    profile_->nested_wall_ns_ = 0;
+    profile_->nested_cpu_ns_ = 0;
+    start_wall_ns_ = WallNs();
+    start_cpu_ns_ = ThreadCpuNs();
+}
+
+RunnerProfileGuard::~RunnerProfileGuard() {
+    if (nullptr == profile_) {
+        return;
+    }
+    uint64_t wall_ns = WallNs() - start_wall_ns_;
+    uint64_t cpu_ns = ThreadCpuNs() - start_cpu_ns_;
+    // cpu time of a thread may be a little less precise than wall time, avoid underflow
+    uint64_t self_wall_ns = wall_ns > profile_->nested_wall_ns_ ? wall_ns - profile_->nested_wall_ns_ : 0;
+    uint64_t self_cpu_ns = cpu_ns > profile_->nested_cpu_ns_ ? cpu_ns - profile_->nested_cpu_ns_ : 0;
+    profile_->Record(runner_id_, self_wall_ns, self_cpu_ns);
+    profile_->nested_wall_ns_ = saved_nested_wall_ns_ + wall_ns;
+    profile_->nested_cpu_ns_ = saved_nested_cpu_ns_ + cpu_ns;
+}
+
+uint64_t RunnerProfileGuard::WallNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+uint64_t RunnerProfileGuard::ThreadCpuNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+}  // namespace vm
+}  // namespace hybridse
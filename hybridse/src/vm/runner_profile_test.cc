@@ -0,0 +1,87 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/runner_profile.h"
+
+#include <thread>  // NOLINT
+
+#include "gtest/gtest.h"
+
+namespace hybridse {
+namespace vm {
+
+class RunnerProfileTest : public ::testing::Test {};
+
+TEST_F(RunnerProfileTest, ExclusiveTime) {
+    RunnerProfile profile;
+    {
+        RunnerProfileGuard outer(&profile, 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        {
+            RunnerProfileGuard inner(&profile, 2);
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    }
+    {
+        RunnerProfileGuard null_guard(nullptr, 3);
+    }
+    auto& stats = profile.GetStats();
+    ASSERT_EQ(2u, stats.size());
+    ASSERT_EQ(1u, stats.at(1).calls);
+    ASSERT_EQ(1u, stats.at(2).calls);
+    // the outer runner does not include the time of inner runner
+    ASSERT_GE(stats.at(1).wall_ns, 10000000u);
+    ASSERT_LT(stats.at(1).wall_ns, 20000000u);
+    ASSERT_GE(stats.at(2).wall_ns, 20000000u);
+}
+
+TEST_F(RunnerProfileTest, MergeAndPrint) {
+    RunnerProfile p1;
+    p1.SetPlan({{1, "[1]PROJECT"}, {2, "  [2]DATA"}});
+    p1.Record(1, 100, 50);
+    p1.RecordCacheHit(2);
+    p1.RecordTotal(1000, 500);
+
+    RunnerProfile p2;
+    p2.Record(1, 200, 100);
+    p2.Record(5, 10, 10);
+    p2.RecordResultCache(5, true);
+    p2.RecordResultCache(5, false);
+    p2.RecordTotal(2000, 1000);
+
+    RunnerProfile merged;
+    merged.Merge(p1);
+    merged.Merge(p2);
+    ASSERT_EQ(2u, merged.GetTotal().calls);
+    ASSERT_EQ(3000u, merged.GetTotal().wall_ns);
+    ASSERT_EQ(2u, merged.GetStats().at(1).calls);
+    ASSERT_EQ(300u, merged.GetStats().at(1).wall_ns);
+    ASSERT_EQ(1u, merged.GetStats().at(2).cache_hits);
+
+    std::string output = merged.ToString();
+    ASSERT_NE(std::string::npos, output.find("[1]PROJECT (calls=2 wall=0.000ms cpu=0.000ms)")) << output;
+    ASSERT_NE(std::string::npos, output.find("  [2]DATA (calls=0 cache_hits=1")) << output;
+    // runner out of plan tree is printed as well
+    ASSERT_NE(std::string::npos, output.find("[5] (calls=1 result_cache_hits=1/2")) << output;
+}
+
+}  // namespace vm
+}  // namespace hybridse
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
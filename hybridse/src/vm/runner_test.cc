@@ -14,7 +14,9 @@
  * limitations under the License.
  */
 
+#include <atomic>
 #include <memory>
+#include <thread>  // NOLINT
 #include <utility>
 #include "boost/algorithm/string.hpp"
 #include "case/sql_case.h"
@@ -522,6 +524,87 @@ TEST_F(RunnerTest, RunnerPrintDataMemTimeTableTest) {
         LOG(INFO) << oss.str();
     }
 }
+
+// sleeps and counts the runs
+class SleepRunner : public Runner {
+ public:
+    SleepRunner(int32_t id, RunnerType type, const SchemasContext* schemas_ctx, int64_t sleep_ms)
+        : Runner(id, type, schemas_ctx), sleep_ms_(sleep_ms) {}
+    std::shared_ptr<DataHandler> Run(RunnerContext& ctx,  // NOLINT
+                                     const std::vector<std::shared_ptr<DataHandler>>& inputs) override {
+        std::this_thread::sleep_for(std::chrono::milliseconds(sleep_ms_));
+        calls_++;
+        return std::make_shared<MemTableHandler>();
+    }
+    int64_t sleep_ms_;
+    std::atomic<int> calls_{0};
+};
+
+class ThreadSubplanExecutor : public SubplanExecutor {
+ public:
+    void RunAll(const std::vector<std::function<void()>>& tasks) override {
+        std::vector<std::thread> threads;
+        for (auto& task : tasks) {
+            threads.emplace_back(task);
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+};
+
+TEST_F(RunnerTest, ParallelProducersTest) {
+    SchemasContext schemas_ctx;
+    SleepRunner shared(0, kRunnerRequest, &schemas_ctx, 0);
+    shared.EnableCache();
+    SleepRunner left(1, kRunnerRequestUnion, &schemas_ctx, 100);
+    left.AddProducer(&shared);
+    SleepRunner right(2, kRunnerRequestLastJoin, &schemas_ctx, 100);
+    right.AddProducer(&shared);
+    SleepRunner root(3, kRunnerRowProject, &schemas_ctx, 0);
+    root.AddProducer(&left);
+    root.AddProducer(&right);
+    root.EnableParallelProducers({&shared});
+
+    ThreadSubplanExecutor executor;
+    RunnerContext ctx(nullptr, Row(), "", false);
+    ctx.SetSubplanExecutor(&executor);
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(root.RunWithCache(ctx) != nullptr);
+    auto cost = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    ASSERT_LT(cost.count(), 190);
+    ASSERT_EQ(1, shared.calls_.load());
+    ASSERT_EQ(1, left.calls_.load());
+    ASSERT_EQ(1, right.calls_.load());
+
+    // producers run one by one without executor
+    RunnerContext serial_ctx(nullptr, Row(), "", false);
+    start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(root.RunWithCache(serial_ctx) != nullptr);
+    cost = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    ASSERT_GE(cost.count(), 200);
+    ASSERT_EQ(2, shared.calls_.load());
+}
+
+TEST_F(RunnerTest, PrefetchCacheTest) {
+    SchemasContext schemas_ctx;
+    SleepRunner proxy(0, kRunnerRequestRunProxy, &schemas_ctx, 0);
+    proxy.EnablePrefetch();
+
+    // a prefetched result is cached only when the subplans run in parallel
+    RunnerContext serial_ctx(nullptr, Row(), "", false);
+    proxy.RunWithCache(serial_ctx);
+    proxy.RunWithCache(serial_ctx);
+    ASSERT_EQ(2, proxy.calls_.load());
+    ASSERT_TRUE(serial_ctx.GetCache(proxy.id_) == nullptr);
+
+    ThreadSubplanExecutor executor;
+    RunnerContext ctx(nullptr, Row(), "", false);
+    ctx.SetSubplanExecutor(&executor);
+    proxy.RunWithCache(ctx);
+    proxy.RunWithCache(ctx);
+    ASSERT_EQ(3, proxy.calls_.load());
+}
 }  // namespace vm
 }  // namespace hybridse
 
@@ -308,6 +308,10 @@ bool SqlCompiler::BuildClusterJob(SqlContext& ctx, Status& status) {  // NOLINT
                                  ctx.is_cluster_optimized && is_request_mode,
                                  ctx.batch_request_info.common_column_indices,
                                  ctx.batch_request_info.common_node_set);
+    runner_builder.SetEnableRequestPipeline(ctx.enable_request_pipeline && vm::kRequestMode == ctx.engine_mode);
+    if (vm::kBatchMode == ctx.engine_mode) {
+        runner_builder.SetSpillOptions(ctx.spill_options);
+    }
     ctx.cluster_job = runner_builder.BuildClusterJob(ctx.physical_plan, status);
     return status.isOK();
 }
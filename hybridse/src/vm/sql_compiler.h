@@ -30,6 +30,7 @@
 #include "vm/engine_context.h"
 #include "vm/jit_wrapper.h"
 #include "vm/physical_op.h"
+#include "vm/result_cache.h"
 #include "vm/runner.h"
 
 namespace hybridse {
@@ -45,6 +46,7 @@ struct SqlContext {
     bool enable_expr_optimize = false;
     bool enable_batch_window_parallelization = true;
     bool enable_window_column_pruning = false;
+    bool enable_request_pipeline = false;
 
     // the sql content
     std::string sql;
@@ -57,6 +59,7 @@ struct SqlContext {
     // TODO(wangtaize) add a light jit engine
     // eg using bthead to compile ir
     hybridse::vm::JitOptions jit_options;
+    hybridse::vm::SpillOptions spill_options;
     std::shared_ptr<hybridse::vm::HybridSeJitWrapper> jit = nullptr;
     Schema schema;
     Schema request_schema;
@@ -77,6 +80,9 @@ struct SqlContext {
 
     std::shared_ptr<const std::unordered_map<std::string, std::string>> options;
 
+    // cross-request result cache of subplans, null if not enabled by options
+    std::shared_ptr<hybridse::vm::SubplanResultCache> result_cache = nullptr;
+
     SqlContext() {}
     ~SqlContext() {}
 };
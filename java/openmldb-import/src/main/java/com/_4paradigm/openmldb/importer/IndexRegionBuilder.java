@@ -22,6 +22,7 @@ import org.slf4j.Logger;
 import org.slf4j.LoggerFactory;
 
 import java.util.ArrayList;
+import java.util.Collections;
 import java.util.List;
 import java.util.Map;
 import java.util.TreeMap;
@@ -159,8 +160,9 @@ public class IndexRegionBuilder {
             List<Map<Long, Integer>> entryList = keyEntries.getOrDefault(key, new ArrayList<>());
             if (entryList.isEmpty()) {
                 for (int i = 0; i < tsCnt; i++) {
-                    // !TimeComparator, original TimeComparator is reverse ordered, so here use the default.
-                    entryList.add(new TreeMap<>());
+                    // the same order as TimeComparator(newer first), so the tablet appends the sorted run
+                    // to the key entry without searching.
+                    entryList.add(new TreeMap<>(Collections.reverseOrder()));
                 }
                 keyEntries.put(key, entryList);
             }
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "base/numa.h"
+
+#include <pthread.h>
+
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+#include "base/glog_wapper.h"
+#include "base/strings.h"
+
+namespace openmldb {
+namespace base {
+
+static const char NODE_ROOT_PATH[] = "/sys/devices/system/node/";
+
+static thread_local int32_t thread_numa_node = -1;
+
+static bool ReadLine(const std::string& path, std::string* line) {
+    std::ifstream in(path);
+    if (!in.is_open() || !std::getline(in, *line)) {
+        return false;
+    }
+    return true;
+}
+
+static std::vector<std::string> LoadCpuLists() {
+    std::vector<std::string> cpu_lists;
+    std::string online;
+    std::vector<uint32_t> nodes;
+    if (!ReadLine(std::string(NODE_ROOT_PATH) + "online", &online) || !NumaTopology::ParseCpuList(online, &nodes)) {
+        return cpu_lists;
+    }
+    for (uint32_t node : nodes) {
+        std::string cpu_list;
+        // the ids of online nodes are expected to be continuous from 0
+        if (node != cpu_lists.size() ||
+            !ReadLine(std::string(NODE_ROOT_PATH) + "node" + std::to_string(node) + "/cpulist", &cpu_list)) {
+            PDLOG(WARNING, "fail to read cpus of numa node %u", node);
+            return {};
+        }
+        cpu_lists.push_back(cpu_list);
+    }
+    return cpu_lists;
+}
+
+const NumaTopology& NumaTopology::Instance() {
+    static const NumaTopology topology(LoadCpuLists());
+    return topology;
+}
+
+NumaTopology::NumaTopology(const std::vector<std::string>& cpu_lists) {
+    for (const auto& cpu_list : cpu_lists) {
+        std::vector<uint32_t> cpus;
+        if (!ParseCpuList(cpu_list, &cpus)) {
+            PDLOG(WARNING, "invalid cpu list %s", cpu_list.c_str());
+            cpus_.clear();
+            return;
+        }
+        // a node with memory only is kept, so node ids are the same as the ones of the kernel
+        cpus_.push_back(std::move(cpus));
+    }
+}
+
+bool NumaTopology::ParseCpuList(const std::string& str, std::vector<uint32_t>* cpus) {
+    cpus->clear();
+    std::vector<std::string> ranges;
+    SplitString(str, ",", ranges);
+    for (auto& range : ranges) {
+        range.erase(0, range.find_first_not_of(" \t\n"));
+        range.erase(range.find_last_not_of(" \t\n") + 1);
+        if (range.empty()) {
+            continue;
+        }
+        auto pos = range.find('-');
+        try {
+            uint32_t start = std::stoul(range.substr(0, pos));
+            uint32_t end = pos == std::string::npos ? start : std::stoul(range.substr(pos + 1));
+            if (end < start) {
+                return false;
+            }
+            for (uint32_t cpu = start; cpu <= end; cpu++) {
+                cpus->push_back(cpu);
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool NumaTopology::BindThread(uint32_t node) const {
+    if (node >= cpus_.size() || cpus_[node].empty()) {
+        return false;
+    }
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (uint32_t cpu : cpus_[node]) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &cpu_set);
+        }
+    }
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0) {
+        PDLOG(WARNING, "fail to bind thread to numa node %u", node);
+        return false;
+    }
+    thread_numa_node = node;
+    return true;
+}
+
+int32_t GetThreadNumaNode() { return thread_numa_node; }
+
+NumaNodeScope::NumaNodeScope(const NumaTopology& topology, uint32_t node) : bound_(false), old_node_(-1) {
+    if (pthread_getaffinity_np(pthread_self(), sizeof(old_set_), &old_set_) != 0) {
+        return;
+    }
+    old_node_ = thread_numa_node;
+    bound_ = topology.BindThread(node);
+}
+
+NumaNodeScope::~NumaNodeScope() {
+    if (bound_) {
+        pthread_setaffinity_np(pthread_self(), sizeof(old_set_), &old_set_);
+        thread_numa_node = old_node_;
+    }
+}
+
+}  // namespace base
+}  // namespace openmldb
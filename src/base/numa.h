@@ -0,0 +1,73 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_BASE_NUMA_H_
+#define SRC_BASE_NUMA_H_
+
+#include <sched.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace openmldb {
+namespace base {
+
+// NUMA nodes of the machine and the cpus of each node. Linux places a page on the node of the
+// thread touching it first, so the memory allocated by a thread bound to a node is local to it.
+class NumaTopology {
+ public:
+    // the topology read from /sys/devices/system/node, no node if it's not available
+    static const NumaTopology& Instance();
+
+    // cpu lists of the nodes, e.g. {"0-3,8-11", "4-7,12-15"}
+    explicit NumaTopology(const std::vector<std::string>& cpu_lists);
+
+    inline uint32_t GetNodeCnt() const { return cpus_.size(); }
+    inline const std::vector<uint32_t>& GetCpus(uint32_t node) const { return cpus_[node]; }
+
+    // bind the current thread to the cpus of the node
+    bool BindThread(uint32_t node) const;
+
+    // parse a cpu list like "0-3,8,10-11"
+    static bool ParseCpuList(const std::string& str, std::vector<uint32_t>* cpus);
+
+ private:
+    std::vector<std::vector<uint32_t>> cpus_;
+};
+
+// the node which the current thread is bound to, -1 if it's not bound
+int32_t GetThreadNumaNode();
+
+// bind the current thread to the node in the scope and restore the affinity when it's destroyed
+class NumaNodeScope {
+ public:
+    NumaNodeScope(const NumaTopology& topology, uint32_t node);
+    ~NumaNodeScope();
+
+    NumaNodeScope(const NumaNodeScope&) = delete;
+    NumaNodeScope& operator=(const NumaNodeScope&) = delete;
+
+ private:
+    cpu_set_t old_set_;
+    bool bound_;
+    int32_t old_node_;
+};
+
+}  // namespace base
+}  // namespace openmldb
+
+#endif  // SRC_BASE_NUMA_H_
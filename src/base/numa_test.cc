@@ -0,0 +1,96 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "base/numa.h"
+
+#include <pthread.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "base/taskpool.hpp"
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace base {
+
+class NumaTest : public ::testing::Test {
+ public:
+    NumaTest() {}
+    ~NumaTest() {}
+};
+
+TEST_F(NumaTest, ParseCpuList) {
+    std::vector<uint32_t> cpus;
+    ASSERT_TRUE(NumaTopology::ParseCpuList("0-3,8,10-11\n", &cpus));
+    ASSERT_EQ(std::vector<uint32_t>({0, 1, 2, 3, 8, 10, 11}), cpus);
+    ASSERT_TRUE(NumaTopology::ParseCpuList("", &cpus));
+    ASSERT_TRUE(cpus.empty());
+    ASSERT_FALSE(NumaTopology::ParseCpuList("3-1", &cpus));
+    ASSERT_FALSE(NumaTopology::ParseCpuList("a-b", &cpus));
+}
+
+TEST_F(NumaTest, Topology) {
+    NumaTopology topology({"0-1", ""});
+    ASSERT_EQ(2u, topology.GetNodeCnt());
+    ASSERT_EQ(2u, topology.GetCpus(0).size());
+    // a node without cpus can not be bound
+    ASSERT_FALSE(topology.BindThread(1));
+    ASSERT_FALSE(topology.BindThread(2));
+    ASSERT_EQ(0u, NumaTopology({"0", "x"}).GetNodeCnt());
+}
+
+TEST_F(NumaTest, NodeScope) {
+    cpu_set_t cpu_set;
+    ASSERT_EQ(0, pthread_getaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set));
+    int cpu_cnt = CPU_COUNT(&cpu_set);
+    NumaTopology topology({std::to_string(sched_getcpu())});
+    ASSERT_EQ(-1, GetThreadNumaNode());
+    {
+        NumaNodeScope scope(topology, 0);
+        ASSERT_EQ(0, GetThreadNumaNode());
+        ASSERT_EQ(0, pthread_getaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set));
+        ASSERT_EQ(1, CPU_COUNT(&cpu_set));
+    }
+    ASSERT_EQ(-1, GetThreadNumaNode());
+    ASSERT_EQ(0, pthread_getaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set));
+    ASSERT_EQ(cpu_cnt, CPU_COUNT(&cpu_set));
+}
+
+TEST_F(NumaTest, BindTaskPool) {
+    NumaTopology topology({std::to_string(sched_getcpu())});
+    std::atomic<int> bound_cnt(0);
+    {
+        TaskPool pool(2, 16, [&topology] { topology.BindThread(0); });
+        for (int i = 0; i < 10; i++) {
+            pool.AddTask([&bound_cnt] {
+                if (GetThreadNumaNode() == 0) {
+                    bound_cnt++;
+                }
+            });
+        }
+    }
+    ASSERT_EQ(10, bound_cnt.load());
+}
+
+}  // namespace base
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -22,6 +22,8 @@
 
 #include <atomic>
 #include <iostream>
+#include <new>
+#include <vector>
 
 #include "base/random.h"
 
@@ -39,20 +41,32 @@ struct DefaultComparator {
     }
 };
 
-// Skiplist node , a thread safe structure
+// Skiplist node , a thread safe structure. The tower of next nodes is allocated inline after the key
+// and the value, so a node is a single allocation and a level hop does not miss on a separate tower.
+// Nodes are created by Create and released by delete
 template <class K, class V>
 class Node {
  public:
-    // Set data reference and Node height
-    Node(const K& key, V& value, uint8_t height)  // NOLINT
-        : height_(height), key_(key), value_(value) {
-        nexts_ = new std::atomic<Node<K, V>*>[height];
+    // Create a node of the data and height
+    static Node<K, V>* Create(const K& key, V& value, uint8_t height) {  // NOLINT
+        assert(height > 0);
+        return new (::operator new(ByteSize(height))) Node<K, V>(key, value, height);
     }
 
-    Node(uint8_t height) : height_(height), key_(), value_() {  // NOLINT
-        nexts_ = new std::atomic<Node<K, V>*>[height];
+    // Create a node without data, as the head of a skiplist
+    static Node<K, V>* Create(uint8_t height) {
+        assert(height > 0);
+        return new (::operator new(ByteSize(height))) Node<K, V>(height);
     }
 
+    // The bytes of a node with a tower of height levels, ByteSize(0) is the size without the tower
+    static constexpr size_t ByteSize(uint8_t height) {
+        return sizeof(Node<K, V>) + sizeof(std::atomic<Node<K, V>*>) * height - sizeof(std::atomic<Node<K, V>*>);
+    }
+
+    // the node is allocated by Create with its tower
+    static void operator delete(void* ptr) { ::operator delete(ptr); }
+
     // Set the next node with memory barrier
     void SetNext(uint8_t level, Node<K, V>* node) {
         assert(level < height_ && level >= 0);
@@ -77,17 +91,41 @@ class Node {
         return nexts_[level].load(std::memory_order_relaxed);
     }
 
+    // Prefetch the next node of the level, it's only a hint so a stale next is fine
+    void PrefetchNext(uint8_t level) {
+        assert(level < height_ && level >= 0);
+        __builtin_prefetch(nexts_[level].load(std::memory_order_relaxed), 0, 1);
+    }
+
     V& GetValue() { return value_; }
 
     const K& GetKey() const { return key_; }
 
-    ~Node() { delete[] nexts_; }
+    ~Node() {}
 
  private:
-    uint8_t const height_;
+    // Set data reference and Node height
+    Node(const K& key, V& value, uint8_t height)  // NOLINT
+        : key_(key), value_(value), height_(height) {
+        InitNexts();
+    }
+
+    explicit Node(uint8_t height) : key_(), value_(), height_(height) { InitNexts(); }
+
+    Node(const Node<K, V>&) = delete;
+    Node<K, V>& operator=(const Node<K, V>&) = delete;
+
+    void InitNexts() {
+        for (uint8_t i = 0; i < height_; i++) {
+            new (&nexts_[i]) std::atomic<Node<K, V>*>(NULL);
+        }
+    }
+
     K const key_;
     V value_;
-    std::atomic<Node<K, V>*>* nexts_;
+    uint8_t const height_;
+    // the first level of the tower, the others follow it in the same allocation
+    std::atomic<Node<K, V>*> nexts_[1];
 };
 
 template <class K, class V, class Comparator>
@@ -101,10 +139,7 @@ class Skiplist {
           rand_(0xdeadbeef),
           head_(NULL),
           tail_(NULL) {
-        head_ = new Node<K, V>(MaxHeight);
-        for (uint8_t i = 0; i < head_->Height(); i++) {
-            head_->SetNext(i, NULL);
-        }
+        head_ = Node<K, V>::Create(MaxHeight);
         max_height_.store(1, std::memory_order_relaxed);
     }
     ~Skiplist() { delete head_; }
@@ -362,26 +397,86 @@ class Skiplist {
     // delete the iterator after it's used
     Iterator* NewIterator() { return new Iterator(this); }
 
+    // Append keys after the last node without searching, so a sorted run is built bottom-up in O(n).
+    // A key less than the last one is inserted by searching. Need external synchronized and the list
+    // must not be modified by others while the appender is used
+    class Appender {
+     public:
+        explicit Appender(Skiplist<K, V, Comparator>* list) : list_(list), tails_(list->MaxHeight, NULL) { Reset(); }
+        ~Appender() {}
+
+        // return the height of the new node
+        uint8_t Append(const K& key, V& value) {  // NOLINT
+            Node<K, V>* last = tails_[0];
+            if (last != list_->head_ && list_->compare_(key, last->GetKey()) < 0) {
+                uint8_t height = list_->Insert(key, value);
+                Reset();
+                return height;
+            }
+            uint8_t height = list_->RandomHeight();
+            if (height > list_->GetMaxHeight()) {
+                list_->max_height_.store(height, std::memory_order_relaxed);
+            }
+            Node<K, V>* node = list_->NewNode(key, value, height);
+            for (uint8_t i = 0; i < height; i++) {
+                node->SetNextNoBarrier(i, NULL);
+                tails_[i]->SetNext(i, node);
+                tails_[i] = node;
+            }
+            list_->tail_.store(node, std::memory_order_release);
+            return height;
+        }
+
+     private:
+        // find the last node of each level
+        void Reset() {
+            Node<K, V>* node = list_->head_;
+            for (int level = list_->MaxHeight - 1; level >= 0; level--) {
+                Node<K, V>* next = node->GetNext(level);
+                while (next != NULL) {
+                    node = next;
+                    next = node->GetNext(level);
+                }
+                tails_[level] = node;
+            }
+        }
+
+        Skiplist<K, V, Comparator>* const list_;
+        std::vector<Node<K, V>*> tails_;
+    };
+
  private:
     Node<K, V>* NewNode(const K& key, V& value, uint8_t height) {  // NOLINT
-        Node<K, V>* node = new Node<K, V>(key, value, height);
-        return node;
+        return Node<K, V>::Create(key, value, height);
     }
 
+    // A node grows at most one level above the list, so a short list like the time list of
+    // a key does not get towers much higher than its size needs
     uint8_t RandomHeight() {
+        uint8_t limit = GetMaxHeight() < MaxHeight ? GetMaxHeight() + 1 : MaxHeight;
         uint8_t height = 1;
-        while (height < MaxHeight && (rand_.Next() % Branch) == 0) {
+        while (height < limit && (rand_.Next() % Branch) == 0) {
             height++;
         }
         return height;
     }
 
+    // Get the next node of the level and prefetch the one after it, the search compares it
+    // next if it moves forward on the level
+    Node<K, V>* GetNextAndPrefetch(Node<K, V>* node, uint8_t level) {
+        Node<K, V>* next = node->GetNext(level);
+        if (next != NULL) {
+            next->PrefetchNext(level);
+        }
+        return next;
+    }
+
     Node<K, V>* FindLessOrEqual(const K& key, Node<K, V>** nodes) {
         assert(nodes != NULL);
         Node<K, V>* node = head_;
         uint8_t level = GetMaxHeight() - 1;
         while (true) {
-            Node<K, V>* next = node->GetNext(level);
+            Node<K, V>* next = GetNextAndPrefetch(node, level);
             if (IsAfterNode(key, next)) {
                 node = next;
             } else {
@@ -398,7 +493,7 @@ class Skiplist {
         Node<K, V>* node = head_;
         uint8_t level = GetMaxHeight() - 1;
         while (true) {
-            Node<K, V>* next = node->GetNext(level);
+            Node<K, V>* next = GetNextAndPrefetch(node, level);
             if (next == NULL || compare_(next->GetKey(), key) > 0) {
                 if (level <= 0) {
                     return node;
@@ -415,7 +510,7 @@ class Skiplist {
         uint8_t level = GetMaxHeight() - 1;
         while (true) {
             assert(node == head_ || compare_(node->GetKey(), key) < 0);
-            Node<K, V>* next = node->GetNext(level);
+            Node<K, V>* next = GetNextAndPrefetch(node, level);
             if (next == NULL || compare_(next->GetKey(), key) >= 0) {
                 if (level <= 0) {
                     return node;
@@ -468,6 +563,7 @@ class Skiplist {
     Node<K, V>* head_;
     std::atomic<Node<K, V>*> tail_;
     friend Iterator;
+    friend Appender;
 };
 
 }  // namespace base
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "base/skiplist.h"
+#include "common/timer.h"
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace base {
+
+typedef Skiplist<uint64_t, uint64_t, DefaultComparator> TsList;
+
+class SkiplistBenchmarkTest : public ::testing::Test {
+ public:
+    SkiplistBenchmarkTest() {}
+    ~SkiplistBenchmarkTest() {}
+};
+
+// Insert 1M random keys into one skiplist and seek 1M random keys, like the key list of a segment,
+// and report the throughput of both
+TEST_F(SkiplistBenchmarkTest, InsertAndSeek) {
+    const uint64_t num = 1000000;
+    std::mt19937_64 rand(42);
+    std::vector<uint64_t> keys(num);
+    for (auto& key : keys) {
+        key = rand();
+    }
+    DefaultComparator cmp;
+    TsList list(12, 4, cmp);
+    uint64_t consumed = ::baidu::common::timer::get_micros();
+    for (uint64_t& key : keys) {
+        list.Insert(key, key);
+    }
+    consumed = ::baidu::common::timer::get_micros() - consumed;
+
+    std::shuffle(keys.begin(), keys.end(), rand);
+    std::unique_ptr<TsList::Iterator> it(list.NewIterator());
+    uint64_t found = 0;
+    uint64_t sconsumed = ::baidu::common::timer::get_micros();
+    for (uint64_t key : keys) {
+        it->Seek(key);
+        found += it->Valid() && it->GetKey() == key;
+    }
+    sconsumed = ::baidu::common::timer::get_micros() - sconsumed;
+    ASSERT_EQ(num, found);
+    std::cout << "insert " << num << " keys: " << consumed / 1000 << "ms, " << num * 1000000 / (consumed + 1)
+              << " keys/s" << std::endl;
+    std::cout << "seek " << num << " keys: " << sconsumed / 1000 << "ms, " << num * 1000000 / (sconsumed + 1)
+              << " keys/s" << std::endl;
+    ASSERT_EQ(num, list.Clear());
+}
+
+// Put 10 rows of increasing time into each of 100k short time lists, like the time lists of the
+// keys of a segment, and report the throughput and the index memory per row
+TEST_F(SkiplistBenchmarkTest, ShortTimeLists) {
+    const uint32_t key_num = 100000;
+    const uint32_t row_num = 10;
+    const uint8_t max_height = 8;
+    uint64_t start_ts = 1700000000000;
+    DefaultComparator cmp;
+    std::vector<std::unique_ptr<TsList>> lists;
+    for (uint32_t i = 0; i < key_num; i++) {
+        lists.emplace_back(new TsList(max_height, 4, cmp));
+    }
+    uint64_t node_bytes = 0;
+    uint64_t levels = 0;
+    uint64_t consumed = ::baidu::common::timer::get_micros();
+    for (uint32_t n = 0; n < row_num; n++) {
+        for (auto& list : lists) {
+            uint64_t ts = start_ts + n;
+            uint8_t height = list->Insert(ts, ts);
+            node_bytes += Node<uint64_t, uint64_t>::ByteSize(height);
+            levels += height;
+        }
+    }
+    consumed = ::baidu::common::timer::get_micros() - consumed;
+
+    uint64_t sconsumed = ::baidu::common::timer::get_micros();
+    uint64_t found = 0;
+    for (auto& list : lists) {
+        TsList::Iterator list_it(list.get());
+        for (uint32_t n = 0; n < row_num; n++) {
+            list_it.Seek(start_ts + n);
+            found += list_it.Valid();
+        }
+    }
+    sconsumed = ::baidu::common::timer::get_micros() - sconsumed;
+    ASSERT_EQ(key_num * row_num, found);
+    uint64_t total = key_num * row_num;
+    std::cout << "put " << total << " rows: " << consumed / 1000 << "ms, " << total * 1000000 / (consumed + 1)
+              << " rows/s" << std::endl;
+    std::cout << "seek " << total << " rows: " << sconsumed / 1000 << "ms, " << total * 1000000 / (sconsumed + 1)
+              << " rows/s" << std::endl;
+    std::cout << "node " << node_bytes / total << " bytes/row, height " << static_cast<double>(levels) / total
+              << " levels/row, head " << Node<uint64_t, uint64_t>::ByteSize(max_height) << " bytes/key" << std::endl;
+    for (auto& list : lists) {
+        ASSERT_EQ(row_num, list->Clear());
+    }
+}
+
+}  // namespace base
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
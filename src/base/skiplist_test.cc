@@ -16,6 +16,7 @@
 
 #include "base/skiplist.h"
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -77,21 +78,50 @@ struct StrComparator {
 TEST_F(NodeTest, SetNext) {
     uint32_t key = 1;
     uint32_t value = 2;
-    Node<uint32_t, uint32_t> node(key, value, 2);
+    Node<uint32_t, uint32_t>* node = Node<uint32_t, uint32_t>::Create(key, value, 2);
+    ASSERT_TRUE(node->GetNext(0) == NULL);
+    ASSERT_TRUE(node->GetNext(1) == NULL);
     uint32_t key2 = 3;
     uint32_t value2 = 3;
-    Node<uint32_t, uint32_t> node2(key2, value2, 2);
-    node.SetNext(1, &node2);
-    Node<uint32_t, uint32_t>* node_ptr = node.GetNext(1);
+    Node<uint32_t, uint32_t>* node2 = Node<uint32_t, uint32_t>::Create(key2, value2, 2);
+    node->SetNext(1, node2);
+    Node<uint32_t, uint32_t>* node_ptr = node->GetNext(1);
     ASSERT_EQ(3, (signed)node_ptr->GetValue());
     ASSERT_EQ(3, (signed)node_ptr->GetKey());
+    ASSERT_TRUE(node->GetNext(0) == NULL);
+    delete node;
+    delete node2;
 }
 
 TEST_F(NodeTest, NodeByteSize) {
     std::atomic<Node<Slice, std::string*>*> node0[12];
     ASSERT_EQ(96u, sizeof(node0));
-    ASSERT_EQ(32u, sizeof(Node<uint64_t, void*>));
-    ASSERT_EQ(40u, sizeof(Node<Slice, void*>));
+    // the tower is inline, 8 bytes per level after the key, the value and the height
+    ASSERT_EQ(24u, (Node<uint64_t, void*>::ByteSize(0)));
+    ASSERT_EQ(32u, (Node<uint64_t, void*>::ByteSize(1)));
+    ASSERT_EQ(120u, (Node<uint64_t, void*>::ByteSize(12)));
+    ASSERT_EQ(32u, (Node<Slice, void*>::ByteSize(0)));
+    ASSERT_EQ(40u, (Node<Slice, void*>::ByteSize(1)));
+}
+
+TEST_F(NodeTest, InlineTower) {
+    std::string key = "key";
+    std::string value = "value";
+    Node<std::string, std::string>* node = Node<std::string, std::string>::Create(key, value, 12);
+    ASSERT_EQ(12u, node->Height());
+    ASSERT_EQ("key", node->GetKey());
+    ASSERT_EQ("value", node->GetValue());
+    for (uint8_t i = 0; i < node->Height(); i++) {
+        ASSERT_TRUE(node->GetNext(i) == NULL);
+        node->SetNext(i, node);
+    }
+    // the levels don't overlap the data
+    for (uint8_t i = 0; i < node->Height(); i++) {
+        ASSERT_EQ(node, node->GetNext(i));
+    }
+    ASSERT_EQ("key", node->GetKey());
+    ASSERT_EQ("value", node->GetValue());
+    delete node;
 }
 
 TEST_F(NodeTest, SliceTest) {
@@ -663,6 +693,69 @@ TEST_F(SkiplistTest, Duplicate) {
     ASSERT_FALSE(it->Valid());
 }
 
+TEST_F(SkiplistTest, Appender) {
+    DescComparator cmp;
+    Skiplist<uint32_t, uint32_t, DescComparator> sl(12, 4, cmp);
+    {
+        Skiplist<uint32_t, uint32_t, DescComparator>::Appender appender(&sl);
+        for (uint32_t key = 1000; key > 500; key--) {
+            uint32_t value = key;
+            ASSERT_GT(appender.Append(key, value), 0);
+        }
+        // out of order keys are inserted by searching
+        uint32_t key = 2000;
+        uint32_t value = 2000;
+        appender.Append(key, value);
+        for (key = 500; key > 0; key--) {
+            value = key;
+            appender.Append(key, value);
+        }
+    }
+    // append to a list which is not empty
+    Skiplist<uint32_t, uint32_t, DescComparator>::Appender appender(&sl);
+    uint32_t key = 0;
+    uint32_t value = 0;
+    appender.Append(key, value);
+    ASSERT_EQ(0u, sl.GetLast()->GetKey());
+    ASSERT_EQ(1002u, sl.GetSize());
+
+    Skiplist<uint32_t, uint32_t, DescComparator>::Iterator* it = sl.NewIterator();
+    it->SeekToFirst();
+    ASSERT_EQ(2000u, it->GetKey());
+    it->Next();
+    for (uint32_t expect = 1000;; expect--) {
+        ASSERT_TRUE(it->Valid());
+        ASSERT_EQ(expect, it->GetKey());
+        ASSERT_EQ(expect, it->GetValue());
+        it->Next();
+        if (expect == 0) {
+            break;
+        }
+    }
+    ASSERT_FALSE(it->Valid());
+    it->Seek(321);
+    ASSERT_EQ(321u, it->GetKey());
+    ASSERT_EQ(1u, sl.Get(1));
+    delete it;
+}
+
+TEST_F(SkiplistTest, RandomHeight) {
+    DefaultComparator cmp;
+    for (uint32_t round = 0; round < 100; round++) {
+        Skiplist<uint64_t, uint64_t, DefaultComparator> sl(12, 4, cmp);
+        // a node is at most one level higher than the nodes before it and the list starts at one level
+        uint8_t max_height = 1;
+        for (uint64_t ts = 0; ts < 10; ts++) {
+            uint64_t value = ts;
+            uint8_t height = sl.Insert(ts, value);
+            ASSERT_GT(height, 0);
+            ASSERT_LE(height, max_height + 1);
+            max_height = std::max(max_height, height);
+        }
+        ASSERT_EQ(10u, sl.Clear());
+    }
+}
+
 }  // namespace base
 }  // namespace openmldb
 
@@ -134,6 +134,34 @@ static inline std::string DebugString(const std::string& src) {
     return dst.substr(0, j);
 }
 
+// escape the html special chars of `src`, so that it is shown as text in a page
+static inline std::string HtmlEscape(const std::string& src) {
+    std::string dst;
+    dst.reserve(src.size());
+    for (char c : src) {
+        switch (c) {
+            case '&':
+                dst.append("&amp;");
+                break;
+            case '<':
+                dst.append("&lt;");
+                break;
+            case '>':
+                dst.append("&gt;");
+                break;
+            case '"':
+                dst.append("&quot;");
+                break;
+            case '\'':
+                dst.append("&#39;");
+                break;
+            default:
+                dst.push_back(c);
+        }
+    }
+    return dst;
+}
+
 static inline std::string NumToString(double num) {
     char buf[32];
     snprintf(buf, sizeof(buf), "%.3f", num);
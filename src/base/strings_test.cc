@@ -45,6 +45,12 @@ TEST_F(StringsTest, Split) {
     ASSERT_EQ("xxxxx", result[1]);
 }
 
+TEST_F(StringsTest, HtmlEscape) {
+    ASSERT_EQ("select c1 from t1", HtmlEscape("select c1 from t1"));
+    ASSERT_EQ("&lt;script&gt;alert(&quot;x&quot;)&lt;/script&gt;", HtmlEscape("<script>alert(\"x\")</script>"));
+    ASSERT_EQ("a &amp;&amp; b &gt; &#39;c&#39;", HtmlEscape("a && b > 'c'"));
+}
+
 TEST_F(StringsTest, ReadableTime) {
     std::string result = HumanReadableTime(60000);
     ASSERT_EQ("1m", result);
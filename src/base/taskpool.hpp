@@ -25,13 +25,20 @@ namespace openmldb {
 namespace base {
 class TaskPool {
  public:
+    typedef boost::function<void()> Task;
+
     TaskPool(uint32_t thread_num, uint32_t qsize)
         : stop_(false), threads_num_(thread_num), queue_(qsize) {
         Start();
     }
 
+    // thread_init runs on each thread before it takes tasks, e.g. to bind the thread to cpus
+    TaskPool(uint32_t thread_num, uint32_t qsize, const Task& thread_init)
+        : stop_(false), threads_num_(thread_num), queue_(qsize), thread_init_(thread_init) {
+        Start();
+    }
+
     ~TaskPool() { Stop(); }
-    typedef boost::function<void()> Task;
 
     bool Start() {
         for (uint32_t i = 0; i < threads_num_; i++) {
@@ -69,12 +76,26 @@ class TaskPool {
         work_cv_.notify_one();
     }
 
+    // return false instead of waiting if the queue is full
+    bool TryAddTask(const Task& task) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (queue_.full() || stop_) {
+            return false;
+        }
+        queue_.put(task);
+        work_cv_.notify_one();
+        return true;
+    }
+
  private:
     static void* ThreadWrapper(void* arg) {
         reinterpret_cast<TaskPool*>(arg)->ThreadProc();
         return NULL;
     }
     void ThreadProc() {
+        if (thread_init_) {
+            thread_init_();
+        }
         while (true) {
             Task task;
             {
@@ -96,6 +117,7 @@ class TaskPool {
     bool stop_;
     uint32_t threads_num_;
     ::openmldb::base::RingQueue<Task> queue_;
+    Task thread_init_;
     std::vector<pthread_t> tids_;
     std::condition_variable work_cv_, queue_cv_;
     std::mutex mutex_;
@@ -15,9 +15,15 @@
  */
 
 #include "catalog/distribute_iterator.h"
+
+#include <algorithm>
+
 #include "gflags/gflags.h"
 
 DECLARE_uint32(traverse_cnt_limit);
+DECLARE_uint32(traverse_prefetch_partition_num);
+DECLARE_int32(request_timeout_ms);
+DECLARE_int32(request_max_retry);
 
 namespace openmldb {
 namespace catalog {
@@ -27,7 +33,16 @@ constexpr uint32_t INVALID_PID = UINT32_MAX;
 FullTableIterator::FullTableIterator(uint32_t tid, std::shared_ptr<Tables> tables,
         const std::map<uint32_t, std::shared_ptr<::openmldb::client::TabletClient>>& tablet_clients)
     : tid_(tid), tables_(tables), tablet_clients_(tablet_clients), in_local_(true), cur_pid_(INVALID_PID),
-    it_(), kv_it_(), key_(0), last_ts_(0), last_pk_(), value_() {
+    it_(), kv_it_(), key_(0), value_(), remote_pids_(), remote_idx_(0), remote_started_(false), pending_(),
+    response_() {
+    for (const auto& kv : tablet_clients_) {
+        remote_pids_.push_back(kv.first);
+    }
+    pending_.resize(remote_pids_.size(), nullptr);
+}
+
+FullTableIterator::~FullTableIterator() {
+    CancelTraverse();
 }
 
 void FullTableIterator::SeekToFirst() {
@@ -47,10 +62,14 @@ void FullTableIterator::Next() {
 }
 
 void FullTableIterator::Reset() {
+    CancelTraverse();
     it_.reset();
     kv_it_.reset();
+    response_.reset();
     cur_pid_ = INVALID_PID;
     in_local_ = true;
+    remote_idx_ = 0;
+    remote_started_ = false;
 }
 
 void FullTableIterator::EndLocal() {
@@ -103,8 +122,67 @@ bool FullTableIterator::NextFromLocal() {
     return false;
 }
 
+void FullTableIterator::SendTraverse(size_t idx, const std::string& pk, uint64_t ts) {
+    uint32_t pid = remote_pids_[idx];
+    ::openmldb::api::TraverseRequest request;
+    request.set_tid(tid_);
+    request.set_pid(pid);
+    request.set_limit(FLAGS_traverse_cnt_limit);
+    if (!pk.empty()) {
+        request.set_pk(pk);
+        request.set_ts(ts);
+    }
+    auto cntl = std::make_shared<brpc::Controller>();
+    cntl->set_timeout_ms(FLAGS_request_timeout_ms);
+    cntl->set_max_retry(FLAGS_request_max_retry);
+    auto callback = new TraverseCallback(std::make_shared<::openmldb::api::TraverseResponse>(), cntl);
+    // one reference is released when the rpc is done and the other one by WaitTraverse
+    callback->Ref();
+    if (!tablet_clients_[pid]->AsyncTraverse(request, callback)) {
+        LOG(WARNING) << "fail to send traverse request. tid " << tid_ << " pid " << pid;
+        callback->UnRef();
+        callback->UnRef();
+        return;
+    }
+    pending_[idx] = callback;
+}
+
+std::shared_ptr<::openmldb::api::TraverseResponse> FullTableIterator::WaitTraverse(size_t idx) {
+    auto callback = pending_[idx];
+    pending_[idx] = nullptr;
+    if (callback == nullptr) {
+        return nullptr;
+    }
+    std::shared_ptr<::openmldb::api::TraverseResponse> response;
+    auto cntl = callback->GetController();
+    brpc::Join(cntl->call_id());
+    if (cntl->Failed()) {
+        LOG(WARNING) << "fail to traverse. tid " << tid_ << " pid " << remote_pids_[idx] << " error "
+                     << cntl->ErrorText();
+    } else if (callback->GetResponse()->code() != 0) {
+        LOG(WARNING) << "fail to traverse. tid " << tid_ << " pid " << remote_pids_[idx] << " msg "
+                     << callback->GetResponse()->msg();
+    } else {
+        response = callback->GetResponse();
+    }
+    callback->UnRef();
+    return response;
+}
+
+void FullTableIterator::CancelTraverse() {
+    for (auto& callback : pending_) {
+        if (callback != nullptr) {
+            auto call_id = callback->GetController()->call_id();
+            brpc::StartCancel(call_id);
+            brpc::Join(call_id);
+            callback->UnRef();
+            callback = nullptr;
+        }
+    }
+}
+
 bool FullTableIterator::NextFromRemote() {
-    if (tablet_clients_.empty()) {
+    if (remote_pids_.empty()) {
         return false;
     }
     if (kv_it_) {
@@ -114,44 +192,42 @@ bool FullTableIterator::NextFromRemote() {
             return true;
         }
     }
-    auto iter = tablet_clients_.begin();
-    if (cur_pid_ == INVALID_PID) {
-        cur_pid_ = iter->first;
-    } else {
-        iter = tablet_clients_.find(cur_pid_);
-    }
-    do {
-        if (iter == tablet_clients_.end()) {
-            return false;
+    size_t prefetch_num = std::max(FLAGS_traverse_prefetch_partition_num, 1u);
+    if (!remote_started_) {
+        remote_started_ = true;
+        for (size_t idx = 0; idx < remote_pids_.size() && idx < prefetch_num; idx++) {
+            SendTraverse(idx, "", 0);
         }
-        cur_pid_ = iter->first;
-        uint32_t count = 0;
-        if (kv_it_) {
-            if (!kv_it_->IsFinish()) {
-                DLOG(INFO) << "pid " << cur_pid_ << " last pk " << last_pk_ <<
-                    " key " << last_ts_ << " count " << count;
-                kv_it_.reset(iter->second->Traverse(tid_, cur_pid_, "", last_pk_, last_ts_,
-                            FLAGS_traverse_cnt_limit, false, count));
-            } else {
-                iter++;
-                kv_it_.reset();
-                continue;
+    }
+    while (remote_idx_ < remote_pids_.size()) {
+        if (pending_[remote_idx_] == nullptr) {
+            // all the pages of the partition are read, move the window to the next partition
+            remote_idx_++;
+            size_t next = remote_idx_ + prefetch_num - 1;
+            if (next < remote_pids_.size()) {
+                SendTraverse(next, "", 0);
             }
-        } else {
-            kv_it_.reset(iter->second->Traverse(tid_, cur_pid_, "", "", 0, FLAGS_traverse_cnt_limit, false, count));
-            DLOG(INFO) << "count " << count;
+            continue;
         }
-        if (kv_it_ && kv_it_->Valid()) {
-            last_pk_ = kv_it_->GetLastPK();
-            last_ts_ = kv_it_->GetLastTS();
-            response_vec_.emplace_back(kv_it_->GetResponse());
+        auto response = WaitTraverse(remote_idx_);
+        if (!response) {
+            continue;
+        }
+        if (!response->is_finish()) {
+            // fetch the next page while this one is read
+            SendTraverse(remote_idx_, response->pk(), response->ts());
+        }
+        kv_it_.reset(new ::openmldb::base::KvIterator(response.get(), false));
+        response_ = response;
+        if (kv_it_->Valid()) {
+            cur_pid_ = remote_pids_[remote_idx_];
             key_ = kv_it_->GetKey();
-            break;
+            return true;
         }
-        iter++;
-        kv_it_.reset();
-    } while (true);
-    return true;
+    }
+    kv_it_.reset();
+    response_.reset();
+    return false;
 }
 
 const ::hybridse::codec::Row& FullTableIterator::GetValue() {
@@ -160,8 +236,11 @@ const ::hybridse::codec::Row& FullTableIterator::GetValue() {
             ::hybridse::base::RefCountedSlice::Create(it_->GetValue().data(), it_->GetValue().size()));
         return value_;
     } else {
-        value_ = ::hybridse::codec::Row(
-            ::hybridse::base::RefCountedSlice::Create(kv_it_->GetValue().data(), kv_it_->GetValue().size()));
+        // the page is released after it is read, the row keeps its own copy
+        auto slice = kv_it_->GetValue();
+        int8_t* buf = reinterpret_cast<int8_t*>(malloc(slice.size()));
+        memcpy(buf, slice.data(), slice.size());
+        value_ = ::hybridse::codec::Row(::hybridse::base::RefCountedSlice::CreateManaged(buf, slice.size()));
         return value_;
     }
 }
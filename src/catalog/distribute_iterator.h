@@ -33,10 +33,17 @@ namespace catalog {
 
 using Tables = std::map<uint32_t, std::shared_ptr<::openmldb::storage::Table>>;
 
+using TraverseCallback = ::openmldb::RpcCallback<::openmldb::api::TraverseResponse>;
+
+// Rows of the local partitions first, then the rows of the remote partitions in the order of pid.
+// The first pages of FLAGS_traverse_prefetch_partition_num remote partitions are requested at
+// once, and the next page of a partition is requested when its current page arrives, so at most
+// one page per partition in the window is in flight. A page is released once it is read.
 class FullTableIterator : public ::hybridse::codec::ConstIterator<uint64_t, ::hybridse::codec::Row> {
  public:
     FullTableIterator(uint32_t tid, std::shared_ptr<Tables> tables,
             const std::map<uint32_t, std::shared_ptr<::openmldb::client::TabletClient>>& tablet_clients);
+    ~FullTableIterator() override;
     void Seek(const uint64_t& ts) override {}
     void SeekToFirst() override;
     bool Valid() const override;
@@ -51,6 +58,11 @@ class FullTableIterator : public ::hybridse::codec::ConstIterator<uint64_t, ::hy
     bool NextFromRemote();
     void Reset();
     void EndLocal();
+    // request the page after pk and ts of the idx-th remote partition, the first page if pk is empty
+    void SendTraverse(size_t idx, const std::string& pk, uint64_t ts);
+    // wait for the page in flight of the idx-th remote partition, return null if there is none or it fails
+    std::shared_ptr<::openmldb::api::TraverseResponse> WaitTraverse(size_t idx);
+    void CancelTraverse();
 
  private:
     uint32_t tid_;
@@ -61,10 +73,15 @@ class FullTableIterator : public ::hybridse::codec::ConstIterator<uint64_t, ::hy
     std::unique_ptr<::openmldb::storage::TableIterator> it_;
     std::unique_ptr<::openmldb::base::KvIterator> kv_it_;
     uint64_t key_;
-    uint64_t last_ts_;
-    std::string last_pk_;
     ::hybridse::codec::Row value_;
-    std::vector<std::shared_ptr<::google::protobuf::Message>> response_vec_;
+    std::vector<uint32_t> remote_pids_;
+    // index of the remote partition being read in remote_pids_
+    size_t remote_idx_;
+    bool remote_started_;
+    // the page in flight of each remote partition
+    std::vector<TraverseCallback*> pending_;
+    // the page being read by kv_it_
+    std::shared_ptr<::openmldb::api::TraverseResponse> response_;
 };
 
 class RemoteWindowIterator : public ::hybridse::vm::RowIterator {
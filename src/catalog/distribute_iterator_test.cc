@@ -32,6 +32,7 @@
 
 DECLARE_string(db_root_path);
 DECLARE_uint32(traverse_cnt_limit);
+DECLARE_uint32(traverse_prefetch_partition_num);
 
 namespace openmldb {
 namespace catalog {
@@ -294,6 +295,69 @@ TEST_F(DistributeIteratorTest, TraverseLimit) {
     FLAGS_traverse_cnt_limit = old_limit;
 }
 
+TEST_F(DistributeIteratorTest, TraversePrefetch) {
+    uint32_t old_limit = FLAGS_traverse_cnt_limit;
+    uint32_t old_prefetch_num = FLAGS_traverse_prefetch_partition_num;
+    FLAGS_traverse_cnt_limit = 7;
+    uint32_t tid = 3;
+    FLAGS_db_root_path = "/tmp/" + ::openmldb::test::GenRand();
+    std::vector<std::string> endpoints = {"127.0.0.1:9230", "127.0.0.1:9231"};
+    brpc::Server tablet1;
+    ASSERT_TRUE(::openmldb::test::StartTablet(endpoints[0], &tablet1));
+    brpc::Server tablet2;
+    ASSERT_TRUE(::openmldb::test::StartTablet(endpoints[1], &tablet2));
+    auto client1 = std::make_shared<openmldb::client::TabletClient>(endpoints[0], endpoints[0]);
+    ASSERT_EQ(client1->Init(), 0);
+    auto client2 = std::make_shared<openmldb::client::TabletClient>(endpoints[1], endpoints[1]);
+    ASSERT_EQ(client2->Init(), 0);
+    std::map<uint32_t, std::shared_ptr<openmldb::client::TabletClient>> tablet_clients;
+    std::vector<::openmldb::api::TableMeta> metas;
+    for (uint32_t pid = 0; pid < 4; pid++) {
+        metas.push_back(CreateTableMeta(tid, pid));
+        tablet_clients.emplace(pid, pid % 2 == 0 ? client1 : client2);
+        ASSERT_TRUE(tablet_clients[pid]->CreateTable(metas[pid]));
+    }
+    for (int i = 0; i < 40; i++) {
+        std::string key = "card" + std::to_string(i);
+        uint32_t pid = (uint32_t)(::openmldb::base::hash64(key)) % 4;
+        PutKey(key, metas[pid], tablet_clients[pid]);
+    }
+    std::vector<std::vector<std::string>> results;
+    for (uint32_t prefetch_num : {1, 2, 8}) {
+        FLAGS_traverse_prefetch_partition_num = prefetch_num;
+        // the rows are still valid after the pages are released
+        std::vector<::hybridse::codec::Row> rows;
+        {
+            FullTableIterator it(tid, {}, tablet_clients);
+            it.SeekToFirst();
+            while (it.Valid()) {
+                rows.push_back(it.GetValue());
+                it.Next();
+            }
+        }
+        std::vector<std::string> values;
+        for (auto& row : rows) {
+            values.emplace_back(reinterpret_cast<char*>(row.buf()), row.size());
+        }
+        ASSERT_EQ(400u, values.size());
+        results.push_back(values);
+    }
+    ASSERT_EQ(results[0], results[1]);
+    ASSERT_EQ(results[0], results[2]);
+    // stop in the middle of a partition with the pages in flight
+    FLAGS_traverse_prefetch_partition_num = 4;
+    {
+        FullTableIterator it(tid, {}, tablet_clients);
+        it.SeekToFirst();
+        for (int i = 0; i < 10 && it.Valid(); i++) {
+            it.Next();
+        }
+        ASSERT_TRUE(it.Valid());
+    }
+    FLAGS_traverse_cnt_limit = old_limit;
+    FLAGS_traverse_prefetch_partition_num = old_prefetch_num;
+}
+
 TEST_F(DistributeIteratorTest, WindowIterator) {
     uint32_t tid = 3;
     FLAGS_db_root_path = "/tmp/" + ::openmldb::test::GenRand();
@@ -182,6 +182,49 @@ const uint64_t TabletTableHandler::GetCount() {
     return cnt;
 }
 
+uint64_t TabletTableHandler::GetWriteVersion() {
+    auto tables = std::atomic_load_explicit(&tables_, std::memory_order_acquire);
+    // writes to remote partitions are invisible here, the version is unknown
+    if (tables->empty() || tables->size() != partition_num_) {
+        return 0;
+    }
+    uint64_t version = 0;
+    for (const auto& kv : *tables) {
+        version += kv.second->GetWriteVersion();
+    }
+    return version;
+}
+
+uint64_t TabletTableHandler::GetWriteVersion(const std::string& pk) {
+    uint32_t pid_num = table_st_.GetPartitionNum();
+    uint32_t pid = 0;
+    if (pid_num > 0) {
+        pid = (uint32_t)(::openmldb::base::hash64(pk) % pid_num);
+    }
+    auto tables = std::atomic_load_explicit(&tables_, std::memory_order_acquire);
+    auto it = tables->find(pid);
+    if (it == tables->end()) {
+        return 0;
+    }
+    return it->second->GetWriteVersion();
+}
+
+uint64_t TabletSegmentHandler::GetWriteVersion() {
+    auto partition_handler = std::dynamic_pointer_cast<TabletPartitionHandler>(partition_handler_);
+    if (!partition_handler) {
+        return 0;
+    }
+    return partition_handler->GetWriteVersion(key_);
+}
+
+uint64_t TabletPartitionHandler::GetWriteVersion(const std::string& key) {
+    auto table_handler = std::dynamic_pointer_cast<TabletTableHandler>(table_handler_);
+    if (!table_handler) {
+        return 0;
+    }
+    return table_handler->GetWriteVersion(key);
+}
+
 ::hybridse::codec::Row TabletTableHandler::At(uint64_t pos) {
     auto iter = GetIterator();
     while (pos-- > 0 && iter->Valid()) {
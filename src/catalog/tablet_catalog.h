@@ -112,6 +112,9 @@ class TabletSegmentHandler : public ::hybridse::vm::TableHandler {
     }
     const std::string GetHandlerTypeName() override { return "TabletSegmentHandler"; }
 
+    // version of the partition which the key belongs to
+    uint64_t GetWriteVersion() override;
+
  private:
     std::shared_ptr<::hybridse::vm::PartitionHandler> partition_handler_;
     std::string key_;
@@ -159,6 +162,10 @@ class TabletPartitionHandler : public ::hybridse::vm::PartitionHandler,
     }
     const std::string GetHandlerTypeName() override { return "TabletPartitionHandler"; }
 
+    uint64_t GetWriteVersion() override { return table_handler_->GetWriteVersion(); }
+
+    uint64_t GetWriteVersion(const std::string &key);
+
  private:
     std::shared_ptr<::hybridse::vm::TableHandler> table_handler_;
     std::string index_name_;
@@ -203,6 +210,11 @@ class TabletTableHandler : public ::hybridse::vm::TableHandler,
     std::shared_ptr<::hybridse::vm::PartitionHandler> GetPartition(const std::string &index_name) override;
     const std::string GetHandlerTypeName() override { return "TabletTableHandler"; }
 
+    uint64_t GetWriteVersion() override;
+
+    // version of the partition which the pk belongs to, 0 if the partition is not local
+    uint64_t GetWriteVersion(const std::string &pk);
+
     std::shared_ptr<::hybridse::vm::Tablet> GetTablet(const std::string &index_name, const std::string &pk) override;
     std::shared_ptr<::hybridse::vm::Tablet> GetTablet(const std::string &index_name,
                                                       const std::vector<std::string> &pks) override;
@@ -268,6 +268,24 @@ bool TabletClient::Put(uint32_t tid, uint32_t pid, uint64_t time, const std::str
     return false;
 }
 
+bool TabletClient::AsyncPut(const ::openmldb::api::PutRequest& request,
+                            openmldb::RpcCallback<openmldb::api::PutResponse>* callback) {
+    if (callback == nullptr) {
+        return false;
+    }
+    return client_.SendRequest(&::openmldb::api::TabletServer_Stub::Put, callback->GetController().get(), &request,
+                               callback->GetResponse().get(), callback);
+}
+
+bool TabletClient::AsyncBatchPut(const ::openmldb::api::BatchPutRequest& request,
+                                 openmldb::RpcCallback<openmldb::api::BatchPutResponse>* callback) {
+    if (callback == nullptr) {
+        return false;
+    }
+    return client_.SendRequest(&::openmldb::api::TabletServer_Stub::BatchPut, callback->GetController().get(),
+                               &request, callback->GetResponse().get(), callback);
+}
+
 bool TabletClient::Put(uint32_t tid, uint32_t pid, const char* pk, uint64_t time, const char* value, uint32_t size,
                        uint32_t format_version) {
     ::openmldb::api::PutRequest request;
@@ -1274,6 +1292,15 @@ bool TabletClient::AsyncScan(const ::openmldb::api::ScanRequest& request,
                                callback->GetResponse().get(), callback);
 }
 
+bool TabletClient::AsyncTraverse(const ::openmldb::api::TraverseRequest& request,
+                                 openmldb::RpcCallback<openmldb::api::TraverseResponse>* callback) {
+    if (callback == nullptr) {
+        return false;
+    }
+    return client_.SendRequest(&::openmldb::api::TabletServer_Stub::Traverse, callback->GetController().get(),
+                               &request, callback->GetResponse().get(), callback);
+}
+
 bool TabletClient::Scan(const ::openmldb::api::ScanRequest& request, brpc::Controller* cntl,
                         ::openmldb::api::ScanResponse* response) {
     bool ok = client_.SendRequest(&::openmldb::api::TabletServer_Stub::Scan, cntl, &request, response);
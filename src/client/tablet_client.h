@@ -90,6 +90,11 @@ class TabletClient : public Client {
     bool Put(uint32_t tid, uint32_t pid, uint64_t time, const std::string& value,
              const std::vector<std::pair<std::string, uint32_t>>& dimensions, uint32_t format_version);
 
+    bool AsyncPut(const ::openmldb::api::PutRequest& request,
+                  openmldb::RpcCallback<openmldb::api::PutResponse>* callback);
+
+    bool AsyncBatchPut(const ::openmldb::api::BatchPutRequest& request,
+                       openmldb::RpcCallback<openmldb::api::BatchPutResponse>* callback);
 
 
     bool Get(uint32_t tid, uint32_t pid, const std::string& pk, uint64_t time, std::string& value,  // NOLINT
@@ -137,6 +142,9 @@ class TabletClient : public Client {
     bool AsyncScan(const ::openmldb::api::ScanRequest& request,
                    openmldb::RpcCallback<openmldb::api::ScanResponse>* callback);
 
+    bool AsyncTraverse(const ::openmldb::api::TraverseRequest& request,
+                       openmldb::RpcCallback<openmldb::api::TraverseResponse>* callback);
+
     bool GetTableSchema(uint32_t tid, uint32_t pid,
                         ::openmldb::api::TableMeta& table_meta);  // NOLINT
 
@@ -40,6 +40,7 @@ DEFINE_string(cmd, "", "Set cmd");
 DECLARE_string(host);
 DECLARE_int32(port);
 DECLARE_uint32(traverse_cnt_limit);
+DECLARE_uint32(columnar_file_batch_rows);
 DECLARE_string(ssd_root_path);
 DECLARE_string(hdd_root_path);
 DECLARE_string(recycle_bin_ssd_root_path);
@@ -158,7 +159,7 @@ TEST_F(SqlCmdTest, SelectIntoOutfile) {
 
     // False - Format un-supported
     select_into_sql =
-        "select * from " + name + " into outfile '" + file_path + "' options (mode = 'overwrite', format = 'parquet')";
+        "select * from " + name + " into outfile '" + file_path + "' options (mode = 'overwrite', format = 'json')";
     router->ExecuteSQL(select_into_sql, &status);
     ASSERT_FALSE(status.IsOK());
 
@@ -371,6 +372,126 @@ TEST_F(SqlCmdTest, LoadData) {
     unlink(file_name.c_str());
 }
 
+TEST_F(SqlCmdTest, LoadDataMultiThread) {
+    sr = standalone_cli.sr;
+    cs = standalone_cli.cs;
+    HandleSQL("create database test1;");
+    HandleSQL("use test1;");
+    std::string create_sql = "create table trans (c1 string, c2 int);";
+    HandleSQL(create_sql);
+    std::string file_name = "./myfile_multi_thread.csv";
+    std::ofstream ofile;
+    ofile.open(file_name);
+    ofile << "c1,c2" << std::endl;
+    for (int i = 0; i < 5000; i++) {
+        ofile << "aa" << i << "," << i << std::endl;
+    }
+    ofile.close();
+    std::string load_sql = "LOAD DATA INFILE '" + file_name + "' INTO TABLE trans OPTIONS(thread=4);";
+    hybridse::sdk::Status status;
+    sr->ExecuteSQL(load_sql, &status);
+    ASSERT_TRUE(status.IsOK()) << status.msg;
+    ASSERT_EQ("Load 5000 rows", status.msg);
+    auto result = sr->ExecuteSQL("select * from trans;", &status);
+    ASSERT_TRUE(status.IsOK());
+    ASSERT_EQ(5000, result->Size());
+    HandleSQL("drop table trans;");
+
+    // loading stops at the malformed line, the lines before it are loaded
+    HandleSQL(create_sql);
+    ofile.open(file_name);
+    ofile << "c1,c2" << std::endl;
+    for (int i = 0; i < 3000; i++) {
+        ofile << "aa" << i << "," << i << std::endl;
+    }
+    ofile << "bb,notint" << std::endl;
+    for (int i = 0; i < 3000; i++) {
+        ofile << "cc" << i << "," << i << std::endl;
+    }
+    ofile.close();
+    sr->ExecuteSQL(load_sql, &status);
+    ASSERT_FALSE(status.IsOK());
+    ASSERT_EQ("line [bb,notint] insert failed, translate to insert row failed", status.msg);
+    result = sr->ExecuteSQL("select * from trans;", &status);
+    ASSERT_TRUE(status.IsOK());
+    ASSERT_EQ(3000, result->Size());
+    HandleSQL("drop table trans;");
+    HandleSQL("drop database test1;");
+    unlink(file_name.c_str());
+}
+
+TEST_F(SqlCmdTest, LoadDataColumnarFormat) {
+    sr = standalone_cli.sr;
+    cs = standalone_cli.cs;
+    HandleSQL("create database test1;");
+    HandleSQL("use test1;");
+    HandleSQL("create table trans (c1 string, c2 int, c3 timestamp, c4 date);");
+    HandleSQL("create table trans2 (c1 string, c2 int, c3 timestamp, c4 date);");
+    std::string csv_file = "./myfile_columnar.csv";
+    std::ofstream ofile;
+    ofile.open(csv_file);
+    ofile << "c1,c2,c3,c4" << std::endl;
+    for (int i = 0; i < 5000; i++) {
+        ofile << "aa" << i << "," << (i % 7 == 0 ? "null" : std::to_string(i)) << "," << 1700000000000 + i
+              << ",2022-0" << (i % 9 + 1) << "-1" << (i % 9) << std::endl;
+    }
+    ofile.close();
+    hybridse::sdk::Status status;
+    sr->ExecuteSQL("LOAD DATA INFILE '" + csv_file + "' INTO TABLE trans;", &status);
+    ASSERT_TRUE(status.IsOK()) << status.msg;
+    sr->ExecuteSQL("SET @@execute_mode='online';", &status);
+    ASSERT_TRUE(status.IsOK()) << status.msg;
+    // several row groups or record batches, so they are decoded by many threads
+    uint32_t old_batch_rows = FLAGS_columnar_file_batch_rows;
+    FLAGS_columnar_file_batch_rows = 1000;
+    for (const std::string format : {"parquet", "arrow"}) {
+        std::string file_name = "./myfile_columnar." + format;
+        sr->ExecuteSQL("select * from trans into outfile '" + file_name + "' options (mode = 'overwrite', format = '" +
+                           format + "');",
+                       &status);
+        ASSERT_TRUE(status.IsOK()) << format << " " << status.msg;
+        // the file ends with its footer, it can not be appended to
+        sr->ExecuteSQL("select * from trans into outfile '" + file_name + "' options (mode = 'append', format = '" +
+                           format + "');",
+                       &status);
+        ASSERT_FALSE(status.IsOK());
+        sr->ExecuteSQL("LOAD DATA INFILE '" + file_name + "' INTO TABLE trans2 OPTIONS(format='" + format +
+                           "', thread=4);",
+                       &status);
+        ASSERT_TRUE(status.IsOK()) << format << " " << status.msg;
+        auto result = sr->ExecuteSQL("select * from trans2 where c1 = 'aa14';", &status);
+        ASSERT_TRUE(status.IsOK());
+        ASSERT_EQ(1, result->Size());
+        ASSERT_TRUE(result->Next());
+        ASSERT_TRUE(result->IsNULL(1));
+        ASSERT_EQ(1700000000014, result->GetTimeUnsafe(2));
+        ASSERT_EQ("2022-06-15", result->GetAsStringUnsafe(3));
+        result = sr->ExecuteSQL("select * from trans2;", &status);
+        ASSERT_TRUE(status.IsOK());
+        ASSERT_EQ(5000, result->Size());
+        HandleSQL("drop table trans2;");
+        HandleSQL("create table trans2 (c1 string, c2 int, c3 timestamp, c4 date);");
+        unlink(file_name.c_str());
+    }
+    FLAGS_columnar_file_batch_rows = old_batch_rows;
+
+    // the columns are bound by name
+    sr->ExecuteSQL("select * from trans into outfile './myfile_columnar.parquet' options (format = 'parquet');",
+                   &status);
+    ASSERT_TRUE(status.IsOK()) << status.msg;
+    HandleSQL("create table trans3 (c1 string, c2 int, c3 timestamp, c5 date);");
+    sr->ExecuteSQL("LOAD DATA INFILE './myfile_columnar.parquet' INTO TABLE trans3 OPTIONS(format='parquet');",
+                   &status);
+    ASSERT_FALSE(status.IsOK());
+    ASSERT_EQ("column c5 is not found in file", status.msg);
+    unlink("./myfile_columnar.parquet");
+    HandleSQL("drop table trans;");
+    HandleSQL("drop table trans2;");
+    HandleSQL("drop table trans3;");
+    HandleSQL("drop database test1;");
+    unlink(csv_file.c_str());
+}
+
 TEST_P(DBSDKTest, Deploy) {
     auto cli = GetParam();
     cs = cli->cs;
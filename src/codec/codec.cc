@@ -18,7 +18,6 @@
 
 #include <algorithm>
 #include <array>
-#include <unordered_set>
 
 #include "base/glog_wapper.h"
 #include "boost/lexical_cast.hpp"
@@ -28,11 +27,6 @@ namespace codec {
 
 #define BitMapSize(size) (((size) >> 3) + !!((size)&0x07))
 
-static const std::unordered_set<::openmldb::type::DataType> TYPE_SET(
-    {::openmldb::type::kBool, ::openmldb::type::kSmallInt, ::openmldb::type::kInt, ::openmldb::type::kBigInt,
-     ::openmldb::type::kFloat, ::openmldb::type::kDouble, ::openmldb::type::kDate, ::openmldb::type::kTimestamp,
-     ::openmldb::type::kVarchar, ::openmldb::type::kString});
-
 static constexpr std::array<uint32_t, 9> TYPE_SIZE_ARRAY = {
     0,
     sizeof(bool),     // kBool
@@ -57,34 +51,66 @@ static inline uint8_t GetAddrLength(uint32_t size) {
     }
 }
 
-RowBuilder::RowBuilder(const Schema& schema)
-    : schema_(schema),
-      buf_(NULL),
-      cnt_(0),
-      size_(0),
-      str_field_cnt_(0),
-      str_addr_length_(0),
-      str_field_start_offset_(0),
-      str_offset_(0),
-      schema_version_(1) {
+RowLayout::RowLayout(const Schema& schema) : str_field_cnt_(0), str_field_start_offset_(0) {
     str_field_start_offset_ = HEADER_LENGTH + BitMapSize(schema.size());
+    types_.reserve(schema.size());
+    offsets_.reserve(schema.size());
+    not_null_.reserve(schema.size());
     for (int idx = 0; idx < schema.size(); idx++) {
         const ::openmldb::common::ColumnDesc& column = schema.Get(idx);
         openmldb::type::DataType cur_type = column.data_type();
+        types_.push_back(cur_type);
+        not_null_.push_back(column.not_null());
         if (cur_type == ::openmldb::type::kVarchar || cur_type == ::openmldb::type::kString) {
-            offset_vec_.push_back(str_field_cnt_);
+            offsets_.push_back(str_field_cnt_);
             str_field_cnt_++;
+        } else if (cur_type < TYPE_SIZE_ARRAY.size() && cur_type > 0) {
+            offsets_.push_back(str_field_start_offset_);
+            str_field_start_offset_ += TYPE_SIZE_ARRAY[cur_type];
         } else {
-            if (cur_type < TYPE_SIZE_ARRAY.size() && cur_type > 0) {
-                offset_vec_.push_back(str_field_start_offset_);
-                str_field_start_offset_ += TYPE_SIZE_ARRAY[cur_type];
-            } else {
-                PDLOG(WARNING, "type is not supported");
-            }
+            // keep the positions of the other fields, the field can never be appended
+            offsets_.push_back(0);
+            PDLOG(WARNING, "type is not supported");
         }
     }
 }
 
+int32_t RowLayout::GetInteger(const int8_t* row, uint32_t idx, int64_t* val) const {
+    if (idx >= types_.size()) {
+        return -1;
+    }
+    const int8_t* ptr = row + HEADER_LENGTH + (idx >> 3);
+    bool is_null = *(reinterpret_cast<const uint8_t*>(ptr)) & (1 << (idx & 0x07));
+    switch (types_[idx]) {
+        case ::openmldb::type::kSmallInt:
+            *val = is_null ? 0 : v1::GetInt16Field(row, offsets_[idx]);
+            return 0;
+        case ::openmldb::type::kInt:
+            *val = is_null ? 0 : v1::GetInt32Field(row, offsets_[idx]);
+            return 0;
+        case ::openmldb::type::kTimestamp:
+        case ::openmldb::type::kBigInt:
+            *val = is_null ? 0 : v1::GetInt64Field(row, offsets_[idx]);
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+RowBuilder::RowBuilder(const Schema& schema) : RowBuilder(schema, std::make_shared<RowLayout>(schema)) {}
+
+RowBuilder::RowBuilder(const Schema& schema, std::shared_ptr<const RowLayout> layout)
+    : schema_(schema),
+      buf_(NULL),
+      cnt_(0),
+      size_(0),
+      str_field_cnt_(layout->GetStrFieldCnt()),
+      str_addr_length_(0),
+      str_field_start_offset_(layout->GetStrFieldStartOffset()),
+      str_offset_(0),
+      schema_version_(1),
+      layout_(layout) {}
+
 void RowBuilder::SetSchemaVersion(uint8_t version) { schema_version_ = version; }
 
 bool RowBuilder::InitBuffer(int8_t* buf, uint32_t size, bool need_clear) {
@@ -131,17 +157,8 @@ uint32_t RowBuilder::CalTotalLength(uint32_t string_length) {
 }
 
 bool RowBuilder::Check(uint32_t index, ::openmldb::type::DataType type) {
-    if ((int32_t)index >= schema_.size()) {
-        return false;
-    }
-    const ::openmldb::common::ColumnDesc& column = schema_.Get(index);
-    if (column.data_type() != type) {
-        return false;
-    }
-    if (TYPE_SET.find(column.data_type()) == TYPE_SET.end()) {
-        return false;
-    }
-    return true;
+    // the type of each field is kept by the layout, so the schema is not looked up
+    return index < layout_->GetColumnCnt() && layout_->GetType(index) == type;
 }
 
 bool RowBuilder::AppendDate(int32_t date) {
@@ -155,7 +172,7 @@ bool RowBuilder::SetDate(uint32_t index, int32_t date) { return SetDate(buf_, in
 bool RowBuilder::SetDate(int8_t* buf, uint32_t index, int32_t date) {
     if (!Check(index, ::openmldb::type::kDate)) return false;
     SetField(buf, index);
-    int8_t* ptr = buf + offset_vec_[index];
+    int8_t* ptr = buf + layout_->GetOffset(index);
     *(reinterpret_cast<int32_t*>(ptr)) = date;
     return true;
 }
@@ -175,7 +192,7 @@ bool RowBuilder::SetDate(int8_t* buf, uint32_t index, uint32_t year, uint32_t mo
     if (month < 1 || month > 12) return false;
     if (day < 1 || day > 31) return false;
     if (!Check(index, ::openmldb::type::kDate)) return false;
-    int8_t* ptr = buf + offset_vec_[index];
+    int8_t* ptr = buf + layout_->GetOffset(index);
     int32_t data = (year - 1900) << 16;
     data = data | ((month - 1) << 8);
     data = data | day;
@@ -198,25 +215,25 @@ bool RowBuilder::AppendNULL() {
 }
 
 bool RowBuilder::SetNULL(uint32_t index) {
-    const ::openmldb::common::ColumnDesc& column = schema_.Get(index);
-    if (column.not_null()) return false;
+    if (index >= layout_->GetColumnCnt() || layout_->IsNotNull(index)) return false;
     int8_t* ptr = buf_ + HEADER_LENGTH + (index >> 3);
     *(reinterpret_cast<uint8_t*>(ptr)) |= 1 << (index & 0x07);
-    if (column.data_type() == ::openmldb::type::kVarchar || column.data_type() == openmldb::type::kString) {
-        uint32_t str_pos = offset_vec_[index];
+    auto type = layout_->GetType(index);
+    if (type == ::openmldb::type::kVarchar || type == openmldb::type::kString) {
+        uint32_t str_pos = layout_->GetOffset(index);
         SetStrOffset(str_pos + 1);
     }
     return true;
 }
 
 bool RowBuilder::SetNULL(int8_t* buf, uint32_t size, uint32_t index) {
-    const ::openmldb::common::ColumnDesc& column = schema_.Get(index);
-    if (column.not_null()) return false;
+    if (index >= layout_->GetColumnCnt() || layout_->IsNotNull(index)) return false;
     int8_t* ptr = buf + HEADER_LENGTH + (index >> 3);
     *(reinterpret_cast<uint8_t*>(ptr)) |= 1 << (index & 0x07);
-    if (column.data_type() == ::openmldb::type::kVarchar || column.data_type() == openmldb::type::kString) {
+    auto type = layout_->GetType(index);
+    if (type == ::openmldb::type::kVarchar || type == openmldb::type::kString) {
         uint32_t str_offset = 0;
-        uint32_t str_pos = offset_vec_[index];
+        uint32_t str_pos = layout_->GetOffset(index);
         auto str_addr_length = GetAddrLength(size);
         if (str_pos == 0) {
             str_offset = str_field_start_offset_ + str_addr_length * str_field_cnt_;
@@ -284,7 +301,7 @@ bool RowBuilder::SetBool(uint32_t index, bool val) { return SetBool(buf_, index,
 bool RowBuilder::SetBool(int8_t* buf, uint32_t index, bool val) {
     if (!Check(index, ::openmldb::type::kBool)) return false;
     SetField(buf, index);
-    int8_t* ptr = buf + offset_vec_[index];
+    int8_t* ptr = buf + layout_->GetOffset(index);
     *(reinterpret_cast<uint8_t*>(ptr)) = val ? 1 : 0;
     return true;
 }
@@ -300,7 +317,7 @@ bool RowBuilder::SetInt16(uint32_t index, int16_t val) { return SetInt16(buf_, i
 bool RowBuilder::SetInt16(int8_t* buf, uint32_t index, int16_t val) {
     if (!Check(index, ::openmldb::type::kSmallInt)) return false;
     SetField(buf, index);
-    int8_t* ptr = buf + offset_vec_[index];
+    int8_t* ptr = buf + layout_->GetOffset(index);
     *(reinterpret_cast<int16_t*>(ptr)) = val;
     return true;
 }
@@ -316,7 +333,7 @@ bool RowBuilder::SetInt32(uint32_t index, int32_t val) { return SetInt32(buf_, i
 bool RowBuilder::SetInt32(int8_t* buf, uint32_t index, int32_t val) {
     if (!Check(index, ::openmldb::type::kInt)) return false;
     SetField(buf, index);
-    int8_t* ptr = buf + offset_vec_[index];
+    int8_t* ptr = buf + layout_->GetOffset(index);
     *(reinterpret_cast<int32_t*>(ptr)) = val;
     return true;
 }
@@ -332,7 +349,7 @@ bool RowBuilder::SetInt64(uint32_t index, int64_t val) { return SetInt64(buf_, i
 bool RowBuilder::SetInt64(int8_t* buf, uint32_t index, int64_t val) {
     if (!Check(index, ::openmldb::type::kBigInt)) return false;
     SetField(buf, index);
-    int8_t* ptr = buf + offset_vec_[index];
+    int8_t* ptr = buf + layout_->GetOffset(index);
     *(reinterpret_cast<int64_t*>(ptr)) = val;
     return true;
 }
@@ -348,7 +365,7 @@ bool RowBuilder::SetTimestamp(uint32_t index, int64_t val) { return SetTimestamp
 bool RowBuilder::SetTimestamp(int8_t* buf, uint32_t index, int64_t val) {
     if (!Check(index, ::openmldb::type::kTimestamp)) return false;
     SetField(buf, index);
-    int8_t* ptr = buf + offset_vec_[index];
+    int8_t* ptr = buf + layout_->GetOffset(index);
     *(reinterpret_cast<int64_t*>(ptr)) = val;
     return true;
 }
@@ -364,7 +381,7 @@ bool RowBuilder::SetFloat(uint32_t index, float val) { return SetFloat(buf_, ind
 bool RowBuilder::SetFloat(int8_t* buf, uint32_t index, float val) {
     if (!Check(index, ::openmldb::type::kFloat)) return false;
     SetField(buf, index);
-    int8_t* ptr = buf + offset_vec_[index];
+    int8_t* ptr = buf + layout_->GetOffset(index);
     *(reinterpret_cast<float*>(ptr)) = val;
     return true;
 }
@@ -380,7 +397,7 @@ bool RowBuilder::SetDouble(uint32_t index, double val) { return SetDouble(buf_,
 bool RowBuilder::SetDouble(int8_t* buf, uint32_t index, double val) {
     if (!Check(index, ::openmldb::type::kDouble)) return false;
     SetField(buf, index);
-    int8_t* ptr = buf + offset_vec_[index];
+    int8_t* ptr = buf + layout_->GetOffset(index);
     *(reinterpret_cast<double*>(ptr)) = val;
     return true;
 }
@@ -396,7 +413,7 @@ bool RowBuilder::SetString(uint32_t index, const char* val, uint32_t length) {
         return false;
     }
     if (str_offset_ + length > size_) return false;
-    uint32_t str_pos = offset_vec_[index];
+    uint32_t str_pos = layout_->GetOffset(index);
     if (str_pos == 0) {
         SetStrOffset(str_pos);
     }
@@ -414,7 +431,7 @@ bool RowBuilder::SetString(int8_t* buf, uint32_t size, uint32_t index, const cha
         return false;
     }
     uint32_t str_offset = 0;
-    uint32_t str_pos = offset_vec_[index];
+    uint32_t str_pos = layout_->GetOffset(index);
     auto str_addr_length = GetAddrLength(size);
     if (str_pos == 0) {
         str_offset = str_field_start_offset_ + str_addr_length * str_field_cnt_;
@@ -74,9 +74,37 @@ class RowProject {
     uint32_t cur_ver_;
 };
 
+// Types and offsets of the fields of a schema, computed once for a schema version and shared
+// by the builders of its rows, so a field is appended without looking up the schema.
+// The offset of a string field is its position among the string fields.
+class RowLayout {
+ public:
+    explicit RowLayout(const Schema& schema);
+
+    inline uint32_t GetColumnCnt() const { return types_.size(); }
+    inline ::openmldb::type::DataType GetType(uint32_t idx) const { return types_[idx]; }
+    inline uint32_t GetOffset(uint32_t idx) const { return offsets_[idx]; }
+    inline bool IsNotNull(uint32_t idx) const { return not_null_[idx]; }
+    inline uint32_t GetStrFieldCnt() const { return str_field_cnt_; }
+    inline uint32_t GetStrFieldStartOffset() const { return str_field_start_offset_; }
+
+    // read a smallint, int, bigint or timestamp field, null is read as 0.
+    // return -1 if the field is not an integer
+    int32_t GetInteger(const int8_t* row, uint32_t idx, int64_t* val) const;
+
+ private:
+    std::vector<::openmldb::type::DataType> types_;
+    std::vector<uint32_t> offsets_;
+    std::vector<bool> not_null_;
+    uint32_t str_field_cnt_;
+    uint32_t str_field_start_offset_;
+};
+
 class RowBuilder {
  public:
     explicit RowBuilder(const Schema& schema);
+    // layout must be created from the same schema
+    RowBuilder(const Schema& schema, std::shared_ptr<const RowLayout> layout);
 
     uint32_t CalTotalLength(uint32_t string_length);
     bool InitBuffer(int8_t* buf, uint32_t size, bool need_clear);
@@ -141,7 +169,7 @@ class RowBuilder {
     uint32_t str_field_start_offset_;
     uint32_t str_offset_;
     uint8_t schema_version_;
-    std::vector<uint32_t> offset_vec_;
+    std::shared_ptr<const RowLayout> layout_;
 };
 
 class RowView {
@@ -15,8 +15,11 @@
  */
 
 #include <iostream>
+#include <memory>
+#include <string>
 
 #include "base/kv_iterator.h"
+#include "codec/codec.h"
 #include "codec/row_codec.h"
 #include "common/timer.h"
 #include "gtest/gtest.h"
@@ -223,6 +226,64 @@ TEST_F(CodecBenchmarkTest, Decode) {
     std::cout << "Decode protobuf: " << pconsumed / 1000 << std::endl;
 }
 
+TEST_F(CodecBenchmarkTest, SharedLayout) {
+    Schema schema;
+    for (uint32_t i = 0; i < 50; i++) {
+        common::ColumnDesc* col = schema.Add();
+        col->set_name("col" + std::to_string(i));
+        col->set_data_type(i % 2 == 0 ? type::kBigInt : type::kString);
+    }
+    std::string str = "hello";
+    uint32_t str_len = str.size() * 25;
+    auto build = [&](RowBuilder* rb, std::string* row) {
+        row->resize(rb->CalTotalLength(str_len));
+        rb->SetBuffer(reinterpret_cast<int8_t*>(&(*row)[0]), row->size());
+        for (uint32_t i = 0; i < 25; i++) {
+            rb->AppendInt64(i);
+            rb->AppendString(str.c_str(), str.size());
+        }
+    };
+    std::string row;
+    uint64_t consumed = ::baidu::common::timer::get_micros();
+    for (uint32_t i = 0; i < 100000; i++) {
+        // the way of the sdk before, the layout is computed on each row
+        RowBuilder rb(schema);
+        build(&rb, &row);
+    }
+    consumed = ::baidu::common::timer::get_micros() - consumed;
+    auto layout = std::make_shared<const RowLayout>(schema);
+    uint64_t lconsumed = ::baidu::common::timer::get_micros();
+    for (uint32_t i = 0; i < 100000; i++) {
+        RowBuilder rb(schema, layout);
+        build(&rb, &row);
+    }
+    lconsumed = ::baidu::common::timer::get_micros() - lconsumed;
+    std::cout << "build 100000 rows with own layout: " << consumed / 1000 << "ms" << std::endl;
+    std::cout << "build 100000 rows with shared layout: " << lconsumed / 1000 << "ms" << std::endl;
+
+    // read the ts of the last bigint column like the put path of a table
+    const int8_t* data = reinterpret_cast<const int8_t*>(row.data());
+    RowView view(schema);
+    int64_t sum = 0;
+    consumed = ::baidu::common::timer::get_micros();
+    for (uint32_t i = 0; i < 1000000; i++) {
+        int64_t ts = 0;
+        view.GetInteger(data, 48, type::kBigInt, &ts);
+        sum += ts;
+    }
+    consumed = ::baidu::common::timer::get_micros() - consumed;
+    lconsumed = ::baidu::common::timer::get_micros();
+    for (uint32_t i = 0; i < 1000000; i++) {
+        int64_t ts = 0;
+        layout->GetInteger(data, 48, &ts);
+        sum -= ts;
+    }
+    lconsumed = ::baidu::common::timer::get_micros() - lconsumed;
+    ASSERT_EQ(0, sum);
+    std::cout << "get ts of 1000000 rows with row view: " << consumed / 1000 << "ms" << std::endl;
+    std::cout << "get ts of 1000000 rows with layout: " << lconsumed / 1000 << "ms" << std::endl;
+}
+
 }  // namespace codec
 }  // namespace openmldb
 
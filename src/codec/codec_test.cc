@@ -544,6 +544,55 @@ TEST_F(CodecTest, RowBuilderSet) {
     ASSERT_EQ(ret, st);
 }
 
+TEST_F(CodecTest, SharedLayout) {
+    Schema schema;
+    ::openmldb::common::ColumnDesc* col = schema.Add();
+    col->set_name("card");
+    col->set_data_type(::openmldb::type::kString);
+    col = schema.Add();
+    col->set_name("cnt");
+    col->set_data_type(::openmldb::type::kSmallInt);
+    col = schema.Add();
+    col->set_name("ts");
+    col->set_data_type(::openmldb::type::kTimestamp);
+    col = schema.Add();
+    col->set_name("amt");
+    col->set_data_type(::openmldb::type::kDouble);
+    auto layout = std::make_shared<const RowLayout>(schema);
+    ASSERT_EQ(4u, layout->GetColumnCnt());
+    ASSERT_EQ(1u, layout->GetStrFieldCnt());
+    for (int i = 0; i < 3; i++) {
+        RowBuilder builder(schema, layout);
+        uint32_t size = builder.CalTotalLength(4);
+        std::string row(size, '\0');
+        int8_t* row_ptr = reinterpret_cast<int8_t*>(&(row[0]));
+        ASSERT_TRUE(builder.SetBuffer(row_ptr, size));
+        ASSERT_TRUE(builder.AppendString("card", 4));
+        if (i == 2) {
+            ASSERT_TRUE(builder.AppendNULL());
+        } else {
+            ASSERT_TRUE(builder.AppendInt16(i));
+        }
+        ASSERT_TRUE(builder.AppendTimestamp(1000 + i));
+        ASSERT_FALSE(builder.AppendInt64(1));
+        ASSERT_TRUE(builder.AppendDouble(1.5));
+        ASSERT_TRUE(builder.IsComplete());
+
+        RowView view(schema, row_ptr, size);
+        char* ch = NULL;
+        uint32_t ch_length = 0;
+        ASSERT_EQ(0, view.GetString(0, &ch, &ch_length));
+        ASSERT_EQ("card", std::string(ch, ch_length));
+        int64_t ts = 0;
+        ASSERT_EQ(0, layout->GetInteger(row_ptr, 2, &ts));
+        ASSERT_EQ(1000 + i, ts);
+        int64_t cnt = -1;
+        ASSERT_EQ(0, layout->GetInteger(row_ptr, 1, &cnt));
+        ASSERT_EQ(i == 2 ? 0 : i, cnt);
+        ASSERT_EQ(-1, layout->GetInteger(row_ptr, 3, &cnt));
+    }
+}
+
 }  // namespace codec
 }  // namespace openmldb
 
@@ -50,6 +50,14 @@ DEFINE_int32(gc_pool_size, 2, "the size of tablet gc thread pool");
 DEFINE_int32(gc_safe_offset, 1, "the safe offset of tablet gc in minute");
 DEFINE_uint64(gc_on_table_recover_count, 10000000, "make a gc on recover count");
 DEFINE_uint32(gc_deleted_pk_version_delta, 2, "config the gc version delta");
+DEFINE_uint32(gc_segment_thread_num, 4, "the max number of threads to gc the segments of a table in parallel");
+DEFINE_uint32(gc_slice_time_ms, 0,
+              "the time slice of a gc walk over a segment, the walk pauses gc_slice_pause_ms after "
+              "each slice. 0 means the walk never pauses");
+DEFINE_uint32(gc_slice_pause_ms, 5, "the pause between two time slices of a gc walk");
+DEFINE_uint32(gc_expire_index_bucket_ms, 60 * 1000,
+              "the time bucket of the expire index of absolute ttl indexes, which lets gc only visit the "
+              "pks with expired rows. 0 means gc walks over all the pks");
 DEFINE_double(mem_release_rate, 5, "specify memory release rate, which should be in 0 ~ 10");
 DEFINE_int32(task_pool_size, 3, "the size of tablet task thread pool");
 DEFINE_int32(io_pool_size, 2, "the size of tablet io task thread pool");
@@ -95,6 +103,8 @@ DEFINE_int32(request_sleep_time, 1000, "the sleep time when request error");
 
 DEFINE_uint32(max_traverse_cnt, 50000, "max traverse iter loop cnt");
 DEFINE_uint32(traverse_cnt_limit, 1000, "limit traverse cnt");
+DEFINE_uint32(traverse_prefetch_partition_num, 8,
+              "the number of remote partitions a full table scan requests pages from in parallel");
 DEFINE_string(ssd_root_path, "", "the root ssd path of db");
 DEFINE_string(hdd_root_path, "", "the root hdd path of db");
 
@@ -143,6 +153,45 @@ DEFINE_uint32(block_cache_mb, 4096,
 DEFINE_uint32(write_buffer_mb, 128, "Memtable size");
 DEFINE_uint32(block_cache_shardbits, 8, "Divide block cache into 2^8 shards to avoid cache contention");
 DEFINE_bool(verify_compression, false, "For debug");
+DEFINE_bool(disk_row_locator, false,
+            "If true, new disk tables store full rows only in the first index and the other indexes keep "
+            "locators to them");
+DEFINE_uint32(disk_row_cache_mb, 0, "Memory of the row cache used to resolve locators of disk tables, 0 to disable");
+DEFINE_uint32(disk_bloom_bits_per_key, 10,
+              "Bits per key of the prefix bloom filter of disk tables, 0 to disable. "
+              "Can be overridden by bloom_bits_per_key of the table");
+DEFINE_bool(disk_key_meta, true, "If true, new disk tables keep count and ts range of each key to answer count fast");
+DEFINE_uint32(disk_periodic_compaction_hours, 24,
+              "Every file of a disk table with ttl is compacted at least once in this period to drop the expired "
+              "rows, 0 to disable");
+
+// numa
+DEFINE_bool(numa_aware, false,
+            "If true, partitions are placed on numa nodes, and their memory is allocated and their puts and reads "
+            "run on the threads bound to the node");
+DEFINE_uint32(numa_worker_thread_num, 8, "The number of worker threads of each numa node if numa_aware is on");
+
+DEFINE_bool(enable_subplan_parallel, false,
+            "If true, independent subplans of a request query run in parallel bthreads, and the remote sub-queries "
+            "only depending on the request row are issued before the local subplans");
+DEFINE_bool(enable_request_pipeline, false,
+            "If true, the chains of row projects, concats and last joins of a request query run as one pipeline");
+DEFINE_uint32(query_memory_limit_mb, 0,
+              "The max memory in MB held by the intermediate data of one query, a query exceeding it fails. "
+              "0 for unlimited");
+DEFINE_uint32(total_query_memory_limit_mb, 0,
+              "The max memory in MB held by the intermediate data of all running queries, the query making it "
+              "exceeded fails. 0 for unlimited");
+DEFINE_uint32(batch_spill_memory_limit_mb, 0,
+              "The max memory in MB a sort of the window or group aggregation of a batch query buffers before "
+              "spilling the rows to disk. 0 to never spill");
+DEFINE_string(batch_spill_dir, "/tmp", "The directory of the spill files of batch queries");
+DEFINE_bool(enable_deploy_coalescing, false,
+            "If true, the concurrent single row requests of the same deployment are run as one batch request");
+DEFINE_uint32(deploy_coalescing_max_batch, 32, "The max number of requests of a deployment run as one batch");
+DEFINE_uint32(deploy_coalescing_max_wait_us, 200,
+              "The max time in microseconds a deployment request waits for others to run with, the actual wait "
+              "adapts to the request rate of the deployment");
 
 // load table resouce control
 DEFINE_uint32(load_table_batch, 30, "set laod table batch size");
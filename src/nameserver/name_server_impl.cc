@@ -2312,6 +2312,9 @@ int NameServerImpl::CreateTableOnTablet(const std::shared_ptr<::openmldb::namese
     if (table_info->has_key_entry_max_height()) {
         table_meta.set_key_entry_max_height(table_info->key_entry_max_height());
     }
+    if (table_info->has_bloom_bits_per_key()) {
+        table_meta.set_bloom_bits_per_key(table_info->bloom_bits_per_key());
+    }
     for (int idx = 0; idx < table_info->column_desc_size(); idx++) {
         ::openmldb::common::ColumnDesc* column_desc = table_meta.add_column_desc();
         column_desc->CopyFrom(table_info->column_desc(idx));
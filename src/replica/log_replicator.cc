@@ -459,6 +459,31 @@ bool LogReplicator::AppendEntry(LogEntry& entry) {
     return true;
 }
 
+bool LogReplicator::AppendEntries(std::vector<LogEntry>& entries) {
+    std::lock_guard<std::mutex> lock(wmu_);
+    uint64_t cur_offset = log_offset_.load(std::memory_order_relaxed);
+    std::string buffer;
+    for (auto& entry : entries) {
+        if (wh_ == NULL || wh_->GetSize() / (1024 * 1024) > (uint32_t)FLAGS_binlog_single_file_max_size) {
+            if (!RollWLogFile()) {
+                return false;
+            }
+        }
+        entry.set_log_index(1 + cur_offset);
+        entry.SerializeToString(&buffer);
+        ::openmldb::log::Status status = wh_->Write(::openmldb::base::Slice(buffer));
+        if (!status.ok()) {
+            PDLOG(WARNING, "fail to write replication log in dir %s for %s", path_.c_str(), status.ToString().c_str());
+            return false;
+        }
+        cur_offset = log_offset_.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (local_endpoints_.empty()) {
+            follower_offset_.store(cur_offset, std::memory_order_relaxed);
+        }
+    }
+    return true;
+}
+
 bool LogReplicator::RollWLogFile() {
     if (wh_ != NULL) {
         wh_->EndLog();
@@ -66,6 +66,10 @@ class LogReplicator {
     // the master node append entry
     bool AppendEntry(::openmldb::api::LogEntry& entry);  // NOLINT
 
+    // the master node appends a batch of entries under one lock, e.g. the rows of bulk load.
+    // the entries before a failed one are kept
+    bool AppendEntries(std::vector<::openmldb::api::LogEntry>& entries);  // NOLINT
+
     //  data to slave nodes
     void Notify();
     // recover logs meta
@@ -37,6 +37,7 @@
 #include <brpc/retry_policy.h>
 #include <gflags/gflags.h>
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <thread>  // NOLINT
@@ -201,9 +202,15 @@ class RpcCallback : public google::protobuf::Closure {
 
     void Run() override {
         is_done_.store(true, std::memory_order_release);
+        if (done_handler_) {
+            done_handler_();
+        }
         UnRef();
     }
 
+    // called in the rpc thread once the response is received, set it before the request is sent
+    void SetDoneHandler(std::function<void()> handler) { done_handler_ = std::move(handler); }
+
     inline const std::shared_ptr<Response>& GetResponse() const { return response_; }
 
     inline const std::shared_ptr<brpc::Controller>& GetController() const { return cntl_; }
@@ -223,6 +230,7 @@ class RpcCallback : public google::protobuf::Closure {
     std::shared_ptr<brpc::Controller> cntl_;
     std::atomic<bool> is_done_;
     std::atomic<uint32_t> ref_count_;
+    std::function<void()> done_handler_;
 };
 
 }  // namespace openmldb
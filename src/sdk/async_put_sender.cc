@@ -0,0 +1,203 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sdk/async_put_sender.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "brpc/channel.h"
+#include "common/timer.h"
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+
+DECLARE_int32(request_timeout_ms);
+DEFINE_uint32(insert_batch_size, 64, "the max number of rows in one put request of async insert");
+DEFINE_uint32(insert_max_in_flight, 4, "the max number of in-flight put requests per tablet of async insert");
+DEFINE_uint32(insert_max_pending, 4096, "the max number of queued rows per tablet before async insert blocks");
+
+namespace openmldb {
+namespace sdk {
+
+class AsyncPutSender::RowFuture : public InsertFuture {
+ public:
+    explicit RowFuture(uint32_t parts) : remaining_(parts) {}
+
+    bool Get(hybridse::sdk::Status* status) override {
+        std::unique_lock<std::mutex> lock(mu_);
+        cv_.wait(lock, [this] { return remaining_ == 0; });
+        if (status != nullptr) {
+            *status = status_;
+        }
+        return status_.IsOK();
+    }
+
+    bool IsDone() const override {
+        std::lock_guard<std::mutex> lock(mu_);
+        return remaining_ == 0;
+    }
+
+    // one partition of the row is done, `error` is empty if it succeeded
+    void Done(const std::string& error) {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (!error.empty() && status_.IsOK()) {
+            status_ = {::hybridse::common::StatusCode::kCmdError, error};
+        }
+        if (remaining_ > 0 && --remaining_ == 0) {
+            cv_.notify_all();
+        }
+    }
+
+ private:
+    mutable std::mutex mu_;
+    std::condition_variable cv_;
+    uint32_t remaining_;
+    hybridse::sdk::Status status_;
+};
+
+AsyncPutSender::~AsyncPutSender() { Flush(); }
+
+std::shared_ptr<InsertFuture> AsyncPutSender::Submit(
+    uint32_t tid, const std::shared_ptr<SQLInsertRow>& row,
+    const std::vector<std::shared_ptr<::openmldb::catalog::TabletAccessor>>& tablets) {
+    const auto& dimensions = row->GetDimensions();
+    auto future = std::make_shared<RowFuture>(dimensions.size());
+    if (dimensions.empty()) {
+        return future;
+    }
+    uint64_t cur_ts = ::baidu::common::timer::get_micros() / 1000;
+    uint32_t max_pending = std::max(FLAGS_insert_max_pending, 1u);
+    for (const auto& kv : dimensions) {
+        uint32_t pid = kv.first;
+        std::shared_ptr<::openmldb::client::TabletClient> client;
+        if (pid < tablets.size() && tablets[pid]) {
+            client = tablets[pid]->GetClient();
+        }
+        if (!client) {
+            future->Done("fail to get tablet client. pid " + std::to_string(pid));
+            continue;
+        }
+        PendingPut put;
+        put.future = future;
+        put.request.set_time(cur_ts);
+        put.request.set_value(row->GetRow());
+        put.request.set_tid(tid);
+        put.request.set_pid(pid);
+        put.request.set_format_version(1);
+        for (const auto& dim : kv.second) {
+            auto* d = put.request.add_dimensions();
+            d->set_key(dim.first);
+            d->set_idx(dim.second);
+        }
+        std::vector<std::unique_ptr<Batch>> batches;
+        {
+            std::unique_lock<std::mutex> lock(mu_);
+            const std::string& endpoint = client->GetEndpoint();
+            auto& queue = queues_[endpoint];
+            // backpressure, the queue drains as the responses of the tablet come back
+            cv_.wait(lock, [&] { return queue.pending.size() < max_pending; });
+            queue.client = client;
+            queue.pending.push_back(std::move(put));
+            while (auto batch = TakeBatch(endpoint, &queue)) {
+                batches.push_back(std::move(batch));
+            }
+        }
+        for (auto& batch : batches) {
+            Send(std::move(batch));
+        }
+    }
+    return future;
+}
+
+void AsyncPutSender::Flush() {
+    std::unique_lock<std::mutex> lock(mu_);
+    cv_.wait(lock, [this] { return in_flight_ == 0; });
+}
+
+std::unique_ptr<AsyncPutSender::Batch> AsyncPutSender::TakeBatch(const std::string& endpoint, TabletQueue* queue) {
+    if (queue->pending.empty() || queue->in_flight >= std::max(FLAGS_insert_max_in_flight, 1u)) {
+        return nullptr;
+    }
+    auto batch = std::make_unique<Batch>();
+    batch->endpoint = endpoint;
+    batch->client = queue->client;
+    uint32_t batch_size = std::max(FLAGS_insert_batch_size, 1u);
+    while (!queue->pending.empty() && batch->futures.size() < batch_size) {
+        auto& put = queue->pending.front();
+        batch->request.add_put()->Swap(&put.request);
+        batch->futures.push_back(std::move(put.future));
+        queue->pending.pop_front();
+    }
+    queue->in_flight++;
+    in_flight_++;
+    cv_.notify_all();
+    return batch;
+}
+
+void AsyncPutSender::Send(std::unique_ptr<Batch> batch) {
+    auto cntl = std::make_shared<brpc::Controller>();
+    cntl->set_timeout_ms(FLAGS_request_timeout_ms);
+    auto response = std::make_shared<::openmldb::api::BatchPutResponse>();
+    auto callback = new openmldb::RpcCallback<openmldb::api::BatchPutResponse>(response, cntl);
+    // the batch is owned by the done handler, which is destroyed with the callback
+    std::shared_ptr<Batch> shared_batch(std::move(batch));
+    callback->SetDoneHandler([this, shared_batch, cntl, response] {
+        OnDone(*shared_batch, cntl->Failed() ? cntl->ErrorText() : "", response.get());
+    });
+    if (!shared_batch->client->AsyncBatchPut(shared_batch->request, callback)) {
+        callback->UnRef();
+        OnDone(*shared_batch, "fail to send put request to " + shared_batch->endpoint, nullptr);
+    }
+}
+
+void AsyncPutSender::OnDone(const Batch& batch, const std::string& error,
+                            const ::openmldb::api::BatchPutResponse* response) {
+    for (size_t i = 0; i < batch.futures.size(); i++) {
+        const auto& put = batch.request.put(i);
+        std::string msg;
+        if (!error.empty()) {
+            msg = "fail to put row to table. tid " + std::to_string(put.tid()) + ": " + error;
+        } else if (response->code() != 0) {
+            msg = "fail to put row to table. tid " + std::to_string(put.tid()) + ": " + response->msg();
+        } else if (static_cast<int>(i) >= response->put_response_size()) {
+            msg = "fail to put row to table. tid " + std::to_string(put.tid()) + ": missing response";
+        } else if (response->put_response(i).code() != 0) {
+            msg = "fail to put row to table. tid " + std::to_string(put.tid()) + " pid " +
+                  std::to_string(put.pid()) + ": " + response->put_response(i).msg();
+        }
+        if (!msg.empty()) {
+            LOG(WARNING) << msg;
+        }
+        batch.futures[i]->Done(msg);
+    }
+    std::vector<std::unique_ptr<Batch>> batches;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto& queue = queues_[batch.endpoint];
+        queue.in_flight--;
+        in_flight_--;
+        while (auto next = TakeBatch(batch.endpoint, &queue)) {
+            batches.push_back(std::move(next));
+        }
+        cv_.notify_all();
+    }
+    for (auto& next : batches) {
+        Send(std::move(next));
+    }
+}
+
+}  // namespace sdk
+}  // namespace openmldb
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_SDK_ASYNC_PUT_SENDER_H_
+#define SRC_SDK_ASYNC_PUT_SENDER_H_
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "catalog/client_manager.h"
+#include "proto/tablet.pb.h"
+#include "sdk/base.h"
+#include "sdk/sql_insert_row.h"
+#include "sdk/sql_router.h"
+
+namespace openmldb {
+namespace sdk {
+
+/// AsyncPutSender puts rows into tablets without waiting for the responses. The puts of
+/// one tablet are queued and coalesced into BatchPut requests of at most
+/// `FLAGS_insert_batch_size` rows, with at most `FLAGS_insert_max_in_flight` requests in
+/// flight per tablet: a put is sent right away if the window is open, otherwise it waits
+/// in the queue and goes with the next request once a response comes back. Submit blocks
+/// when `FLAGS_insert_max_pending` puts are queued for a tablet, so the callers can not
+/// run ahead of the tablets.
+class AsyncPutSender {
+ public:
+    AsyncPutSender() = default;
+    ~AsyncPutSender();
+
+    /// put the row into all its partitions, the future is done when all the puts are done
+    std::shared_ptr<InsertFuture> Submit(
+        uint32_t tid, const std::shared_ptr<SQLInsertRow>& row,
+        const std::vector<std::shared_ptr<::openmldb::catalog::TabletAccessor>>& tablets);
+
+    /// wait for all the submitted puts
+    void Flush();
+
+ private:
+    class RowFuture;
+
+    struct PendingPut {
+        ::openmldb::api::PutRequest request;
+        std::shared_ptr<RowFuture> future;
+    };
+
+    struct TabletQueue {
+        std::shared_ptr<::openmldb::client::TabletClient> client;
+        std::deque<PendingPut> pending;
+        uint32_t in_flight = 0;
+    };
+
+    struct Batch {
+        std::string endpoint;
+        std::shared_ptr<::openmldb::client::TabletClient> client;
+        ::openmldb::api::BatchPutRequest request;
+        std::vector<std::shared_ptr<RowFuture>> futures;
+    };
+
+    // take the next batch of the queue if its window is open, must hold mu_
+    std::unique_ptr<Batch> TakeBatch(const std::string& endpoint, TabletQueue* queue);
+
+    // send the batch without holding mu_
+    void Send(std::unique_ptr<Batch> batch);
+
+    void OnDone(const Batch& batch, const std::string& error, const ::openmldb::api::BatchPutResponse* response);
+
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::map<std::string, TabletQueue> queues_;
+    uint64_t in_flight_ = 0;
+};
+
+}  // namespace sdk
+}  // namespace openmldb
+#endif  // SRC_SDK_ASYNC_PUT_SENDER_H_
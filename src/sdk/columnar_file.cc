@@ -0,0 +1,528 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sdk/columnar_file.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/time/civil_time.h"
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+
+#include "arrow/api.h"
+#include "arrow/io/file.h"
+#include "arrow/ipc/api.h"
+#include "parquet/arrow/reader.h"
+#include "parquet/arrow/writer.h"
+#include "parquet/exception.h"
+#include "parquet/file_reader.h"
+
+DEFINE_uint32(columnar_file_batch_rows, 65536,
+              "the number of rows in one row group of parquet or one record batch of arrow written by select into");
+
+namespace openmldb {
+namespace sdk {
+
+bool IsColumnarFormat(const std::string& format) { return format == "parquet" || format == "arrow"; }
+
+static const absl::CivilDay kEpochDay(1970, 1, 1);
+
+static std::shared_ptr<arrow::DataType> ToArrowType(hybridse::sdk::DataType type) {
+    switch (type) {
+        case hybridse::sdk::kTypeBool:
+            return arrow::boolean();
+        case hybridse::sdk::kTypeInt16:
+            return arrow::int16();
+        case hybridse::sdk::kTypeInt32:
+            return arrow::int32();
+        case hybridse::sdk::kTypeInt64:
+            return arrow::int64();
+        case hybridse::sdk::kTypeFloat:
+            return arrow::float32();
+        case hybridse::sdk::kTypeDouble:
+            return arrow::float64();
+        case hybridse::sdk::kTypeString:
+            return arrow::utf8();
+        case hybridse::sdk::kTypeDate:
+            return arrow::date32();
+        case hybridse::sdk::kTypeTimestamp:
+            return arrow::timestamp(arrow::TimeUnit::MILLI);
+        default:
+            return nullptr;
+    }
+}
+
+static bool AppendValue(hybridse::sdk::ResultSet* rs, int idx, hybridse::sdk::DataType type,
+                        arrow::ArrayBuilder* builder) {
+    if (rs->IsNULL(idx)) {
+        return builder->AppendNull().ok();
+    }
+    switch (type) {
+        case hybridse::sdk::kTypeBool: {
+            bool val = false;
+            return rs->GetBool(idx, &val) && static_cast<arrow::BooleanBuilder*>(builder)->Append(val).ok();
+        }
+        case hybridse::sdk::kTypeInt16: {
+            int16_t val = 0;
+            return rs->GetInt16(idx, &val) && static_cast<arrow::Int16Builder*>(builder)->Append(val).ok();
+        }
+        case hybridse::sdk::kTypeInt32: {
+            int32_t val = 0;
+            return rs->GetInt32(idx, &val) && static_cast<arrow::Int32Builder*>(builder)->Append(val).ok();
+        }
+        case hybridse::sdk::kTypeInt64: {
+            int64_t val = 0;
+            return rs->GetInt64(idx, &val) && static_cast<arrow::Int64Builder*>(builder)->Append(val).ok();
+        }
+        case hybridse::sdk::kTypeFloat: {
+            float val = 0;
+            return rs->GetFloat(idx, &val) && static_cast<arrow::FloatBuilder*>(builder)->Append(val).ok();
+        }
+        case hybridse::sdk::kTypeDouble: {
+            double val = 0;
+            return rs->GetDouble(idx, &val) && static_cast<arrow::DoubleBuilder*>(builder)->Append(val).ok();
+        }
+        case hybridse::sdk::kTypeString: {
+            std::string val;
+            return rs->GetString(idx, &val) && static_cast<arrow::StringBuilder*>(builder)->Append(val).ok();
+        }
+        case hybridse::sdk::kTypeDate: {
+            int32_t year = 0, month = 0, day = 0;
+            if (!rs->GetDate(idx, &year, &month, &day)) {
+                return false;
+            }
+            int32_t days = static_cast<int32_t>(absl::CivilDay(year, month, day) - kEpochDay);
+            return static_cast<arrow::Date32Builder*>(builder)->Append(days).ok();
+        }
+        case hybridse::sdk::kTypeTimestamp: {
+            int64_t val = 0;
+            return rs->GetTime(idx, &val) && static_cast<arrow::TimestampBuilder*>(builder)->Append(val).ok();
+        }
+        default:
+            return false;
+    }
+}
+
+// write record batches into a parquet file or an arrow ipc file
+class BatchWriter {
+ public:
+    virtual ~BatchWriter() {}
+    virtual arrow::Status Write(const std::shared_ptr<arrow::RecordBatch>& batch) = 0;
+    virtual arrow::Status Close() = 0;
+};
+
+class ParquetBatchWriter : public BatchWriter {
+ public:
+    explicit ParquetBatchWriter(std::unique_ptr<parquet::arrow::FileWriter> writer) : writer_(std::move(writer)) {}
+    arrow::Status Write(const std::shared_ptr<arrow::RecordBatch>& batch) override {
+        auto table = arrow::Table::FromRecordBatches({batch});
+        if (!table.ok()) {
+            return table.status();
+        }
+        // one row group per batch
+        return writer_->WriteTable(**table, std::max<int64_t>(batch->num_rows(), 1));
+    }
+    arrow::Status Close() override { return writer_->Close(); }
+
+ private:
+    std::unique_ptr<parquet::arrow::FileWriter> writer_;
+};
+
+class IpcBatchWriter : public BatchWriter {
+ public:
+    explicit IpcBatchWriter(std::shared_ptr<arrow::ipc::RecordBatchWriter> writer) : writer_(std::move(writer)) {}
+    arrow::Status Write(const std::shared_ptr<arrow::RecordBatch>& batch) override {
+        return writer_->WriteRecordBatch(*batch);
+    }
+    arrow::Status Close() override { return writer_->Close(); }
+
+ private:
+    std::shared_ptr<arrow::ipc::RecordBatchWriter> writer_;
+};
+
+static ::openmldb::base::Status ToStatus(const arrow::Status& st) {
+    return {::openmldb::base::kSQLCmdRunError, "ERROR: " + st.ToString()};
+}
+
+::openmldb::base::Status WriteColumnarFile(const std::string& format, const std::string& file_path,
+                                           ::hybridse::sdk::ResultSet* result_set) {
+    if (!IsColumnarFormat(format)) {
+        return {::openmldb::base::kSQLCmdRunError, "ERROR: unsupported format " + format};
+    }
+    const auto* schema = result_set->GetSchema();
+    if (schema == nullptr) {
+        return {::openmldb::base::kSQLCmdRunError, "ERROR: result set has no schema"};
+    }
+    int cnt = schema->GetColumnCnt();
+    std::vector<hybridse::sdk::DataType> types;
+    arrow::FieldVector fields;
+    std::vector<std::unique_ptr<arrow::ArrayBuilder>> builders(cnt);
+    for (int i = 0; i < cnt; i++) {
+        auto type = ToArrowType(schema->GetColumnType(i));
+        if (!type) {
+            return {::openmldb::base::kSQLCmdRunError,
+                    "ERROR: unsupported type of column " + schema->GetColumnName(i) + " in " + format};
+        }
+        auto st = arrow::MakeBuilder(arrow::default_memory_pool(), type, &builders[i]);
+        if (!st.ok()) {
+            return ToStatus(st);
+        }
+        types.push_back(schema->GetColumnType(i));
+        fields.push_back(arrow::field(schema->GetColumnName(i), type, !schema->IsColumnNotNull(i)));
+    }
+    auto arrow_schema = arrow::schema(fields);
+    auto sink = arrow::io::FileOutputStream::Open(file_path);
+    if (!sink.ok()) {
+        return {::openmldb::base::kSQLCmdRunError, "Failed to open file, please check file path"};
+    }
+    std::unique_ptr<BatchWriter> writer;
+    if (format == "parquet") {
+        auto props = parquet::WriterProperties::Builder().compression(parquet::Compression::SNAPPY)->build();
+        auto file_writer =
+            parquet::arrow::FileWriter::Open(*arrow_schema, arrow::default_memory_pool(), *sink, props);
+        if (!file_writer.ok()) {
+            return ToStatus(file_writer.status());
+        }
+        writer.reset(new ParquetBatchWriter(std::move(*file_writer)));
+    } else {
+        auto ipc_writer = arrow::ipc::MakeFileWriter(*sink, arrow_schema);
+        if (!ipc_writer.ok()) {
+            return ToStatus(ipc_writer.status());
+        }
+        writer.reset(new IpcBatchWriter(*ipc_writer));
+    }
+    uint32_t batch_rows = std::max(FLAGS_columnar_file_batch_rows, 1u);
+    auto flush = [&](int64_t num_rows) -> arrow::Status {
+        arrow::ArrayVector arrays(cnt);
+        for (int i = 0; i < cnt; i++) {
+            auto st = builders[i]->Finish(&arrays[i]);
+            if (!st.ok()) {
+                return st;
+            }
+        }
+        return writer->Write(arrow::RecordBatch::Make(arrow_schema, num_rows, arrays));
+    };
+    int64_t pending = 0;
+    if (result_set->Size() != 0) {
+        while (result_set->Next()) {
+            for (int i = 0; i < cnt; i++) {
+                if (!AppendValue(result_set, i, types[i], builders[i].get())) {
+                    return {::openmldb::base::kSQLCmdRunError, "Failed to get result set value"};
+                }
+            }
+            if (++pending == batch_rows) {
+                auto st = flush(pending);
+                if (!st.ok()) {
+                    return ToStatus(st);
+                }
+                pending = 0;
+            }
+        }
+    }
+    if (pending > 0) {
+        auto st = flush(pending);
+        if (!st.ok()) {
+            return ToStatus(st);
+        }
+    }
+    auto st = writer->Close();
+    if (!st.ok()) {
+        return ToStatus(st);
+    }
+    st = (*sink)->Close();
+    if (!st.ok()) {
+        return ToStatus(st);
+    }
+    return {};
+}
+
+static hybridse::sdk::Status ReadError(const std::string& msg) {
+    return {::hybridse::common::StatusCode::kCmdError, msg};
+}
+
+class ArrowFileReaderBase : public ColumnarFileReader {
+ public:
+    explicit ArrowFileReaderBase(const std::string& file_path) : file_path_(file_path) {}
+
+    hybridse::sdk::Status Bind(const hybridse::sdk::Schema& schema) override {
+        int cnt = schema.GetColumnCnt();
+        if (cnt != schema_->num_fields()) {
+            return ReadError("col size mismatch, table has " + std::to_string(cnt) + " columns but file has " +
+                             std::to_string(schema_->num_fields()));
+        }
+        file_cols_.clear();
+        types_.clear();
+        not_null_.clear();
+        str_cols_idx_.clear();
+        for (int i = 0; i < cnt; i++) {
+            const auto& name = schema.GetColumnName(i);
+            int file_col = schema_->GetFieldIndex(name);
+            if (file_col < 0) {
+                return ReadError("column " + name + " is not found in file");
+            }
+            auto expect = ToArrowType(schema.GetColumnType(i));
+            const auto& actual = schema_->field(file_col)->type();
+            // timestamps of any unit are converted to milliseconds
+            if (!expect || expect->id() != actual->id()) {
+                return ReadError("column " + name + " type mismatch, table type " +
+                                 (expect ? expect->ToString() : "unknown") + " file type " + actual->ToString());
+            }
+            file_cols_.push_back(file_col);
+            types_.push_back(schema.GetColumnType(i));
+            not_null_.push_back(schema.IsColumnNotNull(i));
+            if (schema.GetColumnType(i) == hybridse::sdk::kTypeString) {
+                str_cols_idx_.push_back(i);
+            }
+        }
+        return {};
+    }
+
+    hybridse::sdk::Status ReadBatch(int idx, const InsertRowFactory& factory,
+                                    std::vector<std::shared_ptr<SQLInsertRow>>* rows) override {
+        std::shared_ptr<arrow::Table> table;
+        auto status = ReadTable(idx, &table);
+        if (!status.IsOK()) {
+            return status;
+        }
+        auto combined = table->CombineChunks();
+        if (!combined.ok()) {
+            return ReadError(combined.status().ToString());
+        }
+        std::vector<std::shared_ptr<arrow::Array>> cols;
+        for (auto file_col : file_cols_) {
+            auto column = (*combined)->column(file_col);
+            if (column->num_chunks() == 0) {
+                return {};
+            }
+            cols.push_back(column->chunk(0));
+        }
+        int64_t num_rows = (*combined)->num_rows();
+        rows->reserve(num_rows);
+        for (int64_t r = 0; r < num_rows; r++) {
+            uint32_t str_len_sum = 0;
+            for (auto i : str_cols_idx_) {
+                if (!cols[i]->IsNull(r)) {
+                    str_len_sum += static_cast<const arrow::StringArray&>(*cols[i]).value_length(r);
+                }
+            }
+            auto row = factory();
+            row->Init(static_cast<int>(str_len_sum));
+            for (size_t i = 0; i < cols.size(); i++) {
+                if (!AppendColumn(*cols[i], r, types_[i], not_null_[i], row.get())) {
+                    return ReadError("row [" + std::to_string(r) + "] of batch [" + std::to_string(idx) +
+                                     "] insert failed, translate to insert row failed");
+                }
+            }
+            rows->push_back(std::move(row));
+        }
+        return {};
+    }
+
+ protected:
+    virtual hybridse::sdk::Status ReadTable(int idx, std::shared_ptr<arrow::Table>* table) = 0;
+
+ private:
+    static bool AppendColumn(const arrow::Array& array, int64_t r, hybridse::sdk::DataType type, bool not_null,
+                             SQLInsertRow* row) {
+        if (array.IsNull(r)) {
+            return !not_null && row->AppendNULL();
+        }
+        switch (type) {
+            case hybridse::sdk::kTypeBool:
+                return row->AppendBool(static_cast<const arrow::BooleanArray&>(array).Value(r));
+            case hybridse::sdk::kTypeInt16:
+                return row->AppendInt16(static_cast<const arrow::Int16Array&>(array).Value(r));
+            case hybridse::sdk::kTypeInt32:
+                return row->AppendInt32(static_cast<const arrow::Int32Array&>(array).Value(r));
+            case hybridse::sdk::kTypeInt64:
+                return row->AppendInt64(static_cast<const arrow::Int64Array&>(array).Value(r));
+            case hybridse::sdk::kTypeFloat:
+                return row->AppendFloat(static_cast<const arrow::FloatArray&>(array).Value(r));
+            case hybridse::sdk::kTypeDouble:
+                return row->AppendDouble(static_cast<const arrow::DoubleArray&>(array).Value(r));
+            case hybridse::sdk::kTypeString: {
+                auto view = static_cast<const arrow::StringArray&>(array).GetView(r);
+                return row->AppendString(view.data(), static_cast<uint32_t>(view.size()));
+            }
+            case hybridse::sdk::kTypeDate: {
+                auto day = kEpochDay + static_cast<const arrow::Date32Array&>(array).Value(r);
+                return row->AppendDate(static_cast<uint32_t>(day.year()), static_cast<uint32_t>(day.month()),
+                                       static_cast<uint32_t>(day.day()));
+            }
+            case hybridse::sdk::kTypeTimestamp: {
+                const auto& ts_array = static_cast<const arrow::TimestampArray&>(array);
+                int64_t val = ts_array.Value(r);
+                switch (static_cast<const arrow::TimestampType&>(*ts_array.type()).unit()) {
+                    case arrow::TimeUnit::SECOND:
+                        val *= 1000;
+                        break;
+                    case arrow::TimeUnit::MICRO:
+                        val /= 1000;
+                        break;
+                    case arrow::TimeUnit::NANO:
+                        val /= 1000000;
+                        break;
+                    default:
+                        break;
+                }
+                return row->AppendTimestamp(val);
+            }
+            default:
+                return false;
+        }
+    }
+
+ protected:
+    std::string file_path_;
+    std::shared_ptr<arrow::Schema> schema_;
+
+ private:
+    std::vector<int> file_cols_;
+    std::vector<hybridse::sdk::DataType> types_;
+    std::vector<bool> not_null_;
+    std::vector<int> str_cols_idx_;
+};
+
+class ParquetFileReader : public ArrowFileReaderBase {
+ public:
+    using ArrowFileReaderBase::ArrowFileReaderBase;
+
+    hybridse::sdk::Status Init() {
+        try {
+            auto file = arrow::io::ReadableFile::Open(file_path_);
+            if (!file.ok()) {
+                return ReadError(file.status().ToString());
+            }
+            auto parquet_reader = parquet::ParquetFileReader::Open(*file);
+            metadata_ = parquet_reader->metadata();
+            std::unique_ptr<parquet::arrow::FileReader> reader;
+            auto st = parquet::arrow::FileReader::Make(arrow::default_memory_pool(), std::move(parquet_reader),
+                                                       &reader);
+            if (!st.ok()) {
+                return ReadError(st.ToString());
+            }
+            st = reader->GetSchema(&schema_);
+            if (!st.ok()) {
+                return ReadError(st.ToString());
+            }
+        } catch (const parquet::ParquetException& e) {
+            return ReadError(e.what());
+        }
+        return {};
+    }
+
+    int BatchCount() const override { return metadata_->num_row_groups(); }
+
+ protected:
+    hybridse::sdk::Status ReadTable(int idx, std::shared_ptr<arrow::Table>* table) override {
+        // every batch opens its own reader to read in parallel, the footer is parsed only once
+        try {
+            auto file = arrow::io::ReadableFile::Open(file_path_);
+            if (!file.ok()) {
+                return ReadError(file.status().ToString());
+            }
+            auto parquet_reader =
+                parquet::ParquetFileReader::Open(*file, parquet::default_reader_properties(), metadata_);
+            std::unique_ptr<parquet::arrow::FileReader> reader;
+            auto st = parquet::arrow::FileReader::Make(arrow::default_memory_pool(), std::move(parquet_reader),
+                                                       &reader);
+            if (st.ok()) {
+                st = reader->ReadRowGroup(idx, table);
+            }
+            if (!st.ok()) {
+                return ReadError(st.ToString());
+            }
+        } catch (const parquet::ParquetException& e) {
+            return ReadError(e.what());
+        }
+        return {};
+    }
+
+ private:
+    std::shared_ptr<parquet::FileMetaData> metadata_;
+};
+
+class IpcFileReader : public ArrowFileReaderBase {
+ public:
+    using ArrowFileReaderBase::ArrowFileReaderBase;
+
+    hybridse::sdk::Status Init() {
+        auto reader = OpenReader();
+        if (!reader.ok()) {
+            return ReadError(reader.status().ToString());
+        }
+        schema_ = (*reader)->schema();
+        batch_count_ = (*reader)->num_record_batches();
+        return {};
+    }
+
+    int BatchCount() const override { return batch_count_; }
+
+ protected:
+    hybridse::sdk::Status ReadTable(int idx, std::shared_ptr<arrow::Table>* table) override {
+        auto reader = OpenReader();
+        if (!reader.ok()) {
+            return ReadError(reader.status().ToString());
+        }
+        auto batch = (*reader)->ReadRecordBatch(idx);
+        if (!batch.ok()) {
+            return ReadError(batch.status().ToString());
+        }
+        auto result = arrow::Table::FromRecordBatches({*batch});
+        if (!result.ok()) {
+            return ReadError(result.status().ToString());
+        }
+        *table = *result;
+        return {};
+    }
+
+ private:
+    arrow::Result<std::shared_ptr<arrow::ipc::RecordBatchFileReader>> OpenReader() {
+        auto file = arrow::io::ReadableFile::Open(file_path_);
+        if (!file.ok()) {
+            return file.status();
+        }
+        return arrow::ipc::RecordBatchFileReader::Open(*file);
+    }
+
+    int batch_count_ = 0;
+};
+
+std::unique_ptr<ColumnarFileReader> ColumnarFileReader::Open(const std::string& format,
+                                                             const std::string& file_path,
+                                                             hybridse::sdk::Status* status) {
+    if (format == "parquet") {
+        auto reader = std::make_unique<ParquetFileReader>(file_path);
+        *status = reader->Init();
+        if (status->IsOK()) {
+            return reader;
+        }
+    } else if (format == "arrow") {
+        auto reader = std::make_unique<IpcFileReader>(file_path);
+        *status = reader->Init();
+        if (status->IsOK()) {
+            return reader;
+        }
+    } else {
+        *status = ReadError("unsupported format " + format);
+    }
+    LOG(WARNING) << "fail to open " << file_path << " as " << format << ": " << status->msg;
+    return nullptr;
+}
+
+}  // namespace sdk
+}  // namespace openmldb
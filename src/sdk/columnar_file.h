@@ -0,0 +1,69 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_SDK_COLUMNAR_FILE_H_
+#define SRC_SDK_COLUMNAR_FILE_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/status.h"
+#include "sdk/base.h"
+#include "sdk/result_set.h"
+#include "sdk/sql_insert_row.h"
+
+namespace openmldb {
+namespace sdk {
+
+// the formats of select into and load data besides csv
+bool IsColumnarFormat(const std::string& format);
+
+/// write all the rows of `result_set` into `file_path` as a parquet file or an arrow
+/// ipc file. Rows are appended to column builders and every
+/// `FLAGS_columnar_file_batch_rows` rows are flushed as one row group (parquet) or
+/// one record batch (arrow), so the memory does not grow with the result size.
+::openmldb::base::Status WriteColumnarFile(const std::string& format, const std::string& file_path,
+                                           ::hybridse::sdk::ResultSet* result_set);
+
+using InsertRowFactory = std::function<std::shared_ptr<SQLInsertRow>()>;
+
+/// ColumnarFileReader reads a parquet file or an arrow ipc file in batches, one row group
+/// or one record batch per batch. The batches are independent, so they can be decoded
+/// by many threads at the same time.
+class ColumnarFileReader {
+ public:
+    static std::unique_ptr<ColumnarFileReader> Open(const std::string& format, const std::string& file_path,
+                                                    hybridse::sdk::Status* status);
+
+    virtual ~ColumnarFileReader() {}
+
+    virtual int BatchCount() const = 0;
+
+    /// bind the columns of the table to the columns of the file by name, the types
+    /// of the bound columns must match
+    virtual hybridse::sdk::Status Bind(const hybridse::sdk::Schema& schema) = 0;
+
+    /// decode the `idx`-th batch into insert rows, thread safe after Bind. On failure,
+    /// `rows` holds the rows before the malformed one.
+    virtual hybridse::sdk::Status ReadBatch(int idx, const InsertRowFactory& factory,
+                                            std::vector<std::shared_ptr<SQLInsertRow>>* rows) = 0;
+};
+
+}  // namespace sdk
+}  // namespace openmldb
+#endif  // SRC_SDK_COLUMNAR_FILE_H_
@@ -0,0 +1,210 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sdk/columnar_result_set.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "absl/time/civil_time.h"
+#include "glog/logging.h"
+
+namespace openmldb {
+namespace sdk {
+
+static const absl::CivilDay kEpochDay(1970, 1, 1);
+static const std::string kEmptyName;  // NOLINT
+
+// the byte width of a value, 0 for variable width strings
+static size_t ValueWidth(hybridse::sdk::DataType type) {
+    switch (type) {
+        case hybridse::sdk::kTypeBool:
+            return sizeof(uint8_t);
+        case hybridse::sdk::kTypeInt16:
+            return sizeof(int16_t);
+        case hybridse::sdk::kTypeInt32:
+        case hybridse::sdk::kTypeDate:
+            return sizeof(int32_t);
+        case hybridse::sdk::kTypeInt64:
+        case hybridse::sdk::kTypeTimestamp:
+            return sizeof(int64_t);
+        case hybridse::sdk::kTypeFloat:
+            return sizeof(float);
+        case hybridse::sdk::kTypeDouble:
+            return sizeof(double);
+        default:
+            return 0;
+    }
+}
+
+std::shared_ptr<ColumnarResultSet> ColumnarResultSet::Make(
+    const std::shared_ptr<hybridse::sdk::ResultSet>& result_set, hybridse::sdk::Status* status) {
+    if (status == nullptr) {
+        return nullptr;
+    }
+    if (!result_set || result_set->GetSchema() == nullptr) {
+        *status = {::hybridse::common::StatusCode::kCmdError, "result set is null"};
+        return nullptr;
+    }
+    const auto* schema = result_set->GetSchema();
+    std::shared_ptr<ColumnarResultSet> columnar(new ColumnarResultSet());
+    int64_t rows = std::max(result_set->Size(), 0);
+    columnar->columns_.resize(schema->GetColumnCnt());
+    for (int i = 0; i < schema->GetColumnCnt(); i++) {
+        auto& column = columnar->columns_[i];
+        column.name = schema->GetColumnName(i);
+        column.type = schema->GetColumnType(i);
+        column.validity.assign((rows + 7) / 8, 0);
+        if (column.type == hybridse::sdk::kTypeString) {
+            column.offsets.reserve(rows + 1);
+            column.offsets.push_back(0);
+        } else if (ValueWidth(column.type) > 0) {
+            column.values.assign(rows * ValueWidth(column.type), 0);
+        } else {
+            *status = {::hybridse::common::StatusCode::kCmdError,
+                       "unsupported type of column " + column.name};
+            return nullptr;
+        }
+    }
+    result_set->Reset();
+    while (columnar->size_ < rows && result_set->Next()) {
+        if (!columnar->AppendRow(result_set.get())) {
+            *status = {::hybridse::common::StatusCode::kCmdError,
+                       "fail to decode row " + std::to_string(columnar->size_)};
+            return nullptr;
+        }
+    }
+    if (columnar->size_ != rows) {
+        // the fixed width values were sized for all the rows
+        *status = {::hybridse::common::StatusCode::kCmdError, "result set ends at row " +
+                                                                  std::to_string(columnar->size_) + " of " +
+                                                                  std::to_string(rows)};
+        return nullptr;
+    }
+    *status = {};
+    return columnar;
+}
+
+bool ColumnarResultSet::AppendRow(hybridse::sdk::ResultSet* result_set) {
+    int64_t row = size_;
+    for (size_t i = 0; i < columns_.size(); i++) {
+        auto& column = columns_[i];
+        if (result_set->IsNULL(i)) {
+            column.null_count++;
+            if (column.type == hybridse::sdk::kTypeString) {
+                column.offsets.push_back(column.offsets.back());
+            }
+            continue;
+        }
+        column.validity[row >> 3] |= static_cast<uint8_t>(1u << (row & 7));
+        char* value = column.values.data() + row * ValueWidth(column.type);
+        bool ok = true;
+        switch (column.type) {
+            case hybridse::sdk::kTypeBool: {
+                bool val = false;
+                ok = result_set->GetBool(i, &val);
+                *reinterpret_cast<uint8_t*>(value) = val ? 1 : 0;
+                break;
+            }
+            case hybridse::sdk::kTypeInt16:
+                ok = result_set->GetInt16(i, reinterpret_cast<int16_t*>(value));
+                break;
+            case hybridse::sdk::kTypeInt32:
+                ok = result_set->GetInt32(i, reinterpret_cast<int32_t*>(value));
+                break;
+            case hybridse::sdk::kTypeInt64:
+                ok = result_set->GetInt64(i, reinterpret_cast<int64_t*>(value));
+                break;
+            case hybridse::sdk::kTypeFloat:
+                ok = result_set->GetFloat(i, reinterpret_cast<float*>(value));
+                break;
+            case hybridse::sdk::kTypeDouble:
+                ok = result_set->GetDouble(i, reinterpret_cast<double*>(value));
+                break;
+            case hybridse::sdk::kTypeTimestamp:
+                ok = result_set->GetTime(i, reinterpret_cast<int64_t*>(value));
+                break;
+            case hybridse::sdk::kTypeDate: {
+                int32_t year = 0, month = 0, day = 0;
+                ok = result_set->GetDate(i, &year, &month, &day);
+                int32_t days = static_cast<int32_t>(absl::CivilDay(year, month, day) - kEpochDay);
+                memcpy(value, &days, sizeof(days));
+                break;
+            }
+            case hybridse::sdk::kTypeString: {
+                std::string val;
+                ok = result_set->GetString(i, &val);
+                int64_t end = static_cast<int64_t>(column.values.size()) + val.size();
+                if (end > std::numeric_limits<int32_t>::max()) {
+                    LOG(WARNING) << "string data of column " << column.name << " exceeds 2GB";
+                    return false;
+                }
+                column.values.insert(column.values.end(), val.begin(), val.end());
+                column.offsets.push_back(static_cast<int32_t>(end));
+                break;
+            }
+            default:
+                ok = false;
+                break;
+        }
+        if (!ok) {
+            LOG(WARNING) << "fail to get value of column " << column.name << " at row " << row;
+            return false;
+        }
+    }
+    size_++;
+    return true;
+}
+
+const std::string& ColumnarResultSet::GetColumnName(uint32_t index) const {
+    return index < columns_.size() ? columns_[index].name : kEmptyName;
+}
+
+hybridse::sdk::DataType ColumnarResultSet::GetColumnType(uint32_t index) const {
+    return index < columns_.size() ? columns_[index].type : hybridse::sdk::kTypeUnknow;
+}
+
+int64_t ColumnarResultSet::GetNullCount(uint32_t index) const {
+    return index < columns_.size() ? columns_[index].null_count : 0;
+}
+
+ColumnBuffer ColumnarResultSet::GetValues(uint32_t index) const {
+    if (index >= columns_.size()) {
+        return {};
+    }
+    const auto& values = columns_[index].values;
+    return {values.data(), static_cast<int64_t>(values.size()), shared_from_this()};
+}
+
+ColumnBuffer ColumnarResultSet::GetValidity(uint32_t index) const {
+    if (index >= columns_.size()) {
+        return {};
+    }
+    const auto& validity = columns_[index].validity;
+    return {validity.data(), static_cast<int64_t>(validity.size()), shared_from_this()};
+}
+
+ColumnBuffer ColumnarResultSet::GetOffsets(uint32_t index) const {
+    if (index >= columns_.size()) {
+        return {};
+    }
+    const auto& offsets = columns_[index].offsets;
+    return {offsets.data(), static_cast<int64_t>(offsets.size() * sizeof(int32_t)), shared_from_this()};
+}
+
+}  // namespace sdk
+}  // namespace openmldb
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_SDK_COLUMNAR_RESULT_SET_H_
+#define SRC_SDK_COLUMNAR_RESULT_SET_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sdk/base.h"
+#include "sdk/result_set.h"
+
+namespace openmldb {
+namespace sdk {
+
+// a contiguous buffer of ColumnarResultSet, it keeps the result set alive
+struct ColumnBuffer {
+    const void* data = nullptr;
+    int64_t size = 0;
+    std::shared_ptr<const void> owner;
+};
+
+/// ColumnarResultSet holds all the rows of a result set column by column, so the
+/// bindings can hand whole columns to numpy, pandas or java vectors instead of calling
+/// a getter per cell. The buffers follow the arrow columnar format:
+///   - values: `Size()` values of the column type, bool as one byte per value, date as
+///     int32 days since 1970-01-01, timestamp as int64 milliseconds
+///   - validity: a bitmap with bit i (lsb first) set if the i-th value is not null
+///   - string: `Size() + 1` int32 offsets into the utf8 data of the column
+/// The value of a null cell is zero, or an empty string.
+class ColumnarResultSet : public std::enable_shared_from_this<ColumnarResultSet> {
+ public:
+    /// decode all the rows of `result_set` from the beginning, the cursor of `result_set`
+    /// is at the end after that
+    static std::shared_ptr<ColumnarResultSet> Make(const std::shared_ptr<hybridse::sdk::ResultSet>& result_set,
+                                                   hybridse::sdk::Status* status);
+
+    int32_t GetColumnCnt() const { return static_cast<int32_t>(columns_.size()); }
+
+    int64_t Size() const { return size_; }
+
+    const std::string& GetColumnName(uint32_t index) const;
+
+    hybridse::sdk::DataType GetColumnType(uint32_t index) const;
+
+    int64_t GetNullCount(uint32_t index) const;
+
+    ColumnBuffer GetValues(uint32_t index) const;
+
+    ColumnBuffer GetValidity(uint32_t index) const;
+
+    // empty for the columns but strings
+    ColumnBuffer GetOffsets(uint32_t index) const;
+
+ private:
+    struct Column {
+        std::string name;
+        hybridse::sdk::DataType type;
+        int64_t null_count = 0;
+        std::vector<uint8_t> validity;
+        std::vector<char> values;
+        std::vector<int32_t> offsets;
+    };
+
+    ColumnarResultSet() = default;
+
+    bool AppendRow(hybridse::sdk::ResultSet* result_set);
+
+    std::vector<Column> columns_;
+    int64_t size_ = 0;
+};
+
+}  // namespace sdk
+}  // namespace openmldb
+#endif  // SRC_SDK_COLUMNAR_RESULT_SET_H_
@@ -98,7 +98,8 @@ class FileOptionsParser {
     std::function<bool(const hybridse::node::ConstNode* node)> CheckFormat() {
         return [this](const hybridse::node::ConstNode* node) {
             format_ = node->GetAsString();
-            if (format_ != "csv") {
+            // parquet and arrow files are checked when they are opened, see columnar_file.h
+            if (format_ != "csv" && format_ != "parquet" && format_ != "arrow") {
                 return false;
             }
             return true;
@@ -145,7 +146,24 @@ class FileOptionsParser {
 
 class ReadFileOptionsParser : public FileOptionsParser {
  public:
-    ReadFileOptionsParser() { quote_ = '\0'; }
+    ReadFileOptionsParser() {
+        quote_ = '\0';
+        check_map_.emplace("thread", std::make_pair(CheckThread(), hybridse::node::kInt32));
+    }
+    uint32_t GetThread() const { return thread_; }
+
+ private:
+    uint32_t thread_ = 1;
+    std::function<bool(const hybridse::node::ConstNode* node)> CheckThread() {
+        return [this](const hybridse::node::ConstNode* node) {
+            auto thread = node->GetInt();
+            if (thread <= 0) {
+                return false;
+            }
+            thread_ = thread;
+            return true;
+        };
+    }
 };
 
 class WriteFileOptionsParser : public FileOptionsParser {
@@ -0,0 +1,361 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sdk/load_data_pipeline.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/taskpool.hpp"
+#include "boost/bind.hpp"
+#include "brpc/channel.h"
+#include "codec/field_codec.h"
+#include "common/timer.h"
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "sdk/split.h"
+
+DECLARE_int32(request_timeout_ms);
+DEFINE_uint32(load_data_batch_lines, 1000, "the number of lines in one parse task of load data");
+DEFINE_uint32(load_data_put_window, 64, "the max number of in-flight put requests per partition of load data");
+DEFINE_uint32(load_data_report_interval_ms, 10000, "the interval of load data progress report");
+
+namespace openmldb {
+namespace sdk {
+
+LoadDataPipeline::LoadDataPipeline(std::shared_ptr<::openmldb::nameserver::TableInfo> table_info,
+                                   std::shared_ptr<hybridse::sdk::Schema> schema, DefaultValueMap default_map,
+                                   uint32_t default_str_length,
+                                   const std::vector<std::shared_ptr<::openmldb::catalog::TabletAccessor>>& tablets,
+                                   const LoadDataOptions& options)
+    : table_info_(table_info),
+      schema_(schema),
+      default_map_(default_map),
+      default_str_length_(default_str_length),
+      tablets_(tablets),
+      options_(options),
+      str_cols_idx_(),
+      reader_(nullptr),
+      mu_(),
+      cv_(),
+      parsed_(),
+      stop_parse_(false),
+      in_flight_(tablets.size()),
+      put_failed_(false),
+      loaded_rows_(0),
+      start_ms_(0),
+      last_report_ms_(0),
+      cost_ms_(0) {
+    for (int i = 0; i < schema_->GetColumnCnt(); ++i) {
+        if (schema_->GetColumnType(i) == hybridse::sdk::kTypeString) {
+            str_cols_idx_.emplace_back(i);
+        }
+    }
+}
+
+hybridse::sdk::Status LoadDataPipeline::Run(const std::string& first_line, std::istream* file) {
+    if (file == nullptr) {
+        return {::hybridse::common::StatusCode::kCmdError, "file is null"};
+    }
+    uint32_t batch_lines = std::max(FLAGS_load_data_batch_lines, 1u);
+    bool first = true;
+    return RunBatches([&](LineBatch* batch) {
+        batch->lines.reserve(batch_lines);
+        if (first) {
+            batch->lines.push_back(first_line);
+            first = false;
+        }
+        std::string line;
+        while (batch->lines.size() < batch_lines && std::getline(*file, line)) {
+            batch->lines.push_back(std::move(line));
+        }
+        return batch->lines.size() == batch_lines;
+    });
+}
+
+hybridse::sdk::Status LoadDataPipeline::Run(ColumnarFileReader* reader) {
+    if (reader == nullptr) {
+        return {::hybridse::common::StatusCode::kCmdError, "file is null"};
+    }
+    reader_ = reader;
+    int count = reader->BatchCount();
+    int next = 0;
+    return RunBatches([&](LineBatch* batch) {
+        if (next < count) {
+            batch->file_batch = next++;
+        }
+        return next < count;
+    });
+}
+
+hybridse::sdk::Status LoadDataPipeline::RunBatches(const BatchReader& read) {
+    start_ms_ = ::baidu::common::timer::get_micros() / 1000;
+    last_report_ms_ = start_ms_;
+    uint32_t thread = std::max(options_.thread, 1u);
+    // bound the batches read ahead of the sender, so memory does not grow with the file size
+    uint64_t max_pending = 2 * thread + 1;
+    hybridse::sdk::Status status;
+    {
+        ::openmldb::base::TaskPool parse_pool(thread, max_pending);
+        uint64_t next_read_seq = 0;
+        uint64_t next_send_seq = 0;
+        bool eof = false;
+        while (true) {
+            while (!eof && next_read_seq - next_send_seq < max_pending) {
+                auto batch = std::make_shared<LineBatch>();
+                eof = !read(batch.get());
+                if (batch->lines.empty() && batch->file_batch < 0) {
+                    break;
+                }
+                batch->seq = next_read_seq++;
+                parse_pool.AddTask(boost::bind(&LoadDataPipeline::Parse, this, batch));
+            }
+            if (next_send_seq == next_read_seq) {
+                break;
+            }
+            auto rows = WaitParsed(next_send_seq++);
+            status = Send(*rows);
+            if (!status.IsOK()) {
+                break;
+            }
+            ReportProgress(false);
+        }
+        // the batches behind a failed one will never be sent, skip encoding them
+        stop_parse_.store(true, std::memory_order_relaxed);
+    }
+    auto join_status = JoinAll();
+    if (status.IsOK()) {
+        status = join_status;
+    }
+    cost_ms_ = ::baidu::common::timer::get_micros() / 1000 - start_ms_;
+    ReportProgress(true);
+    return status;
+}
+
+void LoadDataPipeline::Parse(std::shared_ptr<LineBatch> batch) {
+    auto rows = std::make_shared<RowBatch>();
+    rows->file_batch = batch->file_batch;
+    if (batch->file_batch >= 0) {
+        if (!stop_parse_.load(std::memory_order_relaxed)) {
+            auto status = reader_->ReadBatch(
+                batch->file_batch,
+                [this]() {
+                    return std::make_shared<SQLInsertRow>(table_info_, schema_, default_map_, default_str_length_);
+                },
+                &rows->rows);
+            for (auto& row : rows->rows) {
+                row->GetDimensions();
+            }
+            if (!status.IsOK()) {
+                rows->error_idx = rows->rows.size();
+                rows->error_msg = status.msg;
+            }
+        }
+    } else if (!stop_parse_.load(std::memory_order_relaxed)) {
+        rows->rows.reserve(batch->lines.size());
+        for (size_t i = 0; i < batch->lines.size(); i++) {
+            std::shared_ptr<SQLInsertRow> row;
+            std::string msg = EncodeLine(batch->lines[i], &row);
+            if (!msg.empty()) {
+                rows->error_idx = i;
+                rows->error_msg = "line [" + batch->lines[i] + "] insert failed, " + msg;
+                break;
+            }
+            // route the row to its partitions in the parse threads as well
+            row->GetDimensions();
+            rows->rows.push_back(std::move(row));
+        }
+        rows->lines = std::move(batch->lines);
+    }
+    std::lock_guard<std::mutex> lock(mu_);
+    parsed_.emplace(batch->seq, rows);
+    cv_.notify_all();
+}
+
+std::string LoadDataPipeline::EncodeLine(const std::string& line, std::shared_ptr<SQLInsertRow>* row) {
+    std::vector<std::string> cols;
+    ::openmldb::sdk::SplitLineWithDelimiterForStrings(line, options_.delimiter, &cols, options_.quote);
+    if (cols.empty()) {
+        return "cols is empty";
+    }
+    int cnt = schema_->GetColumnCnt();
+    if (cnt != static_cast<int>(cols.size())) {
+        return "col size mismatch";
+    }
+    // scan all strings, calc the sum, to init SQLInsertRow's string length
+    std::string::size_type str_len_sum = 0;
+    for (auto idx : str_cols_idx_) {
+        if (cols[idx] != options_.null_value) {
+            str_len_sum += cols[idx].length();
+        }
+    }
+    auto insert_row = std::make_shared<SQLInsertRow>(table_info_, schema_, default_map_, default_str_length_);
+    insert_row->Init(static_cast<int>(str_len_sum));
+    for (int i = 0; i < cnt; ++i) {
+        if (!::openmldb::codec::AppendColumnValue(cols[i], schema_->GetColumnType(i), schema_->IsColumnNotNull(i),
+                                                  options_.null_value, insert_row)) {
+            return "translate to insert row failed";
+        }
+    }
+    *row = insert_row;
+    return "";
+}
+
+std::shared_ptr<LoadDataPipeline::RowBatch> LoadDataPipeline::WaitParsed(uint64_t seq) {
+    std::unique_lock<std::mutex> lock(mu_);
+    auto it = parsed_.find(seq);
+    while (it == parsed_.end()) {
+        cv_.wait(lock);
+        it = parsed_.find(seq);
+    }
+    auto rows = it->second;
+    parsed_.erase(it);
+    return rows;
+}
+
+hybridse::sdk::Status LoadDataPipeline::Send(const RowBatch& batch) {
+    for (size_t i = 0; i < batch.rows.size(); i++) {
+        if (put_failed_.load(std::memory_order_relaxed)) {
+            // report the failed put, the rows behind it are not sent
+            return JoinAll();
+        }
+        const auto& row = batch.rows[i];
+        const auto& dimensions = row->GetDimensions();
+        if (dimensions.empty()) {
+            loaded_rows_++;
+            continue;
+        }
+        auto row_puts = std::make_shared<uint32_t>(dimensions.size());
+        for (const auto& kv : dimensions) {
+            auto status = AsyncPut(kv.first, row->GetRow(), kv.second, RowDesc(batch, i), row_puts);
+            if (!status.IsOK()) {
+                return status;
+            }
+        }
+    }
+    if (batch.error_idx >= 0) {
+        return {::hybridse::common::StatusCode::kCmdError, batch.error_msg};
+    }
+    return {};
+}
+
+std::string LoadDataPipeline::RowDesc(const RowBatch& batch, size_t idx) {
+    if (batch.file_batch >= 0) {
+        return "row [" + std::to_string(idx) + "] of batch [" + std::to_string(batch.file_batch) + "]";
+    }
+    return "line [" + batch.lines[idx] + "]";
+}
+
+hybridse::sdk::Status LoadDataPipeline::AsyncPut(uint32_t pid, const std::string& value,
+                                                 const std::vector<std::pair<std::string, uint32_t>>& dimensions,
+                                                 const std::string& desc,
+                                                 const std::shared_ptr<uint32_t>& row_puts) {
+    std::shared_ptr<::openmldb::client::TabletClient> client;
+    if (pid < tablets_.size() && tablets_[pid]) {
+        client = tablets_[pid]->GetClient();
+    }
+    if (!client) {
+        return {::hybridse::common::StatusCode::kCmdError,
+                desc + " insert failed, fail to get tablet client. pid " + std::to_string(pid)};
+    }
+    auto& window = in_flight_[pid];
+    while (window.size() >= std::max(FLAGS_load_data_put_window, 1u)) {
+        auto status = JoinOldest(pid);
+        if (!status.IsOK()) {
+            return status;
+        }
+    }
+    ::openmldb::api::PutRequest request;
+    request.set_time(::baidu::common::timer::get_micros() / 1000);
+    request.set_value(value);
+    request.set_tid(table_info_->tid());
+    request.set_pid(pid);
+    request.set_format_version(1);
+    for (const auto& dim : dimensions) {
+        auto* d = request.add_dimensions();
+        d->set_key(dim.first);
+        d->set_idx(dim.second);
+    }
+    auto cntl = std::make_shared<brpc::Controller>();
+    cntl->set_timeout_ms(FLAGS_request_timeout_ms);
+    cntl->set_max_retry(1);
+    auto response = std::make_shared<::openmldb::api::PutResponse>();
+    auto callback = new openmldb::RpcCallback<openmldb::api::PutResponse>(response, cntl);
+    // one ref is released by the rpc done, the other one after the put is joined
+    callback->Ref();
+    callback->SetDoneHandler([this, callback]() {
+        if (callback->GetController()->Failed() || callback->GetResponse()->code() != 0) {
+            put_failed_.store(true, std::memory_order_relaxed);
+        }
+    });
+    if (!client->AsyncPut(request, callback)) {
+        callback->UnRef();
+        callback->UnRef();
+        return {::hybridse::common::StatusCode::kCmdError, desc + " insert failed, insert row failed"};
+    }
+    window.push_back({callback, desc, row_puts});
+    return {};
+}
+
+hybridse::sdk::Status LoadDataPipeline::JoinOldest(uint32_t pid) {
+    auto& window = in_flight_[pid];
+    if (window.empty()) {
+        return {};
+    }
+    auto put = std::move(window.front());
+    window.pop_front();
+    auto cntl = put.callback->GetController();
+    brpc::Join(cntl->call_id());
+    hybridse::sdk::Status status;
+    if (cntl->Failed()) {
+        LOG(WARNING) << "fail to put row of " << put.desc << ": " << cntl->ErrorText();
+        status = {::hybridse::common::StatusCode::kCmdError, put.desc + " insert failed, insert row failed"};
+    } else if (put.callback->GetResponse()->code() != 0) {
+        LOG(WARNING) << "fail to put row of " << put.desc << ": " << put.callback->GetResponse()->msg();
+        status = {::hybridse::common::StatusCode::kCmdError, put.desc + " insert failed, insert row failed"};
+    } else if (--*put.row_puts == 0) {
+        loaded_rows_++;
+    }
+    put.callback->UnRef();
+    return status;
+}
+
+hybridse::sdk::Status LoadDataPipeline::JoinAll() {
+    hybridse::sdk::Status status;
+    for (uint32_t pid = 0; pid < in_flight_.size(); pid++) {
+        while (!in_flight_[pid].empty()) {
+            auto cur_status = JoinOldest(pid);
+            if (status.IsOK() && !cur_status.IsOK()) {
+                status = cur_status;
+            }
+        }
+    }
+    return status;
+}
+
+void LoadDataPipeline::ReportProgress(bool force) {
+    uint64_t cur_ms = ::baidu::common::timer::get_micros() / 1000;
+    if (!force && cur_ms - last_report_ms_ < FLAGS_load_data_report_interval_ms) {
+        return;
+    }
+    last_report_ms_ = cur_ms;
+    uint64_t cost_ms = std::max(cur_ms - start_ms_, static_cast<uint64_t>(1));
+    LOG(INFO) << "load data into " << table_info_->db() << "." << table_info_->name() << ": " << loaded_rows_
+              << " rows in " << cost_ms << " ms, " << loaded_rows_ * 1000 / cost_ms << " rows/s";
+}
+
+}  // namespace sdk
+}  // namespace openmldb
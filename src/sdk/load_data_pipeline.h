@@ -0,0 +1,155 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_SDK_LOAD_DATA_PIPELINE_H_
+#define SRC_SDK_LOAD_DATA_PIPELINE_H_
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <istream>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "catalog/client_manager.h"
+#include "proto/tablet.pb.h"
+#include "rpc/rpc_client.h"
+#include "sdk/base.h"
+#include "sdk/columnar_file.h"
+#include "sdk/sql_insert_row.h"
+
+namespace openmldb {
+namespace sdk {
+
+struct LoadDataOptions {
+    std::string delimiter = ",";
+    std::string null_value = "null";
+    char quote = '\0';
+    // the number of threads which split and encode lines
+    uint32_t thread = 1;
+};
+
+/// LoadDataPipeline loads the lines of a csv file into one table in three stages:
+/// the caller thread reads the file in batches of lines, a task pool splits and
+/// encodes the batches into insert rows, and the caller thread puts the encoded
+/// rows in file order with a bounded window of async put requests per partition.
+/// Parquet and arrow files go through the same stages, with one row group or record
+/// batch per batch, decoded column by column in the task pool.
+///
+/// Loading stops at the first malformed line or failed put, and a row counts as
+/// loaded once all its puts are acked, so the rows loaded and the error returned
+/// are the same as inserting the lines one by one.
+class LoadDataPipeline {
+ public:
+    LoadDataPipeline(std::shared_ptr<::openmldb::nameserver::TableInfo> table_info,
+                     std::shared_ptr<hybridse::sdk::Schema> schema, DefaultValueMap default_map,
+                     uint32_t default_str_length,
+                     const std::vector<std::shared_ptr<::openmldb::catalog::TabletAccessor>>& tablets,
+                     const LoadDataOptions& options);
+
+    ~LoadDataPipeline() = default;
+
+    /// load `first_line` and all the remaining lines of `file`
+    hybridse::sdk::Status Run(const std::string& first_line, std::istream* file);
+
+    /// load all the batches of `reader`, which must be bound to the schema of the table
+    hybridse::sdk::Status Run(ColumnarFileReader* reader);
+
+    uint64_t GetLoadedRows() const { return loaded_rows_; }
+    uint64_t GetCostMs() const { return cost_ms_; }
+
+ private:
+    struct LineBatch {
+        uint64_t seq = 0;
+        std::vector<std::string> lines;
+        // the batch index in the columnar file, -1 for csv lines
+        int file_batch = -1;
+    };
+
+    struct RowBatch {
+        std::vector<std::string> lines;
+        int file_batch = -1;
+        std::vector<std::shared_ptr<SQLInsertRow>> rows;
+        // the index of the first malformed line, -1 if all lines are encoded
+        int64_t error_idx = -1;
+        std::string error_msg;
+    };
+
+    struct InFlightPut {
+        openmldb::RpcCallback<openmldb::api::PutResponse>* callback;
+        std::string desc;
+        // the puts of the row not acked yet, shared by all the puts of the row
+        std::shared_ptr<uint32_t> row_puts;
+    };
+
+    // fill the next batch, return false if it is the last one
+    using BatchReader = std::function<bool(LineBatch*)>;
+
+    hybridse::sdk::Status RunBatches(const BatchReader& read);
+
+    void Parse(std::shared_ptr<LineBatch> batch);
+
+    std::string EncodeLine(const std::string& line, std::shared_ptr<SQLInsertRow>* row);
+
+    // the row in the error messages, the csv line or its position in the columnar file
+    static std::string RowDesc(const RowBatch& batch, size_t idx);
+
+    std::shared_ptr<RowBatch> WaitParsed(uint64_t seq);
+
+    hybridse::sdk::Status Send(const RowBatch& batch);
+
+    hybridse::sdk::Status AsyncPut(uint32_t pid, const std::string& value,
+                                   const std::vector<std::pair<std::string, uint32_t>>& dimensions,
+                                   const std::string& desc, const std::shared_ptr<uint32_t>& row_puts);
+
+    hybridse::sdk::Status JoinOldest(uint32_t pid);
+
+    hybridse::sdk::Status JoinAll();
+
+    void ReportProgress(bool force);
+
+ private:
+    std::shared_ptr<::openmldb::nameserver::TableInfo> table_info_;
+    std::shared_ptr<hybridse::sdk::Schema> schema_;
+    DefaultValueMap default_map_;
+    uint32_t default_str_length_;
+    std::vector<std::shared_ptr<::openmldb::catalog::TabletAccessor>> tablets_;
+    LoadDataOptions options_;
+    std::vector<int> str_cols_idx_;
+    ColumnarFileReader* reader_;
+
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::map<uint64_t, std::shared_ptr<RowBatch>> parsed_;
+    std::atomic<bool> stop_parse_;
+
+    std::vector<std::deque<InFlightPut>> in_flight_;
+    // set by the rpc threads once a put fails, no more rows are sent then
+    std::atomic<bool> put_failed_;
+    uint64_t loaded_rows_;
+    uint64_t start_ms_;
+    uint64_t last_report_ms_;
+    uint64_t cost_ms_;
+};
+
+}  // namespace sdk
+}  // namespace openmldb
+#endif  // SRC_SDK_LOAD_DATA_PIPELINE_H_
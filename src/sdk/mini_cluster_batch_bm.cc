@@ -346,6 +346,10 @@ static void BM_InsertPlaceHolderFunction(benchmark::State& state) {  // NOLINT
     }
 }
 
+static void BM_AsyncInsertFunction(benchmark::State& state) {  // NOLINT
+    BM_AsyncInsert(state, mc);
+}
+
 static void BM_InsertPlaceHolderBatchFunction(benchmark::State& state) {  // NOLINT
     ::openmldb::sdk::SQLRouterOptions sql_opt;
     sql_opt.zk_cluster = mc->GetZkCluster();
@@ -882,6 +886,12 @@ BENCHMARK(BM_SimpleInsertFunction)->Args({10})->Args({100})->Args({1000})->Args(
 BENCHMARK(BM_InsertPlaceHolderFunction)->Args({10})->Args({100})->Args({1000})->Args({10000});
 
 BENCHMARK(BM_InsertPlaceHolderBatchFunction)->Args({10})->Args({100})->Args({1000})->Args({10000});
+BENCHMARK(BM_AsyncInsertFunction)
+    ->Args({10000, 0})
+    ->Args({10000, 1})
+    ->Args({10000, 4})
+    ->Args({10000, 16})
+    ->Args({10000, 64});
 BENCHMARK(BM_SimpleTableReaderSync)->Args({10})->Args({100})->Args({1000})->Args({2000})->Args({4000})->Args({10000});
 BENCHMARK(BM_SimpleTableReaderAsync)->Args({10})->Args({100})->Args({1000})->Args({2000})->Args({4000})->Args({10000});
 BENCHMARK(BM_SimpleTableReaderAsyncMulti)
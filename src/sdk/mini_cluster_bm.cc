@@ -29,6 +29,7 @@
 
 DECLARE_bool(enable_distsql);
 DECLARE_bool(enable_localtablet);
+DECLARE_uint32(insert_max_in_flight);
 
 typedef ::google::protobuf::RepeatedPtrField<::openmldb::common::ColumnDesc> RtiDBSchema;
 typedef ::google::protobuf::RepeatedPtrField<::openmldb::common::ColumnKey> RtiDBIndex;
@@ -166,6 +167,73 @@ void BM_RequestQuery(benchmark::State& state, hybridse::sqlcase::SqlCase& sql_ca
     openmldb::sdk::SQLSDKTest::DropTables(sql_case, router);
 }
 
+void BM_AsyncInsert(benchmark::State& state, ::openmldb::sdk::MiniCluster* mc) {  // NOLINT
+    ::openmldb::sdk::SQLRouterOptions sql_opt;
+    sql_opt.zk_cluster = mc->GetZkCluster();
+    sql_opt.zk_path = mc->GetZkPath();
+    auto router = NewClusterSQLRouter(sql_opt);
+    if (router == nullptr) {
+        state.SkipWithError("fail to init sql cluster router");
+        return;
+    }
+    std::string name = "test" + GenRand();
+    std::string db = "db" + GenRand();
+    ::hybridse::sdk::Status status;
+    router->CreateDB(db, &status);
+    router->ExecuteDDL(db,
+                       "create table " + name +
+                           "(col1 string, col2 bigint, col3 int, col4 double, index(key=col1, ts=col2)) "
+                           "options(partitionnum=8);",
+                       &status);
+    if (!status.IsOK()) {
+        state.SkipWithError("fail to create table");
+        return;
+    }
+    router->RefreshCatalog();
+    uint32_t old_in_flight = FLAGS_insert_max_in_flight;
+    int64_t depth = state.range(1);
+    if (depth > 0) {
+        FLAGS_insert_max_in_flight = depth;
+    }
+    std::string insert = "insert into " + name + " values(?, ?, ?, ?);";
+    uint64_t time = 1589780888000l;
+    int64_t rows = 0;
+    std::vector<std::shared_ptr<::openmldb::sdk::InsertFuture>> futures;
+    futures.reserve(state.range(0));
+    for (auto _ : state) {
+        futures.clear();
+        for (int i = 0; i < state.range(0); ++i) {
+            auto row = router->GetInsertRow(db, insert, &status);
+            if (row == nullptr) {
+                state.SkipWithError("get insert row failed");
+                break;
+            }
+            std::string key = "key" + std::to_string(i % 1000);
+            row->Init(key.size());
+            row->AppendString(key);
+            row->AppendInt64(time + rows + i);
+            row->AppendInt32(i);
+            row->AppendDouble(2.7 + i);
+            if (depth > 0) {
+                futures.push_back(router->ExecuteInsertAsync(db, insert, row, &status));
+            } else {
+                benchmark::DoNotOptimize(router->ExecuteInsert(db, insert, row, &status));
+            }
+        }
+        for (auto& future : futures) {
+            if (future && !future->Get(&status)) {
+                state.SkipWithError(status.msg.c_str());
+                break;
+            }
+        }
+        rows += state.range(0);
+    }
+    state.counters["rows/s"] = benchmark::Counter(rows, benchmark::Counter::kIsRate);
+    FLAGS_insert_max_in_flight = old_in_flight;
+    router->ExecuteDDL(db, "drop table " + name + ";", &status);
+    router->DropDB(db, &status);
+}
+
 hybridse::sqlcase::SqlCase LoadSQLCaseWithID(const std::string& yaml, const std::string& case_id) {
     return hybridse::sqlcase::SqlCase::LoadSqlCaseWithID(openmldb::test::SQLCaseTest::GetYAMLBaseDir(), yaml, case_id);
 }
@@ -34,6 +34,8 @@ void BM_RequestQuery(benchmark::State& state, hybridse::sqlcase::SqlCase& sql_ca
                      ::openmldb::sdk::MiniCluster* mc);
 void BM_BatchRequestQuery(benchmark::State& state, hybridse::sqlcase::SqlCase& sql_case,  // NOLINT
                           ::openmldb::sdk::MiniCluster* mc);
+// insert state.range(0) rows with state.range(1) in-flight requests per tablet, 0 for the sync insert
+void BM_AsyncInsert(benchmark::State& state, ::openmldb::sdk::MiniCluster* mc);  // NOLINT
 hybridse::sqlcase::SqlCase LoadSQLCaseWithID(const std::string& yaml, const std::string& case_id);
 void MiniBenchmarkOnCase(hybridse::sqlcase::SqlCase& sql_case, BmRunMode engine_mode,  // NOLINT
                          ::openmldb::sdk::MiniCluster* mc, benchmark::State* state);
@@ -212,6 +212,11 @@ bool NodeAdapter::TransformToTableDef(::hybridse::node::CreatePlanNode* create_n
                 if (!TransformToColumnKey(column_index, column_names, index, status)) {
                     return false;
                 }
+                if (index->hot_ttl() > 0 && storage_mode != hybridse::node::kTiered) {
+                    status->msg = "CREATE common: hot_ttl is only supported by tiered storage mode";
+                    status->code = hybridse::common::kUnsupportSql;
+                    return false;
+                }
                 break;
             }
 
@@ -372,6 +377,10 @@ bool NodeAdapter::TransformToColumnKey(hybridse::node::ColumnIndexNode* column_i
         }
         index->set_ts_name(column_index->GetTs());
     }
+    if (column_index->GetHotTTL() > 0) {
+        // convert it(ms) to minutes, >= 1 min
+        index->set_hot_ttl(base::AbsTTLConvert(column_index->GetHotTTL(), true));
+    }
     return true;
 }
 
@@ -43,7 +43,9 @@
 #include "sdk/base.h"
 #include "sdk/base_impl.h"
 #include "sdk/batch_request_result_set_sql.h"
+#include "sdk/columnar_file.h"
 #include "sdk/file_option_parser.h"
+#include "sdk/load_data_pipeline.h"
 #include "sdk/node_adapter.h"
 #include "sdk/result_set_sql.h"
 #include "sdk/split.h"
@@ -56,6 +58,8 @@ DECLARE_uint32(replica_num);
 namespace openmldb {
 namespace sdk {
 
+constexpr size_t kLoadDataReadBufferSize = 4 * 1024 * 1024;
+
 using hybridse::plan::PlanAPI;
 
 class ExplainInfoImpl : public ExplainInfo {
@@ -213,7 +217,10 @@ SQLClusterRouter::SQLClusterRouter(DBSDK* sdk)
       mu_(),
       rand_(::baidu::common::timer::now_time()) {}
 
-SQLClusterRouter::~SQLClusterRouter() { delete cluster_sdk_; }
+SQLClusterRouter::~SQLClusterRouter() {
+    async_put_sender_.Flush();
+    delete cluster_sdk_;
+}
 
 bool SQLClusterRouter::Init() {
     if (cluster_sdk_ == nullptr) {
@@ -1261,6 +1268,27 @@ bool SQLClusterRouter::ExecuteInsert(const std::string& db, const std::string& s
     }
 }
 
+std::shared_ptr<InsertFuture> SQLClusterRouter::ExecuteInsertAsync(const std::string& db, const std::string& sql,
+                                                                   std::shared_ptr<SQLInsertRow> row,
+                                                                   hybridse::sdk::Status* status) {
+    if (!row || !status) {
+        return nullptr;
+    }
+    std::shared_ptr<SQLCache> cache = GetCache(db, sql, hybridse::vm::kBatchMode);
+    if (!cache) {
+        status->msg = "please use getInsertRow with " + sql + " first";
+        return nullptr;
+    }
+    std::shared_ptr<::openmldb::nameserver::TableInfo> table_info = cache->table_info;
+    std::vector<std::shared_ptr<::openmldb::catalog::TabletAccessor>> tablets;
+    bool ret = cluster_sdk_->GetTablet(db, table_info->name(), &tablets);
+    if (!ret || tablets.empty()) {
+        status->msg = "fail to get table " + table_info->name() + " tablet";
+        return nullptr;
+    }
+    return async_put_sender_.Submit(table_info->tid(), row, tablets);
+}
+
 bool SQLClusterRouter::GetSQLPlan(const std::string& sql, ::hybridse::node::NodeManager* nm,
                                   ::hybridse::node::PlanNodeList* plan) {
     if (nm == NULL || plan == NULL) return false;
@@ -2600,6 +2628,17 @@ void SQLClusterRouter::SetInteractive(bool value) { interactive_ = value; }
     if (!st.OK()) {
         return {st.code, st.msg};
     }
+    if (IsColumnarFormat(options_parse.GetFormat())) {
+        // a parquet or arrow file ends with its footer, so it can not be appended to
+        if (options_parse.GetMode() == "append") {
+            return {openmldb::base::kSQLCmdRunError, "ERROR: mode append is not supported by format " +
+                                                         options_parse.GetFormat()};
+        }
+        if (options_parse.GetMode() == "error_if_exists" && access(file_path.c_str(), 0) == 0) {
+            return {openmldb::base::kSQLCmdRunError, "File already exists"};
+        }
+        return WriteColumnarFile(options_parse.GetFormat(), file_path, result_set);
+    }
     // Check file
     std::ofstream fstream;
     if (options_parse.GetMode() == "error_if_exists") {
@@ -2671,7 +2710,7 @@ void SQLClusterRouter::SetInteractive(bool value) { interactive_ = value; }
     return {};
 }
 
-// Only csv format
+// csv, parquet or arrow files
 hybridse::sdk::Status SQLClusterRouter::HandleLoadDataInfile(
     const std::string& database, const std::string& table, const std::string& file_path,
     const std::shared_ptr<hybridse::node::OptionsMap>& options) {
@@ -2683,112 +2722,94 @@ hybridse::sdk::Status SQLClusterRouter::HandleLoadDataInfile(
     if (!st.OK()) {
         return {::hybridse::common::StatusCode::kCmdError, st.msg};
     }
-    /*std::cout << "Load " << file_path << " to " << real_db << "-" << table << ", options: delimiter ["
-              << options_parse.GetDelimiter() << "], has header[" << (options_parse.GetHeader() ? "true" : "false")
-              << "], null_value[" << options_parse.GetNullValue() << "], format[" << options_parse.GetFormat()
-              << "], quote[" << options_parse.GetQuote() << "]" << std::endl;*/
-    // read csv
     if (!base::IsExists(file_path)) {
         return {::hybridse::common::StatusCode::kCmdError, "file not exist"};
     }
-    std::ifstream file(file_path);
-    if (!file.is_open()) {
-        return {::hybridse::common::StatusCode::kCmdError, "open file failed"};
-    }
-
+    std::shared_ptr<hybridse::sdk::Schema> schema;
+    std::unique_ptr<ColumnarFileReader> reader;
+    std::vector<char> read_buf;
+    std::ifstream file;
     std::string line;
-    if (!std::getline(file, line)) {
-        return {::hybridse::common::StatusCode::kCmdError, "read from file failed"};
-    }
-    std::vector<std::string> cols;
-    ::openmldb::sdk::SplitLineWithDelimiterForStrings(line, options_parse.GetDelimiter(), &cols,
-                                                      options_parse.GetQuote());
-    auto schema = GetTableSchema(database, table);
-    if (!schema) {
-        return {::hybridse::common::StatusCode::kCmdError, "table is not exist"};
-    }
-    if (static_cast<int>(cols.size()) != schema->GetColumnCnt()) {
-        return {::hybridse::common::StatusCode::kCmdError, "mismatch column size"};
-    }
+    if (IsColumnarFormat(options_parse.GetFormat())) {
+        // columns are bound by name, the header and csv options do not apply
+        hybridse::sdk::Status open_status;
+        reader = ColumnarFileReader::Open(options_parse.GetFormat(), file_path, &open_status);
+        if (!reader) {
+            return open_status;
+        }
+        schema = GetTableSchema(database, table);
+        if (!schema) {
+            return {::hybridse::common::StatusCode::kCmdError, "table is not exist"};
+        }
+        auto bind_status = reader->Bind(*schema);
+        if (!bind_status.IsOK()) {
+            return bind_status;
+        }
+    } else {
+        // read csv
+        read_buf.resize(kLoadDataReadBufferSize);
+        file.rdbuf()->pubsetbuf(read_buf.data(), read_buf.size());
+        file.open(file_path);
+        if (!file.is_open()) {
+            return {::hybridse::common::StatusCode::kCmdError, "open file failed"};
+        }
 
-    if (options_parse.GetHeader()) {
-        // the first line is the column names, check if equal with table schema
-        for (int i = 0; i < schema->GetColumnCnt(); ++i) {
-            if (cols[i] != schema->GetColumnName(i)) {
-                return {::hybridse::common::StatusCode::kCmdError, "mismatch column name"};
+        if (!std::getline(file, line)) {
+            return {::hybridse::common::StatusCode::kCmdError, "read from file failed"};
+        }
+        std::vector<std::string> cols;
+        ::openmldb::sdk::SplitLineWithDelimiterForStrings(line, options_parse.GetDelimiter(), &cols,
+                                                          options_parse.GetQuote());
+        schema = GetTableSchema(database, table);
+        if (!schema) {
+            return {::hybridse::common::StatusCode::kCmdError, "table is not exist"};
+        }
+        if (static_cast<int>(cols.size()) != schema->GetColumnCnt()) {
+            return {::hybridse::common::StatusCode::kCmdError, "mismatch column size"};
+        }
+
+        if (options_parse.GetHeader()) {
+            // the first line is the column names, check if equal with table schema
+            for (int i = 0; i < schema->GetColumnCnt(); ++i) {
+                if (cols[i] != schema->GetColumnName(i)) {
+                    return {::hybridse::common::StatusCode::kCmdError, "mismatch column name"};
+                }
             }
+            // then read the first row of data
+            std::getline(file, line);
         }
-        // then read the first row of data
-        std::getline(file, line);
     }
 
-    // build placeholder
+    // build placeholder, resolve the insert row once for the whole file
     std::string holders;
     for (auto i = 0; i < schema->GetColumnCnt(); ++i) {
         holders += ((i == 0) ? "?" : ",?");
     }
     hybridse::sdk::Status status;
     std::string insert_placeholder = "insert into " + table + " values(" + holders + ");";
-    std::vector<int> str_cols_idx;
-    for (int i = 0; i < schema->GetColumnCnt(); ++i) {
-        if (schema->GetColumnType(i) == hybridse::sdk::kTypeString) {
-            str_cols_idx.emplace_back(i);
-        }
-    }
-    uint64_t i = 0;
-    do {
-        cols.clear();
-        std::string error;
-        ::openmldb::sdk::SplitLineWithDelimiterForStrings(line, options_parse.GetDelimiter(), &cols,
-                                                          options_parse.GetQuote());
-        auto ret = InsertOneRow(database, insert_placeholder, str_cols_idx, options_parse.GetNullValue(), cols);
-        if (!ret.IsOK()) {
-            return {::hybridse::common::StatusCode::kCmdError, "line [" + line + "] insert failed, " + ret.msg};
-        }
-        ++i;
-    } while (std::getline(file, line));
-    return {0, "Load " + std::to_string(i) + " rows"};
-}
-
-hybridse::sdk::Status SQLClusterRouter::InsertOneRow(const std::string& database, const std::string& insert_placeholder,
-                                                     const std::vector<int>& str_col_idx, const std::string& null_value,
-                                                     const std::vector<std::string>& cols) {
-    if (cols.empty()) {
-        return {::hybridse::common::StatusCode::kCmdError, "cols is empty"};
-    }
-    if (database.empty()) {
-        return {::hybridse::common::StatusCode::kCmdError, "database is empty"};
-    }
-    hybridse::sdk::Status status;
-    auto row = GetInsertRow(database, insert_placeholder, &status);
-    if (!row) {
+    if (!GetInsertRow(database, insert_placeholder, &status)) {
         return status;
     }
-    // build row from cols
-    auto& schema = row->GetSchema();
-    auto cnt = schema->GetColumnCnt();
-    if (cnt != static_cast<int>(cols.size())) {
-        return {::hybridse::common::StatusCode::kCmdError, "col size mismatch"};
-    }
-    // scan all strings , calc the sum, to init SQLInsertRow's string length
-    std::string::size_type str_len_sum = 0;
-    for (auto idx : str_col_idx) {
-        if (cols[idx] != null_value) {
-            str_len_sum += cols[idx].length();
-        }
-    }
-    row->Init(static_cast<int>(str_len_sum));
-
-    for (int i = 0; i < cnt; ++i) {
-        if (!::openmldb::codec::AppendColumnValue(cols[i], schema->GetColumnType(i), schema->IsColumnNotNull(i),
-                                                  null_value, row)) {
-            return {::hybridse::common::StatusCode::kCmdError, "translate to insert row failed"};
-        }
-    }
-    if (!ExecuteInsert(database, insert_placeholder, row, &status)) {
-        return {::hybridse::common::StatusCode::kCmdError, "insert row failed"};
+    auto cache = GetCache(database, insert_placeholder, hybridse::vm::kBatchMode);
+    if (!cache) {
+        return {::hybridse::common::StatusCode::kCmdError, "fail to get insert info of table " + table};
     }
-    return {};
+    std::vector<std::shared_ptr<::openmldb::catalog::TabletAccessor>> tablets;
+    if (!cluster_sdk_->GetTablet(database, table, &tablets) || tablets.empty()) {
+        return {::hybridse::common::StatusCode::kCmdError, "fail to get table " + table + " tablet"};
+    }
+    LoadDataOptions load_options;
+    load_options.delimiter = options_parse.GetDelimiter();
+    load_options.null_value = options_parse.GetNullValue();
+    load_options.quote = options_parse.GetQuote();
+    load_options.thread = options_parse.GetThread();
+    LoadDataPipeline pipeline(cache->table_info, cache->column_schema, cache->default_map, cache->str_length,
+                              tablets, load_options);
+    auto ret = reader ? pipeline.Run(reader.get()) : pipeline.Run(line, &file);
+    if (!ret.IsOK()) {
+        return ret;
+    }
+    return {0, "Load " + std::to_string(pipeline.GetLoadedRows()) + " rows"};
 }
 
 hybridse::sdk::Status SQLClusterRouter::HandleCreateFunction(const hybridse::node::CreateFunctionPlanNode* node) {
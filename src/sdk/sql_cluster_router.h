@@ -30,6 +30,7 @@
 #include "base/spinlock.h"
 #include "base/lru_cache.h"
 #include "client/tablet_client.h"
+#include "sdk/async_put_sender.h"
 #include "sdk/db_sdk.h"
 #include "sdk/sql_router.h"
 #include "sdk/table_reader_impl.h"
@@ -137,6 +138,10 @@ class SQLClusterRouter : public SQLRouter {
     bool ExecuteInsert(const std::string& db, const std::string& sql, std::shared_ptr<SQLInsertRows> rows,
                        hybridse::sdk::Status* status) override;
 
+    std::shared_ptr<InsertFuture> ExecuteInsertAsync(const std::string& db, const std::string& sql,
+                                                     std::shared_ptr<SQLInsertRow> row,
+                                                     hybridse::sdk::Status* status) override;
+
     std::shared_ptr<TableReader> GetTableReader() override;
 
     std::shared_ptr<ExplainInfo> Explain(const std::string& db, const std::string& sql,
@@ -348,10 +353,6 @@ class SQLClusterRouter : public SQLRouter {
             const std::string& table, const std::string& file_path,
             const std::shared_ptr<hybridse::node::OptionsMap>& options);
 
-    hybridse::sdk::Status InsertOneRow(const std::string& database,
-            const std::string& insert_placeholder, const std::vector<int>& str_col_idx,
-            const std::string& null_value, const std::vector<std::string>& cols);
-
     hybridse::sdk::Status HandleDeploy(const hybridse::node::DeployPlanNode* deploy_node);
 
     hybridse::sdk::Status HandleIndex(const std::set<std::pair<std::string, std::string>>& table_pair,
@@ -403,6 +404,7 @@ class SQLClusterRouter : public SQLRouter {
                       base::lru_cache<std::string, std::shared_ptr<SQLCache>>>> input_lru_cache_;
     ::openmldb::base::SpinMutex mu_;
     ::openmldb::base::Random rand_;
+    AsyncPutSender async_put_sender_;
 };
 
 }  // namespace sdk
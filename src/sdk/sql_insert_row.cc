@@ -19,12 +19,15 @@
 #include <stdint.h>
 
 #include <string>
+#include <unordered_map>
 
 #include "glog/logging.h"
 
 namespace openmldb {
 namespace sdk {
 
+static constexpr size_t MAX_LAYOUT_CACHE_SIZE = 64;
+
 SQLInsertRows::SQLInsertRows(std::shared_ptr<::openmldb::nameserver::TableInfo> table_info,
                              std::shared_ptr<hybridse::sdk::Schema> schema, DefaultValueMap default_map,
                              uint32_t default_str_length)
@@ -40,6 +43,47 @@ std::shared_ptr<SQLInsertRow> SQLInsertRows::NewRow() {
     return row;
 }
 
+InsertRowLayout::InsertRowLayout(const ::openmldb::nameserver::TableInfo& table_info)
+    : row_layout(std::make_shared<const ::openmldb::codec::RowLayout>(table_info.column_desc())),
+      is_dimension(table_info.column_desc_size(), false),
+      is_ts(table_info.column_desc_size(), false) {
+    std::map<std::string, uint32_t> column_name_map;
+    for (int idx = 0; idx < table_info.column_desc_size(); idx++) {
+        column_name_map.emplace(table_info.column_desc(idx).name(), idx);
+    }
+    for (int idx = 0; idx < table_info.column_key_size(); ++idx) {
+        for (const auto& column : table_info.column_key(idx).col_name()) {
+            uint32_t pos = column_name_map[column];
+            index_map[idx].push_back(pos);
+            is_dimension[pos] = true;
+        }
+        if (!table_info.column_key(idx).ts_name().empty()) {
+            is_ts[column_name_map[table_info.column_key(idx).ts_name()]] = true;
+        }
+    }
+}
+
+std::shared_ptr<const InsertRowLayout> InsertRowLayout::Get(
+    const std::shared_ptr<::openmldb::nameserver::TableInfo>& table_info) {
+    // the table info is replaced instead of modified when the table is altered, so the
+    // address together with a weak reference identifies the schema
+    struct Entry {
+        std::weak_ptr<::openmldb::nameserver::TableInfo> table_info;
+        std::shared_ptr<const InsertRowLayout> layout;
+    };
+    static thread_local std::unordered_map<const ::openmldb::nameserver::TableInfo*, Entry> cache;
+    auto it = cache.find(table_info.get());
+    if (it != cache.end() && it->second.table_info.lock() == table_info) {
+        return it->second.layout;
+    }
+    if (cache.size() >= MAX_LAYOUT_CACHE_SIZE) {
+        cache.clear();
+    }
+    auto layout = std::make_shared<const InsertRowLayout>(*table_info);
+    cache[table_info.get()] = Entry{table_info, layout};
+    return layout;
+}
+
 SQLInsertRow::SQLInsertRow(std::shared_ptr<::openmldb::nameserver::TableInfo> table_info,
                            std::shared_ptr<hybridse::sdk::Schema> schema, DefaultValueMap default_map,
                            uint32_t default_string_length)
@@ -47,27 +91,11 @@ SQLInsertRow::SQLInsertRow(std::shared_ptr<::openmldb::nameserver::TableInfo> ta
       schema_(schema),
       default_map_(default_map),
       default_string_length_(default_string_length),
-      rb_(table_info->column_desc()),
+      layout_(InsertRowLayout::Get(table_info)),
+      raw_dimensions_(table_info->column_desc_size(), hybridse::codec::NONETOKEN),
+      rb_(table_info->column_desc(), layout_->row_layout),
       val_(),
-      str_size_(0) {
-    std::map<std::string, uint32_t> column_name_map;
-    for (int idx = 0; idx < table_info_->column_desc_size(); idx++) {
-        column_name_map.emplace(table_info_->column_desc(idx).name(), idx);
-    }
-    if (table_info_->column_key_size() > 0) {
-        index_map_.clear();
-        raw_dimensions_.clear();
-        for (int idx = 0; idx < table_info_->column_key_size(); ++idx) {
-            for (const auto& column : table_info_->column_key(idx).col_name()) {
-                index_map_[idx].push_back(column_name_map[column]);
-                raw_dimensions_[column_name_map[column]] = hybridse::codec::NONETOKEN;
-            }
-            if (!table_info_->column_key(idx).ts_name().empty()) {
-                ts_set_.insert(column_name_map[table_info_->column_key(idx).ts_name()]);
-            }
-        }
-    }
-}
+      str_size_(0) {}
 
 bool SQLInsertRow::Init(int str_length) {
     str_size_ = str_length + default_string_length_;
@@ -92,7 +120,7 @@ const std::map<uint32_t, std::vector<std::pair<std::string, uint32_t>>>& SQLInse
     }
     uint32_t pid_num = table_info_->table_partition_size();
     uint32_t pid = 0;
-    for (const auto& kv : index_map_) {
+    for (const auto& kv : layout_->index_map) {
         std::string key;
         for (uint32_t idx : kv.second) {
             if (!key.empty()) {
@@ -270,7 +298,8 @@ bool SQLInsertRow::AppendNULL() {
     if (IsDimension()) {
         PackDimension(hybridse::codec::NONETOKEN);
     }
-    if (ts_set_.count(rb_.GetAppendPos())) {
+    uint32_t pos = rb_.GetAppendPos();
+    if (pos < layout_->is_ts.size() && layout_->is_ts[pos]) {
         return false;
     }
     if (rb_.AppendNULL()) {
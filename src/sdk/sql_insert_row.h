@@ -60,6 +60,22 @@ static inline ::hybridse::sdk::DataType ConvertType(::openmldb::type::DataType t
     }
 }
 
+// The layout of a row and the positions of index and ts columns are the same for all the rows
+// of a table, so they are computed once and shared by the rows instead of on each row
+struct InsertRowLayout {
+    explicit InsertRowLayout(const ::openmldb::nameserver::TableInfo& table_info);
+
+    std::shared_ptr<const ::openmldb::codec::RowLayout> row_layout;
+    // index pos -> positions of its key columns
+    std::map<uint32_t, std::vector<uint32_t>> index_map;
+    std::vector<bool> is_dimension;
+    std::vector<bool> is_ts;
+
+    // the layout is cached per thread and keyed by the table info
+    static std::shared_ptr<const InsertRowLayout> Get(
+        const std::shared_ptr<::openmldb::nameserver::TableInfo>& table_info);
+};
+
 class SQLInsertRow {
  public:
     explicit SQLInsertRow(std::shared_ptr<::openmldb::nameserver::TableInfo> table_info,
@@ -100,16 +116,18 @@ class SQLInsertRow {
     bool DateToString(uint32_t year, uint32_t month, uint32_t day, std::string* date);
     bool MakeDefault();
     void PackDimension(const std::string& val);
-    inline bool IsDimension() { return raw_dimensions_.find(rb_.GetAppendPos()) != raw_dimensions_.end(); }
+    inline bool IsDimension() {
+        uint32_t pos = rb_.GetAppendPos();
+        return pos < layout_->is_dimension.size() && layout_->is_dimension[pos];
+    }
 
  private:
     std::shared_ptr<::openmldb::nameserver::TableInfo> table_info_;
     std::shared_ptr<hybridse::sdk::Schema> schema_;
     DefaultValueMap default_map_;
     uint32_t default_string_length_;
-    std::map<uint32_t, std::vector<uint32_t>> index_map_;
-    std::set<uint32_t> ts_set_;
-    std::map<uint32_t, std::string> raw_dimensions_;
+    std::shared_ptr<const InsertRowLayout> layout_;
+    std::vector<std::string> raw_dimensions_;
     std::map<uint32_t, std::vector<std::pair<std::string, uint32_t>>> dimensions_;
     ::openmldb::codec::RowBuilder rb_;
     std::string val_;
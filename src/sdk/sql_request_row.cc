@@ -31,6 +31,7 @@ static constexpr uint8_t SDK_VERSION_LENGTH = 2;
 static constexpr uint8_t SDK_SIZE_LENGTH = 4;
 static constexpr uint8_t SDK_HEADER_LENGTH = SDK_VERSION_LENGTH + SDK_SIZE_LENGTH;
 static constexpr uint32_t SDK_UINT24_MAX = (1 << 24) - 1;
+static constexpr size_t MAX_LAYOUT_CACHE_SIZE = 64;
 static const std::unordered_map<::hybridse::sdk::DataType, uint8_t> SDK_TYPE_SIZE_MAP = {
     {::hybridse::sdk::kTypeBool, sizeof(bool)},         {::hybridse::sdk::kTypeInt16, sizeof(int16_t)},
     {::hybridse::sdk::kTypeInt32, sizeof(int32_t)},     {::hybridse::sdk::kTypeDate, sizeof(int32_t)},
@@ -51,37 +52,65 @@ static inline uint8_t SDKGetAddrLength(uint32_t size) {
 
 inline uint32_t SDKGetStartOffset(int32_t column_count) { return SDK_HEADER_LENGTH + BitMapSize(column_count); }
 
+RequestRowLayout::RequestRowLayout(const hybridse::sdk::Schema& schema)
+    : offsets(), str_field_cnt(0), str_field_start_offset(SDK_HEADER_LENGTH + BitMapSize(schema.GetColumnCnt())) {
+    offsets.reserve(schema.GetColumnCnt());
+    for (int idx = 0; idx < schema.GetColumnCnt(); idx++) {
+        auto type = schema.GetColumnType(idx);
+        if (type == ::hybridse::sdk::kTypeString) {
+            offsets.push_back(str_field_cnt);
+            str_field_cnt++;
+        } else {
+            auto iter = SDK_TYPE_SIZE_MAP.find(type);
+            if (iter == SDK_TYPE_SIZE_MAP.end()) {
+                // no Append method takes this type
+                LOG(WARNING) << hybridse::sdk::DataTypeName(type) << " is not supported";
+                offsets.push_back(0);
+            } else {
+                offsets.push_back(str_field_start_offset);
+                str_field_start_offset += iter->second;
+            }
+        }
+    }
+}
+
+std::shared_ptr<const RequestRowLayout> RequestRowLayout::Get(const std::shared_ptr<hybridse::sdk::Schema>& schema) {
+    // the address together with a weak reference identifies the schema, as InsertRowLayout does
+    struct Entry {
+        std::weak_ptr<hybridse::sdk::Schema> schema;
+        std::shared_ptr<const RequestRowLayout> layout;
+    };
+    static thread_local std::unordered_map<const hybridse::sdk::Schema*, Entry> cache;
+    auto it = cache.find(schema.get());
+    if (it != cache.end() && it->second.schema.lock() == schema) {
+        return it->second.layout;
+    }
+    if (cache.size() >= MAX_LAYOUT_CACHE_SIZE) {
+        cache.clear();
+    }
+    auto layout = std::make_shared<const RequestRowLayout>(*schema);
+    cache[schema.get()] = Entry{schema, layout};
+    return layout;
+}
+
 SQLRequestRow::SQLRequestRow(std::shared_ptr<hybridse::sdk::Schema> schema, const std::set<std::string>& record_cols)
     : schema_(schema),
+      layout_(RequestRowLayout::Get(schema)),
       cnt_(0),
       size_(0),
-      str_field_cnt_(0),
       str_addr_length_(0),
-      str_field_start_offset_(0),
       str_offset_(0),
-      offset_vec_(),
       val_(),
       buf_(NULL),
       str_length_expect_(0),
       str_length_current_(0),
       has_error_(false),
       is_ok_(false) {
-    str_field_start_offset_ = SDK_HEADER_LENGTH + BitMapSize(schema->GetColumnCnt());
+    if (record_cols.empty()) {
+        return;
+    }
     for (int idx = 0; idx < schema->GetColumnCnt(); idx++) {
-        auto type = schema->GetColumnType(idx);
-        if (type == ::hybridse::sdk::kTypeString) {
-            offset_vec_.push_back(str_field_cnt_);
-            str_field_cnt_++;
-        } else {
-            auto iter = SDK_TYPE_SIZE_MAP.find(type);
-            if (iter == SDK_TYPE_SIZE_MAP.end()) {
-                LOG(WARNING) << hybridse::sdk::DataTypeName(type) << " is not supported";
-            } else {
-                offset_vec_.push_back(str_field_start_offset_);
-                str_field_start_offset_ += iter->second;
-            }
-        }
-        if (!record_cols.empty() && record_cols.find(schema->GetColumnName(idx)) != record_cols.end()) {
+        if (record_cols.find(schema->GetColumnName(idx)) != record_cols.end()) {
             record_cols_.insert(static_cast<uint32_t>(idx));
         }
     }
@@ -95,16 +124,16 @@ bool SQLRequestRow::Init(int32_t str_length) {
     is_ok_ = false;
     str_length_expect_ = str_length;
     str_length_current_ = 0;
-    uint32_t total_length = str_field_start_offset_;
+    uint32_t total_length = layout_->str_field_start_offset;
     total_length += str_length;
-    if (total_length + str_field_cnt_ <= UINT8_MAX) {
-        total_length += str_field_cnt_;
-    } else if (total_length + str_field_cnt_ * 2 <= UINT16_MAX) {
-        total_length += str_field_cnt_ * 2;
-    } else if (total_length + str_field_cnt_ * 3 <= SDK_UINT24_MAX) {
-        total_length += str_field_cnt_ * 3;
-    } else if (total_length + str_field_cnt_ * 4 <= UINT32_MAX) {
-        total_length += str_field_cnt_ * 4;
+    if (total_length + layout_->str_field_cnt <= UINT8_MAX) {
+        total_length += layout_->str_field_cnt;
+    } else if (total_length + layout_->str_field_cnt * 2 <= UINT16_MAX) {
+        total_length += layout_->str_field_cnt * 2;
+    } else if (total_length + layout_->str_field_cnt * 3 <= SDK_UINT24_MAX) {
+        total_length += layout_->str_field_cnt * 3;
+    } else if (total_length + layout_->str_field_cnt * 4 <= UINT32_MAX) {
+        total_length += layout_->str_field_cnt * 4;
     }
     // TODO(wangtaize) limit total length
     val_.resize(total_length);
@@ -117,7 +146,7 @@ bool SQLRequestRow::Init(int32_t str_length) {
     memset(buf_ + SDK_HEADER_LENGTH, 0, bitmap_size);
     cnt_ = 0;
     str_addr_length_ = SDKGetAddrLength(total_length);
-    str_offset_ = str_field_start_offset_ + str_addr_length_ * str_field_cnt_;
+    str_offset_ = layout_->str_field_start_offset + str_addr_length_ * layout_->str_field_cnt;
     return true;
 }
 
@@ -136,19 +165,13 @@ bool SQLRequestRow::Check(hybridse::sdk::DataType type) {
                      << " but real type " << hybridse::sdk::DataTypeName(type);
         return false;
     }
-    if (type != ::hybridse::sdk::kTypeString) {
-        auto iter = SDK_TYPE_SIZE_MAP.find(type);
-        if (iter == SDK_TYPE_SIZE_MAP.end()) {
-            LOG(WARNING) << hybridse::sdk::DataTypeName(type) << " is not supported";
-            return false;
-        }
-    }
+    // the types of the Append methods are all supported by the layout
     return true;
 }
 
 bool SQLRequestRow::AppendBool(bool val) {
     if (!Check(::hybridse::sdk::kTypeBool)) return false;
-    int8_t* ptr = buf_ + offset_vec_[cnt_];
+    int8_t* ptr = buf_ + layout_->offsets[cnt_];
     *(reinterpret_cast<uint8_t*>(ptr)) = val ? 1 : 0;
     if (record_cols_.find(cnt_) != record_cols_.end()) {
         if (val) {
@@ -163,7 +186,7 @@ bool SQLRequestRow::AppendBool(bool val) {
 
 bool SQLRequestRow::AppendInt32(int32_t val) {
     if (!Check(::hybridse::sdk::kTypeInt32)) return false;
-    int8_t* ptr = buf_ + offset_vec_[cnt_];
+    int8_t* ptr = buf_ + layout_->offsets[cnt_];
     *(reinterpret_cast<int32_t*>(ptr)) = val;
     if (record_cols_.find(cnt_) != record_cols_.end()) {
         record_value_.emplace(schema_->GetColumnName(cnt_), std::to_string(val));
@@ -174,7 +197,7 @@ bool SQLRequestRow::AppendInt32(int32_t val) {
 
 bool SQLRequestRow::AppendInt16(int16_t val) {
     if (!Check(::hybridse::sdk::kTypeInt16)) return false;
-    int8_t* ptr = buf_ + offset_vec_[cnt_];
+    int8_t* ptr = buf_ + layout_->offsets[cnt_];
     *(reinterpret_cast<int16_t*>(ptr)) = val;
     if (record_cols_.find(cnt_) != record_cols_.end()) {
         record_value_.emplace(schema_->GetColumnName(cnt_), std::to_string(val));
@@ -185,7 +208,7 @@ bool SQLRequestRow::AppendInt16(int16_t val) {
 
 bool SQLRequestRow::AppendInt64(int64_t val) {
     if (!Check(::hybridse::sdk::kTypeInt64)) return false;
-    int8_t* ptr = buf_ + offset_vec_[cnt_];
+    int8_t* ptr = buf_ + layout_->offsets[cnt_];
     *(reinterpret_cast<int64_t*>(ptr)) = val;
     if (record_cols_.find(cnt_) != record_cols_.end()) {
         record_value_.emplace(schema_->GetColumnName(cnt_), std::to_string(val));
@@ -196,7 +219,7 @@ bool SQLRequestRow::AppendInt64(int64_t val) {
 
 bool SQLRequestRow::AppendTimestamp(int64_t val) {
     if (!Check(::hybridse::sdk::kTypeTimestamp)) return false;
-    int8_t* ptr = buf_ + offset_vec_[cnt_];
+    int8_t* ptr = buf_ + layout_->offsets[cnt_];
     *(reinterpret_cast<int64_t*>(ptr)) = val;
     if (record_cols_.find(cnt_) != record_cols_.end()) {
         record_value_.emplace(schema_->GetColumnName(cnt_), std::to_string(val));
@@ -206,7 +229,7 @@ bool SQLRequestRow::AppendTimestamp(int64_t val) {
 }
 bool SQLRequestRow::AppendDate(int32_t val) {
     if (!Check(::hybridse::sdk::kTypeDate)) return false;
-    int8_t* ptr = buf_ + offset_vec_[cnt_];
+    int8_t* ptr = buf_ + layout_->offsets[cnt_];
     *(reinterpret_cast<int32_t*>(ptr)) = val;
     if (record_cols_.find(cnt_) != record_cols_.end()) {
         record_value_.emplace(schema_->GetColumnName(cnt_), std::to_string(val));
@@ -216,7 +239,7 @@ bool SQLRequestRow::AppendDate(int32_t val) {
 }
 bool SQLRequestRow::AppendDate(int32_t year, int32_t month, int32_t day) {
     if (!Check(::hybridse::sdk::kTypeDate)) return false;
-    int8_t* ptr = buf_ + offset_vec_[cnt_];
+    int8_t* ptr = buf_ + layout_->offsets[cnt_];
     int32_t date = 0;
     if (year < 1900 || year > 9999) {
         *(reinterpret_cast<int32_t*>(ptr)) = 0;
@@ -245,7 +268,7 @@ bool SQLRequestRow::AppendDate(int32_t year, int32_t month, int32_t day) {
 }
 bool SQLRequestRow::AppendFloat(float val) {
     if (!Check(::hybridse::sdk::kTypeFloat)) return false;
-    int8_t* ptr = buf_ + offset_vec_[cnt_];
+    int8_t* ptr = buf_ + layout_->offsets[cnt_];
     *(reinterpret_cast<float*>(ptr)) = val;
     if (record_cols_.find(cnt_) != record_cols_.end()) {
         record_value_.emplace(schema_->GetColumnName(cnt_), std::to_string(val));
@@ -256,7 +279,7 @@ bool SQLRequestRow::AppendFloat(float val) {
 
 bool SQLRequestRow::AppendDouble(double val) {
     if (!Check(::hybridse::sdk::kTypeDouble)) return false;
-    int8_t* ptr = buf_ + offset_vec_[cnt_];
+    int8_t* ptr = buf_ + layout_->offsets[cnt_];
     *(reinterpret_cast<double*>(ptr)) = val;
     if (record_cols_.find(cnt_) != record_cols_.end()) {
         record_value_.emplace(schema_->GetColumnName(cnt_), std::to_string(val));
@@ -270,7 +293,7 @@ bool SQLRequestRow::AppendString(const std::string& val) { return AppendString(v
 bool SQLRequestRow::AppendString(const char* string_buffer_var_name, uint32_t length) {
     if (!Check(::hybridse::sdk::kTypeString)) return false;
     if (str_offset_ + length > size_) return false;
-    int8_t* ptr = buf_ + str_field_start_offset_ + str_addr_length_ * offset_vec_[cnt_];
+    int8_t* ptr = buf_ + layout_->str_field_start_offset + str_addr_length_ * layout_->offsets[cnt_];
     if (str_addr_length_ == 1) {
         *(reinterpret_cast<uint8_t*>(ptr)) = (uint8_t)str_offset_;
     } else if (str_addr_length_ == 2) {
@@ -303,7 +326,7 @@ bool SQLRequestRow::AppendNULL() {
     *(reinterpret_cast<uint8_t*>(ptr)) |= 1 << (cnt_ & 0x07);
     auto type = schema_->GetColumnType(cnt_);
     if (type == ::hybridse::sdk::kTypeString) {
-        ptr = buf_ + str_field_start_offset_ + str_addr_length_ * offset_vec_[cnt_];
+        ptr = buf_ + layout_->str_field_start_offset + str_addr_length_ * layout_->offsets[cnt_];
         if (str_addr_length_ == 1) {
             *(reinterpret_cast<uint8_t*>(ptr)) = (uint8_t)str_offset_;
         } else if (str_addr_length_ == 2) {
@@ -30,6 +30,21 @@
 
 namespace openmldb {
 namespace sdk {
+
+// The offsets of the fields are the same for all the request rows of a schema, so they are
+// computed once and shared by the rows instead of on each row
+struct RequestRowLayout {
+    explicit RequestRowLayout(const hybridse::sdk::Schema& schema);
+
+    // the offset of a fixed size field, or the index of a string field among the string fields
+    std::vector<uint32_t> offsets;
+    uint32_t str_field_cnt;
+    uint32_t str_field_start_offset;
+
+    // the layout is cached per thread and keyed by the schema
+    static std::shared_ptr<const RequestRowLayout> Get(const std::shared_ptr<hybridse::sdk::Schema>& schema);
+};
+
 class SQLRequestRow {
  public:
     SQLRequestRow() {}
@@ -62,13 +77,11 @@ class SQLRequestRow {
 
  private:
     std::shared_ptr<hybridse::sdk::Schema> schema_;
+    std::shared_ptr<const RequestRowLayout> layout_;
     uint32_t cnt_;
     uint32_t size_;
-    uint32_t str_field_cnt_;
     uint32_t str_addr_length_;
-    uint32_t str_field_start_offset_;
     uint32_t str_offset_;
-    std::vector<uint32_t> offset_vec_;
     std::string val_;
     int8_t* buf_;
     uint32_t str_length_expect_;
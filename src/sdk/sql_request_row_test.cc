@@ -111,6 +111,39 @@ TEST_F(SQLRequestRowTest, normal_test) {
     ASSERT_EQ(32, i32);
 }
 
+TEST_F(SQLRequestRowTest, shared_layout) {
+    ::hybridse::vm::Schema schema;
+    InitSimpleSchema(&schema);
+    std::shared_ptr<::hybridse::sdk::Schema> schema_shared = std::make_shared<::hybridse::sdk::SchemaImpl>(schema);
+    auto layout = RequestRowLayout::Get(schema_shared);
+    ASSERT_EQ(layout, RequestRowLayout::Get(schema_shared));
+    ASSERT_EQ(1u, layout->str_field_cnt);
+    ASSERT_EQ(std::vector<uint32_t>({7, 0, 11}), layout->offsets);
+    // another schema gets its own layout
+    std::shared_ptr<::hybridse::sdk::Schema> other = std::make_shared<::hybridse::sdk::SchemaImpl>(schema);
+    ASSERT_NE(layout, RequestRowLayout::Get(other));
+
+    // the rows sharing the layout are encoded one by one
+    ::hybridse::codec::RowView rv(schema);
+    for (int32_t i = 0; i < 3; i++) {
+        SQLRequestRow rr(schema_shared, std::set<std::string>());
+        std::string str = "hello" + std::to_string(i);
+        ASSERT_TRUE(rr.Init(str.size()));
+        ASSERT_TRUE(rr.AppendInt32(i));
+        ASSERT_TRUE(rr.AppendString(str));
+        ASSERT_TRUE(rr.AppendInt64(i * 64));
+        ASSERT_TRUE(rr.Build());
+        ASSERT_TRUE(rv.Reset(reinterpret_cast<const int8_t*>(rr.GetRow().c_str()), rr.GetRow().size()));
+        int32_t i32 = -1;
+        ASSERT_EQ(0, rv.GetInt32(0, &i32));
+        ASSERT_EQ(i, i32);
+        ASSERT_EQ(str, rv.GetStringUnsafe(1));
+        int64_t i64 = -1;
+        ASSERT_EQ(0, rv.GetInt64(2, &i64));
+        ASSERT_EQ(i * 64, i64);
+    }
+}
+
 TEST_F(SQLRequestRowTest, GetRecordVal) {
     ::hybridse::vm::Schema schema;
     {
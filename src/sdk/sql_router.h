@@ -75,6 +75,16 @@ class QueryFuture {
     virtual bool IsDone() const = 0;
 };
 
+class InsertFuture {
+ public:
+    InsertFuture() {}
+    virtual ~InsertFuture() {}
+
+    /// wait until the row is put into all its partitions, return false with the error of this row
+    virtual bool Get(hybridse::sdk::Status* status) = 0;
+    virtual bool IsDone() const = 0;
+};
+
 class SQLRouter {
  public:
     SQLRouter() {}
@@ -98,6 +108,13 @@ class SQLRouter {
     virtual bool ExecuteInsert(const std::string& db, const std::string& sql,
                                std::shared_ptr<openmldb::sdk::SQLInsertRows> row, hybridse::sdk::Status* status) = 0;
 
+    /// put the row without waiting for the tablets. Rows to the same tablet are coalesced into
+    /// one request while the previous requests are in flight, and the call blocks when too many
+    /// rows are queued for a tablet. Rows of different requests may be applied in any order.
+    virtual std::shared_ptr<openmldb::sdk::InsertFuture> ExecuteInsertAsync(
+        const std::string& db, const std::string& sql, std::shared_ptr<openmldb::sdk::SQLInsertRow> row,
+        hybridse::sdk::Status* status) = 0;
+
     virtual std::shared_ptr<openmldb::sdk::TableReader> GetTableReader() = 0;
 
     virtual std::shared_ptr<ExplainInfo> Explain(const std::string& db, const std::string& sql,
@@ -42,10 +42,107 @@
 %shared_ptr(openmldb::sdk::ExplainInfo);
 %shared_ptr(hybridse::sdk::ProcedureInfo);
 %shared_ptr(openmldb::sdk::QueryFuture);
+%shared_ptr(openmldb::sdk::InsertFuture);
 %shared_ptr(openmldb::sdk::TableReader);
+%shared_ptr(openmldb::sdk::ColumnarResultSet);
 %template(VectorUint32) std::vector<uint32_t>;
 %template(VectorString) std::vector<std::string>;
 
+// the column buffers of ColumnarResultSet are passed without copy, a memoryview in python
+// and a direct ByteBuffer in java, and each buffer keeps the ColumnarResultSet alive
+%ignore openmldb::sdk::ColumnBuffer;
+#ifdef SWIGPYTHON
+%{
+// the object a column buffer memoryview is exported from, it holds the result set of the buffer
+struct ColumnBufferObject {
+    PyObject_HEAD
+    openmldb::sdk::ColumnBuffer* buffer;
+};
+
+static int ColumnBufferGetBuffer(PyObject* obj, Py_buffer* view, int flags) {
+    auto* buffer = reinterpret_cast<ColumnBufferObject*>(obj)->buffer;
+    return PyBuffer_FillInfo(view, obj, const_cast<void*>(buffer->data), buffer->size, 1, flags);
+}
+
+static void ColumnBufferDealloc(PyObject* obj) {
+    delete reinterpret_cast<ColumnBufferObject*>(obj)->buffer;
+    Py_TYPE(obj)->tp_free(obj);
+}
+
+static PyObject* NewColumnBufferView(const openmldb::sdk::ColumnBuffer& buffer) {
+    static PyBufferProcs procs = {ColumnBufferGetBuffer, nullptr};
+    static PyTypeObject type = {PyVarObject_HEAD_INIT(nullptr, 0)};
+    if (type.tp_name == nullptr) {
+        type.tp_name = "openmldb.ColumnBuffer";
+        type.tp_basicsize = sizeof(ColumnBufferObject);
+        type.tp_flags = Py_TPFLAGS_DEFAULT;
+        type.tp_dealloc = ColumnBufferDealloc;
+        type.tp_as_buffer = &procs;
+        if (PyType_Ready(&type) < 0) {
+            type.tp_name = nullptr;
+            return nullptr;
+        }
+    }
+    auto* obj = PyObject_New(ColumnBufferObject, &type);
+    if (obj == nullptr) {
+        return nullptr;
+    }
+    obj->buffer = new openmldb::sdk::ColumnBuffer(buffer);
+    // the memoryview references obj until it is released
+    PyObject* view = PyMemoryView_FromObject(reinterpret_cast<PyObject*>(obj));
+    Py_DECREF(obj);
+    return view;
+}
+%}
+%typemap(out) openmldb::sdk::ColumnBuffer {
+    if ($1.data == nullptr) {
+        Py_INCREF(Py_None);
+        $result = Py_None;
+    } else {
+        $result = NewColumnBufferView($1);
+        if ($result == nullptr) {
+            SWIG_fail;
+        }
+    }
+}
+#endif
+#ifdef SWIGJAVA
+%typemap(jni) openmldb::sdk::ColumnBuffer "jobject"
+%typemap(jtype) openmldb::sdk::ColumnBuffer "java.nio.ByteBuffer"
+%typemap(jstype) openmldb::sdk::ColumnBuffer "java.nio.ByteBuffer"
+%typemap(javaout) openmldb::sdk::ColumnBuffer {
+    java.nio.ByteBuffer buf = $jnicall;
+    return buf == null ? null : keepAlive(buf.order(java.nio.ByteOrder.nativeOrder()));
+  }
+%typemap(out) openmldb::sdk::ColumnBuffer {
+    $result = $1.data == nullptr ? nullptr : jenv->NewDirectByteBuffer(const_cast<void*>($1.data), $1.size);
+}
+%typemap(javacode) openmldb::sdk::ColumnarResultSet %{
+  // a buffer keeps the result set it points into reachable until the buffer is collected
+  private static final class BufferRef extends java.lang.ref.PhantomReference<java.nio.ByteBuffer> {
+    private final ColumnarResultSet owner;
+
+    BufferRef(java.nio.ByteBuffer buf, ColumnarResultSet owner) {
+      super(buf, BUFFER_QUEUE);
+      this.owner = owner;
+    }
+  }
+
+  private static final java.lang.ref.ReferenceQueue<java.nio.ByteBuffer> BUFFER_QUEUE =
+      new java.lang.ref.ReferenceQueue<java.nio.ByteBuffer>();
+  private static final java.util.Set<BufferRef> BUFFER_REFS =
+      java.util.Collections.newSetFromMap(new java.util.concurrent.ConcurrentHashMap<BufferRef, Boolean>());
+
+  private java.nio.ByteBuffer keepAlive(java.nio.ByteBuffer buf) {
+    for (java.lang.ref.Reference<?> ref = BUFFER_QUEUE.poll(); ref != null; ref = BUFFER_QUEUE.poll()) {
+      BUFFER_REFS.remove(ref);
+    }
+    BUFFER_REFS.add(new BufferRef(buf, this));
+    return buf;
+  }
+%}
+#endif
+
 %{
 #include "sdk/sql_router.h"
 #include "sdk/result_set.h"
@@ -53,6 +150,7 @@
 #include "sdk/sql_request_row.h"
 #include "sdk/sql_insert_row.h"
 #include "sdk/table_reader.h"
+#include "sdk/columnar_result_set.h"
 
 using hybridse::sdk::Schema;
 using hybridse::sdk::ColumnTypes;
@@ -67,7 +165,10 @@ using openmldb::sdk::SQLInsertRows;
 using openmldb::sdk::ExplainInfo;
 using hybridse::sdk::ProcedureInfo;
 using openmldb::sdk::QueryFuture;
+using openmldb::sdk::InsertFuture;
 using openmldb::sdk::TableReader;
+using openmldb::sdk::ColumnarResultSet;
+using openmldb::sdk::ColumnBuffer;
 %}
 
 %include "sdk/sql_router.h"
@@ -76,6 +177,7 @@ using openmldb::sdk::TableReader;
 %include "sdk/sql_request_row.h"
 %include "sdk/sql_insert_row.h"
 %include "sdk/table_reader.h"
+%include "sdk/columnar_result_set.h"
 
 %template(ColumnDescPair) std::pair<std::string, hybridse::sdk::DataType>;
 %template(ColumnDescVector) std::vector<std::pair<std::string, hybridse::sdk::DataType>>;
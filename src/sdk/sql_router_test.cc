@@ -31,9 +31,14 @@
 #include "common/timer.h"
 #include "gflags/gflags.h"
 #include "gtest/gtest.h"
+#include "sdk/columnar_result_set.h"
 #include "sdk/mini_cluster.h"
 #include "vm/catalog.h"
 
+DECLARE_uint32(insert_batch_size);
+DECLARE_uint32(insert_max_in_flight);
+DECLARE_uint32(insert_max_pending);
+
 namespace openmldb {
 namespace sdk {
 
@@ -456,6 +461,167 @@ TEST_F(SQLRouterTest, test_sql_insert_placeholder_with_date_column_key) {
     ASSERT_TRUE(ok);
 }
 
+TEST_F(SQLRouterTest, test_columnar_result_set) {
+    SQLRouterOptions sql_opt;
+    sql_opt.zk_cluster = mc_->GetZkCluster();
+    sql_opt.zk_path = mc_->GetZkPath();
+    auto router = NewClusterSQLRouter(sql_opt);
+    ASSERT_TRUE(router != nullptr);
+    std::string name = "test" + GenRand();
+    std::string db = "db" + GenRand();
+    ::hybridse::sdk::Status status;
+    bool ok = router->CreateDB(db, &status);
+    ASSERT_TRUE(ok);
+    std::string ddl = "create table " + name +
+                      "("
+                      "col1 string, col2 bool, col3 smallint, col4 int, col5 bigint, col6 float, col7 double, "
+                      "col8 date, col9 timestamp, index(key=col1, ts=col9));";
+    ok = router->ExecuteDDL(db, ddl, &status);
+    ASSERT_TRUE(ok);
+    ASSERT_TRUE(router->RefreshCatalog());
+    ASSERT_TRUE(router->ExecuteInsert(
+        db, "insert into " + name + " values('key1', true, 1, 2, 3, 1.5, 2.5, '1970-01-02', 1000);", &status));
+    ASSERT_TRUE(router->ExecuteInsert(
+        db, "insert into " + name + " values('key1', null, null, null, null, null, null, null, 2000);", &status));
+    ASSERT_TRUE(router->ExecuteInsert(
+        db, "insert into " + name + " values('key22', false, 4, 5, 6, 3.5, 4.5, '1970-02-01', 3000);", &status));
+
+    auto rs = router->ExecuteSQL(db, "select * from " + name + ";", &status);
+    ASSERT_TRUE(status.IsOK()) << status.msg;
+    auto columnar = ColumnarResultSet::Make(rs, &status);
+    ASSERT_TRUE(status.IsOK()) << status.msg;
+    ASSERT_EQ(3, columnar->Size());
+    ASSERT_EQ(9, columnar->GetColumnCnt());
+    ASSERT_EQ("col5", columnar->GetColumnName(4));
+    ASSERT_EQ(::hybridse::sdk::kTypeInt64, columnar->GetColumnType(4));
+
+    // read the rows in the order of the result set
+    std::vector<int64_t> ts;
+    rs->Reset();
+    while (rs->Next()) {
+        ts.push_back(rs->GetTimeUnsafe(8));
+    }
+    auto ts_values = columnar->GetValues(8);
+    ASSERT_EQ(3 * static_cast<int64_t>(sizeof(int64_t)), ts_values.size);
+    const auto* ts_data = reinterpret_cast<const int64_t*>(ts_values.data);
+    ASSERT_EQ(ts, std::vector<int64_t>(ts_data, ts_data + 3));
+    int64_t null_row = -1;
+    for (int64_t i = 0; i < 3; i++) {
+        if (ts_data[i] == 2000) {
+            null_row = i;
+        }
+    }
+    for (int col = 1; col < 8; col++) {
+        ASSERT_EQ(1, columnar->GetNullCount(col));
+        const auto* validity = reinterpret_cast<const uint8_t*>(columnar->GetValidity(col).data);
+        for (int64_t i = 0; i < 3; i++) {
+            ASSERT_EQ(i != null_row, static_cast<bool>(validity[0] & (1 << i))) << col << " " << i;
+        }
+    }
+    ASSERT_EQ(0, columnar->GetNullCount(0));
+    ASSERT_EQ(nullptr, columnar->GetOffsets(4).data);
+    for (int64_t i = 0; i < 3; i++) {
+        int64_t v = reinterpret_cast<const int64_t*>(columnar->GetValues(4).data)[i];
+        int32_t days = reinterpret_cast<const int32_t*>(columnar->GetValues(7).data)[i];
+        double d = reinterpret_cast<const double*>(columnar->GetValues(6).data)[i];
+        uint8_t b = reinterpret_cast<const uint8_t*>(columnar->GetValues(1).data)[i];
+        const auto* offsets = reinterpret_cast<const int32_t*>(columnar->GetOffsets(0).data);
+        std::string key(reinterpret_cast<const char*>(columnar->GetValues(0).data) + offsets[i],
+                        offsets[i + 1] - offsets[i]);
+        if (ts_data[i] == 1000) {
+            ASSERT_EQ(3, v);
+            ASSERT_EQ(1, days);
+            ASSERT_EQ(2.5, d);
+            ASSERT_EQ(1, b);
+            ASSERT_EQ("key1", key);
+        } else if (ts_data[i] == 3000) {
+            ASSERT_EQ(6, v);
+            ASSERT_EQ(31, days);
+            ASSERT_EQ(4.5, d);
+            ASSERT_EQ(0, b);
+            ASSERT_EQ("key22", key);
+        } else {
+            ASSERT_EQ(0, v);
+            ASSERT_EQ("key1", key);
+        }
+    }
+    // a buffer keeps the result set alive
+    ts_values = columnar->GetValues(8);
+    columnar.reset();
+    ts_data = reinterpret_cast<const int64_t*>(ts_values.data);
+    ASSERT_EQ(ts, std::vector<int64_t>(ts_data, ts_data + 3));
+
+    ok = router->ExecuteDDL(db, "drop table " + name + ";", &status);
+    ASSERT_TRUE(ok);
+    ok = router->DropDB(db, &status);
+    ASSERT_TRUE(ok);
+}
+
+TEST_F(SQLRouterTest, test_sql_insert_async) {
+    SQLRouterOptions sql_opt;
+    sql_opt.zk_cluster = mc_->GetZkCluster();
+    sql_opt.zk_path = mc_->GetZkPath();
+    auto router = NewClusterSQLRouter(sql_opt);
+    ASSERT_TRUE(router != nullptr);
+    std::string name = "test" + GenRand();
+    std::string db = "db" + GenRand();
+    ::hybridse::sdk::Status status;
+    bool ok = router->CreateDB(db, &status);
+    ASSERT_TRUE(ok);
+    std::string ddl = "create table " + name +
+                      "("
+                      "col1 string, col2 bigint, index(key=col1, ts=col2)) options(partitionnum=4);";
+    ok = router->ExecuteDDL(db, ddl, &status);
+    ASSERT_TRUE(ok);
+    ASSERT_TRUE(router->RefreshCatalog());
+
+    // small batches and windows, so the puts are queued and coalesced
+    uint32_t old_batch_size = FLAGS_insert_batch_size;
+    uint32_t old_in_flight = FLAGS_insert_max_in_flight;
+    uint32_t old_pending = FLAGS_insert_max_pending;
+    FLAGS_insert_batch_size = 8;
+    FLAGS_insert_max_in_flight = 2;
+    FLAGS_insert_max_pending = 32;
+    std::string insert = "insert into " + name + " values(?, ?);";
+    std::vector<std::shared_ptr<InsertFuture>> futures;
+    for (int i = 0; i < 1000; i++) {
+        std::shared_ptr<SQLInsertRow> row = router->GetInsertRow(db, insert, &status);
+        ASSERT_FALSE(row == nullptr);
+        std::string key = "key" + std::to_string(i % 10);
+        ASSERT_TRUE(row->Init(key.size()));
+        ASSERT_TRUE(row->AppendString(key));
+        ASSERT_TRUE(row->AppendInt64(1000 + i));
+        auto future = router->ExecuteInsertAsync(db, insert, row, &status);
+        ASSERT_TRUE(future != nullptr) << status.msg;
+        futures.push_back(future);
+    }
+    for (auto& future : futures) {
+        ASSERT_TRUE(future->Get(&status)) << status.msg;
+        ASSERT_TRUE(future->IsDone());
+    }
+    FLAGS_insert_batch_size = old_batch_size;
+    FLAGS_insert_max_in_flight = old_in_flight;
+    FLAGS_insert_max_pending = old_pending;
+    auto rs = router->ExecuteSQL(db, "select * from " + name + ";", &status);
+    ASSERT_TRUE(rs != nullptr);
+    ASSERT_EQ(1000, rs->Size());
+
+    // the rows are not inserted after the table is dropped, the error is reported per row
+    std::shared_ptr<SQLInsertRow> row = router->GetInsertRow(db, insert, &status);
+    ASSERT_FALSE(row == nullptr);
+    ok = router->ExecuteDDL(db, "drop table " + name + ";", &status);
+    ASSERT_TRUE(ok);
+    ASSERT_TRUE(row->Init(4));
+    ASSERT_TRUE(row->AppendString("key0"));
+    ASSERT_TRUE(row->AppendInt64(1000));
+    auto future = router->ExecuteInsertAsync(db, insert, row, &status);
+    if (future != nullptr) {
+        ASSERT_FALSE(future->Get(&status));
+    }
+    ok = router->DropDB(db, &status);
+    ASSERT_TRUE(ok);
+}
+
 TEST_F(SQLRouterTest, test_sql_insert_placeholder_with_column_key_1) {
     SQLRouterOptions sql_opt;
     sql_opt.zk_cluster = mc_->GetZkCluster();
@@ -21,6 +21,7 @@
 
 #include <memory>
 #include <string>
+#include <thread>  // NOLINT
 #include <vector>
 
 #include "base/file_util.h"
@@ -35,6 +36,9 @@
 #include "test/base_test.h"
 #include "vm/catalog.h"
 
+DECLARE_bool(enable_deploy_coalescing);
+DECLARE_uint32(deploy_coalescing_max_wait_us);
+
 namespace openmldb {
 namespace sdk {
 
@@ -483,6 +487,88 @@ TEST_F(SQLSDKQueryTest, RequestProcedureTest) {
 }
 
 
+static std::string ResultToString(std::shared_ptr<hybridse::sdk::ResultSet> rs) {
+    std::string out;
+    while (rs->Next()) {
+        out.append(rs->GetStringUnsafe(0)).append(",");
+        out.append(std::to_string(rs->GetInt32Unsafe(1))).append(",");
+        out.append(std::to_string(rs->GetInt64Unsafe(2))).append(",");
+        out.append(std::to_string(rs->GetInt64Unsafe(3))).append(";");
+    }
+    return out;
+}
+
+// the tablet runs with FLAGS_enable_deploy_coalescing, see main
+TEST_F(SQLSDKQueryTest, CoalescedProcedureTest) {
+    std::string ddl =
+        "create table trans_coalesced(c1 string, c3 int, c4 bigint, c7 timestamp, index(key=c1, ts=c7));";
+    auto router = router_;
+    ASSERT_TRUE(router != nullptr) << "Fail new cluster sql router";
+    std::string db = "test";
+    hybridse::sdk::Status status;
+    router->CreateDB(db, &status);
+    ASSERT_TRUE(router->ExecuteDDL(db, ddl, &status)) << status.msg;
+    ASSERT_TRUE(router->RefreshCatalog());
+    for (int i = 0; i < 20; i++) {
+        std::string insert_sql = "insert into trans_coalesced values(\"key" + std::to_string(i % 4) + "\"," +
+                                 std::to_string(i) + "," + std::to_string(i * 10) + "," +
+                                 std::to_string(1590738990000 + i * 1000) + ");";
+        ASSERT_TRUE(router->ExecuteInsert(db, insert_sql, &status)) << status.msg;
+    }
+    // no constant column, so the coalesced requests run as one batch request
+    std::string sql =
+        "SELECT c1, c3, sum(c4) OVER w1 as w1_c4_sum, count(c4) OVER w1 as w1_c4_cnt FROM trans_coalesced WINDOW w1 AS"
+        " (PARTITION BY trans_coalesced.c1 ORDER BY trans_coalesced.c7 ROWS BETWEEN 2 PRECEDING AND CURRENT ROW);";
+    std::string sp_name = "sp_coalesced";
+    std::string sp_ddl = "create procedure " + sp_name + " (c1 string, c3 int, c4 bigint, c7 timestamp) begin " +
+                         sql + " end;";
+    ASSERT_TRUE(router->ExecuteDDL(db, sp_ddl, &status)) << status.msg;
+    ASSERT_TRUE(router->RefreshCatalog());
+
+    const int request_num = 256;
+    std::vector<std::shared_ptr<SQLRequestRow>> request_rows;
+    for (int i = 0; i < request_num; i++) {
+        auto request_row = router->GetRequestRow(db, sql, &status);
+        ASSERT_TRUE(request_row);
+        std::string key = "key" + std::to_string(i % 5);
+        request_row->Init(key.size());
+        ASSERT_TRUE(request_row->AppendString(key));
+        ASSERT_TRUE(request_row->AppendInt32(100 + i));
+        ASSERT_TRUE(request_row->AppendInt64(i));
+        ASSERT_TRUE(request_row->AppendTimestamp(1590738990000 + i * 100));
+        ASSERT_TRUE(request_row->Build());
+        request_rows.push_back(request_row);
+    }
+    // the output of each request run on its own
+    std::vector<std::string> expected;
+    for (const auto& request_row : request_rows) {
+        auto rs = router->ExecuteSQLRequest(db, sql, request_row, &status);
+        ASSERT_TRUE(rs) << status.msg;
+        expected.push_back(ResultToString(rs));
+    }
+    // the concurrent calls of the procedure are coalesced
+    const int thread_num = 16;
+    std::vector<std::string> results(request_num);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < thread_num; t++) {
+        workers.emplace_back([&, t] {
+            for (int i = t; i < request_num; i += thread_num) {
+                hybridse::sdk::Status call_status;
+                auto rs = router->CallProcedure(db, sp_name, request_rows[i], &call_status);
+                results[i] = rs ? ResultToString(rs) : "error: " + call_status.msg;
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (int i = 0; i < request_num; i++) {
+        ASSERT_EQ(expected[i], results[i]) << "request " << i;
+    }
+    ASSERT_TRUE(router->ExecuteDDL(db, "drop procedure " + sp_name + ";", &status));
+    ASSERT_TRUE(router->ExecuteDDL(db, "drop table trans_coalesced;", &status));
+}
+
 TEST_F(SQLSDKQueryTest, DropTableWithProcedureTest) {
     // create table trans
     std::string ddl =
@@ -877,6 +963,8 @@ int main(int argc, char** argv) {
     ::hybridse::vm::Engine::InitializeGlobalLLVM();
     ::testing::InitGoogleTest(&argc, argv);
     srand(time(NULL));
+    FLAGS_enable_deploy_coalescing = true;
+    FLAGS_deploy_coalescing_max_wait_us = 2000;
     ::openmldb::sdk::StandaloneEnv env;
     env.SetUp();
     // connect to nameserver
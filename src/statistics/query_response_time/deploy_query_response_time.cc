@@ -45,9 +45,9 @@ void DeployResponseTimeRowReducer::Reduce(const std::string &dp_name, TIME time,
 }
 
 absl::Status DeployQueryTimeCollector::Collect(const std::string& deploy_name, absl::Duration time) {
-    absl::ReaderMutexLock lock(&mutex_);
-    auto it = collectors_.find(deploy_name);
-    if (it == collectors_.end()) {
+    auto collectors = GetCollectors();
+    auto it = collectors->find(deploy_name);
+    if (it == collectors->end()) {
         return absl::NotFoundError(absl::StrCat("deploy name ", deploy_name, " not found"));
     }
 
@@ -56,30 +56,37 @@ absl::Status DeployQueryTimeCollector::Collect(const std::string& deploy_name, a
 }
 
 absl::Status DeployQueryTimeCollector::AddDeploy(const std::string& deploy_name) {
-    absl::WriterMutexLock lock(&mutex_);
-    if (collectors_.find(deploy_name) != collectors_.end()) {
+    absl::MutexLock lock(&mutex_);
+    auto collectors = GetCollectors();
+    if (collectors->find(deploy_name) != collectors->end()) {
         return absl::AlreadyExistsError(absl::StrCat("deploy name ", deploy_name, " already exists"));
     }
-    collectors_.emplace(deploy_name, std::make_shared<TimeCollector>());
+    auto new_collectors = std::make_shared<CollectorMap>(*collectors);
+    new_collectors->emplace(deploy_name, std::make_shared<TimeCollector>());
+    std::atomic_store_explicit(&collectors_, std::shared_ptr<const CollectorMap>(new_collectors),
+                               std::memory_order_release);
     return absl::OkStatus();
 }
 
 absl::Status DeployQueryTimeCollector::DeleteDeploy(const std::string& deploy_name) {
-    absl::WriterMutexLock lock(&mutex_);
-    auto it = collectors_.find(deploy_name);
-    if (it == collectors_.end()) {
+    absl::MutexLock lock(&mutex_);
+    auto collectors = GetCollectors();
+    if (collectors->find(deploy_name) == collectors->end()) {
         return absl::NotFoundError(absl::StrCat("deploy name ", deploy_name, " not found"));
     }
 
-    collectors_.erase(it);
+    auto new_collectors = std::make_shared<CollectorMap>(*collectors);
+    new_collectors->erase(deploy_name);
+    std::atomic_store_explicit(&collectors_, std::shared_ptr<const CollectorMap>(new_collectors),
+                               std::memory_order_release);
     return absl::OkStatus();
 }
 
 absl::StatusOr<std::vector<DeployResponseTimeRow>> DeployQueryTimeCollector::GetRows(
     const std::string& deploy_name) const {
-    absl::ReaderMutexLock lock(&mutex_);
-    auto it = collectors_.find(deploy_name);
-    if (it == collectors_.end()) {
+    auto collectors = GetCollectors();
+    auto it = collectors->find(deploy_name);
+    if (it == collectors->end()) {
         return absl::NotFoundError(absl::StrCat("deploy name ", deploy_name, " not found"));
     }
 
@@ -93,10 +100,10 @@ absl::StatusOr<std::vector<DeployResponseTimeRow>> DeployQueryTimeCollector::Get
 }
 
 std::vector<DeployResponseTimeRow> DeployQueryTimeCollector::GetRows() const {
-    absl::ReaderMutexLock lock(&mutex_);
+    auto collectors = GetCollectors();
     std::vector<DeployResponseTimeRow> rows;
-    rows.reserve(GetRecordsCnt());
-    for (auto& kv : collectors_) {
+    rows.reserve(GetRecordsCnt(*collectors));
+    for (auto& kv : *collectors) {
         for (auto idx = 0u; idx < kv.second->BucketCount(); ++idx) {
             auto row = kv.second->GetRow(idx);
             rows.emplace_back(kv.first, row->time_, row->count_, row->total_);
@@ -106,11 +113,11 @@ std::vector<DeployResponseTimeRow> DeployQueryTimeCollector::GetRows() const {
 }
 
 std::vector<DeployResponseTimeRow> DeployQueryTimeCollector::Flush() {
-    absl::ReaderMutexLock lock(&mutex_);
+    auto collectors = GetCollectors();
 
     std::vector<DeployResponseTimeRow> rows;
-    rows.reserve(GetRecordsCnt());
-    for (auto& kv : collectors_) {
+    rows.reserve(GetRecordsCnt(*collectors));
+    for (auto& kv : *collectors) {
         auto rs = kv.second->Flush();
         for (auto& r : rs) {
             rows.emplace_back(kv.first, r.time_, r.count_, r.total_);
@@ -120,9 +127,27 @@ std::vector<DeployResponseTimeRow> DeployQueryTimeCollector::Flush() {
     return rows;
 }
 
-uint32_t DeployQueryTimeCollector::GetRecordsCnt() const {
+absl::StatusOr<HistogramSnapshot> DeployQueryTimeCollector::GetHistogram(const std::string& deploy_name) const {
+    auto collectors = GetCollectors();
+    auto it = collectors->find(deploy_name);
+    if (it == collectors->end()) {
+        return absl::NotFoundError(absl::StrCat("deploy name ", deploy_name, " not found"));
+    }
+    return it->second->GetHistogram();
+}
+
+std::map<std::string, HistogramSnapshot> DeployQueryTimeCollector::GetHistograms() const {
+    auto collectors = GetCollectors();
+    std::map<std::string, HistogramSnapshot> histograms;
+    for (auto& kv : *collectors) {
+        histograms.emplace(kv.first, kv.second->GetHistogram());
+    }
+    return histograms;
+}
+
+uint32_t DeployQueryTimeCollector::GetRecordsCnt(const CollectorMap& collectors) {
     uint32_t cnt = 0;
-    for (auto& kv : collectors_) {
+    for (auto& kv : collectors) {
         cnt += kv.second->BucketCount();
     }
     return cnt;
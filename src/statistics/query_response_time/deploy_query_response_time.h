@@ -74,6 +74,9 @@ class DeployResponseTimeRowReducer {
     std::map<std::string, std::map<TIME, std::shared_ptr<DeployResponseTimeRow>>> cache_;
 };
 
+// collectors of all deployments. Collect is on the request path and never takes the mutex:
+// the deployment map is copy-on-write, readers load a snapshot of it, and writers (add / delete
+// deployment, which are rare) copy the map and publish the new one under mutex_
 class DeployQueryTimeCollector {
  public:
     DeployQueryTimeCollector() {}
@@ -82,7 +85,7 @@ class DeployQueryTimeCollector {
 
     ~DeployQueryTimeCollector() {}
 
-    absl::Status Collect(const std::string& deploy_name, absl::Duration time) LOCKS_EXCLUDED(mutex_);
+    absl::Status Collect(const std::string& deploy_name, absl::Duration time);
 
     absl::Status AddDeploy(const std::string& deploy_name) LOCKS_EXCLUDED(mutex_);
 
@@ -95,12 +98,24 @@ class DeployQueryTimeCollector {
 
     std::vector<DeployResponseTimeRow> GetRows() const LOCKS_EXCLUDED(mutex_);
 
+    /// \brief latency histogram (microseconds) of deployment since last flush
+    absl::StatusOr<HistogramSnapshot> GetHistogram(const std::string& deploy_name) const;
+
+    /// \brief latency histograms (microseconds) of all deployments since last flush
+    std::map<std::string, HistogramSnapshot> GetHistograms() const;
+
  private:
-    uint32_t GetRecordsCnt() const SHARED_LOCKS_REQUIRED(mutex_);
+    using CollectorMap = std::unordered_map<std::string, std::shared_ptr<TimeCollector>>;
+
+    std::shared_ptr<const CollectorMap> GetCollectors() const {
+        return std::atomic_load_explicit(&collectors_, std::memory_order_acquire);
+    }
+
+    static uint32_t GetRecordsCnt(const CollectorMap& collectors);
 
  private:
-    std::unordered_map<std::string, std::shared_ptr<TimeCollector>> collectors_ GUARDED_BY(mutex_);
-    mutable absl::Mutex mutex_;  // protects collectors_
+    std::shared_ptr<const CollectorMap> collectors_ = std::make_shared<const CollectorMap>();
+    mutable absl::Mutex mutex_;  // serializes writers of collectors_
 };
 
 }  // namespace statistics
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2022 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "statistics/query_response_time/latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "absl/strings/str_cat.h"
+
+namespace openmldb {
+namespace statistics {
+
+uint32_t ThisThreadIdx() {
+    static std::atomic<uint32_t> next_idx{0};
+    thread_local uint32_t idx = next_idx.fetch_add(1, std::memory_order_relaxed);
+    return idx;
+}
+
+LatencyHistogram::LatencyHistogram() : sum_(0), max_(0) {
+    for (auto& cnt : counts_) {
+        cnt.store(0, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::Record(uint64_t value) {
+    counts_[GetBucketIdx(value)].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    uint64_t cur_max = max_.load(std::memory_order_relaxed);
+    while (value > cur_max && !max_.compare_exchange_weak(cur_max, value, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::Flush(std::vector<uint64_t>* counts, uint64_t* sum, uint64_t* max) {
+    counts->resize(kBucketCount, 0);
+    for (uint32_t idx = 0; idx < kBucketCount; idx++) {
+        (*counts)[idx] += counts_[idx].exchange(0, std::memory_order_relaxed);
+    }
+    *sum += sum_.exchange(0, std::memory_order_relaxed);
+    *max = std::max(*max, max_.exchange(0, std::memory_order_relaxed));
+}
+
+uint32_t LatencyHistogram::GetBucketIdx(uint64_t value) {
+    if (value >= (1ul << kMaxValueBits)) {
+        return kBucketCount - 1;
+    }
+    if (value < kSubBucketCount) {
+        return value;
+    }
+    uint32_t power = 63 - __builtin_clzll(value);
+    uint32_t shift = power - (kSubBucketBits - 1);
+    uint64_t sub_idx = (value >> shift) - kSubBucketHalfCount;
+    return kSubBucketCount + (power - kSubBucketBits) * kSubBucketHalfCount + sub_idx;
+}
+
+uint64_t LatencyHistogram::LowestEquivalentValue(uint32_t idx) {
+    if (idx < kSubBucketCount) {
+        return idx;
+    }
+    uint32_t offset = idx - kSubBucketCount;
+    uint32_t power = offset / kSubBucketHalfCount + kSubBucketBits;
+    uint64_t sub_idx = offset % kSubBucketHalfCount;
+    return (kSubBucketHalfCount + sub_idx) << (power - (kSubBucketBits - 1));
+}
+
+uint64_t LatencyHistogram::HighestEquivalentValue(uint32_t idx) {
+    if (idx < kSubBucketCount) {
+        return idx;
+    }
+    uint32_t power = (idx - kSubBucketCount) / kSubBucketHalfCount + kSubBucketBits;
+    return LowestEquivalentValue(idx) + (1ul << (power - (kSubBucketBits - 1))) - 1;
+}
+
+void HistogramSnapshot::Merge(const LatencyHistogram& histogram) {
+    for (uint32_t idx = 0; idx < LatencyHistogram::kBucketCount; idx++) {
+        uint64_t cnt = histogram.GetCount(idx);
+        counts_[idx] += cnt;
+        count_ += cnt;
+    }
+    sum_ += histogram.GetSum();
+    max_ = std::max(max_, histogram.GetMax());
+}
+
+void HistogramSnapshot::Merge(const HistogramSnapshot& snapshot) { Add(snapshot.counts_, snapshot.sum_, snapshot.max_); }
+
+void HistogramSnapshot::Add(const std::vector<uint64_t>& counts, uint64_t sum, uint64_t max) {
+    for (size_t idx = 0; idx < counts.size() && idx < counts_.size(); idx++) {
+        counts_[idx] += counts[idx];
+        count_ += counts[idx];
+    }
+    sum_ += sum;
+    max_ = std::max(max_, max);
+}
+
+uint64_t HistogramSnapshot::ValueAtPercentile(double percentile) const {
+    if (count_ == 0) {
+        return 0;
+    }
+    percentile = std::min(std::max(percentile, 0.0), 100.0);
+    uint64_t target = std::max(static_cast<uint64_t>(std::ceil(percentile / 100 * count_)), 1ul);
+    uint64_t seen = 0;
+    for (uint32_t idx = 0; idx < counts_.size(); idx++) {
+        seen += counts_[idx];
+        if (seen >= target) {
+            return std::min(LatencyHistogram::HighestEquivalentValue(idx), max_);
+        }
+    }
+    return max_;
+}
+
+std::string HistogramSnapshot::ToString() const {
+    return absl::StrCat("count=", count_, " mean=", Mean(), " p50=", ValueAtPercentile(50),
+                        " p90=", ValueAtPercentile(90), " p99=", ValueAtPercentile(99),
+                        " p999=", ValueAtPercentile(99.9), " max=", max_);
+}
+
+HistogramSnapshot ThreadLocalHistogram::Snapshot() const {
+    HistogramSnapshot snapshot;
+    shards_.ForEach([&snapshot](const LatencyHistogram* shard) { snapshot.Merge(*shard); });
+    return snapshot;
+}
+
+HistogramSnapshot ThreadLocalHistogram::Flush() {
+    std::vector<uint64_t> counts(LatencyHistogram::kBucketCount, 0);
+    uint64_t sum = 0;
+    uint64_t max = 0;
+    shards_.ForEach([&](LatencyHistogram* shard) { shard->Flush(&counts, &sum, &max); });
+    HistogramSnapshot snapshot;
+    snapshot.Add(counts, sum, max);
+    return snapshot;
+}
+
+}  // namespace statistics
+}  // namespace openmldb
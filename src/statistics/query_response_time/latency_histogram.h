@@ -0,0 +1,176 @@
+/*
+ * Copyright 2022 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_STATISTICS_QUERY_RESPONSE_TIME_LATENCY_HISTOGRAM_H_
+#define SRC_STATISTICS_QUERY_RESPONSE_TIME_LATENCY_HISTOGRAM_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace openmldb {
+namespace statistics {
+
+// return a small dense index of the current thread, start from 0
+uint32_t ThisThreadIdx();
+
+// ThreadShards keeps one `Shard` per thread, so that writers on different threads never touch
+// the same cache line. Shards are allocated lazily with CAS, readers visit all shards and merge.
+// Threads beyond kMaxThreadShards share shards, so `Shard` must still be safe for concurrent writers.
+template <typename Shard>
+class ThreadShards {
+ public:
+    static constexpr uint32_t kMaxThreadShards = 64;
+
+    ThreadShards() {
+        for (auto& shard : shards_) {
+            shard.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    // shards are not copyable
+    ThreadShards(const ThreadShards&) = delete;
+
+    ~ThreadShards() {
+        for (auto& shard : shards_) {
+            delete shard.load(std::memory_order_relaxed);
+        }
+    }
+
+    Shard* Local() {
+        auto& slot = shards_[ThisThreadIdx() % kMaxThreadShards];
+        Shard* shard = slot.load(std::memory_order_acquire);
+        if (shard != nullptr) {
+            return shard;
+        }
+        Shard* new_shard = new Shard();
+        if (slot.compare_exchange_strong(shard, new_shard, std::memory_order_acq_rel)) {
+            return new_shard;
+        }
+        delete new_shard;
+        return shard;
+    }
+
+    template <typename Fn>
+    void ForEach(Fn&& fn) const {
+        for (auto& slot : shards_) {
+            Shard* shard = slot.load(std::memory_order_acquire);
+            if (shard != nullptr) {
+                fn(shard);
+            }
+        }
+    }
+
+ private:
+    std::atomic<Shard*> shards_[kMaxThreadShards];
+};
+
+// LatencyHistogram is an HDR style histogram with log-linear buckets.
+// Values below 2 ^ kSubBucketBits are recorded exactly, each range [2 ^ k, 2 ^ (k + 1)) above is divided into
+// 2 ^ (kSubBucketBits - 1) equal sub buckets, so the relative error of a recorded value is at most
+// 2 ^ -(kSubBucketBits - 1). Values beyond 2 ^ kMaxValueBits are recorded into the last bucket.
+//
+// All counters are relaxed atomics, it is meant to be written by one thread and read by others.
+class LatencyHistogram {
+ public:
+    static constexpr uint32_t kSubBucketBits = 6;
+    static constexpr uint32_t kMaxValueBits = 40;
+    static constexpr uint64_t kSubBucketCount = 1ul << kSubBucketBits;
+    static constexpr uint64_t kSubBucketHalfCount = kSubBucketCount >> 1;
+    static constexpr uint32_t kBucketCount = kSubBucketCount + (kMaxValueBits - kSubBucketBits) * kSubBucketHalfCount;
+
+    LatencyHistogram();
+
+    // histogram is not copyable
+    LatencyHistogram(const LatencyHistogram&) = delete;
+
+    void Record(uint64_t value);
+
+    uint64_t GetCount(uint32_t idx) const { return counts_[idx].load(std::memory_order_relaxed); }
+    uint64_t GetSum() const { return sum_.load(std::memory_order_relaxed); }
+    uint64_t GetMax() const { return max_.load(std::memory_order_relaxed); }
+
+    // reset the counters and return the old counts in `counts`, which are accumulated into
+    void Flush(std::vector<uint64_t>* counts, uint64_t* sum, uint64_t* max);
+
+    static uint32_t GetBucketIdx(uint64_t value);
+
+    // the smallest value that is recorded into bucket `idx`
+    static uint64_t LowestEquivalentValue(uint32_t idx);
+
+    // the largest value that is recorded into bucket `idx`
+    static uint64_t HighestEquivalentValue(uint32_t idx);
+
+ private:
+    std::atomic<uint64_t> counts_[kBucketCount];
+    std::atomic<uint64_t> sum_;
+    std::atomic<uint64_t> max_;
+};
+
+// HistogramSnapshot is a plain copy of one or more merged LatencyHistogram
+class HistogramSnapshot {
+ public:
+    HistogramSnapshot() : counts_(LatencyHistogram::kBucketCount, 0), count_(0), sum_(0), max_(0) {}
+
+    void Merge(const LatencyHistogram& histogram);
+
+    void Merge(const HistogramSnapshot& snapshot);
+
+    void Add(const std::vector<uint64_t>& counts, uint64_t sum, uint64_t max);
+
+    uint64_t Count() const { return count_; }
+    uint64_t Sum() const { return sum_; }
+    uint64_t Max() const { return max_; }
+    double Mean() const { return count_ == 0 ? 0 : static_cast<double>(sum_) / count_; }
+
+    // return the value at `percentile` (0 ~ 100), 0 if nothing is recorded
+    uint64_t ValueAtPercentile(double percentile) const;
+
+    // e.g. "count=100 mean=12.5 p50=11 p90=20 p99=31 p999=40 max=40"
+    std::string ToString() const;
+
+ private:
+    std::vector<uint64_t> counts_;
+    uint64_t count_;
+    uint64_t sum_;
+    uint64_t max_;
+};
+
+// ThreadLocalHistogram records into per-thread LatencyHistogram shards without any lock,
+// and merges the shards on read
+class ThreadLocalHistogram {
+ public:
+    ThreadLocalHistogram() {}
+
+    // histogram is not copyable
+    ThreadLocalHistogram(const ThreadLocalHistogram&) = delete;
+
+    void Record(uint64_t value) { shards_.Local()->Record(value); }
+
+    HistogramSnapshot Snapshot() const;
+
+    // reset all shards, return the merged old data
+    HistogramSnapshot Flush();
+
+ private:
+    ThreadShards<LatencyHistogram> shards_;
+};
+
+}  // namespace statistics
+}  // namespace openmldb
+
+#endif  // SRC_STATISTICS_QUERY_RESPONSE_TIME_LATENCY_HISTOGRAM_H_
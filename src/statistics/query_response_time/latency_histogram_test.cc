@@ -0,0 +1,129 @@
+/*
+ * Copyright 2022 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "statistics/query_response_time/latency_histogram.h"
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace statistics {
+
+class LatencyHistogramTest : public ::testing::Test {
+ public:
+    ~LatencyHistogramTest() override {}
+};
+
+TEST_F(LatencyHistogramTest, BucketIdx) {
+    for (uint64_t v = 0; v < LatencyHistogram::kSubBucketCount; v++) {
+        EXPECT_EQ(v, LatencyHistogram::GetBucketIdx(v));
+    }
+    uint32_t last_idx = 0;
+    for (uint64_t v = 1; v < (1ul << LatencyHistogram::kMaxValueBits); v = v * 3 / 2 + 1) {
+        uint32_t idx = LatencyHistogram::GetBucketIdx(v);
+        ASSERT_LT(idx, LatencyHistogram::kBucketCount);
+        ASSERT_GE(idx, last_idx);
+        ASSERT_LE(LatencyHistogram::LowestEquivalentValue(idx), v);
+        ASSERT_GE(LatencyHistogram::HighestEquivalentValue(idx), v);
+        last_idx = idx;
+    }
+    // buckets are continuous
+    for (uint32_t idx = 1; idx < LatencyHistogram::kBucketCount; idx++) {
+        ASSERT_EQ(LatencyHistogram::HighestEquivalentValue(idx - 1) + 1, LatencyHistogram::LowestEquivalentValue(idx));
+    }
+    EXPECT_EQ(LatencyHistogram::kBucketCount - 1, LatencyHistogram::GetBucketIdx(UINT64_MAX));
+}
+
+TEST_F(LatencyHistogramTest, Percentile) {
+    ThreadLocalHistogram histogram;
+    HistogramSnapshot empty = histogram.Snapshot();
+    EXPECT_EQ(0u, empty.Count());
+    EXPECT_EQ(0u, empty.ValueAtPercentile(99));
+
+    for (uint64_t v = 1; v <= 10000; v++) {
+        histogram.Record(v);
+    }
+    auto snapshot = histogram.Snapshot();
+    EXPECT_EQ(10000u, snapshot.Count());
+    EXPECT_EQ(10000u * 10001 / 2, snapshot.Sum());
+    EXPECT_EQ(10000u, snapshot.Max());
+    // relative error is less than 1 / 32
+    for (double p : {1.0, 50.0, 90.0, 99.0, 99.9}) {
+        double expect = p * 100;
+        double value = snapshot.ValueAtPercentile(p);
+        EXPECT_GE(value, expect) << "p" << p;
+        EXPECT_LE(value, expect * (1 + 1.0 / 32)) << "p" << p;
+    }
+    EXPECT_EQ(10000u, snapshot.ValueAtPercentile(100));
+}
+
+TEST_F(LatencyHistogramTest, MultiThread) {
+    ThreadLocalHistogram histogram;
+    const uint64_t thread_num = 8;
+    const uint64_t cnt = 100000;
+    std::vector<std::thread> threads;
+    for (uint64_t i = 0; i < thread_num; i++) {
+        threads.emplace_back([&histogram, i, cnt]() {
+            for (uint64_t v = 0; v < cnt; v++) {
+                histogram.Record(i * cnt + v);
+            }
+        });
+    }
+    // read while writing
+    uint64_t flushed_cnt = 0;
+    uint64_t flushed_sum = 0;
+    for (int i = 0; i < 10; i++) {
+        auto snapshot = histogram.Flush();
+        flushed_cnt += snapshot.Count();
+        flushed_sum += snapshot.Sum();
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    auto snapshot = histogram.Flush();
+    flushed_cnt += snapshot.Count();
+    flushed_sum += snapshot.Sum();
+    EXPECT_EQ(thread_num * cnt, flushed_cnt);
+    EXPECT_EQ(thread_num * cnt * (thread_num * cnt - 1) / 2, flushed_sum);
+
+    EXPECT_EQ(0u, histogram.Snapshot().Count());
+}
+
+TEST_F(LatencyHistogramTest, Merge) {
+    ThreadLocalHistogram h1;
+    ThreadLocalHistogram h2;
+    for (uint64_t v = 0; v < 100; v++) {
+        h1.Record(v);
+        h2.Record(v + 100);
+    }
+    auto snapshot = h1.Snapshot();
+    snapshot.Merge(h2.Snapshot());
+    EXPECT_EQ(200u, snapshot.Count());
+    EXPECT_EQ(199u, snapshot.Max());
+    EXPECT_EQ(199u * 200 / 2, snapshot.Sum());
+    EXPECT_LE(snapshot.ValueAtPercentile(50), 100u);
+    EXPECT_GE(snapshot.ValueAtPercentile(50), 99u);
+}
+
+}  // namespace statistics
+}  // namespace openmldb
+
+int main(int argc, char* argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
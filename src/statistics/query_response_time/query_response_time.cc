@@ -26,29 +26,32 @@ namespace statistics {
 
 TimeCollector::TimeCollector()
     : helper_(TIME_DISTRIBUTION_BASE, TIME_DISTRIBUTION_NEGATIVE_POWER_COUNT,
-              TIME_DISTRIBUTION_NON_NEGATIVE_POWER_COUNT) {
-    Setup();
-}
-
-// TimeCollector(std::initializer_list<std::initializer_list<ResponseTimeRow>> data) {}
+              TIME_DISTRIBUTION_NON_NEGATIVE_POWER_COUNT) {}
 
 void TimeCollector::Collect(absl::Duration time) {
-    for (size_t idx = 0; idx < helper_.BucketCount(); ++idx) {
-        if (time <= helper_.UpperBound(idx).value()) {
-            count_[idx].fetch_add(1, std::memory_order_relaxed);
-            total_[idx].fetch_add(absl::ToInt64Microseconds(time), std::memory_order_relaxed);
-            break;
-        }
-    }
+    size_t idx = GetBucketIdx(time);
+    int64_t us = absl::ToInt64Microseconds(time);
+    auto shard = shards_.Local();
+    shard->count_[idx].fetch_add(1, std::memory_order_relaxed);
+    shard->total_[idx].fetch_add(us, std::memory_order_relaxed);
+    histogram_.Record(us < 0 ? 0 : us);
 }
 
 std::vector<ResponseTimeRow> TimeCollector::Flush() {
+    std::vector<uint32_t> cnts(BucketCount(), 0);
+    std::vector<uint64_t> totals(BucketCount(), 0);
+    shards_.ForEach([&cnts, &totals](Shard* shard) {
+        for (size_t idx = 0; idx < cnts.size(); ++idx) {
+            cnts[idx] += shard->count_[idx].exchange(0, std::memory_order_relaxed);
+            totals[idx] += shard->total_[idx].exchange(0, std::memory_order_relaxed);
+        }
+    });
+    histogram_.Flush();
+
     std::vector<ResponseTimeRow> rows;
     rows.reserve(BucketCount());
     for (size_t idx = 0; idx < helper_.BucketCount(); ++idx) {
-        auto cnt = count_[idx].exchange(0, std::memory_order_relaxed);
-        auto total = total_[idx].exchange(0, std::memory_order_relaxed);
-        rows.emplace_back(helper_.UpperBound(idx).value(), cnt, absl::Microseconds(total));
+        rows.emplace_back(helper_.UpperBoundUnchecked(idx), cnts[idx], absl::Microseconds(totals[idx]));
     }
     return rows;
 }
@@ -56,8 +59,7 @@ std::vector<ResponseTimeRow> TimeCollector::Flush() {
 size_t TimeCollector::GetBucketIdx(absl::Duration time) {
     size_t idx = 0;
     while (idx < helper_.BucketCount()) {
-        // do not check the status from UpperBound since we assume it is always ok
-        if (time <= helper_.UpperBound(idx).value()) {
+        if (time <= helper_.UpperBoundUnchecked(idx)) {
             return idx;
         }
         idx++;
@@ -70,13 +72,6 @@ absl::StatusOr<absl::Duration> TimeCollector::GetUpperBound(size_t idx) const {
 
 uint32_t TimeCollector::BucketCount() const { return helper_.BucketCount(); }
 
-void TimeCollector::Setup() {
-    for (size_t idx = 0; idx < helper_.BucketCount(); ++idx) {
-        count_[idx] = 0;
-        total_[idx] = 0;
-    }
-}
-
 absl::StatusOr<ResponseTimeRow> TimeCollector::GetRow(size_t idx) const {
     auto bound = GetUpperBound(idx);
     if (!bound.ok()) {
@@ -85,9 +80,18 @@ absl::StatusOr<ResponseTimeRow> TimeCollector::GetRow(size_t idx) const {
     return ResponseTimeRow{bound.value(), GetCount(idx), GetTotalUnited(idx)};
 }
 
-uint32_t TimeCollector::GetCount(size_t idx) const { return count_[idx].load(std::memory_order_relaxed); }
+uint32_t TimeCollector::GetCount(size_t idx) const {
+    uint32_t cnt = 0;
+    shards_.ForEach([&cnt, idx](const Shard* shard) { cnt += shard->count_[idx].load(std::memory_order_relaxed); });
+    return cnt;
+}
 
-uint64_t TimeCollector::GetTotal(size_t idx) const { return total_[idx].load(std::memory_order_relaxed); }
+uint64_t TimeCollector::GetTotal(size_t idx) const {
+    uint64_t total = 0;
+    shards_.ForEach(
+        [&total, idx](const Shard* shard) { total += shard->total_[idx].load(std::memory_order_relaxed); });
+    return total;
+}
 
 absl::StatusOr<absl::Duration> TimeDistributionHelper::UpperBound(size_t idx) const {
     if (IndexOutOfBound(idx)) {
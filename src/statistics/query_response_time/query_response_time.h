@@ -26,6 +26,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "glog/logging.h"
+#include "statistics/query_response_time/latency_histogram.h"
 
 namespace openmldb {
 namespace statistics {
@@ -146,6 +147,9 @@ class TimeDistributionHelper {
     /// \brief return upper bound for `idx` th time interval, idx start from 0
     absl::StatusOr<absl::Duration> UpperBound(size_t idx) const;
 
+    /// \brief same as UpperBound, without bound check
+    absl::Duration UpperBoundUnchecked(size_t idx) const { return upper_bounds_[idx]; }
+
     bool IndexOutOfBound(size_t idx) const { return idx >= BucketCount(); }
 
     /// \brief return number of time intervals in the whole distribution
@@ -164,6 +168,10 @@ class TimeDistributionHelper {
 
 /// Thread safe wrapper for QUERY TIME DISTRIBUTION counters
 /// all methods provided meant atomic
+///
+/// counters are kept in per-thread shards, so Collect from different threads never contend,
+/// readers merge all the shards. Besides the time distribution, every collected time is also
+/// recorded into a latency histogram in microseconds, which gives the percentiles
 class TimeCollector {
  public:
     // construct from fresh data
@@ -190,6 +198,21 @@ class TimeCollector {
 
     absl::StatusOr<ResponseTimeRow> GetRow(size_t idx) const;
 
+    /// \brief merged latency histogram in microseconds since last flush
+    HistogramSnapshot GetHistogram() const { return histogram_.Snapshot(); }
+
+ private:
+    struct Shard {
+        Shard() {
+            for (size_t idx = 0; idx < TIME_DISTRIBUTION_BUCKET_COUNT; ++idx) {
+                count_[idx].store(0, std::memory_order_relaxed);
+                total_[idx].store(0, std::memory_order_relaxed);
+            }
+        }
+        std::atomic<uint32_t> count_[TIME_DISTRIBUTION_BUCKET_COUNT];
+        std::atomic<uint64_t> total_[TIME_DISTRIBUTION_BUCKET_COUNT];
+    };
+
  private:
     // unsafe methods
 
@@ -199,12 +222,10 @@ class TimeCollector {
 
     absl::Duration GetTotalUnited(size_t idx) const { return absl::Microseconds(GetTotal(idx)); }
 
-    void Setup();
-
  private:
     TimeDistributionHelper helper_;
-    std::atomic<uint32_t> count_[TIME_DISTRIBUTION_BUCKET_COUNT];
-    std::atomic<uint64_t> total_[TIME_DISTRIBUTION_BUCKET_COUNT];
+    ThreadShards<Shard> shards_;
+    ThreadLocalHistogram histogram_;
 };
 
 }  // namespace statistics
@@ -931,6 +931,106 @@ bool AvgAggregator::DecodeAggrVal(const int8_t* row_ptr, AggrBuffer* buffer) {
     return true;
 }
 
+ApproxDistinctCountAggregator::ApproxDistinctCountAggregator(
+    const ::openmldb::api::TableMeta& base_meta, const ::openmldb::api::TableMeta& aggr_meta,
+    std::shared_ptr<Table> aggr_table, std::shared_ptr<LogReplicator> aggr_replicator, const uint32_t& index_pos,
+    const std::string& aggr_col, const AggrType& aggr_type, const std::string& ts_col, WindowType window_tpye,
+    uint32_t window_size)
+    : Aggregator(base_meta, aggr_meta, aggr_table, aggr_replicator, index_pos, aggr_col, aggr_type, ts_col, window_tpye,
+                 window_size) {}
+
+bool ApproxDistinctCountAggregator::UpdateAggrVal(const codec::RowView& row_view, const int8_t* row_ptr,
+                                                  AggrBuffer* aggr_buffer) {
+    if (row_view.IsNULL(row_ptr, aggr_col_idx_)) {
+        return true;
+    }
+    // values are hashed in the same way as approx_distinct_count udaf
+    uint64_t hash = 0;
+    switch (aggr_col_type_) {
+        case DataType::kBool: {
+            bool val;
+            row_view.GetValue(row_ptr, aggr_col_idx_, aggr_col_type_, &val);
+            hash = ::hybridse::base::HyperLogLog::HashInt(val);
+            break;
+        }
+        case DataType::kSmallInt: {
+            int16_t val;
+            row_view.GetValue(row_ptr, aggr_col_idx_, aggr_col_type_, &val);
+            hash = ::hybridse::base::HyperLogLog::HashInt(val);
+            break;
+        }
+        case DataType::kDate:
+        case DataType::kInt: {
+            int32_t val;
+            row_view.GetValue(row_ptr, aggr_col_idx_, aggr_col_type_, &val);
+            hash = ::hybridse::base::HyperLogLog::HashInt(val);
+            break;
+        }
+        case DataType::kTimestamp:
+        case DataType::kBigInt: {
+            int64_t val;
+            row_view.GetValue(row_ptr, aggr_col_idx_, aggr_col_type_, &val);
+            hash = ::hybridse::base::HyperLogLog::HashInt(val);
+            break;
+        }
+        case DataType::kFloat: {
+            float val;
+            row_view.GetValue(row_ptr, aggr_col_idx_, aggr_col_type_, &val);
+            hash = ::hybridse::base::HyperLogLog::HashDouble(val);
+            break;
+        }
+        case DataType::kDouble: {
+            double val;
+            row_view.GetValue(row_ptr, aggr_col_idx_, aggr_col_type_, &val);
+            hash = ::hybridse::base::HyperLogLog::HashDouble(val);
+            break;
+        }
+        case DataType::kString:
+        case DataType::kVarchar: {
+            char* ch = NULL;
+            uint32_t ch_length = 0;
+            row_view.GetValue(row_ptr, aggr_col_idx_, &ch, &ch_length);
+            hash = ::hybridse::base::HyperLogLog::HashBytes(ch, ch_length);
+            break;
+        }
+        default: {
+            PDLOG(ERROR, "Unsupported data type");
+            return false;
+        }
+    }
+    if (!aggr_buffer->hll_) {
+        aggr_buffer->hll_ = std::make_unique<::hybridse::base::HyperLogLog>();
+    }
+    aggr_buffer->hll_->Add(hash);
+    aggr_buffer->non_null_cnt++;
+    return true;
+}
+
+bool ApproxDistinctCountAggregator::EncodeAggrVal(const AggrBuffer& buffer, std::string* aggr_val) {
+    if (buffer.hll_) {
+        buffer.hll_->SerializeTo(aggr_val);
+    } else {
+        ::hybridse::base::HyperLogLog().SerializeTo(aggr_val);
+    }
+    return true;
+}
+
+bool ApproxDistinctCountAggregator::DecodeAggrVal(const int8_t* row_ptr, AggrBuffer* buffer) {
+    char* aggr_val = NULL;
+    uint32_t ch_length = 0;
+    if (aggr_row_view_.GetValue(row_ptr, 4, &aggr_val, &ch_length) == 1) {
+        return true;
+    }
+    auto hll = std::make_unique<::hybridse::base::HyperLogLog>();
+    if (!hll->ParseFrom(aggr_val, ch_length)) {
+        PDLOG(ERROR, "Parse hyperloglog sketch failed");
+        return false;
+    }
+    buffer->non_null_cnt = hll->IsEmpty() ? 0 : 1;
+    buffer->hll_ = std::move(hll);
+    return true;
+}
+
 std::shared_ptr<Aggregator> CreateAggregator(const ::openmldb::api::TableMeta& base_meta,
                                              const ::openmldb::api::TableMeta& aggr_meta,
                                              std::shared_ptr<Table> aggr_table,
@@ -991,6 +1091,10 @@ std::shared_ptr<Aggregator> CreateAggregator(const ::openmldb::api::TableMeta& b
     } else if (aggr_type == "avg") {
         return std::make_shared<AvgAggregator>(base_meta, aggr_meta, aggr_table, aggr_replicator, index_pos, aggr_col,
                                                AggrType::kAvg, ts_col, window_type, window_size);
+    } else if (aggr_type == "approx_distinct_count") {
+        return std::make_shared<ApproxDistinctCountAggregator>(base_meta, aggr_meta, aggr_table, aggr_replicator,
+                                                               index_pos, aggr_col, AggrType::kApproxDistinctCount,
+                                                               ts_col, window_type, window_size);
     } else {
         PDLOG(ERROR, "Unsupported aggregate function type");
         return std::shared_ptr<Aggregator>();
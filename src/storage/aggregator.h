@@ -23,6 +23,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "base/fe_sketch.h"
 #include "codec/codec.h"
 #include "proto/tablet.pb.h"
 #include "proto/type.pb.h"
@@ -43,6 +44,7 @@ enum class AggrType {
     kMax = 3,
     kCount = 4,
     kAvg = 5,
+    kApproxDistinctCount = 6,
 };
 
 enum class WindowType {
@@ -75,6 +77,8 @@ class AggrBuffer {
     uint64_t binlog_offset_;
     int64_t non_null_cnt;
     DataType data_type_;
+    // sketch of approx_distinct_count, created on the first non-null value
+    std::unique_ptr<::hybridse::base::HyperLogLog> hll_;
     AggrBuffer() : aggr_val_(), ts_begin_(-1), ts_end_(0), aggr_cnt_(0), binlog_offset_(0), non_null_cnt(0) {}
     AggrBuffer(const AggrBuffer& buffer) {
         memcpy(&aggr_val_, &buffer.aggr_val_, sizeof(aggr_val_));
@@ -90,6 +94,9 @@ class AggrBuffer {
                 memcpy(aggr_val_.vstring.data, buffer.aggr_val_.vstring.data, buffer.aggr_val_.vstring.len);
             }
         }
+        if (buffer.hll_) {
+            hll_ = std::make_unique<::hybridse::base::HyperLogLog>(*buffer.hll_);
+        }
     }
     AggrBuffer& operator=(const AggrBuffer& buffer) = delete;
     ~AggrBuffer() { clear(); }
@@ -100,6 +107,7 @@ class AggrBuffer {
             }
         }
         memset(&aggr_val_, 0, sizeof(aggr_val_));
+        hll_.reset();
         ts_begin_ = -1;
         ts_end_ = 0;
         aggr_cnt_ = 0;
@@ -279,6 +287,24 @@ class AvgAggregator : public Aggregator {
     bool DecodeAggrVal(const int8_t* row_ptr, AggrBuffer* buffer) override;
 };
 
+class ApproxDistinctCountAggregator : public Aggregator {
+ public:
+    ApproxDistinctCountAggregator(const ::openmldb::api::TableMeta& base_meta,
+                                  const ::openmldb::api::TableMeta& aggr_meta, std::shared_ptr<Table> aggr_table,
+                                  std::shared_ptr<LogReplicator> aggr_replicator, const uint32_t& index_pos,
+                                  const std::string& aggr_col, const AggrType& aggr_type, const std::string& ts_col,
+                                  WindowType window_tpye, uint32_t window_size);
+
+    ~ApproxDistinctCountAggregator() = default;
+
+ private:
+    bool UpdateAggrVal(const codec::RowView& row_view, const int8_t* row_ptr, AggrBuffer* aggr_buffer) override;
+
+    bool EncodeAggrVal(const AggrBuffer& buffer, std::string* aggr_val) override;
+
+    bool DecodeAggrVal(const int8_t* row_ptr, AggrBuffer* buffer) override;
+};
+
 std::shared_ptr<Aggregator> CreateAggregator(const ::openmldb::api::TableMeta& base_meta,
                                              const ::openmldb::api::TableMeta& aggr_meta,
                                              std::shared_ptr<Table> aggr_table,
@@ -652,6 +652,49 @@ TEST_F(AggregatorTest, AvgAggregatorUpdate) {
     ASSERT_EQ(last_buffer->non_null_cnt, static_cast<int64_t>(0));
 }
 
+void CheckApproxDistinctCountAggrResult(std::shared_ptr<Table> aggr_table, uint64_t expect) {
+    ASSERT_EQ(aggr_table->GetRecordCnt(), 50);
+    auto it = aggr_table->NewTraverseIterator(0);
+    it->SeekToFirst();
+    for (int i = 50 - 1; i >= 0; --i) {
+        ASSERT_TRUE(it->Valid());
+        auto tmp_val = it->GetValue();
+        std::string origin_data = tmp_val.ToString();
+        codec::RowView origin_row_view(aggr_table->GetTableMeta()->column_desc(),
+                                       reinterpret_cast<int8_t*>(const_cast<char*>(origin_data.c_str())),
+                                       origin_data.size());
+        char* ch = NULL;
+        uint32_t ch_length = 0;
+        origin_row_view.GetString(4, &ch, &ch_length);
+        ::hybridse::base::HyperLogLog hll;
+        ASSERT_TRUE(hll.ParseFrom(ch, ch_length));
+        ASSERT_EQ(hll.Estimate(), expect);
+        it->Next();
+    }
+}
+
+TEST_F(AggregatorTest, ApproxDistinctCountAggregatorUpdate) {
+    std::shared_ptr<Aggregator> aggregator;
+    AggrBuffer* last_buffer;
+    std::shared_ptr<Table> aggr_table;
+    ASSERT_TRUE(GetUpdatedResult(counter, "col3", "approx_distinct_count", "1s", aggregator, aggr_table,
+                                 &last_buffer));
+    ASSERT_EQ(aggregator->GetAggrType(), AggrType::kApproxDistinctCount);
+    CheckApproxDistinctCountAggrResult(aggr_table, 2);
+    ASSERT_TRUE(last_buffer->hll_);
+    ASSERT_EQ(last_buffer->hll_->Estimate(), 1u);
+    counter += 2;
+    ASSERT_TRUE(GetUpdatedResult(counter, "col9", "approx_distinct_count", "1m", aggregator, aggr_table,
+                                 &last_buffer));
+    CheckApproxDistinctCountAggrResult(aggr_table, 2);
+    counter += 2;
+    ASSERT_TRUE(GetUpdatedResult(counter, "col_null", "approx_distinct_count", "1d", aggregator, aggr_table,
+                                 &last_buffer));
+    CheckApproxDistinctCountAggrResult(aggr_table, 0);
+    ASSERT_FALSE(last_buffer->hll_);
+    ASSERT_EQ(last_buffer->non_null_cnt, 0);
+}
+
 TEST_F(AggregatorTest, OutOfOrder) {
     std::map<std::string, std::string> map;
     std::string folder = "/tmp/" + GenRand() + "/";
@@ -15,10 +15,13 @@
  */
 
 #include "storage/disk_table.h"
+#include <algorithm>
+#include <set>
 #include <utility>
 #include "base/file_util.h"
 #include "base/glog_wapper.h"  // NOLINT
 #include "base/hash.h"
+#include "codec/schema_codec.h"
 #include "config.h"  // NOLINT
 
 DECLARE_bool(disable_wal);
@@ -29,6 +32,11 @@ DECLARE_uint32(block_cache_mb);
 DECLARE_uint32(write_buffer_mb);
 DECLARE_uint32(block_cache_shardbits);
 DECLARE_bool(verify_compression);
+DECLARE_bool(disk_row_locator);
+DECLARE_uint32(disk_row_cache_mb);
+DECLARE_uint32(disk_bloom_bits_per_key);
+DECLARE_bool(disk_key_meta);
+DECLARE_uint32(disk_periodic_compaction_hours);
 
 namespace openmldb {
 namespace storage {
@@ -36,6 +44,35 @@ namespace storage {
 static rocksdb::Options ssd_option_template;
 static rocksdb::Options hdd_option_template;
 static bool options_template_initialized = false;
+// filter policy depends on the table, so table factory is created for each table
+static rocksdb::BlockBasedTableOptions table_options_template;
+static std::shared_ptr<rocksdb::Cache> row_cache;
+// epoch is global, so that a reloaded table never hits rows cached before
+static std::atomic<uint64_t> row_cache_epoch(0);
+
+// key in default column family to record the layout of table
+static const char ROW_LAYOUT_KEY[] = "row_layout";
+static const char ROW_LAYOUT_LOCATOR[] = "locator";
+static const char KEY_META_KEY[] = "key_meta";
+// keys of key meta start with '\0', so the prefix keeps other meta apart
+static const std::string META_KEY_PREFIX = "meta|";  // NOLINT
+static const size_t MIN_LOCATOR_BATCH = 2;
+static const size_t MAX_LOCATOR_BATCH = 64;
+
+// rows expire when a compaction runs TTLCompactionFilter over them, periodic compaction makes rocksdb
+// visit every file of a column family with ttl at least once per period in the background. The period
+// is much longer than the gc interval, as each round rewrites the files, and the readers skip the
+// expired rows left in the meantime
+static uint64_t GetPeriodicCompactionSeconds(const std::shared_ptr<InnerIndexSt>& inner_index) {
+    for (const auto& index : inner_index->GetIndex()) {
+        if (index->GetTTL()->NeedGc()) {
+            return static_cast<uint64_t>(FLAGS_disk_periodic_compaction_hours) * 3600;
+        }
+    }
+    return 0;
+}
+
+static void DeleteCachedRow(const rocksdb::Slice& /*key*/, void* value) { delete static_cast<std::string*>(value); }
 
 DiskTable::DiskTable(const std::string& name, uint32_t id, uint32_t pid, const std::map<std::string, uint32_t>& mapping,
                      uint64_t ttl, ::openmldb::type::TTLType ttl_type, ::openmldb::common::StorageMode storage_mode,
@@ -44,7 +81,12 @@ DiskTable::DiskTable(const std::string& name, uint32_t id, uint32_t pid, const s
             ::openmldb::type::CompressType::kNoCompress),
       write_opts_(),
       offset_(0),
-      table_path_(table_path) {
+      table_path_(table_path),
+      row_locator_layout_(false),
+      key_meta_(false),
+      key_meta_hit_(0),
+      key_meta_miss_(0),
+      expired_meta_(std::make_shared<ExpiredKeyMeta>()) {
     if (!options_template_initialized) {
         initOptionTemplate();
     }
@@ -58,7 +100,12 @@ DiskTable::DiskTable(const ::openmldb::api::TableMeta& table_meta, const std::st
             ::openmldb::type::CompressType::kNoCompress),
       write_opts_(),
       offset_(0),
-      table_path_(table_path) {
+      table_path_(table_path),
+      row_locator_layout_(false),
+      key_meta_(false),
+      key_meta_hit_(0),
+      key_meta_miss_(0),
+      expired_meta_(std::make_shared<ExpiredKeyMeta>()) {
     if (!options_template_initialized) {
         initOptionTemplate();
     }
@@ -101,8 +148,7 @@ void DiskTable::initOptionTemplate() {
     // table_options.cache_index_and_filter_blocks = true;
     // table_options.pin_l0_filter_and_index_blocks_in_cache = true;
     table_options.block_cache = cache;
-    // table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(10,
-    // false));
+    // bloom filter is keyed on the pk part extracted by KeyTsPrefixTransform
     table_options.whole_key_filtering = false;
     table_options.block_size = 256 << 10;
     table_options.use_delta_encoding = false;
@@ -142,14 +188,123 @@ void DiskTable::initOptionTemplate() {
     hdd_option_template.target_file_size_base = 256 << 20;
     hdd_option_template.max_bytes_for_level_base = 1024 << 20;
     hdd_option_template.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_options));
+    table_options_template = table_options;
 
+    if (FLAGS_disk_row_cache_mb > 0) {
+        row_cache = rocksdb::NewLRUCache(static_cast<size_t>(FLAGS_disk_row_cache_mb) << 20,
+                                         FLAGS_block_cache_shardbits);
+    }
     options_template_initialized = true;
 }
 
+TTLCompactionFilter::TTLCompactionFilter(std::shared_ptr<InnerIndexSt> inner_index,
+                                         std::shared_ptr<ExpiredKeyMeta> expired_meta)
+    : has_ts_idx_(false),
+      need_gc_(false),
+      record_idx_(0),
+      inner_pos_(inner_index->GetId()),
+      expired_meta_(std::move(expired_meta)) {
+    uint64_t cur_time = ::baidu::common::timer::get_micros() / 1000;
+    auto to_expire = [cur_time](const TTLSt& ttl) {
+        uint64_t expire_time = ttl.abs_ttl == 0 || cur_time <= ttl.abs_ttl ? 0 : cur_time - ttl.abs_ttl;
+        return TTLSt(expire_time, ttl.lat_ttl, ttl.ttl_type);
+    };
+    const auto& indexs = inner_index->GetIndex();
+    if (indexs.size() > 1) {
+        has_ts_idx_ = true;
+        for (const auto& index : indexs) {
+            auto ts_col = index->GetTsColumn();
+            if (!ts_col) {
+                continue;
+            }
+            auto ttl = index->GetTTL();
+            need_gc_ = need_gc_ || ttl->NeedGc();
+            expire_map_.emplace(ts_col->GetId(), to_expire(*ttl));
+        }
+    } else {
+        auto ttl = indexs.front()->GetTTL();
+        need_gc_ = ttl->NeedGc();
+        expire_value_ = to_expire(*ttl);
+    }
+}
+
+TTLCompactionFilter::~TTLCompactionFilter() {
+    if (expired_meta_ && !expired_.empty()) {
+        expired_meta_->Add(expired_);
+    }
+}
+
+bool TTLCompactionFilter::Filter(int /*level*/, const rocksdb::Slice& key, const rocksdb::Slice& /*existing_value*/,
+                                 std::string* /*new_value*/, bool* /*value_changed*/) const {
+    if (!need_gc_) {
+        return false;
+    }
+    const TTLSt* expire_value = &expire_value_;
+    if (has_ts_idx_) {
+        if (key.size() < TS_LEN + TS_POS_LEN) {
+            return false;
+        }
+        uint32_t ts_idx = 0;
+        memcpy(static_cast<void*>(&ts_idx), key.data() + key.size() - TS_LEN - TS_POS_LEN, TS_POS_LEN);
+        auto iter = expire_map_.find(ts_idx);
+        if (iter == expire_map_.end()) {
+            return false;
+        }
+        expire_value = &iter->second;
+    } else if (key.size() < TS_LEN) {
+        return false;
+    }
+    rocksdb::Slice prefix(key.data(), key.size() - TS_LEN);
+    if (prefix != rocksdb::Slice(last_prefix_)) {
+        last_prefix_.assign(prefix.data(), prefix.size());
+        record_idx_ = 0;
+    }
+    if (record_idx_ < UINT32_MAX) {
+        record_idx_++;
+    }
+    uint64_t ts = 0;
+    memcpy(static_cast<void*>(&ts), key.data() + key.size() - TS_LEN, TS_LEN);
+    memrev64ifbe(static_cast<void*>(&ts));
+    if (!expire_value->IsExpired(ts, record_idx_)) {
+        return false;
+    }
+    if (expired_meta_) {
+        // rows are dropped from the oldest, so the rows left are newer than ts
+        std::string pk;
+        uint64_t key_ts = 0;
+        uint32_t ts_idx = UINT32_MAX;
+        ParseKeyAndTs(has_ts_idx_, key, pk, key_ts, ts_idx);
+        KeyMeta meta;
+        meta.count = static_cast<uint64_t>(-1);
+        meta.min_ts_floor = ts == UINT64_MAX ? ts : ts + 1;
+        expired_[CombineMetaKey(pk, inner_pos_, has_ts_idx_ ? ts_idx : UINT32_MAX)].Merge(meta);
+    }
+    return true;
+}
+
 bool DiskTable::InitColumnFamilyDescriptor() {
     cf_ds_.clear();
-    cf_ds_.push_back(
-        rocksdb::ColumnFamilyDescriptor(rocksdb::kDefaultColumnFamilyName, rocksdb::ColumnFamilyOptions()));
+    uint32_t bloom_bits_per_key = FLAGS_disk_bloom_bits_per_key;
+    auto table_meta = GetTableMeta();
+    if (table_meta && table_meta->has_bloom_bits_per_key()) {
+        bloom_bits_per_key = table_meta->bloom_bits_per_key();
+    }
+    rocksdb::BlockBasedTableOptions table_options = table_options_template;
+    if (bloom_bits_per_key > 0) {
+        table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(bloom_bits_per_key, false));
+    }
+    std::shared_ptr<rocksdb::TableFactory> table_factory(rocksdb::NewBlockBasedTableFactory(table_options));
+    // default column family keeps key meta and is only read by whole key
+    rocksdb::ColumnFamilyOptions default_cfo;
+    default_cfo.merge_operator = std::make_shared<KeyMetaMergeOperator>();
+    if (bloom_bits_per_key > 0) {
+        rocksdb::BlockBasedTableOptions meta_table_options = table_options_template;
+        meta_table_options.whole_key_filtering = true;
+        meta_table_options.block_size = 4 << 10;
+        meta_table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(bloom_bits_per_key, false));
+        default_cfo.table_factory.reset(rocksdb::NewBlockBasedTableFactory(meta_table_options));
+    }
+    cf_ds_.push_back(rocksdb::ColumnFamilyDescriptor(rocksdb::kDefaultColumnFamilyName, default_cfo));
     auto inner_indexs = table_index_.GetAllInnerIndex();
     for (const auto& inner_index : *inner_indexs) {
         rocksdb::ColumnFamilyOptions cfo;
@@ -162,12 +317,16 @@ bool DiskTable::InitColumnFamilyDescriptor() {
         }
         cfo.comparator = &cmp_;
         cfo.prefix_extractor.reset(new KeyTsPrefixTransform());
+        cfo.table_factory = table_factory;
+        if (bloom_bits_per_key > 0) {
+            // lookups of absent keys are what the filter is for, so keep it for the last level too
+            cfo.optimize_filters_for_hits = false;
+        }
         const auto& indexs = inner_index->GetIndex();
         auto index_def = indexs.front();
-        if (index_def->GetTTLType() == ::openmldb::storage::TTLType::kAbsoluteTime ||
-            index_def->GetTTLType() == ::openmldb::storage::TTLType::kAbsOrLat) {
-            cfo.compaction_filter_factory = std::make_shared<AbsoluteTTLFilterFactory>(inner_index);
-        }
+        // ttl may be updated later, so the filter is always set and checks ttl when compaction starts
+        cfo.compaction_filter_factory = std::make_shared<TTLFilterFactory>(inner_index, expired_meta_);
+        cfo.periodic_compaction_seconds = GetPeriodicCompactionSeconds(inner_index);
         cf_ds_.push_back(rocksdb::ColumnFamilyDescriptor(index_def->GetName(), cfo));
         DEBUGLOG("add cf_name %s. tid %u pid %u", index_def->GetName().c_str(), id_, pid_);
     }
@@ -180,8 +339,9 @@ bool DiskTable::Init() {
     }
     InitColumnFamilyDescriptor();
     std::string path = table_path_ + "/data";
-    if (!openmldb::base::IsExists(path)) {
-        PDLOG(INFO, "Create new disk table with path %s", path);
+    bool is_new = !openmldb::base::IsExists(path);
+    if (is_new) {
+        PDLOG(INFO, "Create new disk table with path %s", path.c_str());
     }
 
     if (!::openmldb::base::MkdirRecur(path)) {
@@ -191,6 +351,10 @@ bool DiskTable::Init() {
     options_.create_if_missing = true;
     options_.error_if_exists = false;
     options_.create_missing_column_families = true;
+    // tickers only, timers cost too much on the read path
+    statistics_ = rocksdb::CreateDBStatistics();
+    statistics_->set_stats_level(rocksdb::StatsLevel::kExceptTimers);
+    options_.statistics = statistics_;
     rocksdb::Status s = rocksdb::DB::Open(options_, path, cf_ds_, &cf_hs_, &db_);
     if (!s.ok()) {
         PDLOG(WARNING, "rocksdb open failed. tid %u pid %u error %s", id_, pid_, s.ToString().c_str());
@@ -198,16 +362,379 @@ bool DiskTable::Init() {
     }
     PDLOG(INFO, "Open DB. tid %u pid %u ColumnFamilyHandle size %u with data path %s", id_, pid_, GetIdxCnt(),
           path.c_str());
+    return InitRowLocator(is_new) && InitKeyMeta(is_new);
+}
+
+bool DiskTable::InitKeyMeta(bool is_new) {
+    // key meta is only trusted if it is kept since the table was created
+    std::string value;
+    rocksdb::Status s = db_->Get(rocksdb::ReadOptions(), cf_hs_[0], KEY_META_KEY, &value);
+    if (s.ok()) {
+        key_meta_ = true;
+    } else if (!s.IsNotFound()) {
+        PDLOG(WARNING, "get key meta failed. tid %u pid %u msg %s", id_, pid_, s.ToString().c_str());
+        return false;
+    } else if (is_new && FLAGS_disk_key_meta) {
+        s = db_->Put(write_opts_, cf_hs_[0], KEY_META_KEY, "");
+        if (!s.ok()) {
+            PDLOG(WARNING, "put key meta failed. tid %u pid %u msg %s", id_, pid_, s.ToString().c_str());
+            return false;
+        }
+        key_meta_ = true;
+    }
+    expired_meta_->SetEnabled(key_meta_);
     return true;
 }
 
+void DiskTable::MergeKeyMeta(rocksdb::WriteBatch* batch, const std::string& pk, uint32_t inner_pos,
+                             uint32_t ts_idx, uint64_t ts) {
+    KeyMeta meta;
+    meta.count = 1;
+    meta.min_ts = ts;
+    meta.max_ts = ts;
+    std::string value;
+    meta.Encode(&value);
+    batch->Merge(cf_hs_[0], CombineMetaKey(pk, inner_pos, ts_idx), value);
+}
+
+void DiskTable::ApplyExpiredKeyMeta() {
+    std::map<std::string, KeyMeta> metas;
+    expired_meta_->Swap(&metas);
+    if (!key_meta_ || metas.empty()) {
+        return;
+    }
+    rocksdb::WriteBatch batch;
+    std::string value;
+    for (const auto& kv : metas) {
+        kv.second.Encode(&value);
+        batch.Merge(cf_hs_[0], kv.first, value);
+    }
+    rocksdb::Status s = db_->Write(write_opts_, &batch);
+    if (!s.ok()) {
+        PDLOG(WARNING, "apply expired key meta failed. tid %u pid %u msg %s", id_, pid_, s.ToString().c_str());
+        // try again in the next gc
+        expired_meta_->Add(metas);
+    }
+}
+
+bool DiskTable::PutMeta(const std::string& key, const std::string& value) {
+    rocksdb::Status s = db_->Put(write_opts_, cf_hs_[0], META_KEY_PREFIX + key, value);
+    if (!s.ok()) {
+        PDLOG(WARNING, "put meta %s failed. tid %u pid %u msg %s", key.c_str(), id_, pid_, s.ToString().c_str());
+        return false;
+    }
+    return true;
+}
+
+bool DiskTable::GetMeta(const std::string& key, std::string* value) {
+    rocksdb::Status s = db_->Get(rocksdb::ReadOptions(), cf_hs_[0], META_KEY_PREFIX + key, value);
+    if (!s.ok() && !s.IsNotFound()) {
+        PDLOG(WARNING, "get meta %s failed. tid %u pid %u msg %s", key.c_str(), id_, pid_, s.ToString().c_str());
+    }
+    return s.ok();
+}
+
+bool DiskTable::GetKeyMeta(uint32_t index, const std::string& pk, KeyMeta* meta) {
+    if (!key_meta_) {
+        return false;
+    }
+    std::shared_ptr<IndexDef> index_def = table_index_.GetIndex(index);
+    if (!index_def) {
+        return false;
+    }
+    uint32_t inner_pos = index_def->GetInnerPos();
+    auto inner_index = table_index_.GetInnerIndex(inner_pos);
+    uint32_t ts_idx = UINT32_MAX;
+    if (inner_index && inner_index->GetIndex().size() > 1) {
+        auto ts_col = index_def->GetTsColumn();
+        if (!ts_col) {
+            return false;
+        }
+        ts_idx = ts_col->GetId();
+    }
+    std::string value;
+    rocksdb::Status s = db_->Get(rocksdb::ReadOptions(), cf_hs_[0], CombineMetaKey(pk, inner_pos, ts_idx), &value);
+    *meta = KeyMeta();
+    if (s.IsNotFound()) {
+        return true;
+    }
+    if (!s.ok() || !meta->Decode(value)) {
+        return false;
+    }
+    // a row put again is counted twice, and may be subtracted twice if compaction drops both
+    // versions, the key has to be scanned then
+    if (meta->overlapped || meta->count > INT64_MAX) {
+        return false;
+    }
+    meta->min_ts = std::max(meta->min_ts, meta->min_ts_floor);
+    meta->min_ts_floor = 0;
+    return true;
+}
+
+void DiskTable::GetFilterStats(DiskTableFilterStats* stats) const {
+    if (statistics_) {
+        stats->bloom_checked = statistics_->getTickerCount(rocksdb::BLOOM_FILTER_USEFUL) +
+                               statistics_->getTickerCount(rocksdb::BLOOM_FILTER_FULL_POSITIVE) +
+                               statistics_->getTickerCount(rocksdb::BLOOM_FILTER_PREFIX_CHECKED);
+        stats->bloom_useful = statistics_->getTickerCount(rocksdb::BLOOM_FILTER_USEFUL) +
+                              statistics_->getTickerCount(rocksdb::BLOOM_FILTER_PREFIX_USEFUL);
+    }
+    stats->key_meta_hit = key_meta_hit_.load(std::memory_order_relaxed);
+    stats->key_meta_miss = key_meta_miss_.load(std::memory_order_relaxed);
+}
+
+bool DiskTable::InitRowLocator(bool is_new) {
+    // layout is decided when the table is created and recorded in the default column family,
+    // so that changing the flag never breaks existing tables
+    std::string layout;
+    rocksdb::Status s = db_->Get(rocksdb::ReadOptions(), cf_hs_[0], ROW_LAYOUT_KEY, &layout);
+    if (s.ok()) {
+        row_locator_layout_ = layout == ROW_LAYOUT_LOCATOR;
+    } else if (!s.IsNotFound()) {
+        PDLOG(WARNING, "get row layout failed. tid %u pid %u msg %s", id_, pid_, s.ToString().c_str());
+        return false;
+    } else if (is_new && FLAGS_disk_row_locator && table_index_.GetAllInnerIndex()->size() > 1) {
+        if (!CanUseRowLocator()) {
+            PDLOG(INFO, "indexes expire rows differently, use full row layout. tid %u pid %u", id_, pid_);
+            return true;
+        }
+        s = db_->Put(write_opts_, cf_hs_[0], ROW_LAYOUT_KEY, ROW_LAYOUT_LOCATOR);
+        if (!s.ok()) {
+            PDLOG(WARNING, "put row layout failed. tid %u pid %u msg %s", id_, pid_, s.ToString().c_str());
+            return false;
+        }
+        row_locator_layout_ = true;
+    }
+    if (row_locator_layout_) {
+        ResetRowLocator();
+        PDLOG(INFO, "disk table uses row locator layout. tid %u pid %u", id_, pid_);
+    }
+    return true;
+}
+
+bool DiskTable::CanUseRowLocator() const {
+    auto inner_indexs = table_index_.GetAllInnerIndex();
+    const auto& primary = inner_indexs->at(0)->GetIndex();
+    if (primary.empty() || !primary.front()->GetTsColumn()) {
+        return false;
+    }
+    auto primary_ts_col = primary.front()->GetTsColumn();
+    auto primary_ttl = primary.front()->GetTTL();
+    bool need_gc = false;
+    for (const auto& inner_index : *inner_indexs) {
+        for (const auto& index : inner_index->GetIndex()) {
+            need_gc = need_gc || index->GetTTL()->NeedGc();
+            auto ts_col = index->GetTsColumn();
+            // auto gen ts of a replaced row can only be recovered from the locator
+            if (ts_col && ts_col->IsAutoGenTs() && !primary_ts_col->IsAutoGenTs()) {
+                return false;
+            }
+        }
+    }
+    if (!need_gc) {
+        return true;
+    }
+    // secondary entries must not outlive the rows of primary index, and rows must not be dropped
+    // from primary index while a secondary index still keeps them
+    for (const auto& inner_index : *inner_indexs) {
+        for (const auto& index : inner_index->GetIndex()) {
+            auto ttl = index->GetTTL();
+            auto ts_col = index->GetTsColumn();
+            if (ttl->ttl_type != ::openmldb::storage::TTLType::kAbsoluteTime || ttl->abs_ttl != primary_ttl->abs_ttl ||
+                primary_ttl->ttl_type != ::openmldb::storage::TTLType::kAbsoluteTime || !ts_col ||
+                ts_col->GetId() != primary_ts_col->GetId()) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool DiskTable::KeepReplacedRow(const std::string& locator, const std::string& new_value,
+                                rocksdb::WriteBatch* batch) {
+    std::string old_value;
+    rocksdb::Status s = db_->Get(rocksdb::ReadOptions(), cf_hs_[1], rocksdb::Slice(locator), &old_value);
+    if (s.IsNotFound()) {
+        return true;
+    } else if (!s.ok()) {
+        PDLOG(WARNING, "get replaced row failed. tid %u pid %u msg %s", id_, pid_, s.ToString().c_str());
+        return false;
+    }
+    if (old_value == new_value) {
+        return true;
+    }
+    return KeepRowInSecondaryIndex(locator, rocksdb::Slice(old_value), batch);
+}
+
+bool DiskTable::KeepRowInSecondaryIndex(const std::string& locator, const rocksdb::Slice& row,
+                                        rocksdb::WriteBatch* batch) {
+    const int8_t* data = reinterpret_cast<const int8_t*>(row.data());
+    uint8_t version = codec::RowView::GetSchemaVersion(data);
+    auto decoder = GetVersionDecoder(version);
+    auto layout = GetVersionLayout(version);
+    if (decoder == nullptr || layout == nullptr) {
+        PDLOG(WARNING, "invalid schema version %u, tid %u pid %u", version, id_, pid_);
+        return false;
+    }
+    auto inner_indexs = table_index_.GetAllInnerIndex();
+    std::string primary_key;
+    uint64_t locator_ts = 0;
+    uint32_t locator_ts_idx = 0;
+    ParseKeyAndTs(inner_indexs->at(0)->GetIndex().size() > 1, rocksdb::Slice(locator), primary_key, locator_ts,
+                  locator_ts_idx);
+    std::string locator_value;
+    locator_value.reserve(locator.size() + 1);
+    locator_value.push_back(ROW_LOCATOR_TAG);
+    locator_value.append(locator);
+    std::string row_value;
+    row_value.reserve(row.size() + 1);
+    row_value.push_back(ROW_VALUE_TAG);
+    row_value.append(row.data(), row.size());
+    for (uint32_t inner_pos = 1; inner_pos < inner_indexs->size(); inner_pos++) {
+        const auto& indexs = inner_indexs->at(inner_pos)->GetIndex();
+        bool has_ts_idx = indexs.size() > 1;
+        for (const auto& index_def : indexs) {
+            auto ts_col = index_def->GetTsColumn();
+            if (!ts_col) {
+                continue;
+            }
+            // same as the dimension built by sdk
+            std::string key;
+            bool valid = true;
+            for (const auto& col : index_def->GetColumns()) {
+                std::string val;
+                int ret = decoder->GetStrValue(data, col.GetId(), &val);
+                if (ret < 0) {
+                    valid = false;
+                    break;
+                } else if (ret == 1) {
+                    val = codec::NONETOKEN;
+                } else if (val.empty()) {
+                    val = codec::EMPTY_STRING;
+                }
+                if (key.empty()) {
+                    key = std::move(val);
+                } else {
+                    key += "|" + val;
+                }
+            }
+            if (!valid) {
+                continue;
+            }
+            int64_t ts = 0;
+            if (ts_col->IsAutoGenTs()) {
+                ts = locator_ts;
+            } else if (layout->GetInteger(data, ts_col->GetId(), &ts) != 0) {
+                continue;
+            }
+            std::string combine_key =
+                has_ts_idx ? CombineKeyTs(key, ts, ts_col->GetId()) : CombineKeyTs(key, ts);
+            std::string cur_value;
+            rocksdb::Status s =
+                db_->Get(rocksdb::ReadOptions(), cf_hs_[inner_pos + 1], rocksdb::Slice(combine_key), &cur_value);
+            if (s.IsNotFound()) {
+                // the secondary key is in another partition
+                continue;
+            } else if (!s.ok()) {
+                PDLOG(WARNING, "get secondary index failed. tid %u pid %u msg %s", id_, pid_, s.ToString().c_str());
+                return false;
+            }
+            if (cur_value == locator_value) {
+                batch->Put(cf_hs_[inner_pos + 1], rocksdb::Slice(combine_key), rocksdb::Slice(row_value));
+            }
+        }
+    }
+    return true;
+}
+
+bool DiskTable::KeepDeletedRows(const std::string& pk, rocksdb::WriteBatch* batch) {
+    const auto& primary = table_index_.GetInnerIndex(0)->GetIndex();
+    if (primary.empty() || !primary.front()->GetTsColumn()) {
+        return true;
+    }
+    // locators are the keys of the first ts column
+    uint32_t locator_ts_idx = primary.front()->GetTsColumn()->GetId();
+    bool has_ts_idx = primary.size() > 1;
+    std::string start = has_ts_idx ? CombineKeyTs(pk, UINT64_MAX, locator_ts_idx) : CombineKeyTs(pk, UINT64_MAX);
+    std::unique_ptr<rocksdb::Iterator> it(db_->NewIterator(rocksdb::ReadOptions(), cf_hs_[1]));
+    for (it->Seek(rocksdb::Slice(start)); it->Valid(); it->Next()) {
+        std::string key;
+        uint64_t ts = 0;
+        uint32_t ts_idx = 0;
+        if (ParseKeyAndTs(has_ts_idx, it->key(), key, ts, ts_idx) != 0 || key != pk ||
+            (has_ts_idx && ts_idx != locator_ts_idx)) {
+            break;
+        }
+        if (!KeepRowInSecondaryIndex(it->key().ToString(), it->value(), batch)) {
+            return false;
+        }
+    }
+    if (!it->status().ok()) {
+        PDLOG(WARNING, "iterate deleted rows failed. tid %u pid %u msg %s", id_, pid_,
+              it->status().ToString().c_str());
+        return false;
+    }
+    return true;
+}
+
+void DiskTable::ResetRowLocator() {
+    auto locator = std::make_shared<RowLocator>();
+    locator->db = db_;
+    locator->primary_cf = cf_hs_[1];
+    locator->row_cache = row_cache;
+    locator->cache_prefix.resize(sizeof(uint32_t) * 2 + sizeof(uint64_t));
+    char* buf = &locator->cache_prefix[0];
+    memcpy(buf, &id_, sizeof(uint32_t));
+    memcpy(buf + sizeof(uint32_t), &pid_, sizeof(uint32_t));
+    uint64_t epoch = row_cache_epoch.fetch_add(1, std::memory_order_relaxed);
+    memcpy(buf + sizeof(uint32_t) * 2, &epoch, sizeof(uint64_t));
+    std::atomic_store(&row_locator_, std::shared_ptr<RowLocator>(locator));
+}
+
+void DiskTable::EraseRowCache(const std::string& locator) {
+    auto row_locator = std::atomic_load(&row_locator_);
+    if (row_locator && row_locator->row_cache) {
+        row_locator->row_cache->Erase(row_locator->cache_prefix + locator);
+    }
+}
+
+rocksdb::Iterator* DiskTable::NewIndexIterator(const rocksdb::ReadOptions& ro, uint32_t inner_pos) {
+    rocksdb::Iterator* it = db_->NewIterator(ro, cf_hs_[inner_pos + 1]);
+    if (row_locator_layout_ && inner_pos > 0) {
+        return new RowLocatorIterator(it, ro.snapshot, std::atomic_load(&row_locator_));
+    }
+    return it;
+}
+
 bool DiskTable::Put(const std::string& pk, uint64_t time, const char* data, uint32_t size) {
     rocksdb::Status s;
     std::string combine_key = CombineKeyTs(pk, time);
     rocksdb::Slice spk = rocksdb::Slice(combine_key);
-    s = db_->Put(write_opts_, cf_hs_[1], spk, rocksdb::Slice(data, size));
+    if (row_locator_layout_) {
+        std::lock_guard<std::mutex> lock(GetLocatorMutex(combine_key));
+        rocksdb::WriteBatch batch;
+        if (!KeepReplacedRow(combine_key, std::string(data, size), &batch)) {
+            return false;
+        }
+        if (key_meta_) {
+            MergeKeyMeta(&batch, pk, 0, UINT32_MAX, time);
+        }
+        batch.Put(cf_hs_[1], spk, rocksdb::Slice(data, size));
+        s = db_->Write(write_opts_, &batch);
+    } else if (key_meta_) {
+        rocksdb::WriteBatch batch;
+        MergeKeyMeta(&batch, pk, 0, UINT32_MAX, time);
+        batch.Put(cf_hs_[1], spk, rocksdb::Slice(data, size));
+        s = db_->Write(write_opts_, &batch);
+    } else {
+        s = db_->Put(write_opts_, cf_hs_[1], spk, rocksdb::Slice(data, size));
+    }
     if (s.ok()) {
+        if (row_locator_layout_) {
+            EraseRowCache(combine_key);
+        }
         offset_.fetch_add(1, std::memory_order_relaxed);
+        IncrWriteVersion();
         return true;
     } else {
         DEBUGLOG("Put failed. tid %u pid %u msg %s", id_, pid_, s.ToString().c_str());
@@ -218,16 +745,29 @@ bool DiskTable::Put(const std::string& pk, uint64_t time, const char* data, uint
 bool DiskTable::Put(uint64_t time, const std::string& value, const Dimensions& dimensions) {
     rocksdb::WriteBatch batch;
     rocksdb::Status s;
+    const int8_t* data = reinterpret_cast<const int8_t*>(value.data());
+    uint8_t version = codec::RowView::GetSchemaVersion(data);
+    auto layout = GetVersionLayout(version);
+    if (layout == nullptr) {
+        PDLOG(WARNING, "invalid schema version %u, tid %u pid %u", version, id_, pid_);
+        return false;
+    }
+    // with row locator layout, the full row is put into the primary index only if the
+    // primary key is in this partition, and the other indexes refer to it
+    std::string locator;
+    std::vector<std::pair<uint32_t, std::string>> secondary_keys;
+    // indexes sharing an inner index are put once like mem table, so key meta counts each row once
+    std::set<int32_t> put_inner_pos;
     Dimensions::const_iterator it = dimensions.begin();
     for (; it != dimensions.end(); ++it) {
-        const int8_t* data = reinterpret_cast<const int8_t*>(value.data());
-        uint8_t version = codec::RowView::GetSchemaVersion(data);
-        auto decoder = GetVersionDecoder(version);
-        if (decoder == nullptr) {
-            PDLOG(WARNING, "invalid schema version %u, tid %u pid %u", version, id_, pid_);
+        int32_t inner_pos = table_index_.GetInnerIndexPos(it->idx());
+        if (inner_pos < 0) {
+            PDLOG(WARNING, "invalid dimension. dimension idx %u, tid %u pid %u", it->idx(), id_, pid_);
             return false;
         }
-        int32_t inner_pos = table_index_.GetInnerIndexPos(it->idx());
+        if (!put_inner_pos.insert(inner_pos).second) {
+            continue;
+        }
         auto inner_index = table_index_.GetInnerIndex(inner_pos);
 
         for (const auto& index_def : inner_index->GetIndex()) {
@@ -242,23 +782,62 @@ bool DiskTable::Put(uint64_t time, const std::string& value, const Dimensions& d
                 int64_t ts = 0;
                 if (ts_col->IsAutoGenTs()) {
                     ts = time;
-                } else if (decoder->GetInteger(data, ts_col->GetId(), ts_col->GetType(), &ts) != 0) {
+                } else if (layout->GetInteger(data, ts_col->GetId(), &ts) != 0) {
                     PDLOG(WARNING, "get ts failed. tid %u pid %u", id_, pid_);
                     return false;
                 }
-                if (inner_index->GetIndex().size() > 1) {
+                bool has_ts_idx = inner_index->GetIndex().size() > 1;
+                if (has_ts_idx) {
                     combine_key = CombineKeyTs(it->key(), ts, ts_col->GetId());
                 } else {
                     combine_key = CombineKeyTs(it->key(), ts);
                 }
+                if (key_meta_) {
+                    MergeKeyMeta(&batch, it->key(), inner_pos, has_ts_idx ? ts_col->GetId() : UINT32_MAX, ts);
+                }
+                if (row_locator_layout_ && inner_pos == 0 && locator.empty()) {
+                    locator = combine_key;
+                }
+                if (row_locator_layout_ && inner_pos > 0) {
+                    // value of secondary index is known after all dimensions are seen
+                    secondary_keys.emplace_back(inner_pos + 1, std::move(combine_key));
+                    continue;
+                }
                 rocksdb::Slice spk = rocksdb::Slice(combine_key);
                 batch.Put(cf_hs_[inner_pos + 1], spk, value);
             }
         }
     }
+    std::unique_lock<std::mutex> lock;
+    if (!locator.empty()) {
+        // an overwritten row may still be referred by secondary keys which the new row does not have
+        lock = std::unique_lock<std::mutex>(GetLocatorMutex(locator));
+        if (!KeepReplacedRow(locator, value, &batch)) {
+            return false;
+        }
+    }
+    if (!secondary_keys.empty()) {
+        std::string locator_value;
+        if (locator.empty()) {
+            locator_value.reserve(value.size() + 1);
+            locator_value.push_back(ROW_VALUE_TAG);
+            locator_value.append(value);
+        } else {
+            locator_value.reserve(locator.size() + 1);
+            locator_value.push_back(ROW_LOCATOR_TAG);
+            locator_value.append(locator);
+        }
+        for (const auto& kv : secondary_keys) {
+            batch.Put(cf_hs_[kv.first], rocksdb::Slice(kv.second), rocksdb::Slice(locator_value));
+        }
+    }
     s = db_->Write(write_opts_, &batch);
     if (s.ok()) {
+        if (!locator.empty()) {
+            EraseRowCache(locator);
+        }
         offset_.fetch_add(1, std::memory_order_relaxed);
+        IncrWriteVersion();
         return true;
     } else {
         DEBUGLOG("Put failed. tid %u pid %u msg %s", id_, pid_, s.ToString().c_str());
@@ -272,6 +851,16 @@ bool DiskTable::Delete(const std::string& pk, uint32_t idx) {
     if (!index_def) {
         return false;
     }
+    std::vector<std::unique_lock<std::mutex>> locks;
+    if (row_locator_layout_ && index_def->GetInnerPos() == 0) {
+        // deleting the primary key must not delete rows that are still in secondary indexes
+        for (auto& mu : locator_mu_) {
+            locks.emplace_back(mu);
+        }
+        if (!KeepDeletedRows(pk, &batch)) {
+            return false;
+        }
+    }
     auto inner_index = table_index_.GetInnerIndex(index_def->GetInnerPos());
     if (inner_index && inner_index->GetIndex().size() > 1) {
         const auto& indexs = inner_index->GetIndex();
@@ -282,16 +871,33 @@ bool DiskTable::Delete(const std::string& pk, uint32_t idx) {
             }
             std::string combine_key1 = CombineKeyTs(pk, UINT64_MAX, ts_col->GetId());
             std::string combine_key2 = CombineKeyTs(pk, 0, ts_col->GetId());
-            batch.DeleteRange(cf_hs_[idx + 1], rocksdb::Slice(combine_key1), rocksdb::Slice(combine_key2));
+            batch.DeleteRange(cf_hs_[index_def->GetInnerPos() + 1], rocksdb::Slice(combine_key1),
+                              rocksdb::Slice(combine_key2));
+            if (key_meta_) {
+                std::string meta_key = CombineMetaKey(pk, index_def->GetInnerPos(), ts_col->GetId());
+                batch.Delete(cf_hs_[0], meta_key);
+                expired_meta_->Erase(meta_key);
+            }
         }
     } else {
         std::string combine_key1 = CombineKeyTs(pk, UINT64_MAX);
         std::string combine_key2 = CombineKeyTs(pk, 0);
-        batch.DeleteRange(cf_hs_[idx + 1], rocksdb::Slice(combine_key1), rocksdb::Slice(combine_key2));
+        batch.DeleteRange(cf_hs_[index_def->GetInnerPos() + 1], rocksdb::Slice(combine_key1),
+                          rocksdb::Slice(combine_key2));
+        if (key_meta_) {
+            std::string meta_key = CombineMetaKey(pk, index_def->GetInnerPos(), UINT32_MAX);
+            batch.Delete(cf_hs_[0], meta_key);
+            expired_meta_->Erase(meta_key);
+        }
     }
     rocksdb::Status s = db_->Write(write_opts_, &batch);
     if (s.ok()) {
+        if (row_locator_layout_ && row_cache && index_def->GetInnerPos() == 0) {
+            // rows of pk can not be erased from row cache one by one, just drop all rows of this table
+            ResetRowLocator();
+        }
         offset_.fetch_add(1, std::memory_order_relaxed);
+        IncrWriteVersion();
         return true;
     } else {
         DEBUGLOG("Delete failed. tid %u pid %u msg %s", id_, pid_, s.ToString().c_str());
@@ -316,132 +922,24 @@ bool DiskTable::Get(uint32_t idx, const std::string& pk, uint64_t ts, std::strin
 bool DiskTable::Get(const std::string& pk, uint64_t ts, std::string& value) { return Get(0, pk, ts, value); }
 
 void DiskTable::SchedGc() {
-    GcHead();
+    // expired rows are dropped by TTLCompactionFilter in the background compactions, so gc only
+    // applies the new ttl and keeps periodic compaction on for the column families that need gc
     UpdateTTL();
-}
-
-void DiskTable::GcHead() {
-    uint64_t start_time = ::baidu::common::timer::get_micros() / 1000;
+    ApplyExpiredKeyMeta();
     auto inner_indexs = table_index_.GetAllInnerIndex();
     for (const auto& inner_index : *inner_indexs) {
-        uint32_t idx = inner_index->GetId();
-        rocksdb::ReadOptions ro = rocksdb::ReadOptions();
-        const rocksdb::Snapshot* snapshot = db_->GetSnapshot();
-        ro.snapshot = snapshot;
-        // ro.prefix_same_as_start = true;
-        ro.pin_data = true;
-        rocksdb::Iterator* it = db_->NewIterator(ro, cf_hs_[idx + 1]);
-        it->SeekToFirst();
-        const auto& indexs = inner_index->GetIndex();
-        if (indexs.size() > 1) {
-            bool need_ttl = false;
-            std::map<uint32_t, uint64_t> ttl_map;
-            for (const auto& index : indexs) {
-                auto ts_col = index->GetTsColumn();
-                if (ts_col) {
-                    auto lat_ttl = index->GetTTL()->lat_ttl;
-                    if (lat_ttl > 0) {
-                        ttl_map.emplace(ts_col->GetId(), lat_ttl);
-                        need_ttl = true;
-                    }
-                }
-            }
-            if (!need_ttl) {
-                continue;
-            }
-            std::map<uint32_t, uint32_t> key_cnt;
-            std::map<uint32_t, uint64_t> delete_key_map;
-            std::string last_pk;
-            while (it->Valid()) {
-                std::string cur_pk;
-                uint64_t ts = 0;
-                uint32_t ts_idx = 0;
-                ParseKeyAndTs(true, it->key(), cur_pk, ts, ts_idx);
-                if (!last_pk.empty() && cur_pk == last_pk) {
-                    auto ttl_iter = ttl_map.find(ts_idx);
-                    if (ttl_iter != ttl_map.end() && ttl_iter->second > 0) {
-                        auto key_cnt_iter = key_cnt.find(ts_idx);
-                        if (key_cnt_iter == key_cnt.end()) {
-                            key_cnt.insert(std::make_pair(ts_idx, 1));
-                        } else {
-                            key_cnt_iter->second++;
-                        }
-                        if (key_cnt_iter->second > ttl_iter->second &&
-                            delete_key_map.find(ts_idx) == delete_key_map.end()) {
-                            delete_key_map.insert(std::make_pair(ts_idx, ts));
-                        }
-                    }
-                } else {
-                    for (const auto& kv : delete_key_map) {
-                        std::string combine_key1 = CombineKeyTs(last_pk, kv.second, kv.first);
-                        std::string combine_key2 = CombineKeyTs(last_pk, 0, kv.first);
-                        rocksdb::Status s = db_->DeleteRange(write_opts_, cf_hs_[idx + 1], rocksdb::Slice(combine_key1),
-                                                             rocksdb::Slice(combine_key2));
-                        if (!s.ok()) {
-                            PDLOG(WARNING, "Delete failed. tid %u pid %u msg %s", id_, pid_, s.ToString().c_str());
-                        }
-                    }
-                    delete_key_map.clear();
-                    key_cnt.clear();
-                    key_cnt.insert(std::make_pair(ts_idx, 1));
-                    last_pk = cur_pk;
-                }
-                it->Next();
-            }
-            for (const auto& kv : delete_key_map) {
-                std::string combine_key1 = CombineKeyTs(last_pk, kv.second, kv.first);
-                std::string combine_key2 = CombineKeyTs(last_pk, 0, kv.first);
-                rocksdb::Status s = db_->DeleteRange(write_opts_, cf_hs_[idx + 1], rocksdb::Slice(combine_key1),
-                                                     rocksdb::Slice(combine_key2));
-                if (!s.ok()) {
-                    PDLOG(WARNING, "Delete failed. tid %u pid %u msg %s", id_, pid_, s.ToString().c_str());
-                }
-            }
-        } else {
-            auto index = indexs.front();
-            auto ttl_num = index->GetTTL()->lat_ttl;
-            if (ttl_num < 1) {
-                continue;
-            }
-            std::string last_pk;
-            uint64_t count = 0;
-            while (it->Valid()) {
-                std::string cur_pk;
-                uint64_t ts = 0;
-                ParseKeyAndTs(it->key(), cur_pk, ts);
-                if (!last_pk.empty() && cur_pk == last_pk) {
-                    if (ts == 0 || count < ttl_num) {
-                        it->Next();
-                        count++;
-                        continue;
-                    } else {
-                        std::string combine_key1 = CombineKeyTs(cur_pk, ts);
-                        std::string combine_key2 = CombineKeyTs(cur_pk, 0);
-                        rocksdb::Status s = db_->DeleteRange(write_opts_, cf_hs_[idx + 1], rocksdb::Slice(combine_key1),
-                                                             rocksdb::Slice(combine_key2));
-                        if (!s.ok()) {
-                            PDLOG(WARNING, "Delete failed. tid %u pid %u msg %s", id_, pid_, s.ToString().c_str());
-                        }
-                        it->Seek(rocksdb::Slice(combine_key2));
-                    }
-                } else {
-                    count = 1;
-                    last_pk = cur_pk;
-                    it->Next();
-                }
-            }
+        auto cf = cf_hs_[inner_index->GetId() + 1];
+        uint64_t seconds = GetPeriodicCompactionSeconds(inner_index);
+        if (db_->GetOptions(cf).periodic_compaction_seconds == seconds) {
+            continue;
+        }
+        rocksdb::Status s = db_->SetOptions(cf, {{"periodic_compaction_seconds", std::to_string(seconds)}});
+        if (!s.ok()) {
+            PDLOG(WARNING, "fail to set periodic compaction. tid %u pid %u msg %s", id_, pid_, s.ToString().c_str());
         }
-        delete it;
-        db_->ReleaseSnapshot(snapshot);
     }
-    uint64_t time_used = ::baidu::common::timer::get_micros() / 1000 - start_time;
-    PDLOG(INFO, "Gc used %lu second. tid %u pid %u", time_used / 1000, id_, pid_);
 }
 
-void DiskTable::GcTTLOrHead() {}
-
-void DiskTable::GcTTLAndHead() {}
-
 // ttl as ms
 uint64_t DiskTable::GetExpireTime(const TTLSt& ttl_st) {
     if (ttl_st.abs_ttl == 0 || ttl_st.ttl_type == ::openmldb::storage::TTLType::kLatestTime) {
@@ -489,7 +987,7 @@ TableIterator* DiskTable::NewIterator(uint32_t idx, const std::string& pk, Ticke
     ro.snapshot = snapshot;
     ro.prefix_same_as_start = true;
     ro.pin_data = true;
-    rocksdb::Iterator* it = db_->NewIterator(ro, cf_hs_[inner_pos + 1]);
+    rocksdb::Iterator* it = NewIndexIterator(ro, inner_pos);
     if (inner_index && inner_index->GetIndex().size() > 1) {
         auto ts_col = index_def->GetTsColumn();
         if (ts_col) {
@@ -512,9 +1010,9 @@ TraverseIterator* DiskTable::NewTraverseIterator(uint32_t index) {
     rocksdb::ReadOptions ro = rocksdb::ReadOptions();
     const rocksdb::Snapshot* snapshot = db_->GetSnapshot();
     ro.snapshot = snapshot;
-    // ro.prefix_same_as_start = true;
+    // keys of all pks are iterated, so prefix_same_as_start is not set
     ro.pin_data = true;
-    rocksdb::Iterator* it = db_->NewIterator(ro, cf_hs_[inner_pos + 1]);
+    rocksdb::Iterator* it = NewIndexIterator(ro, inner_pos);
     if (inner_index && inner_index->GetIndex().size() > 1) {
         auto ts_col = index_def->GetTsColumn();
         if (ts_col) {
@@ -525,6 +1023,127 @@ TraverseIterator* DiskTable::NewTraverseIterator(uint32_t index) {
     return new DiskTableTraverseIterator(db_, it, snapshot, ttl->ttl_type, expire_time, expire_cnt);
 }
 
+RowLocatorIterator::RowLocatorIterator(rocksdb::Iterator* it, const rocksdb::Snapshot* snapshot,
+                                       const std::shared_ptr<RowLocator>& locator)
+    : it_(it), locator_(locator), pos_(0), batch_size_(MIN_LOCATOR_BATCH) {
+    ro_.snapshot = snapshot;
+}
+
+RowLocatorIterator::~RowLocatorIterator() { delete it_; }
+
+void RowLocatorIterator::SeekToFirst() {
+    it_->SeekToFirst();
+    Fill(true);
+}
+
+void RowLocatorIterator::SeekToLast() {
+    it_->SeekToLast();
+    Fill(true);
+}
+
+void RowLocatorIterator::Seek(const rocksdb::Slice& target) {
+    it_->Seek(target);
+    Fill(true);
+}
+
+void RowLocatorIterator::SeekForPrev(const rocksdb::Slice& target) {
+    it_->SeekForPrev(target);
+    Fill(true);
+}
+
+void RowLocatorIterator::Next() {
+    pos_++;
+    if (pos_ >= entries_.size()) {
+        Fill(false);
+    }
+}
+
+void RowLocatorIterator::Prev() {
+    status_ = rocksdb::Status::NotSupported("RowLocatorIterator does not support Prev");
+    entries_.clear();
+    pos_ = 0;
+}
+
+void RowLocatorIterator::Fill(bool reset) {
+    if (reset) {
+        batch_size_ = MIN_LOCATOR_BATCH;
+    }
+    entries_.clear();
+    pos_ = 0;
+    // rows missing in primary index are expired or deleted, read the next batch if all are missing
+    while (entries_.empty() && it_->Valid()) {
+        std::vector<std::string> locators;
+        std::vector<size_t> locator_pos;
+        for (; it_->Valid() && entries_.size() < batch_size_; it_->Next()) {
+            rocksdb::Slice value = it_->value();
+            if (value.empty()) {
+                continue;
+            }
+            entries_.emplace_back();
+            auto& entry = entries_.back();
+            entry.key.assign(it_->key().data(), it_->key().size());
+            if (value[0] == ROW_VALUE_TAG) {
+                values_.emplace_back(value.data() + 1, value.size() - 1);
+                entry.value = values_.back();
+                entry.found = true;
+            } else {
+                locators.emplace_back(value.data() + 1, value.size() - 1);
+                locator_pos.push_back(entries_.size() - 1);
+            }
+        }
+        batch_size_ = std::min(batch_size_ * 2, MAX_LOCATOR_BATCH);
+        if (!locators.empty()) {
+            Resolve(locators, locator_pos);
+        }
+        entries_.erase(
+            std::remove_if(entries_.begin(), entries_.end(), [](const Entry& entry) { return !entry.found; }),
+            entries_.end());
+    }
+}
+
+void RowLocatorIterator::Resolve(const std::vector<std::string>& locators, const std::vector<size_t>& pos) {
+    auto& cache = locator_->row_cache;
+    std::vector<rocksdb::Slice> keys;
+    std::vector<size_t> miss;
+    keys.reserve(locators.size());
+    for (size_t i = 0; i < locators.size(); i++) {
+        if (cache) {
+            auto handle = cache->Lookup(locator_->cache_prefix + locators[i]);
+            if (handle != nullptr) {
+                values_.emplace_back(*static_cast<std::string*>(cache->Value(handle)));
+                cache->Release(handle);
+                entries_[pos[i]].value = values_.back();
+                entries_[pos[i]].found = true;
+                continue;
+            }
+        }
+        keys.emplace_back(locators[i]);
+        miss.push_back(i);
+    }
+    if (keys.empty()) {
+        return;
+    }
+    std::vector<rocksdb::PinnableSlice> rows(keys.size());
+    std::vector<rocksdb::Status> statuses(keys.size());
+    locator_->db->MultiGet(ro_, locator_->primary_cf, keys.size(), keys.data(), rows.data(), statuses.data());
+    for (size_t i = 0; i < keys.size(); i++) {
+        if (!statuses[i].ok()) {
+            if (!statuses[i].IsNotFound()) {
+                status_ = statuses[i];
+            }
+            continue;
+        }
+        values_.emplace_back(rows[i].data(), rows[i].size());
+        auto& entry = entries_[pos[miss[i]]];
+        entry.value = values_.back();
+        entry.found = true;
+        if (cache) {
+            cache->Insert(locator_->cache_prefix + locators[miss[i]], new std::string(values_.back()),
+                          values_.back().size(), &DeleteCachedRow);
+        }
+    }
+}
+
 DiskTableIterator::DiskTableIterator(rocksdb::DB* db, rocksdb::Iterator* it, const rocksdb::Snapshot* snapshot,
                                      const std::string& pk)
     : db_(db), it_(it), snapshot_(snapshot), pk_(pk), ts_(0) {}
@@ -846,17 +1465,23 @@ void DiskTableTraverseIterator::NextPK() {
     rocksdb::ReadOptions ro = rocksdb::ReadOptions();
     const rocksdb::Snapshot* snapshot = db_->GetSnapshot();
     ro.snapshot = snapshot;
-    // ro.prefix_same_as_start = true;
+    // keys of all pks are iterated, so prefix_same_as_start is not set
     ro.pin_data = true;
+    // keys are traversed without reading rows, locators are only resolved by row iterators
     rocksdb::Iterator* it = db_->NewIterator(ro, cf_hs_[inner_pos + 1]);
-    if (inner_index && inner_index->GetIndex().size() > 1) {
-        auto ts_col = index_def->GetTsColumn();
-        if (ts_col) {
-            return new DiskTableKeyIterator(db_, it, snapshot, ttl->ttl_type, expire_time, expire_cnt,
-                                                 ts_col->GetId(), cf_hs_[inner_pos + 1]);
-        }
+    DiskTableKeyIterator* key_it = nullptr;
+    auto ts_col = index_def->GetTsColumn();
+    if (inner_index && inner_index->GetIndex().size() > 1 && ts_col) {
+        key_it = new DiskTableKeyIterator(db_, it, snapshot, ttl->ttl_type, expire_time, expire_cnt, ts_col->GetId(),
+                                          cf_hs_[inner_pos + 1]);
+    } else {
+        key_it = new DiskTableKeyIterator(db_, it, snapshot, ttl->ttl_type, expire_time, expire_cnt,
+                                          cf_hs_[inner_pos + 1]);
+    }
+    if (row_locator_layout_ && inner_pos > 0) {
+        key_it->SetRowLocator(std::atomic_load(&row_locator_));
     }
-    return new DiskTableKeyIterator(db_, it, snapshot, ttl->ttl_type, expire_time, expire_cnt, cf_hs_[inner_pos + 1]);
+    return key_it;
 }
 
 DiskTableKeyIterator::DiskTableKeyIterator(rocksdb::DB* db, rocksdb::Iterator* it,
@@ -959,9 +1584,13 @@ std::unique_ptr<::hybridse::vm::RowIterator> DiskTableKeyIterator::GetValue() {
     rocksdb::ReadOptions ro = rocksdb::ReadOptions();
     const rocksdb::Snapshot* snapshot = db_->GetSnapshot();
     ro.snapshot = snapshot;
-    // ro.prefix_same_as_start = true;
+    // rows of a window share the prefix, so the prefix bloom filter skips the other sst files
+    ro.prefix_same_as_start = true;
     ro.pin_data = true;
     rocksdb::Iterator* it = db_->NewIterator(ro, column_handle_);
+    if (row_locator_) {
+        it = new RowLocatorIterator(it, snapshot, row_locator_);
+    }
     std::unique_ptr<DiskTableRowIterator> wit(new DiskTableRowIterator(db_, it, snapshot, ttl_type_, expire_time_,
                                                                        expire_cnt_, pk_, ts_, has_ts_idx_, ts_idx_));
     return wit;
@@ -971,9 +1600,13 @@ std::unique_ptr<::hybridse::vm::RowIterator> DiskTableKeyIterator::GetValue() {
     rocksdb::ReadOptions ro = rocksdb::ReadOptions();
     const rocksdb::Snapshot* snapshot = db_->GetSnapshot();
     ro.snapshot = snapshot;
-    // ro.prefix_same_as_start = true;
+    // rows of a window share the prefix, so the prefix bloom filter skips the other sst files
+    ro.prefix_same_as_start = true;
     ro.pin_data = true;
     rocksdb::Iterator* it = db_->NewIterator(ro, column_handle_);
+    if (row_locator_) {
+        it = new RowLocatorIterator(it, snapshot, row_locator_);
+    }
     return new DiskTableRowIterator(db_, it, snapshot, ttl_type_, expire_time_, expire_cnt_, pk_, ts_, has_ts_idx_,
                                     ts_idx_);
 }
@@ -1117,19 +1750,29 @@ uint64_t DiskTable::GetRecordIdxByteSize() {
 }
 
 int DiskTable::GetCount(uint32_t index, const std::string& pk, uint64_t& count) {
-    PDLOG(WARNING, "Count in disk table is slow");
     std::shared_ptr<IndexDef> index_def = table_index_.GetIndex(index);
-    if (index_def && !index_def->IsReady()) {
+    if (!index_def || !index_def->IsReady()) {
         return -1;
     }
+    KeyMeta meta;
+    if (GetKeyMeta(index, pk, &meta)) {
+        // the oldest row has the smallest ts and the largest rank, if it is not expired
+        // no row of pk has been dropped by ttl and the count is exact
+        auto ttl = index_def->GetTTL();
+        TTLSt expire_value(GetExpireTime(*ttl), ttl->lat_ttl, ttl->ttl_type);
+        uint32_t oldest_idx = static_cast<uint32_t>(std::min<uint64_t>(meta.count, UINT32_MAX));
+        if (meta.count == 0 || !expire_value.IsExpired(meta.min_ts, oldest_idx)) {
+            key_meta_hit_.fetch_add(1, std::memory_order_relaxed);
+            count = meta.count;
+            return 0;
+        }
+    }
+    key_meta_miss_.fetch_add(1, std::memory_order_relaxed);
     uint32_t inner_pos = index_def->GetInnerPos();
     auto inner_index = table_index_.GetInnerIndex(inner_pos);
     rocksdb::ReadOptions ro = rocksdb::ReadOptions();
-    const rocksdb::Snapshot* snapshot = db_->GetSnapshot();
-    ro.snapshot = snapshot;
-    // ro.prefix_same_as_start = true;
-    ro.pin_data = true;
-    rocksdb::Iterator* it = db_->NewIterator(ro, cf_hs_[inner_pos + 1]);
+    ro.prefix_same_as_start = true;
+    std::unique_ptr<rocksdb::Iterator> it(db_->NewIterator(ro, cf_hs_[inner_pos + 1]));
 
     bool has_ts_idx = false;
     uint32_t ts_idx;
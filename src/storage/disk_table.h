@@ -16,9 +16,13 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <deque>
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <vector>
 #include "base/endianconv.h"
@@ -28,12 +32,15 @@
 #include "gflags/gflags.h"
 #include "proto/common.pb.h"
 #include "proto/tablet.pb.h"
+#include "rocksdb/cache.h"
 #include "rocksdb/compaction_filter.h"
 #include "rocksdb/db.h"
 #include "rocksdb/filter_policy.h"
+#include "rocksdb/merge_operator.h"
 #include "rocksdb/options.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/slice_transform.h"
+#include "rocksdb/statistics.h"
 #include "rocksdb/status.h"
 #include "rocksdb/table.h"
 #include "rocksdb/utilities/checkpoint.h"
@@ -143,72 +150,234 @@ class KeyTsPrefixTransform : public rocksdb::SliceTransform {
     bool SameResultWhenAppended(const rocksdb::Slice& prefix) const override { return InDomain(prefix); }
 };
 
-class AbsoluteTTLCompactionFilter : public rocksdb::CompactionFilter {
- public:
-    explicit AbsoluteTTLCompactionFilter(std::shared_ptr<InnerIndexSt> inner_index) : inner_index_(inner_index) {}
-    virtual ~AbsoluteTTLCompactionFilter() {}
-
-    const char* Name() const override { return "AbsoluteTTLCompactionFilter"; }
+// Count and ts range of the rows of a pk in an index, kept in the default column family
+// with merge operands so that puts never read it. Rows dropped by ttl are subtracted by an
+// operand with negative count and min_ts_floor, the smallest ts which may be left. Operands
+// apply in order, so the floor raises min_ts of the rows put before it and never hides older
+// rows put after it. As puts do not check whether the row exists, a row put again would be
+// counted twice. A put not newer than the rows before it marks the meta as overlapped, and
+// the count of an overlapped meta is not used, the rows are scanned instead. Rows put in ts
+// order, the common case, keep the count exact.
+struct KeyMeta {
+    // wraps around for negative operands
+    uint64_t count = 0;
+    uint64_t min_ts = UINT64_MAX;
+    uint64_t max_ts = 0;
+    uint64_t min_ts_floor = 0;
+    // 1 if a row may be counted more than once
+    uint64_t overlapped = 0;
+
+    static const size_t ENCODED_SIZE = sizeof(uint64_t) * 5;
+    // without min_ts_floor and overlapped, or without overlapped
+    static const size_t OLD_ENCODED_SIZE = sizeof(uint64_t) * 3;
+    static const size_t OLD_FLOOR_ENCODED_SIZE = sizeof(uint64_t) * 4;
+
+    void Encode(std::string* value) const {
+        value->resize(ENCODED_SIZE);
+        char* buf = &(*value)[0];
+        memcpy(buf, &count, sizeof(uint64_t));
+        memcpy(buf + sizeof(uint64_t), &min_ts, sizeof(uint64_t));
+        memcpy(buf + sizeof(uint64_t) * 2, &max_ts, sizeof(uint64_t));
+        memcpy(buf + sizeof(uint64_t) * 3, &min_ts_floor, sizeof(uint64_t));
+        memcpy(buf + sizeof(uint64_t) * 4, &overlapped, sizeof(uint64_t));
+    }
 
-    bool Filter(int /*level*/, const rocksdb::Slice& key, const rocksdb::Slice& /*existing_value*/,
-                std::string* /*new_value*/, bool* /*value_changed*/) const override {
-        if (key.size() < TS_LEN) {
+    bool Decode(const rocksdb::Slice& value) {
+        if (value.size() != ENCODED_SIZE && value.size() != OLD_ENCODED_SIZE &&
+            value.size() != OLD_FLOOR_ENCODED_SIZE) {
             return false;
         }
-        uint64_t real_ttl = 0;
-        const auto& indexs = inner_index_->GetIndex();
-        if (indexs.size() > 1) {
-            if (key.size() < TS_LEN + TS_POS_LEN) {
-                return false;
-            }
-            uint32_t ts_idx = *((uint32_t*)(key.data() + key.size() - TS_LEN -  // NOLINT
-                                          TS_POS_LEN));
-            bool has_found = false;
-            for (const auto index : indexs) {
-                auto ts_col = index->GetTsColumn();
-                if (!ts_col) {
-                    return false;
-                }
-                if (ts_col->GetId() == ts_idx) {
-                    real_ttl = index->GetTTL()->abs_ttl;
-                    has_found = true;
-                    break;
-                }
-            }
-            if (!has_found) {
-                return false;
-            }
-        } else {
-            real_ttl = indexs.front()->GetTTL()->abs_ttl;
+        memcpy(&count, value.data(), sizeof(uint64_t));
+        memcpy(&min_ts, value.data() + sizeof(uint64_t), sizeof(uint64_t));
+        memcpy(&max_ts, value.data() + sizeof(uint64_t) * 2, sizeof(uint64_t));
+        min_ts_floor = 0;
+        if (value.size() > OLD_ENCODED_SIZE) {
+            memcpy(&min_ts_floor, value.data() + sizeof(uint64_t) * 3, sizeof(uint64_t));
+        }
+        // the old versions checked that the row did not exist before counting it
+        overlapped = 0;
+        if (value.size() == ENCODED_SIZE) {
+            memcpy(&overlapped, value.data() + sizeof(uint64_t) * 4, sizeof(uint64_t));
         }
-        if (real_ttl < 1) {
+        return true;
+    }
+
+    // other is applied after this
+    void Merge(const KeyMeta& other) {
+        // min_ts is UINT64_MAX until a row is put
+        if (other.overlapped || (min_ts != UINT64_MAX && other.min_ts <= max_ts)) {
+            overlapped = 1;
+        }
+        count += other.count;
+        min_ts_floor = std::max(std::min(min_ts_floor, other.min_ts), other.min_ts_floor);
+        min_ts = std::min(min_ts, other.min_ts);
+        max_ts = std::max(max_ts, other.max_ts);
+    }
+};
+
+// Rows dropped by TTLCompactionFilter are collected here and subtracted from key meta by gc,
+// because compaction filters must not write to the db. Keyed by the key of KeyMeta.
+class ExpiredKeyMeta {
+ public:
+    ExpiredKeyMeta() : enabled_(false) {}
+    void SetEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool IsEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+    void Add(const std::map<std::string, KeyMeta>& metas) {
+        std::lock_guard<std::mutex> lock(mu_);
+        for (const auto& kv : metas) {
+            metas_[kv.first].Merge(kv.second);
+        }
+    }
+    void Erase(const std::string& meta_key) {
+        std::lock_guard<std::mutex> lock(mu_);
+        metas_.erase(meta_key);
+    }
+    void Swap(std::map<std::string, KeyMeta>* metas) {
+        std::lock_guard<std::mutex> lock(mu_);
+        metas_.swap(*metas);
+    }
+
+ private:
+    std::atomic<bool> enabled_;
+    std::mutex mu_;
+    std::map<std::string, KeyMeta> metas_;
+};
+
+// key of KeyMeta is 0 | inner pos | ts column id | pk, which never conflicts with other
+// keys of the default column family
+static inline std::string CombineMetaKey(const std::string& pk, uint32_t inner_pos, uint32_t ts_idx) {
+    std::string result;
+    result.resize(1 + TS_POS_LEN * 2 + pk.size());
+    char* buf = &result[0];
+    buf[0] = 0;
+    memcpy(buf + 1, &inner_pos, TS_POS_LEN);
+    memcpy(buf + 1 + TS_POS_LEN, &ts_idx, TS_POS_LEN);
+    memcpy(buf + 1 + TS_POS_LEN * 2, pk.data(), pk.size());
+    return result;
+}
+
+class KeyMetaMergeOperator : public rocksdb::AssociativeMergeOperator {
+ public:
+    const char* Name() const override { return "KeyMetaMergeOperator"; }
+
+    bool Merge(const rocksdb::Slice& /*key*/, const rocksdb::Slice* existing_value, const rocksdb::Slice& value,
+               std::string* new_value, rocksdb::Logger* /*logger*/) const override {
+        KeyMeta meta;
+        if (existing_value != nullptr && !meta.Decode(*existing_value)) {
             return false;
         }
-        uint64_t ts = 0;
-        memcpy(static_cast<void*>(&ts), key.data() + key.size() - TS_LEN, TS_LEN);
-        memrev64ifbe(static_cast<void*>(&ts));
-        uint64_t cur_time = ::baidu::common::timer::get_micros() / 1000;
-        if (ts < cur_time - real_ttl) {
-            return true;
+        KeyMeta operand;
+        if (!operand.Decode(value)) {
+            return false;
         }
-        return false;
+        meta.Merge(operand);
+        meta.Encode(new_value);
+        return true;
     }
+};
+
+// Drop expired rows during compaction, so that gc needs no extra scan of the table.
+// Keys of one pk (and ts column) are adjacent and ordered by ts desc, so the
+// rank used by latest ttl is counted while the keys are passing by. Keys of the
+// same pk out of this compaction are not counted, which only makes the filter
+// keep more rows than the ttl allows until they meet in a later compaction, so
+// latest ttl is approximate on disk. The iterators check the ttl again when reading.
+class TTLCompactionFilter : public rocksdb::CompactionFilter {
+ public:
+    TTLCompactionFilter(std::shared_ptr<InnerIndexSt> inner_index, std::shared_ptr<ExpiredKeyMeta> expired_meta);
+    virtual ~TTLCompactionFilter();
+
+    const char* Name() const override { return "TTLCompactionFilter"; }
+
+    bool Filter(int /*level*/, const rocksdb::Slice& key, const rocksdb::Slice& /*existing_value*/,
+                std::string* /*new_value*/, bool* /*value_changed*/) const override;
 
  private:
-    std::shared_ptr<InnerIndexSt> inner_index_;
+    bool has_ts_idx_;
+    // ttl with abs_ttl converted to expire time, keyed by ts column id
+    std::map<uint32_t, TTLSt> expire_map_;
+    TTLSt expire_value_;
+    bool need_gc_;
+    // the filter is created for each compaction and keys are filtered in order
+    mutable std::string last_prefix_;
+    mutable uint32_t record_idx_;
+    uint32_t inner_pos_;
+    // nullptr if the table keeps no key meta
+    std::shared_ptr<ExpiredKeyMeta> expired_meta_;
+    mutable std::map<std::string, KeyMeta> expired_;
 };
 
-class AbsoluteTTLFilterFactory : public rocksdb::CompactionFilterFactory {
+class TTLFilterFactory : public rocksdb::CompactionFilterFactory {
  public:
-    explicit AbsoluteTTLFilterFactory(const std::shared_ptr<InnerIndexSt>& inner_index) : inner_index_(inner_index) {}
+    TTLFilterFactory(const std::shared_ptr<InnerIndexSt>& inner_index,
+                     const std::shared_ptr<ExpiredKeyMeta>& expired_meta)
+        : inner_index_(inner_index), expired_meta_(expired_meta) {}
     std::unique_ptr<rocksdb::CompactionFilter> CreateCompactionFilter(
         const rocksdb::CompactionFilter::Context& context) override {
-        return std::unique_ptr<rocksdb::CompactionFilter>(new AbsoluteTTLCompactionFilter(inner_index_));
+        return std::unique_ptr<rocksdb::CompactionFilter>(new TTLCompactionFilter(
+            inner_index_, expired_meta_->IsEnabled() ? expired_meta_ : std::shared_ptr<ExpiredKeyMeta>()));
     }
-    const char* Name() const override { return "AbsoluteTTLFilterFactory"; }
+    const char* Name() const override { return "TTLFilterFactory"; }
 
  private:
     std::shared_ptr<InnerIndexSt> inner_index_;
+    std::shared_ptr<ExpiredKeyMeta> expired_meta_;
+};
+
+// With row locator layout, the full row is only stored in the first index (the primary
+// index). The other indexes store a tag and the key of the row in the primary index, or
+// the row itself if the primary key is not in this partition.
+static const char ROW_LOCATOR_TAG = 0;
+static const char ROW_VALUE_TAG = 1;
+
+struct RowLocator {
+    rocksdb::DB* db;
+    rocksdb::ColumnFamilyHandle* primary_cf;
+    // shared by all tables, nullptr if disabled
+    std::shared_ptr<rocksdb::Cache> row_cache;
+    // tid, pid and delete epoch of the table, cached rows of old epoch are never hit
+    std::string cache_prefix;
+};
+
+// Wrap iterator of secondary index and replace locators with rows of primary index.
+// Entries are read ahead in batches, locators of a batch are looked up in row cache
+// and then with one MultiGet. Batch size starts small and is doubled on each refill,
+// so that short windows do not read much more than they need.
+class RowLocatorIterator : public rocksdb::Iterator {
+ public:
+    RowLocatorIterator(rocksdb::Iterator* it, const rocksdb::Snapshot* snapshot,
+                       const std::shared_ptr<RowLocator>& locator);
+    ~RowLocatorIterator() override;
+    bool Valid() const override { return pos_ < entries_.size(); }
+    void SeekToFirst() override;
+    void SeekToLast() override;
+    void Seek(const rocksdb::Slice& target) override;
+    void SeekForPrev(const rocksdb::Slice& target) override;
+    void Next() override;
+    // backward iteration is not used by disk table
+    void Prev() override;
+    rocksdb::Slice key() const override { return entries_[pos_].key; }
+    rocksdb::Slice value() const override { return entries_[pos_].value; }
+    rocksdb::Status status() const override { return status_.ok() ? it_->status() : status_; }
+
+ private:
+    struct Entry {
+        std::string key;
+        rocksdb::Slice value;
+        bool found = false;
+    };
+    void Fill(bool reset);
+    void Resolve(const std::vector<std::string>& locators, const std::vector<size_t>& pos);
+
+    rocksdb::Iterator* it_;
+    rocksdb::ReadOptions ro_;
+    std::shared_ptr<RowLocator> locator_;
+    std::vector<Entry> entries_;
+    size_t pos_;
+    size_t batch_size_;
+    // values are kept until the iterator is deleted, the same as pin_data
+    std::deque<std::string> values_;
+    rocksdb::Status status_;
 };
 
 class DiskTableIterator : public TableIterator {
@@ -330,6 +499,8 @@ class DiskTableKeyIterator : public ::hybridse::vm::WindowIterator {
 
     const hybridse::codec::Row GetKey() override;
 
+    void SetRowLocator(const std::shared_ptr<RowLocator>& row_locator) { row_locator_ = row_locator; }
+
  private:
     void NextPK();
 
@@ -345,6 +516,16 @@ class DiskTableKeyIterator : public ::hybridse::vm::WindowIterator {
     uint64_t ts_;
     uint32_t ts_idx_;
     rocksdb::ColumnFamilyHandle* column_handle_;
+    std::shared_ptr<RowLocator> row_locator_;
+};
+
+struct DiskTableFilterStats {
+    // lookups of sst files checked with bloom filter and the ones filtered out
+    uint64_t bloom_checked = 0;
+    uint64_t bloom_useful = 0;
+    // GetCount answered by key meta and the ones fell back to scan
+    uint64_t key_meta_hit = 0;
+    uint64_t key_meta_miss = 0;
 };
 
 class DiskTable : public Table {
@@ -402,16 +583,13 @@ class DiskTable : public Table {
 
     void SchedGc() override;
 
-    void GcHead();
-    void GcTTLAndHead();
-    void GcTTLOrHead();
-
     bool IsExpire(const ::openmldb::api::LogEntry& entry) override;
 
     void CompactDB() {
         for (rocksdb::ColumnFamilyHandle* cf : cf_hs_) {
             db_->CompactRange(rocksdb::CompactRangeOptions(), cf, nullptr, nullptr);
         }
+        ApplyExpiredKeyMeta();
     }
 
     int CreateCheckPoint(const std::string& checkpoint_dir);
@@ -425,7 +603,42 @@ class DiskTable : public Table {
 
     int GetCount(uint32_t index, const std::string& pk, uint64_t& count) override; // NOLINT
 
+    bool IsRowLocatorLayout() const { return row_locator_layout_; }
+
+    // return false if key meta is not kept by the table, meta is empty if pk is not found
+    bool GetKeyMeta(uint32_t index, const std::string& pk, KeyMeta* meta);
+
+    void GetFilterStats(DiskTableFilterStats* stats) const;
+
+    // small values kept along with the table, e.g. the tier boundary of a tiered table
+    bool PutMeta(const std::string& key, const std::string& value);
+    // return false if the key is not found or the read fails
+    bool GetMeta(const std::string& key, std::string* value);
+
  private:
+    bool InitRowLocator(bool is_new);
+    // rows are recomputed from the primary index on writes, so all indexes must expire rows the same way
+    bool CanUseRowLocator() const;
+    bool InitKeyMeta(bool is_new);
+    void MergeKeyMeta(rocksdb::WriteBatch* batch, const std::string& pk, uint32_t inner_pos, uint32_t ts_idx,
+                      uint64_t ts);
+    // subtract rows dropped by compaction from key meta
+    void ApplyExpiredKeyMeta();
+    // whether key is in the column family, rows put again are not counted by key meta
+    void ResetRowLocator();
+    // iterator of index, locators are resolved to rows if the index is secondary
+    rocksdb::Iterator* NewIndexIterator(const rocksdb::ReadOptions& ro, uint32_t inner_pos);
+    void EraseRowCache(const std::string& locator);
+    // the row at locator is about to be replaced or deleted, store it in the secondary indexes
+    // that still refer to it. return false if reading the old row fails
+    bool KeepReplacedRow(const std::string& locator, const std::string& new_value, rocksdb::WriteBatch* batch);
+    bool KeepRowInSecondaryIndex(const std::string& locator, const rocksdb::Slice& row, rocksdb::WriteBatch* batch);
+    // rows of pk are about to be deleted from primary index
+    bool KeepDeletedRows(const std::string& pk, rocksdb::WriteBatch* batch);
+    std::mutex& GetLocatorMutex(const std::string& locator) {
+        return locator_mu_[std::hash<std::string>()(locator) % LOCATOR_MUTEX_NUM];
+    }
+
     rocksdb::DB* db_;
     rocksdb::WriteOptions write_opts_;
     std::vector<rocksdb::ColumnFamilyDescriptor> cf_ds_;
@@ -434,6 +647,17 @@ class DiskTable : public Table {
     KeyTSComparator cmp_;
     std::atomic<uint64_t> offset_;
     std::string table_path_;
+    bool row_locator_layout_;
+    bool key_meta_;
+    std::shared_ptr<rocksdb::Statistics> statistics_;
+    std::atomic<uint64_t> key_meta_hit_;
+    std::atomic<uint64_t> key_meta_miss_;
+    std::shared_ptr<ExpiredKeyMeta> expired_meta_;
+    // replaced when primary index is deleted, access with atomic_load/atomic_store
+    std::shared_ptr<RowLocator> row_locator_;
+    // serialize writes of the same locator, so that the replaced row is read before it is overwritten
+    static constexpr uint32_t LOCATOR_MUTEX_NUM = 16;
+    std::mutex locator_mu_[LOCATOR_MUTEX_NUM];
 };
 
 }  // namespace storage
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gflags/gflags.h>
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/file_util.h"
+#include "codec/schema_codec.h"
+#include "codec/sdk_codec.h"
+#include "common/timer.h"
+#include "gtest/gtest.h"
+#include "storage/disk_table.h"
+
+using ::openmldb::codec::SchemaCodec;
+
+DECLARE_string(hdd_root_path);
+DECLARE_bool(disk_row_locator);
+
+namespace openmldb {
+namespace storage {
+
+static const int KEY_NUM = 5;
+static const int ROW_NUM = 20000;
+static const int QUERY_NUM = 2000;
+
+class DiskTableBenchmarkTest : public ::testing::Test {
+ public:
+    DiskTableBenchmarkTest() {}
+    ~DiskTableBenchmarkTest() {}
+};
+
+// Put rows into a table with 5 indexes and report the size of data and the latency of
+// window query on a secondary index, with and without row locator layout
+static void RunLayout(bool row_locator, uint32_t tid) {
+    ::openmldb::api::TableMeta table_meta;
+    table_meta.set_tid(tid);
+    table_meta.set_pid(1);
+    table_meta.set_storage_mode(::openmldb::common::kHDD);
+    table_meta.set_format_version(1);
+    for (int i = 0; i < KEY_NUM; i++) {
+        SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "k" + std::to_string(i), ::openmldb::type::kString);
+    }
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts", ::openmldb::type::kBigInt);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "payload", ::openmldb::type::kString);
+    for (int i = 0; i < KEY_NUM; i++) {
+        SchemaCodec::SetIndex(table_meta.add_column_key(), "k" + std::to_string(i), "k" + std::to_string(i), "ts",
+                              ::openmldb::type::kAbsoluteTime, 0, 0);
+    }
+    std::string table_path = FLAGS_hdd_root_path + "/" + std::to_string(tid) + "_1";
+    FLAGS_disk_row_locator = row_locator;
+    DiskTable* table = new DiskTable(table_meta, table_path);
+    ASSERT_TRUE(table->Init());
+    FLAGS_disk_row_locator = false;
+    ASSERT_EQ(row_locator, table->IsRowLocatorLayout());
+
+    codec::SDKCodec codec(table_meta);
+    std::string payload(256, 'x');
+    uint64_t start = ::baidu::common::timer::get_micros();
+    for (int n = 0; n < ROW_NUM; n++) {
+        std::vector<std::string> row;
+        Dimensions dims;
+        for (int i = 0; i < KEY_NUM; i++) {
+            std::string key = "key" + std::to_string(n % (100 * (i + 1)));
+            row.push_back(key);
+            ::openmldb::api::Dimension* dim = dims.Add();
+            dim->set_key(key);
+            dim->set_idx(i);
+        }
+        row.push_back(std::to_string(1000 + n));
+        row.push_back(payload);
+        std::string value;
+        ASSERT_EQ(0, codec.EncodeRow(row, &value));
+        ASSERT_TRUE(table->Put(1000 + n, value, dims));
+    }
+    uint64_t put_time = ::baidu::common::timer::get_micros() - start;
+    table->CompactDB();
+    uint64_t size = 0;
+    ASSERT_TRUE(::openmldb::base::GetDirSizeRecur(table_path + "/data", size));
+
+    // window of 100 rows on the last index
+    std::unique_ptr<::hybridse::vm::WindowIterator> it(table->NewWindowIterator(KEY_NUM - 1));
+    uint64_t total_bytes = 0;
+    start = ::baidu::common::timer::get_micros();
+    for (int n = 0; n < QUERY_NUM; n++) {
+        it->Seek("key" + std::to_string(n % (100 * KEY_NUM)));
+        ASSERT_TRUE(it->Valid());
+        auto wit = it->GetValue();
+        wit->SeekToFirst();
+        for (int cnt = 0; wit->Valid() && cnt < 100; cnt++) {
+            total_bytes += wit->GetValue().size();
+            wit->Next();
+        }
+    }
+    uint64_t query_time = ::baidu::common::timer::get_micros() - start;
+    std::cout << (row_locator ? "row locator layout" : "full row layout") << ": data size " << size / 1024
+              << "KB, put " << put_time / ROW_NUM << "us/row, window query " << query_time / QUERY_NUM
+              << "us/query, read " << total_bytes / QUERY_NUM << " bytes/query" << std::endl;
+    delete table;
+    ::openmldb::base::RemoveDirRecursive(table_path);
+}
+
+TEST_F(DiskTableBenchmarkTest, RowLayout) {
+    RunLayout(false, 1);
+    RunLayout(true, 2);
+}
+
+}  // namespace storage
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    FLAGS_hdd_root_path = "/tmp/disk_table_bench_" + std::to_string(::baidu::common::timer::get_micros());
+    int ret = RUN_ALL_TESTS();
+    ::openmldb::base::RemoveDirRecursive(FLAGS_hdd_root_path);
+    return ret;
+}
@@ -33,6 +33,8 @@ DECLARE_string(ssd_root_path);
 DECLARE_string(hdd_root_path);
 DECLARE_uint32(max_traverse_cnt);
 DECLARE_int32(gc_safe_offset);
+DECLARE_bool(disk_row_locator);
+DECLARE_uint32(disk_row_cache_mb);
 
 namespace openmldb {
 namespace storage {
@@ -1025,6 +1027,8 @@ TEST_F(DiskTableTest, GcHeadMulTs) {
         }
     }
     table->SchedGc();
+    // expired rows are dropped when compaction runs the ttl filter
+    table->CompactDB();
     iter = table->NewIterator(0, "card0", ticket);
     iter->SeekToFirst();
     while (iter->Valid()) {
@@ -1103,7 +1107,9 @@ TEST_F(DiskTableTest, GcHead) {
             }
         }
     }
-    table->GcHead();
+    table->SchedGc();
+    // expired rows are dropped when compaction runs the ttl filter
+    table->CompactDB();
     for (int idx = 0; idx < 100; idx++) {
         std::string key = "test" + std::to_string(idx);
         uint64_t ts = 9537;
@@ -1125,6 +1131,366 @@ TEST_F(DiskTableTest, GcHead) {
     RemoveData(table_path);
 }
 
+TEST_F(DiskTableTest, GcAbsAndLat) {
+    ::openmldb::api::TableMeta table_meta;
+    table_meta.set_tid(16);
+    table_meta.set_pid(1);
+    table_meta.set_storage_mode(::openmldb::common::kHDD);
+    table_meta.set_format_version(1);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "card", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "mcc", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts1", ::openmldb::type::kBigInt);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts2", ::openmldb::type::kBigInt);
+    // abs ttl is 5 minutes
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card", "card", "ts1", ::openmldb::type::kAbsAndLat, 5, 3);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card1", "card", "ts2", ::openmldb::type::kAbsOrLat, 5, 3);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "mcc", "mcc", "ts2", ::openmldb::type::kAbsOrLat, 5, 3);
+
+    std::string table_path = FLAGS_hdd_root_path + "/16_1";
+    DiskTable* table = new DiskTable(table_meta, table_path);
+    ASSERT_TRUE(table->Init());
+    codec::SDKCodec codec(table_meta);
+
+    uint64_t cur_time = ::baidu::common::timer::get_micros() / 1000;
+    // rows of key 0 are all in abs ttl, the others are older one minute each
+    auto get_ts = [cur_time](int idx, int i) -> uint64_t {
+        return idx == 0 ? cur_time - i : cur_time - i * 60 * 1000;
+    };
+    for (int idx = 0; idx < 10; idx++) {
+        Dimensions dims;
+        ::openmldb::api::Dimension* dim = dims.Add();
+        dim->set_key("card" + std::to_string(idx));
+        dim->set_idx(0);
+        ::openmldb::api::Dimension* dim1 = dims.Add();
+        dim1->set_key("card" + std::to_string(idx));
+        dim1->set_idx(1);
+        ::openmldb::api::Dimension* dim2 = dims.Add();
+        dim2->set_key("mcc" + std::to_string(idx));
+        dim2->set_idx(2);
+        for (int i = 0; i < 10; i++) {
+            uint64_t ts = get_ts(idx, i);
+            std::vector<std::string> row = {"value" + std::to_string(i), "value" + std::to_string(i),
+                                            std::to_string(ts), std::to_string(ts)};
+            std::string value;
+            ASSERT_EQ(0, codec.EncodeRow(row, &value));
+            ASSERT_TRUE(table->Put(ts, value, dims));
+        }
+    }
+    table->SchedGc();
+    // expired rows are dropped when compaction runs the ttl filter
+    table->CompactDB();
+    for (int idx = 0; idx < 10; idx++) {
+        std::string key = "card" + std::to_string(idx);
+        std::string key1 = "mcc" + std::to_string(idx);
+        for (int i = 0; i < 10; i++) {
+            uint64_t ts = get_ts(idx, i);
+            std::string value;
+            // abs and lat: expired only if older than 5 minutes and out of the latest 3 rows
+            bool and_expired = idx != 0 && i >= 5;
+            // abs or lat: expired if older than 5 minutes or out of the latest 3 rows
+            bool or_expired = i >= 3;
+            ASSERT_EQ(!and_expired, table->Get(0, key, ts, value)) << key << " " << i;
+            ASSERT_EQ(!or_expired, table->Get(1, key, ts, value)) << key << " " << i;
+            ASSERT_EQ(!or_expired, table->Get(2, key1, ts, value)) << key1 << " " << i;
+        }
+    }
+    delete table;
+    RemoveData(table_path);
+}
+
+TEST_F(DiskTableTest, RowLocatorLayout) {
+    ::openmldb::api::TableMeta table_meta;
+    table_meta.set_tid(17);
+    table_meta.set_pid(1);
+    table_meta.set_storage_mode(::openmldb::common::kHDD);
+    table_meta.set_format_version(1);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "card", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "mcc", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts1", ::openmldb::type::kBigInt);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts2", ::openmldb::type::kBigInt);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card", "card", "ts1", ::openmldb::type::kAbsoluteTime, 0, 0);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card1", "card", "ts2", ::openmldb::type::kAbsoluteTime, 0, 0);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "mcc", "mcc", "ts2", ::openmldb::type::kAbsoluteTime, 0, 0);
+
+    std::string table_path = FLAGS_hdd_root_path + "/17_1";
+    FLAGS_disk_row_locator = true;
+    DiskTable* table = new DiskTable(table_meta, table_path);
+    ASSERT_TRUE(table->Init());
+    FLAGS_disk_row_locator = false;
+    ASSERT_TRUE(table->IsRowLocatorLayout());
+    codec::SDKCodec codec(table_meta);
+
+    auto encode = [&codec](int idx, int i) {
+        std::vector<std::string> row = {"card" + std::to_string(idx), "mcc" + std::to_string(idx),
+                                        std::to_string(1000 + i), std::to_string(1000 + i)};
+        std::string value;
+        codec.EncodeRow(row, &value);
+        return value;
+    };
+    for (int idx = 0; idx < 10; idx++) {
+        for (int i = 0; i < 10; i++) {
+            Dimensions dims;
+            // key of primary index is not in this partition, row is stored in the secondary index
+            if (idx != 9) {
+                ::openmldb::api::Dimension* dim = dims.Add();
+                dim->set_key("card" + std::to_string(idx));
+                dim->set_idx(0);
+                ::openmldb::api::Dimension* dim1 = dims.Add();
+                dim1->set_key("card" + std::to_string(idx));
+                dim1->set_idx(1);
+            }
+            ::openmldb::api::Dimension* dim2 = dims.Add();
+            dim2->set_key("mcc" + std::to_string(idx));
+            dim2->set_idx(2);
+            ASSERT_TRUE(table->Put(1000 + i, encode(idx, i), dims));
+        }
+    }
+    auto check = [&](DiskTable* table, int deleted) {
+        for (int idx = 0; idx < 10; idx++) {
+            std::string key = "card" + std::to_string(idx);
+            std::string key1 = "mcc" + std::to_string(idx);
+            for (int i = 0; i < 10; i++) {
+                std::string value;
+                ASSERT_EQ(idx != 9 && idx != deleted, table->Get(0, key, 1000 + i, value));
+                ASSERT_TRUE(table->Get(2, key1, 1000 + i, value));
+                ASSERT_EQ(encode(idx, i), value);
+            }
+        }
+        // window of secondary index reads rows in batches
+        std::unique_ptr<::hybridse::vm::WindowIterator> it(table->NewWindowIterator(2));
+        for (int idx : {0, 5, 9}) {
+            it->Seek("mcc" + std::to_string(idx));
+            ASSERT_TRUE(it->Valid());
+            ASSERT_EQ("mcc" + std::to_string(idx), it->GetKey().ToString());
+            auto wit = it->GetValue();
+            wit->SeekToFirst();
+            int cnt = 0;
+            while (wit->Valid()) {
+                auto& row = wit->GetValue();
+                ASSERT_EQ(encode(idx, 9 - cnt), std::string(reinterpret_cast<char*>(row.buf()), row.size()));
+                ASSERT_EQ(static_cast<uint64_t>(1009 - cnt), wit->GetKey());
+                cnt++;
+                wit->Next();
+            }
+            ASSERT_EQ(10, cnt);
+        }
+    };
+    check(table, -1);
+    // rows are kept in secondary index when the key is deleted from primary index
+    ASSERT_TRUE(table->Delete("card5", 0));
+    check(table, 5);
+    delete table;
+
+    // layout is kept by the table no matter what the flag is
+    table = new DiskTable(table_meta, table_path);
+    ASSERT_TRUE(table->Init());
+    ASSERT_TRUE(table->IsRowLocatorLayout());
+    check(table, 5);
+    delete table;
+    RemoveData(table_path);
+}
+
+TEST_F(DiskTableTest, RowLocatorOverwrite) {
+    ::openmldb::api::TableMeta table_meta;
+    table_meta.set_tid(19);
+    table_meta.set_pid(1);
+    table_meta.set_storage_mode(::openmldb::common::kHDD);
+    table_meta.set_format_version(1);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "card", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "mcc", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts1", ::openmldb::type::kBigInt);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card", "card", "ts1", ::openmldb::type::kAbsoluteTime, 0, 0);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "mcc", "mcc", "ts1", ::openmldb::type::kAbsoluteTime, 0, 0);
+
+    std::string table_path = FLAGS_hdd_root_path + "/19_1";
+    FLAGS_disk_row_locator = true;
+    DiskTable* table = new DiskTable(table_meta, table_path);
+    ASSERT_TRUE(table->Init());
+    FLAGS_disk_row_locator = false;
+    ASSERT_TRUE(table->IsRowLocatorLayout());
+    codec::SDKCodec codec(table_meta);
+
+    auto put = [&](const std::string& mcc) {
+        std::vector<std::string> row = {"card0", mcc, "1000"};
+        std::string value;
+        codec.EncodeRow(row, &value);
+        Dimensions dims;
+        ::openmldb::api::Dimension* dim = dims.Add();
+        dim->set_key("card0");
+        dim->set_idx(0);
+        ::openmldb::api::Dimension* dim1 = dims.Add();
+        dim1->set_key(mcc);
+        dim1->set_idx(1);
+        EXPECT_TRUE(table->Put(1000, value, dims));
+        return value;
+    };
+    // same primary key and ts with different secondary keys
+    std::string value0 = put("mcc0");
+    std::string value1 = put("mcc1");
+    std::string value;
+    ASSERT_TRUE(table->Get(0, "card0", 1000, value));
+    ASSERT_EQ(value1, value);
+    ASSERT_TRUE(table->Get(1, "mcc0", 1000, value));
+    ASSERT_EQ(value0, value);
+    ASSERT_TRUE(table->Get(1, "mcc1", 1000, value));
+    ASSERT_EQ(value1, value);
+    // putting the same row again does not change anything
+    put("mcc1");
+    ASSERT_TRUE(table->Get(1, "mcc0", 1000, value));
+    ASSERT_EQ(value0, value);
+    ASSERT_TRUE(table->Get(1, "mcc1", 1000, value));
+    ASSERT_EQ(value1, value);
+    delete table;
+    RemoveData(table_path);
+}
+
+TEST_F(DiskTableTest, RowLocatorLayoutTTL) {
+    ::openmldb::api::TableMeta table_meta;
+    table_meta.set_tid(19);
+    table_meta.set_pid(2);
+    table_meta.set_storage_mode(::openmldb::common::kHDD);
+    table_meta.set_format_version(1);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "card", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "mcc", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts1", ::openmldb::type::kBigInt);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card", "card", "ts1", ::openmldb::type::kAbsoluteTime, 10, 0);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "mcc", "mcc", "ts1", ::openmldb::type::kAbsoluteTime, 20, 0);
+
+    // secondary entries would outlive the rows of primary index
+    std::string table_path = FLAGS_hdd_root_path + "/19_2";
+    FLAGS_disk_row_locator = true;
+    DiskTable* table = new DiskTable(table_meta, table_path);
+    ASSERT_TRUE(table->Init());
+    ASSERT_FALSE(table->IsRowLocatorLayout());
+    delete table;
+    RemoveData(table_path);
+
+    table_meta.mutable_column_key(1)->mutable_ttl()->set_abs_ttl(10);
+    table = new DiskTable(table_meta, table_path);
+    ASSERT_TRUE(table->Init());
+    FLAGS_disk_row_locator = false;
+    ASSERT_TRUE(table->IsRowLocatorLayout());
+    delete table;
+    RemoveData(table_path);
+}
+
+TEST_F(DiskTableTest, KeyMetaCount) {
+    ::openmldb::api::TableMeta table_meta;
+    table_meta.set_tid(18);
+    table_meta.set_pid(1);
+    table_meta.set_storage_mode(::openmldb::common::kHDD);
+    table_meta.set_format_version(1);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "card", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "mcc", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts1", ::openmldb::type::kBigInt);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts2", ::openmldb::type::kBigInt);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card", "card", "ts1", ::openmldb::type::kAbsoluteTime, 0, 0);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card1", "card", "ts2", ::openmldb::type::kLatestTime, 0, 5);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "mcc", "mcc", "ts1", ::openmldb::type::kAbsoluteTime, 0, 0);
+
+    std::string table_path = FLAGS_hdd_root_path + "/18_1";
+    DiskTable* table = new DiskTable(table_meta, table_path);
+    ASSERT_TRUE(table->Init());
+    codec::SDKCodec codec(table_meta);
+    for (int idx = 0; idx < 3; idx++) {
+        for (int i = 0; i < 10; i++) {
+            std::vector<std::string> row = {"card" + std::to_string(idx), "mcc" + std::to_string(idx),
+                                            std::to_string(1000 + i), std::to_string(2000 + i)};
+            std::string value;
+            codec.EncodeRow(row, &value);
+            Dimensions dims;
+            ::openmldb::api::Dimension* dim = dims.Add();
+            dim->set_key("card" + std::to_string(idx));
+            dim->set_idx(0);
+            // the same inner index, the row should be counted once
+            ::openmldb::api::Dimension* dim1 = dims.Add();
+            dim1->set_key("card" + std::to_string(idx));
+            dim1->set_idx(1);
+            ::openmldb::api::Dimension* dim2 = dims.Add();
+            dim2->set_key("mcc" + std::to_string(idx));
+            dim2->set_idx(2);
+            ASSERT_TRUE(table->Put(1000 + i, value, dims));
+        }
+    }
+    // rows put again are counted again, so the count of their pks is not used
+    for (int i = 0; i < 10; i++) {
+        std::vector<std::string> row = {"card0", "mcc0", std::to_string(1000 + i), std::to_string(2000 + i)};
+        std::string value;
+        codec.EncodeRow(row, &value);
+        Dimensions dims;
+        ::openmldb::api::Dimension* dim = dims.Add();
+        dim->set_key("card0");
+        dim->set_idx(0);
+        ::openmldb::api::Dimension* dim2 = dims.Add();
+        dim2->set_key("mcc0");
+        dim2->set_idx(2);
+        ASSERT_TRUE(table->Put(1000 + i, value, dims));
+    }
+    KeyMeta meta;
+    ASSERT_FALSE(table->GetKeyMeta(1, "card0", &meta));
+    ASSERT_FALSE(table->GetKeyMeta(2, "mcc0", &meta));
+    ASSERT_TRUE(table->GetKeyMeta(1, "card1", &meta));
+    ASSERT_EQ(10u, meta.count);
+    ASSERT_EQ(2000u, meta.min_ts);
+    ASSERT_EQ(2009u, meta.max_ts);
+    ASSERT_TRUE(table->GetKeyMeta(2, "mcc1", &meta));
+    ASSERT_EQ(10u, meta.count);
+
+    uint64_t count = 0;
+    ASSERT_EQ(0, table->GetCount(0, "card0", count));
+    ASSERT_EQ(10u, count);
+    ASSERT_EQ(0, table->GetCount(2, "mcc2", count));
+    ASSERT_EQ(10u, count);
+    ASSERT_EQ(0, table->GetCount(0, "card9", count));
+    ASSERT_EQ(0u, count);
+    // latest ttl is exceeded, rows may be dropped by gc so they are scanned
+    ASSERT_EQ(0, table->GetCount(1, "card1", count));
+    ASSERT_EQ(10u, count);
+    table->SchedGc();
+    // expired rows are dropped when compaction runs the ttl filter, and subtracted from key meta
+    table->CompactDB();
+    ASSERT_TRUE(table->GetKeyMeta(1, "card1", &meta));
+    ASSERT_EQ(5u, meta.count);
+    ASSERT_EQ(2005u, meta.min_ts);
+    ASSERT_EQ(0, table->GetCount(1, "card1", count));
+    ASSERT_EQ(5u, count);
+    ASSERT_EQ(0, table->GetCount(1, "card0", count));
+    ASSERT_EQ(5u, count);
+    ASSERT_EQ(0, table->GetCount(0, "card1", count));
+    ASSERT_EQ(10u, count);
+
+    DiskTableFilterStats stats;
+    table->GetFilterStats(&stats);
+    ASSERT_EQ(4u, stats.key_meta_hit);
+    ASSERT_EQ(3u, stats.key_meta_miss);
+
+    ASSERT_TRUE(table->Delete("card1", 0));
+    ASSERT_TRUE(table->GetKeyMeta(0, "card1", &meta));
+    ASSERT_EQ(0u, meta.count);
+    ASSERT_EQ(0, table->GetCount(1, "card1", count));
+    ASSERT_EQ(0u, count);
+    // index 2 is the inner index 1, its rows are in the column family of the inner index
+    ASSERT_TRUE(table->Delete("mcc0", 2));
+    Ticket ticket;
+    TableIterator* it = table->NewIterator(2, "mcc0", ticket);
+    it->SeekToFirst();
+    ASSERT_FALSE(it->Valid());
+    delete it;
+    delete table;
+
+    // key meta is kept after reload
+    table = new DiskTable(table_meta, table_path);
+    ASSERT_TRUE(table->Init());
+    ASSERT_EQ(0, table->GetCount(2, "mcc1", count));
+    ASSERT_EQ(10u, count);
+    ASSERT_EQ(0, table->GetCount(0, "card1", count));
+    ASSERT_EQ(0u, count);
+    table->GetFilterStats(&stats);
+    ASSERT_EQ(2u, stats.key_meta_hit);
+    delete table;
+    RemoveData(table_path);
+}
+
 TEST_F(DiskTableTest, CheckPoint) {
     std::map<std::string, uint32_t> mapping;
     mapping.insert(std::make_pair("idx0", 0));
@@ -1206,6 +1572,7 @@ int main(int argc, char** argv) {
     ::openmldb::base::SetLogLevel(INFO);
     FLAGS_hdd_root_path = "/tmp/" + std::to_string(::openmldb::storage::GenRand());
     FLAGS_ssd_root_path = "/tmp/" + std::to_string(::openmldb::storage::GenRand());
+    FLAGS_disk_row_cache_mb = 16;
     // FLAGS_hdd_root_path = "/tmp/1";
     // FLAGS_ssd_root_path = "/tmp/1";
     return RUN_ALL_TESTS();
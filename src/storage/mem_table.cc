@@ -19,9 +19,11 @@
 #include <algorithm>
 #include <utility>
 
+#include "base/count_down_latch.h"
 #include "base/glog_wapper.h"
 #include "base/hash.h"
 #include "base/slice.h"
+#include "common/thread_pool.h"
 #include "common/timer.h"
 #include "gflags/gflags.h"
 #include "storage/record.h"
@@ -32,12 +34,35 @@ DECLARE_uint32(key_entry_max_height);
 DECLARE_uint32(absolute_default_skiplist_height);
 DECLARE_uint32(latest_default_skiplist_height);
 DECLARE_uint32(max_traverse_cnt);
+DECLARE_uint32(gc_segment_thread_num);
+DECLARE_uint32(gc_expire_index_bucket_ms);
 
 namespace openmldb {
 namespace storage {
 
 static const uint32_t SEED = 0xe17a1465;
 
+// shared by the gc of all the tables, the gc thread of a table takes part in its own gc too
+static ::baidu::common::ThreadPool* GetGcSegmentPool() {
+    static ::baidu::common::ThreadPool pool(std::max<uint32_t>(FLAGS_gc_segment_thread_num, 1));
+    return &pool;
+}
+
+// only absolute ttl is gc by the ts of rows alone, and the buckets of the expire index are never
+// drained without a ttl, so the index is dropped once the ttl is set to 0
+static bool UseExpireIndex(const std::vector<std::shared_ptr<IndexDef>>& indexs) {
+    if (FLAGS_gc_expire_index_bucket_ms == 0) {
+        return false;
+    }
+    for (const auto& index_def : indexs) {
+        auto ttl = index_def->GetTTL();
+        if (ttl->ttl_type != ::openmldb::storage::TTLType::kAbsoluteTime || ttl->abs_ttl == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
 MemTable::MemTable(const std::string& name, uint32_t id, uint32_t pid, uint32_t seg_cnt,
                    const std::map<std::string, uint32_t>& mapping, uint64_t ttl, ::openmldb::type::TTLType ttl_type)
     : Table(::openmldb::common::StorageMode::kMemory, name, id, pid, ttl * 60 * 1000, true, 60 * 1000, mapping,
@@ -117,6 +142,7 @@ bool MemTable::Init() {
             }
         }
         segments_[i] = seg_arr;
+        SyncExpireIndex(i, inner_indexs->at(i)->GetIndex());
         key_entry_max_height_ = cur_key_entry_max_height;
     }
     PDLOG(INFO, "init table name %s, id %d, pid %d, seg_cnt %d", name_.c_str(), id_, pid_, seg_cnt_);
@@ -138,6 +164,7 @@ bool MemTable::Put(const std::string& pk, uint64_t time, const char* data, uint3
     segment->Put(spk, time, data, size);
     record_cnt_.fetch_add(1, std::memory_order_relaxed);
     record_byte_size_.fetch_add(GetRecordSize(size));
+    IncrWriteVersion();
     return true;
 }
 
@@ -162,8 +189,8 @@ bool MemTable::Put(uint64_t time, const std::string& value, const Dimensions& di
     uint32_t real_ref_cnt = 0;
     const int8_t* data = reinterpret_cast<const int8_t*>(value.data());
     uint8_t version = codec::RowView::GetSchemaVersion(data);
-    auto decoder = GetVersionDecoder(version);
-    if (decoder == nullptr) {
+    auto layout = GetVersionLayout(version);
+    if (layout == nullptr) {
         PDLOG(WARNING, "invalid schema version %u, tid %u pid %u", version, id_, pid_);
         return false;
     }
@@ -176,11 +203,12 @@ bool MemTable::Put(uint64_t time, const std::string& value, const Dimensions& di
         }
         for (const auto& index_def : inner_index->GetIndex()) {
             auto ts_col = index_def->GetTsColumn();
-            if (ts_col) {
+            // a ts column shared by several indexes is decoded once
+            if (ts_col && ts_map.find(ts_col->GetId()) == ts_map.end()) {
                 int64_t ts = 0;
                 if (ts_col->IsAutoGenTs()) {
                     ts = time;
-                } else if (decoder->GetInteger(data, ts_col->GetId(), ts_col->GetType(), &ts) != 0) {
+                } else if (layout->GetInteger(data, ts_col->GetId(), &ts) != 0) {
                     PDLOG(WARNING, "get ts failed. tid %u pid %u", id_, pid_);
                     return false;
                 }
@@ -216,6 +244,7 @@ bool MemTable::Put(uint64_t time, const std::string& value, const Dimensions& di
     }
     record_cnt_.fetch_add(1, std::memory_order_relaxed);
     record_byte_size_.fetch_add(GetRecordSize(value.length()));
+    IncrWriteVersion();
     return true;
 }
 
@@ -231,7 +260,11 @@ bool MemTable::Delete(const std::string& pk, uint32_t idx) {
     }
     uint32_t real_idx = index_def->GetInnerPos();
     Segment* segment = segments_[real_idx][seg_idx];
-    return segment->Delete(spk);
+    if (!segment->Delete(spk)) {
+        return false;
+    }
+    IncrWriteVersion();
+    return true;
 }
 
 uint64_t MemTable::Release() {
@@ -254,6 +287,24 @@ uint64_t MemTable::Release() {
     return total_cnt;
 }
 
+void MemTable::SyncExpireIndex(uint32_t inner_pos, const std::vector<std::shared_ptr<IndexDef>>& indexs) {
+    if (segments_[inner_pos] == NULL) {
+        return;
+    }
+    bool use_index = UseExpireIndex(indexs);
+    for (uint32_t j = 0; j < seg_cnt_; j++) {
+        Segment* segment = segments_[inner_pos][j];
+        if (segment == NULL || segment->HasExpireIndex() == use_index) {
+            continue;
+        }
+        if (use_index) {
+            segment->EnableExpireIndex(FLAGS_gc_expire_index_bucket_ms);
+        } else {
+            segment->DisableExpireIndex();
+        }
+    }
+}
+
 void MemTable::SchedGc() {
     uint64_t consumed = ::baidu::common::timer::get_micros();
     PDLOG(INFO, "start making gc for table %s, tid %u, pid %u", name_.c_str(), id_, pid_);
@@ -261,6 +312,8 @@ void MemTable::SchedGc() {
     uint64_t gc_record_cnt = 0;
     uint64_t gc_record_byte_size = 0;
     auto inner_indexs = table_index_.GetAllInnerIndex();
+    // the ttl of each inner index, empty if the inner index is not gc in this round
+    std::vector<std::map<uint32_t, TTLSt>> inner_ttl(inner_indexs->size());
     for (uint32_t i = 0; i < inner_indexs->size(); i++) {
         const std::vector<std::shared_ptr<IndexDef>>& real_index = inner_indexs->at(i)->GetIndex();
         std::map<uint32_t, TTLSt> ttl_st_map;
@@ -293,37 +346,123 @@ void MemTable::SchedGc() {
                 deleted_num++;
             }
         }
+        if (deleted_num < real_index.size()) {
+            // the ttl may have been updated since the last round
+            SyncExpireIndex(i, real_index);
+        }
         if (!enable_gc_.load(std::memory_order_relaxed) || !need_gc) {
             continue;
         }
         if (deleted_num == real_index.size() || ttl_st_map.empty()) {
             continue;
         }
+        inner_ttl[i] = std::move(ttl_st_map);
+    }
+    // segments with more expired rows are gc first and the ones without expired rows only free
+    // the entries deleted in the former rounds
+    struct SegmentGcTask {
+        uint32_t inner_pos;
+        uint32_t seg_idx;
+        uint64_t expired;
+    };
+    std::vector<SegmentGcTask> tasks;
+    for (uint32_t i = 0; i < inner_ttl.size(); i++) {
+        if (inner_ttl[i].empty()) {
+            continue;
+        }
         for (uint32_t j = 0; j < seg_cnt_; j++) {
+            tasks.push_back({i, j, segments_[i][j]->EstimateExpired(inner_ttl[i])});
+        }
+    }
+    std::stable_sort(tasks.begin(), tasks.end(),
+                     [](const SegmentGcTask& a, const SegmentGcTask& b) { return a.expired > b.expired; });
+    std::atomic<uint64_t> task_pos(0);
+    std::atomic<uint64_t> skip_cnt(0);
+    std::atomic<uint64_t> total_idx_cnt(gc_idx_cnt);
+    std::atomic<uint64_t> total_record_cnt(gc_record_cnt);
+    std::atomic<uint64_t> total_record_byte_size(gc_record_byte_size);
+    auto gc_segments = [&]() {
+        uint64_t idx_cnt = 0;
+        uint64_t record_cnt = 0;
+        uint64_t record_byte_size = 0;
+        for (uint64_t pos = task_pos.fetch_add(1); pos < tasks.size(); pos = task_pos.fetch_add(1)) {
+            const SegmentGcTask& task = tasks[pos];
+            const auto& ttl_st_map = inner_ttl[task.inner_pos];
             uint64_t seg_gc_time = ::baidu::common::timer::get_micros() / 1000;
-            Segment* segment = segments_[i][j];
+            Segment* segment = segments_[task.inner_pos][task.seg_idx];
             segment->IncrGcVersion();
-            segment->GcFreeList(gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+            segment->GcFreeList(idx_cnt, record_cnt, record_byte_size);
+            if (task.expired == 0) {
+                skip_cnt.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
             if (ttl_st_map.size() == 1) {
-                segment->ExecuteGc(ttl_st_map.begin()->second, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+                segment->ExecuteGc(ttl_st_map.begin()->second, idx_cnt, record_cnt, record_byte_size);
             } else {
-                segment->ExecuteGc(ttl_st_map, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+                segment->ExecuteGc(ttl_st_map, idx_cnt, record_cnt, record_byte_size);
             }
             seg_gc_time = ::baidu::common::timer::get_micros() / 1000 - seg_gc_time;
-            PDLOG(INFO, "gc segment[%u][%u] done consumed %lu for table %s tid %u pid %u", i, j, seg_gc_time,
-                  name_.c_str(), id_, pid_);
+            PDLOG(INFO, "gc segment[%u][%u] done consumed %lu for table %s tid %u pid %u", task.inner_pos,
+                  task.seg_idx, seg_gc_time, name_.c_str(), id_, pid_);
         }
-    }
+        total_idx_cnt.fetch_add(idx_cnt, std::memory_order_relaxed);
+        total_record_cnt.fetch_add(record_cnt, std::memory_order_relaxed);
+        total_record_byte_size.fetch_add(record_byte_size, std::memory_order_relaxed);
+    };
+    uint64_t thread_num = std::min<uint64_t>(std::max<uint32_t>(FLAGS_gc_segment_thread_num, 1), tasks.size());
+    ::openmldb::base::CountDownLatch latch(thread_num > 1 ? thread_num - 1 : 0);
+    for (uint64_t i = 1; i < thread_num; i++) {
+        GetGcSegmentPool()->AddTask([&]() {
+            gc_segments();
+            latch.CountDown();
+        });
+    }
+    gc_segments();
+    latch.Wait();
+    gc_idx_cnt = total_idx_cnt.load(std::memory_order_relaxed);
+    gc_record_cnt = total_record_cnt.load(std::memory_order_relaxed);
+    gc_record_byte_size = total_record_byte_size.load(std::memory_order_relaxed);
     consumed = ::baidu::common::timer::get_micros() - consumed;
     record_cnt_.fetch_sub(gc_record_cnt, std::memory_order_relaxed);
     record_byte_size_.fetch_sub(gc_record_byte_size, std::memory_order_relaxed);
     PDLOG(INFO,
-          "gc finished, gc_idx_cnt %lu, gc_record_cnt %lu consumed %lu ms for "
+          "gc finished, gc_idx_cnt %lu, gc_record_cnt %lu, skip %lu of %lu segments, consumed %lu ms for "
           "table %s tid %u pid %u",
-          gc_idx_cnt, gc_record_cnt, consumed / 1000, name_.c_str(), id_, pid_);
+          gc_idx_cnt, gc_record_cnt, skip_cnt.load(std::memory_order_relaxed), tasks.size(), consumed / 1000,
+          name_.c_str(), id_, pid_);
     UpdateTTL();
 }
 
+uint64_t MemTable::GcBefore(uint32_t idx, uint64_t time) {
+    std::shared_ptr<IndexDef> index_def = table_index_.GetIndex(idx);
+    if (!index_def || !index_def->IsReady() || time == 0) {
+        return 0;
+    }
+    uint64_t gc_idx_cnt = 0;
+    uint64_t gc_record_cnt = 0;
+    uint64_t gc_record_byte_size = 0;
+    uint32_t inner_pos = index_def->GetInnerPos();
+    auto ts_col = index_def->GetTsColumn();
+    for (uint32_t j = 0; j < seg_cnt_; j++) {
+        Segment* segment = segments_[inner_pos][j];
+        segment->IncrGcVersion();
+        segment->GcFreeList(gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+        // entries with ts <= abs_ttl are deleted
+        if (segment->GetTsCnt() > 1 && ts_col) {
+            std::map<uint32_t, TTLSt> ttl_st_map;
+            ttl_st_map.emplace(ts_col->GetId(), TTLSt(time - 1, 0, ::openmldb::storage::TTLType::kAbsoluteTime));
+            segment->GcAllType(ttl_st_map, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+        } else {
+            segment->Gc4TTL(time - 1, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+        }
+    }
+    record_cnt_.fetch_sub(gc_record_cnt, std::memory_order_relaxed);
+    record_byte_size_.fetch_sub(gc_record_byte_size, std::memory_order_relaxed);
+    PDLOG(INFO, "gc index %u before %lu finished, gc_idx_cnt %lu, gc_record_cnt %lu. tid %u pid %u", idx, time,
+          gc_idx_cnt, gc_record_cnt, id_, pid_);
+    return gc_record_cnt;
+}
+
 // tll as ms
 uint64_t MemTable::GetExpireTime(const TTLSt& ttl_st) {
     if (!enable_gc_.load(std::memory_order_relaxed) || ttl_st.abs_ttl == 0 ||
@@ -370,8 +509,8 @@ bool MemTable::IsExpire(const LogEntry& entry) {
     }
     const int8_t* data = reinterpret_cast<const int8_t*>(entry.value().data());
     uint8_t version = codec::RowView::GetSchemaVersion(data);
-    auto decoder = GetVersionDecoder(version);
-    if (decoder == nullptr) {
+    auto layout = GetVersionLayout(version);
+    if (layout == nullptr) {
         PDLOG(WARNING, "invalid schema version %u, tid %u pid %u", static_cast<uint32_t>(version), id_, pid_);
         return false;
     }
@@ -393,7 +532,7 @@ bool MemTable::IsExpire(const LogEntry& entry) {
             int64_t ts = entry.ts();
             auto ts_col = index_def->GetTsColumn();
             if (ts_col && !ts_col->IsAutoGenTs()) {
-                if (decoder->GetInteger(data, ts_col->GetId(), ts_col->GetType(), &ts) != 0) {
+                if (layout->GetInteger(data, ts_col->GetId(), &ts) != 0) {
                     continue;
                 }
             }
@@ -739,6 +878,7 @@ bool MemTable::GetBulkLoadInfo(::openmldb::api::BulkLoadInfoResponse* response)
 bool MemTable::BulkLoad(const std::vector<DataBlock*>& data_blocks,
                         const ::google::protobuf::RepeatedPtrField<::openmldb::api::BulkLoadIndex>& indexes) {
     // data_block[i] is the block which id == i
+    std::vector<std::pair<uint64_t, DataBlock*>> rows;
     for (int i = 0; i < indexes.size(); ++i) {
         const auto& inner_index = indexes.Get(i);
         auto real_idx = inner_index.inner_index_id();
@@ -752,6 +892,8 @@ bool MemTable::BulkLoad(const std::vector<DataBlock*>& data_blocks,
                 for (int key_entry_idx = 0; key_entry_idx < key_entries.key_entry_size(); ++key_entry_idx) {
                     const auto& key_entry = key_entries.key_entry(key_entry_idx);
                     auto key_entry_id = key_entry.key_entry_id();
+                    rows.clear();
+                    rows.reserve(key_entry.time_entry_size());
                     for (int time_idx = 0; time_idx < key_entry.time_entry_size(); ++time_idx) {
                         const auto& time_entry = key_entry.time_entry(time_idx);
                         auto* block =
@@ -761,18 +903,20 @@ bool MemTable::BulkLoad(const std::vector<DataBlock*>& data_blocks,
                             LOG(INFO) << "block info mismatch";
                             return false;
                         }
-
-                        VLOG(1) << "do segment(" << real_idx << "-" << seg_idx << ") put, key" << pk.ToString()
-                                << ", time " << time_entry.time() << ", key_entry_id " << key_entry_id << ", block id "
-                                << time_entry.block_id();
-                        block->dim_cnt_down++;
-                        segment->BulkLoadPut(key_entry_id, pk, time_entry.time(), block);
+                        rows.emplace_back(time_entry.time(), block);
+                    }
+                    VLOG(1) << "do segment(" << real_idx << "-" << seg_idx << ") put, key" << pk.ToString()
+                            << ", key_entry_id " << key_entry_id << ", rows " << rows.size();
+                    for (auto& row : rows) {
+                        row.second->dim_cnt_down++;
                     }
+                    // the time entries are sorted by the sender, the ones out of order are inserted by searching
+                    segment->BulkLoadPut(key_entry_id, pk, rows);
                 }
             }
         }
     }
-
+    IncrWriteVersion();
     return true;
 }
 
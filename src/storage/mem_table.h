@@ -183,6 +183,10 @@ class MemTable : public Table {
 
     void SchedGc() override;
 
+    // delete the entries of index whose ts is less than time, ttl of the index is not considered,
+    // return the number of rows released from memory
+    uint64_t GcBefore(uint32_t idx, uint64_t time);
+
     int GetCount(uint32_t index, const std::string& pk, uint64_t& count) override;  // NOLINT
 
     uint64_t GetRecordIdxCnt() override;
@@ -222,6 +226,9 @@ class MemTable : public Table {
 
     bool CheckLatest(uint32_t index_id, const std::string& key, uint64_t ts);
 
+    // enable or drop the expire index of the segments of an inner index as its ttl requires
+    void SyncExpireIndex(uint32_t inner_pos, const std::vector<std::shared_ptr<IndexDef>>& indexs);
+
  private:
     uint32_t seg_cnt_;
     std::vector<Segment**> segments_;
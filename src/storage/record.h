@@ -24,8 +24,9 @@ namespace storage {
 
 static const uint32_t DATA_BLOCK_BYTE_SIZE = sizeof(DataBlock);
 static const uint32_t KEY_ENTRY_BYTE_SIZE = sizeof(KeyEntry);
-static const uint32_t ENTRY_NODE_SIZE = sizeof(::openmldb::base::Node<::openmldb::base::Slice, void*>);
-static const uint32_t DATA_NODE_SIZE = sizeof(::openmldb::base::Node<uint64_t, void*>);
+// the bytes of the skiplist nodes without their towers, a tower takes 8 bytes per level
+static const uint32_t ENTRY_NODE_SIZE = ::openmldb::base::Node<::openmldb::base::Slice, void*>::ByteSize(0);
+static const uint32_t DATA_NODE_SIZE = ::openmldb::base::Node<uint64_t, void*>::ByteSize(0);
 static const uint32_t KEY_ENTRY_PTR_SIZE = sizeof(KeyEntry*);
 
 static inline uint32_t GetRecordSize(uint32_t value_size) { return value_size + DATA_BLOCK_BYTE_SIZE; }
@@ -18,6 +18,15 @@
 
 #include <gflags/gflags.h>
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <string>
+#include <string_view>
+#include <thread>  // NOLINT
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
 #include "base/glog_wapper.h"
 #include "base/strings.h"
 #include "common/timer.h"
@@ -26,11 +35,55 @@
 DECLARE_int32(gc_safe_offset);
 DECLARE_uint32(skiplist_max_height);
 DECLARE_uint32(gc_deleted_pk_version_delta);
+DECLARE_uint32(gc_slice_time_ms);
+DECLARE_uint32(gc_slice_pause_ms);
 
 namespace openmldb {
 namespace storage {
 
 static const SliceComparator scmp;
+
+// the tail of a list emptied by Split is the head node, so check IsEmpty first
+static ::openmldb::base::Node<uint64_t, DataBlock*>* GetOldest(KeyEntry* entry) {
+    return entry->entries.IsEmpty() ? NULL : entry->entries.GetLast();
+}
+
+static void AtomicMin(std::atomic<uint64_t>* value, uint64_t cur) {
+    uint64_t old = value->load(std::memory_order_relaxed);
+    while (cur < old && !value->compare_exchange_weak(old, cur, std::memory_order_relaxed)) {
+    }
+}
+
+static void AtomicMax(std::atomic<uint64_t>* value, uint64_t cur) {
+    uint64_t old = value->load(std::memory_order_relaxed);
+    while (cur > old && !value->compare_exchange_weak(old, cur, std::memory_order_relaxed)) {
+    }
+}
+
+// Splits a gc walk into slices of gc_slice_time_ms and sleeps gc_slice_pause_ms between two
+// slices, so a walk over a large segment gives the cpu back to the foreground requests.
+// The nodes removed by the walk are only freed in the later rounds, so the walk can pause anywhere.
+class GcSlicer {
+ public:
+    GcSlicer() : slice_start_(::baidu::common::timer::get_micros() / 1000), cnt_(0) {}
+
+    void Tick() {
+        if (FLAGS_gc_slice_time_ms == 0 || ++cnt_ % 16 != 0) {
+            return;
+        }
+        uint64_t now = ::baidu::common::timer::get_micros() / 1000;
+        if (now - slice_start_ < FLAGS_gc_slice_time_ms) {
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(FLAGS_gc_slice_pause_ms));
+        slice_start_ = ::baidu::common::timer::get_micros() / 1000;
+    }
+
+ private:
+    uint64_t slice_start_;
+    uint64_t cnt_;
+};
+
 Segment::Segment()
     : entries_(NULL),
       mu_(),
@@ -39,7 +92,13 @@ Segment::Segment()
       pk_cnt_(0),
       ts_cnt_(1),
       gc_version_(0),
-      ttl_offset_(FLAGS_gc_safe_offset * 60 * 1000) {
+      ttl_offset_(FLAGS_gc_safe_offset * 60 * 1000),
+      min_ts_(UINT64_MAX),
+      max_ts_(0),
+      put_cnt_(0),
+      gc_keep_cnt_(0),
+      expire_bucket_ms_(0),
+      expire_index_byte_size_(0) {
     entries_ = new KeyEntries((uint8_t)FLAGS_skiplist_max_height, 4, scmp);
     key_entry_max_height_ = (uint8_t)FLAGS_skiplist_max_height;
     entry_free_list_ = new KeyEntryNodeList(4, 4, tcmp);
@@ -54,7 +113,13 @@ Segment::Segment(uint8_t height)
       key_entry_max_height_(height),
       ts_cnt_(1),
       gc_version_(0),
-      ttl_offset_(FLAGS_gc_safe_offset * 60 * 1000) {
+      ttl_offset_(FLAGS_gc_safe_offset * 60 * 1000),
+      min_ts_(UINT64_MAX),
+      max_ts_(0),
+      put_cnt_(0),
+      gc_keep_cnt_(0),
+      expire_bucket_ms_(0),
+      expire_index_byte_size_(0) {
     entries_ = new KeyEntries((uint8_t)FLAGS_skiplist_max_height, 4, scmp);
     entry_free_list_ = new KeyEntryNodeList(4, 4, tcmp);
 }
@@ -68,7 +133,13 @@ Segment::Segment(uint8_t height, const std::vector<uint32_t>& ts_idx_vec)
       key_entry_max_height_(height),
       ts_cnt_(ts_idx_vec.size()),
       gc_version_(0),
-      ttl_offset_(FLAGS_gc_safe_offset * 60 * 1000) {
+      ttl_offset_(FLAGS_gc_safe_offset * 60 * 1000),
+      min_ts_(UINT64_MAX),
+      max_ts_(0),
+      put_cnt_(0),
+      gc_keep_cnt_(0),
+      expire_bucket_ms_(0),
+      expire_index_byte_size_(0) {
     entries_ = new KeyEntries((uint8_t)FLAGS_skiplist_max_height, 4, scmp);
     entry_free_list_ = new KeyEntryNodeList(4, 4, tcmp);
     for (uint32_t i = 0; i < ts_idx_vec.size(); i++) {
@@ -130,6 +201,8 @@ uint64_t Segment::Release() {
     delete f_it;
     entry_free_list_->Clear();
     idx_cnt_vec_.clear();
+    expire_buckets_.clear();
+    expire_index_byte_size_.store(0, std::memory_order_relaxed);
     return cnt;
 }
 
@@ -186,6 +259,11 @@ void Segment::PutUnlock(const Slice& key, uint64_t time, DataBlock* row) {
         pk_cnt_.fetch_add(1, std::memory_order_relaxed);
     }
     idx_cnt_.fetch_add(1, std::memory_order_relaxed);
+    UpdateTsRange(time);
+    put_cnt_.fetch_add(1, std::memory_order_relaxed);
+    if (expire_bucket_ms_.load(std::memory_order_relaxed) > 0) {
+        AddExpireHint(key, time, GetOldest((KeyEntry*)entry));  // NOLINT
+    }
     uint8_t height = ((KeyEntry*)entry)->entries.Insert(time, row);  // NOLINT
     ((KeyEntry*)entry)                                               // NOLINT
         ->count_.fetch_add(1, std::memory_order_relaxed);
@@ -193,35 +271,111 @@ void Segment::PutUnlock(const Slice& key, uint64_t time, DataBlock* row) {
     idx_byte_size_.fetch_add(byte_size, std::memory_order_relaxed);
 }
 
-void Segment::BulkLoadPut(unsigned int key_entry_id, const Slice& key, uint64_t time, DataBlock* row) {
+void Segment::EnableExpireIndex(uint64_t bucket_ms) {
+    if (ts_cnt_ > 1 || bucket_ms == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mu_);
+    if (expire_bucket_ms_.load(std::memory_order_relaxed) == bucket_ms) {
+        return;
+    }
+    expire_buckets_.clear();
+    idx_byte_size_.fetch_sub(expire_index_byte_size_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    expire_index_byte_size_.store(0, std::memory_order_relaxed);
+    expire_bucket_ms_.store(bucket_ms, std::memory_order_relaxed);
+    // puts are blocked by mu_, so every pk put before is indexed by its oldest row
+    KeyEntries::Iterator* it = entries_->NewIterator();
+    for (it->SeekToFirst(); it->Valid(); it->Next()) {
+        auto oldest = GetOldest(reinterpret_cast<KeyEntry*>(it->GetValue()));
+        if (oldest != NULL) {
+            AddExpireHint(it->GetKey(), oldest->GetKey(), NULL);
+        }
+    }
+    delete it;
+}
+
+void Segment::DisableExpireIndex() {
+    std::lock_guard<std::mutex> lock(mu_);
+    expire_bucket_ms_.store(0, std::memory_order_relaxed);
+    expire_buckets_.clear();
+    idx_byte_size_.fetch_sub(expire_index_byte_size_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    expire_index_byte_size_.store(0, std::memory_order_relaxed);
+}
+
+void Segment::AddExpireHint(const Slice& key, uint64_t ts, ::openmldb::base::Node<uint64_t, DataBlock*>* oldest) {
+    uint64_t bucket_ms = expire_bucket_ms_.load(std::memory_order_relaxed);
+    uint64_t bucket = ts / bucket_ms;
+    if (oldest != NULL && oldest->GetKey() / bucket_ms <= bucket) {
+        return;
+    }
+    std::string& hints = expire_buckets_[bucket];
+    uint32_t key_size = key.size();
+    hints.append(reinterpret_cast<const char*>(&key_size), sizeof(key_size));
+    hints.append(key.data(), key.size());
+    idx_byte_size_.fetch_add(sizeof(key_size) + key_size, std::memory_order_relaxed);
+    expire_index_byte_size_.fetch_add(sizeof(key_size) + key_size, std::memory_order_relaxed);
+}
+
+void Segment::BulkLoadPut(unsigned int key_entry_id, const Slice& key,
+                          const std::vector<std::pair<uint64_t, DataBlock*>>& rows) {
+    if (rows.empty()) {
+        return;
+    }
+    if (ts_cnt_ > 1 && key_entry_id >= ts_cnt_) {
+        PDLOG(WARNING, "invalid key entry id %u, ts cnt %u", key_entry_id, ts_cnt_);
+        return;
+    }
     void* key_entry_or_list = nullptr;
     uint32_t byte_size = 0;
-    std::lock_guard<std::mutex> lock(mu_);  // TODO(hw): need lock?
+    // regular puts may run at the same time
+    std::lock_guard<std::mutex> lock(mu_);
     int ret = entries_->Get(key, key_entry_or_list);
-    if (ts_cnt_ == 1) {
-        PutUnlock(key, time, row);
-    } else {
-        if (ret < 0 || key_entry_or_list == nullptr) {
-            char* pk = new char[key.size()];
-            memcpy(pk, key.data(), key.size());
-            Slice skey(pk, key.size());
+    bool is_new_key = ret < 0 || key_entry_or_list == nullptr;
+    if (is_new_key) {
+        if (ts_cnt_ == 1) {
+            key_entry_or_list = (void*)new KeyEntry(key_entry_max_height_);  // NOLINT
+        } else {
             auto** entry_arr_tmp = new KeyEntry*[ts_cnt_];
             for (uint32_t i = 0; i < ts_cnt_; i++) {
                 entry_arr_tmp[i] = new KeyEntry(key_entry_max_height_);
             }
-            auto entry_arr = (void*)entry_arr_tmp;  // NOLINT
-            uint8_t height = entries_->Insert(skey, entry_arr);
-            byte_size += GetRecordPkMultiIdxSize(height, key.size(), key_entry_max_height_, ts_cnt_);
-            pk_cnt_.fetch_add(1, std::memory_order_relaxed);
-        }
-        uint8_t height = ((KeyEntry**)key_entry_or_list)[key_entry_id]->entries.Insert(  // NOLINT
-            time, row);
-        ((KeyEntry**)key_entry_or_list)[key_entry_id]->count_.fetch_add(  // NOLINT
-            1, std::memory_order_relaxed);
-        byte_size += GetRecordTsIdxSize(height);
-        idx_byte_size_.fetch_add(byte_size, std::memory_order_relaxed);
-        idx_cnt_vec_[key_entry_id]->fetch_add(1, std::memory_order_relaxed);
+            key_entry_or_list = (void*)entry_arr_tmp;  // NOLINT
+        }
     }
+    KeyEntry* key_entry = ts_cnt_ == 1 ? reinterpret_cast<KeyEntry*>(key_entry_or_list)
+                                       : reinterpret_cast<KeyEntry**>(key_entry_or_list)[key_entry_id];
+    auto* oldest = GetOldest(key_entry);
+    TimeEntries::Appender appender(&key_entry->entries);
+    for (const auto& row : rows) {
+        DataBlock* block = row.second;
+        byte_size += GetRecordTsIdxSize(appender.Append(row.first, block));
+        UpdateTsRange(row.first);
+    }
+    put_cnt_.fetch_add(rows.size(), std::memory_order_relaxed);
+    key_entry->count_.fetch_add(rows.size(), std::memory_order_relaxed);
+    if (expire_bucket_ms_.load(std::memory_order_relaxed) > 0) {
+        uint64_t min_ts = UINT64_MAX;
+        for (const auto& row : rows) {
+            min_ts = std::min(min_ts, row.first);
+        }
+        AddExpireHint(key, min_ts, oldest);
+    }
+    if (is_new_key) {
+        // the entry is visible to readers after all the rows are linked
+        char* pk = new char[key.size()];
+        memcpy(pk, key.data(), key.size());
+        Slice skey(pk, key.size());
+        uint8_t height = entries_->Insert(skey, key_entry_or_list);
+        byte_size += ts_cnt_ == 1 ? GetRecordPkIdxSize(height, key.size(), key_entry_max_height_)
+                                  : GetRecordPkMultiIdxSize(height, key.size(), key_entry_max_height_, ts_cnt_);
+        pk_cnt_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (ts_cnt_ == 1) {
+        idx_cnt_.fetch_add(rows.size(), std::memory_order_relaxed);
+    } else {
+        idx_cnt_vec_[key_entry_id]->fetch_add(rows.size(), std::memory_order_relaxed);
+    }
+    idx_byte_size_.fetch_add(byte_size, std::memory_order_relaxed);
 }
 
 void Segment::Put(const Slice& key, const std::map<int32_t, uint64_t>& ts_map, DataBlock* row) {
@@ -267,7 +421,14 @@ void Segment::Put(const Slice& key, const std::map<int32_t, uint64_t>& ts_map, D
         byte_size += GetRecordTsIdxSize(height);
         idx_byte_size_.fetch_add(byte_size, std::memory_order_relaxed);
         idx_cnt_vec_[pos->second]->fetch_add(1, std::memory_order_relaxed);
+        UpdateTsRange(kv.second);
     }
+    put_cnt_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Segment::UpdateTsRange(uint64_t ts) {
+    AtomicMin(&min_ts_, ts);
+    AtomicMax(&max_ts_, ts);
 }
 
 bool Segment::Get(const Slice& key, const uint64_t time, DataBlock** block) {
@@ -413,6 +574,10 @@ void Segment::GcFreeList(uint64_t& gc_idx_cnt, uint64_t& gc_record_cnt, uint64_t
 void Segment::ExecuteGc(const TTLSt& ttl_st, uint64_t& gc_idx_cnt, uint64_t& gc_record_cnt,
                         uint64_t& gc_record_byte_size) {
     uint64_t cur_time = ::baidu::common::timer::get_micros() / 1000;
+    put_cnt_.store(0, std::memory_order_relaxed);
+    // the rows beyond the keep cnt are all freed only by a walk with a keep cnt
+    bool with_keep_cnt = ttl_st.ttl_type != ::openmldb::storage::TTLType::kAbsoluteTime && ttl_st.lat_ttl > 0;
+    gc_keep_cnt_.store(with_keep_cnt ? ttl_st.lat_ttl : UINT64_MAX, std::memory_order_relaxed);
     switch (ttl_st.ttl_type) {
         case ::openmldb::storage::TTLType::kAbsoluteTime: {
             if (ttl_st.abs_ttl == 0) {
@@ -471,9 +636,68 @@ void Segment::ExecuteGc(const std::map<uint32_t, TTLSt>& ttl_st_map, uint64_t& g
     if (!need_gc) {
         return;
     }
+    put_cnt_.store(0, std::memory_order_relaxed);
     GcAllType(ttl_st_map, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
 }
 
+uint64_t Segment::EstimateExpiredByTime(uint64_t expire_time, uint64_t idx_cnt) {
+    uint64_t min_ts = min_ts_.load(std::memory_order_relaxed);
+    uint64_t max_ts = max_ts_.load(std::memory_order_relaxed);
+    if (idx_cnt == 0 || min_ts > expire_time) {
+        return 0;
+    }
+    if (max_ts <= expire_time || max_ts <= min_ts) {
+        return idx_cnt;
+    }
+    // assume the rows spread evenly over the range of ts
+    double ratio = static_cast<double>(expire_time - min_ts) / (max_ts - min_ts);
+    return std::max<uint64_t>(1, static_cast<uint64_t>(idx_cnt * ratio));
+}
+
+uint64_t Segment::EstimateExpired(const TTLSt& ttl_st) {
+    uint64_t idx_cnt = GetIdxCnt();
+    uint64_t put_cnt = put_cnt_.load(std::memory_order_relaxed);
+    uint64_t cur_time = ::baidu::common::timer::get_micros() / 1000;
+    uint64_t expire_time = cur_time - ttl_offset_ - ttl_st.abs_ttl;
+    // a smaller keep cnt than the last walk makes all keys candidates again
+    uint64_t head_cnt = ttl_st.lat_ttl < gc_keep_cnt_.load(std::memory_order_relaxed) ? idx_cnt : put_cnt;
+    switch (ttl_st.ttl_type) {
+        case ::openmldb::storage::TTLType::kAbsoluteTime:
+            return ttl_st.abs_ttl == 0 ? 0 : EstimateExpiredByTime(expire_time, idx_cnt);
+        case ::openmldb::storage::TTLType::kLatestTime:
+            return ttl_st.lat_ttl == 0 ? 0 : head_cnt;
+        case ::openmldb::storage::TTLType::kAbsAndLat:
+            // rows beyond the keep cnt are freed once they expire, no matter if there are new rows
+            if (ttl_st.abs_ttl == 0 || ttl_st.lat_ttl == 0) {
+                return 0;
+            }
+            return EstimateExpiredByTime(expire_time, idx_cnt);
+        case ::openmldb::storage::TTLType::kAbsOrLat: {
+            uint64_t cnt = ttl_st.abs_ttl == 0 ? 0 : EstimateExpiredByTime(expire_time, idx_cnt);
+            return ttl_st.lat_ttl == 0 ? cnt : cnt + head_cnt;
+        }
+        default:
+            return 0;
+    }
+}
+
+uint64_t Segment::EstimateExpired(const std::map<uint32_t, TTLSt>& ttl_st_map) {
+    if (ttl_st_map.empty()) {
+        return 0;
+    }
+    if (ts_cnt_ <= 1) {
+        return EstimateExpired(ttl_st_map.begin()->second);
+    }
+    // GcAllType keeps neither the range of ts nor the keep cnt of each ts column, so segments
+    // with multiple ts columns are never skipped and only ordered by the rows put since the last gc
+    for (const auto& kv : ttl_st_map) {
+        if (kv.second.NeedGc()) {
+            return put_cnt_.load(std::memory_order_relaxed) + 1;
+        }
+    }
+    return 0;
+}
+
 void Segment::Gc4Head(uint64_t keep_cnt, uint64_t& gc_idx_cnt, uint64_t& gc_record_cnt, uint64_t& gc_record_byte_size) {
     if (keep_cnt == 0) {
         PDLOG(WARNING, "[Gc4Head] segment gc4head is disabled");
@@ -481,9 +705,13 @@ void Segment::Gc4Head(uint64_t keep_cnt, uint64_t& gc_idx_cnt, uint64_t& gc_reco
     }
     uint64_t consumed = ::baidu::common::timer::get_micros();
     uint64_t old = gc_idx_cnt;
+    uint64_t min_ts = UINT64_MAX;
+    min_ts_.store(UINT64_MAX, std::memory_order_relaxed);
+    GcSlicer slicer;
     KeyEntries::Iterator* it = entries_->NewIterator();
     it->SeekToFirst();
     while (it->Valid()) {
+        slicer.Tick();
         KeyEntry* entry = (KeyEntry*)it->GetValue();  // NOLINT
         ::openmldb::base::Node<uint64_t, DataBlock*>* node = NULL;
         {
@@ -496,8 +724,13 @@ void Segment::Gc4Head(uint64_t keep_cnt, uint64_t& gc_idx_cnt, uint64_t& gc_reco
         FreeList(node, entry_gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
         entry->count_.fetch_sub(entry_gc_idx_cnt, std::memory_order_relaxed);
         gc_idx_cnt += entry_gc_idx_cnt;
+        node = GetOldest(entry);
+        if (node != NULL) {
+            min_ts = std::min(min_ts, node->GetKey());
+        }
         it->Next();
     }
+    AtomicMin(&min_ts_, min_ts);
     DEBUGLOG("[Gc4Head] segment gc keep cnt %lu consumed %lu, count %lu", keep_cnt,
              (::baidu::common::timer::get_micros() - consumed) / 1000, gc_idx_cnt - old);
     idx_cnt_.fetch_sub(gc_idx_cnt - old, std::memory_order_relaxed);
@@ -508,9 +741,11 @@ void Segment::GcAllType(const std::map<uint32_t, TTLSt>& ttl_st_map, uint64_t& g
                         uint64_t& gc_record_byte_size) {
     uint64_t old = gc_idx_cnt;
     uint64_t consumed = ::baidu::common::timer::get_micros();
+    GcSlicer slicer;
     KeyEntries::Iterator* it = entries_->NewIterator();
     it->SeekToFirst();
     while (it->Valid()) {
+        slicer.Tick();
         KeyEntry** entry_arr = (KeyEntry**)it->GetValue();  // NOLINT
         Slice key = it->GetKey();
         it->Next();
@@ -631,11 +866,19 @@ void Segment::SplitList(KeyEntry* entry, uint64_t ts, ::openmldb::base::Node<uin
 // fast gc with no global pause
 void Segment::Gc4TTL(const uint64_t time, uint64_t& gc_idx_cnt, uint64_t& gc_record_cnt,
                      uint64_t& gc_record_byte_size) {
+    if (expire_bucket_ms_.load(std::memory_order_relaxed) > 0) {
+        Gc4TTLByIndex(time, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+        return;
+    }
     uint64_t consumed = ::baidu::common::timer::get_micros();
     uint64_t old = gc_idx_cnt;
+    uint64_t min_ts = UINT64_MAX;
+    min_ts_.store(UINT64_MAX, std::memory_order_relaxed);
+    GcSlicer slicer;
     KeyEntries::Iterator* it = entries_->NewIterator();
     it->SeekToFirst();
     while (it->Valid()) {
+        slicer.Tick();
         KeyEntry* entry = (KeyEntry*)it->GetValue();  // NOLINT
         Slice key = it->GetKey();
         it->Next();
@@ -647,6 +890,7 @@ void Segment::Gc4TTL(const uint64_t time, uint64_t& gc_idx_cnt, uint64_t& gc_rec
                 "[Gc4TTL] segment gc with key %lu need not ttl, last node "
                 "key %lu",
                 time, node->GetKey());
+            min_ts = std::min(min_ts, node->GetKey());
             continue;
         }
         node = NULL;
@@ -666,13 +910,97 @@ void Segment::Gc4TTL(const uint64_t time, uint64_t& gc_idx_cnt, uint64_t& gc_rec
         FreeList(node, entry_gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
         entry->count_.fetch_sub(entry_gc_idx_cnt, std::memory_order_relaxed);
         gc_idx_cnt += entry_gc_idx_cnt;
+        // the rows newer than time are left, the oldest of them is the min ts of the entry
+        node = GetOldest(entry);
+        if (node != NULL) {
+            min_ts = std::min(min_ts, node->GetKey());
+        }
     }
+    AtomicMin(&min_ts_, min_ts);
     DEBUGLOG("[Gc4TTL] segment gc with key %lu ,consumed %lu, count %lu", time,
              (::baidu::common::timer::get_micros() - consumed) / 1000, gc_idx_cnt - old);
     idx_cnt_.fetch_sub(gc_idx_cnt - old, std::memory_order_relaxed);
     delete it;
 }
 
+// only visit the pks in the buckets of the expire index up to the bucket of time
+void Segment::Gc4TTLByIndex(const uint64_t time, uint64_t& gc_idx_cnt, uint64_t& gc_record_cnt,
+                            uint64_t& gc_record_byte_size) {
+    uint64_t consumed = ::baidu::common::timer::get_micros();
+    uint64_t old = gc_idx_cnt;
+    std::vector<std::pair<uint64_t, std::string>> buckets;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        uint64_t bucket_ms = expire_bucket_ms_.load(std::memory_order_relaxed);
+        if (bucket_ms == 0) {
+            // disabled since Gc4TTL checked it, the next round walks all the pks
+            return;
+        }
+        auto end = expire_buckets_.upper_bound(time / bucket_ms);
+        for (auto iter = expire_buckets_.begin(); iter != end; ++iter) {
+            buckets.emplace_back(iter->first, std::move(iter->second));
+        }
+        expire_buckets_.erase(expire_buckets_.begin(), end);
+    }
+    // a pk may be in more than one bucket
+    std::unordered_set<std::string_view> visited;
+    GcSlicer slicer;
+    for (const auto& bucket : buckets) {
+        const std::string& hints = bucket.second;
+        idx_byte_size_.fetch_sub(hints.size(), std::memory_order_relaxed);
+        expire_index_byte_size_.fetch_sub(hints.size(), std::memory_order_relaxed);
+        size_t pos = 0;
+        while (pos + sizeof(uint32_t) <= hints.size()) {
+            slicer.Tick();
+            uint32_t key_size = 0;
+            memcpy(&key_size, hints.data() + pos, sizeof(key_size));
+            Slice key(hints.data() + pos + sizeof(key_size), key_size);
+            pos += sizeof(key_size) + key_size;
+            if (!visited.emplace(key.data(), key.size()).second) {
+                continue;
+            }
+            KeyEntry* entry = NULL;
+            ::openmldb::base::Node<uint64_t, DataBlock*>* node = NULL;
+            ::openmldb::base::Node<Slice, void*>* entry_node = NULL;
+            {
+                std::lock_guard<std::mutex> lock(mu_);
+                void* value = NULL;
+                if (entries_->Get(key, value) < 0 || value == NULL) {
+                    continue;
+                }
+                entry = reinterpret_cast<KeyEntry*>(value);
+                SplitList(entry, time, &node);
+                auto last = GetOldest(entry);
+                if (last != NULL) {
+                    // the pks with rows left go back into the bucket of their oldest row
+                    AddExpireHint(key, last->GetKey(), NULL);
+                } else {
+                    entry_node = entries_->Remove(key);
+                }
+            }
+            if (entry_node != NULL) {
+                std::lock_guard<std::mutex> lock(gc_mu_);
+                entry_free_list_->Insert(gc_version_.load(std::memory_order_relaxed), entry_node);
+            }
+            uint64_t entry_gc_idx_cnt = 0;
+            FreeList(node, entry_gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+            entry->count_.fetch_sub(entry_gc_idx_cnt, std::memory_order_relaxed);
+            gc_idx_cnt += entry_gc_idx_cnt;
+        }
+    }
+    {
+        // the oldest bucket is a lower bound of the ts left in the segment
+        std::lock_guard<std::mutex> lock(mu_);
+        uint64_t min_ts = expire_buckets_.empty()
+                              ? UINT64_MAX
+                              : expire_buckets_.begin()->first * expire_bucket_ms_.load(std::memory_order_relaxed);
+        min_ts_.store(min_ts, std::memory_order_relaxed);
+    }
+    DEBUGLOG("[Gc4TTLByIndex] segment gc with key %lu, visit %lu pks in %lu buckets, consumed %lu, count %lu", time,
+             visited.size(), buckets.size(), (::baidu::common::timer::get_micros() - consumed) / 1000, gc_idx_cnt - old);
+    idx_cnt_.fetch_sub(gc_idx_cnt - old, std::memory_order_relaxed);
+}
+
 void Segment::Gc4TTLAndHead(const uint64_t time, const uint64_t keep_cnt, uint64_t& gc_idx_cnt, uint64_t& gc_record_cnt,
                             uint64_t& gc_record_byte_size) {
     if (time == 0 || keep_cnt == 0) {
@@ -681,9 +1009,13 @@ void Segment::Gc4TTLAndHead(const uint64_t time, const uint64_t keep_cnt, uint64
     }
     uint64_t consumed = ::baidu::common::timer::get_micros();
     uint64_t old = gc_idx_cnt;
+    uint64_t min_ts = UINT64_MAX;
+    min_ts_.store(UINT64_MAX, std::memory_order_relaxed);
+    GcSlicer slicer;
     KeyEntries::Iterator* it = entries_->NewIterator();
     it->SeekToFirst();
     while (it->Valid()) {
+        slicer.Tick();
         KeyEntry* entry = (KeyEntry*)it->GetValue();  // NOLINT
         ::openmldb::base::Node<uint64_t, DataBlock*>* node = entry->entries.GetLast();
         it->Next();
@@ -694,6 +1026,7 @@ void Segment::Gc4TTLAndHead(const uint64_t time, const uint64_t keep_cnt, uint64
                 "[Gc4TTLAndHead] segment gc with key %lu need not ttl, last "
                 "node key %lu",
                 time, node->GetKey());
+            min_ts = std::min(min_ts, node->GetKey());
             continue;
         }
         node = NULL;
@@ -707,7 +1040,12 @@ void Segment::Gc4TTLAndHead(const uint64_t time, const uint64_t keep_cnt, uint64
         FreeList(node, entry_gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
         entry->count_.fetch_sub(entry_gc_idx_cnt, std::memory_order_relaxed);
         gc_idx_cnt += entry_gc_idx_cnt;
+        node = GetOldest(entry);
+        if (node != NULL) {
+            min_ts = std::min(min_ts, node->GetKey());
+        }
     }
+    AtomicMin(&min_ts_, min_ts);
     DEBUGLOG(
         "[Gc4TTLAndHead] segment gc time %lu and keep cnt %lu consumed %lu, "
         "count %lu",
@@ -730,9 +1068,13 @@ void Segment::Gc4TTLOrHead(const uint64_t time, const uint64_t keep_cnt, uint64_
     }
     uint64_t consumed = ::baidu::common::timer::get_micros();
     uint64_t old = gc_idx_cnt;
+    uint64_t min_ts = UINT64_MAX;
+    min_ts_.store(UINT64_MAX, std::memory_order_relaxed);
+    GcSlicer slicer;
     KeyEntries::Iterator* it = entries_->NewIterator();
     it->SeekToFirst();
     while (it->Valid()) {
+        slicer.Tick();
         KeyEntry* entry = (KeyEntry*)it->GetValue();  // NOLINT
         Slice key = it->GetKey();
         it->Next();
@@ -759,7 +1101,12 @@ void Segment::Gc4TTLOrHead(const uint64_t time, const uint64_t keep_cnt, uint64_
         FreeList(node, entry_gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
         entry->count_.fetch_sub(entry_gc_idx_cnt, std::memory_order_relaxed);
         gc_idx_cnt += entry_gc_idx_cnt;
+        node = GetOldest(entry);
+        if (node != NULL) {
+            min_ts = std::min(min_ts, node->GetKey());
+        }
     }
+    AtomicMin(&min_ts_, min_ts);
     DEBUGLOG(
         "[Gc4TTLAndHead] segment gc time %lu and keep cnt %lu consumed %lu, "
         "count %lu",
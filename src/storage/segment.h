@@ -21,6 +21,8 @@
 #include <map>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "base/skiplist.h"
@@ -159,7 +161,10 @@ class Segment {
 
     void PutUnlock(const Slice& key, uint64_t time, DataBlock* row);
 
-    void BulkLoadPut(unsigned int key_entry_id, const Slice& key, uint64_t time, DataBlock* row);
+    // put the rows of a key entry under one lock. Rows sorted by time in descending order are
+    // appended in O(n), and the entry of a new key is built before it's linked into the segment
+    void BulkLoadPut(unsigned int key_entry_id, const Slice& key,
+                     const std::vector<std::pair<uint64_t, DataBlock*>>& rows);
 
     void Put(const Slice& key, const std::map<int32_t, uint64_t>& ts_map, DataBlock* row);
 
@@ -245,7 +250,28 @@ class Segment {
                          uint64_t& gc_record_cnt,         // NOLINT
                          uint64_t& gc_record_byte_size);  // NOLINT
 
+    // a rough count of the rows the next ExecuteGc with the ttl will free, it's used to order
+    // the segments of a gc round and 0 means the walk over the segment can be skipped
+    uint64_t EstimateExpired(const TTLSt& ttl_st);
+    uint64_t EstimateExpired(const std::map<uint32_t, TTLSt>& ttl_st_map);
+
+    // Index the pks by the time bucket of their oldest row, so Gc4TTL only visits the pks with
+    // expired rows instead of all of them. The pks already put are indexed when it's enabled.
+    // It only works on the segments with a single ts column
+    void EnableExpireIndex(uint64_t bucket_ms);
+    // drop the expire index, e.g. the absolute ttl is set to 0 and the buckets would never be drained
+    void DisableExpireIndex();
+    bool HasExpireIndex() const { return expire_bucket_ms_.load(std::memory_order_relaxed) > 0; }
+    uint64_t GetExpireIndexByteSize() { return expire_index_byte_size_.load(std::memory_order_relaxed); }
+
  private:
+    // put the pk into the bucket of ts if ts is in an older bucket than the oldest row of the pk
+    void AddExpireHint(const Slice& key, uint64_t ts, ::openmldb::base::Node<uint64_t, DataBlock*>* oldest);
+    void Gc4TTLByIndex(const uint64_t time, uint64_t& gc_idx_cnt,  // NOLINT
+                       uint64_t& gc_record_cnt,                    // NOLINT
+                       uint64_t& gc_record_byte_size);             // NOLINT
+    uint64_t EstimateExpiredByTime(uint64_t expire_time, uint64_t idx_cnt);
+    void UpdateTsRange(uint64_t ts);
     void FreeList(::openmldb::base::Node<uint64_t, DataBlock*>* node, uint64_t& gc_idx_cnt,  // NOLINT
                   uint64_t& gc_record_cnt,         // NOLINT
                   uint64_t& gc_record_byte_size);  // NOLINT
@@ -273,6 +299,20 @@ class Segment {
     std::map<uint32_t, uint32_t> ts_idx_map_;
     std::vector<std::shared_ptr<std::atomic<uint64_t>>> idx_cnt_vec_;
     uint64_t ttl_offset_;
+    // the range of ts put into the segment. min_ts_ is recomputed by the walks over single ts
+    // segments, the other walks leave it as is so the estimate only errs on the side of gc
+    std::atomic<uint64_t> min_ts_;
+    std::atomic<uint64_t> max_ts_;
+    // rows put since the last ExecuteGc, and the keep cnt of it or UINT64_MAX if it has no keep cnt
+    std::atomic<uint64_t> put_cnt_;
+    std::atomic<uint64_t> gc_keep_cnt_;
+    // 0 means the expire index is disabled, only changed with mu_ held
+    std::atomic<uint64_t> expire_bucket_ms_;
+    // bucket id -> the pks with the oldest row in the bucket, each pk is encoded as a 4 bytes size
+    // and the key. A pk is left in the newer bucket after it's moved to an older one, such stale
+    // hints are visited at most once in a gc round. Guarded by mu_
+    std::map<uint64_t, std::string> expire_buckets_;
+    std::atomic<uint64_t> expire_index_byte_size_;
 };
 
 }  // namespace storage
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/timer.h"
+#include "gtest/gtest.h"
+#include "storage/segment.h"
+
+namespace openmldb {
+namespace storage {
+
+static const uint32_t KEY_NUM = 1000;
+static const uint32_t ROW_NUM = 1000;
+
+class SegmentBenchmarkTest : public ::testing::Test {
+ public:
+    SegmentBenchmarkTest() {}
+    ~SegmentBenchmarkTest() {}
+};
+
+// Load 1M rows of 1000 keys into a segment, one by one like the put path and as sorted runs
+// like the bulk load path, and report the throughput of both
+TEST_F(SegmentBenchmarkTest, BulkLoadVsPut) {
+    std::vector<std::string> keys;
+    for (uint32_t i = 0; i < KEY_NUM; i++) {
+        keys.push_back("key" + std::to_string(i));
+    }
+    std::string value(128, 'a');
+    uint64_t start_ts = 1700000000000;
+
+    Segment put_segment;
+    uint64_t consumed = ::baidu::common::timer::get_micros();
+    // rows come in the order of time like the online data
+    for (uint32_t n = 0; n < ROW_NUM; n++) {
+        for (const auto& key : keys) {
+            put_segment.Put(key, start_ts + n, new DataBlock(1, value.c_str(), value.size()));
+        }
+    }
+    consumed = ::baidu::common::timer::get_micros() - consumed;
+
+    Segment bulk_segment;
+    std::vector<std::pair<uint64_t, DataBlock*>> rows;
+    uint64_t bconsumed = ::baidu::common::timer::get_micros();
+    for (const auto& key : keys) {
+        rows.clear();
+        for (uint32_t n = ROW_NUM; n > 0; n--) {
+            rows.emplace_back(start_ts + n - 1, new DataBlock(1, value.c_str(), value.size()));
+        }
+        bulk_segment.BulkLoadPut(0, key, rows);
+    }
+    bconsumed = ::baidu::common::timer::get_micros() - bconsumed;
+
+    ASSERT_EQ(put_segment.GetIdxCnt(), bulk_segment.GetIdxCnt());
+    ASSERT_EQ(put_segment.GetPkCnt(), bulk_segment.GetPkCnt());
+    uint64_t total = KEY_NUM * ROW_NUM;
+    std::cout << "put " << total << " rows: " << consumed / 1000 << "ms, " << total * 1000000 / (consumed + 1)
+              << " rows/s" << std::endl;
+    std::cout << "bulk load " << total << " rows: " << bconsumed / 1000 << "ms, "
+              << total * 1000000 / (bconsumed + 1) << " rows/s" << std::endl;
+    put_segment.Release();
+    bulk_segment.Release();
+}
+
+// Gc a segment of 200k keys where only 1% of the keys have expired rows, walking over all the keys
+// and visiting the keys in the expire index only, and report the memory taken by the index
+TEST_F(SegmentBenchmarkTest, ExpireIndexGc) {
+    const uint32_t key_num = 200000;
+    // the start of a minute, so no key but the ones with expired rows is in the buckets to gc
+    uint64_t start_ts = 1700000040000;
+    std::string value(128, 'a');
+    Segment full_segment;
+    Segment index_segment;
+    index_segment.EnableExpireIndex(60 * 1000);
+    for (uint32_t i = 0; i < key_num; i++) {
+        std::string key = "key" + std::to_string(i);
+        // one hour of rows and the keys with expired rows have one more row of the day before
+        for (uint32_t n = 0; n < 5; n++) {
+            uint64_t ts = start_ts + n * 12 * 60 * 1000;
+            full_segment.Put(key, ts, new DataBlock(1, value.c_str(), value.size()));
+            index_segment.Put(key, ts, new DataBlock(1, value.c_str(), value.size()));
+        }
+        if (i % 100 == 0) {
+            uint64_t ts = start_ts - 24 * 60 * 60 * 1000;
+            full_segment.Put(key, ts, new DataBlock(1, value.c_str(), value.size()));
+            index_segment.Put(key, ts, new DataBlock(1, value.c_str(), value.size()));
+        }
+    }
+    uint64_t gc_idx_cnt = 0;
+    uint64_t gc_record_cnt = 0;
+    uint64_t gc_record_byte_size = 0;
+    uint64_t consumed = ::baidu::common::timer::get_micros();
+    full_segment.Gc4TTL(start_ts - 1, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    consumed = ::baidu::common::timer::get_micros() - consumed;
+    uint64_t index_gc_idx_cnt = 0;
+    uint64_t index_consumed = ::baidu::common::timer::get_micros();
+    index_segment.Gc4TTL(start_ts - 1, index_gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    index_consumed = ::baidu::common::timer::get_micros() - index_consumed;
+    ASSERT_EQ(gc_idx_cnt, index_gc_idx_cnt);
+    ASSERT_EQ(key_num / 100, gc_idx_cnt);
+    std::cout << "gc by walk: " << consumed / 1000 << "ms, gc by expire index: " << index_consumed / 1000 << "ms"
+              << std::endl;
+    std::cout << "expire index " << index_segment.GetExpireIndexByteSize() << " bytes, "
+              << index_segment.GetExpireIndexByteSize() * 100 / index_segment.GetIdxByteSize()
+              << "% of the record index" << std::endl;
+    full_segment.Release();
+    index_segment.Release();
+}
+
+}  // namespace storage
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
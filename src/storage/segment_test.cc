@@ -17,15 +17,24 @@
 #include "storage/segment.h"
 
 #include <iostream>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "base/glog_wapper.h"  // NOLINT
 #include "base/slice.h"
+#include "common/timer.h"
+#include "gflags/gflags.h"
 #include "gtest/gtest.h"
 #include "storage/record.h"
 
 using ::openmldb::base::Slice;
 
+DECLARE_int32(gc_safe_offset);
+DECLARE_uint32(gc_slice_time_ms);
+DECLARE_uint32(gc_slice_pause_ms);
+
 namespace openmldb {
 namespace storage {
 
@@ -407,6 +416,200 @@ TEST_F(SegmentTest, PutAndGetTS) {
     ASSERT_EQ(e, t);
 }
 
+TEST_F(SegmentTest, BulkLoadPut) {
+    Segment segment;
+    std::vector<std::pair<uint64_t, DataBlock*>> rows;
+    for (uint64_t ts = 1100; ts > 1000; ts--) {
+        rows.emplace_back(ts, new DataBlock(1, "test1", 5));
+    }
+    segment.BulkLoadPut(0, "pk1", rows);
+    // the next run of the same key with a row out of order
+    auto new_rows = [&rows]() {
+        rows.clear();
+        rows.emplace_back(1000, new DataBlock(1, "test1", 5));
+        rows.emplace_back(1200, new DataBlock(1, "test1", 5));
+        rows.emplace_back(999, new DataBlock(1, "test1", 5));
+    };
+    new_rows();
+    segment.BulkLoadPut(0, "pk1", rows);
+    segment.Put("pk2", 1000, "test2", 5);
+    new_rows();
+    segment.BulkLoadPut(0, "pk2", rows);
+    ASSERT_EQ(2, (int64_t)segment.GetPkCnt());
+    ASSERT_EQ(107, (int64_t)segment.GetIdxCnt());
+    uint64_t count = 0;
+    ASSERT_EQ(0, segment.GetCount("pk1", count));
+    ASSERT_EQ(103, (int64_t)count);
+    Ticket ticket;
+    std::unique_ptr<MemTableIterator> it(segment.NewIterator("pk1", ticket));
+    it->SeekToFirst();
+    uint64_t expect = 1200;
+    while (it->Valid()) {
+        ASSERT_EQ(expect, it->GetKey());
+        expect = expect == 1200 ? 1100 : expect - 1;
+        it->Next();
+    }
+    ASSERT_EQ(998u, expect);
+    DataBlock* result = NULL;
+    ASSERT_TRUE(segment.Get("pk2", 1200, &result));
+    ASSERT_EQ(rows[1].second, result);
+
+    std::vector<uint32_t> ts_idx_vec = {1, 3};
+    Segment multi_ts_segment(8, ts_idx_vec);
+    new_rows();
+    // key entry id is the position of ts column 3
+    multi_ts_segment.BulkLoadPut(1, "pk", rows);
+    ASSERT_EQ(1, (int64_t)multi_ts_segment.GetPkCnt());
+    uint64_t ts_cnt = 0;
+    ASSERT_EQ(0, multi_ts_segment.GetIdxCnt(3, ts_cnt));
+    ASSERT_EQ(3, (int64_t)ts_cnt);
+    ASSERT_EQ(0, multi_ts_segment.GetIdxCnt(1, ts_cnt));
+    ASSERT_EQ(0, (int64_t)ts_cnt);
+    ASSERT_TRUE(multi_ts_segment.Get("pk", 3, 1200, &result));
+    ASSERT_EQ(rows[1].second, result);
+}
+
+TEST_F(SegmentTest, EstimateExpired) {
+    int32_t offset = FLAGS_gc_safe_offset;
+    FLAGS_gc_safe_offset = 0;
+    Segment segment;
+    FLAGS_gc_safe_offset = offset;
+    for (uint64_t ts = 1000; ts < 2000; ts++) {
+        segment.Put("pk", ts, "test1", 5);
+    }
+    uint64_t now = ::baidu::common::timer::get_micros() / 1000;
+    // no row is expired
+    ASSERT_EQ(0u, segment.EstimateExpired(TTLSt(now, 0, ::openmldb::storage::TTLType::kAbsoluteTime)));
+    ASSERT_EQ(0u, segment.EstimateExpired(TTLSt(0, 0, ::openmldb::storage::TTLType::kAbsoluteTime)));
+    uint64_t expired = segment.EstimateExpired(TTLSt(now - 1500, 0, ::openmldb::storage::TTLType::kAbsoluteTime));
+    ASSERT_GT(expired, 0u);
+    ASSERT_LT(expired, 1000u);
+    ASSERT_EQ(1000u, segment.EstimateExpired(TTLSt(now - 3000, 0, ::openmldb::storage::TTLType::kAbsoluteTime)));
+
+    uint64_t gc_idx_cnt = 0;
+    uint64_t gc_record_cnt = 0;
+    uint64_t gc_record_byte_size = 0;
+    segment.Gc4TTL(1499, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    ASSERT_EQ(500u, gc_idx_cnt);
+    // rows older than the remaining ones are expired
+    ASSERT_EQ(0u, segment.EstimateExpired(TTLSt(now - 1499, 0, ::openmldb::storage::TTLType::kAbsoluteTime)));
+
+    // all the rows put since the last gc are candidates of the latest ttl
+    TTLSt lat_ttl(0, 100, ::openmldb::storage::TTLType::kLatestTime);
+    ASSERT_EQ(1000u, segment.EstimateExpired(lat_ttl));
+    segment.ExecuteGc(lat_ttl, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    ASSERT_EQ(900u, gc_idx_cnt);
+    ASSERT_EQ(0u, segment.EstimateExpired(lat_ttl));
+    segment.Put("pk", 2000, "test1", 5);
+    ASSERT_EQ(1u, segment.EstimateExpired(lat_ttl));
+    // a smaller keep cnt makes all the rows candidates
+    ASSERT_EQ(101u, segment.EstimateExpired(TTLSt(0, 10, ::openmldb::storage::TTLType::kLatestTime)));
+}
+
+TEST_F(SegmentTest, GcWithTimeSlice) {
+    uint32_t slice_time = FLAGS_gc_slice_time_ms;
+    uint32_t slice_pause = FLAGS_gc_slice_pause_ms;
+    FLAGS_gc_slice_time_ms = 1;
+    FLAGS_gc_slice_pause_ms = 1;
+    Segment segment;
+    for (uint32_t i = 0; i < 10000; i++) {
+        std::string pk = "pk" + std::to_string(i);
+        segment.Put(pk, 1000, "test1", 5);
+        segment.Put(pk, 1001, "test2", 5);
+    }
+    uint64_t gc_idx_cnt = 0;
+    uint64_t gc_record_cnt = 0;
+    uint64_t gc_record_byte_size = 0;
+    segment.Gc4TTL(1000, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    ASSERT_EQ(10000u, gc_idx_cnt);
+    ASSERT_EQ(10000u, segment.GetIdxCnt());
+    segment.Gc4Head(1, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    ASSERT_EQ(10000u, gc_idx_cnt);
+    segment.Gc4TTL(1001, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    ASSERT_EQ(20000u, gc_idx_cnt);
+    ASSERT_EQ(0u, segment.GetIdxCnt());
+    FLAGS_gc_slice_time_ms = slice_time;
+    FLAGS_gc_slice_pause_ms = slice_pause;
+}
+
+TEST_F(SegmentTest, ExpireIndex) {
+    Segment segment;
+    Segment full_segment;
+    segment.EnableExpireIndex(100);
+    ASSERT_TRUE(segment.HasExpireIndex());
+    auto put = [&](const std::string& pk, uint64_t ts) {
+        segment.Put(pk, ts, "test1", 5);
+        full_segment.Put(pk, ts, "test1", 5);
+    };
+    for (uint32_t i = 0; i < 1000; i++) {
+        std::string pk = "pk" + std::to_string(i);
+        for (uint64_t ts = 1000; ts < 1010; ts++) {
+            put(pk, ts + i * 10);
+        }
+    }
+    // rows out of order move the pk to an older bucket
+    put("pk999", 1005);
+    put("pk500", 900);
+    // the index takes less than 10% of the index memory
+    ASSERT_GT(segment.GetExpireIndexByteSize(), 0u);
+    ASSERT_LT(segment.GetExpireIndexByteSize() * 10, segment.GetIdxByteSize());
+    ASSERT_EQ(segment.GetExpireIndexByteSize(), segment.GetIdxByteSize() - full_segment.GetIdxByteSize());
+
+    for (uint64_t time : {999, 1004, 1050, 5000, 9999, 20000}) {
+        uint64_t gc_idx_cnt = 0;
+        uint64_t gc_record_cnt = 0;
+        uint64_t gc_record_byte_size = 0;
+        segment.Gc4TTL(time, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+        uint64_t full_gc_idx_cnt = 0;
+        uint64_t full_gc_record_cnt = 0;
+        uint64_t full_gc_record_byte_size = 0;
+        full_segment.Gc4TTL(time, full_gc_idx_cnt, full_gc_record_cnt, full_gc_record_byte_size);
+        ASSERT_EQ(full_gc_idx_cnt, gc_idx_cnt);
+        ASSERT_EQ(full_gc_record_cnt, gc_record_cnt);
+        ASSERT_EQ(full_segment.GetIdxCnt(), segment.GetIdxCnt());
+        if (time == 1004) {
+            // a pk deleted and put again is left in its old bucket
+            ASSERT_TRUE(segment.Delete("pk1"));
+            ASSERT_TRUE(full_segment.Delete("pk1"));
+            put("pk1", 1100);
+        }
+    }
+    ASSERT_EQ(0u, segment.GetExpireIndexByteSize());
+    ASSERT_EQ(full_segment.GetIdxByteSize(), segment.GetIdxByteSize());
+}
+
+TEST_F(SegmentTest, ExpireIndexEnableAndDisable) {
+    Segment segment;
+    Segment full_segment;
+    for (uint32_t i = 0; i < 100; i++) {
+        std::string pk = "pk" + std::to_string(i);
+        for (uint64_t ts = 1000; ts < 1010; ts++) {
+            segment.Put(pk, ts + i * 10, "test1", 5);
+            full_segment.Put(pk, ts + i * 10, "test1", 5);
+        }
+    }
+    // the pks put before are indexed when the ttl is set
+    segment.EnableExpireIndex(100);
+    ASSERT_TRUE(segment.HasExpireIndex());
+    ASSERT_EQ(segment.GetExpireIndexByteSize(), segment.GetIdxByteSize() - full_segment.GetIdxByteSize());
+    uint64_t gc_idx_cnt = 0;
+    uint64_t gc_record_cnt = 0;
+    uint64_t gc_record_byte_size = 0;
+    segment.Gc4TTL(1500, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    uint64_t full_gc_idx_cnt = 0;
+    full_segment.Gc4TTL(1500, full_gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    ASSERT_EQ(full_gc_idx_cnt, gc_idx_cnt);
+    ASSERT_EQ(full_segment.GetIdxCnt(), segment.GetIdxCnt());
+
+    // the ttl goes to 0, the index is dropped
+    segment.DisableExpireIndex();
+    ASSERT_FALSE(segment.HasExpireIndex());
+    ASSERT_EQ(0u, segment.GetExpireIndexByteSize());
+    ASSERT_EQ(full_segment.GetIdxByteSize(), segment.GetIdxByteSize());
+    segment.Put("pk0", 900, "test1", 5);
+    ASSERT_EQ(0u, segment.GetExpireIndexByteSize());
+}
+
 }  // namespace storage
 }  // namespace openmldb
 
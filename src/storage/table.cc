@@ -74,6 +74,8 @@ void Table::AddVersionSchema(const ::openmldb::api::TableMeta& table_meta) {
     new_versions->insert(std::make_pair(1, std::make_shared<Schema>(table_meta.column_desc())));
     auto version_decoder = std::make_shared<std::map<int32_t, std::shared_ptr<codec::RowView>>>();
     version_decoder->emplace(1, std::make_shared<codec::RowView>(*(new_versions->begin()->second)));
+    auto version_layout = std::make_shared<std::map<int32_t, std::shared_ptr<codec::RowLayout>>>();
+    version_layout->emplace(1, std::make_shared<codec::RowLayout>(*(new_versions->begin()->second)));
     for (const auto& ver : table_meta.schema_versions()) {
         int remain_size = ver.field_count() - table_meta.column_desc_size();
         if (remain_size < 0) {
@@ -91,9 +93,11 @@ void Table::AddVersionSchema(const ::openmldb::api::TableMeta& table_meta) {
         }
         new_versions->emplace(ver.id(), new_schema);
         version_decoder->emplace(ver.id(), std::make_shared<codec::RowView>(*new_schema));
+        version_layout->emplace(ver.id(), std::make_shared<codec::RowLayout>(*new_schema));
     }
     std::atomic_store_explicit(&version_schema_, new_versions, std::memory_order_relaxed);
     std::atomic_store_explicit(&version_decoder_, version_decoder, std::memory_order_relaxed);
+    std::atomic_store_explicit(&version_layout_, version_layout, std::memory_order_relaxed);
 }
 
 void Table::SetTableMeta(::openmldb::api::TableMeta& table_meta) {  // NOLINT
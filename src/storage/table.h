@@ -106,6 +106,12 @@ class Table {
 
     inline void SetDiskused(uint64_t size) { diskused_.store(size, std::memory_order_relaxed); }
 
+    // the version is increased after every write, so a reader can check whether the data
+    // has been changed since the last read
+    inline uint64_t GetWriteVersion() const { return write_version_.load(std::memory_order_acquire); }
+
+    inline void IncrWriteVersion() { write_version_.fetch_add(1, std::memory_order_release); }
+
     inline const ::openmldb::type::CompressType GetCompressType() { return compress_type_; }
 
     void AddVersionSchema(const ::openmldb::api::TableMeta& table_meta);
@@ -134,6 +140,16 @@ class Table {
         return it->second;
     }
 
+    // layout of the schema version, fields are read by offset without looking up the schema
+    std::shared_ptr<codec::RowLayout> GetVersionLayout(int32_t ver) {
+        auto versions = std::atomic_load_explicit(&version_layout_, std::memory_order_relaxed);
+        auto it = versions->find(ver);
+        if (it == versions->end()) {
+            return nullptr;
+        }
+        return it->second;
+    }
+
     std::shared_ptr<Schema> GetSchema() {
         auto versions = std::atomic_load_explicit(&version_schema_, std::memory_order_relaxed);
         if (!versions->empty()) {
@@ -187,6 +203,7 @@ class Table {
     uint32_t id_;
     uint32_t pid_;
     std::atomic<uint64_t> diskused_;
+    std::atomic<uint64_t> write_version_{1};
     bool is_leader_;
     uint64_t ttl_offset_;
     std::atomic<uint32_t> table_status_;
@@ -196,6 +213,7 @@ class Table {
     int64_t last_make_snapshot_time_;
     std::shared_ptr<std::map<int32_t, std::shared_ptr<Schema>>> version_schema_;
     std::shared_ptr<std::map<int32_t, std::shared_ptr<codec::RowView>>> version_decoder_;
+    std::shared_ptr<std::map<int32_t, std::shared_ptr<codec::RowLayout>>> version_layout_;
     std::shared_ptr<std::vector<::openmldb::storage::UpdateTTLMeta>> update_ttl_;
 };
 
@@ -0,0 +1,658 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/tiered_table.h"
+
+#include <string.h>
+
+#include <map>
+#include <mutex>
+#include <utility>
+
+#include "base/glog_wapper.h"
+#include "common/timer.h"
+#include "gflags/gflags.h"
+
+DECLARE_uint32(max_traverse_cnt);
+
+namespace openmldb {
+namespace storage {
+
+// key of the boundary in the meta of disk tier, followed by index name
+static const char TIER_BOUNDARY_PREFIX[] = "tier_boundary|";
+
+TieredTableIterator::TieredTableIterator(TableIterator* hot, TableIterator* cold, uint64_t boundary)
+    : hot_(hot), cold_(cold), boundary_(boundary), in_hot_(true) {}
+
+void TieredTableIterator::SwitchToCold() {
+    if (in_hot_ && hot_ && hot_->Valid() && hot_->GetKey() >= boundary_) {
+        return;
+    }
+    in_hot_ = false;
+    if (cold_ && boundary_ > 0) {
+        cold_->Seek(boundary_ - 1);
+    }
+}
+
+bool TieredTableIterator::Valid() {
+    if (in_hot_) {
+        return hot_ && hot_->Valid();
+    }
+    return cold_ && boundary_ > 0 && cold_->Valid();
+}
+
+void TieredTableIterator::Next() {
+    if (in_hot_) {
+        hot_->Next();
+        SwitchToCold();
+    } else {
+        cold_->Next();
+    }
+}
+
+openmldb::base::Slice TieredTableIterator::GetValue() const {
+    return in_hot_ ? hot_->GetValue() : cold_->GetValue();
+}
+
+std::string TieredTableIterator::GetPK() const { return in_hot_ ? hot_->GetPK() : cold_->GetPK(); }
+
+uint64_t TieredTableIterator::GetKey() const { return in_hot_ ? hot_->GetKey() : cold_->GetKey(); }
+
+void TieredTableIterator::SeekToFirst() {
+    in_hot_ = true;
+    if (hot_) {
+        hot_->SeekToFirst();
+    }
+    SwitchToCold();
+}
+
+void TieredTableIterator::Seek(uint64_t time) {
+    if (time >= boundary_) {
+        in_hot_ = true;
+        if (hot_) {
+            hot_->Seek(time);
+        }
+        SwitchToCold();
+    } else {
+        in_hot_ = false;
+        if (cold_) {
+            cold_->Seek(time);
+        }
+    }
+}
+
+TieredRowIterator::TieredRowIterator(::hybridse::vm::RowIterator* hot, ::hybridse::vm::RowIterator* cold,
+                                     uint64_t boundary, const TTLSt& expire_value)
+    : hot_(hot), cold_(cold), boundary_(boundary), in_hot_(true), record_idx_(1), expire_value_(expire_value) {}
+
+void TieredRowIterator::SwitchToCold() {
+    if (in_hot_ && hot_ && hot_->Valid() && hot_->GetKey() >= boundary_) {
+        return;
+    }
+    in_hot_ = false;
+    if (cold_ && boundary_ > 0) {
+        cold_->Seek(boundary_ - 1);
+    }
+}
+
+bool TieredRowIterator::Valid() const {
+    bool valid = in_hot_ ? hot_ && hot_->Valid() : cold_ && boundary_ > 0 && cold_->Valid();
+    // ttl of the tiers only counts their own rows, so latest ttl is checked on the merged rows
+    return valid && !expire_value_.IsExpired(GetKey(), record_idx_);
+}
+
+void TieredRowIterator::Next() {
+    record_idx_++;
+    if (in_hot_) {
+        hot_->Next();
+        SwitchToCold();
+    } else {
+        cold_->Next();
+    }
+}
+
+const uint64_t& TieredRowIterator::GetKey() const { return in_hot_ ? hot_->GetKey() : cold_->GetKey(); }
+
+const ::hybridse::codec::Row& TieredRowIterator::GetValue() { return in_hot_ ? hot_->GetValue() : cold_->GetValue(); }
+
+void TieredRowIterator::Seek(const uint64_t& key) {
+    if (key >= boundary_) {
+        in_hot_ = true;
+        if (hot_) {
+            hot_->Seek(key);
+        }
+        SwitchToCold();
+    } else {
+        in_hot_ = false;
+        if (cold_) {
+            cold_->Seek(key);
+        }
+    }
+}
+
+void TieredRowIterator::SeekToFirst() {
+    record_idx_ = 1;
+    in_hot_ = true;
+    if (hot_) {
+        hot_->SeekToFirst();
+    }
+    SwitchToCold();
+}
+
+TieredKeyIterator::TieredKeyIterator(::hybridse::vm::WindowIterator* hot, ::hybridse::vm::WindowIterator* hot_probe,
+                                     ::hybridse::vm::WindowIterator* cold, ::hybridse::vm::WindowIterator* cold_probe,
+                                     uint64_t boundary, const TTLSt& expire_value)
+    : hot_(hot),
+      hot_probe_(hot_probe),
+      cold_(cold),
+      cold_probe_(cold_probe),
+      boundary_(boundary),
+      expire_value_(expire_value),
+      in_hot_(true) {}
+
+bool TieredKeyIterator::InHot(const std::string& key) {
+    hot_probe_->Seek(key);
+    return hot_probe_->Valid() && hot_probe_->GetKey().ToString() == key;
+}
+
+void TieredKeyIterator::SkipHotKeys() {
+    // the rows of these pks in disk tier have been returned along with the ones in memory
+    while (cold_->Valid() && InHot(cold_->GetKey().ToString())) {
+        cold_->Next();
+    }
+}
+
+void TieredKeyIterator::Seek(const std::string& key) {
+    hot_->Seek(key);
+    if (hot_->Valid() && hot_->GetKey().ToString() == key) {
+        in_hot_ = true;
+        return;
+    }
+    in_hot_ = false;
+    cold_->Seek(key);
+    SkipHotKeys();
+}
+
+void TieredKeyIterator::SeekToFirst() {
+    in_hot_ = true;
+    hot_->SeekToFirst();
+    if (!hot_->Valid()) {
+        in_hot_ = false;
+        cold_->SeekToFirst();
+        SkipHotKeys();
+    }
+}
+
+void TieredKeyIterator::Next() {
+    if (in_hot_) {
+        hot_->Next();
+        if (!hot_->Valid()) {
+            in_hot_ = false;
+            cold_->SeekToFirst();
+            SkipHotKeys();
+        }
+    } else {
+        cold_->Next();
+        SkipHotKeys();
+    }
+}
+
+bool TieredKeyIterator::Valid() { return in_hot_ ? hot_->Valid() : cold_->Valid(); }
+
+const hybridse::codec::Row TieredKeyIterator::GetKey() { return in_hot_ ? hot_->GetKey() : cold_->GetKey(); }
+
+std::unique_ptr<::hybridse::vm::RowIterator> TieredKeyIterator::GetValue() {
+    return std::unique_ptr<::hybridse::vm::RowIterator>(GetRawValue());
+}
+
+::hybridse::vm::RowIterator* TieredKeyIterator::GetRawValue() {
+    ::hybridse::vm::RowIterator* hot_rows = nullptr;
+    ::hybridse::vm::RowIterator* cold_rows = nullptr;
+    if (in_hot_) {
+        hot_rows = hot_->GetRawValue();
+        if (boundary_ > 0) {
+            std::string key = hot_->GetKey().ToString();
+            cold_probe_->Seek(key);
+            if (cold_probe_->Valid() && cold_probe_->GetKey().ToString() == key) {
+                cold_rows = cold_probe_->GetRawValue();
+            }
+        }
+    } else {
+        cold_rows = cold_->GetRawValue();
+    }
+    auto it = new TieredRowIterator(hot_rows, cold_rows, boundary_, expire_value_);
+    it->SeekToFirst();
+    return it;
+}
+
+TieredTraverseIterator::TieredTraverseIterator(TieredKeyIterator* key_it) : key_it_(key_it), traverse_cnt_(0) {}
+
+void TieredTraverseIterator::SkipEmptyPK() {
+    row_it_.reset();
+    while (key_it_->Valid()) {
+        row_it_.reset(key_it_->GetRawValue());
+        traverse_cnt_++;
+        if (row_it_->Valid() || traverse_cnt_ >= FLAGS_max_traverse_cnt) {
+            pk_ = key_it_->GetKey().ToString();
+            return;
+        }
+        key_it_->Next();
+    }
+    row_it_.reset();
+}
+
+bool TieredTraverseIterator::Valid() { return row_it_ && row_it_->Valid(); }
+
+void TieredTraverseIterator::Next() {
+    row_it_->Next();
+    traverse_cnt_++;
+    if (!row_it_->Valid()) {
+        NextPK();
+    }
+}
+
+void TieredTraverseIterator::NextPK() {
+    key_it_->Next();
+    SkipEmptyPK();
+}
+
+void TieredTraverseIterator::Seek(const std::string& key, uint64_t time) {
+    key_it_->Seek(key);
+    if (!key_it_->Valid() || key_it_->GetKey().ToString() != key || time == 0) {
+        SkipEmptyPK();
+        return;
+    }
+    pk_ = key;
+    row_it_.reset(key_it_->GetRawValue());
+    traverse_cnt_++;
+    // skip from the first row, so that the rows are counted for latest ttl
+    while (row_it_->Valid() && row_it_->GetKey() >= time) {
+        row_it_->Next();
+        traverse_cnt_++;
+    }
+    if (!row_it_->Valid()) {
+        NextPK();
+    }
+}
+
+openmldb::base::Slice TieredTraverseIterator::GetValue() const {
+    const ::hybridse::codec::Row& row = row_it_->GetValue();
+    return openmldb::base::Slice(reinterpret_cast<const char*>(row.buf()), row.size());
+}
+
+std::string TieredTraverseIterator::GetPK() const { return pk_; }
+
+uint64_t TieredTraverseIterator::GetKey() const {
+    if (row_it_ && row_it_->Valid()) {
+        return row_it_->GetKey();
+    }
+    return UINT64_MAX;
+}
+
+void TieredTraverseIterator::SeekToFirst() {
+    key_it_->SeekToFirst();
+    SkipEmptyPK();
+}
+
+TieredTable::TieredTable(const ::openmldb::api::TableMeta& table_meta, const std::string& table_path)
+    : Table(table_meta.storage_mode(), table_meta.name(), table_meta.tid(), table_meta.pid(), 0, true, 0,
+            std::map<std::string, uint32_t>(), ::openmldb::type::TTLType::kAbsoluteTime,
+            ::openmldb::type::CompressType::kNoCompress),
+      table_path_(table_path) {
+    diskused_ = 0;
+    table_meta_ = std::make_shared<::openmldb::api::TableMeta>(table_meta);
+}
+
+bool TieredTable::Init() {
+    if (!InitFromMeta()) {
+        return false;
+    }
+    ::openmldb::api::TableMeta hot_meta(*table_meta_);
+    hot_meta.set_storage_mode(::openmldb::common::kMemory);
+    hot_ = std::make_unique<MemTable>(hot_meta);
+    if (!hot_->Init()) {
+        PDLOG(WARNING, "init memory tier failed. tid %u pid %u", id_, pid_);
+        return false;
+    }
+    cold_ = std::make_unique<DiskTable>(*table_meta_, table_path_);
+    if (!cold_->Init()) {
+        PDLOG(WARNING, "init disk tier failed. tid %u pid %u path %s", id_, pid_, table_path_.c_str());
+        return false;
+    }
+    std::map<std::string, uint64_t> hot_ttl_map;
+    for (const auto& column_key : table_meta_->column_key()) {
+        if (column_key.hot_ttl() > 0) {
+            hot_ttl_map.emplace(column_key.index_name(), column_key.hot_ttl() * 60 * 1000);
+        }
+    }
+    auto indexs = table_index_.GetAllIndex();
+    boundaries_.clear();
+    for (size_t i = 0; i < indexs.size(); i++) {
+        boundaries_.emplace_back(std::make_unique<TierBoundary>());
+    }
+    for (const auto& index_def : indexs) {
+        if (index_def->GetId() >= boundaries_.size()) {
+            continue;
+        }
+        auto& boundary = boundaries_[index_def->GetId()];
+        auto iter = hot_ttl_map.find(index_def->GetName());
+        if (iter != hot_ttl_map.end()) {
+            boundary->hot_ttl = iter->second;
+        }
+        std::string value;
+        if (cold_->GetMeta(TIER_BOUNDARY_PREFIX + index_def->GetName(), &value) && value.size() == sizeof(uint64_t)) {
+            uint64_t time = 0;
+            memcpy(&time, value.data(), sizeof(uint64_t));
+            boundary->pending.store(time, std::memory_order_relaxed);
+            boundary->published.store(time, std::memory_order_relaxed);
+        }
+        PDLOG(INFO, "index %s hot ttl %lu ms boundary %lu. tid %u pid %u", index_def->GetName().c_str(),
+              boundary->hot_ttl, boundary->published.load(std::memory_order_relaxed), id_, pid_);
+    }
+    return true;
+}
+
+uint64_t TieredTable::GetTierBoundary(uint32_t idx) const {
+    if (idx >= boundaries_.size()) {
+        return 0;
+    }
+    return boundaries_[idx]->published.load(std::memory_order_acquire);
+}
+
+bool TieredTable::Put(const std::string& pk, uint64_t time, const char* data, uint32_t size) {
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    uint64_t published = GetTierBoundary(0);
+    uint64_t pending = boundaries_.empty() ? 0 : boundaries_[0]->pending.load(std::memory_order_acquire);
+    // the memory tier never rejects a row after init, so the disk tier is written first and
+    // a failed put leaves no row in either tier
+    bool ok = true;
+    if (time < pending) {
+        ok = cold_->Put(pk, time, data, size);
+    }
+    if (ok && time >= published) {
+        ok = hot_->Put(pk, time, data, size);
+        if (ok && time < pending) {
+            AddBothCnt(1);
+        }
+    }
+    if (ok) {
+        IncrWriteVersion();
+    }
+    return ok;
+}
+
+bool TieredTable::Put(uint64_t time, const std::string& value, const Dimensions& dimensions) {
+    if (dimensions.empty()) {
+        PDLOG(WARNING, "empty dimension. tid %u pid %u", id_, pid_);
+        return false;
+    }
+    if (value.length() < codec::HEADER_LENGTH) {
+        PDLOG(WARNING, "invalid value. tid %u pid %u", id_, pid_);
+        return false;
+    }
+    const int8_t* data = reinterpret_cast<const int8_t*>(value.data());
+    uint8_t version = codec::RowView::GetSchemaVersion(data);
+    auto layout = GetVersionLayout(version);
+    if (layout == nullptr) {
+        PDLOG(WARNING, "invalid schema version %u, tid %u pid %u", version, id_, pid_);
+        return false;
+    }
+    // the boundary must not move while the row is routed, otherwise a row may miss both tiers
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    Dimensions hot_dims;
+    Dimensions cold_dims;
+    // the disk tier counts the rows of the first inner index
+    bool cold_counted = false;
+    for (const auto& dim : dimensions) {
+        int32_t inner_pos = table_index_.GetInnerIndexPos(dim.idx());
+        auto inner_index = table_index_.GetInnerIndex(inner_pos);
+        if (!inner_index) {
+            PDLOG(WARNING, "invalid dimension. dimension idx %u, tid %u pid %u", dim.idx(), id_, pid_);
+            return false;
+        }
+        bool to_hot = false;
+        bool to_cold = false;
+        for (const auto& index_def : inner_index->GetIndex()) {
+            int64_t ts = time;
+            auto ts_col = index_def->GetTsColumn();
+            if (ts_col && !ts_col->IsAutoGenTs() &&
+                layout->GetInteger(data, ts_col->GetId(), &ts) != 0) {
+                PDLOG(WARNING, "get ts failed. tid %u pid %u", id_, pid_);
+                return false;
+            }
+            uint32_t id = index_def->GetId();
+            uint64_t published = GetTierBoundary(id);
+            uint64_t pending = id < boundaries_.size() ? boundaries_[id]->pending.load(std::memory_order_acquire) : 0;
+            to_hot = to_hot || static_cast<uint64_t>(ts) >= published;
+            to_cold = to_cold || static_cast<uint64_t>(ts) < pending;
+        }
+        if (to_hot) {
+            hot_dims.Add()->CopyFrom(dim);
+        }
+        if (to_cold) {
+            cold_dims.Add()->CopyFrom(dim);
+            cold_counted = cold_counted || inner_pos == 0;
+        }
+    }
+    // the memory tier only rejects the malformed rows checked above, so the disk tier is
+    // written first and a failed put leaves no row in either tier
+    bool ok = true;
+    if (!cold_dims.empty()) {
+        ok = cold_->Put(time, value, cold_dims);
+    }
+    if (ok && !hot_dims.empty()) {
+        ok = hot_->Put(time, value, hot_dims);
+        if (ok && cold_counted) {
+            AddBothCnt(1);
+        }
+    }
+    if (ok) {
+        IncrWriteVersion();
+    }
+    return ok;
+}
+
+bool TieredTable::Delete(const std::string& pk, uint32_t idx) {
+    // a row being demoted would be written back to the disk tier after it is deleted there
+    std::unique_lock<std::shared_mutex> lock(mu_);
+    bool hot_ok = hot_->Delete(pk, idx);
+    bool cold_ok = cold_->Delete(pk, idx);
+    if (hot_ok || cold_ok) {
+        IncrWriteVersion();
+    }
+    return hot_ok || cold_ok;
+}
+
+TableIterator* TieredTable::NewIterator(const std::string& pk, Ticket& ticket) { return NewIterator(0, pk, ticket); }
+
+TableIterator* TieredTable::NewIterator(uint32_t index, const std::string& pk, Ticket& ticket) {
+    // rows older than the boundary are kept in memory until the next gc, so the boundary is
+    // read before the tiers
+    uint64_t boundary = GetTierBoundary(index);
+    TableIterator* hot = hot_->NewIterator(index, pk, ticket);
+    if (hot == NULL) {
+        return NULL;
+    }
+    return new TieredTableIterator(hot, cold_->NewIterator(index, pk, ticket), boundary);
+}
+
+::hybridse::vm::WindowIterator* TieredTable::NewWindowIterator(uint32_t index) {
+    std::shared_ptr<IndexDef> index_def = table_index_.GetIndex(index);
+    if (!index_def || !index_def->IsReady()) {
+        LOG(WARNING) << "index id " << index << "  not found. tid " << id_ << " pid " << pid_;
+        return NULL;
+    }
+    uint64_t boundary = GetTierBoundary(index);
+    std::unique_ptr<::hybridse::vm::WindowIterator> hot(hot_->NewWindowIterator(index));
+    std::unique_ptr<::hybridse::vm::WindowIterator> hot_probe(hot_->NewWindowIterator(index));
+    std::unique_ptr<::hybridse::vm::WindowIterator> cold(cold_->NewWindowIterator(index));
+    std::unique_ptr<::hybridse::vm::WindowIterator> cold_probe(cold_->NewWindowIterator(index));
+    if (!hot || !hot_probe || !cold || !cold_probe) {
+        return NULL;
+    }
+    auto ttl = index_def->GetTTL();
+    TTLSt expire_value(0, 0, ttl->ttl_type);
+    if (hot_->GetExpireStatus()) {
+        expire_value.abs_ttl = GetExpireTime(*ttl);
+        expire_value.lat_ttl = ttl->lat_ttl;
+    }
+    return new TieredKeyIterator(hot.release(), hot_probe.release(), cold.release(), cold_probe.release(), boundary,
+                                 expire_value);
+}
+
+TraverseIterator* TieredTable::NewTraverseIterator(uint32_t index) {
+    auto key_it = dynamic_cast<TieredKeyIterator*>(NewWindowIterator(index));
+    if (key_it == NULL) {
+        PDLOG(WARNING, "index %u not found. tid %u pid %u", index, id_, pid_);
+        return NULL;
+    }
+    return new TieredTraverseIterator(key_it);
+}
+
+int TieredTable::GetCount(uint32_t index, const std::string& pk, uint64_t& count) {
+    Ticket ticket;
+    std::unique_ptr<TableIterator> it(NewIterator(index, pk, ticket));
+    if (!it) {
+        return -1;
+    }
+    count = 0;
+    for (it->SeekToFirst(); it->Valid(); it->Next()) {
+        count++;
+    }
+    return 0;
+}
+
+bool TieredTable::DeleteIndex(const std::string& idx_name) {
+    std::shared_ptr<IndexDef> index_def = table_index_.GetIndex(idx_name);
+    if (!index_def || !hot_->DeleteIndex(idx_name)) {
+        return false;
+    }
+    cold_->DeleteIndex(idx_name);
+    auto table_meta = GetTableMeta();
+    auto new_table_meta = std::make_shared<::openmldb::api::TableMeta>(*table_meta);
+    if (index_def->GetId() < (uint32_t)table_meta->column_key_size()) {
+        new_table_meta->mutable_column_key(index_def->GetId())->set_flag(1);
+    }
+    std::atomic_store_explicit(&table_meta_, new_table_meta, std::memory_order_release);
+    // the rows are released by gc of the tiers
+    index_def->SetStatus(IndexStatus::kDeleted);
+    return true;
+}
+
+void TieredTable::SyncTTL(Table* table) {
+    for (const auto& index_def : table_index_.GetAllIndex()) {
+        auto tier_index = table->GetIndex(index_def->GetName());
+        if (!tier_index) {
+            continue;
+        }
+        auto ttl = index_def->GetTTL();
+        auto tier_ttl = tier_index->GetTTL();
+        if (ttl->abs_ttl != tier_ttl->abs_ttl || ttl->lat_ttl != tier_ttl->lat_ttl ||
+            ttl->ttl_type != tier_ttl->ttl_type) {
+            table->SetTTL(UpdateTTLMeta(*ttl, index_def->GetName()));
+        }
+    }
+}
+
+void TieredTable::SubBothCnt(uint64_t cnt) {
+    uint64_t cur = both_cnt_.load(std::memory_order_relaxed);
+    while (!both_cnt_.compare_exchange_weak(cur, cur - std::min(cur, cnt), std::memory_order_relaxed)) {
+    }
+}
+
+bool TieredTable::DemoteIndex(const std::shared_ptr<IndexDef>& index_def, uint64_t start, uint64_t end,
+                              uint64_t* cnt) {
+    uint32_t idx = index_def->GetId();
+    std::unique_ptr<::hybridse::vm::WindowIterator> it(hot_->NewWindowIterator(idx));
+    if (!it) {
+        return false;
+    }
+    *cnt = 0;
+    Dimensions dims;
+    auto dim = dims.Add();
+    dim->set_idx(idx);
+    for (it->SeekToFirst(); it->Valid(); it->Next()) {
+        dim->set_key(it->GetKey().ToString());
+        std::unique_ptr<::hybridse::vm::RowIterator> rows(it->GetRawValue());
+        // rows older than start were moved by the previous rounds and the expired rows are not moved
+        for (rows->Seek(end - 1); rows->Valid() && rows->GetKey() >= start; rows->Next()) {
+            const ::hybridse::codec::Row& row = rows->GetValue();
+            std::string value(reinterpret_cast<const char*>(row.buf()), row.size());
+            if (!cold_->Put(rows->GetKey(), value, dims)) {
+                PDLOG(WARNING, "move row of index %s to disk failed. tid %u pid %u", index_def->GetName().c_str(), id_,
+                      pid_);
+                return false;
+            }
+            (*cnt)++;
+        }
+    }
+    PDLOG(INFO, "moved %lu rows of index %s in [%lu, %lu) to disk. tid %u pid %u", *cnt,
+          index_def->GetName().c_str(), start, end, id_, pid_);
+    return true;
+}
+
+void TieredTable::SchedGc() {
+    UpdateTTL();
+    SyncTTL(hot_.get());
+    SyncTTL(cold_.get());
+    uint64_t now = ::baidu::common::timer::get_micros() / 1000;
+    for (const auto& index_def : table_index_.GetAllIndex()) {
+        uint32_t idx = index_def->GetId();
+        if (!index_def->IsReady() || idx >= boundaries_.size()) {
+            continue;
+        }
+        auto& boundary = boundaries_[idx];
+        if (boundary->hot_ttl == 0 || now <= boundary->hot_ttl) {
+            continue;
+        }
+        uint64_t old = boundary->published.load(std::memory_order_acquire);
+        uint64_t cur = now - boundary->hot_ttl;
+        if (cur <= old) {
+            continue;
+        }
+        {
+            // rows older than cur are written to disk since now, so the copy below misses no row
+            std::unique_lock<std::shared_mutex> lock(mu_);
+            boundary->pending.store(cur, std::memory_order_release);
+        }
+        uint64_t cnt = 0;
+        bool demoted = false;
+        {
+            std::shared_lock<std::shared_mutex> lock(mu_);
+            demoted = DemoteIndex(index_def, old, cur, &cnt);
+        }
+        if (!demoted) {
+            continue;
+        }
+        std::string value(sizeof(uint64_t), '\0');
+        memcpy(&value[0], &cur, sizeof(uint64_t));
+        if (!cold_->PutMeta(TIER_BOUNDARY_PREFIX + index_def->GetName(), value)) {
+            continue;
+        }
+        boundary->published.store(cur, std::memory_order_release);
+        if (index_def->GetInnerPos() == 0) {
+            AddBothCnt(cnt);
+        }
+        // rows are released one round later, so the iterators created before the boundary
+        // moves never see released rows. The released rows are in the disk tier only
+        SubBothCnt(hot_->GcBefore(idx, old));
+    }
+    hot_->SchedGc();
+    cold_->SchedGc();
+}
+
+}  // namespace storage
+}  // namespace openmldb
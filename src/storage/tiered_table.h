@@ -0,0 +1,232 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_STORAGE_TIERED_TABLE_H_
+#define SRC_STORAGE_TIERED_TABLE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "storage/disk_table.h"
+#include "storage/iterator.h"
+#include "storage/mem_table.h"
+#include "storage/table.h"
+#include "vm/catalog.h"
+
+namespace openmldb {
+namespace storage {
+
+// Rows of an index with ts >= boundary are read from the memory tier and the older
+// ones are read from the disk tier. The boundary only moves forward.
+struct TierBoundary {
+    // ms of rows kept in memory, 0 means all rows are kept in memory
+    uint64_t hot_ttl = 0;
+    // rows older than pending are written to the disk tier
+    std::atomic<uint64_t> pending{0};
+    // rows older than published are read from the disk tier
+    std::atomic<uint64_t> published{0};
+};
+
+// rows of a pk, hot rows newer than boundary first and then cold rows older than boundary
+class TieredTableIterator : public TableIterator {
+ public:
+    // take the ownership of hot and cold, either may be null
+    TieredTableIterator(TableIterator* hot, TableIterator* cold, uint64_t boundary);
+    ~TieredTableIterator() override = default;
+
+    bool Valid() override;
+    void Next() override;
+    openmldb::base::Slice GetValue() const override;
+    std::string GetPK() const override;
+    uint64_t GetKey() const override;
+    void SeekToFirst() override;
+    void Seek(uint64_t time) override;
+
+ private:
+    void SwitchToCold();
+
+    std::unique_ptr<TableIterator> hot_;
+    std::unique_ptr<TableIterator> cold_;
+    uint64_t boundary_;
+    bool in_hot_;
+};
+
+class TieredRowIterator : public ::hybridse::vm::RowIterator {
+ public:
+    // take the ownership of hot and cold, either may be null
+    TieredRowIterator(::hybridse::vm::RowIterator* hot, ::hybridse::vm::RowIterator* cold, uint64_t boundary,
+                      const TTLSt& expire_value);
+    ~TieredRowIterator() override = default;
+
+    bool Valid() const override;
+    void Next() override;
+    const uint64_t& GetKey() const override;
+    const ::hybridse::codec::Row& GetValue() override;
+    void Seek(const uint64_t& key) override;
+    void SeekToFirst() override;
+    bool IsSeekable() const override { return true; }
+
+ private:
+    void SwitchToCold();
+
+    std::unique_ptr<::hybridse::vm::RowIterator> hot_;
+    std::unique_ptr<::hybridse::vm::RowIterator> cold_;
+    uint64_t boundary_;
+    bool in_hot_;
+    uint32_t record_idx_;
+    TTLSt expire_value_;
+};
+
+// pks in the memory tier first, then the pks only in the disk tier
+class TieredKeyIterator : public ::hybridse::vm::WindowIterator {
+ public:
+    // take the ownership of all the iterators, probes are used to look up a single pk
+    TieredKeyIterator(::hybridse::vm::WindowIterator* hot, ::hybridse::vm::WindowIterator* hot_probe,
+                      ::hybridse::vm::WindowIterator* cold, ::hybridse::vm::WindowIterator* cold_probe,
+                      uint64_t boundary, const TTLSt& expire_value);
+    ~TieredKeyIterator() override = default;
+
+    void Seek(const std::string& key) override;
+    void SeekToFirst() override;
+    void Next() override;
+    bool Valid() override;
+    std::unique_ptr<::hybridse::vm::RowIterator> GetValue() override;
+    ::hybridse::vm::RowIterator* GetRawValue() override;
+    const hybridse::codec::Row GetKey() override;
+
+ private:
+    bool InHot(const std::string& key);
+    void SkipHotKeys();
+
+    std::unique_ptr<::hybridse::vm::WindowIterator> hot_;
+    std::unique_ptr<::hybridse::vm::WindowIterator> hot_probe_;
+    std::unique_ptr<::hybridse::vm::WindowIterator> cold_;
+    std::unique_ptr<::hybridse::vm::WindowIterator> cold_probe_;
+    uint64_t boundary_;
+    TTLSt expire_value_;
+    bool in_hot_;
+};
+
+class TieredTraverseIterator : public TraverseIterator {
+ public:
+    explicit TieredTraverseIterator(TieredKeyIterator* key_it);
+    ~TieredTraverseIterator() override = default;
+
+    bool Valid() override;
+    void Next() override;
+    void NextPK() override;
+    void Seek(const std::string& key, uint64_t time) override;
+    openmldb::base::Slice GetValue() const override;
+    std::string GetPK() const override;
+    uint64_t GetKey() const override;
+    void SeekToFirst() override;
+    uint64_t GetCount() const override { return traverse_cnt_; }
+
+ private:
+    // open the rows of current pk and skip the pks without rows
+    void SkipEmptyPK();
+
+    std::unique_ptr<TieredKeyIterator> key_it_;
+    std::unique_ptr<::hybridse::vm::RowIterator> row_it_;
+    std::string pk_;
+    uint64_t traverse_cnt_;
+};
+
+// A table with recent rows in a MemTable and older rows in a DiskTable. The boundary of
+// each index follows hot_ttl of its ColumnKey, rows older than the boundary are moved to
+// the disk tier by SchedGc and the iterators merge both tiers by ts.
+class TieredTable : public Table {
+ public:
+    TieredTable(const ::openmldb::api::TableMeta& table_meta, const std::string& table_path);
+    TieredTable(const TieredTable&) = delete;
+    TieredTable& operator=(const TieredTable&) = delete;
+    ~TieredTable() override = default;
+
+    bool Init() override;
+
+    bool Put(const std::string& pk, uint64_t time, const char* data, uint32_t size) override;
+
+    bool Put(uint64_t time, const std::string& value, const Dimensions& dimensions) override;
+
+    bool Delete(const std::string& pk, uint32_t idx) override;
+
+    TableIterator* NewIterator(const std::string& pk, Ticket& ticket) override;
+
+    TableIterator* NewIterator(uint32_t index, const std::string& pk, Ticket& ticket) override;
+
+    TraverseIterator* NewTraverseIterator(uint32_t index) override;
+
+    ::hybridse::vm::WindowIterator* NewWindowIterator(uint32_t index) override;
+
+    // move rows older than the boundary to the disk tier, then gc both tiers
+    void SchedGc() override;
+
+    // the rows in both tiers are counted once
+    uint64_t GetRecordCnt() const override {
+        uint64_t cold_cnt = cold_->GetRecordCnt();
+        return hot_->GetRecordCnt() + cold_cnt - std::min(cold_cnt, both_cnt_.load(std::memory_order_relaxed));
+    }
+
+    bool IsExpire(const ::openmldb::api::LogEntry& entry) override { return hot_->IsExpire(entry); }
+
+    uint64_t GetExpireTime(const TTLSt& ttl_st) override { return hot_->GetExpireTime(ttl_st); }
+
+    bool DeleteIndex(const std::string& idx_name) override;
+
+    // the stats of memory usage are the ones of the memory tier
+    uint64_t GetRecordIdxCnt() override { return hot_->GetRecordIdxCnt(); }
+    bool GetRecordIdxCnt(uint32_t idx, uint64_t** stat, uint32_t* size) override {
+        return hot_->GetRecordIdxCnt(idx, stat, size);
+    }
+    uint64_t GetRecordPkCnt() override { return hot_->GetRecordPkCnt(); }
+    inline uint64_t GetRecordByteSize() const override { return hot_->GetRecordByteSize(); }
+    uint64_t GetRecordIdxByteSize() override { return hot_->GetRecordIdxByteSize(); }
+
+    int GetCount(uint32_t index, const std::string& pk, uint64_t& count) override;  // NOLINT
+
+    // rows of the index older than the returned time are read from the disk tier
+    uint64_t GetTierBoundary(uint32_t idx) const;
+
+    MemTable* GetHotTable() { return hot_.get(); }
+    DiskTable* GetColdTable() { return cold_.get(); }
+
+ private:
+    // copy the rows of the index with ts in [start, end) to the disk tier, `cnt` is set to the rows copied
+    bool DemoteIndex(const std::shared_ptr<IndexDef>& index_def, uint64_t start, uint64_t end, uint64_t* cnt);
+    void AddBothCnt(uint64_t cnt) { both_cnt_.fetch_add(cnt, std::memory_order_relaxed); }
+    void SubBothCnt(uint64_t cnt);
+    void SyncTTL(Table* table);
+
+    std::string table_path_;
+    std::unique_ptr<MemTable> hot_;
+    std::unique_ptr<DiskTable> cold_;
+    // indexed by index id
+    std::vector<std::unique_ptr<TierBoundary>> boundaries_;
+    // put and demoting rows are shared, moving the pending boundary and delete are exclusive
+    std::shared_mutex mu_;
+    // the rows of the first inner index in both tiers, which the disk tier counts as well. They are
+    // written to both tiers while the boundary moves, or demoted and not yet released from memory
+    std::atomic<uint64_t> both_cnt_{0};
+};
+
+}  // namespace storage
+}  // namespace openmldb
+
+#endif  // SRC_STORAGE_TIERED_TABLE_H_
@@ -0,0 +1,222 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/tiered_table.h"
+
+#include <gflags/gflags.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/file_util.h"
+#include "base/glog_wapper.h"
+#include "codec/schema_codec.h"
+#include "codec/sdk_codec.h"
+#include "common/timer.h"
+#include "gtest/gtest.h"
+#include "storage/ticket.h"
+
+using ::openmldb::codec::SchemaCodec;
+
+DECLARE_string(hdd_root_path);
+
+namespace openmldb {
+namespace storage {
+
+static const uint64_t MINUTE = 60 * 1000;
+static const int ROW_NUM = 180;
+
+class TieredTableTest : public ::testing::Test {
+ public:
+    TieredTableTest() {}
+    ~TieredTableTest() {}
+};
+
+static ::openmldb::api::TableMeta CreateMeta(uint32_t tid) {
+    ::openmldb::api::TableMeta table_meta;
+    table_meta.set_tid(tid);
+    table_meta.set_pid(1);
+    table_meta.set_storage_mode(::openmldb::common::kHDD);
+    table_meta.set_format_version(1);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "card", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "mcc", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts", ::openmldb::type::kBigInt);
+    auto column_key = table_meta.add_column_key();
+    SchemaCodec::SetIndex(column_key, "card", "card", "ts", ::openmldb::type::kAbsoluteTime, 0, 0);
+    column_key->set_hot_ttl(60);
+    // kept in memory only
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "mcc", "mcc", "ts", ::openmldb::type::kAbsoluteTime, 0, 0);
+    return table_meta;
+}
+
+static void PutRow(TieredTable* table, codec::SDKCodec* codec, const std::string& card, uint64_t ts,
+                   bool with_mcc = false) {
+    std::vector<std::string> row = {card, "mcc", std::to_string(ts)};
+    std::string value;
+    ASSERT_EQ(0, codec->EncodeRow(row, &value));
+    Dimensions dims;
+    auto dim = dims.Add();
+    dim->set_key(card);
+    dim->set_idx(0);
+    if (with_mcc) {
+        dim = dims.Add();
+        dim->set_key("mcc");
+        dim->set_idx(1);
+    }
+    ASSERT_TRUE(table->Put(ts, value, dims));
+}
+
+static uint64_t CountWindow(TieredTable* table, uint32_t idx, const std::string& pk) {
+    std::unique_ptr<::hybridse::vm::WindowIterator> it(table->NewWindowIterator(idx));
+    it->Seek(pk);
+    if (!it->Valid() || it->GetKey().ToString() != pk) {
+        return 0;
+    }
+    auto rows = it->GetValue();
+    uint64_t cnt = 0;
+    uint64_t last = UINT64_MAX;
+    for (rows->SeekToFirst(); rows->Valid(); rows->Next()) {
+        EXPECT_LT(rows->GetKey(), last);
+        last = rows->GetKey();
+        cnt++;
+    }
+    return cnt;
+}
+
+TEST_F(TieredTableTest, MoveToDisk) {
+    ::openmldb::api::TableMeta table_meta = CreateMeta(1);
+    std::string table_path = FLAGS_hdd_root_path + "/1_1";
+    TieredTable* table = new TieredTable(table_meta, table_path);
+    ASSERT_TRUE(table->Init());
+    codec::SDKCodec codec(table_meta);
+    uint64_t now = ::baidu::common::timer::get_micros() / 1000;
+    for (int i = 0; i < ROW_NUM; i++) {
+        PutRow(table, &codec, "card0", now - i * MINUTE - MINUTE / 2);
+        PutRow(table, &codec, "card1", now - i * MINUTE - MINUTE / 2);
+    }
+    ASSERT_EQ(0u, table->GetTierBoundary(0));
+    ASSERT_EQ(2u * ROW_NUM, table->GetHotTable()->GetRecordCnt());
+
+    table->SchedGc();
+    uint64_t boundary = table->GetTierBoundary(0);
+    ASSERT_GE(boundary, now - 60 * MINUTE);
+    ASSERT_EQ(0u, table->GetTierBoundary(1));
+    // rows are released from memory in the next round
+    ASSERT_EQ(2u * ROW_NUM, table->GetHotTable()->GetRecordCnt());
+    // the rows in both tiers are counted once
+    ASSERT_EQ(2u * ROW_NUM, table->GetRecordCnt());
+    ASSERT_EQ(static_cast<uint64_t>(ROW_NUM), CountWindow(table, 0, "card0"));
+    ASSERT_EQ(static_cast<uint64_t>(ROW_NUM), CountWindow(table, 0, "card1"));
+
+    table->SchedGc();
+    ASSERT_EQ(2u * 60, table->GetHotTable()->GetRecordCnt());
+    ASSERT_EQ(2u * ROW_NUM, table->GetRecordCnt());
+    ASSERT_EQ(static_cast<uint64_t>(ROW_NUM), CountWindow(table, 0, "card1"));
+    uint64_t count = 0;
+    ASSERT_EQ(0, table->GetCount(0, "card0", count));
+    ASSERT_EQ(static_cast<uint64_t>(ROW_NUM), count);
+
+    // rows older than the boundary are written to disk only
+    PutRow(table, &codec, "card2", now - 150 * MINUTE);
+    PutRow(table, &codec, "card2", now - MINUTE);
+    ASSERT_EQ(2u * 60 + 1, table->GetHotTable()->GetRecordCnt());
+    ASSERT_EQ(2u * ROW_NUM + 2, table->GetRecordCnt());
+    ASSERT_EQ(2u, CountWindow(table, 0, "card2"));
+
+    Ticket ticket;
+    std::unique_ptr<TableIterator> it(table->NewIterator(0, "card0", ticket));
+    it->Seek(now - 100 * MINUTE);
+    ASSERT_TRUE(it->Valid());
+    ASSERT_EQ(now - 100 * MINUTE - MINUTE / 2, it->GetKey());
+    it->SeekToFirst();
+    ASSERT_EQ(now - MINUTE / 2, it->GetKey());
+
+    std::unique_ptr<TraverseIterator> traverse(table->NewTraverseIterator(0));
+    uint64_t total = 0;
+    for (traverse->SeekToFirst(); traverse->Valid(); traverse->Next()) {
+        total++;
+    }
+    ASSERT_EQ(2u * ROW_NUM + 2, total);
+    traverse->Seek("card1", now - 100 * MINUTE - MINUTE / 2);
+    ASSERT_TRUE(traverse->Valid());
+    ASSERT_EQ("card1", traverse->GetPK());
+    ASSERT_EQ(now - 101 * MINUTE - MINUTE / 2, traverse->GetKey());
+    delete table;
+
+    // the boundary is kept on disk, the rows in memory are gone without binlog
+    table = new TieredTable(table_meta, table_path);
+    ASSERT_TRUE(table->Init());
+    ASSERT_GE(table->GetTierBoundary(0), boundary);
+    ASSERT_EQ(ROW_NUM - 60u, CountWindow(table, 0, "card0"));
+    ASSERT_EQ(1u, CountWindow(table, 0, "card2"));
+    delete table;
+    ::openmldb::base::RemoveDirRecursive(table_path);
+}
+
+TEST_F(TieredTableTest, IndexWithoutHotTTL) {
+    ::openmldb::api::TableMeta table_meta = CreateMeta(2);
+    std::string table_path = FLAGS_hdd_root_path + "/2_1";
+    TieredTable* table = new TieredTable(table_meta, table_path);
+    ASSERT_TRUE(table->Init());
+    codec::SDKCodec codec(table_meta);
+    uint64_t now = ::baidu::common::timer::get_micros() / 1000;
+    for (int i = 0; i < ROW_NUM; i++) {
+        PutRow(table, &codec, "card0", now - i * MINUTE - MINUTE / 2, true);
+    }
+    table->SchedGc();
+    table->SchedGc();
+    ASSERT_GT(table->GetTierBoundary(0), 0u);
+    ASSERT_EQ(0u, table->GetTierBoundary(1));
+    ASSERT_EQ(static_cast<uint64_t>(ROW_NUM), CountWindow(table, 0, "card0"));
+    ASSERT_EQ(static_cast<uint64_t>(ROW_NUM), CountWindow(table, 1, "mcc"));
+    // the rows are still referenced by the index kept in memory
+    ASSERT_EQ(static_cast<uint64_t>(ROW_NUM), table->GetHotTable()->GetRecordCnt());
+    delete table;
+    ::openmldb::base::RemoveDirRecursive(table_path);
+}
+
+TEST_F(TieredTableTest, LatestTTL) {
+    ::openmldb::api::TableMeta table_meta = CreateMeta(3);
+    table_meta.mutable_column_key(0)->mutable_ttl()->set_ttl_type(::openmldb::type::kLatestTime);
+    table_meta.mutable_column_key(0)->mutable_ttl()->set_lat_ttl(100);
+    std::string table_path = FLAGS_hdd_root_path + "/3_1";
+    TieredTable* table = new TieredTable(table_meta, table_path);
+    ASSERT_TRUE(table->Init());
+    codec::SDKCodec codec(table_meta);
+    uint64_t now = ::baidu::common::timer::get_micros() / 1000;
+    for (int i = 0; i < ROW_NUM; i++) {
+        PutRow(table, &codec, "card0", now - i * MINUTE - MINUTE / 2);
+    }
+    table->SchedGc();
+    table->SchedGc();
+    // 60 rows in memory and 40 rows on disk are in the latest 100 rows
+    ASSERT_EQ(100u, CountWindow(table, 0, "card0"));
+    delete table;
+    ::openmldb::base::RemoveDirRecursive(table_path);
+}
+
+}  // namespace storage
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    ::openmldb::base::SetLogLevel(INFO);
+    FLAGS_hdd_root_path = "/tmp/tiered_table_test_" + std::to_string(::baidu::common::timer::get_micros());
+    int ret = RUN_ALL_TESTS();
+    ::openmldb::base::RemoveDirRecursive(FLAGS_hdd_root_path);
+    return ret;
+}
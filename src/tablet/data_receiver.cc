@@ -96,16 +96,18 @@ bool DataReceiver::WriteBinlogToReplicator(const std::shared_ptr<replica::LogRep
             << next_part_id_ - 1 << ", request part id " << request->part_id();
         return false;
     }
+    std::vector<::openmldb::api::LogEntry> entries(request->binlog_info_size());
+    uint64_t term = replicator->GetLeaderTerm();
     for (int i = 0; i < request->binlog_info_size(); ++i) {
         const auto& info = request->binlog_info(i);
-        ::openmldb::api::LogEntry entry;
+        auto& entry = entries[i];
         auto* block = info.block_id() < data_blocks_.size() ? data_blocks_[info.block_id()] : nullptr;
         if (block == nullptr) {
             LOG(ERROR) << "binlog wants " << info.block_id() << ", but cached block size = " << data_blocks_.size();
             return false;
         }
         entry.set_value(block->data, block->size);
-        entry.set_term(replicator->GetLeaderTerm());
+        entry.set_term(term);
         if (info.dimensions_size() > 0) {
             entry.mutable_dimensions()->CopyFrom(info.dimensions());
         }
@@ -113,7 +115,11 @@ bool DataReceiver::WriteBinlogToReplicator(const std::shared_ptr<replica::LogRep
             entry.mutable_ts_dimensions()->CopyFrom(info.ts_dimensions());
         }
         entry.set_ts(info.time());
-        replicator->AppendEntry(entry);
+    }
+    // the rows of a part are written as one batch instead of taking the binlog lock for each row
+    if (!replicator->AppendEntries(entries)) {
+        LOG(ERROR) << tid_ << "-" << pid_ << " write binlog failed";
+        return false;
     }
     LOG(INFO) << "binlog write num " << request->binlog_info_size();
     return true;
@@ -0,0 +1,186 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_TABLET_REQUEST_COALESCER_H_
+#define SRC_TABLET_REQUEST_COALESCER_H_
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bthread/bthread.h"
+#include "bthread/condition_variable.h"
+#include "bthread/mutex.h"
+#include "butil/time.h"
+
+namespace openmldb {
+namespace tablet {
+
+// RequestCoalescer groups the concurrent requests of the same key and hands them to
+// the handler as one batch, on the bthread of one of the requests (the leader).
+//
+// A request arriving while no batch of its key is being collected becomes the leader: it
+// waits for more requests of the key up to an adaptive window, takes at most `max_batch`
+// of them and runs them. A leader runs only its own batch. The requests queued beyond it
+// are handed to a new leader bthread, and the requests arriving while the batch runs form
+// the next batch, so the batches of a busy key run concurrently instead of one after another.
+// The window follows the arrival rate of the key: it is 0 if less than one request is
+// expected within `max_wait_us`, so a lightly loaded key gets no extra latency, and it
+// is the time to collect `max_batch` requests otherwise, capped by `max_wait_us`.
+template <typename Request>
+class RequestCoalescer {
+ public:
+    using Handler = std::function<void(const std::string& key, std::vector<Request>* batch)>;
+
+    RequestCoalescer(uint32_t max_batch, uint64_t max_wait_us, Handler handler)
+        : max_batch_(std::max(max_batch, 1u)), max_wait_us_(max_wait_us), handler_(std::move(handler)) {}
+
+    void Submit(const std::string& key, Request request) {
+        std::unique_lock<bthread::Mutex> lock(mu_);
+        auto& group = groups_[key];
+        int64_t now = butil::gettimeofday_us();
+        if (group.last_arrival_us > 0) {
+            // an idle gap counts as at most one second, so the rate recovers quickly
+            double interval = std::min<int64_t>(now - group.last_arrival_us, kMaxIntervalUs);
+            group.interval_us = group.interval_us * (1 - kIntervalWeight) + interval * kIntervalWeight;
+        }
+        group.last_arrival_us = now;
+        group.pending.push_back(std::move(request));
+        if (group.collecting) {
+            if (group.pending.size() >= max_batch_) {
+                group.cv.notify_one();
+            }
+            return;
+        }
+        group.collecting = true;
+        Lead(key, &group, &lock);
+    }
+
+    ~RequestCoalescer() {
+        std::unique_lock<bthread::Mutex> lock(mu_);
+        while (leaders_ > 0) {
+            leaders_cv_.wait(lock);
+        }
+    }
+
+    // the current window of the key in microseconds
+    uint64_t GetWindow(const std::string& key) {
+        std::lock_guard<bthread::Mutex> lock(mu_);
+        auto it = groups_.find(key);
+        return it == groups_.end() ? 0 : Window(it->second);
+    }
+
+ private:
+    static constexpr double kIntervalWeight = 0.1;
+    static constexpr int64_t kMaxIntervalUs = 1000000;
+
+    struct Group {
+        std::deque<Request> pending;
+        bthread::ConditionVariable cv;
+        // a leader is collecting the next batch
+        bool collecting = false;
+        int64_t last_arrival_us = 0;
+        // moving average of the interval between two requests
+        double interval_us = kMaxIntervalUs;
+    };
+
+    struct LeaderArg {
+        RequestCoalescer* coalescer;
+        std::string key;
+    };
+
+    static void* RunLeader(void* arg) {
+        std::unique_ptr<LeaderArg> leader(static_cast<LeaderArg*>(arg));
+        auto* coalescer = leader->coalescer;
+        std::unique_lock<bthread::Mutex> lock(coalescer->mu_);
+        coalescer->Lead(leader->key, &coalescer->groups_[leader->key], &lock);
+        if (--coalescer->leaders_ == 0) {
+            coalescer->leaders_cv_.notify_all();
+        }
+        return nullptr;
+    }
+
+    // collect a batch of the group and run it, the lock is held on entry and on return
+    void Lead(const std::string& key, Group* group, std::unique_lock<bthread::Mutex>* lock) {
+        bool lead_next = true;
+        while (lead_next) {
+            int64_t deadline = butil::gettimeofday_us() + static_cast<int64_t>(Window(*group));
+            while (group->pending.size() < max_batch_) {
+                int64_t left = deadline - butil::gettimeofday_us();
+                if (left <= 0) {
+                    break;
+                }
+                group->cv.wait_for(*lock, left);
+            }
+            std::vector<Request> batch;
+            size_t size = std::min<size_t>(group->pending.size(), max_batch_);
+            batch.reserve(size);
+            for (size_t i = 0; i < size; i++) {
+                batch.push_back(std::move(group->pending.front()));
+                group->pending.pop_front();
+            }
+            if (group->pending.empty()) {
+                group->collecting = false;
+                lead_next = false;
+            } else {
+                // keep leading after the batch only if no bthread takes over the rest
+                lead_next = !StartLeader(key);
+            }
+            lock->unlock();
+            handler_(key, &batch);
+            lock->lock();
+        }
+    }
+
+    bool StartLeader(const std::string& key) {
+        auto* arg = new LeaderArg{this, key};
+        bthread_t tid;
+        if (bthread_start_background(&tid, nullptr, RunLeader, arg) != 0) {
+            delete arg;
+            return false;
+        }
+        leaders_++;
+        return true;
+    }
+
+    uint64_t Window(const Group& group) const {
+        if (max_batch_ <= 1 || group.interval_us >= max_wait_us_) {
+            return 0;
+        }
+        return std::min(max_wait_us_, static_cast<uint64_t>(group.interval_us * (max_batch_ - 1)));
+    }
+
+    const uint32_t max_batch_;
+    const uint64_t max_wait_us_;
+    Handler handler_;
+    bthread::Mutex mu_;
+    // the leader bthreads started and not finished yet
+    uint32_t leaders_ = 0;
+    bthread::ConditionVariable leaders_cv_;
+    // the groups are never erased, there is one per deployment
+    std::map<std::string, Group> groups_;
+};
+
+}  // namespace tablet
+}  // namespace openmldb
+
+#endif  // SRC_TABLET_REQUEST_COALESCER_H_
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tablet/request_coalescer.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <mutex>  // NOLINT
+#include <set>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "base/glog_wapper.h"
+#include "gflags/gflags.h"
+#include "gtest/gtest.h"
+
+namespace openmldb::tablet {
+
+class RequestCoalescerTest : public ::testing::Test {};
+
+TEST_F(RequestCoalescerTest, single_request_runs_at_once) {
+    std::vector<size_t> batch_sizes;
+    RequestCoalescer<int> coalescer(32, 1000000, [&](const std::string& key, std::vector<int>* batch) {
+        batch_sizes.push_back(batch->size());
+    });
+    // a key without recent requests does not wait for others
+    auto start = butil::gettimeofday_us();
+    coalescer.Submit("db.sp", 1);
+    ASSERT_LT(butil::gettimeofday_us() - start, 500000);
+    ASSERT_EQ(std::vector<size_t>({1}), batch_sizes);
+    ASSERT_EQ(0u, coalescer.GetWindow("db.sp"));
+    ASSERT_EQ(0u, coalescer.GetWindow("db.sp2"));
+}
+
+TEST_F(RequestCoalescerTest, concurrent_requests_are_batched) {
+    const uint32_t max_batch = 8;
+    const int thread_num = 16;
+    const int request_num = 2000;
+    std::mutex mu;
+    std::multiset<int> handled;
+    size_t max_size = 0;
+    uint32_t batches = 0;
+    uint64_t window = 0;
+    {
+        RequestCoalescer<int> coalescer(max_batch, 2000, [&](const std::string& key, std::vector<int>* batch) {
+            ASSERT_EQ("db.sp", key);
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            std::lock_guard<std::mutex> lock(mu);
+            max_size = std::max(max_size, batch->size());
+            batches++;
+            handled.insert(batch->begin(), batch->end());
+        });
+        std::vector<std::thread> workers;
+        for (int t = 0; t < thread_num; t++) {
+            workers.emplace_back([&coalescer, t] {
+                for (int i = t; i < request_num; i += thread_num) {
+                    coalescer.Submit("db.sp", i);
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        window = coalescer.GetWindow("db.sp");
+        // the coalescer waits for the leaders handed the queued requests when it is destroyed
+    }
+    ASSERT_EQ(static_cast<size_t>(request_num), handled.size());
+    for (int i = 0; i < request_num; i++) {
+        ASSERT_EQ(1u, handled.count(i));
+    }
+    ASSERT_LE(max_size, max_batch);
+    ASSERT_GT(max_size, 1u);
+    ASSERT_LT(batches, static_cast<uint32_t>(request_num));
+    ASSERT_LE(window, 2000u);
+}
+
+TEST_F(RequestCoalescerTest, batches_run_concurrently) {
+    std::mutex mu;
+    std::condition_variable cv;
+    bool release = false;
+    std::set<int> handled;
+    RequestCoalescer<int> coalescer(4, 1000, [&](const std::string& key, std::vector<int>* batch) {
+        std::unique_lock<std::mutex> lock(mu);
+        handled.insert(batch->begin(), batch->end());
+        cv.notify_all();
+        if (std::find(batch->begin(), batch->end(), 0) != batch->end()) {
+            cv.wait(lock, [&] { return release; });
+        }
+    });
+    std::thread first([&coalescer] { coalescer.Submit("db.sp", 0); });
+    {
+        std::unique_lock<std::mutex> lock(mu);
+        cv.wait(lock, [&] { return handled.count(0) > 0; });
+    }
+    // the batch of 0 is still running, the next request leads a batch of its own
+    coalescer.Submit("db.sp", 1);
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        EXPECT_EQ(1u, handled.count(1));
+        release = true;
+    }
+    cv.notify_all();
+    first.join();
+}
+
+TEST_F(RequestCoalescerTest, keys_are_not_mixed) {
+    std::mutex mu;
+    std::set<std::string> mixed;
+    {
+        RequestCoalescer<std::string> coalescer(4, 1000, [&](const std::string& key, std::vector<std::string>* batch) {
+            for (const auto& request : *batch) {
+                if (request != key) {
+                    std::lock_guard<std::mutex> lock(mu);
+                    mixed.insert(request);
+                }
+            }
+        });
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 8; t++) {
+            workers.emplace_back([&coalescer, t] {
+                std::string key = "db.sp" + std::to_string(t % 2);
+                for (int i = 0; i < 200; i++) {
+                    coalescer.Submit(key, key);
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+    ASSERT_TRUE(mixed.empty());
+}
+
+}  // namespace openmldb::tablet
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    ::openmldb::base::SetLogLevel(INFO);
+    ::google::ParseCommandLineFlags(&argc, &argv, true);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tablet/subplan_executor.h"
+
+#include "bthread/bthread.h"
+#include "bthread/countdown_event.h"
+
+namespace openmldb {
+namespace tablet {
+
+struct SubplanTask {
+    const std::function<void()>* fn;
+    bthread::CountdownEvent* done;
+};
+
+static void* RunSubplanTask(void* arg) {
+    auto task = static_cast<SubplanTask*>(arg);
+    (*task->fn)();
+    task->done->signal();
+    return nullptr;
+}
+
+void BthreadSubplanExecutor::RunAll(const std::vector<std::function<void()>>& tasks) {
+    if (tasks.empty()) {
+        return;
+    }
+    bthread::CountdownEvent done(static_cast<int>(tasks.size() - 1));
+    std::vector<SubplanTask> args(tasks.size());
+    for (size_t idx = 1; idx < tasks.size(); idx++) {
+        args[idx] = {&tasks[idx], &done};
+        bthread_t tid;
+        if (bthread_start_background(&tid, nullptr, RunSubplanTask, &args[idx]) != 0) {
+            // run it here if no bthread is available
+            RunSubplanTask(&args[idx]);
+        }
+    }
+    tasks[0]();
+    done.wait();
+}
+
+}  // namespace tablet
+}  // namespace openmldb
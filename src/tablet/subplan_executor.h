@@ -0,0 +1,42 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_TABLET_SUBPLAN_EXECUTOR_H_
+#define SRC_TABLET_SUBPLAN_EXECUTOR_H_
+
+#include <functional>
+#include <vector>
+
+#include "vm/subplan_executor.h"
+
+namespace openmldb {
+namespace tablet {
+
+// Run the subplans of a request in bthreads, so a subplan waiting for a remote
+// sub-query yields the worker instead of blocking it. The first task runs on the
+// calling bthread.
+class BthreadSubplanExecutor : public ::hybridse::vm::SubplanExecutor {
+ public:
+    BthreadSubplanExecutor() = default;
+    ~BthreadSubplanExecutor() override = default;
+
+    void RunAll(const std::vector<std::function<void()>>& tasks) override;
+};
+
+}  // namespace tablet
+}  // namespace openmldb
+
+#endif  // SRC_TABLET_SUBPLAN_EXECUTOR_H_
@@ -30,6 +30,7 @@
 #include <snappy.h>
 
 #include <algorithm>
+#include <sstream>
 #include <thread>  // NOLINT
 #include <utility>
 #include <vector>
@@ -44,6 +45,7 @@
 #include "base/file_util.h"
 #include "base/glog_wapper.h"
 #include "base/hash.h"
+#include "base/numa.h"
 #include "base/proto_util.h"
 #include "base/status.h"
 #include "base/strings.h"
@@ -60,6 +62,7 @@
 #include "tablet/file_sender.h"
 #include "storage/table.h"
 #include "storage/disk_table_snapshot.h"
+#include "storage/tiered_table.h"
 #include "absl/cleanup/cleanup.h"
 
 using google::protobuf::RepeatedPtrField;
@@ -116,6 +119,17 @@ DECLARE_uint32(snapshot_ttl_check_interval);
 DECLARE_uint32(put_slow_log_threshold);
 DECLARE_uint32(query_slow_log_threshold);
 DECLARE_int32(snapshot_pool_size);
+DECLARE_bool(numa_aware);
+DECLARE_uint32(numa_worker_thread_num);
+DECLARE_bool(enable_subplan_parallel);
+DECLARE_bool(enable_request_pipeline);
+DECLARE_bool(enable_deploy_coalescing);
+DECLARE_uint32(query_memory_limit_mb);
+DECLARE_uint32(total_query_memory_limit_mb);
+DECLARE_uint32(batch_spill_memory_limit_mb);
+DECLARE_string(batch_spill_dir);
+DECLARE_uint32(deploy_coalescing_max_batch);
+DECLARE_uint32(deploy_coalescing_max_wait_us);
 
 namespace openmldb {
 namespace tablet {
@@ -124,6 +138,26 @@ static const std::string SERVER_CONCURRENCY_KEY = "server";  // NOLINT
 static const uint32_t SEED = 0xe17a1465;
 
 static constexpr const char DEPLOY_STATS[] = "deploy_stats";
+static constexpr const char DEPLOY_PROFILE[] = "deploy_profile";
+
+// tables of these modes recover from a MemTableSnapshot and the binlog
+static bool IsMemSnapshotMode(::openmldb::common::StorageMode mode) {
+    return mode == ::openmldb::common::kMemory || mode == ::openmldb::common::kTiered;
+}
+
+// the disk tier of a tiered table lives on the hdd paths
+static ::openmldb::common::StorageMode RootPathMode(::openmldb::common::StorageMode mode) {
+    return mode == ::openmldb::common::kTiered ? ::openmldb::common::kHDD : mode;
+}
+
+// the error message of a failed run, tell the user if the query ran out of memory
+static std::string GetRunErrorMsg(const ::hybridse::vm::RunSession& session, const std::string& msg) {
+    auto tracker = session.GetMemoryTracker();
+    if (tracker && tracker->LimitExceeded()) {
+        return "query memory limit exceeded: " + tracker->ToString();
+    }
+    return msg;
+}
 
 TabletImpl::TabletImpl()
     : tables_(),
@@ -185,6 +219,28 @@ bool TabletImpl::Init(const std::string& zk_cluster, const std::string& zk_path,
     ::openmldb::base::SplitString(FLAGS_recycle_bin_hdd_root_path, ",",
                                   mode_recycle_root_paths_[::openmldb::common::kHDD]);
     deploy_collector_ = std::make_unique<::openmldb::statistics::DeployQueryTimeCollector>();
+    if (FLAGS_numa_aware) {
+        const auto& topology = ::openmldb::base::NumaTopology::Instance();
+        for (uint32_t node = 0; node < topology.GetNodeCnt(); node++) {
+            if (!topology.GetCpus(node).empty()) {
+                numa_nodes_.push_back(node);
+            }
+        }
+        if (numa_nodes_.size() > 1) {
+            for (uint32_t node : numa_nodes_) {
+                numa_latency_.emplace_back(std::make_unique<::openmldb::statistics::ThreadLocalHistogram>());
+                numa_inplace_cnt_.emplace_back(std::make_unique<std::atomic<uint64_t>>(0));
+                numa_pools_.emplace_back(std::make_unique<::openmldb::base::TaskPool>(
+                    FLAGS_numa_worker_thread_num, FLAGS_numa_worker_thread_num * 1024,
+                    [&topology, node] { topology.BindThread(node); }));
+            }
+            PDLOG(INFO, "numa aware with %u nodes", static_cast<uint32_t>(numa_nodes_.size()));
+        } else {
+            PDLOG(WARNING, "numa_aware is ignored as there is only %u numa node",
+                  static_cast<uint32_t>(numa_nodes_.size()));
+            numa_nodes_.clear();
+        }
+    }
 
     if (!zk_cluster.empty()) {
         zk_client_ = new ZkClient(zk_cluster, real_endpoint, FLAGS_zk_session_timeout, endpoint, zk_path);
@@ -205,7 +261,24 @@ bool TabletImpl::Init(const std::string& zk_cluster, const std::string& zk_path,
     } else {
         options.SetClusterOptimized(false);
     }
+    options.SetEnableRequestPipeline(FLAGS_enable_request_pipeline);
+    if (FLAGS_batch_spill_memory_limit_mb > 0) {
+        options.spill_options().SetMemoryBudget(static_cast<int64_t>(FLAGS_batch_spill_memory_limit_mb) << 20);
+        options.spill_options().SetDir(FLAGS_batch_spill_dir);
+    }
     engine_ = std::unique_ptr<::hybridse::vm::Engine>(new ::hybridse::vm::Engine(catalog_, options));
+    if (FLAGS_query_memory_limit_mb > 0) {
+        ::hybridse::vm::MemoryTracker::SetDefaultQueryLimit(static_cast<int64_t>(FLAGS_query_memory_limit_mb) << 20);
+    }
+    if (FLAGS_total_query_memory_limit_mb > 0) {
+        ::hybridse::vm::MemoryTracker::Process()->SetLimit(static_cast<int64_t>(FLAGS_total_query_memory_limit_mb)
+                                                           << 20);
+    }
+    if (FLAGS_enable_deploy_coalescing) {
+        deploy_coalescer_ = std::make_unique<RequestCoalescer<CoalescedQuery>>(
+            FLAGS_deploy_coalescing_max_batch, FLAGS_deploy_coalescing_max_wait_us,
+            [this](const std::string& key, std::vector<CoalescedQuery>* queries) { RunCoalescedQueries(queries); });
+    }
     catalog_->SetLocalTablet(
         std::shared_ptr<::hybridse::vm::Tablet>(new ::hybridse::vm::LocalTablet(engine_.get(), sp_cache_)));
     std::set<std::string> snapshot_compression_set{"off", "zlib", "snappy"};
@@ -587,6 +660,9 @@ void TabletImpl::RecoverExternalFunction() {
 
 void TabletImpl::Get(RpcController* controller, const ::openmldb::api::GetRequest* request,
                      ::openmldb::api::GetResponse* response, Closure* done) {
+    if (RunOnNumaNode(request->tid(), request->pid(), done, [=] { Get(controller, request, response, done); })) {
+        return;
+    }
     brpc::ClosureGuard done_guard(done);
     uint64_t start_time = ::baidu::common::timer::get_micros();
     uint32_t tid = request->tid();
@@ -684,12 +760,58 @@ void TabletImpl::Get(RpcController* controller, const ::openmldb::api::GetReques
 
 void TabletImpl::Put(RpcController* controller, const ::openmldb::api::PutRequest* request,
                      ::openmldb::api::PutResponse* response, Closure* done) {
+    if (RunOnNumaNode(request->tid(), request->pid(), done, [=] { Put(controller, request, response, done); })) {
+        return;
+    }
+    brpc::ClosureGuard done_guard(done);
+    if (follower_.load(std::memory_order_relaxed)) {
+        response->set_code(::openmldb::base::ReturnCode::kIsFollowerCluster);
+        response->set_msg("is follower cluster");
+        return;
+    }
+    PutInternal(request, response);
+}
+
+void TabletImpl::BatchPut(RpcController* controller, const ::openmldb::api::BatchPutRequest* request,
+                          ::openmldb::api::BatchPutResponse* response, Closure* done) {
     brpc::ClosureGuard done_guard(done);
     if (follower_.load(std::memory_order_relaxed)) {
         response->set_code(::openmldb::base::ReturnCode::kIsFollowerCluster);
         response->set_msg("is follower cluster");
         return;
     }
+    response->set_code(::openmldb::base::ReturnCode::kOk);
+    if (request->put_size() == 0) {
+        return;
+    }
+    for (int i = 0; i < request->put_size(); i++) {
+        response->add_put_response();
+    }
+    // the puts are grouped by the numa node of their partitions and each group runs like a Put,
+    // the last group to finish runs done
+    std::map<int32_t, std::vector<int>> groups;
+    for (int i = 0; i < request->put_size(); i++) {
+        groups[GetNumaNodePos(request->put(i).tid(), request->put(i).pid())].push_back(i);
+    }
+    Closure* batch_done = done_guard.release();
+    auto remain = std::make_shared<std::atomic<uint32_t>>(groups.size());
+    for (auto& kv : groups) {
+        const auto& first = request->put(kv.second.front());
+        auto put_group = [this, request, response, batch_done, remain, idxs = std::move(kv.second)] {
+            for (int i : idxs) {
+                PutInternal(&request->put(i), response->mutable_put_response(i));
+            }
+            if (remain->fetch_sub(1, std::memory_order_acq_rel) == 1 && batch_done != nullptr) {
+                batch_done->Run();
+            }
+        };
+        if (!RunOnNumaNode(first.tid(), first.pid(), batch_done, put_group)) {
+            put_group();
+        }
+    }
+}
+
+void TabletImpl::PutInternal(const ::openmldb::api::PutRequest* request, ::openmldb::api::PutResponse* response) {
     uint64_t start_time = ::baidu::common::timer::get_micros();
     std::shared_ptr<Table> table = GetTable(request->tid(), request->pid());
     if (!table) {
@@ -1204,6 +1326,9 @@ int32_t TabletImpl::CountIndex(uint64_t expire_time, uint64_t expire_cnt, ::open
 
 void TabletImpl::Scan(RpcController* controller, const ::openmldb::api::ScanRequest* request,
                       ::openmldb::api::ScanResponse* response, Closure* done) {
+    if (RunOnNumaNode(request->tid(), request->pid(), done, [=] { Scan(controller, request, response, done); })) {
+        return;
+    }
     brpc::ClosureGuard done_guard(done);
     uint64_t start_time = ::baidu::common::timer::get_micros();
     if (request->st() < request->et()) {
@@ -1322,6 +1447,9 @@ void TabletImpl::Scan(RpcController* controller, const ::openmldb::api::ScanRequ
 
 void TabletImpl::Count(RpcController* controller, const ::openmldb::api::CountRequest* request,
                        ::openmldb::api::CountResponse* response, Closure* done) {
+    if (RunOnNumaNode(request->tid(), request->pid(), done, [=] { Count(controller, request, response, done); })) {
+        return;
+    }
     brpc::ClosureGuard done_guard(done);
     std::shared_ptr<Table> table = GetTable(request->tid(), request->pid());
     if (!table) {
@@ -1404,6 +1532,9 @@ void TabletImpl::Count(RpcController* controller, const ::openmldb::api::CountRe
 
 void TabletImpl::Traverse(RpcController* controller, const ::openmldb::api::TraverseRequest* request,
                           ::openmldb::api::TraverseResponse* response, Closure* done) {
+    if (RunOnNumaNode(request->tid(), request->pid(), done, [=] { Traverse(controller, request, response, done); })) {
+        return;
+    }
     brpc::ClosureGuard done_guard(done);
     std::shared_ptr<Table> table = GetTable(request->tid(), request->pid());
     if (!table) {
@@ -1604,12 +1735,94 @@ void TabletImpl::Delete(RpcController* controller, const ::openmldb::api::Delete
 void TabletImpl::Query(RpcController* ctrl, const openmldb::api::QueryRequest* request,
                        openmldb::api::QueryResponse* response, Closure* done) {
     DLOG(INFO) << "handle query request begin!";
+    if (deploy_coalescer_ && request->is_procedure() && !request->is_batch() && !request->is_debug() &&
+        !request->has_task_id() && !IsDeployProfileEnabled()) {
+        // the response is sent by the bthread running the batch
+        deploy_coalescer_->Submit(absl::StrCat(request->db(), ".", request->sp_name()),
+                                  CoalescedQuery{ctrl, request, response, done, absl::Now()});
+        return;
+    }
     brpc::ClosureGuard done_guard(done);
     brpc::Controller* cntl = static_cast<brpc::Controller*>(ctrl);
     butil::IOBuf& buf = cntl->response_attachment();
     ProcessQuery(ctrl, request, response, &buf);
 }
 
+void TabletImpl::RunCoalescedQueries(std::vector<CoalescedQuery>* queries) {
+    auto run_one_by_one = [this](CoalescedQuery* queries, size_t cnt) {
+        for (size_t i = 0; i < cnt; i++) {
+            brpc::ClosureGuard done_guard(queries[i].done);
+            brpc::Controller* cntl = static_cast<brpc::Controller*>(queries[i].ctrl);
+            ProcessQuery(queries[i].ctrl, queries[i].request, queries[i].response, &cntl->response_attachment());
+        }
+    };
+    if (queries->size() == 1) {
+        run_one_by_one(queries->data(), queries->size());
+        return;
+    }
+    const auto* first = queries->front().request;
+    hybridse::base::Status status;
+    auto compile_info = sp_cache_->GetBatchRequestInfo(first->db(), first->sp_name(), status);
+    // the rows of a deployment with constant columns are split into common and non common slices in batch
+    // request mode, which the single row responses can not carry
+    if (!status.isOK() || !compile_info || !compile_info->GetBatchRequestInfo().common_column_indices.empty() ||
+        !compile_info->GetBatchRequestInfo().output_common_column_indices.empty()) {
+        run_one_by_one(queries->data(), queries->size());
+        return;
+    }
+    std::vector<CoalescedQuery> valid_queries;
+    std::vector<::hybridse::codec::Row> input_rows;
+    valid_queries.reserve(queries->size());
+    input_rows.reserve(queries->size());
+    for (auto& query : *queries) {
+        ::hybridse::codec::Row row;
+        auto& request_buf = static_cast<brpc::Controller*>(query.ctrl)->request_attachment();
+        if (!codec::DecodeRpcRow(request_buf, 0, query.request->row_size(), query.request->row_slices(), &row)) {
+            brpc::ClosureGuard done_guard(query.done);
+            query.response->set_code(::openmldb::base::kSQLRunError);
+            query.response->set_msg("fail to decode input row");
+            continue;
+        }
+        input_rows.push_back(row);
+        valid_queries.push_back(query);
+    }
+    if (valid_queries.empty()) {
+        return;
+    }
+    ::hybridse::vm::BatchRequestRunSession session;
+    session.SetCompileInfo(compile_info);
+    session.SetSpName(first->sp_name());
+    std::vector<::hybridse::codec::Row> output_rows;
+    if (session.Run(input_rows, output_rows) != 0 || output_rows.size() != valid_queries.size()) {
+        // run them again one by one, so a bad request only fails itself
+        DLOG(WARNING) << "fail to run " << valid_queries.size() << " requests of " << first->sp_name()
+                      << " as a batch";
+        run_one_by_one(valid_queries.data(), valid_queries.size());
+        return;
+    }
+    const std::string& schema = session.GetEncodedSchema();
+    for (size_t i = 0; i < valid_queries.size(); i++) {
+        auto& query = valid_queries[i];
+        brpc::ClosureGuard done_guard(query.done);
+        auto* response = query.response;
+        size_t buf_total_size = 0;
+        auto& buf = static_cast<brpc::Controller*>(query.ctrl)->response_attachment();
+        if (output_rows[i].GetRowPtrCnt() != 1 || !codec::EncodeRpcRow(output_rows[i], &buf, &buf_total_size)) {
+            response->set_code(::openmldb::base::kSQLRunError);
+            response->set_msg("fail to encode sql output row");
+            continue;
+        }
+        response->set_schema(schema);
+        response->set_byte_size(buf_total_size);
+        response->set_count(1);
+        response->set_row_slices(1);
+        response->set_code(::openmldb::base::kOk);
+        if (IsCollectDeployStatsEnabled()) {
+            TryCollectDeployStats(query.request->db(), query.request->sp_name(), query.start);
+        }
+    }
+}
+
 void TabletImpl::ProcessQuery(RpcController* ctrl, const openmldb::api::QueryRequest* request,
                               ::openmldb::api::QueryResponse* response, butil::IOBuf* buf) {
     auto start = absl::Now();
@@ -1664,7 +1877,7 @@ void TabletImpl::ProcessQuery(RpcController* ctrl, const openmldb::api::QueryReq
         std::vector<::hybridse::codec::Row> output_rows;
         int32_t run_ret = session.Run(parameter_row, output_rows);
         if (run_ret != 0) {
-            response->set_msg(status.msg);
+            response->set_msg(GetRunErrorMsg(session, status.msg));
             response->set_code(::openmldb::base::kSQLRunError);
             DLOG(WARNING) << "fail to run sql: " << request->sql();
             return;
@@ -1695,6 +1908,10 @@ void TabletImpl::ProcessQuery(RpcController* ctrl, const openmldb::api::QueryReq
         if (request->is_debug()) {
             session.EnableDebug();
         }
+        bool is_profile = request->is_procedure() && IsDeployProfileEnabled();
+        if (is_profile) {
+            session.EnableProfile();
+        }
         if (request->is_procedure()) {
             const std::string& db_name = request->db();
             const std::string& sp_name = request->sp_name();
@@ -1712,6 +1929,9 @@ void TabletImpl::ProcessQuery(RpcController* ctrl, const openmldb::api::QueryReq
             session.SetCompileInfo(request_compile_info);
             session.SetSpName(sp_name);
             RunRequestQuery(ctrl, *request, session, *response, *buf);
+            if (is_profile) {
+                CollectDeployProfile(db_name, sp_name, session);
+            }
         } else {
             bool ok = engine_->Get(request->sql(), request->db(), session, status);
             if (!ok || session.GetCompileInfo() == nullptr) {
@@ -1767,6 +1987,10 @@ void TabletImpl::ProcessBatchRequestQuery(RpcController* ctrl,
         session.EnableDebug();
     }
     bool is_procedure = request->is_procedure();
+    bool is_profile = is_procedure && IsDeployProfileEnabled();
+    if (is_profile) {
+        session.EnableProfile();
+    }
 
     if (is_procedure) {
         std::shared_ptr<hybridse::vm::CompileInfo> request_compile_info;
@@ -1860,8 +2084,11 @@ void TabletImpl::ProcessBatchRequestQuery(RpcController* ctrl,
     } else {
         run_ret = session.Run(input_rows, output_rows);
     }
+    if (is_profile) {
+        CollectDeployProfile(request->db(), request->sp_name(), session);
+    }
     if (run_ret != 0) {
-        response->set_msg(status.msg);
+        response->set_msg(GetRunErrorMsg(session, status.msg));
         response->set_code(::openmldb::base::kSQLRunError);
         DLOG(WARNING) << "fail to run sql: " << request->sql();
         return;
@@ -2393,6 +2620,13 @@ void TabletImpl::GetTableStatus(RpcController* controller, const ::openmldb::api
                     }
                     status->set_idx_cnt(record_idx_cnt);
                 }
+            } else if (DiskTable* disk_table = dynamic_cast<DiskTable*>(table.get())) {
+                ::openmldb::storage::DiskTableFilterStats stats;
+                disk_table->GetFilterStats(&stats);
+                status->set_bloom_filter_checked(stats.bloom_checked);
+                status->set_bloom_filter_useful(stats.bloom_useful);
+                status->set_key_meta_hit(stats.key_meta_hit);
+                status->set_key_meta_miss(stats.key_meta_miss);
             }
         }
     }
@@ -2812,7 +3046,7 @@ void TabletImpl::SendSnapshotInternal(const std::string& endpoint, uint32_t tid,
             }
             snapshot_file = manifest.name();
         }
-        if (table->GetStorageMode() == common::kMemory) {
+        if (IsMemSnapshotMode(table->GetStorageMode())) {
             // send snapshot file
             if (sender.SendFile(snapshot_file, full_path + snapshot_file) < 0) {
                 PDLOG(WARNING, "send snapshot failed. tid[%u] pid[%u]", tid, pid);
@@ -3000,7 +3234,7 @@ void TabletImpl::LoadTable(RpcController* controller, const ::openmldb::api::Loa
             break;
         }
 
-        if (table_meta.storage_mode() == openmldb::common::kMemory) {
+        if (IsMemSnapshotMode(table_meta.storage_mode())) {
             if (CreateTableInternal(&table_meta, msg) < 0) {
                 response->set_code(::openmldb::base::ReturnCode::kCreateTableFailed);
                 response->set_msg(msg.c_str());
@@ -3060,8 +3294,20 @@ int TabletImpl::LoadTableInternal(uint32_t tid, uint32_t pid, std::shared_ptr<::
         }
         std::string binlog_path = GetDBPath(db_root_path, tid, pid) + "/binlog/";
         ::openmldb::storage::Binlog binlog(replicator->GetLogPart(), binlog_path);
-        if (snapshot->Recover(table, snapshot_offset) &&
-            binlog.RecoverFromBinlog(table, snapshot_offset, latest_offset)) {
+        bool recovered = false;
+        {
+            // the recovered rows are allocated on the numa node of the partition like the ones put later,
+            // the load threads of the snapshot are created in the scope and inherit the binding
+            std::unique_ptr<::openmldb::base::NumaNodeScope> scope;
+            int32_t numa_pos = GetNumaNodePos(tid, pid);
+            if (numa_pos >= 0) {
+                scope = std::make_unique<::openmldb::base::NumaNodeScope>(::openmldb::base::NumaTopology::Instance(),
+                                                                          numa_nodes_[numa_pos]);
+            }
+            recovered = snapshot->Recover(table, snapshot_offset) &&
+                        binlog.RecoverFromBinlog(table, snapshot_offset, latest_offset);
+        }
+        if (recovered) {
             // recover aggregator if exists
             std::string aggr_path = GetDBPath(db_root_path, tid, pid) + "/aggr_info.txt";
             if (::openmldb::base::IsExists(aggr_path)) {
@@ -3380,7 +3626,7 @@ void TabletImpl::CreateTable(RpcController* controller, const ::openmldb::api::C
     task_pool_.DelayTask(FLAGS_binlog_delete_interval, boost::bind(&TabletImpl::SchedDelBinlog, this, tid, pid));
     PDLOG(INFO, "create table with id %u pid %u name %s", tid, pid, name.c_str());
 
-    int gc_interval = table->GetStorageMode() == common::kMemory ? FLAGS_gc_interval : FLAGS_disk_gc_interval;
+    int gc_interval = IsMemSnapshotMode(table->GetStorageMode()) ? FLAGS_gc_interval : FLAGS_disk_gc_interval;
     gc_pool_.DelayTask(gc_interval * 60 * 1000, boost::bind(&TabletImpl::GcTable, this, tid, pid, false));
     response->set_code(::openmldb::base::ReturnCode::kOk);
     response->set_msg("ok");
@@ -3797,12 +4043,23 @@ int TabletImpl::CreateTableInternal(const ::openmldb::api::TableMeta* table_meta
     Table* table_ptr;
     if (table_meta->storage_mode() == openmldb::common::kMemory) {
         table_ptr = new MemTable(*table_meta);
+    } else if (table_meta->storage_mode() == openmldb::common::kTiered) {
+        table_ptr = new ::openmldb::storage::TieredTable(*table_meta, table_db_path);
     } else {
         table_ptr = new DiskTable(*table_meta, table_db_path);
     }
     table.reset(table_ptr);
 
-    if (!table->Init()) {
+    bool init_ok = false;
+    int32_t numa_pos = GetNumaNodePos(tid, pid);
+    if (numa_pos >= 0) {
+        // segments are allocated by a thread bound to the node, so they are on the memory of the node
+        ::openmldb::base::NumaNodeScope scope(::openmldb::base::NumaTopology::Instance(), numa_nodes_[numa_pos]);
+        init_ok = table->Init();
+    } else {
+        init_ok = table->Init();
+    }
+    if (!init_ok) {
         PDLOG(WARNING, "fail to init table. tid %u, pid %u", table_meta->tid(), table_meta->pid());
         msg.assign("fail to init table");
         return -1;
@@ -3834,7 +4091,8 @@ int TabletImpl::CreateTableInternal(const ::openmldb::api::TableMeta* table_meta
     }
 
     ::openmldb::storage::Snapshot* snapshot_ptr = nullptr;
-    if (table_meta->storage_mode() == openmldb::common::StorageMode::kMemory) {
+    if (IsMemSnapshotMode(table_meta->storage_mode())) {
+        // the snapshot and binlog of a tiered table hold the rows of both tiers
         snapshot_ptr = new ::openmldb::storage::MemTableSnapshot(tid, pid, replicator->GetLogPart(), db_root_path);
     } else {
         snapshot_ptr = new ::openmldb::storage::DiskTableSnapshot(table_meta->tid(), table_meta->pid(), db_root_path);
@@ -4065,7 +4323,7 @@ std::shared_ptr<::openmldb::api::TaskInfo> TabletImpl::FindMultiTask(const ::ope
 void TabletImpl::GcTable(uint32_t tid, uint32_t pid, bool execute_once) {
     std::shared_ptr<Table> table = GetTable(tid, pid);
     if (table) {
-        int32_t gc_interval = table->GetStorageMode() == common::kMemory ? FLAGS_gc_interval : FLAGS_disk_gc_interval;
+        int32_t gc_interval = IsMemSnapshotMode(table->GetStorageMode()) ? FLAGS_gc_interval : FLAGS_disk_gc_interval;
         table->SchedGc();
         if (!execute_once) {
             gc_pool_.DelayTask(gc_interval * 60 * 1000, boost::bind(&TabletImpl::GcTable, this, tid, pid, false));
@@ -4175,6 +4433,93 @@ void TabletImpl::ShowMemPool(RpcController* controller, const ::openmldb::api::H
 #endif
 }
 
+void TabletImpl::ShowDeployProfile(RpcController* controller, const ::openmldb::api::HttpRequest* request,
+                                   ::openmldb::api::HttpResponse* response, Closure* done) {
+    brpc::ClosureGuard done_guard(done);
+    brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+    std::ostringstream oss;
+    oss << "latency(us) since last flush, collected if deploy_stats is on\n";
+    for (const auto& kv : deploy_collector_->GetHistograms()) {
+        oss << kv.first << ": " << kv.second.ToString() << "\n";
+    }
+    oss << "\nrunner profiles, collected if deploy_profile is on\n";
+    {
+        std::lock_guard<std::mutex> lock(deploy_profile_mu_);
+        for (const auto& kv : deploy_profiles_) {
+            oss << kv.first << ":\n" << kv.second.ToString() << "\n";
+        }
+    }
+    cntl->response_attachment().append("<html><head><title>Deploy Profile</title></head><body><pre>");
+    // deployment names and sql are user input
+    cntl->response_attachment().append(::openmldb::base::HtmlEscape(oss.str()));
+    cntl->response_attachment().append("</pre></body></html>");
+}
+
+void TabletImpl::ShowNumaStat(RpcController* controller, const ::openmldb::api::HttpRequest* request,
+                              ::openmldb::api::HttpResponse* response, Closure* done) {
+    brpc::ClosureGuard done_guard(done);
+    brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+    std::ostringstream oss;
+    if (numa_nodes_.empty()) {
+        oss << "numa_aware is off or there is only one numa node\n";
+    }
+    std::vector<uint64_t> partition_cnt(numa_nodes_.size(), 0);
+    std::vector<uint64_t> record_cnt(numa_nodes_.size(), 0);
+    std::vector<uint64_t> mem_bytes(numa_nodes_.size(), 0);
+    if (!numa_nodes_.empty()) {
+        std::lock_guard<SpinMutex> spin_lock(spin_mutex_);
+        for (const auto& tables : tables_) {
+            for (const auto& kv : tables.second) {
+                if (kv.second->GetStorageMode() != ::openmldb::common::kMemory) {
+                    continue;
+                }
+                int32_t pos = GetNumaNodePos(tables.first, kv.first);
+                partition_cnt[pos]++;
+                record_cnt[pos] += kv.second->GetRecordCnt();
+                mem_bytes[pos] += kv.second->GetRecordByteSize() + kv.second->GetRecordIdxByteSize();
+            }
+        }
+    }
+    for (uint32_t pos = 0; pos < numa_nodes_.size(); pos++) {
+        oss << "node " << numa_nodes_[pos] << ": partitions=" << partition_cnt[pos] << " records=" << record_cnt[pos]
+            << " memory=" << mem_bytes[pos] << "B inplace=" << numa_inplace_cnt_[pos]->load(std::memory_order_relaxed)
+            << "\n    latency(us) " << numa_latency_[pos]->Snapshot().ToString() << "\n";
+    }
+    cntl->response_attachment().append("<html><head><title>Numa Stat</title></head><body><pre>");
+    cntl->response_attachment().append(oss.str());
+    cntl->response_attachment().append("</pre></body></html>");
+}
+
+int32_t TabletImpl::GetNumaNodePos(uint32_t tid, uint32_t pid) {
+    if (numa_nodes_.empty()) {
+        return -1;
+    }
+    // the partitions of a table are spread on all the nodes
+    return (tid + pid) % numa_nodes_.size();
+}
+
+bool TabletImpl::RunOnNumaNode(uint32_t tid, uint32_t pid, Closure* done,
+                               const ::openmldb::base::TaskPool::Task& task) {
+    int32_t pos = GetNumaNodePos(tid, pid);
+    // calls without done are waited by the caller, so they are run in place
+    if (pos < 0 || done == nullptr ||
+        ::openmldb::base::GetThreadNumaNode() == static_cast<int32_t>(numa_nodes_[pos])) {
+        return false;
+    }
+    uint64_t start_time = ::baidu::common::timer::get_micros();
+    auto* latency = numa_latency_[pos].get();
+    auto numa_task = [task, latency, start_time] {
+        task();
+        latency->Record(::baidu::common::timer::get_micros() - start_time);
+    };
+    // the rpc thread must not wait for the workers, so the request runs in place if the queue is full
+    if (!numa_pools_[pos]->TryAddTask(numa_task)) {
+        numa_inplace_cnt_[pos]->fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
 void TabletImpl::CheckZkClient() {
     if (zk_client_) {
         if (!zk_client_->IsConnected()) {
@@ -4445,7 +4790,7 @@ void TabletImpl::SchedDelBinlog(uint32_t tid, uint32_t pid) {
 
 bool TabletImpl::ChooseDBRootPath(uint32_t tid, uint32_t pid, const ::openmldb::common::StorageMode& mode,
                                   std::string& path) {
-    std::vector<std::string>& paths = mode_root_paths_[mode];
+    std::vector<std::string>& paths = mode_root_paths_[RootPathMode(mode)];
     if (paths.size() < 1) {
         return false;
     }
@@ -4463,7 +4808,7 @@ bool TabletImpl::ChooseDBRootPath(uint32_t tid, uint32_t pid, const ::openmldb::
 
 bool TabletImpl::ChooseRecycleBinRootPath(uint32_t tid, uint32_t pid, const ::openmldb::common::StorageMode& mode,
                                           std::string& path) {
-    std::vector<std::string>& paths = mode_recycle_root_paths_[mode];
+    std::vector<std::string>& paths = mode_recycle_root_paths_[RootPathMode(mode)];
     if (paths.size() < 1) return false;
 
     if (paths.size() == 1) {
@@ -5289,6 +5634,23 @@ bool TabletImpl::GetRealEp(uint64_t tid, uint64_t pid, std::map<std::string, std
     return true;
 }
 
+// deploy options which take effect in engine
+static std::shared_ptr<std::unordered_map<std::string, std::string>> GetEngineOptions(
+    const hybridse::sdk::ProcedureInfo& sp_info) {
+    std::shared_ptr<std::unordered_map<std::string, std::string>> options = nullptr;
+    for (const auto& key :
+         {hybridse::vm::LONG_WINDOWS, hybridse::vm::RESULT_CACHE_TTL, hybridse::vm::RESULT_CACHE_SIZE}) {
+        auto value = sp_info.GetOption(key);
+        if (value) {
+            if (!options) {
+                options = std::make_shared<std::unordered_map<std::string, std::string>>();
+            }
+            options->emplace(key, *value);
+        }
+    }
+    return options;
+}
+
 void TabletImpl::CreateProcedure(RpcController* controller, const openmldb::api::CreateProcedureRequest* request,
                                  openmldb::api::GeneralResponse* response, Closure* done) {
     brpc::ClosureGuard done_guard(done);
@@ -5305,12 +5667,7 @@ void TabletImpl::CreateProcedure(RpcController* controller, const openmldb::api:
     ::hybridse::base::Status status;
     auto sp_info_impl = std::make_shared<openmldb::catalog::ProcedureInfoImpl>(sp_info);
 
-    auto long_windows = sp_info_impl->GetOption(hybridse::vm::LONG_WINDOWS);
-    std::shared_ptr<std::unordered_map<std::string, std::string>> options = nullptr;
-    if (long_windows) {
-        options = std::make_shared<std::unordered_map<std::string, std::string>>();
-        options->emplace(hybridse::vm::LONG_WINDOWS, *long_windows);
-    }
+    auto options = GetEngineOptions(*sp_info_impl);
 
     // build for single request
     ::hybridse::vm::RequestRunSession session;
@@ -5383,6 +5740,8 @@ void TabletImpl::DropProcedure(RpcController* controller, const ::openmldb::api:
         } else {
             LOG(INFO) << "deleted deploy collector for " << collector_key;
         }
+        std::lock_guard<std::mutex> lock(deploy_profile_mu_);
+        deploy_profiles_.erase(collector_key);
     }
     response->set_code(::openmldb::base::ReturnCode::kOk);
     response->set_msg("ok");
@@ -5395,6 +5754,9 @@ void TabletImpl::RunRequestQuery(RpcController* ctrl, const openmldb::api::Query
     if (request.is_debug()) {
         session.EnableDebug();
     }
+    if (FLAGS_enable_subplan_parallel) {
+        session.SetSubplanExecutor(&subplan_executor_);
+    }
     ::hybridse::codec::Row row;
     auto& request_buf = dynamic_cast<brpc::Controller*>(ctrl)->request_attachment();
     size_t input_slices = request.row_slices();
@@ -5412,7 +5774,7 @@ void TabletImpl::RunRequestQuery(RpcController* ctrl, const openmldb::api::Query
     }
     if (ret != 0) {
         response.set_code(::openmldb::base::kSQLRunError);
-        response.set_msg("fail to run sql");
+        response.set_msg(GetRunErrorMsg(session, "fail to run sql"));
         return;
     } else if (row.GetRowPtrCnt() != 1) {
         response.set_code(::openmldb::base::kSQLRunError);
@@ -5438,12 +5800,7 @@ void TabletImpl::CreateProcedure(const std::shared_ptr<hybridse::sdk::ProcedureI
     const std::string& db_name = sp_info->GetDbName();
     const std::string& sp_name = sp_info->GetSpName();
     const std::string& sql = sp_info->GetSql();
-    auto long_windows = sp_info->GetOption(hybridse::vm::LONG_WINDOWS);
-    std::shared_ptr<std::unordered_map<std::string, std::string>> options = nullptr;
-    if (long_windows) {
-        options = std::make_shared<std::unordered_map<std::string, std::string>>();
-        options->emplace(hybridse::vm::LONG_WINDOWS, *long_windows);
-    }
+    auto options = GetEngineOptions(*sp_info);
 
     ::hybridse::base::Status status;
     // build for single request
@@ -5523,12 +5880,29 @@ std::string TabletImpl::GetDBPath(const std::string& root_path, uint32_t tid, ui
     return root_path + "/" + std::to_string(tid) + "_" + std::to_string(pid);
 }
 
-bool TabletImpl::IsCollectDeployStatsEnabled() const {
+bool TabletImpl::IsGlobalVariableEnabled(const std::string& name) const {
     auto p = std::atomic_load_explicit(&global_variables_, std::memory_order_relaxed);
-    auto it = p->find(DEPLOY_STATS);
+    auto it = p->find(name);
     return it != p->end() && (it->second == "true" || it->second == "on");
 }
 
+bool TabletImpl::IsCollectDeployStatsEnabled() const { return IsGlobalVariableEnabled(DEPLOY_STATS); }
+
+bool TabletImpl::IsDeployProfileEnabled() const { return IsGlobalVariableEnabled(DEPLOY_PROFILE); }
+
+void TabletImpl::CollectDeployProfile(const std::string& db, const std::string& name,
+                                      const ::hybridse::vm::RunSession& session) {
+    auto profile = session.GetProfile();
+    if (!profile) {
+        return;
+    }
+    if (session.IsDebug()) {
+        LOG(INFO) << "runner profile of " << db << "." << name << ":\n" << profile->ToString();
+    }
+    std::lock_guard<std::mutex> lock(deploy_profile_mu_);
+    deploy_profiles_[absl::StrCat(db, ".", name)].Merge(*profile);
+}
+
 // try collect the cost time for a deployment procedure into collector
 // if the procedure found in collector, it is colelcted directly
 // if not, the function will try find the procedure info from procedure cache, and if turns out is a deployment
@@ -5544,7 +5918,8 @@ void TabletImpl::TryCollectDeployStats(const std::string& db, const std::string&
         auto sp_info = sp_cache_->FindSpProcedureInfo(db, name);
         if (sp_info.ok() && sp_info.value()->GetType() == hybridse::sdk::kReqDeployment) {
             s = deploy_collector_->AddDeploy(deploy_name);
-            if (!s.ok()) {
+            // may be added by another request concurrently
+            if (!s.ok() && !absl::IsAlreadyExists(s)) {
                 LOG(ERROR) << "[ERROR] add deploy collector: " << s;
                 return;
             }
@@ -5554,7 +5929,7 @@ void TabletImpl::TryCollectDeployStats(const std::string& db, const std::string&
     if (!s.ok()) {
         LOG(ERROR) << "[ERROR] collect deploy stat: " << s;
     }
-    LOG(INFO) << "collected " << deploy_name << " for " << time;
+    DLOG(INFO) << "collected " << deploy_name << " for " << time;
 }
 
 void TabletImpl::BulkLoad(RpcController* controller, const ::openmldb::api::BulkLoadRequest* request,
@@ -19,6 +19,7 @@
 
 #include <brpc/server.h>
 
+#include <atomic>
 #include <list>
 #include <map>
 #include <memory>
@@ -29,6 +30,7 @@
 #include <vector>
 
 #include "base/spinlock.h"
+#include "base/taskpool.hpp"
 #include "catalog/tablet_catalog.h"
 #include "common/thread_pool.h"
 #include "nameserver/system_table.h"
@@ -37,12 +39,15 @@
 #include "storage/aggregator.h"
 #include "sdk/sql_cluster_router.h"
 #include "statistics/query_response_time/deploy_query_response_time.h"
+#include "statistics/query_response_time/latency_histogram.h"
 #include "storage/mem_table.h"
 #include "storage/mem_table_snapshot.h"
 #include "tablet/bulk_load_mgr.h"
 #include "tablet/combine_iterator.h"
 #include "tablet/file_receiver.h"
+#include "tablet/request_coalescer.h"
 #include "tablet/sp_cache.h"
+#include "tablet/subplan_executor.h"
 #include "vm/engine.h"
 #include "zk/zk_client.h"
 
@@ -86,6 +91,9 @@ class TabletImpl : public ::openmldb::api::TabletServer {
     void Put(RpcController* controller, const ::openmldb::api::PutRequest* request,
              ::openmldb::api::PutResponse* response, Closure* done);
 
+    void BatchPut(RpcController* controller, const ::openmldb::api::BatchPutRequest* request,
+                  ::openmldb::api::BatchPutResponse* response, Closure* done);
+
     void Get(RpcController* controller, const ::openmldb::api::GetRequest* request,
              ::openmldb::api::GetResponse* response, Closure* done);
 
@@ -168,6 +176,14 @@ class TabletImpl : public ::openmldb::api::TabletServer {
     void ShowMemPool(RpcController* controller, const ::openmldb::api::HttpRequest* request,
                      ::openmldb::api::HttpResponse* response, Closure* done);
 
+    // show latency percentiles and runner profiles of deployments
+    void ShowDeployProfile(RpcController* controller, const ::openmldb::api::HttpRequest* request,
+                           ::openmldb::api::HttpResponse* response, Closure* done);
+
+    // show partitions, memory and latency of each numa node if numa_aware is on
+    void ShowNumaStat(RpcController* controller, const ::openmldb::api::HttpRequest* request,
+                      ::openmldb::api::HttpResponse* response, Closure* done);
+
     void GetAllSnapshotOffset(RpcController* controller, const ::openmldb::api::EmptyRequest* request,
                               ::openmldb::api::TableSnapshotOffsetResponse* response, Closure* done);
 
@@ -377,6 +393,9 @@ class TabletImpl : public ::openmldb::api::TabletServer {
 
     int CheckDimessionPut(const ::openmldb::api::PutRequest* request, uint32_t idx_cnt);
 
+    // put one row into the leader partition and replicate it, shared by Put and BatchPut
+    void PutInternal(const ::openmldb::api::PutRequest* request, ::openmldb::api::PutResponse* response);
+
     // sync log data from page cache to disk
     void SchedSyncDisk(uint32_t tid, uint32_t pid);
 
@@ -426,20 +445,48 @@ class TabletImpl : public ::openmldb::api::TabletServer {
 
     std::string GetDBPath(const std::string& root_path, uint32_t tid, uint32_t pid);
 
+    // return true if the global variable is set to "true" or "on"
+    bool IsGlobalVariableEnabled(const std::string& name) const;
+
     bool IsCollectDeployStatsEnabled() const;
 
+    bool IsDeployProfileEnabled() const;
+
     // collect deploy statistics into memory
     void TryCollectDeployStats(const std::string& db, const std::string& name, absl::Time start_time);
 
+    // merge the runner profile of the last run of session into the profile of deployment
+    void CollectDeployProfile(const std::string& db, const std::string& name,
+                              const ::hybridse::vm::RunSession& session);
+
     void RunRequestQuery(RpcController* controller, const openmldb::api::QueryRequest& request,
                          ::hybridse::vm::RequestRunSession& session,                  // NOLINT
                          openmldb::api::QueryResponse& response, butil::IOBuf& buf);  // NOLINT
 
+    // a deployment request waiting to run with the concurrent requests of the same deployment
+    struct CoalescedQuery {
+        RpcController* ctrl;
+        const openmldb::api::QueryRequest* request;
+        openmldb::api::QueryResponse* response;
+        Closure* done;
+        absl::Time start;
+    };
+
+    // run the requests of one deployment as a batch request and send the response of each
+    void RunCoalescedQueries(std::vector<CoalescedQuery>* queries);
+
     void CreateProcedure(const std::shared_ptr<hybridse::sdk::ProcedureInfo>& sp_info);
 
     // refresh the pre-aggr tables info
     bool RefreshAggrCatalog();
 
+    // the position of the numa node of the partition in numa_nodes_, -1 if numa_aware is off
+    int32_t GetNumaNodePos(uint32_t tid, uint32_t pid);
+
+    // run the task on the workers of the numa node of the partition, return false if the task
+    // should run on the current thread, e.g. the queue of the node is full
+    bool RunOnNumaNode(uint32_t tid, uint32_t pid, Closure* done, const ::openmldb::base::TaskPool::Task& task);
+
  private:
     Tables tables_;
     std::mutex mu_;
@@ -472,6 +519,8 @@ class TabletImpl : public ::openmldb::api::TabletServer {
     std::string zk_path_;
     std::string endpoint_;
     std::shared_ptr<SpCache> sp_cache_;
+    BthreadSubplanExecutor subplan_executor_;
+    std::unique_ptr<RequestCoalescer<CoalescedQuery>> deploy_coalescer_;
     std::string notify_path_;
     std::string sp_root_path_;
     std::string globalvar_changed_notify_path_;
@@ -480,6 +529,19 @@ class TabletImpl : public ::openmldb::api::TabletServer {
     std::shared_ptr<std::map<std::string, std::string>> global_variables_;
 
     std::unique_ptr<openmldb::statistics::DeployQueryTimeCollector> deploy_collector_;
+
+    std::mutex deploy_profile_mu_;
+    // deploy name -> merged runner profile, only collected if global variable deploy_profile is on
+    std::map<std::string, ::hybridse::vm::RunnerProfile> deploy_profiles_;
+
+    // numa nodes with cpus, partitions are placed on them by (tid + pid) % size
+    std::vector<uint32_t> numa_nodes_;
+    // latency of the rpcs run on each node, including the time waiting in the queue
+    std::vector<std::unique_ptr<::openmldb::statistics::ThreadLocalHistogram>> numa_latency_;
+    // workers bound to each node, stopped first when the tablet is destroyed
+    std::vector<std::unique_ptr<::openmldb::base::TaskPool>> numa_pools_;
+    // the requests of each numa node run on the rpc thread as the queue of the node is full
+    std::vector<std::unique_ptr<std::atomic<uint64_t>>> numa_inplace_cnt_;
 };
 
 }  // namespace tablet
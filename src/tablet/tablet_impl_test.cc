@@ -39,6 +39,7 @@
 #include "log/log_writer.h"
 #include "proto/tablet.pb.h"
 #include "proto/type.pb.h"
+#include "storage/tiered_table.h"
 #include "test/util.h"
 
 DECLARE_string(db_root_path);
@@ -1634,6 +1635,53 @@ TEST_P(TabletImplTest, Traverse) {
     delete kv_it;
 }
 
+TEST_P(TabletImplTest, BatchPut) {
+    ::openmldb::common::StorageMode storage_mode = GetParam();
+    TabletImpl tablet;
+    uint32_t id = counter++;
+    tablet.Init("");
+    ::openmldb::api::CreateTableRequest request;
+    ::openmldb::api::TableMeta* table_meta = request.mutable_table_meta();
+    table_meta->set_name("t0");
+    table_meta->set_tid(id);
+    table_meta->set_pid(1);
+    table_meta->set_storage_mode(storage_mode);
+    AddDefaultSchema(0, 0, ::openmldb::type::TTLType::kAbsoluteTime, table_meta);
+    ::openmldb::api::CreateTableResponse response;
+    MockClosure closure;
+    tablet.CreateTable(NULL, &request, &response, &closure);
+    ASSERT_EQ(0, response.code());
+    // the puts of a batch succeed or fail one by one
+    ::openmldb::api::BatchPutRequest brequest;
+    for (int ts = 9527; ts < 9540; ts++) {
+        auto* prequest = brequest.add_put();
+        PackDefaultDimension("test1", prequest);
+        prequest->set_time(ts);
+        prequest->set_value(::openmldb::test::EncodeKV("test1", "test" + std::to_string(ts)));
+        prequest->set_tid(id);
+        prequest->set_pid(ts == 9530 ? 2 : 1);
+    }
+    ::openmldb::api::BatchPutResponse bresponse;
+    tablet.BatchPut(NULL, &brequest, &bresponse, &closure);
+    ASSERT_EQ(0, bresponse.code());
+    ASSERT_EQ(13, bresponse.put_response_size());
+    for (int i = 0; i < 13; i++) {
+        if (i == 3) {
+            ASSERT_EQ(::openmldb::base::ReturnCode::kTableIsNotExist, bresponse.put_response(i).code());
+        } else {
+            ASSERT_EQ(0, bresponse.put_response(i).code());
+        }
+    }
+    ::openmldb::api::TraverseRequest sr;
+    sr.set_tid(id);
+    sr.set_pid(1);
+    sr.set_limit(100);
+    ::openmldb::api::TraverseResponse srp;
+    tablet.Traverse(NULL, &sr, &srp, &closure);
+    ASSERT_EQ(0, srp.code());
+    ASSERT_EQ(12, (signed)srp.count());
+}
+
 TEST_P(TabletImplTest, TraverseTTL) {
     ::openmldb::common::StorageMode storage_mode = GetParam();
     // disktable and memtable behave inconsistently with max_traverse_cnt
@@ -2493,6 +2541,71 @@ TEST_P(TabletImplTest, Recover) {
     }
 }
 
+TEST_F(TabletImplTest, TieredRecover) {
+    uint32_t id = counter++;
+    MockClosure closure;
+    uint64_t now = ::baidu::common::timer::get_micros() / 1000;
+    uint64_t old_time = now - 2 * 60 * 60 * 1000;
+    ::openmldb::api::TableMeta table_meta;
+    table_meta.set_name("t0");
+    table_meta.set_tid(id);
+    table_meta.set_pid(1);
+    table_meta.set_storage_mode(::openmldb::common::kTiered);
+    AddDefaultSchema(0, 0, ::openmldb::type::TTLType::kAbsoluteTime, &table_meta);
+    // rows older than 60 minutes are moved to disk
+    table_meta.mutable_column_key(0)->set_hot_ttl(60);
+    table_meta.set_term(1024);
+    table_meta.set_mode(::openmldb::api::TableMode::kTableLeader);
+    auto scan = [&](TabletImpl* tablet) {
+        ::openmldb::api::ScanRequest sr;
+        sr.set_tid(id);
+        sr.set_pid(1);
+        sr.set_pk("test1");
+        sr.set_st(now);
+        sr.set_et(old_time - 1);
+        ::openmldb::api::ScanResponse srp;
+        tablet->Scan(NULL, &sr, &srp, &closure);
+        EXPECT_EQ(0, srp.code());
+        return srp.count();
+    };
+    {
+        TabletImpl tablet;
+        tablet.Init("");
+        ::openmldb::api::CreateTableRequest request;
+        request.mutable_table_meta()->CopyFrom(table_meta);
+        ::openmldb::api::CreateTableResponse response;
+        tablet.CreateTable(NULL, &request, &response, &closure);
+        ASSERT_EQ(0, response.code());
+        ASSERT_EQ(0, PutKVData(id, 1, "test1", "test0", old_time, &tablet));
+        ASSERT_EQ(0, PutKVData(id, 1, "test1", "test1", now, &tablet));
+        auto table = std::dynamic_pointer_cast<::openmldb::storage::TieredTable>(tablet.GetTable(id, 1));
+        ASSERT_TRUE(table);
+        table->SchedGc();
+        ASSERT_GT(table->GetTierBoundary(0), old_time);
+        uint64_t cold_cnt = 0;
+        ASSERT_EQ(0, table->GetColdTable()->GetCount(0, "test1", cold_cnt));
+        ASSERT_EQ(1u, cold_cnt);
+        ASSERT_EQ(2u, scan(&tablet));
+        sleep(2);
+    }
+    // the memory tier is rebuilt from the binlog and the disk tier is reopened
+    {
+        TabletImpl tablet;
+        tablet.Init("");
+        ::openmldb::api::LoadTableRequest request;
+        request.mutable_table_meta()->CopyFrom(table_meta);
+        ::openmldb::api::GeneralResponse response;
+        tablet.LoadTable(NULL, &request, &response, &closure);
+        ASSERT_EQ(0, response.code());
+        sleep(1);
+        auto table = std::dynamic_pointer_cast<::openmldb::storage::TieredTable>(tablet.GetTable(id, 1));
+        ASSERT_TRUE(table);
+        ASSERT_GT(table->GetTierBoundary(0), old_time);
+        ASSERT_EQ(1u, table->GetHotTable()->GetRecordCnt());
+        ASSERT_EQ(2u, scan(&tablet));
+    }
+}
+
 TEST_P(TabletImplTest, LoadWithDeletedKey) {
     ::openmldb::common::StorageMode storage_mode = GetParam();
     uint32_t id = counter++;
@@ -0,0 +1,53 @@
+# Copyright 2021 4Paradigm
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+set(ARROW_HOME https://github.com/apache/arrow)
+set(ARROW_TAG apache-arrow-12.0.1)
+
+message(STATUS "build arrow and parquet from ${ARROW_HOME}@${ARROW_TAG}")
+
+# parquet files are written with snappy, so arrow links the snappy and zlib installed
+# here, its other dependencies (thrift, boost headers, ...) are built by arrow itself
+if (NOT BUILD_BUNDLED)
+  list(APPEND ARROW_DEPENDS hybridsql-asserts)
+endif()
+if (BUILD_BUNDLED_SNAPPY)
+  list(APPEND ARROW_DEPENDS snappy)
+endif()
+if (BUILD_BUNDLED_ZLIB)
+  list(APPEND ARROW_DEPENDS zlib)
+endif()
+
+ExternalProject_Add(
+  arrow
+  DEPENDS ${ARROW_DEPENDS}
+  GIT_REPOSITORY ${ARROW_HOME}
+  GIT_TAG ${ARROW_TAG}
+  GIT_SHALLOW TRUE
+  PREFIX ${DEPS_BUILD_DIR}
+  DOWNLOAD_DIR ${DEPS_DOWNLOAD_DIR}/arrow
+  INSTALL_DIR ${DEPS_INSTALL_DIR}
+  CONFIGURE_COMMAND
+    ${CMAKE_COMMAND} -S<SOURCE_DIR>/cpp -B<BINARY_DIR> -DCMAKE_INSTALL_PREFIX=<INSTALL_DIR>
+    -DCMAKE_PREFIX_PATH=<INSTALL_DIR> -DCMAKE_INSTALL_LIBDIR=lib -DCMAKE_BUILD_TYPE=Release
+    -DCMAKE_POSITION_INDEPENDENT_CODE=ON
+    -DARROW_BUILD_SHARED=OFF -DARROW_BUILD_STATIC=ON -DARROW_PARQUET=ON -DARROW_IPC=ON
+    -DARROW_COMPUTE=OFF -DARROW_CSV=OFF -DARROW_JSON=OFF -DARROW_FILESYSTEM=OFF
+    -DARROW_JEMALLOC=OFF -DARROW_MIMALLOC=OFF -DARROW_SIMD_LEVEL=NONE -DARROW_RUNTIME_SIMD_LEVEL=NONE
+    -DARROW_DEPENDENCY_SOURCE=BUNDLED -DARROW_WITH_SNAPPY=ON -DSnappy_SOURCE=SYSTEM
+    -DARROW_WITH_ZLIB=ON -DZLIB_SOURCE=SYSTEM -DARROW_WITH_LZ4=OFF -DARROW_WITH_ZSTD=OFF
+    -DARROW_WITH_BROTLI=OFF -DARROW_WITH_BZ2=OFF
+  BUILD_COMMAND ""
+  INSTALL_COMMAND
+    ${CMAKE_COMMAND} --build <BINARY_DIR> --target install -- ${MAKEOPTS})